@@ -10,6 +10,9 @@
 
 #include <config/CoviseConfig.h>
 #include "coVRAnimationManager.h"
+#include "coVRStreamingSequence.h"
+#include "coVRStatsDisplay.h"
+#include "VRViewer.h"
 #include "ui/Menu.h"
 #include "ui/Action.h"
 #include "ui/Button.h"
@@ -27,6 +30,8 @@
 #include <grmsg/coGRSetTimestepMsg.h>
 
 #include <vrb/client/VRBMessage.h>
+
+#include <algorithm>
 //#include <net/message.h>
 //#include <net/message_types.h>
 using namespace opencover;
@@ -225,6 +230,10 @@ coVRAnimationManager::setRemoteAnimationFrame(int currentFrame)
         {
             updateSequence(m_listOfSeq[i], currentFrame);
         }
+        for (auto stream: m_listOfStreams)
+        {
+            stream->show(currentFrame, upcomingFrames(currentFrame, stream->getCacheSize()));
+        }
         coVRPluginList::instance()->setTimestep(currentFrame);
         if (animFrameItem && m_numFrames != 0)
             animFrameItem->setValue(currentFrame);
@@ -324,6 +333,10 @@ coVRAnimationManager::setAnimationFrame(int currentFrame)
         {
             updateSequence(m_listOfSeq[i], currentFrame);
         }
+        for (auto stream: m_listOfStreams)
+        {
+            stream->show(currentFrame, upcomingFrames(currentFrame, stream->getCacheSize()));
+        }
         coVRPluginList::instance()->setTimestep(currentFrame);
         if (animFrameItem && m_numFrames != 0)
             animFrameItem->setValue(m_timestepBase + m_timestepScale * currentFrame);
@@ -338,24 +351,29 @@ int coVRAnimationManager::getNextFrame(int current)
     if (!m_animRunning)
         return current;
 
+    return advanceFrame(current, m_aniDirection);
+}
+
+int coVRAnimationManager::advanceFrame(int current, int &direction) const
+{
     if (animPingPongItem->getValue()) // normal loop mode
     {
         if (current >= m_stopFrame) // check for end of sequence
-            m_aniDirection = -1;
+            direction = -1;
         if (current <= m_startFrame) // check for start of sequence
-            m_aniDirection = 1;
+            direction = 1;
     }
     else
-        m_aniDirection = 1;
+        direction = 1;
 
     int next = current;
     if (animSpeedItem->getValue() > 0.0)
     {
-        next = current + m_aniDirection * m_aniSkip;
+        next = current + direction * m_aniSkip;
     }
     else if (animSpeedItem->getValue() < 0.0)
     {
-        next = current - m_aniDirection * m_aniSkip;
+        next = current - direction * m_aniSkip;
     }
 
     if (m_numFrames == 0)
@@ -379,6 +397,65 @@ int coVRAnimationManager::getNextFrame(int current)
     return next;
 }
 
+std::vector<int> coVRAnimationManager::upcomingFrames(int current, size_t count) const
+{
+    // timesteps in the order the animation will reach them
+    std::vector<int> frames;
+    int direction = m_aniDirection;
+    int frame = current;
+    for (size_t i = 0; i < count; ++i)
+    {
+        frame = advanceFrame(frame, direction);
+        if (frame == current)
+            break;
+        frames.push_back(frame);
+    }
+    return frames;
+}
+
+bool coVRAnimationManager::streamsReady(int frame)
+{
+    // hold the animation until the streaming sequences that wait for
+    // their timesteps have loaded this frame, the others drop it;
+    // called on every cluster node for the same frame, all of them hold
+    // until the frame is loaded everywhere so that they stay in step
+    bool ready = true;
+    for (auto stream: m_listOfStreams)
+    {
+        if (stream->getPolicy() != coVRStreamingSequence::Wait || frame >= stream->getNumTimesteps())
+            continue;
+        if (stream->isLoaded(frame))
+            continue;
+        stream->show(frame, upcomingFrames(frame, stream->getCacheSize()));
+        ready = false;
+    }
+    return coVRMSController::instance()->allReduceAnd(ready);
+}
+
+void coVRAnimationManager::updateStreams()
+{
+    size_t shown = 0, hits = 0;
+    double lead = 0.;
+    for (auto stream: m_listOfStreams)
+    {
+        size_t s = 0, h = 0;
+        double l = 0.;
+        stream->takeStats(s, h, l);
+        shown += s;
+        hits += h;
+        lead += l;
+    }
+
+    osg::Stats *stats = VRViewer::instance()->getViewerStats();
+    if (shown > 0 && stats && stats->collectStats("frame_rate"))
+    {
+        unsigned int frame = VRViewer::instance()->getFrameStamp()->getFrameNumber();
+        stats->setAttribute(frame, "Timestep cache hit rate", 100. * hits / shown);
+        if (hits > 0)
+            stats->setAttribute(frame, "Timestep prefetch lead ms", 1000. * lead / hits);
+    }
+}
+
 bool
 coVRAnimationManager::updateAnimationFrame()
 {
@@ -388,7 +465,10 @@ coVRAnimationManager::updateAnimationFrame()
         if ((cover->frameTime() - m_lastAnimationUpdate >= 1.0 / std::abs(speed))
             || (speed > 0. && speed > m_animSliderMax - 0.001)
             || (speed < 0. && speed < m_animSliderMin + 0.001)) {
-            return requestAnimationFrame(getNextFrame());
+            int next = getNextFrame();
+            if (!streamsReady(next))
+                return false;
+            return requestAnimationFrame(next);
         }
     }
     else
@@ -474,8 +554,15 @@ coVRAnimationManager::enableAnimation(bool state)
 bool
 coVRAnimationManager::update()
 {
+    // show streamed timesteps that have been loaded in the meantime
+    bool render = false;
+    for (auto stream: m_listOfStreams)
+        render = stream->update() || render;
+    if (!m_listOfStreams.empty())
+        updateStreams();
+
     // Set selected animation frame:
-    return updateAnimationFrame();
+    return updateAnimationFrame() || render;
 
 #if 0
    // rotate world menu button is checked
@@ -588,6 +675,33 @@ coVRAnimationManager::addSequence(osg::Sequence *seq, coVRAnimationManager::Fill
     }
 }
 
+void
+coVRAnimationManager::addStreamingSequence(coVRStreamingSequence *seq)
+{
+    if (std::find(m_listOfStreams.begin(), m_listOfStreams.end(), seq) != m_listOfStreams.end())
+        return;
+    setNumTimesteps(seq->getNumTimesteps(), seq);
+    m_listOfStreams.push_back(seq);
+    seq->show(m_currentAnimationFrame, upcomingFrames(m_currentAnimationFrame, seq->getCacheSize()));
+    if (auto stats = VRViewer::instance()->statsDisplay)
+        stats->enableTimestepStreamingStats(true);
+}
+
+void
+coVRAnimationManager::removeStreamingSequence(coVRStreamingSequence *seq)
+{
+    auto it = std::find(m_listOfStreams.begin(), m_listOfStreams.end(), seq);
+    if (it == m_listOfStreams.end())
+        return;
+    removeTimestepProvider(seq);
+    m_listOfStreams.erase(it);
+    if (m_listOfStreams.empty())
+    {
+        if (auto stats = VRViewer::instance()->statsDisplay)
+            stats->enableTimestepStreamingStats(false);
+    }
+}
+
 void coVRAnimationManager::setStartFrame(int frame)
 {
     m_startFrame = frame;
@@ -42,6 +42,8 @@ class Slider;
 #include <OpenConfig/file.h>
 namespace opencover
 {
+class coVRStreamingSequence;
+
 class COVEREXPORT coVRAnimationManager
 : public ui::Owner
 {
@@ -77,6 +79,10 @@ public:
 
     const std::vector<Sequence> &getSequences() const;
 
+    //! drive a sequence whose timesteps are loaded on demand, not owned
+    void addStreamingSequence(coVRStreamingSequence *seq);
+    void removeStreamingSequence(coVRStreamingSequence *seq);
+
     int getAnimationFrame() const
     {
         return m_currentAnimationFrame;
@@ -129,6 +135,11 @@ private:
 
     void updateSequence(Sequence &seq, int currentFrame);
     std::vector<Sequence> m_listOfSeq;
+    std::vector<coVRStreamingSequence *> m_listOfStreams;
+    int advanceFrame(int current, int &direction) const;
+    std::vector<int> upcomingFrames(int current, size_t count) const;
+    bool streamsReady(int frame);
+    void updateStreams();
     float m_animSliderMin, m_animSliderMax;
 
     int m_aniDirection = 1; // added for ping pong mode
@@ -64,8 +64,18 @@ using namespace opencover;
 #endif
 
 #include <errno.h>
+#include <algorithm>
+#include <iomanip>
+#include <memory>
 #include "coVRMSController.h"
 
+// a batch is sent when it grows beyond this
+#define MAX_BATCH_SIZE (256 * 1024)
+// slaves read ahead from the master socket in chunks of this size
+#define RECV_BUFFER_SIZE (64 * 1024)
+// broadcasts are relayed along the slave tree in frames of at most this size
+#define TREE_FRAME_SIZE (64 * 1024)
+
 #ifdef DEBUG_MESSAGES
 int debugMessageCounter;
 bool debugMessagesCheck;
@@ -73,6 +83,60 @@ bool debugMessagesCheck;
 
 coVRMSController *coVRMSController::s_singleton = NULL;
 
+// measures the time spent in a sync call, calls nested in another sync call are not counted separately
+class coVRMSController::SyncTimer
+{
+public:
+    SyncTimer(coVRMSController *ms, const char *function)
+        : ms(ms)
+        , function(function)
+        , start(std::chrono::steady_clock::now())
+    {
+        ++ms->m_syncDepth;
+    }
+    ~SyncTimer()
+    {
+        --ms->m_syncDepth;
+        if (ms->m_syncDepth == 0 && ms->numSlaves > 0)
+            ms->recordSync(function, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+
+private:
+    coVRMSController *ms;
+    const char *function;
+    std::chrono::steady_clock::time_point start;
+};
+
+coVRMSController::SyncSite::SyncSite(const char *file, int line)
+    : SyncSite(std::string(file) + ":" + std::to_string(line))
+{
+}
+
+coVRMSController::SyncSite::SyncSite(const std::string &name)
+{
+    if (s_singleton)
+    {
+        m_previous = s_singleton->m_syncSite;
+        s_singleton->m_syncSite = name;
+    }
+}
+
+coVRMSController::SyncSite::~SyncSite()
+{
+    if (s_singleton)
+        s_singleton->m_syncSite = m_previous;
+}
+
+coVRMSController::Batch::Batch()
+{
+    coVRMSController::instance()->beginBatch();
+}
+
+coVRMSController::Batch::~Batch()
+{
+    coVRMSController::instance()->endBatch();
+}
+
 coVRMSController::SlaveData::SlaveData(int n)
     : data(coVRMSController::instance()->numSlaves)
     , n(n)
@@ -151,6 +215,7 @@ coVRMSController::coVRMSController(int AmyID, const char *addr, int port)
 
     m_drawStatistics = coCoviseConfig::isOn("COVER.MultiPC.Statistics", false);
     //   cover->setBuiltInFunctionState("CLUSTER_STATISTICS",m_drawStatistics);
+    readSyncConfig();
 
     // Multicast settings
     multicastDebugLevel = coCoviseConfig::getInt("COVER.MultiPC.Multicast.debugLevel", 0);
@@ -505,6 +570,7 @@ coVRMSController::coVRMSController(const MPI_Comm *comm, pthread_barrier_t *shmB
 
     m_drawStatistics = coCoviseConfig::isOn("COVER.MultiPC.Statistics", false);
     //   cover->setBuiltInFunctionState("CLUSTER_STATISTICS",m_drawStatistics);
+    readSyncConfig();
 
     // Multicast settings
     multicastDebugLevel = coCoviseConfig::getInt("COVER.MultiPC.Multicast.debugLevel", 0);
@@ -563,6 +629,13 @@ coVRMSController::coVRMSController(const MPI_Comm *comm, pthread_barrier_t *shmB
 
 coVRMSController::~coVRMSController()
 {
+    if (m_syncReportInterval > 0. && isCluster())
+        printSyncStatistics(std::cerr);
+
+    for (auto &child: m_treeChildren)
+        delete child.second;
+    if (m_treeParent != socket)
+        delete m_treeParent;
     delete socket;
     delete socketDraw;
     if ((syncMode == SYNC_SERIAL) || (syncMode == SYNC_TCP_SERIAL))
@@ -590,6 +663,321 @@ coVRMSController::~coVRMSController()
     s_singleton = nullptr;
 }
 
+void coVRMSController::readSyncConfig()
+{
+#ifndef DEBUG_MESSAGES
+    // the handshake for every transfer in DEBUG_MESSAGES does not allow for batching
+    m_batchingEnabled = coCoviseConfig::isOn("COVER.MultiPC.Batching", true);
+    // number of slaves each node sends the broadcasts to, 0: master sends to all slaves
+    m_treeFanout = coCoviseConfig::getInt("COVER.MultiPC.TreeFanout", 0);
+#endif
+    m_syncReportInterval = coCoviseConfig::getFloat("COVER.MultiPC.SyncStatisticsInterval", 0.f);
+    m_lastSyncReport = std::chrono::steady_clock::now();
+}
+
+bool coVRMSController::batching() const
+{
+    // MPI and multicast keep message boundaries, batches would not match the reads of the slaves
+    return m_batchingEnabled && numSlaves > 0 && syncMode != SYNC_MPI && syncMode != SYNC_MULTICAST;
+}
+
+void coVRMSController::beginBatch()
+{
+    ++m_batchDepth;
+}
+
+void coVRMSController::endBatch()
+{
+    assert(m_batchDepth > 0);
+    --m_batchDepth;
+    if (m_batchDepth == 0)
+        flushBatch();
+}
+
+void coVRMSController::flushBatch()
+{
+    if (m_batch.empty())
+        return;
+    assert(isMaster());
+
+    double startTime = 0.0;
+    if (m_drawStatistics)
+    {
+        startTime = cover->currentTime();
+    }
+    if (m_treeActive)
+    {
+        sendTree(0, m_batch.data(), int(m_batch.size()));
+        m_batch.clear();
+        if (m_drawStatistics)
+        {
+            networkSend += cover->currentTime() - startTime;
+        }
+        return;
+    }
+    for (int i = 0; i < numSlaves; i++)
+    {
+        size_t written = 0;
+        while (written < m_batch.size())
+        {
+            int ret = slaves[i]->send(m_batch.data() + written, int(m_batch.size() - written));
+            if (ret <= 0)
+            {
+                cerr << "coVRMSController::flushBatch: sending to slave " << i + 1 << " failed" << endl;
+                break;
+            }
+            written += ret;
+        }
+    }
+    m_batch.clear();
+    if (m_drawStatistics)
+    {
+        networkSend += cover->currentTime() - startTime;
+    }
+}
+
+namespace
+{
+// where a slave with children in the broadcast tree accepts the connection of one of them
+struct TreeAddress
+{
+    char host[256];
+    int port;
+};
+
+bool readFully(Socket *sock, void *c, int n)
+{
+    char *data = static_cast<char *>(c);
+    while (n > 0)
+    {
+        int ret = sock->Read(data, n);
+        if (ret < 0 && (errno == EAGAIN || errno == EINTR))
+            continue;
+        if (ret <= 0)
+            return false;
+        data += ret;
+        n -= ret;
+    }
+    return true;
+}
+
+template <class Connection>
+bool writeFully(Connection *conn, const void *c, int n)
+{
+    const char *data = static_cast<const char *>(c);
+    while (n > 0)
+    {
+        int ret = conn->send(data, n);
+        if (ret <= 0)
+            return false;
+        data += ret;
+        n -= ret;
+    }
+    return true;
+}
+
+// covise::Socket names it write instead of send
+struct SocketWriter
+{
+    Socket *sock;
+    int send(const void *c, int n)
+    {
+        int ret;
+        do
+        {
+            ret = sock->write(c, n);
+        } while ((ret <= 0) && ((errno == EAGAIN) || (errno == EINTR)));
+        return ret;
+    }
+};
+}
+
+// node 0 is the master, node i the slave i; the children of node i are
+// i*fanout+1 ... i*fanout+fanout, so every node is relayed to by a node with a lower id
+int coVRMSController::treeParent(int id) const
+{
+    return (id - 1) / m_treeFanout;
+}
+
+// the child of node id that relays to target, -1 if target is not below id
+int coVRMSController::treeChildFor(int id, int target) const
+{
+    while (target > id)
+    {
+        int parent = treeParent(target);
+        if (parent == id)
+            return target;
+        target = parent;
+    }
+    return -1;
+}
+
+void coVRMSController::setupTree()
+{
+    // MPI and multicast distribute on their own
+    if (m_treeFanout <= 0 || m_treeFanout >= numSlaves || syncMode == SYNC_MPI || syncMode == SYNC_MULTICAST)
+        return;
+
+    if (isMaster())
+    {
+        // collect where the relaying slaves listen and tell their children
+        std::vector<TreeAddress> addresses(numSlaves + 1);
+        for (int id = m_treeFanout + 1; id <= numSlaves; id++)
+        {
+            readSlave(treeParent(id) - 1, &addresses[id], sizeof(TreeAddress));
+        }
+        for (int id = m_treeFanout + 1; id <= numSlaves; id++)
+        {
+            if (!writeFully(slaves[id - 1], &addresses[id], sizeof(TreeAddress)))
+                cerr << "coVRMSController::setupTree: sending to slave " << id << " failed" << endl;
+        }
+    }
+    else
+    {
+        std::string host = coCoviseConfig::getEntry("COVER.MultiPC.TreeInterface");
+        if (host.empty())
+        {
+            char hostname[256] = "localhost";
+            gethostname(hostname, sizeof(hostname));
+            host = hostname;
+        }
+        for (int child = myID * m_treeFanout + 1; child <= std::min(numSlaves, (myID + 1) * m_treeFanout); child++)
+        {
+            TreeAddress address;
+            memset(&address, 0, sizeof(address));
+            strncpy(address.host, host.c_str(), sizeof(address.host) - 1);
+            Socket *sock = new Socket(&address.port);
+            sock->listen();
+            sendMaster(&address, sizeof(address));
+            m_treeChildren.emplace_back(child, sock);
+        }
+
+        if (treeParent(myID) == 0)
+        {
+            m_treeParent = socket;
+        }
+        else
+        {
+            TreeAddress address;
+            readMaster(&address, sizeof(address));
+            Host h(address.host);
+            m_treeParent = new Socket(&h, address.port, 200, 10);
+        }
+
+        for (auto &child: m_treeChildren)
+        {
+            if (child.second->acceptOnly(120) < 0)
+            {
+                cerr << "Slave " << child.first << " did not connect to slave " << myID << " within 2 minutes" << endl;
+            }
+        }
+    }
+    m_treeActive = true;
+    if (debugLevel(2))
+        cerr << "coVRMSController: relaying broadcasts along a tree with fanout " << m_treeFanout << endl;
+}
+
+// master: send to target (0: all slaves) through the tree
+void coVRMSController::sendTree(int target, const void *c, int n)
+{
+    assert(isMaster());
+
+    // relaying slaves forward a frame once it is complete, so large
+    // transfers are split up to keep all levels of the tree busy
+    const char *data = static_cast<const char *>(c);
+    while (n > 0)
+    {
+        int header[2] = {target, std::min(n, TREE_FRAME_SIZE)};
+        for (int child = 1; child <= std::min(numSlaves, m_treeFanout); child++)
+        {
+            if (target != 0 && treeChildFor(0, target) != child)
+                continue;
+            if (!writeFully(slaves[child - 1], header, sizeof(header))
+                || !writeFully(slaves[child - 1], data, header[1]))
+            {
+                cerr << "coVRMSController::sendTree: sending to slave " << child << " failed" << endl;
+            }
+        }
+        data += header[1];
+        n -= header[1];
+    }
+}
+
+// slave: receive one frame from the parent, relay it and keep what is meant for us;
+// there is no relay thread, frames are only forwarded while this slave itself
+// reads from the master: the children wait until their parent reaches its next
+// read, so a slow relay delays its whole subtree, and frames sent with
+// sendSlave() to a slave further down wait until the relays on the path read
+bool coVRMSController::readTree()
+{
+    assert(isSlave());
+
+    int header[2];
+    if (!readFully(m_treeParent, header, sizeof(header)) || header[1] < 0)
+        return false;
+    bool own = header[0] == 0 || header[0] == myID;
+    char *data = nullptr;
+    if (own)
+    {
+        if (m_recvBegin == m_recvEnd)
+            m_recvBegin = m_recvEnd = 0;
+        if (m_recvBuffer.size() < m_recvEnd + size_t(header[1]))
+            m_recvBuffer.resize(m_recvEnd + size_t(header[1]));
+        data = m_recvBuffer.data() + m_recvEnd;
+    }
+    else
+    {
+        m_treeFrame.resize(header[1]);
+        data = m_treeFrame.data();
+    }
+    if (!readFully(m_treeParent, data, header[1]))
+        return false;
+
+    for (auto &child: m_treeChildren)
+    {
+        if (header[0] != 0 && treeChildFor(myID, header[0]) != child.first)
+            continue;
+        SocketWriter writer{child.second};
+        if (!writeFully(&writer, header, sizeof(header)) || !writeFully(&writer, data, header[1]))
+        {
+            cerr << "coVRMSController::readTree: relaying to slave " << child.first << " failed" << endl;
+        }
+    }
+
+    if (own)
+        m_recvEnd += header[1];
+    return true;
+}
+
+void coVRMSController::recordSync(const char *function, double seconds)
+{
+    auto &h = m_syncHistograms[m_syncSite.empty() ? std::string(function) : m_syncSite + " " + function];
+    ++h.count;
+    h.total += seconds;
+    h.max = std::max(h.max, seconds);
+    size_t bucket = 0;
+    for (double us = seconds * 1e6; us >= 1. && bucket + 1 < h.buckets.size(); us *= 0.5)
+        ++bucket;
+    ++h.buckets[bucket];
+}
+
+void coVRMSController::printSyncStatistics(std::ostream &os) const
+{
+    os << "coVRMSController: sync latencies of " << (isMaster() ? "master" : "slave ") << myID << std::endl;
+    for (const auto &site: m_syncHistograms)
+    {
+        const auto &h = site.second;
+        os << "  " << site.first << ": " << h.count << " calls, avg " << std::fixed << std::setprecision(3)
+           << h.total / h.count * 1e3 << " ms, max " << h.max * 1e3 << " ms, <us:";
+        for (size_t b = 0; b < h.buckets.size(); ++b)
+        {
+            if (h.buckets[b] > 0)
+                os << " " << (1u << b) << ":" << h.buckets[b];
+        }
+        os << std::defaultfloat << std::endl;
+    }
+}
+
 bool
 coVRMSController::debugLevel(int l) const
 {
@@ -690,6 +1078,8 @@ void coVRMSController::connectToMaster(const char *addr, int port)
     {
         cerr << "could not set socket buff to " << sendbuf << endl;
     }
+
+    setupTree();
 }
 
 void coVRMSController::sendSlaves(const Message *msg)
@@ -740,9 +1130,18 @@ void coVRMSController::sendSlaves(const Message *msg)
         }
 #endif
     }
+    else if ((batching() && m_batchDepth > 0) || m_treeActive)
+    {
+        int header[4] = {msg->sender, msg->send_type, msg->type, int(msg->data.length())};
+        if (msg->data.data() == nullptr)
+            header[3] = 0;
+        sendSlaves(header, sizeof(header));
+        if (header[3] > 0)
+            sendSlaves(msg->data.data(), header[3]);
+    }
     else
-
     {
+        flushBatch();
         for (int i = 0; i < numSlaves; i++)
         {
             slaves[i]->sendMessage(msg);
@@ -754,6 +1153,14 @@ void coVRMSController::sendSlaves(const Message *msg)
 }
 void coVRMSController::sendSlaves(const UdpMessage* msg)
 {
+    if ((batching() && m_batchDepth > 0) || m_treeActive)
+    {
+        int header[3] = {msg->type, msg->sender, int(msg->data.length())};
+        sendSlaves(header, UDP_MESSAGE_HEADER_SIZE);
+        sendSlaves(msg->data.data(), msg->data.length());
+        return;
+    }
+    flushBatch();
 	for (int i = 0; i < numSlaves; i++)
 	{
 		slaves[i]->sendMessage(msg);
@@ -1059,9 +1466,39 @@ int coVRMSController::readMaster(void *c, int n, bool mcastOverTCP)
 #endif
         while (read < n)
         {
+            if (m_recvBegin < m_recvEnd)
+            {
+                // data that arrived together with an earlier read
+                size_t num = std::min(m_recvEnd - m_recvBegin, size_t(n - read));
+                memcpy((char *)c + read, m_recvBuffer.data() + m_recvBegin, num);
+                m_recvBegin += num;
+                read += int(num);
+                continue;
+            }
+
+            if (m_treeActive)
+            {
+                bool ok = readTree();
+                if (m_drawStatistics)
+                {
+                    networkRecv += cover->currentTime() - startTime;
+                }
+                if (!ok)
+                    return -1;
+                continue;
+            }
+
+            // small reads fetch everything that is available, so that the
+            // transfers of a batch do not need a system call each
+            bool readAhead = m_batchingEnabled && n - read < RECV_BUFFER_SIZE;
+            if (readAhead && m_recvBuffer.empty())
+                m_recvBuffer.resize(RECV_BUFFER_SIZE);
             do
             {
-                ret = socket->Read((char *)c + read, n - read);
+                if (readAhead)
+                    ret = socket->Read(m_recvBuffer.data(), int(m_recvBuffer.size()));
+                else
+                    ret = socket->Read((char *)c + read, n - read);
 
             } while ((ret <= 0) && ((errno == EAGAIN) || (errno == EINTR)));
             if (m_drawStatistics)
@@ -1070,7 +1507,15 @@ int coVRMSController::readMaster(void *c, int n, bool mcastOverTCP)
             }
             if (ret < 0)
                 return ret;
-            read += ret;
+            if (readAhead)
+            {
+                m_recvBegin = 0;
+                m_recvEnd = ret;
+            }
+            else
+            {
+                read += ret;
+            }
         }
     }
     return read;
@@ -1118,6 +1563,7 @@ int coVRMSController::readSlave(int slaveNum, void *data, int num)
     assert(isMaster());
     assert(slaveNum >= 0);
     assert(slaveNum < getNumSlaves());
+    flushBatch();
 
     return slaves[slaveNum]->read(data, num);
 }
@@ -1125,6 +1571,7 @@ int coVRMSController::readSlave(int slaveNum, void *data, int num)
 int coVRMSController::readSlaves(SlaveData *c)
 {
     assert(isMaster());
+    flushBatch();
 
     int i;
     int ret = 0;
@@ -1248,6 +1695,7 @@ void coVRMSController::sendMasterDraw(const void *c, int n)
 int coVRMSController::readSlavesDraw(void *c, int n)
 {
     assert(isMaster());
+    flushBatch();
 
     int i;
     int ret;
@@ -1276,6 +1724,7 @@ int coVRMSController::readSlavesDraw(void *c, int n)
 void coVRMSController::sendSlavesDraw(const void *c, int n)
 {
     assert(isMaster());
+    flushBatch();
 
 #if !defined(NOMCAST) && defined(HAVE_NORM)
     if (syncMode == SYNC_MULTICAST)
@@ -1351,6 +1800,9 @@ void coVRMSController::barrierDraw()
 {
     if (numSlaves == 0)
         return;
+    SyncTimer timer(this, "barrierDraw");
+    if (master)
+        flushBatch();
     MARK0("coVRMSController::barrierDraw");
     if (cover->debugLevel(5))
         fprintf(stderr, "\ncoVRMSController::barrierDraw\n");
@@ -1459,6 +1911,7 @@ void coVRMSController::sendSlave(int i, const void *c, int n)
     assert(isMaster());
     assert(i >= 0);
     assert(i < getNumSlaves());
+    flushBatch();
 
     double startTime = 0.0;
     if (m_drawStatistics)
@@ -1471,7 +1924,10 @@ void coVRMSController::sendSlave(int i, const void *c, int n)
     slaves[i]->read(&n, sizeof(n));
     debugMessageCounter++;
 #endif
-    slaves[i]->send(c, n);
+    if (m_treeActive)
+        sendTree(i + 1, c, n);
+    else
+        slaves[i]->send(c, n);
     //std::cerr << i << " : " << (char*) data.data[i] << std::endl;
     //std::cerr << i << " : " << data.size() << std::endl;
 
@@ -1484,6 +1940,7 @@ void coVRMSController::sendSlave(int i, const void *c, int n)
 void coVRMSController::sendSlaves(const SlaveData &data)
 {
     assert(isMaster());
+    flushBatch();
 
     int i;
     double startTime = 0.0;
@@ -1501,11 +1958,23 @@ void coVRMSController::sendSlaves(const SlaveData &data)
     }
     debugMessageCounter++;
 #endif
-    for (i = 0; i < numSlaves; i++)
+    if (m_treeActive)
     {
-        slaves[i]->send(data.data[i], data.size());
-        //std::cerr << i << " : " << (char*) data.data[i] << std::endl;
-        //std::cerr << i << " : " << data.size() << std::endl;
+        // a relaying slave stops reading once it got its own part, so the
+        // parts for the slaves further down the tree have to come first
+        for (i = numSlaves - 1; i >= 0; i--)
+        {
+            sendTree(i + 1, data.data[i], data.size());
+        }
+    }
+    else
+    {
+        for (i = 0; i < numSlaves; i++)
+        {
+            slaves[i]->send(data.data[i], data.size());
+            //std::cerr << i << " : " << (char*) data.data[i] << std::endl;
+            //std::cerr << i << " : " << data.size() << std::endl;
+        }
     }
 
     if (m_drawStatistics)
@@ -1535,7 +2004,15 @@ void coVRMSController::sendSlaves(const void *c, int n)
     }
     else
 #endif
+    if (batching() && m_batchDepth > 0)
+    {
+        m_batch.insert(m_batch.end(), static_cast<const char *>(c), static_cast<const char *>(c) + n);
+        if (m_batch.size() > MAX_BATCH_SIZE)
+            flushBatch();
+    }
+    else
     {
+        flushBatch();
 #ifdef DEBUG_MESSAGES
         for (i = 0; i < numSlaves; i++)
         {
@@ -1546,9 +2023,16 @@ void coVRMSController::sendSlaves(const void *c, int n)
         }
         debugMessageCounter++;
 #endif
-        for (i = 0; i < numSlaves; i++)
+        if (m_treeActive)
+        {
+            sendTree(0, c, n);
+        }
+        else
         {
-            slaves[i]->send(c, n);
+            for (i = 0; i < numSlaves; i++)
+            {
+                slaves[i]->send(c, n);
+            }
         }
     }
     if (m_drawStatistics)
@@ -1591,6 +2075,7 @@ void coVRMSController::startSlaves()
 #ifdef DEBUG_MESSAGES
         debugMessageCounter++;
 #endif
+        setupTree();
     }
 }
 
@@ -1715,6 +2200,9 @@ void coVRMSController::barrier()
 {
     if (numSlaves == 0)
         return;
+    SyncTimer timer(this, "barrier");
+    if (master)
+        flushBatch();
     MARK0("coVRMSController::barrier");
     if (cover->debugLevel(5))
         fprintf(stderr, "\ncoVRMSController::barrier\n");
@@ -2051,6 +2539,14 @@ void coVRMSController::barrierApp(int frameNum)
 {
     if (numSlaves == 0)
         return;
+    if (m_syncReportInterval > 0.
+        && std::chrono::steady_clock::now() - m_lastSyncReport > std::chrono::duration<double>(m_syncReportInterval))
+    {
+        printSyncStatistics(std::cerr);
+        m_syncHistograms.clear();
+        m_lastSyncReport = std::chrono::steady_clock::now();
+    }
+    SyncTimer timer(this, "barrierApp");
     if (master)
     {
         sendSlaves(&frameNum, sizeof(frameNum));
@@ -2089,6 +2585,7 @@ void coVRMSController::agreeInt(int value)
 {
     if (numSlaves == 0)
         return;
+    SyncTimer timer(this, "agreeInt");
     if (master)
     {
         sendSlaves(&value, sizeof(value));
@@ -2119,6 +2616,7 @@ void coVRMSController::agreeFloat(float value)
 {
     if (numSlaves == 0)
         return;
+    SyncTimer timer(this, "agreeFloat");
     if (master)
     {
         sendSlaves(&value, sizeof(value));
@@ -2150,10 +2648,12 @@ void coVRMSController::agreeString(std::string s)
         return;
     if (s.length() == 0)
         return;
+    SyncTimer timer(this, "agreeString");
     if (master)
     {
         int len = s.length();
 	const char *buf = s.c_str();
+        Batch batch;
         sendSlaves(&len, sizeof(len));
         sendSlaves(buf, len+1);
     }
@@ -2204,6 +2704,9 @@ void coVRMSController::syncTime()
 
     if (numSlaves == 0)
         return;
+    SyncTimer timer(this, "syncTime");
+    if (master)
+        flushBatch();
     int i;
     static bool oldStat = false;
     if ((oldStat != m_drawStatistics) && (master) && cover->getScene() != 0)
@@ -2312,6 +2815,7 @@ void coVRMSController::syncTime()
     {
         frameTime = cover->frameTime();
         frameRealTime = cover->frameRealTime();
+        Batch batch;
         sendSlaves(&frameTime, sizeof(double));
         sendSlaves(&frameRealTime, sizeof(double));
     }
@@ -2344,6 +2848,7 @@ void coVRMSController::syncTime()
 
 int coVRMSController::syncData(void *data, int size)
 {
+    SyncTimer timer(this, "syncData");
 #if defined(HAS_MPI) && defined(MPI_BCAST)
     if (syncMode == SYNC_MPI)
     {
@@ -2376,6 +2881,8 @@ int coVRMSController::syncMessage(covise::Message *msg)
 
     if (!coVRMSController::instance()->isCluster())
         return sizeof(buffer)+msg->data.length();
+    SyncTimer timer(this, "syncMessage");
+    Batch batch;
 
     if (coVRMSController::instance()->isMaster())
     {
@@ -2403,6 +2910,7 @@ int coVRMSController::syncMessage(covise::Message *msg)
 
 bool coVRMSController::syncBool(bool state)
 {
+    SyncTimer timer(this, "syncBool");
     char c = state ? 1 : 0;
     syncData(&c, 1);
     return (c != 0);
@@ -2414,6 +2922,7 @@ bool coVRMSController::reduceOr(bool val)
 {
     if (numSlaves == 0)
         return val;
+    SyncTimer timer(this, "reduceOr");
 
 #ifdef HAS_MPI
     if (syncMode == SYNC_MPI)
@@ -2445,6 +2954,7 @@ bool coVRMSController::reduceAnd(bool val)
 {
     if (numSlaves == 0)
         return val;
+    SyncTimer timer(this, "reduceAnd");
 
 #ifdef HAS_MPI
     if (syncMode == SYNC_MPI)
@@ -2476,6 +2986,7 @@ bool coVRMSController::allReduceOr(bool val)
 {
     if (numSlaves == 0)
         return val;
+    SyncTimer timer(this, "allReduceOr");
 
 #ifdef HAS_MPI
     if (syncMode == SYNC_MPI)
@@ -2494,6 +3005,7 @@ bool coVRMSController::allReduceAnd(bool val)
 {
     if (numSlaves == 0)
         return val;
+    SyncTimer timer(this, "allReduceAnd");
 
 #ifdef HAS_MPI
     if (syncMode == SYNC_MPI)
@@ -2512,11 +3024,13 @@ std::string coVRMSController::syncString(const std::string &s)
 {
     if (numSlaves == 0)
         return s;
+    SyncTimer timer(this, "syncString");
 
     size_t sz = 0;
     if (isMaster())
     {
         sz = s.size();
+        Batch batch;
         sendSlaves(&sz, sizeof(sz));
         if (sz > 0)
             sendSlaves(s.c_str(), sz);
@@ -2542,6 +3056,8 @@ std::string coVRMSController::syncString(const std::string &s)
 template<typename T> 
 typename std::enable_if<std::is_pod<T>::value, std::vector<T>>::type coVRMSController::syncVector(const std::vector<T> &vec)
 {
+    SyncTimer timer(this, "syncVector");
+    Batch batch;
     std::vector<T> retval = vec;
     auto s = retval.size();
     syncData(&s, sizeof(typename std::vector<T>::size_type));
@@ -2568,6 +3084,8 @@ INSTANTIATE_SYNCVECTOR(double)
 
 std::vector<std::string> coVRMSController::syncVector(const std::vector<std::string> &vec)
 {
+    SyncTimer timer(this, "syncVector");
+    Batch batch;
     std::vector<std::string> retval = vec;
     auto s = retval.size();
     syncData(&s, sizeof(typename std::vector<std::string>::size_type));
@@ -2591,6 +3109,7 @@ bool coVRMSController::syncVRBMessages()
 
     if (cover->debugLevel(5))
         fprintf(stderr, "\ncoVRMSController::syncVRBMessages\n");
+    std::unique_ptr<SyncTimer> timer;
 
     Message *vrbMsg = new Message;
 	UdpMessage* udpMsg = new UdpMessage;
@@ -2652,24 +3171,26 @@ bool coVRMSController::syncVRBMessages()
 				oldSec = curSec;
 			}
 		}
-		sendSlaves(&numVrbMessages, sizeof(int));
-		//cerr << "numMasterMSGS " <<  numVrbMessages << endl;
-        for (int i = 0; i < numVrbMessages; i++)
+        timer.reset(new SyncTimer(this, "syncVRBMessages"));
         {
-            sendSlaves(vrbMsgs[i]);
-			coVRCommunication::instance()->handleVRB(*vrbMsgs[i]);
-			delete vrbMsgs[i];
-        }
-        sendSlaves(&numUdpMessages, sizeof(int));
-        for (int i = 0; i < numUdpMessages; i++)
-        {
-            sendSlaves(udpMsgs[i]);
-			coVRCommunication::instance()->handleUdp(udpMsgs[i]);
-			delete udpMsgs[i];
+            // all messages reach the slaves with one transfer, before any of them is handled
+            Batch batch;
+            sendSlaves(&numVrbMessages, sizeof(int));
+            //cerr << "numMasterMSGS " <<  numVrbMessages << endl;
+            for (int i = 0; i < numVrbMessages; i++)
+            {
+                sendSlaves(vrbMsgs[i]);
+            }
+            sendSlaves(&numUdpMessages, sizeof(int));
+            for (int i = 0; i < numUdpMessages; i++)
+            {
+                sendSlaves(udpMsgs[i]);
+            }
         }
     }
 	else
 	{
+        timer.reset(new SyncTimer(this, "syncVRBMessages"));
 		//get number of Messages
 		if (readMaster(&numVrbMessages, sizeof(int)) < 0)
 		{
@@ -2679,12 +3200,12 @@ bool coVRMSController::syncVRBMessages()
 		//cerr << "numSlaveMSGS " <<  numVrbMessages << endl;
         for (int i = 0; i < numVrbMessages; i++)
         {
-            if (readMaster(vrbMsg) < 0)
+            vrbMsgs[i] = new Message;
+            if (readMaster(vrbMsgs[i]) < 0)
 			{
 				cerr << "sync_exit17 myID=" << myID << endl;
 				exit(0);
 			}
-			coVRCommunication::instance()->handleVRB(*vrbMsg);
         }
         if (readMaster(&numUdpMessages, sizeof(int)) < 0)
 		{
@@ -2694,14 +3215,26 @@ bool coVRMSController::syncVRBMessages()
 		//cerr << "numSlaveMSGS " <<  numVrbMessages << endl;
         for (int i = 0; i < numUdpMessages; i++)
         {
-            if (readMaster(udpMsg) < 0)
+            udpMsgs[i] = new UdpMessage;
+            if (readMaster(udpMsgs[i]) < 0)
 			{
 				cerr << "sync_exit170 myID=" << myID << endl;
 				exit(0);
 			}
-			coVRCommunication::instance()->handleUdp(udpMsg);
         }
     }
+    timer.reset();
+
+    for (int i = 0; i < numVrbMessages; i++)
+    {
+        coVRCommunication::instance()->handleVRB(*vrbMsgs[i]);
+        delete vrbMsgs[i];
+    }
+    for (int i = 0; i < numUdpMessages; i++)
+    {
+        coVRCommunication::instance()->handleUdp(udpMsgs[i]);
+        delete udpMsgs[i];
+    }
     delete vrbMsg;
 	delete udpMsg;
     return numVrbMessages > 0 || numUdpMessages > 0;
@@ -2731,9 +3264,11 @@ void coVRMSController::loadFile(const char *filename)
     {
         if (filename)
             len = strlen(filename) + 1;
+        beginBatch();
         sendSlaves(&len, sizeof(int));
         if (len > 0)
             sendSlaves(filename, len);
+        endBatch();
 
         if (filename != NULL)
         {
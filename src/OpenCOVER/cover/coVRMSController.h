@@ -30,18 +30,21 @@ typedef void pthread_barrier_t;
 #endif
 #endif
 
+#include <array>
+#include <chrono>
+#include <iosfwd>
+#include <map>
 #include <string>
 #include <vector>
 #include <util/coTypes.h>
 
 //#define DEBUG_MESSAGES
-#ifdef DEBUG_MESSAGES
+// attribute the latency of the following cluster syncs in this scope to this source location
+#define CLUSTER_MARK_NAME2(line) clusterMark_##line
+#define CLUSTER_MARK_NAME(line) CLUSTER_MARK_NAME2(line)
 #define CLUSTER_MARK() \
     ;                  \
-    coVRMSController::msController->checkMark(__FILE__, __LINE__);
-#else
-#define CLUSTER_MARK() ;
-#endif
+    opencover::coVRMSController::SyncSite CLUSTER_MARK_NAME(__LINE__)(__FILE__, __LINE__);
 #define UDP_MESSAGE_HEADER_SIZE  3 *sizeof(int)
 
 namespace covise
@@ -108,6 +111,28 @@ public:
         int n;
     };
 
+    //! names the sync calls made while it exists in the latency statistics
+    class COVEREXPORT SyncSite
+    {
+    public:
+        SyncSite(const char *file, int line);
+        explicit SyncSite(const std::string &name);
+        ~SyncSite();
+
+    private:
+        std::string m_previous;
+    };
+
+    //! the master collects everything sent to the slaves while it exists and
+    //! sends it with a single write per slave, use around runs of syncs
+    //! without computation in between: the slaves wait for the data until then
+    class COVEREXPORT Batch
+    {
+    public:
+        Batch();
+        ~Batch();
+    };
+
     static coVRMSController *instance();
     coVRMSController(int AmyID = -1, const char *addr = NULL, int port = 0);
 #ifdef HAS_MPI
@@ -202,6 +227,13 @@ public:
     bool drawStatistics() const;
     void setDrawStatistics(bool enable);
 
+    void beginBatch();
+    void endBatch();
+    //! send what was collected for the slaves so far
+    void flushBatch();
+    //! histograms of the time spent in the sync calls, per call site
+    void printSyncStatistics(std::ostream &os) const;
+
 #ifdef HAS_MPI
     MPI_Comm getAppCommunicator() const
     {
@@ -210,6 +242,28 @@ public:
 #endif
 
 private:
+    class SyncTimer;
+    friend class SyncTimer;
+    enum
+    {
+        NumLatencyBuckets = 24 // bucket i: latencies below 2^i microseconds
+    };
+    struct SyncHistogram
+    {
+        size_t count = 0;
+        double total = 0., max = 0.;
+        std::array<size_t, NumLatencyBuckets> buckets{};
+    };
+
+    void readSyncConfig();
+    bool batching() const;
+    // broadcasts relayed by the slaves along a tree (COVER.MultiPC.TreeFanout)
+    void setupTree();
+    int treeParent(int id) const;
+    int treeChildFor(int id, int target) const;
+    void sendTree(int target, const void *c, int n);
+    bool readTree();
+    void recordSync(const char *function, double seconds);
     bool debugLevel(int l) const;
     int m_debugLevel;
     bool master;
@@ -260,6 +314,25 @@ private:
 #endif
 
     int heartBeatCounter, heartBeatCounterDraw;
+
+    bool m_batchingEnabled = false;
+    int m_batchDepth = 0;
+    std::vector<char> m_batch; // master: data for all slaves that has not been sent yet
+    std::vector<char> m_recvBuffer; // slave: data read from the master ahead of time
+    size_t m_recvBegin = 0, m_recvEnd = 0;
+
+    int m_treeFanout = 0;
+    bool m_treeActive = false;
+    covise::Socket *m_treeParent = nullptr; // slave: connection the broadcasts arrive on
+    std::vector<std::pair<int, covise::Socket *>> m_treeChildren; // slave: ids and connections of the slaves we relay to
+    std::vector<char> m_treeFrame;
+
+    std::string m_syncSite;
+    int m_syncDepth = 0;
+    std::map<std::string, SyncHistogram> m_syncHistograms;
+    double m_syncReportInterval = 0.;
+    std::chrono::steady_clock::time_point m_lastSyncReport;
+
     static coVRMSController *s_singleton;
 };
 
@@ -193,6 +193,8 @@ coVRStatsDisplay::coVRStatsDisplay()
     , _rhrFpsChildNum(0)
     , _rhrBandwidthChildNum(0)
     , _rhrSkippedChildNum(0)
+    , _geometrySharingChildNum(0)
+    , _timestepStreamingChildNum(0)
     , _viewerChildNum(0)
     , _gpuChildNum(0)
     , _cameraSceneChildNum(0)
@@ -345,6 +347,14 @@ void coVRStatsDisplay::showStats(int whichStats, osgViewer::ViewerBase *viewer)
             _switch->setValue(_rhrSkippedChildNum, true);
             _switch->setValue(_threadingModelChildNum, true);
         }
+        if (_geometrySharingStats)
+        {
+            _switch->setValue(_geometrySharingChildNum, true);
+        }
+        if (_timestepStreamingStats)
+        {
+            _switch->setValue(_timestepStreamingChildNum, true);
+        }
     }
     default:
         break;
@@ -362,6 +372,16 @@ void coVRStatsDisplay::enableRhrStats(bool enable)
     _rhrStats = enable;
 }
 
+void coVRStatsDisplay::enableGeometrySharingStats(bool enable)
+{
+    _geometrySharingStats = enable;
+}
+
+void coVRStatsDisplay::enableTimestepStreamingStats(bool enable)
+{
+    _timestepStreamingStats = enable;
+}
+
 void coVRStatsDisplay::enableFinishStats(bool enable)
 {
     _finishStats = enable;
@@ -526,6 +546,37 @@ struct AveragedValueTextDrawCallback : public virtual osg::Drawable::DrawCallbac
     mutable osg::Timer_t _tickLastUpdated;
 };
 
+// add a label and the value of a statistics attribute drawn by an AveragedValueTextDrawCallback
+// to geode at pos and advance pos behind them, sample is as wide as the values to be expected
+static void addAveragedValueText(osg::Geode *geode, osg::Vec3 &pos, const std::string &font, float characterSize, float space,
+                                 const osg::Vec4 &color, const std::string &label, const char *sample,
+                                 osg::Stats *stats, const std::string &name, Accum accum, double multiplier)
+{
+    osg::ref_ptr<osgText::Text> labelText = new osgText::Text;
+    geode->addDrawable(labelText.get());
+
+    labelText->setColor(color);
+    labelText->setFont(font);
+    labelText->setCharacterSize(characterSize);
+    labelText->setPosition(pos);
+    labelText->setText(label + ":X", osgText::String::ENCODING_UTF8);
+    pos.x() = labelText->getBound().xMax();
+    labelText->setText(label + ": ", osgText::String::ENCODING_UTF8);
+
+    osg::ref_ptr<osgText::Text> valueText = new osgText::Text;
+    geode->addDrawable(valueText.get());
+
+    valueText->setColor(color);
+    valueText->setFont(font);
+    valueText->setCharacterSize(characterSize);
+    valueText->setPosition(pos);
+    valueText->setText(sample, osgText::String::ENCODING_UTF8);
+    valueText->setDrawCallback(new AveragedValueTextDrawCallback(stats, name, accum, multiplier));
+
+    pos.x() = valueText->getBound().xMax();
+    pos.x() += space;
+}
+
 struct CameraSceneStatsTextDrawCallback : public virtual osg::Drawable::DrawCallback
 {
     CameraSceneStatsTextDrawCallback(osg::Camera *camera, int cameraNumber)
@@ -1855,6 +1906,30 @@ void coVRStatsDisplay::setUpScene(osgViewer::ViewerBase *viewer)
         pos.x() += space;
     }
 
+    // geometry shared between objects instead of building it again
+    {
+        osg::Geode *geode = new osg::Geode();
+        _geometrySharingChildNum = _switch->getNumChildren();
+        _switch->addChild(geode, false);
+
+        addAveragedValueText(geode, pos, font, characterSize, space, colorFR, "Shared MB", "7777.77",
+                             viewer->getViewerStats(), "Geometry shared bytes", AccumMax, 1./1024/1024);
+        addAveragedValueText(geode, pos, font, characterSize, space, colorFR, "Saved ms", "7777.77",
+                             viewer->getViewerStats(), "Geometry shared ms", AccumMax, 1.);
+    }
+
+    // timesteps of streaming sequences found in their cache
+    {
+        osg::Geode *geode = new osg::Geode();
+        _timestepStreamingChildNum = _switch->getNumChildren();
+        _switch->addChild(geode, false);
+
+        addAveragedValueText(geode, pos, font, characterSize, space, colorFR, "Step hits %", "777.77",
+                             viewer->getViewerStats(), "Timestep cache hit rate", AccumAverage, 1.);
+        addAveragedValueText(geode, pos, font, characterSize, space, colorFR, "Lead ms", "7777.77",
+                             viewer->getViewerStats(), "Timestep prefetch lead ms", AccumAverage, 1.);
+    }
+
     // next line
     pos.y() -= characterSize * 1.5f;
 
@@ -59,6 +59,8 @@ public:
     void enableRhrStats(bool enable);
     void enableFinishStats(bool enable);
     void enableSyncStats(bool enable);
+    void enableGeometrySharingStats(bool enable);
+    void enableTimestepStreamingStats(bool enable);
 
     /** Get the keyboard and mouse usage of this manipulator.*/
     virtual void getUsage(osg::ApplicationUsage &usage) const;
@@ -95,6 +97,8 @@ protected:
     bool _gpuStats = false;
     std::string _gpuName;
     bool _rhrStats = false;
+    bool _geometrySharingStats = false;
+    bool _timestepStreamingStats = false;
     unsigned int _frameRateChildNum;
     unsigned int _gpuMemChildNum;
     unsigned int _gpuPCIeChildNum;
@@ -105,6 +109,8 @@ protected:
     unsigned int _rhrBandwidthChildNum;
     unsigned int _rhrDelayChildNum;
     unsigned int _rhrSkippedChildNum;
+    unsigned int _geometrySharingChildNum;
+    unsigned int _timestepStreamingChildNum;
     unsigned int _viewerChildNum;
     unsigned int _gpuChildNum;
     unsigned int _cameraSceneChildNum;
@@ -0,0 +1,241 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#include "coVRStreamingSequence.h"
+
+#include <config/CoviseConfig.h>
+#include <util/threadname.h>
+
+#include <algorithm>
+#include <iostream>
+
+using namespace opencover;
+using namespace covise;
+
+coVRStreamingSequence::coVRStreamingSequence(int numTimesteps, const Loader &loader, int cacheSize, int numThreads)
+: m_numTimesteps(numTimesteps)
+, m_loader(loader)
+, m_root(new osg::Group)
+{
+    if (cacheSize <= 0)
+        cacheSize = coCoviseConfig::getInt("cacheSize", "COVER.AnimationStreaming", 16);
+    if (numThreads <= 0)
+        numThreads = coCoviseConfig::getInt("threads", "COVER.AnimationStreaming", 2);
+    m_cacheSize = std::max(cacheSize, 2);
+    numThreads = std::max(numThreads, 1);
+
+    m_root->setName("StreamingSequence");
+    for (int i = 0; i < numThreads; ++i)
+        m_workers.emplace_back([this]() { worker(); });
+}
+
+coVRStreamingSequence::~coVRStreamingSequence()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_quit = true;
+    }
+    m_cond.notify_all();
+    for (auto &t: m_workers)
+        t.join();
+
+    while (m_root->getNumParents() > 0)
+        m_root->getParent(0)->removeChild(m_root.get());
+}
+
+osg::Group *coVRStreamingSequence::getNode() const
+{
+    return m_root.get();
+}
+
+int coVRStreamingSequence::getNumTimesteps() const
+{
+    return m_numTimesteps;
+}
+
+size_t coVRStreamingSequence::getCacheSize() const
+{
+    return m_cacheSize;
+}
+
+void coVRStreamingSequence::setPolicy(Policy policy)
+{
+    m_policy = policy;
+}
+
+coVRStreamingSequence::Policy coVRStreamingSequence::getPolicy() const
+{
+    return m_policy;
+}
+
+bool coVRStreamingSequence::isLoaded(int t) const
+{
+    return m_cache.find(t) != m_cache.end();
+}
+
+void coVRStreamingSequence::worker()
+{
+    setThreadName("cover:stream");
+    for (;;)
+    {
+        int t = -1;
+        {
+            std::unique_lock<std::mutex> guard(m_mutex);
+            m_cond.wait(guard, [this]() { return m_quit || !m_queue.empty(); });
+            if (m_quit)
+                return;
+            t = m_queue.front();
+            m_queue.pop_front();
+            m_loading.insert(t);
+        }
+
+        osg::ref_ptr<osg::Node> node;
+        try
+        {
+            node = m_loader(t);
+        }
+        catch (std::exception &ex)
+        {
+            std::cerr << "coVRStreamingSequence: loading timestep " << t << " failed: " << ex.what() << std::endl;
+        }
+
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_loading.erase(t);
+        m_loaded.emplace_back(t, node);
+    }
+}
+
+void coVRStreamingSequence::display(int t)
+{
+    auto it = m_cache.find(t);
+    if (it == m_cache.end())
+        return;
+    m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+    if (m_shown == t)
+        return;
+    m_root->removeChildren(0, m_root->getNumChildren());
+    // a failed load shows nothing
+    if (it->second.node)
+        m_root->addChild(it->second.node.get());
+    m_shown = t;
+}
+
+void coVRStreamingSequence::evict(const std::vector<int> &keep)
+{
+    // drop least recently used timesteps that are neither shown nor coming up
+    for (auto it = m_lru.end(); m_cache.size() > m_cacheSize && it != m_lru.begin();)
+    {
+        --it;
+        int t = *it;
+        if (t == m_shown || t == m_requested || std::find(keep.begin(), keep.end(), t) != keep.end())
+            continue;
+        m_cache.erase(t);
+        it = m_lru.erase(it);
+    }
+}
+
+bool coVRStreamingSequence::update()
+{
+    std::vector<std::pair<int, osg::ref_ptr<osg::Node>>> loaded;
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        loaded.swap(m_loaded);
+    }
+    auto now = std::chrono::steady_clock::now();
+    for (auto &l: loaded)
+    {
+        if (m_cache.find(l.first) != m_cache.end())
+            continue;
+        Entry &e = m_cache[l.first];
+        e.node = l.second;
+        e.loadedAt = now;
+        m_lru.push_front(l.first);
+        e.lru = m_lru.begin();
+    }
+
+    if (m_requested >= 0 && m_requested != m_shown && isLoaded(m_requested))
+    {
+        display(m_requested);
+        return true;
+    }
+    return false;
+}
+
+bool coVRStreamingSequence::show(int t, const std::vector<int> &upcoming)
+{
+    if (t < 0 || t >= m_numTimesteps)
+        t = -1;
+
+    update();
+
+    bool hit = true;
+    if (t != m_requested && t >= 0)
+    {
+        ++m_statShown;
+        auto it = m_cache.find(t);
+        hit = it != m_cache.end();
+        if (hit)
+        {
+            ++m_statHits;
+            m_statLead += std::chrono::duration<double>(std::chrono::steady_clock::now() - it->second.loadedAt).count();
+        }
+    }
+    m_requested = t;
+    if (t < 0)
+    {
+        m_root->removeChildren(0, m_root->getNumChildren());
+        m_shown = -1;
+    }
+    else
+    {
+        display(t);
+    }
+
+    // load the missing timesteps of the window, the requested one first
+    std::vector<int> window;
+    if (t >= 0)
+        window.push_back(t);
+    for (int u: upcoming)
+    {
+        if (window.size() >= m_cacheSize - 1)
+            break;
+        if (u >= 0 && u < m_numTimesteps && std::find(window.begin(), window.end(), u) == window.end())
+            window.push_back(u);
+    }
+    evict(window);
+
+    std::deque<int> queue;
+    for (int w: window)
+    {
+        if (!isLoaded(w))
+            queue.push_back(w);
+    }
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        for (auto &l: m_loaded)
+        {
+            queue.erase(std::remove(queue.begin(), queue.end(), l.first), queue.end());
+        }
+        for (int l: m_loading)
+        {
+            queue.erase(std::remove(queue.begin(), queue.end(), l), queue.end());
+        }
+        m_queue.swap(queue);
+    }
+    m_cond.notify_all();
+
+    return hit;
+}
+
+void coVRStreamingSequence::takeStats(size_t &shown, size_t &hits, double &leadTime)
+{
+    shown = m_statShown;
+    hits = m_statHits;
+    leadTime = m_statLead;
+    m_statShown = m_statHits = 0;
+    m_statLead = 0.;
+}
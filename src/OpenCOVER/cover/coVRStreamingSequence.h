@@ -0,0 +1,115 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#ifndef COVR_STREAMING_SEQUENCE_H
+#define COVR_STREAMING_SEQUENCE_H
+
+/*! \file
+ \brief  animation whose timesteps are loaded on demand
+
+ \author (C)
+         Computer Centre University of Stuttgart,
+         Allmandring 30,
+         D-70550 Stuttgart,
+         Germany
+ */
+
+#include <util/coExport.h>
+#include <osg/Group>
+#include <osg/ref_ptr>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace opencover
+{
+//! Replacement for an osg::Sequence with too many timesteps to keep all of
+//! them in memory: timesteps are created by a loader on worker threads when
+//! the animation gets close to them, and only a window of recently used
+//! timesteps is kept. Register with coVRAnimationManager::addStreamingSequence
+//! and add getNode() to the scene graph.
+class COVEREXPORT coVRStreamingSequence
+{
+public:
+    //! creates the scene graph of a timestep, called on worker threads,
+    //! so it must not access the scene graph or any COVER singleton
+    typedef std::function<osg::ref_ptr<osg::Node>(int timestep)> Loader;
+
+    //! what to do if the animation advances to a timestep that is not loaded yet
+    enum Policy
+    {
+        Wait, //< the animation is held until it is loaded
+        Drop, //< the animation goes on, the last loaded timestep stays visible
+    };
+
+    //! cacheSize: timesteps kept in memory, numThreads: loader threads,
+    //! <= 0: cacheSize/threads of COVER.AnimationStreaming
+    coVRStreamingSequence(int numTimesteps, const Loader &loader, int cacheSize = 0, int numThreads = 0);
+    ~coVRStreamingSequence();
+
+    osg::Group *getNode() const;
+    int getNumTimesteps() const;
+    size_t getCacheSize() const;
+    void setPolicy(Policy policy);
+    Policy getPolicy() const;
+
+    //! whether the scene graph of timestep t is in memory
+    bool isLoaded(int t) const;
+    //! show timestep t as soon as it is loaded and load the upcoming
+    //! timesteps in this order, returns whether t was shown immediately
+    bool show(int t, const std::vector<int> &upcoming);
+    //! take the timesteps loaded since the last call, show the requested one
+    //! if it just became available, returns whether the display changed
+    bool update();
+
+    //! statistics since the last call: timesteps that had to be shown and
+    //! how many of them were already loaded, and the sum of the time in
+    //! seconds these had been loaded before they were needed
+    void takeStats(size_t &shown, size_t &hits, double &leadTime);
+
+private:
+    struct Entry
+    {
+        osg::ref_ptr<osg::Node> node;
+        std::chrono::steady_clock::time_point loadedAt;
+        std::list<int>::iterator lru;
+    };
+
+    void worker();
+    void display(int t);
+    void evict(const std::vector<int> &keep);
+
+    int m_numTimesteps;
+    Loader m_loader;
+    size_t m_cacheSize;
+    Policy m_policy = Wait;
+    osg::ref_ptr<osg::Group> m_root;
+    std::map<int, Entry> m_cache;
+    std::list<int> m_lru; // most recently used first
+    int m_requested = -1, m_shown = -1;
+    size_t m_statShown = 0, m_statHits = 0;
+    double m_statLead = 0.;
+
+    // shared with the worker threads
+    std::vector<std::thread> m_workers;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+    bool m_quit = false;
+    std::deque<int> m_queue; // timesteps to load, most urgent first
+    std::set<int> m_loading;
+    std::vector<std::pair<int, osg::ref_ptr<osg::Node>>> m_loaded;
+};
+}
+#endif
@@ -28,6 +28,9 @@
 #include <cover/coVRPluginList.h>
 #include <cover/coVRFileManager.h>
 #include <cover/coVRCommunication.h>
+#include <cover/VRViewer.h>
+#include <cover/coVRStatsDisplay.h>
+#include <CovisePluginUtil/VRCoviseGeometryManager.h>
 #include <PluginUtil/FeedbackManager.h>
 #include <PluginUtil/ModuleInteraction.h>
 
@@ -85,6 +88,10 @@ bool CovisePlugin::init()
 
     //CoviseRender::set_custom_callback(CovisePlugin::OpenCOVERCallback, this); //get covisemessages from 
     CoviseRender::set_render_module_callback(messageCallback);
+
+    if (auto stats = VRViewer::instance()->statsDisplay)
+        stats->enableGeometrySharingStats(true);
+
     return VRCoviseConnection::covconn;
 }
 
@@ -96,6 +103,9 @@ CovisePlugin::~CovisePlugin()
     }
     delete VRCoviseConnection::covconn;
     VRCoviseConnection::covconn = NULL;
+
+    if (auto stats = VRViewer::instance()->statsDisplay)
+        stats->enableGeometrySharingStats(false);
 }
 
 void CovisePlugin::notify(NotificationLevel level, const char *text)
@@ -204,6 +214,19 @@ bool CovisePlugin::update()
 void CovisePlugin::preFrame()
 {
     updateScenegraph();
+    ObjectManager::instance()->attachBackgroundBuilds();
+
+    // report the geometry that did not have to be built again for the stats display
+    size_t sharedBytes = 0;
+    double sharedMs = 0.;
+    GeometryManager::instance()->takeSharingStats(sharedBytes, sharedMs);
+    osg::Stats *stats = VRViewer::instance()->getViewerStats();
+    if (stats && stats->collectStats("frame_rate"))
+    {
+        unsigned int frame = VRViewer::instance()->getFrameStamp()->getFrameNumber();
+        stats->setAttribute(frame, "Geometry shared bytes", (double)sharedBytes);
+        stats->setAttribute(frame, "Geometry shared ms", sharedMs);
+    }
 }
 
 void CovisePlugin::requestQuit(bool killSession)
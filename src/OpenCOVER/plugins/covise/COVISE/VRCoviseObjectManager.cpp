@@ -49,6 +49,7 @@
 #include <cover/coVRPluginSupport.h>
 #include "coCoviseInteractor.h"
 #include <cover/coVRAnimationManager.h>
+#include <cover/coVRStreamingSequence.h>
 #include <cover/coTabletUI.h>
 #include <cover/coVRTui.h>
 #include <cover/VRRegisterSceneGraph.h>
@@ -59,6 +60,7 @@
 
 #include <config/CoviseConfig.h>
 #include <util/coLog.h>
+#include <util/coTrace.h>
 #include <do/coDistributedObject.h>
 #include <appl/RenderInterface.h>
 
@@ -70,7 +72,11 @@
 #include <osg/LOD>
 
 #include <stdio.h>
+#include <algorithm>
+#include <chrono>
 #include <cstring>
+#include <iterator>
+#include <vector>
 //#include <cover/coVRDePee.h>
 
 using namespace std;
@@ -154,10 +160,17 @@ ObjectManager::ObjectManager(coVRPlugin *plugin): materialList(NULL), coviseSG(n
 
     anzset = 0;
     depthPeeling = coCoviseConfig::isOn("COVER.DepthPeeling", false);
+    m_streamMinTimesteps = coCoviseConfig::getInt("minTimesteps", "COVER.Plugin.COVISE.StreamTimesteps", 0);
+    m_streamDrop = coCoviseConfig::isOn("drop", "COVER.Plugin.COVISE.StreamTimesteps", false);
+    m_backgroundMinElements = coCoviseConfig::getInt("minElements", "COVER.Plugin.COVISE.BackgroundBuild", 1000000);
 }
 
 ObjectManager::~ObjectManager()
 {
+    // waits for the builds still running
+    m_backgroundBuilds.clear();
+    for (auto &s: m_streamedSets)
+        delete s.second;
     delete coviseSG;
     if (cover->debugLevel(2))
         fprintf(stderr, "delete ObjectManager\n");
@@ -433,6 +446,47 @@ void ObjectManager::addObject(const char *object, const coDistributedObject *dat
             }
         }
     }
+
+    if (m_backgroundMinElements > 0 && coVRMSController::instance()->isCluster())
+    {
+        // objects are added on all nodes in the same order, so all of them
+        // know from here on whether attachBackgroundBuilds() has to sync
+        m_clusterBuildsPending = coVRMSController::instance()->allReduceOr(!m_backgroundBuilds.empty());
+    }
+}
+
+void ObjectManager::attachBackgroundBuilds()
+{
+    if (coVRMSController::instance()->isCluster())
+    {
+        if (!m_clusterBuildsPending)
+            return;
+        // master and slaves swap in their geometry in the same frame
+        bool done = true;
+        for (auto &b: m_backgroundBuilds)
+        {
+            if (b.second.node.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+                done = false;
+        }
+        if (!coVRMSController::instance()->allReduceAnd(done))
+            return;
+        m_clusterBuildsPending = false;
+    }
+
+    for (BackgroundBuilds::iterator it = m_backgroundBuilds.begin(); it != m_backgroundBuilds.end();)
+    {
+        if (it->second.node.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            ++it;
+            continue;
+        }
+        osg::ref_ptr<osg::Node> node = it->second.node.get();
+        if (node)
+            it->second.group->addChild(node);
+        else
+            std::cerr << "ObjectManager: no geometry for " << it->first << std::endl;
+        it = m_backgroundBuilds.erase(it);
+    }
 }
 
 coInteractor *ObjectManager::handleInteractors(CoviseRenderObject *container, CoviseRenderObject *geomObj, CoviseRenderObject *normObj, CoviseRenderObject *colorObj, CoviseRenderObject *texObj) const
@@ -535,6 +589,19 @@ void ObjectManager::deleteObject(const char *name, bool groupobject)
         }
     }
     removeGeometry(name, groupobject);
+    BackgroundBuilds::iterator build = m_backgroundBuilds.find(name);
+    if (build != m_backgroundBuilds.end())
+    {
+        // the worker thread reads the render object until it is done
+        build->second.node.wait();
+        m_backgroundBuilds.erase(build);
+    }
+    StreamedSets::iterator streamed = m_streamedSets.find(name);
+    if (streamed != m_streamedSets.end())
+    {
+        delete streamed->second;
+        m_streamedSets.erase(streamed);
+    }
 #ifdef PHANTOM_TRACKER
     if (feedbackList)
         feedbackList->removeData(name);
@@ -650,6 +717,256 @@ static int create_named_color(const char *cname)
     return rgba;
 }
 
+// binding of n normals or colors to an object with numFaces faces and numPoints points
+static int dataBinding(int n, int numFaces, int numPoints)
+{
+    if (numFaces > 0 && numFaces == n)
+        return Bind::PerFace;
+    else if (n >= numPoints)
+        return Bind::PerVertex;
+    else if (n > 1 && n >= numFaces)
+        return Bind::PerFace;
+    else if (n == 1)
+        return Bind::OverAll;
+    return Bind::None;
+}
+
+// color arrays of a data object, no_c = 0 for unsupported types
+static void getColors(CoviseRenderObject *colors, int &no_c, float *&rc, float *&gc, float *&bc, int *&pc, int &colorpacking)
+{
+    const char *ctype = colors->getType();
+    colors->getSize(no_c);
+    if (strcmp(ctype, "STRVDT") == 0 || strcmp(ctype, "USTVDT") == 0)
+    {
+        colors->getAddresses(rc, gc, bc);
+        colorpacking = Pack::None;
+    }
+    else if (strcmp(ctype, "USTSTD") == 0)
+    {
+        colors->getAddresses(rc, gc, bc);
+        bc = NULL;
+        colorpacking = Pack::None;
+    }
+    else if (strcmp(ctype, "RGBADT") == 0)
+    {
+        pc = colors->pc;
+        colorpacking = Pack::RGBA;
+    }
+    else if (strcmp(ctype, "STRSDT") == 0 || strcmp(ctype, "USTSDT") == 0)
+    {
+        colors->getAddresses(rc, gc, bc);
+        gc = NULL;
+        bc = NULL;
+        colorpacking = Pack::Float;
+    }
+    else
+    {
+        colorpacking = Pack::None;
+        no_c = 0;
+        print_comment(__LINE__, __FILE__, "ERROR: DataTypes other than structured and unstructured are not yet implemented");
+    }
+}
+
+// geometry of plain objects, called on worker threads: only reads the
+// render objects, ObjectManager::isStreamable() has made sure that no
+// attributes require the scene graph or other parts of COVER; the
+// GeometryManager only locks its shared caches, so the render thread keeps
+// building other objects concurrently
+static osg::ref_ptr<osg::Node> buildPlainGeometry(const char *name, CoviseRenderObject *geo, CoviseRenderObject *norm, CoviseRenderObject *col)
+{
+    const char *gtype = geo->getType();
+    int no_prim = 0, no_vert = 0, no_points = 0, no_faces = 0;
+    float *x_c = NULL, *y_c = NULL, *z_c = NULL;
+    int *v_l = NULL, *l_l = NULL;
+    if (strcmp(gtype, "POLYGN") == 0)
+    {
+        no_prim = no_faces = geo->getNumPolygons();
+        no_vert = geo->getNumVertices();
+        no_points = geo->getNumPoints();
+        geo->getAddresses(x_c, y_c, z_c, v_l, l_l);
+    }
+    else if (strcmp(gtype, "TRIANG") == 0)
+    {
+        no_prim = no_faces = geo->getNumStrips();
+        no_vert = geo->getNumVertices();
+        no_points = geo->getNumPoints();
+        geo->getAddresses(x_c, y_c, z_c, v_l, l_l);
+    }
+    else if (strcmp(gtype, "TRITRI") == 0 || strcmp(gtype, "QUADS") == 0)
+    {
+        no_vert = geo->getNumVertices();
+        no_faces = no_vert / (strcmp(gtype, "TRITRI") == 0 ? 3 : 4);
+        no_points = geo->getNumPoints();
+        geo->getAddresses(x_c, y_c, z_c, v_l);
+    }
+    else if (strcmp(gtype, "LINES") == 0)
+    {
+        no_prim = no_faces = geo->getNumLines();
+        no_vert = geo->getNumVertices();
+        no_points = geo->getNumPoints();
+        geo->getAddresses(x_c, y_c, z_c, v_l, l_l);
+    }
+    else if (strcmp(gtype, "POINTS") == 0)
+    {
+        no_points = geo->getNumPoints();
+        geo->getAddresses(x_c, y_c, z_c, v_l, l_l);
+    }
+
+    int no_n = 0, normalbinding = Bind::None;
+    float *xn = NULL, *yn = NULL, *zn = NULL;
+    if (norm)
+    {
+        norm->getSize(no_n);
+        norm->getAddresses(xn, yn, zn);
+        normalbinding = dataBinding(no_n, no_faces, no_points);
+    }
+
+    int no_c = 0, colorbinding = Bind::None, colorpacking = Pack::None;
+    float *rc = NULL, *gc = NULL, *bc = NULL;
+    int *pc = NULL;
+    if (col)
+    {
+        getColors(col, no_c, rc, gc, bc, pc, colorpacking);
+        if (no_c == 0)
+            colorpacking = Pack::None;
+        colorbinding = no_c == 0 ? Bind::None : dataBinding(no_c, no_faces, no_points);
+    }
+
+    const char *attr = geo->getAttribute("vertexOrder");
+    int vertexOrder = attr ? attr[0] - '0' : 0;
+    float transparency = 0.f;
+    if ((attr = geo->getAttribute("TRANSPARENCY")))
+        transparency = std::min(std::max(float(atof(attr)), 0.f), 1.f);
+    bool cullBackfaces = geo->getAttribute("CULL_BACKFACES") != NULL;
+    float pointsize = 2.f, linewidth = 2.f;
+    if ((attr = geo->getAttribute("POINTSIZE")))
+        pointsize = atof(attr);
+    if ((attr = geo->getAttribute("LINEWIDTH")))
+        linewidth = atof(attr);
+
+    const osg::Texture::WrapMode wm = osg::Texture::CLAMP_TO_EDGE;
+    const osg::Texture::FilterMode fm = osg::Texture::NEAREST;
+    GeometryManager *gm = GeometryManager::instance();
+    osg::Node *node = NULL;
+    if (strcmp(gtype, "POLYGN") == 0)
+        node = gm->addPolygon(name, no_prim, no_vert, no_points, x_c, y_c, z_c, v_l, l_l,
+                              no_c, colorbinding, colorpacking, rc, gc, bc, pc,
+                              no_n, normalbinding, xn, yn, zn, transparency, vertexOrder, NULL,
+                              0, 0, 0, NULL, 0, NULL, NULL, wm, fm, fm, 0, NULL, NULL, NULL, cullBackfaces);
+    else if (strcmp(gtype, "TRIANG") == 0)
+        node = gm->addTriangleStrip(name, no_prim, no_vert, no_points, x_c, y_c, z_c, v_l, l_l,
+                                    no_c, colorbinding, colorpacking, rc, gc, bc, pc,
+                                    no_n, normalbinding, xn, yn, zn, transparency, vertexOrder, NULL,
+                                    0, 0, 0, NULL, 0, NULL, NULL, wm, fm, fm, 0, NULL, NULL, NULL, cullBackfaces);
+    else if (strcmp(gtype, "TRITRI") == 0 || strcmp(gtype, "QUADS") == 0)
+        node = gm->addTriangles(name, no_vert, no_points, x_c, y_c, z_c, v_l,
+                                no_c, colorbinding, colorpacking, rc, gc, bc, pc,
+                                no_n, normalbinding, xn, yn, zn, transparency, vertexOrder, NULL,
+                                0, 0, 0, NULL, 0, NULL, NULL, wm, fm, fm, 0, NULL, NULL, NULL, cullBackfaces);
+    else if (strcmp(gtype, "LINES") == 0)
+        node = gm->addLine(name, no_prim, no_vert, no_points, x_c, y_c, z_c, v_l, l_l,
+                           no_c, colorbinding, colorpacking, rc, gc, bc, pc,
+                           no_n, normalbinding, xn, yn, zn, false, NULL,
+                           0, 0, 0, NULL, 0, NULL, NULL, wm, fm, fm, linewidth);
+    else if (strcmp(gtype, "POINTS") == 0)
+        node = gm->addPoint(name, no_points, x_c, y_c, z_c,
+                            no_c, colorbinding, colorpacking, rc, gc, bc, pc, NULL,
+                            0, 0, 0, NULL, 0, NULL, NULL, wm, fm, fm, pointsize);
+    return node;
+}
+
+//----------------------------------------------------------------
+// timestep sets streamed by a coVRStreamingSequence
+//----------------------------------------------------------------
+struct ObjectManager::StreamedSet
+{
+    std::vector<CoviseRenderObject *> geometry, normals, colors;
+    coVRStreamingSequence *sequence;
+
+    StreamedSet(const char *object, int no_elems, bool drop,
+                CoviseRenderObject *const *geo, CoviseRenderObject *const *norm, CoviseRenderObject *const *col)
+    : geometry(geo, geo + no_elems)
+    {
+        if (norm)
+            normals.assign(norm, norm + no_elems);
+        if (col)
+            colors.assign(col, col + no_elems);
+        // the loader threads must not create the singleton
+        GeometryManager::instance();
+        sequence = new coVRStreamingSequence(no_elems, [this](int t) { return build(t); });
+        sequence->setPolicy(drop ? coVRStreamingSequence::Drop : coVRStreamingSequence::Wait);
+        sequence->getNode()->setName(object);
+    }
+
+    ~StreamedSet()
+    {
+        coVRAnimationManager::instance()->removeStreamingSequence(sequence);
+        // stops the loader threads before their render objects go away
+        delete sequence;
+        for (auto ro: geometry)
+            delete ro;
+        for (auto ro: normals)
+            delete ro;
+        for (auto ro: colors)
+            delete ro;
+    }
+
+    // geometry of timestep t, called on the loader threads
+    osg::ref_ptr<osg::Node> build(int t) const
+    {
+        return buildPlainGeometry(geometry[t]->getName(), geometry[t], normals.empty() ? NULL : normals[t], colors.empty() ? NULL : colors[t]);
+    }
+};
+
+// whether the elements of a timestep set can be built on the loader threads
+// of a coVRStreamingSequence or a single object on a worker thread: plain geometry with optional normals and
+// colors that needs neither plugins, interactors, shaders nor the scene graph
+bool ObjectManager::isStreamable(CoviseRenderObject *container, int no_elems,
+                                 CoviseRenderObject *const *geo, CoviseRenderObject *const *norm, CoviseRenderObject *const *col) const
+{
+    static const char *const geometryTypes[] = { "POLYGN", "TRIANG", "TRITRI", "QUADS", "LINES", "POINTS" };
+    static const char *const mainThreadAttributes[] = {
+        "BOUNDING_BOX", "CAD_FILE", "COLOR", "DEPTH_ONLY", "FEEDBACK", "FRAME_ANGLE", "INTERACTOR",
+        "LABEL", "LOD", "MATERIAL", "MENU", "MODEL_FILE", "MODULE", "MULTIROT", "PLUGIN",
+        "POLYGON_OFFSET", "RESIZE_OBJECT", "ROTANGLE_OBJECT", "ROTATE_ANGLE", "ROTATE_OBJECT",
+        "ROTATE_POINT", "ROTATE_SPEED", "ROTATE_VECTOR", "ROTATION_AXIS", "ROTATION_POINT", "SCALE",
+        "SCENEGRAPHITEMS_STARTINDEX", "SHADER", "SLIDER", "TRANSLATE_OBJECT", "UNIFORMS", "VARIANT"
+    };
+    auto plain = [](CoviseRenderObject *ro)
+    {
+        for (size_t i = 0; i < ro->getNumAttributes(); ++i)
+        {
+            for (const char *a: mainThreadAttributes)
+            {
+                if (strcmp(ro->getAttributeName(i), a) == 0)
+                    return false;
+            }
+        }
+        return true;
+    };
+
+    if (container->getAttribute("SHADER") || container->getAttribute("DEPTH_ONLY") || container->getAttribute("VARIANT"))
+        return false;
+    for (int i = 0; i < no_elems; ++i)
+    {
+        if (!geo[i]->isAssignedToMe() || !plain(geo[i]))
+            return false;
+        if (std::find_if(std::begin(geometryTypes), std::end(geometryTypes), [&](const char *t)
+                         { return strcmp(geo[i]->getType(), t) == 0; }) == std::end(geometryTypes))
+            return false;
+        if (norm && !plain(norm[i]))
+            return false;
+        if (col)
+        {
+            // scalar colors are mapped by the shader of their color map
+            const char *ctype = col[i]->getType();
+            if (strcmp(ctype, "STRSDT") == 0 || strcmp(ctype, "USTSDT") == 0 || !plain(col[i]))
+                return false;
+        }
+    }
+    return true;
+}
+
 //----------------------------------------------------------------
 //
 //----------------------------------------------------------------
@@ -686,6 +1003,7 @@ void ObjectManager::addColorMap(const char *object, CoviseRenderObject *cmap)
 osg::Node *ObjectManager::addGeometry(const char *object, osg::Group *root, CoviseRenderObject *geometry,
                                       CoviseRenderObject *normals, CoviseRenderObject *colors, CoviseRenderObject *texture, CoviseRenderObject *vertexAttribute, CoviseRenderObject *container, const char *lod)
 {
+    coTraceScope trace("GeometryManager", "renderer");
     CoviseRenderObject *const *dobjsg = NULL; // Geometry Set elements
     CoviseRenderObject *const *dobjsc = NULL; // Color Set elements
     CoviseRenderObject *const *dobjsn = NULL; // Normal Set elements
@@ -1223,14 +1541,27 @@ osg::Node *ObjectManager::addGeometry(const char *object, osg::Group *root, Covi
             CoviseBase::sendInfo("timesteps <=1 --> static");
         }
         osg::Group* groupNode = nullptr;
-        if (container->isAssignedToMe())
+        StreamedSet *streamed = nullptr;
+        if (is_animation && container->isAssignedToMe() && m_streamMinTimesteps > 0 && no_elems >= m_streamMinTimesteps
+            && no_t == 0 && no_va == 0 && !geometry->getAttribute("MULTIROT")
+            && isStreamable(container, no_elems, dobjsg, no_n > 0 ? dobjsn : NULL, no_c > 0 ? dobjsc : NULL))
+        {
+            // the streamed set owns the element render objects from now on
+            streamed = new StreamedSet(object, no_elems, m_streamDrop, dobjsg, no_n > 0 ? dobjsn : NULL, no_c > 0 ? dobjsc : NULL);
+            delete m_streamedSets[object];
+            m_streamedSets[object] = streamed;
+            groupNode = streamed->sequence->getNode();
+            if (coVRMSController::instance()->isMaster())
+                CoviseBase::sendInfo("Streaming the sequence: %d timesteps", no_elems);
+        }
+        else if (container->isAssignedToMe())
         {
             groupNode = GeometryManager::instance()->addGroup(object, is_animation);
-            if (cur_rotator)
-            {
-                cur_rotator->node = groupNode;
-                RotatorList::instance()->append(cur_rotator);
-            }
+        }
+        if (groupNode && cur_rotator)
+        {
+            cur_rotator->node = groupNode;
+            RotatorList::instance()->append(cur_rotator);
         }
         anzset++;
         for (int i = 0; i < no_elems; i++)
@@ -1239,6 +1570,8 @@ osg::Node *ObjectManager::addGeometry(const char *object, osg::Group *root, Covi
             objName = buf;
             elemnames[curset][i] = new char[strlen(objName) + 1];
             strcpy(elemnames[curset][i], objName);
+            if (streamed)
+                continue;
 
             //std::cerr << "ObjectManager::addGeometry info: calling addGeometry for " << objName << " (" << i << ")" << std::endl;
             osg::Node *node = addGeometry(objName, groupNode, dobjsg[i],
@@ -1312,6 +1645,10 @@ osg::Node *ObjectManager::addGeometry(const char *object, osg::Group *root, Covi
             //std::cerr << "setting interactor user data on Group " << groupNode->getName() << std::endl;
             groupNode->setUserData(new InteractorReference(inter));
         }
+        if (streamed)
+        {
+            coVRAnimationManager::instance()->addStreamingSequence(streamed->sequence);
+        }
         if (groupNode)
         {
             if (osg::Sequence * pSequence = dynamic_cast<osg::Sequence*>(groupNode)) // timesteps
@@ -1442,18 +1779,7 @@ osg::Node *ObjectManager::addGeometry(const char *object, osg::Group *root, Covi
         {
             normals->getSize(no_n);
             normals->getAddresses(xn, yn, zn);
-
-            /// now get this attribute junk done
-            if (no_faces > 0 && no_faces == no_n)
-                normalbinding = Bind::PerFace;
-            else if (no_n >= no_points)
-                normalbinding = Bind::PerVertex;
-            else if (no_n > 1 && no_n >= no_faces)
-                normalbinding = Bind::PerFace;
-            else if (no_n == 1)
-                normalbinding = Bind::OverAll;
-            else
-                normalbinding = Bind::None;
+            normalbinding = dataBinding(no_n, no_faces, no_points);
         }
 
         if (vertexAttribute)
@@ -1489,75 +1815,10 @@ osg::Node *ObjectManager::addGeometry(const char *object, osg::Group *root, Covi
         if (colors && (!texture || vertexAttribute != NULL))
         {
 
-            colors->getSize(no_c);
-            ctype = colors->getType();
-            if (strcmp(ctype, "STRVDT") == 0)
-            {
-                colors->getSize(no_c);
-                colors->getAddresses(rc, gc, bc);
-                colorpacking = Pack::None;
-            }
-            else if (strcmp(ctype, "USTSTD") == 0)
-            {
-                colors->getSize(no_c);
-                colors->getAddresses(rc, gc, bc);
-                bc = NULL;
-                colorpacking = Pack::None;
-            }
-            else if (strcmp(ctype, "USTVDT") == 0)
-            {
-                colors->getSize(no_c);
-                colors->getAddresses(rc, gc, bc);
-                colorpacking = Pack::None;
-            }
-            else if (strcmp(ctype, "RGBADT") == 0)
-            {
-                colors->getSize(no_c);
-                pc = colors->pc;
-                colorpacking = Pack::RGBA;
-            }
-            else if (strcmp(ctype, "STRSDT") == 0)
-            {
-                colors->getSize(no_c);
-                colors->getAddresses(rc, gc, bc);
-                gc = NULL;
-                bc = NULL;
-                colorpacking = Pack::Float;
-            }
-            else if (strcmp(ctype, "USTSDT") == 0)
-            {
-                colors->getSize(no_c);
-                colors->getAddresses(rc, gc, bc);
-                gc = NULL;
-                bc = NULL;
-                colorpacking = Pack::Float;
-            }
-            else
-            {
-                colorbinding = Bind::None;
-                colorpacking = Pack::None;
-                no_c = 0;
-                print_comment(__LINE__, __FILE__, "ERROR: DataTypes other than structured and unstructured are not yet implemented");
-                //   sendError("ERROR: DataTypes other than structured and unstructured are not jet implemented");
-            }
-
-            /// now get this attribute junk done
+            getColors(colors, no_c, rc, gc, bc, pc, colorpacking);
             if (no_c == 0)
-            {
-                // sendWarning("WARNING: Data object 'Color' is empty");
-                colorbinding = Bind::None;
                 colorpacking = Pack::None;
-            }
-            else if (no_faces > 0 && no_faces == no_c)
-                colorbinding = Bind::PerFace;
-            else if (no_c >= no_points)
-                colorbinding = Bind::PerVertex;
-            else if (no_c > 1 && no_c >= no_faces)
-                colorbinding = Bind::PerFace;
-            else if (no_c == 1)
-                colorbinding = Bind::OverAll;
-            else
-                colorbinding = Bind::None;
+            colorbinding = no_c == 0 ? Bind::None : dataBinding(no_c, no_faces, no_points);
         }
         else //if(container==NULL) // we got an object without colors
         {
@@ -1599,7 +1860,22 @@ osg::Node *ObjectManager::addGeometry(const char *object, osg::Group *root, Covi
 
         if (!skipGeometryCreation)
         {
-            if (strcmp(gtype, "UNIGRD") == 0)
+            RenderObjectMap::iterator top = m_roMap.find(object);
+            if (m_backgroundMinElements > 0 && std::max(no_vert, no_points) >= m_backgroundMinElements
+                && top != m_roMap.end() && top->second == container && !texture && !vertexAttribute
+                && isStreamable(container, 1, &geometry, normals ? &normals : NULL, colors ? &colors : NULL))
+            {
+                // an empty group stands in for the geometry until it is attached in preFrame,
+                // the render objects stay in m_roMap until deleteObject() has waited for the build
+                BackgroundBuild &build = m_backgroundBuilds[object];
+                build.group = new osg::Group;
+                build.group->setName(object);
+                std::string name(object);
+                build.node = std::async(std::launch::async, [name, geometry, normals, colors]()
+                                        { return buildPlainGeometry(name.c_str(), geometry, normals, colors); });
+                newNode = build.group.get();
+            }
+            else if (strcmp(gtype, "UNIGRD") == 0)
             {
                 newNode = GeometryManager::instance()->addUGrid(object, xsize, ysize, zsize, xmin, xmax, ymin, ymax, zmin, zmax,
                                                                 no_c, colorbinding, colorpacking, rc, gc, bc, pc,
@@ -26,8 +26,10 @@
 
 #include <osg/Matrix>
 #include <osg/ColorMask>
+#include <osg/Group>
 
 #include <util/coMaterial.h>
+#include <future>
 #include <map>
 
 #define MAXSETS 8000
@@ -53,6 +55,7 @@ namespace opencover
 class coVRShader;
 class coInteractor;
 class coVRPlugin;
+class coVRStreamingSequence;
 
 struct ColorMap
 {
@@ -121,6 +124,30 @@ private:
 
     typedef std::map<std::string, CoviseRenderObject *> RenderObjectMap;
     RenderObjectMap m_roMap;
+
+    // timestep sets with at least m_streamMinTimesteps elements only get the
+    // geometry of the timesteps around the current one, built on the loader
+    // threads of a coVRStreamingSequence (COVER.Plugin.COVISE.StreamTimesteps)
+    struct StreamedSet;
+    typedef std::map<std::string, StreamedSet *> StreamedSets;
+    StreamedSets m_streamedSets;
+    int m_streamMinTimesteps;
+    bool m_streamDrop;
+    bool isStreamable(CoviseRenderObject *container, int no_elems,
+                      CoviseRenderObject *const *geo, CoviseRenderObject *const *norm, CoviseRenderObject *const *col) const;
+
+    // objects with at least m_backgroundMinElements vertices are built on a
+    // worker thread, their geometry is attached to an empty group in preFrame
+    // (COVER.Plugin.COVISE.BackgroundBuild)
+    struct BackgroundBuild
+    {
+        osg::ref_ptr<osg::Group> group;
+        std::future<osg::ref_ptr<osg::Node>> node;
+    };
+    typedef std::map<std::string, BackgroundBuild> BackgroundBuilds;
+    BackgroundBuilds m_backgroundBuilds;
+    int m_backgroundMinElements;
+    bool m_clusterBuildsPending = false; // some node of the cluster has builds in progress
     coVRPlugin *m_plugin = nullptr;
 
 public:
@@ -133,6 +160,8 @@ public:
     void coviseError(const char *error);
 
     void update(void);
+    //! attach the geometry that has been built in the background
+    void attachBackgroundBuilds();
 };
 }
 #endif
@@ -63,6 +63,12 @@
 #include <PluginUtil/Tipsify.h>
 #include <cover/RenderObject.h>
 #include <do/coDoData.h>
+#include <util/coThreadPool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
 
 #include <osg/Program>
 #include <osg/Shader>
@@ -98,6 +104,295 @@ inline osg::Vec4 getColor(bool *transparent, int idx, int colorpacking, const in
     }
 }
 
+// the arrays of large objects are filled by the threads of coThreadPool,
+// each of them working on a range of at least this many elements
+static const size_t MinParallelRange = 16384;
+
+// call body(begin, end) for consecutive ranges covering [0, n)
+template <class Body>
+static void forRanges(size_t n, Body body)
+{
+    coThreadPool &pool = coThreadPool::global();
+    size_t numRanges = std::min((n + MinParallelRange - 1) / MinParallelRange, 4 * (size_t)pool.numThreads());
+    if (numRanges <= 1 || pool.numThreads() < 2)
+    {
+        body(size_t(0), n);
+        return;
+    }
+    pool.run(numRanges, [&](size_t i, int)
+             {
+                 body(n * i / numRanges, n * (i + 1) / numRanges);
+             });
+}
+
+// n vectors interleaved from x, y and z, indirectly through idx if it is not NULL
+static osg::Vec3Array *makeVec3Array(size_t n, const int *idx, const float *x, const float *y, const float *z, bool normalize = false)
+{
+    osg::Vec3Array *arr = new osg::Vec3Array(n);
+    if (n == 0)
+        return arr;
+    osg::Vec3 *out = &(*arr)[0];
+    forRanges(n, [&](size_t begin, size_t end)
+              {
+                  for (size_t i = begin; i < end; ++i)
+                  {
+                      size_t v = idx ? idx[i] : i;
+                      out[i].set(x[v], y[v], z[v]);
+                      if (normalize)
+                          out[i].normalize();
+                  }
+              });
+    return arr;
+}
+
+static osg::Vec2Array *makeVec2Array(size_t n, const int *idx, const float *x, const float *y)
+{
+    osg::Vec2Array *arr = new osg::Vec2Array(n);
+    if (n == 0)
+        return arr;
+    osg::Vec2 *out = &(*arr)[0];
+    forRanges(n, [&](size_t begin, size_t end)
+              {
+                  for (size_t i = begin; i < end; ++i)
+                  {
+                      size_t v = idx ? idx[i] : i;
+                      out[i].set(x[v], y[v]);
+                  }
+              });
+    return arr;
+}
+
+static osg::FloatArray *makeFloatArray(size_t n, const int *idx, const float *r)
+{
+    osg::FloatArray *arr = new osg::FloatArray(n);
+    if (n == 0)
+        return arr;
+    float *out = &(*arr)[0];
+    forRanges(n, [&](size_t begin, size_t end)
+              {
+                  for (size_t i = begin; i < end; ++i)
+                      out[i] = r[idx ? idx[i] : i];
+              });
+    return arr;
+}
+
+// n colors, indirectly through idx if it is not NULL;
+// *transparent is set if one of them is translucent
+static osg::Vec4Array *makeColorArray(size_t n, const int *idx, bool *transparent, int colorpacking, const int *pc,
+                                      const float *r, const float *g, const float *b, float transparency = 0.f)
+{
+    osg::Vec4Array *arr = new osg::Vec4Array(n);
+    if (n == 0)
+        return arr;
+    osg::Vec4 *out = &(*arr)[0];
+    std::atomic<bool> anyTransparent(false);
+    forRanges(n, [&](size_t begin, size_t end)
+              {
+                  bool trans = false;
+                  for (size_t i = begin; i < end; ++i)
+                      out[i] = getColor(&trans, idx ? idx[i] : (int)i, colorpacking, pc, r, g, b, transparency);
+                  if (trans)
+                      anyTransparent = true;
+              });
+    if (anyTransparent)
+        *transparent = true;
+    return arr;
+}
+
+// one value per face repeated for its corners: face i covers the elements
+// [start(i), start(i + 1)) of out, which has to hold start(numFaces) elements
+template <class T, class Start, class Value>
+static void fillPerFace(T *out, size_t numFaces, Start start, Value value)
+{
+    forRanges(numFaces, [&](size_t begin, size_t end)
+              {
+                  for (size_t i = begin; i < end; ++i)
+                  {
+                      T val = value(i);
+                      for (size_t k = start(i); k < start(i + 1); ++k)
+                          out[k] = val;
+                  }
+              });
+}
+
+// kinds of shared data, part of the key in GeometryManager::sharedData
+enum SharedTag
+{
+    SharedVertices, // coordinates
+    SharedCornerVertices, // coordinates of the corners of an index list
+    SharedNormals,
+    SharedCornerNormals,
+    SharedFans, // triangle fans of polygons
+    SharedSegments, // segments of line strips
+};
+
+template <class T>
+static std::pair<const void *, size_t> span(const T *data, size_t n)
+{
+    return std::make_pair((const void *)data, n * sizeof(T));
+}
+
+static inline uint64_t hashMix(uint64_t h, uint64_t v)
+{
+    v *= 0x87c37b91114253d5ull;
+    v = (v << 31) | (v >> 33);
+    v *= 0x4cf5ad432745937full;
+    h ^= v;
+    h = (h << 27) | (h >> 37);
+    return h * 5 + 0x52dce729;
+}
+
+// 64 bit hash of the contents of the arrays: large arrays are hashed in
+// parallel in chunks of a fixed size, so that the result does not depend
+// on the number of threads
+static uint64_t contentHash(int tag, std::initializer_list<std::pair<const void *, size_t>> arrays)
+{
+    const size_t ChunkSize = 1 << 20;
+    uint64_t h = hashMix(0x9e3779b97f4a7c15ull, tag);
+    for (const auto &a : arrays)
+    {
+        const char *data = static_cast<const char *>(a.first);
+        size_t numChunks = (a.second + ChunkSize - 1) / ChunkSize;
+        std::vector<uint64_t> chunkHash(numChunks);
+        auto hashChunk = [&](size_t c, int)
+        {
+            const char *p = data + c * ChunkSize;
+            size_t bytes = std::min(ChunkSize, a.second - c * ChunkSize);
+            uint64_t ch = hashMix(0, c);
+            size_t i = 0;
+            for (; i + sizeof(uint64_t) <= bytes; i += sizeof(uint64_t))
+            {
+                uint64_t v;
+                memcpy(&v, p + i, sizeof(v));
+                ch = hashMix(ch, v);
+            }
+            if (i < bytes)
+            {
+                uint64_t v = 0;
+                memcpy(&v, p + i, bytes - i);
+                ch = hashMix(ch, v);
+            }
+            chunkHash[c] = ch;
+        };
+        if (numChunks > 1)
+            coThreadPool::global().run(numChunks, hashChunk);
+        else if (numChunks == 1)
+            hashChunk(0, 0);
+        h = hashMix(h, a.second);
+        for (uint64_t ch : chunkHash)
+            h = hashMix(h, ch);
+    }
+    return h;
+}
+
+template <class T, class Build>
+osg::ref_ptr<T> GeometryManager::shared(bool share, int tag, std::initializer_list<std::pair<const void *, size_t>> arrays, Build build)
+{
+    if (!share || !shareGeometry)
+        return build();
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t key = contentHash(tag, arrays);
+    double hashMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    bool collision = false;
+    {
+        std::lock_guard<std::mutex> guard(sharedMutex);
+        sharedSavedMs -= hashMs;
+        auto it = sharedData.find(key);
+        if (it != sharedData.end())
+        {
+            collision = !sameSource(it->second, tag, arrays);
+            if (T *data = collision ? NULL : dynamic_cast<T *>(it->second.data.get()))
+            {
+                it->second.lastUse = ++sharedUse;
+                sharedSavedBytes += it->second.bytes;
+                sharedSavedMs += it->second.buildMs;
+                return data;
+            }
+        }
+    }
+
+    // built without holding the lock, equal data built concurrently by
+    // another thread is not shared
+    start = std::chrono::steady_clock::now();
+    osg::ref_ptr<T> data = build();
+    double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (collision)
+        return data;
+
+    std::lock_guard<std::mutex> guard(sharedMutex);
+    pruneShared();
+    auto inserted = sharedData.emplace(key, SharedData());
+    if (!inserted.second)
+        return data;
+    SharedData &entry = inserted.first->second;
+    entry.data = data.get();
+    entry.tag = tag;
+    for (const auto &a : arrays)
+    {
+        entry.sizes.push_back(a.second);
+        const char *p = static_cast<const char *>(a.first);
+        entry.source.insert(entry.source.end(), p, p + a.second);
+    }
+    entry.bytes = data->getTotalDataSize();
+    entry.buildMs = buildMs;
+    entry.lastUse = ++sharedUse;
+    return data;
+}
+
+bool GeometryManager::sameSource(const SharedData &entry, int tag, std::initializer_list<std::pair<const void *, size_t>> arrays)
+{
+    if (entry.tag != tag || entry.sizes.size() != arrays.size())
+        return false;
+    size_t offset = 0, i = 0;
+    for (const auto &a : arrays)
+    {
+        if (entry.sizes[i++] != a.second)
+            return false;
+        if (a.second > 0 && memcmp(entry.source.data() + offset, a.first, a.second) != 0)
+            return false;
+        offset += a.second;
+    }
+    return true;
+}
+
+// drop the least recently used data that is not part of a node any more
+// as soon as it takes more than sharedCacheBytes, called with sharedMutex held
+void GeometryManager::pruneShared()
+{
+    size_t unused = 0;
+    std::vector<std::pair<unsigned, uint64_t>> candidates;
+    for (const auto &e : sharedData)
+    {
+        if (e.second.data->referenceCount() == 1)
+        {
+            unused += e.second.bytes + e.second.source.size();
+            candidates.emplace_back(e.second.lastUse, e.first);
+        }
+    }
+    if (unused <= sharedCacheBytes)
+        return;
+    std::sort(candidates.begin(), candidates.end());
+    for (const auto &c : candidates)
+    {
+        if (unused <= sharedCacheBytes)
+            break;
+        auto it = sharedData.find(c.second);
+        unused -= it->second.bytes + it->second.source.size();
+        sharedData.erase(it);
+    }
+}
+
+void GeometryManager::takeSharingStats(size_t &bytes, double &ms)
+{
+    std::lock_guard<std::mutex> guard(sharedMutex);
+    bytes = sharedSavedBytes;
+    ms = sharedSavedMs;
+    sharedSavedBytes = 0;
+    sharedSavedMs = 0.;
+}
+
 GeometryManager *GeometryManager::instance()
 {
     static GeometryManager *singleton = NULL;
@@ -112,15 +407,32 @@ GeometryManager::GeometryManager()
 
     d_kdtreeBuilder = new osg::KdTreeBuilder;
 
+    globalDefaultMaterial = new osg::Material;
+    globalDefaultMaterial->setColorMode(osg::Material::AMBIENT_AND_DIFFUSE);
+    globalDefaultMaterial->setAmbient(osg::Material::FRONT_AND_BACK, osg::Vec4(0.2f, 0.2f, 0.2f, 1.0));
+    globalDefaultMaterial->setDiffuse(osg::Material::FRONT_AND_BACK, osg::Vec4(1.0f, 1.0f, 1.0f, 1.0));
+    globalDefaultMaterial->setSpecular(osg::Material::FRONT_AND_BACK, osg::Vec4(0.4f, 0.4f, 0.4f, 1.0));
+    globalDefaultMaterial->setEmission(osg::Material::FRONT_AND_BACK, osg::Vec4(0.0f, 0.0f, 0.0f, 1.0));
+    globalDefaultMaterial->setShininess(osg::Material::FRONT_AND_BACK, 16.0f);
+
     float r = coCoviseConfig::getFloat("r", "COVER.CoviseGeometryDefaultColor", 1.0f);
     float g = coCoviseConfig::getFloat("g", "COVER.CoviseGeometryDefaultColor", 1.0f);
     float b = coCoviseConfig::getFloat("b", "COVER.CoviseGeometryDefaultColor", 1.0f);
     coviseGeometryDefaultColor = osg::Vec4(r, g, b, 1.0f);
+
+    shareGeometry = coCoviseConfig::isOn("COVER.Plugin.COVISE.ShareGeometry", true);
+    sharedCacheBytes = (size_t)coCoviseConfig::getInt("COVER.Plugin.COVISE.ShareGeometryCacheMB", 256) << 20;
 }
 GeometryManager::~GeometryManager()
 {
 }
 
+void GeometryManager::buildKdTree(osg::Geometry *geom)
+{
+    osg::ref_ptr<osg::KdTreeBuilder> builder = d_kdtreeBuilder->clone();
+    builder->apply(*geom);
+}
+
 osg::Group *
 GeometryManager::addGroup(const char *object, bool is_timestep)
 {
@@ -701,17 +1013,6 @@ GeometryManager::addSGrid(const char *object,
 
 void GeometryManager::setDefaultMaterial(osg::StateSet *geoState, bool transparent, coMaterial *material, bool isLightingOn)
 {
-    if (globalDefaultMaterial.get() == NULL)
-    {
-        globalDefaultMaterial = new osg::Material;
-        globalDefaultMaterial->setColorMode(osg::Material::AMBIENT_AND_DIFFUSE);
-        globalDefaultMaterial->setAmbient(osg::Material::FRONT_AND_BACK, osg::Vec4(0.2f, 0.2f, 0.2f, 1.0));
-        globalDefaultMaterial->setDiffuse(osg::Material::FRONT_AND_BACK, osg::Vec4(1.0f, 1.0f, 1.0f, 1.0));
-        globalDefaultMaterial->setSpecular(osg::Material::FRONT_AND_BACK, osg::Vec4(0.4f, 0.4f, 0.4f, 1.0));
-        globalDefaultMaterial->setEmission(osg::Material::FRONT_AND_BACK, osg::Vec4(0.0f, 0.0f, 0.0f, 1.0));
-        globalDefaultMaterial->setShininess(osg::Material::FRONT_AND_BACK, 16.0f);
-    }
-
     if (material)
     {
         osg::Material *mymtl = new osg::Material;
@@ -726,6 +1027,7 @@ void GeometryManager::setDefaultMaterial(osg::StateSet *geoState, bool transpare
     }
     else
     {
+        std::lock_guard<std::mutex> guard(stateMutex);
         geoState->setAttributeAndModes(globalDefaultMaterial.get(), osg::StateAttribute::ON);
     }
 
@@ -807,59 +1109,75 @@ GeometryManager::addPolygon(const char *object_name,
     cover->setRenderStrategy(geom);
 
     // set up geometry
-    osg::Vec3Array *vert = new osg::Vec3Array;
+    // the corners of all polygons are v_l[i_l[0]], ..., v_l[no_of_vertices-1],
+    // polygon i consists of the corners [start(i), start(i + 1))
+    const int *corners = v_l + i_l[0];
+    const size_t no_of_corners = no_of_vertices - i_l[0];
+    auto start = [&](size_t i) -> size_t
+    {
+        return (i < (size_t)no_of_polygons ? i_l[i] : no_of_vertices) - i_l[0];
+    };
+
+    // without normals, the smoothing below changes the arrays of geom
+    const bool share = no_of_normals > 0;
+
+    osg::ref_ptr<osg::Vec3Array> vert;
     if (indexed)
     {
-        for (int i=0; i<no_of_coords; ++i)
-        {
-            vert->push_back(osg::Vec3(x_c[i], y_c[i], z_c[i]));
-        }
+        vert = shared<osg::Vec3Array>(share, SharedVertices, { span(x_c, no_of_coords), span(y_c, no_of_coords), span(z_c, no_of_coords) }, [&]()
+                                      {
+                                          return makeVec3Array(no_of_coords, NULL, x_c, y_c, z_c);
+                                      });
 
-        osg::DrawElementsUInt *primitives = new osg::DrawElementsUInt(osg::PrimitiveSet::TRIANGLES);
-        for (int i = 0; i < no_of_polygons; i++)
+        auto makeFans = [&]()
         {
-            int numv;
-            int base = i_l[i];
-            if (i == no_of_polygons - 1)
-                numv = no_of_vertices - base;
-            else
-                numv = i_l[i + 1] - base;
-
-            if (numv < 3)
-                continue;
+            // the polygons are split into triangle fans, the first triangle of
+            // polygon i being firstTri[i]
+            std::vector<size_t> firstTri(no_of_polygons + 1, 0);
+            for (int i = 0; i < no_of_polygons; i++)
+            {
+                int numv = (int)(start(i + 1) - start(i));
+                firstTri[i + 1] = firstTri[i] + (numv < 3 ? 0 : numv - 2);
+            }
 
-            int vbase = v_l[base];
-            for (int t=0; t<=numv-3; ++t)
+            osg::DrawElementsUInt *primitives = new osg::DrawElementsUInt(osg::PrimitiveSet::TRIANGLES, 3 * firstTri[no_of_polygons]);
+            if (firstTri[no_of_polygons] > 0)
             {
-                primitives->push_back(vbase);
-                for (int n = 1; n < 3; n++)
-                {
-                    primitives->push_back(v_l[base + n + t]);
-                }
+                GLuint *tri = &(*primitives)[0];
+                forRanges(no_of_polygons, [&](size_t begin, size_t end)
+                          {
+                              for (size_t i = begin; i < end; ++i)
+                              {
+                                  const int *poly = corners + start(i);
+                                  GLuint *out = tri + 3 * firstTri[i];
+                                  for (size_t t = 0; t < firstTri[i + 1] - firstTri[i]; ++t)
+                                  {
+                                      *out++ = poly[0];
+                                      *out++ = poly[t + 1];
+                                      *out++ = poly[t + 2];
+                                  }
+                              }
+                          });
+                if (share)
+                    tipsify(tri, primitives->size());
             }
-        }
-        geom->addPrimitiveSet(primitives);
+            return primitives;
+        };
+        geom->addPrimitiveSet(shared<osg::DrawElementsUInt>(share, SharedFans, { span(corners, no_of_corners), span(i_l, no_of_polygons) }, makeFans));
     }
     else
     {
-        osg::DrawArrayLengths *primitives = new osg::DrawArrayLengths(osg::PrimitiveSet::POLYGON);
+        vert = shared<osg::Vec3Array>(share, SharedCornerVertices, { span(x_c, no_of_coords), span(y_c, no_of_coords), span(z_c, no_of_coords), span(corners, no_of_corners) }, [&]()
+                                      {
+                                          return makeVec3Array(no_of_corners, corners, x_c, y_c, z_c);
+                                      });
+
+        osg::DrawArrayLengths *primitives = new osg::DrawArrayLengths(osg::PrimitiveSet::POLYGON, 0, no_of_polygons);
         for (int i = 0; i < no_of_polygons; i++)
-        {
-            int numv;
-            if (i == no_of_polygons - 1)
-                numv = no_of_vertices - i_l[i];
-            else
-                numv = i_l[i + 1] - i_l[i];
-            primitives->push_back(numv);
-            for (int n = 0; n < numv; n++)
-            {
-                int v = v_l[i_l[i] + n];
-                vert->push_back(osg::Vec3(x_c[v], y_c[v], z_c[v]));
-            }
-        }
+            (*primitives)[i] = (GLsizei)(start(i + 1) - start(i));
         geom->addPrimitiveSet(primitives);
     }
-    geom->setVertexArray(vert);
+    geom->setVertexArray(vert.get());
 
     // associate colors
     bool transparent = false;
@@ -868,35 +1186,18 @@ GeometryManager::addPolygon(const char *object_name,
         if (colorpacking == Pack::Float)
         {
             int attribIdx = 0;
-            osg::FloatArray *dataArr = new osg::FloatArray();
+            osg::FloatArray *dataArr = NULL;
+            if (colorbinding != Bind::PerVertex)
+                dataArr = new osg::FloatArray();
+            else if (indexed)
+                dataArr = makeFloatArray(no_of_coords, NULL, r);
+            else
+                dataArr = makeFloatArray(no_of_corners, corners, r);
             geom->setVertexAttribArray(attribIdx, dataArr);
             switch (colorbinding)
             {
             case Bind::PerVertex:
                 geom->setVertexAttribBinding(attribIdx, osg::Geometry::BIND_PER_VERTEX);
-                if (indexed)
-                {
-                    for (int i=0; i<no_of_coords; ++i)
-                    {
-                        dataArr->push_back(r[i]);
-                    }
-                }
-                else
-                {
-                    for (int i = 0; i < no_of_polygons; i++)
-                    {
-                        int numv;
-                        if (i == no_of_polygons - 1)
-                            numv = no_of_vertices - i_l[i];
-                        else
-                            numv = i_l[i + 1] - i_l[i];
-                        for (int n = 0; n < numv; n++)
-                        {
-                            int v = v_l[i_l[i] + n];
-                            dataArr->push_back(r[v]);
-                        }
-                    }
-                }
                 break;
             case Bind::PerFace:
                 geom->setVertexAttribBinding(attribIdx, osg::Geometry::BIND_PER_VERTEX);
@@ -914,32 +1215,11 @@ GeometryManager::addPolygon(const char *object_name,
             {
                 //fprintf(stderr,"COVER INFO: colorbinding per vertex\n");
 
-                osg::Vec4Array *colArr = new osg::Vec4Array();
-
+                osg::Vec4Array *colArr = NULL;
                 if (indexed)
-                {
-                    for (int i=0; i<no_of_colors; ++i)
-                    {
-                        colArr->push_back(getColor(&transparent, i, colorpacking, pc, r, g, b, transparency));
-                    }
-                }
+                    colArr = makeColorArray(no_of_colors, NULL, &transparent, colorpacking, pc, r, g, b, transparency);
                 else
-                {
-                    for (int i = 0; i < no_of_polygons; i++)
-                    {
-                        int numv;
-                        if (i == no_of_polygons - 1)
-                            numv = no_of_vertices - i_l[i];
-                        else
-                            numv = i_l[i + 1] - i_l[i];
-                        for (int n = 0; n < numv; n++)
-                        {
-                            int v = v_l[i_l[i] + n];
-                            auto c = getColor(&transparent, v, colorpacking, pc, r, g, b, transparency);
-                            colArr->push_back(c);
-                        }
-                    }
-                }
+                    colArr = makeColorArray(no_of_corners, corners, &transparent, colorpacking, pc, r, g, b, transparency);
                 geom->setColorArray(colArr);
                 geom->setColorBinding(osg::Geometry::BIND_PER_VERTEX);
             }
@@ -956,18 +1236,21 @@ GeometryManager::addPolygon(const char *object_name,
 
             case Bind::PerFace:
             {
-                osg::Vec4Array *colArr = new osg::Vec4Array();
-                for (int i = 0; i < no_of_polygons; i++)
+                osg::Vec4Array *colArr = new osg::Vec4Array(no_of_corners);
+                std::atomic<bool> anyTransparent(false);
+                if (no_of_corners > 0)
                 {
-                    auto c = getColor(&transparent, i, colorpacking, pc, r, g, b, transparency);
-                    int numv;
-                    if (i == no_of_polygons - 1)
-                        numv = no_of_vertices - i_l[i];
-                    else
-                        numv = i_l[i + 1] - i_l[i];
-                    for (int j = 0; j < numv; ++j)
-                        colArr->push_back(c);
+                    fillPerFace(&(*colArr)[0], no_of_polygons, start, [&](size_t i)
+                                {
+                                    bool trans = false;
+                                    osg::Vec4 c = getColor(&trans, (int)i, colorpacking, pc, r, g, b, transparency);
+                                    if (trans)
+                                        anyTransparent = true;
+                                    return c;
+                                });
                 }
+                if (anyTransparent)
+                    transparent = true;
                 geom->setColorArray(colArr);
                 geom->setColorBinding(osg::Geometry::BIND_PER_VERTEX);
                 break;
@@ -999,36 +1282,18 @@ GeometryManager::addPolygon(const char *object_name,
         {
             //fprintf(stderr,"COVER INFO: colorbinding per vertex\n");
 
-            osg::Vec3Array *normalArray = new osg::Vec3Array();
-
+            osg::ref_ptr<osg::Vec3Array> normalArray;
             if (indexed)
-            {
-                for (int i = 0; i < no_of_normals; ++i)
-                {
-                    osg::Vec3 norm = osg::Vec3(nx[i], ny[i], nz[i]);
-                    norm.normalize();
-                    normalArray->push_back(norm);
-                }
-            }
+                normalArray = shared<osg::Vec3Array>(share, SharedNormals, { span(nx, no_of_normals), span(ny, no_of_normals), span(nz, no_of_normals) }, [&]()
+                                                     {
+                                                         return makeVec3Array(no_of_normals, NULL, nx, ny, nz, true);
+                                                     });
             else
-            {
-                for (int i = 0; i < no_of_polygons; i++)
-                {
-                    int numv;
-                    if (i == no_of_polygons - 1)
-                        numv = no_of_vertices - i_l[i];
-                    else
-                        numv = i_l[i + 1] - i_l[i];
-                    for (int n = 0; n < numv; n++)
-                    {
-                        int v = v_l[i_l[i] + n];
-                        osg::Vec3 norm = osg::Vec3(nx[v], ny[v], nz[v]);
-                        norm.normalize();
-                        normalArray->push_back(norm);
-                    }
-                }
-            }
-            geom->setNormalArray(normalArray);
+                normalArray = shared<osg::Vec3Array>(share, SharedCornerNormals, { span(nx, no_of_normals), span(ny, no_of_normals), span(nz, no_of_normals), span(corners, no_of_corners) }, [&]()
+                                                     {
+                                                         return makeVec3Array(no_of_corners, corners, nx, ny, nz, true);
+                                                     });
+            geom->setNormalArray(normalArray.get());
             geom->setNormalBinding(osg::Geometry::BIND_PER_VERTEX);
         }
         break;
@@ -1047,21 +1312,15 @@ GeometryManager::addPolygon(const char *object_name,
 
         case Bind::PerFace:
         {
-            osg::Vec3Array *normalArray = new osg::Vec3Array();
-            for (int i = 0; i < no_of_polygons; i++)
+            osg::Vec3Array *normalArray = new osg::Vec3Array(no_of_corners);
+            if (no_of_corners > 0)
             {
-                osg::Vec3 n = osg::Vec3(nx[i], ny[i], nz[i]);
-                n.normalize();
-
-                int numv;
-                if (i == no_of_polygons - 1)
-                    numv = no_of_vertices - i_l[i];
-                else
-                    numv = i_l[i + 1] - i_l[i];
-                for (int j = 0; j < numv; ++j)
-                {
-                    normalArray->push_back(n);
-                }
+                fillPerFace(&(*normalArray)[0], no_of_polygons, start, [&](size_t i)
+                            {
+                                osg::Vec3 n = osg::Vec3(nx[i], ny[i], nz[i]);
+                                n.normalize();
+                                return n;
+                            });
             }
             geom->setNormalArray(normalArray);
             geom->setNormalBinding(osg::Geometry::BIND_PER_VERTEX);
@@ -1072,31 +1331,11 @@ GeometryManager::addPolygon(const char *object_name,
 
     if (no_of_texCoords)
     {
-        osg::Vec2Array *tcArray = new osg::Vec2Array();
-
+        osg::Vec2Array *tcArray = NULL;
         if (indexed)
-        {
-            for (int i=0; i<no_of_texCoords; ++i)
-            {
-                tcArray->push_back(osg::Vec2(tx[i], ty[i]));
-            }
-        }
+            tcArray = makeVec2Array(no_of_texCoords, NULL, tx, ty);
         else
-        {
-            for (int i = 0; i < no_of_polygons; i++)
-            {
-                int numv;
-                if (i == no_of_polygons - 1)
-                    numv = no_of_vertices - i_l[i];
-                else
-                    numv = i_l[i + 1] - i_l[i];
-                for (int n = 0; n < numv; n++)
-                {
-                    int v = v_l[i_l[i] + n];
-                    tcArray->push_back(osg::Vec2(tx[v], ty[v]));
-                }
-            }
-        }
+            tcArray = makeVec2Array(no_of_corners, corners, tx, ty);
         geom->setTexCoordArray(0, tcArray);
     }
 
@@ -1104,30 +1343,11 @@ GeometryManager::addPolygon(const char *object_name,
 
     if (no_of_vertexAttributes > 0)
     {
-        osg::Vec3Array *vertArray = new osg::Vec3Array;
+        osg::Vec3Array *vertArray = NULL;
         if (indexed)
-        {
-            for (int i=0; i<no_of_vertexAttributes; ++i)
-            {
-                vertArray->push_back(osg::Vec3(vax[i], vay[i], vaz[i]));
-            }
-        }
+            vertArray = makeVec3Array(no_of_vertexAttributes, NULL, vax, vay, vaz);
         else
-        {
-            for (int i = 0; i < no_of_polygons; i++)
-            {
-                int numv;
-                if (i == no_of_polygons - 1)
-                    numv = no_of_vertices - i_l[i];
-                else
-                    numv = i_l[i + 1] - i_l[i];
-                for (int n = 0; n < numv; n++)
-                {
-                    int v = v_l[i_l[i] + n];
-                    vertArray->push_back(osg::Vec3(vax[v], vay[v], vaz[v]));
-                }
-            }
-        }
+            vertArray = makeVec3Array(no_of_corners, corners, vax, vay, vaz);
         geom->setVertexAttribArray(6, vertArray);
     }
     // geoState->setGlobalDefaults();
@@ -1164,16 +1384,20 @@ GeometryManager::addPolygon(const char *object_name,
         osgUtil::SmoothingVisitor::smooth(*geom, CreaseAngle);
     }
 
-    for (auto &ps: geom->getPrimitiveSetList())
+    // shared triangle fans have been optimized when they were built
+    if (!share)
     {
-        if (auto de = dynamic_cast<osg::DrawElementsUInt *>(ps.get()))
+        for (auto &ps: geom->getPrimitiveSetList())
         {
-            tipsify(&(*de)[0], de->size());
+            if (auto de = dynamic_cast<osg::DrawElementsUInt *>(ps.get()))
+            {
+                tipsify(&(*de)[0], de->size());
+            }
         }
     }
 
 #if (OSG_VERSION_GREATER_OR_EQUAL(3, 4, 0))
-    d_kdtreeBuilder->apply(*geom);
+    buildKdTree(geom);
 #endif
 
     geode->addDrawable(geom);
@@ -1213,19 +1437,19 @@ GeometryManager::addTriangles(const char *object_name,
     cover->setRenderStrategy(geom);
 
     // set up geometry
-    osg::Vec3Array *vert = new osg::Vec3Array;
+    const size_t no_of_corners = 3 * (size_t)no_of_triangles;
+    auto start = [](size_t i) -> size_t
+    {
+        return 3 * i;
+    };
+    // without normals, the smoothing below changes the arrays of geom
+    const bool share = no_of_normals > 0;
+    osg::ref_ptr<osg::Vec3Array> vert = shared<osg::Vec3Array>(share, SharedCornerVertices, { span(x_c, no_of_coords), span(y_c, no_of_coords), span(z_c, no_of_coords), span(v_l, no_of_corners) }, [&]()
+                                                  {
+                                                      return makeVec3Array(no_of_corners, v_l, x_c, y_c, z_c);
+                                                  });
     osg::DrawArrays *primitives = new osg::DrawArrays(osg::PrimitiveSet::TRIANGLES, 0, no_of_vertices);
-    int vn = 0;
-    for (int i = 0; i < no_of_triangles; i++)
-    {
-        for (int n = 0; n < 3; n++)
-        {
-            int v = v_l[vn];
-            vert->push_back(osg::Vec3(x_c[v], y_c[v], z_c[v]));
-            vn++;
-        }
-    }
-    geom->setVertexArray(vert);
+    geom->setVertexArray(vert.get());
     geom->addPrimitiveSet(primitives);
 
     // associate colors
@@ -1238,18 +1462,7 @@ GeometryManager::addTriangles(const char *object_name,
         {
             //fprintf(stderr,"COVER INFO: colorbinding per vertex\n");
 
-            osg::Vec4Array *colArr = new osg::Vec4Array();
-            vn = 0;
-            for (int i = 0; i < no_of_triangles; i++)
-            {
-                for (int n = 0; n < 3; n++)
-                {
-                    int v = v_l[vn];
-                    vn++;
-                    auto c = getColor(&transparent, v, colorpacking, pc, r, g, b, transparency);
-                    colArr->push_back(c);
-                }
-            }
+            osg::Vec4Array *colArr = makeColorArray(no_of_corners, v_l, &transparent, colorpacking, pc, r, g, b, transparency);
             geom->setColorArray(colArr);
             geom->setColorBinding(osg::Geometry::BIND_PER_VERTEX);
             break;
@@ -1267,13 +1480,18 @@ GeometryManager::addTriangles(const char *object_name,
 
         case Bind::PerFace:
         {
-            osg::Vec4Array *colArr = new osg::Vec4Array();
-            for (int i = 0; i < no_of_triangles; i++)
-            {
-                auto c = getColor(&transparent, i, colorpacking, pc, r, g, b, transparency);
-                for (int j = 0; j < 3; ++j)
-                    colArr->push_back(c);
-            }
+            osg::Vec4Array *colArr = new osg::Vec4Array(no_of_corners);
+            std::atomic<bool> anyTransparent(false);
+            fillPerFace(&(*colArr)[0], no_of_triangles, start, [&](size_t i)
+                        {
+                            bool trans = false;
+                            osg::Vec4 c = getColor(&trans, (int)i, colorpacking, pc, r, g, b, transparency);
+                            if (trans)
+                                anyTransparent = true;
+                            return c;
+                        });
+            if (anyTransparent)
+                transparent = true;
             geom->setColorArray(colArr);
             geom->setColorBinding(osg::Geometry::BIND_PER_VERTEX);
             break;
@@ -1304,20 +1522,11 @@ GeometryManager::addTriangles(const char *object_name,
         {
             //fprintf(stderr,"COVER INFO: colorbinding per vertex\n");
 
-            osg::Vec3Array *normalArray = new osg::Vec3Array();
-            vn = 0;
-            for (int i = 0; i < no_of_triangles; i++)
-            {
-                for (int n = 0; n < 3; n++)
-                {
-                    int v = v_l[vn];
-                    vn++;
-                    osg::Vec3 norm = osg::Vec3(nx[v], ny[v], nz[v]);
-                    norm.normalize();
-                    normalArray->push_back(norm);
-                }
-            }
-            geom->setNormalArray(normalArray);
+            osg::ref_ptr<osg::Vec3Array> normalArray = shared<osg::Vec3Array>(share, SharedCornerNormals, { span(nx, no_of_normals), span(ny, no_of_normals), span(nz, no_of_normals), span(v_l, no_of_corners) }, [&]()
+                                                                 {
+                                                                     return makeVec3Array(no_of_corners, v_l, nx, ny, nz, true);
+                                                                 });
+            geom->setNormalArray(normalArray.get());
             geom->setNormalBinding(osg::Geometry::BIND_PER_VERTEX);
         }
         break;
@@ -1336,15 +1545,13 @@ GeometryManager::addTriangles(const char *object_name,
 
         case Bind::PerFace:
         {
-            osg::Vec3Array *normalArray = new osg::Vec3Array();
-            for (int i = 0; i < no_of_triangles; i++)
-            {
-                osg::Vec3 n = osg::Vec3(nx[i], ny[i], nz[i]);
-                n.normalize();
-
-                for (int j = 0; j < 3; ++j)
-                    normalArray->push_back(n);
-            }
+            osg::Vec3Array *normalArray = new osg::Vec3Array(no_of_corners);
+            fillPerFace(&(*normalArray)[0], no_of_triangles, start, [&](size_t i)
+                        {
+                            osg::Vec3 n = osg::Vec3(nx[i], ny[i], nz[i]);
+                            n.normalize();
+                            return n;
+                        });
             geom->setNormalArray(normalArray);
             geom->setNormalBinding(osg::Geometry::BIND_PER_VERTEX);
         }
@@ -1354,17 +1561,7 @@ GeometryManager::addTriangles(const char *object_name,
 
     if (no_of_texCoords)
     {
-        osg::Vec2Array *tcArray = new osg::Vec2Array();
-        vn = 0;
-        for (int i = 0; i < no_of_triangles; i++)
-        {
-            for (int n = 0; n < 3; n++)
-            {
-                int v = v_l[vn];
-                vn++;
-                tcArray->push_back(osg::Vec2(tx[v], ty[v]));
-            }
-        }
+        osg::Vec2Array *tcArray = makeVec2Array(no_of_corners, v_l, tx, ty);
         geom->setTexCoordArray(0, tcArray);
     }
 
@@ -1372,17 +1569,7 @@ GeometryManager::addTriangles(const char *object_name,
 
     if (no_of_vertexAttributes > 0)
     {
-        osg::Vec3Array *vertArray = new osg::Vec3Array;
-        vn = 0;
-        for (int i = 0; i < no_of_triangles; i++)
-        {
-            for (int n = 0; n < 3; n++)
-            {
-                int v = v_l[vn];
-                vn++;
-                vertArray->push_back(osg::Vec3(vax[v], vay[v], vaz[v]));
-            }
-        }
+        osg::Vec3Array *vertArray = makeVec3Array(no_of_corners, v_l, vax, vay, vaz);
         geom->setVertexAttribArray(6, vertArray);
     }
     // geoState->setGlobalDefaults();
@@ -1418,7 +1605,7 @@ GeometryManager::addTriangles(const char *object_name,
     }
 
 #if (OSG_VERSION_GREATER_OR_EQUAL(3, 4, 0))
-    d_kdtreeBuilder->apply(*geom);
+    buildKdTree(geom);
 #endif
 
     geode->addDrawable(geom);
@@ -1458,19 +1645,17 @@ GeometryManager::addQuads(const char *object_name,
     cover->setRenderStrategy(geom);
 
     // set up geometry
-    osg::Vec3Array *vert = new osg::Vec3Array;
+    const size_t no_of_corners = 4 * (size_t)no_of_quads;
+    auto start = [](size_t i) -> size_t
+    {
+        return 4 * i;
+    };
+    osg::ref_ptr<osg::Vec3Array> vert = shared<osg::Vec3Array>(true, SharedCornerVertices, { span(x_c, no_of_coords), span(y_c, no_of_coords), span(z_c, no_of_coords), span(v_l, no_of_corners) }, [&]()
+                                                  {
+                                                      return makeVec3Array(no_of_corners, v_l, x_c, y_c, z_c);
+                                                  });
     osg::DrawArrays *primitives = new osg::DrawArrays(osg::PrimitiveSet::QUADS, 0, no_of_vertices);
-    int vn = 0;
-    for (int i = 0; i < no_of_quads; i++)
-    {
-        for (int n = 0; n < 4; n++)
-        {
-            int v = v_l[vn];
-            vert->push_back(osg::Vec3(x_c[v], y_c[v], z_c[v]));
-            vn++;
-        }
-    }
-    geom->setVertexArray(vert);
+    geom->setVertexArray(vert.get());
     geom->addPrimitiveSet(primitives);
 
     // associate colors
@@ -1484,18 +1669,7 @@ GeometryManager::addQuads(const char *object_name,
         {
             //fprintf(stderr,"COVER INFO: colorbinding per vertex\n");
 
-            osg::Vec4Array *colArr = new osg::Vec4Array();
-            vn = 0;
-            for (int i = 0; i < no_of_quads; i++)
-            {
-                for (int n = 0; n < 4; n++)
-                {
-                    int v = v_l[vn];
-                    vn++;
-                    auto c = getColor(&transparent, v, colorpacking, pc, r, g, b, transparency);
-                    colArr->push_back(c);
-                }
-            }
+            osg::Vec4Array *colArr = makeColorArray(no_of_corners, v_l, &transparent, colorpacking, pc, r, g, b, transparency);
             geom->setColorArray(colArr);
             geom->setColorBinding(osg::Geometry::BIND_PER_VERTEX);
         }
@@ -1517,13 +1691,18 @@ GeometryManager::addQuads(const char *object_name,
         {
             //fprintf(stderr,"COVER INFO: colorbinding per face\n");
 
-            osg::Vec4Array *colArr = new osg::Vec4Array();
-            for (int i = 0; i < no_of_quads; i++)
-            {
-                auto c = getColor(&transparent, i, colorpacking, pc, r, g, b, transparency);
-                for (int j = 0; j < 4; ++j)
-                    colArr->push_back(c);
-            }
+            osg::Vec4Array *colArr = new osg::Vec4Array(no_of_corners);
+            std::atomic<bool> anyTransparent(false);
+            fillPerFace(&(*colArr)[0], no_of_quads, start, [&](size_t i)
+                        {
+                            bool trans = false;
+                            osg::Vec4 c = getColor(&trans, (int)i, colorpacking, pc, r, g, b, transparency);
+                            if (trans)
+                                anyTransparent = true;
+                            return c;
+                        });
+            if (anyTransparent)
+                transparent = true;
             geom->setColorArray(colArr);
             geom->setColorBinding(osg::Geometry::BIND_PER_VERTEX);
             break;
@@ -1554,20 +1733,11 @@ GeometryManager::addQuads(const char *object_name,
         {
             //fprintf(stderr,"COVER INFO: colorbinding per vertex\n");
 
-            osg::Vec3Array *normalArray = new osg::Vec3Array();
-            vn = 0;
-            for (int i = 0; i < no_of_quads; i++)
-            {
-                for (int n = 0; n < 4; n++)
-                {
-                    int v = v_l[vn];
-                    vn++;
-                    osg::Vec3 norm = osg::Vec3(nx[v], ny[v], nz[v]);
-                    norm.normalize();
-                    normalArray->push_back(norm);
-                }
-            }
-            geom->setNormalArray(normalArray);
+            osg::ref_ptr<osg::Vec3Array> normalArray = shared<osg::Vec3Array>(true, SharedCornerNormals, { span(nx, no_of_normals), span(ny, no_of_normals), span(nz, no_of_normals), span(v_l, no_of_corners) }, [&]()
+                                                                 {
+                                                                     return makeVec3Array(no_of_corners, v_l, nx, ny, nz, true);
+                                                                 });
+            geom->setNormalArray(normalArray.get());
             geom->setNormalBinding(osg::Geometry::BIND_PER_VERTEX);
         }
         break;
@@ -1586,15 +1756,13 @@ GeometryManager::addQuads(const char *object_name,
 
         case Bind::PerFace:
         {
-            osg::Vec3Array *normalArray = new osg::Vec3Array();
-            for (int i = 0; i < no_of_quads; i++)
-            {
-                osg::Vec3 n = osg::Vec3(nx[i], ny[i], nz[i]);
-                n.normalize();
-
-                for (int j = 0; j < 4; ++j)
-                    normalArray->push_back(n);
-            }
+            osg::Vec3Array *normalArray = new osg::Vec3Array(no_of_corners);
+            fillPerFace(&(*normalArray)[0], no_of_quads, start, [&](size_t i)
+                        {
+                            osg::Vec3 n = osg::Vec3(nx[i], ny[i], nz[i]);
+                            n.normalize();
+                            return n;
+                        });
             geom->setNormalArray(normalArray);
             geom->setNormalBinding(osg::Geometry::BIND_PER_VERTEX);
         }
@@ -1604,17 +1772,7 @@ GeometryManager::addQuads(const char *object_name,
 
     if (no_of_texCoords)
     {
-        osg::Vec2Array *tcArray = new osg::Vec2Array();
-        vn = 0;
-        for (int i = 0; i < no_of_quads; i++)
-        {
-            for (int n = 0; n < 4; n++)
-            {
-                int v = v_l[vn];
-                vn++;
-                tcArray->push_back(osg::Vec2(tx[v], ty[v]));
-            }
-        }
+        osg::Vec2Array *tcArray = makeVec2Array(no_of_corners, v_l, tx, ty);
         geom->setTexCoordArray(0, tcArray);
     }
 
@@ -1622,17 +1780,7 @@ GeometryManager::addQuads(const char *object_name,
 
     if (no_of_vertexAttributes > 0)
     {
-        osg::Vec3Array *vertArray = new osg::Vec3Array;
-        vn = 0;
-        for (int i = 0; i < no_of_quads; i++)
-        {
-            for (int n = 0; n < 4; n++)
-            {
-                int v = v_l[vn];
-                vn++;
-                vertArray->push_back(osg::Vec3(vax[v], vay[v], vaz[v]));
-            }
-        }
+        osg::Vec3Array *vertArray = makeVec3Array(no_of_corners, v_l, vax, vay, vaz);
         geom->setVertexAttribArray(6, vertArray);
     }
     // geoState->setGlobalDefaults();
@@ -1668,7 +1816,7 @@ GeometryManager::addQuads(const char *object_name,
     }
 
 #if (OSG_VERSION_GREATER_OR_EQUAL(3, 4, 0))
-    d_kdtreeBuilder->apply(*geom);
+    buildKdTree(geom);
 #endif
 
     geode->addDrawable(geom);
@@ -2021,7 +2169,7 @@ osg::Node *GeometryManager::addTriangleStrip(const char *object_name,
     }
 
 #if (OSG_VERSION_GREATER_OR_EQUAL(3, 4, 0))
-    d_kdtreeBuilder->apply(*geom);
+    buildKdTree(geom);
 #endif
 
     geode->setStateSet(geoState);
@@ -2277,57 +2425,71 @@ osg::Node *GeometryManager::addLine(const char *object_name,
     int no_of_line_segments = 0;
 
     // set up geometry
-    osg::Vec3Array *vert = new osg::Vec3Array;
+    // the vertices of all lines are v_l[i_l[0]], ..., v_l[no_of_vertices-1],
+    // line i consists of the vertices [start(i), start(i + 1))
+    const int *corners = v_l + i_l[0];
+    const size_t no_of_corners = no_of_vertices - i_l[0];
+    auto start = [&](size_t i) -> size_t
+    {
+        return (i < (size_t)no_of_lines ? i_l[i] : no_of_vertices) - i_l[0];
+    };
+
+    osg::ref_ptr<osg::Vec3Array> vert;
     if (linestrips)
     {
         if (indexed)
         {
-            osg::DrawElementsUInt *primitives = new osg::DrawElementsUInt(osg::PrimitiveSet::LINES);
+            // line i is split into the segments [firstSeg[i], firstSeg[i + 1])
+            std::vector<size_t> firstSeg(no_of_lines + 1, 0);
             for (int i = 0; i < no_of_lines; i++)
             {
-                int numv;
-                if (i == no_of_lines - 1)
-                    numv = no_of_vertices - i_l[i];
-                else
-                    numv = i_l[i + 1] - i_l[i];
-
-                if (numv < 2)
-                    continue;
+                int numv = (int)(start(i + 1) - start(i));
+                firstSeg[i + 1] = firstSeg[i] + (numv < 2 ? 0 : numv - 1);
+            }
 
-                for (int t = 0; t <= numv - 2; ++t)
+            auto makeSegments = [&]()
+            {
+                osg::DrawElementsUInt *primitives = new osg::DrawElementsUInt(osg::PrimitiveSet::LINES, 2 * firstSeg[no_of_lines]);
+                if (firstSeg[no_of_lines] > 0)
                 {
-                    primitives->push_back(v_l[i_l[i] + 0 + t]);
-                    primitives->push_back(v_l[i_l[i] + 1 + t]);
+                    GLuint *seg = &(*primitives)[0];
+                    forRanges(no_of_lines, [&](size_t begin, size_t end)
+                              {
+                                  for (size_t i = begin; i < end; ++i)
+                                  {
+                                      const int *line = corners + start(i);
+                                      GLuint *out = seg + 2 * firstSeg[i];
+                                      for (size_t t = 0; t < firstSeg[i + 1] - firstSeg[i]; ++t)
+                                      {
+                                          *out++ = line[t];
+                                          *out++ = line[t + 1];
+                                      }
+                                  }
+                              });
                 }
-            }
-            geom->addPrimitiveSet(primitives);
-            for (int n = 0; n < no_of_coords; n++)
-            {
-                vert->push_back(osg::Vec3(x_c[n], y_c[n], z_c[n]));
-            }
+                return primitives;
+            };
+            geom->addPrimitiveSet(shared<osg::DrawElementsUInt>(true, SharedSegments, { span(corners, no_of_corners), span(i_l, no_of_lines) }, makeSegments));
+            vert = shared<osg::Vec3Array>(true, SharedVertices, { span(x_c, no_of_coords), span(y_c, no_of_coords), span(z_c, no_of_coords) }, [&]()
+                                          {
+                                              return makeVec3Array(no_of_coords, NULL, x_c, y_c, z_c);
+                                          });
         }
         else
         {
-            osg::DrawArrayLengths *primitives = new osg::DrawArrayLengths(osg::PrimitiveSet::LINE_STRIP);
+            osg::DrawArrayLengths *primitives = new osg::DrawArrayLengths(osg::PrimitiveSet::LINE_STRIP, 0, no_of_lines);
             for (int i = 0; i < no_of_lines; i++)
-            {
-                int numv;
-                if (i == no_of_lines - 1)
-                    numv = no_of_vertices - i_l[i];
-                else
-                    numv = i_l[i + 1] - i_l[i];
-                primitives->push_back(numv);
-                for (int n = 0; n < numv; n++)
-                {
-                    int v = v_l[i_l[i] + n];
-                    vert->push_back(osg::Vec3(x_c[v], y_c[v], z_c[v]));
-                }
-            }
+                (*primitives)[i] = (GLsizei)(start(i + 1) - start(i));
             geom->addPrimitiveSet(primitives);
+            vert = shared<osg::Vec3Array>(true, SharedCornerVertices, { span(x_c, no_of_coords), span(y_c, no_of_coords), span(z_c, no_of_coords), span(corners, no_of_corners) }, [&]()
+                                          {
+                                              return makeVec3Array(no_of_corners, corners, x_c, y_c, z_c);
+                                          });
         }
     }
     else
     {
+        vert = new osg::Vec3Array;
         for (int i = 0; i < no_of_lines; i++)
         {
             int numv;
@@ -2354,7 +2516,7 @@ osg::Node *GeometryManager::addLine(const char *object_name,
         osg::DrawArrays *primitives = new osg::DrawArrays(osg::PrimitiveSet::LINES, 0, no_of_line_segments);
         geom->addPrimitiveSet(primitives);
     }
-    geom->setVertexArray(vert);
+    geom->setVertexArray(vert.get());
 
     // associate colors
     bool transparent = false;
@@ -2366,38 +2528,18 @@ osg::Node *GeometryManager::addLine(const char *object_name,
         {
             //fprintf(stderr,"COVER INFO: colorbinding per vertex\n");
 
-            osg::Vec4Array *colArr = new osg::Vec4Array();
+            osg::Vec4Array *colArr = NULL;
 
             if (linestrips)
             {
                 if (indexed)
-                {
-                    for (int i=0; i<no_of_colors; ++i)
-                    {
-                        auto c = getColor(&transparent, i, colorpacking, pc, r, g, b);
-                        colArr->push_back(c);
-                    }
-                }
+                    colArr = makeColorArray(no_of_colors, NULL, &transparent, colorpacking, pc, r, g, b);
                 else
-                {
-                    for (int i = 0; i < no_of_lines; i++)
-                    {
-                        int numv;
-                        if (i == no_of_lines - 1)
-                            numv = no_of_vertices - i_l[i];
-                        else
-                            numv = i_l[i + 1] - i_l[i];
-                        for (int n = 0; n < numv; n++)
-                        {
-                            int v = v_l[i_l[i] + n];
-                            auto c = getColor(&transparent, v, colorpacking, pc, r, g, b);
-                            colArr->push_back(c);
-                        }
-                    }
-                }
+                    colArr = makeColorArray(no_of_corners, corners, &transparent, colorpacking, pc, r, g, b);
             }
             else
             {
+                colArr = new osg::Vec4Array();
                 for (int i = 0; i < no_of_lines; i++)
                 {
                     int numv;
@@ -2564,22 +2706,26 @@ osg::Node *GeometryManager::addLine(const char *object_name,
 
     if (no_of_texCoords > 0)
     {
-        osg::Vec2Array *tcArray = new osg::Vec2Array();
+        osg::Vec2Array *tcArray = NULL;
 
-        if (no_of_texCoords == 1)
+        if (no_of_texCoords > 1 && no_of_texCoords == no_of_coords)
         {
-            tcArray->push_back(osg::Vec2(tx[0], ty[0]));
-            tcArray->setBinding(osg::Array::BIND_OVERALL);
+            if (indexed)
+                tcArray = makeVec2Array(no_of_texCoords, NULL, tx, ty);
+            else
+                tcArray = makeVec2Array(no_of_corners, corners, tx, ty);
         }
-        else if (no_of_texCoords == no_of_coords)
+        else
         {
-            if (indexed)
+            tcArray = new osg::Vec2Array();
+            if (no_of_texCoords == 1)
             {
-                for (int i=0; i<no_of_texCoords; ++i)
-                    tcArray->push_back(osg::Vec2(tx[i], ty[i]));
+                tcArray->push_back(osg::Vec2(tx[0], ty[0]));
+                tcArray->setBinding(osg::Array::BIND_OVERALL);
             }
-            else
+            else if (no_of_texCoords == no_of_lines)
             {
+                int idx = 0;
                 for (int i = 0; i < no_of_lines; i++)
                 {
                     int numv;
@@ -2589,47 +2735,29 @@ osg::Node *GeometryManager::addLine(const char *object_name,
                         numv = i_l[i + 1] - i_l[i];
                     for (int n = 0; n < numv; n++)
                     {
-                        int v = v_l[i_l[i] + n];
-                        tcArray->push_back(osg::Vec2(tx[v], ty[v]));
+                        tcArray->push_back(osg::Vec2(tx[idx], ty[idx]));
                     }
-
-                }
-            }
-        }
-        else if (no_of_texCoords == no_of_lines)
-        {
-            int idx = 0;
-            for (int i = 0; i < no_of_lines; i++)
-            {
-                int numv;
-                if (i == no_of_lines - 1)
-                    numv = no_of_vertices - i_l[i];
-                else
-                    numv = i_l[i + 1] - i_l[i];
-                for (int n = 0; n < numv; n++)
-                {
-                    tcArray->push_back(osg::Vec2(tx[idx], ty[idx]));
+                    ++idx;
                 }
-                ++idx;
             }
-        }
-        else if (no_of_texCoords == no_of_line_segments)
-        {
-            for (int i = 0; i < no_of_lines; i++)
+            else if (no_of_texCoords == no_of_line_segments)
             {
-                int numv;
-                if (i == no_of_lines - 1)
-                    numv = no_of_vertices - i_l[i];
-                else
-                    numv = i_l[i + 1] - i_l[i];
-                if (numv < 2)
-                    continue;
-                int v = v_l[i_l[i]];
-                for (int n = 1; n < numv; n++)
+                for (int i = 0; i < no_of_lines; i++)
                 {
-                    tcArray->push_back(osg::Vec2(tx[v], ty[v]));
-                    v = v_l[i_l[i]+n];
-                    tcArray->push_back(osg::Vec2(tx[v], ty[v]));
+                    int numv;
+                    if (i == no_of_lines - 1)
+                        numv = no_of_vertices - i_l[i];
+                    else
+                        numv = i_l[i + 1] - i_l[i];
+                    if (numv < 2)
+                        continue;
+                    int v = v_l[i_l[i]];
+                    for (int n = 1; n < numv; n++)
+                    {
+                        tcArray->push_back(osg::Vec2(tx[v], ty[v]));
+                        v = v_l[i_l[i]+n];
+                        tcArray->push_back(osg::Vec2(tx[v], ty[v]));
+                    }
                 }
             }
         }
@@ -2685,14 +2813,13 @@ GeometryManager::addPoint(const char *object_name, int no_of_points,
     cover->setRenderStrategy(geom);
 
     // set up geometry
-    osg::Vec3Array *vert = new osg::Vec3Array;
+    osg::ref_ptr<osg::Vec3Array> vert = shared<osg::Vec3Array>(true, SharedVertices, { span(x_c, no_of_points), span(y_c, no_of_points), span(z_c, no_of_points) }, [&]()
+                                                  {
+                                                      return makeVec3Array(no_of_points, NULL, x_c, y_c, z_c);
+                                                  });
     osg::DrawArrayLengths *primitives = new osg::DrawArrayLengths(osg::PrimitiveSet::POINTS);
     primitives->push_back(no_of_points);
-    for (int i = 0; i < no_of_points; i++)
-    {
-        vert->push_back(osg::Vec3(x_c[i], y_c[i], z_c[i]));
-    }
-    geom->setVertexArray(vert);
+    geom->setVertexArray(vert.get());
     geom->addPrimitiveSet(primitives);
 
     bool transparent = false;
@@ -2704,13 +2831,7 @@ GeometryManager::addPoint(const char *object_name, int no_of_points,
         {
             //fprintf(stderr,"COVER INFO: colorbinding per vertex\n");
 
-            osg::Vec4Array *colArr = new osg::Vec4Array();
-
-            for (int i = 0; i < no_of_points; i++)
-            {
-                auto c = getColor(&transparent, i, colorpacking, pc, r, g, b);
-                colArr->push_back(c);
-            }
+            osg::Vec4Array *colArr = makeColorArray(no_of_points, NULL, &transparent, colorpacking, pc, r, g, b);
             geom->setColorArray(colArr);
             geom->setColorBinding(osg::Geometry::BIND_PER_VERTEX);
         }
@@ -2746,12 +2867,7 @@ GeometryManager::addPoint(const char *object_name, int no_of_points,
 
     if (no_of_texCoords)
     {
-        osg::Vec2Array *tcArray = new osg::Vec2Array();
-
-        for (int i = 0; i < no_of_points; i++)
-        {
-            tcArray->push_back(osg::Vec2(tx[i], ty[i]));
-        }
+        osg::Vec2Array *tcArray = makeVec2Array(no_of_points, NULL, tx, ty);
         geom->setTexCoordArray(0, tcArray);
     }
 
@@ -2821,6 +2937,7 @@ GeometryManager::addSphere(const char *object_name, int no_of_points,
     geoState->setAttributeAndModes(alphaFunc, osg::StateAttribute::ON);
     if (iRenderMethod == coSphere::RENDER_METHOD_TEXTURE)
     {
+        std::lock_guard<std::mutex> guard(stateMutex);
         osg::Texture2D *tex = coVRFileManager::instance()->loadTexture("share/covise/materials/textures/Sphere.tiff");
         if (tex)
         {
@@ -2835,7 +2952,12 @@ GeometryManager::addSphere(const char *object_name, int no_of_points,
         setDefaultMaterial(geoState, transparent, material);
     geode->setStateSet(geoState);
 
-    coSphere *sphere = new coSphere();
+    coSphere *sphere = NULL;
+    {
+        // the first sphere sets up the class
+        std::lock_guard<std::mutex> guard(stateMutex);
+        sphere = new coSphere();
+    }
     sphere->setRenderMethod((coSphere::RenderMethod)iRenderMethod);
     sphere->setCoords(no_of_points, x_c, y_c, z_c, radii_c);
     if ((colorbinding == Bind::OverAll || colorbinding == Bind::None) && material != NULL)
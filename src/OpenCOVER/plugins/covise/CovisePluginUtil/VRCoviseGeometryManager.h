@@ -28,6 +28,14 @@ using covise::coMaterial;
 #include <osg/Material>
 #include <osg/ref_ptr>
 #include <osg/KdTree>
+#include <osg/BufferObject>
+
+#include <cstdint>
+#include <initializer_list>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 namespace osg
 {
@@ -58,6 +66,45 @@ private:
 
     osg::Vec4 coviseGeometryDefaultColor;
 
+    // vertex arrays and index lists are shared between the nodes built from
+    // equal coordinates and connectivity, e.g. all the timesteps of a
+    // static grid or re-executions that only change the colors
+    struct SharedData
+    {
+        osg::ref_ptr<osg::BufferData> data;
+        // the tag and source arrays data was built from: a hash hit is only
+        // trusted if they are equal
+        int tag = 0;
+        std::vector<size_t> sizes;
+        std::vector<char> source;
+        size_t bytes = 0;
+        double buildMs = 0.;
+        unsigned lastUse = 0;
+    };
+    std::map<uint64_t, SharedData> sharedData;
+    bool shareGeometry;
+    size_t sharedCacheBytes; // unused shared data kept for later objects
+    unsigned sharedUse = 0;
+    size_t sharedSavedBytes = 0;
+    double sharedSavedMs = 0.;
+
+    // the data built by build() or the equal data built before for the
+    // same tag and array contents, referenced before it can be pruned
+    template <class T, class Build>
+    osg::ref_ptr<T> shared(bool share, int tag, std::initializer_list<std::pair<const void *, size_t>> arrays, Build build);
+    static bool sameSource(const SharedData &entry, int tag, std::initializer_list<std::pair<const void *, size_t>> arrays);
+    void pruneShared();
+
+    // d_kdtreeBuilder is copied for every geometry
+    void buildKdTree(osg::Geometry *geom);
+
+    // nodes may also be built on the loader threads of a coVRStreamingSequence
+    // and in the background: sharedMutex guards sharedData and its statistics,
+    // stateMutex the state attributes shared between nodes, everything else
+    // the add* methods touch belongs to the node being built
+    std::mutex sharedMutex;
+    std::mutex stateMutex;
+
 public:
     static GeometryManager *instance();
     GeometryManager();
@@ -170,6 +217,9 @@ public:
                          float *vax, float *vay, float *vaz,
                          coMaterial *material = NULL);
 
+    //! bytes and milliseconds saved by sharing data since the last call
+    void takeSharingStats(size_t &bytes, double &ms);
+
     ~GeometryManager();
 };
 }
@@ -3,11 +3,13 @@
 
 #include <osg/ref_ptr>
 #include <osg/Node>
+#include <memory>
 #include <string>
 #include <vector>
 #include <cover/ui/Button.h>
 
 struct PointSet;
+class PointCloudOctree;
 
 namespace opencover {
 namespace ui {
@@ -29,6 +31,7 @@ public:
 	osg::ref_ptr<osg::MatrixTransform> tranformMat;
     int pointSetSize;
     PointSet *pointSet;
+    std::shared_ptr<PointCloudOctree> octree; // for .pto files, pages its nodes itself
 	osg::Matrix prevMat;
 	opencover::ui::Button *fileButton = nullptr;
 };
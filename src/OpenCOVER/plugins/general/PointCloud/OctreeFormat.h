@@ -0,0 +1,50 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#ifndef _OCTREE_FORMAT_H_
+#define _OCTREE_FORMAT_H_
+
+#include <stdint.h>
+
+// .pto: point cloud octree with level of detail, written by PointOctree
+//
+// The file starts with an OctreeHeader, followed by the points of all nodes
+// and the table of the nodes at nodeTableOffset. Node 0 is the root.
+// Every node stores a spatially uniform subsample of the points in its
+// cube, the points of a node are not repeated in its children: rendering a
+// node together with all of its ancestors shows all points in its cube with
+// a spacing of OctreeNode::spacing.
+
+#define OCTREE_MAGIC "COVPTO\0"
+#define OCTREE_VERSION 1
+
+struct OctreePoint
+{
+    float x, y, z;
+    uint32_t rgba; // red in the lowest byte, as in .ptsb files
+};
+
+struct OctreeHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t numNodes;
+    uint64_t numPoints;
+    uint64_t nodeTableOffset;
+    float min[3], max[3];
+};
+
+struct OctreeNode
+{
+    float min[3], max[3]; // cube of the node
+    float spacing; // minimal distance of the points in this node
+    uint32_t numPoints;
+    uint64_t offset; // of the first point in the file
+    int32_t children[8]; // -1: no child
+};
+
+#endif
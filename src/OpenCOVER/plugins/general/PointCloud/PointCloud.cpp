@@ -43,6 +43,7 @@
 
 // Local:
 #include "PointCloud.h"
+#include "PointCloudOctree.h"
 
 #ifdef HAVE_E57
 #include <e57/E57Foundation.h>
@@ -93,7 +94,11 @@ static FileHandler handlers[] = {
 	  { NULL,
 	  PointCloudPlugin::loadPTS,
 	  PointCloudPlugin::unloadPTS,
-	  "e57" }
+	  "e57" },
+    { NULL,
+      PointCloudPlugin::loadPTS,
+      PointCloudPlugin::unloadPTS,
+      "pto" }
 };
 
 bool PointCloudPlugin::init()
@@ -104,6 +109,8 @@ bool PointCloudPlugin::init()
     }
     plugin = this;
     pointSizeValue = coCoviseConfig::getFloat("COVER.Plugin.PointCloud.PointSize", pointSizeValue);
+    octreeMaxError = coCoviseConfig::getFloat("COVER.Plugin.PointCloud.OctreeMaxError", octreeMaxError);
+    pointBudget = coCoviseConfig::getLong("COVER.Plugin.PointCloud.PointBudget", pointBudget);
     m_usePoitSprites = coCoviseConfig::isOn("pointSprites","COVER.Plugin.PointCloud", true);
 
     coVRFileManager::instance()->registerFileHandler(&handlers[0]);
@@ -112,6 +119,7 @@ bool PointCloudPlugin::init()
     coVRFileManager::instance()->registerFileHandler(&handlers[3]);
 	coVRFileManager::instance()->registerFileHandler(&handlers[4]);
 	coVRFileManager::instance()->registerFileHandler(&handlers[5]);
+    coVRFileManager::instance()->registerFileHandler(&handlers[6]);
 
     //Create main menu button
     pointCloudMenu = new ui::Menu("PointCloudMenu",this);
@@ -402,6 +410,7 @@ PointCloudPlugin::~PointCloudPlugin()
 	coVRFileManager::instance()->unregisterFileHandler(&handlers[3]);
 	coVRFileManager::instance()->unregisterFileHandler(&handlers[4]);
 	coVRFileManager::instance()->unregisterFileHandler(&handlers[5]);
+    coVRFileManager::instance()->unregisterFileHandler(&handlers[6]);
 
     // clean the scenegraph and free memory
     clearData();
@@ -481,6 +490,8 @@ void PointCloudPlugin::changeAllPointSize(float pointSize)
 {
     for (std::vector<FileInfo>::iterator fit = files.begin(); fit != files.end(); fit++)
     {
+        if (fit->octree)
+            fit->octree->setPointSize(pointSize);
         //TODO calc distance correctly
         for (std::vector<NodeInfo>::iterator nit = fit->nodes.begin(); nit != fit->nodes.end(); nit++)
         {
@@ -712,6 +723,19 @@ void PointCloudPlugin::createGeodes(Group *parent, const string &filename)
         fclose(fp);
         return;
     }
+    else if (strcasecmp(cfile + strlen(cfile) - 3, "pto") == 0)
+    {
+        auto octree = std::make_shared<PointCloudOctree>(filename);
+        if (!octree->isValid())
+            return;
+        octree->setPointSize(pointSizeValue);
+        matTra->addChild(octree->getNode());
+        fi.pointSetSize = 0;
+        fi.pointSet = nullptr;
+        fi.octree = octree;
+        files.push_back(fi);
+        return;
+    }
     else if (strcasecmp(cfile + strlen(cfile) - 3, "c2m") == 0)
     {
         cout << "iCloud2Max Data: " << filename << endl;
@@ -737,16 +761,18 @@ void PointCloudPlugin::createGeodes(Group *parent, const string &filename)
                 pointSet[i].points = new ::Point[psize];
                 pointSet[i].size = psize;
 
+                // read all 36 byte records of the set at once
+                std::vector<char> records(36 * (size_t)psize);
+                file.read(records.data(), records.size());
                 for (int n = 0; n < psize; n++)
                 {
-                    // read point data
-                    file.read(buf, 36);
-                    pointSet[i].points[n].coordinates.x() = ((float *)buf)[0];
-                    pointSet[i].points[n].coordinates.y() = ((float *)buf)[1];
-                    pointSet[i].points[n].coordinates.z() = ((float *)buf)[2];
-                    pointSet[i].colors[n].r = (((unsigned char *)buf)[14]) / 255.0;
-                    pointSet[i].colors[n].g = (((unsigned char *)buf)[13]) / 255.0;
-                    pointSet[i].colors[n].b = (((unsigned char *)buf)[12]) / 255.0;
+                    const char *record = &records[36 * (size_t)n];
+                    pointSet[i].points[n].coordinates.x() = ((float *)record)[0];
+                    pointSet[i].points[n].coordinates.y() = ((float *)record)[1];
+                    pointSet[i].points[n].coordinates.z() = ((float *)record)[2];
+                    pointSet[i].colors[n].r = (((unsigned char *)record)[14]) / 255.0;
+                    pointSet[i].colors[n].g = (((unsigned char *)record)[13]) / 255.0;
+                    pointSet[i].colors[n].b = (((unsigned char *)record)[12]) / 255.0;
                 }
 
                 //create drawable and geode and add to the scene (make sure the cube is not empty)
@@ -1228,6 +1254,7 @@ int PointCloudPlugin::unloadFile(const std::string &filename)
             }
 
             fit->nodes.clear();
+            fit->octree.reset();
 
             // remove the pointset data
             if (fit->pointSet != nullptr)
@@ -1272,6 +1299,7 @@ void PointCloudPlugin::clearData()
         }
         
         fit->nodes.clear();
+        fit->octree.reset();
 
         // remove the poinset data
         if (fit->pointSet != nullptr)
@@ -1325,6 +1353,12 @@ void PointCloudPlugin::preFrame()
     s_pointCloudInteractor->resize();
     secondary_Interactor->resize();
 
+    for (auto &fi: files)
+    {
+        if (fi.octree)
+            fi.octree->update(octreeMaxError, pointBudget);
+    }
+
     if (!adaptLOD)
     {
         // reset LOD to 1.0 if LOD was disabled
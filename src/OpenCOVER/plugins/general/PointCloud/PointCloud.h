@@ -85,6 +85,8 @@ private:
     float lodScale = 1.f; // levelOfDetail is multiplied by loadScale for each node
     float lodFarDistance = 40; // distance at which lod is set to minimum (25...inf)
     float lodNearDistance = 15; // distance until which lod is set to maximum (0...15)
+    float octreeMaxError = 2.f; // spacing of the points of .pto files on the screen in pixels
+    long pointBudget = 30000000; // points of .pto files in memory and drawn
     
     static PointCloudInteractor *s_pointCloudInteractor;
     static PointCloudInteractor *secondary_Interactor;
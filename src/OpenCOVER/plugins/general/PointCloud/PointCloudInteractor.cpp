@@ -383,6 +383,8 @@ bool PointCloudInteractor::hitPoint(pointSelection& bestPoint)
 void  
 PointCloudInteractor::MovePoints(osg::Matrixd MoveMat)
 {
+	if (!currFI.pointSet)
+		return;
 	for (int i = 0; i < currFI.pointSet->size; i++)
 	{
 		currFI.pointSet->points[i].coordinates = MoveMat.preMult(currFI.pointSet->points[i].coordinates);
@@ -0,0 +1,284 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#include "PointCloudOctree.h"
+
+#include <cover/coVRPluginSupport.h>
+#include <cover/coVRConfig.h>
+
+#include <osg/Geometry>
+#include <osg/MatrixTransform>
+#include <osg/Viewport>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <queue>
+
+using namespace opencover;
+using namespace std;
+
+PointCloudOctree::PointCloudOctree(const std::string &filename)
+    : filename(filename)
+{
+    ifstream file(filename.c_str(), ios::in | ios::binary);
+    if (!file.is_open())
+    {
+        cerr << "PlugIn.PointCloud: could not open " << filename << endl;
+        return;
+    }
+    OctreeHeader header;
+    file.read((char *)&header, sizeof(header));
+    if (!file || memcmp(header.magic, OCTREE_MAGIC, sizeof(header.magic)) != 0 || header.version != OCTREE_VERSION)
+    {
+        cerr << "PlugIn.PointCloud: " << filename << " is not a point cloud octree" << endl;
+        return;
+    }
+    nodes.resize(header.numNodes);
+    file.seekg(header.nodeTableOffset);
+    file.read((char *)nodes.data(), sizeof(OctreeNode) * nodes.size());
+    if (!file || nodes.empty())
+    {
+        cerr << "PlugIn.PointCloud: could not read the nodes of " << filename << endl;
+        nodes.clear();
+        return;
+    }
+    cout << "PlugIn.PointCloud: " << filename << " has " << header.numPoints << " points in " << nodes.size() << " nodes" << endl;
+
+    geodes.resize(nodes.size());
+    lastSelected.resize(nodes.size(), 0);
+    attached.resize(nodes.size(), false);
+
+    group = new osg::Group();
+    group->setName(filename);
+    osg::StateSet *stateset = group->getOrCreateStateSet();
+    stateset->setMode(GL_LIGHTING, osg::StateAttribute::OFF);
+    stateset->setMode(GL_DEPTH_TEST, osg::StateAttribute::ON);
+    pointState = new osg::Point();
+    stateset->setAttributeAndModes(pointState.get(), osg::StateAttribute::ON);
+
+    loader = std::thread([this]() { loaderLoop(); });
+}
+
+PointCloudOctree::~PointCloudOctree()
+{
+    if (loader.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            quit = true;
+        }
+        requestCond.notify_all();
+        loader.join();
+    }
+    if (group)
+    {
+        while (group->getNumParents() > 0)
+            group->getParent(0)->removeChild(group.get());
+    }
+}
+
+void PointCloudOctree::setPointSize(float size)
+{
+    if (pointState)
+        pointState->setSize(size);
+}
+
+void PointCloudOctree::loaderLoop()
+{
+    ifstream file(filename.c_str(), ios::in | ios::binary);
+    std::vector<OctreePoint> points;
+    for (;;)
+    {
+        int node = -1;
+        {
+            std::unique_lock<std::mutex> guard(mutex);
+            requestCond.wait(guard, [this]() { return quit || !requests.empty(); });
+            if (quit)
+                return;
+            node = requests.front();
+            requests.pop_front();
+            loading = node;
+        }
+
+        points.resize(nodes[node].numPoints);
+        file.clear();
+        file.seekg(nodes[node].offset);
+        file.read((char *)points.data(), sizeof(OctreePoint) * points.size());
+        if (!file)
+        {
+            cerr << "PlugIn.PointCloud: could not read node " << node << " of " << filename << endl;
+            points.clear();
+        }
+
+        std::lock_guard<std::mutex> guard(mutex);
+        loaded.emplace_back(node, std::move(points));
+        points = std::vector<OctreePoint>();
+        loading = -1;
+    }
+}
+
+osg::Geode *PointCloudOctree::createGeode(int node, const std::vector<OctreePoint> &points)
+{
+    osg::Vec3Array *vertices = new osg::Vec3Array(points.size());
+    osg::Vec4ubArray *colors = new osg::Vec4ubArray(points.size());
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        const OctreePoint &p = points[i];
+        (*vertices)[i].set(p.x, p.y, p.z);
+        (*colors)[i].set(p.rgba & 0xff, (p.rgba >> 8) & 0xff, (p.rgba >> 16) & 0xff, 255);
+    }
+    colors->setNormalize(true);
+
+    osg::Geometry *geometry = new osg::Geometry();
+    geometry->setUseDisplayList(false);
+    geometry->setSupportsDisplayList(false);
+    geometry->setUseVertexBufferObjects(true);
+    geometry->setVertexArray(vertices);
+    geometry->setColorArray(colors, osg::Array::BIND_PER_VERTEX);
+    geometry->addPrimitiveSet(new osg::DrawArrays(osg::PrimitiveSet::POINTS, 0, (GLsizei)points.size()));
+    const OctreeNode &n = nodes[node];
+    geometry->setInitialBound(osg::BoundingBox(n.min[0], n.min[1], n.min[2], n.max[0], n.max[1], n.max[2]));
+
+    osg::Geode *geode = new osg::Geode();
+    geode->addDrawable(geometry);
+    return geode;
+}
+
+void PointCloudOctree::update(float maxError, size_t pointBudget)
+{
+    if (!isValid())
+        return;
+    ++frame;
+
+    // turn the nodes read since the last frame into geometry
+    std::vector<std::pair<int, std::vector<OctreePoint>>> arrived;
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        arrived.swap(loaded);
+    }
+    for (auto &a : arrived)
+    {
+        if (geodes[a.first])
+            continue;
+        geodes[a.first] = createGeode(a.first, a.second);
+        loadedPoints += nodes[a.first].numPoints;
+    }
+
+    // viewer position in the coordinates of the octree
+    osg::Matrix tr;
+    tr.makeIdentity();
+    osg::Group *parent = group->getNumParents() > 0 ? group->getParent(0) : nullptr;
+    while (parent != nullptr)
+    {
+        if (auto mt = dynamic_cast<osg::MatrixTransform *>(parent))
+            tr.postMult(mt->getMatrix());
+        parent = parent->getNumParents() > 0 ? parent->getParent(0) : nullptr;
+    }
+    osg::Vec3 viewer = cover->getViewerMat().getTrans() * osg::Matrix::inverse(tr);
+    // the transformation may scale: compare the spacing in world units
+    double scale = osg::Vec3(tr(0, 0), tr(0, 1), tr(0, 2)).length();
+
+    // pixels per unit of size at unit distance
+    double pixelScale = 1000.;
+    if (!coVRConfig::instance()->channels.empty())
+    {
+        const channelStruct &channel = coVRConfig::instance()->channels[0];
+        const osg::Viewport *viewport = channel.camera ? channel.camera->getViewport() : nullptr;
+        if (viewport && channel.leftProj(1, 1) > 0.)
+            pixelScale = channel.leftProj(1, 1) * viewport->height() * 0.5;
+    }
+
+    auto screenError = [&](int node) -> double
+    {
+        const OctreeNode &n = nodes[node];
+        double d2 = 0.;
+        for (int c = 0; c < 3; ++c)
+        {
+            double d = std::max(std::max(n.min[c] - viewer[c], viewer[c] - n.max[c]), 0.f);
+            d2 += d * d;
+        }
+        double distance = std::max(std::sqrt(d2) * scale, 1e-6);
+        return n.spacing * scale / distance * pixelScale;
+    };
+
+    // refine the nodes with the largest error on the screen first, a node
+    // is only refined once it is loaded, so that coarse levels appear first
+    std::priority_queue<std::pair<double, int>> candidates;
+    candidates.emplace(screenError(0), 0);
+    std::deque<int> missing;
+    size_t selectedPoints = 0;
+    while (!candidates.empty())
+    {
+        auto candidate = candidates.top();
+        candidates.pop();
+        int node = candidate.second;
+        if (selectedPoints + nodes[node].numPoints > pointBudget && selectedPoints > 0)
+            break;
+        selectedPoints += nodes[node].numPoints;
+        lastSelected[node] = frame;
+        if (!geodes[node])
+        {
+            missing.push_back(node);
+            continue;
+        }
+        if (candidate.first <= maxError)
+            continue;
+        for (int c = 0; c < 8; ++c)
+        {
+            int child = nodes[node].children[c];
+            if (child >= 0)
+                candidates.emplace(screenError(child), child);
+        }
+    }
+
+    // show the selected nodes, hide the others
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        bool show = geodes[i] && lastSelected[i] == frame;
+        if (show && !attached[i])
+            group->addChild(geodes[i].get());
+        else if (!show && attached[i])
+            group->removeChild(geodes[i].get());
+        attached[i] = show;
+    }
+
+    // evict the hidden nodes that were not needed for the longest time
+    if (loadedPoints > pointBudget)
+    {
+        std::vector<int> hidden;
+        for (size_t i = 0; i < nodes.size(); ++i)
+            if (geodes[i] && !attached[i])
+                hidden.push_back(i);
+        std::sort(hidden.begin(), hidden.end(), [this](int a, int b)
+                  { return lastSelected[a] < lastSelected[b]; });
+        for (size_t i = 0; i < hidden.size() && loadedPoints > pointBudget; ++i)
+        {
+            geodes[hidden[i]] = nullptr;
+            loadedPoints -= nodes[hidden[i]].numPoints;
+        }
+    }
+
+    // replace the requests of the last frame, but do not read nodes again
+    // that have been read since the beginning of this frame
+    std::lock_guard<std::mutex> guard(mutex);
+    missing.erase(std::remove_if(missing.begin(), missing.end(), [this](int node)
+                                 {
+                                     if (node == loading)
+                                         return true;
+                                     for (const auto &l : loaded)
+                                         if (l.first == node)
+                                             return true;
+                                     return false;
+                                 }),
+                  missing.end());
+    requests.swap(missing);
+    if (!requests.empty())
+        requestCond.notify_one();
+}
@@ -0,0 +1,78 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#ifndef _POINTCLOUD_OCTREE_H_
+#define _POINTCLOUD_OCTREE_H_
+
+#include <osg/Group>
+#include <osg/Geode>
+#include <osg/Point>
+#include <osg/ref_ptr>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "OctreeFormat.h"
+
+// renders a .pto point cloud octree: only the node table stays in memory,
+// the points of the nodes that are needed for the current view are read
+// by a background thread and dropped again when they are not visible and
+// the point budget is exceeded
+class PointCloudOctree
+{
+public:
+    PointCloudOctree(const std::string &filename);
+    ~PointCloudOctree();
+
+    bool isValid() const
+    {
+        return !nodes.empty();
+    }
+    osg::Group *getNode()
+    {
+        return group.get();
+    }
+    size_t numLoadedPoints() const
+    {
+        return loadedPoints;
+    }
+
+    // select the nodes to render, coarsest first, until the spacing of
+    // their points on the screen is below maxError pixels or pointBudget
+    // points are selected, request the missing ones and evict unused nodes
+    void update(float maxError, size_t pointBudget);
+    void setPointSize(float size);
+
+private:
+    osg::Geode *createGeode(int node, const std::vector<OctreePoint> &points);
+    void loaderLoop();
+
+    std::string filename;
+    std::vector<OctreeNode> nodes;
+    std::vector<osg::ref_ptr<osg::Geode>> geodes; // NULL if not loaded
+    std::vector<unsigned> lastSelected;
+    std::vector<bool> attached;
+    unsigned frame = 0;
+    size_t loadedPoints = 0;
+    osg::ref_ptr<osg::Group> group;
+    osg::ref_ptr<osg::Point> pointState;
+
+    // shared with the loader thread
+    std::thread loader;
+    std::mutex mutex;
+    std::condition_variable requestCond;
+    bool quit = false;
+    std::deque<int> requests; // most important first
+    int loading = -1;
+    std::vector<std::pair<int, std::vector<OctreePoint>>> loaded;
+};
+#endif
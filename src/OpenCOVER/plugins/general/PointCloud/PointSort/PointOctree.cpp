@@ -0,0 +1,424 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+// PointOctree: convert .ptsb point clouds (as written by PointConvert and
+// PointSort) into the .pto octree with level of detail, which the PointCloud
+// plugin pages in and out while rendering
+//
+// Every node keeps one point per cell of a grid laid over its cube and
+// passes the others on to its children. Parts of the tree with more points
+// than fit into memory are distributed to temporary files next to the
+// output file, so that the size of the input is only limited by the disk.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <iostream>
+#include <string.h>
+#include <float.h>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <util/unixcompat.h>
+
+#include "../OctreeFormat.h"
+
+using namespace std;
+
+static uint32_t maxNodePoints = 65536; // nodes with less points become leaves
+static uint64_t maxMemoryPoints = 32 * 1024 * 1024; // larger subtrees are built from temporary files
+static int gridSize = 128; // cells per edge of the subsampling grid of a node
+static const int MaxDepth = 24;
+static const size_t BlockPoints = 1024 * 1024;
+
+static string outName;
+static FILE *outFile = NULL;
+static uint64_t written = 0;
+static int numTmpFiles = 0;
+static vector<OctreeNode> nodes;
+
+// input files of multi-billion point scans are larger than 2 GB
+static int seekTo(FILE *f, int64_t pos)
+{
+#ifdef _WIN32
+    return _fseeki64(f, pos, SEEK_SET);
+#else
+    return fseeko(f, (off_t)pos, SEEK_SET);
+#endif
+}
+
+static string tmpName()
+{
+    return outName + ".tmp" + to_string(numTmpFiles++);
+}
+
+static int octant(const OctreePoint &p, const OctreeNode &node)
+{
+    int oct = 0;
+    if (p.x >= 0.5f * (node.min[0] + node.max[0]))
+        oct |= 1;
+    if (p.y >= 0.5f * (node.min[1] + node.max[1]))
+        oct |= 2;
+    if (p.z >= 0.5f * (node.min[2] + node.max[2]))
+        oct |= 4;
+    return oct;
+}
+
+static size_t cellIndex(const OctreePoint &p, const OctreeNode &node)
+{
+    const float *c = &p.x;
+    size_t cell = 0;
+    for (int d = 2; d >= 0; --d)
+    {
+        int i = (int)((c[d] - node.min[d]) / (node.max[d] - node.min[d]) * gridSize);
+        i = std::max(0, std::min(gridSize - 1, i));
+        cell = cell * gridSize + i;
+    }
+    return cell;
+}
+
+static int addChild(int parent, int oct)
+{
+    OctreeNode child;
+    for (int d = 0; d < 3; ++d)
+    {
+        float center = 0.5f * (nodes[parent].min[d] + nodes[parent].max[d]);
+        child.min[d] = (oct & (1 << d)) ? center : nodes[parent].min[d];
+        child.max[d] = (oct & (1 << d)) ? nodes[parent].max[d] : center;
+    }
+    child.spacing = (child.max[0] - child.min[0]) / gridSize;
+    child.numPoints = 0;
+    child.offset = 0;
+    for (int i = 0; i < 8; ++i)
+        child.children[i] = -1;
+    nodes.push_back(child);
+    int index = (int)nodes.size() - 1;
+    nodes[parent].children[oct] = index;
+    return index;
+}
+
+static void writePoints(int node, const OctreePoint *p, size_t n)
+{
+    nodes[node].offset = sizeof(OctreeHeader) + written * sizeof(OctreePoint);
+    nodes[node].numPoints = (uint32_t)n;
+    if (n > 0 && fwrite(p, sizeof(OctreePoint), n, outFile) != n)
+    {
+        cerr << "error writing to " << outName << endl;
+        exit(1);
+    }
+    written += n;
+}
+
+// move one point per grid cell to the front of p and return their number
+static size_t subsample(const OctreeNode &node, OctreePoint *p, size_t n)
+{
+    vector<bool> occupied((size_t)gridSize * gridSize * gridSize);
+    size_t numSelected = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        size_t cell = cellIndex(p[i], node);
+        if (!occupied[cell])
+        {
+            occupied[cell] = true;
+            std::swap(p[i], p[numSelected++]);
+        }
+    }
+    return numSelected;
+}
+
+static void buildInMemory(int node, OctreePoint *p, size_t n, int depth)
+{
+    if (n <= maxNodePoints || depth >= MaxDepth)
+    {
+        writePoints(node, p, n);
+        return;
+    }
+
+    size_t numSelected = subsample(nodes[node], p, n);
+    writePoints(node, p, numSelected);
+
+    // sort the remaining points by octant
+    OctreePoint *begin = p + numSelected, *end = p + n;
+    OctreePoint *bounds[9];
+    bounds[0] = begin;
+    bounds[8] = end;
+    const OctreeNode cube = nodes[node];
+    bounds[4] = std::partition(begin, end, [&](const OctreePoint &q) { return !(octant(q, cube) & 4); });
+    for (int z = 0; z < 8; z += 4)
+    {
+        bounds[z + 2] = std::partition(bounds[z], bounds[z + 4], [&](const OctreePoint &q) { return !(octant(q, cube) & 2); });
+        for (int y = z; y < z + 4; y += 2)
+            bounds[y + 1] = std::partition(bounds[y], bounds[y + 2], [&](const OctreePoint &q) { return !(octant(q, cube) & 1); });
+    }
+
+    for (int oct = 0; oct < 8; ++oct)
+    {
+        size_t count = bounds[oct + 1] - bounds[oct];
+        if (count > 0)
+            buildInMemory(addChild(node, oct), bounds[oct], count, depth + 1);
+    }
+}
+
+static void buildFromFile(int node, const string &name, uint64_t n, int depth)
+{
+    FILE *in = fopen(name.c_str(), "rb");
+    if (!in)
+    {
+        cerr << "error opening temporary file " << name << endl;
+        exit(1);
+    }
+
+    if (n <= maxMemoryPoints || depth >= MaxDepth)
+    {
+        vector<OctreePoint> points(n);
+        if (fread(points.data(), sizeof(OctreePoint), n, in) != n)
+        {
+            cerr << "error reading temporary file " << name << endl;
+            exit(1);
+        }
+        fclose(in);
+        remove(name.c_str());
+        buildInMemory(node, points.data(), n, depth);
+        return;
+    }
+
+    // too many points: keep one per grid cell and stream the others to files for the children
+    const OctreeNode cube = nodes[node];
+    vector<bool> occupied((size_t)gridSize * gridSize * gridSize);
+    vector<OctreePoint> selected;
+    FILE *childFile[8] = { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+    string childName[8];
+    uint64_t childCount[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+    vector<OctreePoint> block(BlockPoints);
+    size_t numRead;
+    while ((numRead = fread(block.data(), sizeof(OctreePoint), BlockPoints, in)) > 0)
+    {
+        for (size_t i = 0; i < numRead; ++i)
+        {
+            const OctreePoint &p = block[i];
+            size_t cell = cellIndex(p, cube);
+            if (!occupied[cell])
+            {
+                occupied[cell] = true;
+                selected.push_back(p);
+                continue;
+            }
+            int oct = octant(p, cube);
+            if (!childFile[oct])
+            {
+                childName[oct] = tmpName();
+                childFile[oct] = fopen(childName[oct].c_str(), "wb");
+                if (!childFile[oct])
+                {
+                    cerr << "error creating temporary file " << childName[oct] << endl;
+                    exit(1);
+                }
+            }
+            fwrite(&p, sizeof(OctreePoint), 1, childFile[oct]);
+            ++childCount[oct];
+        }
+    }
+    fclose(in);
+    remove(name.c_str());
+
+    writePoints(node, selected.data(), selected.size());
+    selected.clear();
+    selected.shrink_to_fit();
+
+    for (int oct = 0; oct < 8; ++oct)
+    {
+        if (!childFile[oct])
+            continue;
+        fclose(childFile[oct]);
+        buildFromFile(addChild(node, oct), childName[oct], childCount[oct], depth + 1);
+    }
+}
+
+// append the points of a .ptsb file to tmp: a number of sets, each with its
+// size, all coordinates and then all colors
+static bool readPtsb(const char *filename, FILE *tmp, uint64_t &count, float min[3], float max[3])
+{
+    FILE *coords = fopen(filename, "rb");
+    FILE *colors = fopen(filename, "rb");
+    if (!coords || !colors)
+    {
+        cerr << "error opening " << filename << endl;
+        if (coords)
+            fclose(coords);
+        if (colors)
+            fclose(colors);
+        return false;
+    }
+
+    int numSets = 0;
+    if (fread(&numSets, sizeof(int), 1, coords) != 1)
+        numSets = 0;
+    cout << "Reading " << numSets << " sets from " << filename << endl;
+
+    vector<float> xyz(3 * BlockPoints);
+    vector<uint32_t> rgba(BlockPoints);
+    vector<OctreePoint> block(BlockPoints);
+    int64_t setStart = sizeof(int);
+    for (int s = 0; s < numSets; ++s)
+    {
+        int size = 0;
+        seekTo(coords, setStart);
+        if (fread(&size, sizeof(int), 1, coords) != 1)
+        {
+            cerr << "error reading set " << s << " of " << filename << endl;
+            break;
+        }
+        int64_t colorStart = setStart + sizeof(int) + 3 * sizeof(float) * (int64_t)size;
+        seekTo(colors, colorStart);
+        for (int done = 0; done < size;)
+        {
+            size_t n = std::min((size_t)(size - done), BlockPoints);
+            if (fread(xyz.data(), 3 * sizeof(float), n, coords) != n || fread(rgba.data(), sizeof(uint32_t), n, colors) != n)
+            {
+                cerr << "unexpected end of " << filename << endl;
+                fclose(coords);
+                fclose(colors);
+                return false;
+            }
+            for (size_t i = 0; i < n; ++i)
+            {
+                OctreePoint &p = block[i];
+                p.x = xyz[3 * i];
+                p.y = xyz[3 * i + 1];
+                p.z = xyz[3 * i + 2];
+                p.rgba = rgba[i];
+                const float *c = &p.x;
+                for (int d = 0; d < 3; ++d)
+                {
+                    min[d] = std::min(min[d], c[d]);
+                    max[d] = std::max(max[d], c[d]);
+                }
+            }
+            fwrite(block.data(), sizeof(OctreePoint), n, tmp);
+            count += n;
+            done += (int)n;
+        }
+        setStart = colorStart + sizeof(uint32_t) * (int64_t)size;
+    }
+    fclose(coords);
+    fclose(colors);
+    return true;
+}
+
+static void printHelpPage()
+{
+    cout << endl;
+    cout << "PointOctree - converts .ptsb point clouds into a level of detail octree for the PointCloud plugin" << endl;
+    cout << endl;
+    cout << "Usage: PointOctree [options ...] inputfile.ptsb [inputfiles] outputfile.pto" << endl;
+    cout << endl;
+    cout << "Options:" << endl;
+    cout << "  -h          this help" << endl;
+    cout << "  -n <num>    maximum number of points in a leaf node (default 65536)" << endl;
+    cout << "  -g <num>    cells per edge of the subsampling grid of a node (default 128)" << endl;
+    cout << "  -m <num>    maximum number of points sorted in memory (default 33554432)" << endl;
+    cout << endl;
+}
+
+int main(int argc, char **argv)
+{
+    vector<const char *> inputs;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-h") == 0)
+        {
+            printHelpPage();
+            return 0;
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "-n") == 0)
+            maxNodePoints = (uint32_t)std::max(1L, atol(argv[++i]));
+        else if (i + 1 < argc && strcmp(argv[i], "-g") == 0)
+            gridSize = std::max(2, std::min(1024, atoi(argv[++i])));
+        else if (i + 1 < argc && strcmp(argv[i], "-m") == 0)
+            maxMemoryPoints = (uint64_t)std::max(1LL, atoll(argv[++i]));
+        else
+            inputs.push_back(argv[i]);
+    }
+    if (inputs.size() < 2)
+    {
+        cout << "error: at least one input and the output file are required" << endl;
+        printHelpPage();
+        return -1;
+    }
+    outName = inputs.back();
+    inputs.pop_back();
+
+    // collect all points in one temporary file
+    string rootName = tmpName();
+    FILE *tmp = fopen(rootName.c_str(), "wb");
+    if (!tmp)
+    {
+        cerr << "error creating temporary file " << rootName << endl;
+        return -1;
+    }
+    uint64_t numPoints = 0;
+    float min[3] = { FLT_MAX, FLT_MAX, FLT_MAX }, max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (const char *input : inputs)
+        readPtsb(input, tmp, numPoints, min, max);
+    fclose(tmp);
+    if (numPoints == 0)
+    {
+        cout << "Did not read any data" << endl;
+        remove(rootName.c_str());
+        return -1;
+    }
+
+    // the root node is the smallest cube around all points
+    OctreeNode root;
+    float edge = 0.f;
+    for (int d = 0; d < 3; ++d)
+        edge = std::max(edge, max[d] - min[d]);
+    edge = edge * 1.0001f + FLT_MIN;
+    for (int d = 0; d < 3; ++d)
+    {
+        float center = 0.5f * (min[d] + max[d]);
+        root.min[d] = center - 0.5f * edge;
+        root.max[d] = center + 0.5f * edge;
+    }
+    root.spacing = edge / gridSize;
+    root.numPoints = 0;
+    root.offset = 0;
+    for (int i = 0; i < 8; ++i)
+        root.children[i] = -1;
+    nodes.push_back(root);
+
+    outFile = fopen(outName.c_str(), "wb");
+    if (!outFile)
+    {
+        cerr << "error creating " << outName << endl;
+        remove(rootName.c_str());
+        return -1;
+    }
+    OctreeHeader header;
+    memset(&header, 0, sizeof(header));
+    fwrite(&header, sizeof(header), 1, outFile);
+
+    cout << "Sorting " << numPoints << " points into octree" << endl;
+    buildFromFile(0, rootName, numPoints, 0);
+
+    memcpy(header.magic, OCTREE_MAGIC, sizeof(header.magic));
+    header.version = OCTREE_VERSION;
+    header.numNodes = (uint32_t)nodes.size();
+    header.numPoints = written;
+    header.nodeTableOffset = sizeof(OctreeHeader) + written * sizeof(OctreePoint);
+    for (int d = 0; d < 3; ++d)
+    {
+        header.min[d] = min[d];
+        header.max[d] = max[d];
+    }
+    fwrite(nodes.data(), sizeof(OctreeNode), nodes.size(), outFile);
+    seekTo(outFile, 0);
+    fwrite(&header, sizeof(header), 1, outFile);
+    fclose(outFile);
+
+    cout << "Wrote " << written << " points in " << nodes.size() << " nodes to " << outName << endl;
+    return 0;
+}
@@ -0,0 +1,283 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#include "coCellSearch.h"
+#include <do/coDoUnstructuredGrid.h>
+#include <util/coThreadPool.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace covise;
+
+// cells are handled in blocks when computing their ranges and boxes
+static const int BlockSize = 16384;
+
+static void forBlocks(int numElem, const std::function<void(int begin, int end)> &func)
+{
+    size_t numBlocks = (numElem + BlockSize - 1) / BlockSize;
+    coThreadPool::global().run(numBlocks, [&](size_t b, int)
+                               { func((int)b * BlockSize, std::min(numElem, (int)(b + 1) * BlockSize)); });
+}
+
+//========================= coCellIntervalTree =========================
+
+coCellIntervalTree::coCellIntervalTree(int numElem, const int *el, const int *cl, const int *tl, const float *data)
+    : num_elem(numElem)
+    , standard_cells(false)
+    , polyhedral_cells(false)
+    , cell_min(numElem)
+    , cell_max(numElem)
+{
+    std::vector<char> valid(numElem);
+    forBlocks(numElem, [&](int begin, int end)
+              {
+                  for (int e = begin; e < end; e++)
+                  {
+                      int n = UnstructuredGrid_Num_Nodes[tl[e]];
+                      valid[e] = n > 0;
+                      if (n <= 0)
+                          continue;
+                      const int *nodes = cl + el[e];
+                      float mi = data[nodes[0]], ma = mi;
+                      for (int i = 1; i < n; i++)
+                      {
+                          mi = std::min(mi, data[nodes[i]]);
+                          ma = std::max(ma, data[nodes[i]]);
+                      }
+                      cell_min[e] = mi;
+                      cell_max[e] = ma;
+                  }
+              });
+
+    std::vector<int> cells;
+    cells.reserve(numElem);
+    for (int e = 0; e < numElem; e++)
+    {
+        if (valid[e])
+            cells.push_back(e);
+        if (UnstructuredGrid_Num_Nodes[tl[e]] == -1)
+            polyhedral_cells = true;
+        else
+            standard_cells = true;
+    }
+    by_min.reserve(cells.size());
+    by_max.reserve(cells.size());
+    if (!cells.empty())
+        build(cells, 0, cells.size());
+    std::vector<float>().swap(cell_min);
+    std::vector<float>().swap(cell_max);
+}
+
+// node with the median of the cell centers, the cells completely below go
+// to the left subtree and those completely above to the right one
+int coCellIntervalTree::build(std::vector<int> &cells, size_t begin, size_t end)
+{
+    auto center = [this](int c)
+    {
+        return 0.5f * (cell_min[c] + cell_max[c]);
+    };
+    size_t median = begin + (end - begin) / 2;
+    std::nth_element(cells.begin() + begin, cells.begin() + median, cells.begin() + end,
+                     [&center](int a, int b)
+                     { return center(a) < center(b); });
+    float c = center(cells[median]);
+
+    auto below = std::partition(cells.begin() + begin, cells.begin() + end,
+                                [this, c](int e)
+                                { return cell_max[e] < c; });
+    auto above = std::partition(below, cells.begin() + end,
+                                [this, c](int e)
+                                { return cell_min[e] <= c; });
+
+    int index = (int)nodes.size();
+    nodes.push_back({ c, -1, -1, (int)by_min.size(), (int)(above - below) });
+    for (auto it = below; it != above; ++it)
+    {
+        by_min.push_back({ cell_min[*it], *it });
+        by_max.push_back({ cell_max[*it], *it });
+    }
+    std::sort(by_min.begin() + nodes[index].begin, by_min.end(),
+              [](const Entry &a, const Entry &b)
+              { return a.bound < b.bound; });
+    std::sort(by_max.begin() + nodes[index].begin, by_max.end(),
+              [](const Entry &a, const Entry &b)
+              { return a.bound > b.bound; });
+
+    size_t numBelow = below - (cells.begin() + begin);
+    size_t numAbove = cells.begin() + end - above;
+    size_t aboveBegin = above - cells.begin();
+    if (numBelow > 0)
+    {
+        int left = build(cells, begin, begin + numBelow);
+        nodes[index].left = left;
+    }
+    if (numAbove > 0)
+    {
+        int right = build(cells, aboveBegin, end);
+        nodes[index].right = right;
+    }
+    return index;
+}
+
+void coCellIntervalTree::query(float value, std::vector<int> &cells) const
+{
+    cells.clear();
+    int n = nodes.empty() ? -1 : 0;
+    while (n >= 0)
+    {
+        // all ranges of the node contain its center
+        const Node &node = nodes[n];
+        if (value <= node.center)
+        {
+            for (int i = node.begin; i < node.begin + node.count && by_min[i].bound <= value; i++)
+                cells.push_back(by_min[i].cell);
+            n = value < node.center ? node.left : -1;
+        }
+        else
+        {
+            for (int i = node.begin; i < node.begin + node.count && by_max[i].bound >= value; i++)
+                cells.push_back(by_max[i].cell);
+            n = node.right;
+        }
+    }
+    std::sort(cells.begin(), cells.end());
+}
+
+//============================= coCellBVH ==============================
+
+// cells per leaf
+static const size_t LeafSize = 16;
+
+coCellBVH::coCellBVH(int numElem, int numConn, const int *el, const int *cl, const int *tl,
+                     const float *x, const float *y, const float *z)
+    : num_elem(numElem)
+{
+    // min x, y, z and max x, y, z per cell
+    std::vector<float> box(6 * (size_t)numElem);
+    std::vector<char> valid(numElem);
+    forBlocks(numElem, [&](int begin, int end)
+              {
+                  for (int e = begin; e < end; e++)
+                  {
+                      int n = UnstructuredGrid_Num_Nodes[tl[e]];
+                      if (tl[e] == TYPE_POLYHEDRON)
+                          n = ((e < numElem - 1) ? el[e + 1] : numConn) - el[e];
+                      valid[e] = n > 0;
+                      if (n <= 0)
+                          continue;
+                      const int *nodes = cl + el[e];
+                      float *b = &box[6 * (size_t)e];
+                      b[0] = b[3] = x[nodes[0]];
+                      b[1] = b[4] = y[nodes[0]];
+                      b[2] = b[5] = z[nodes[0]];
+                      for (int i = 1; i < n; i++)
+                      {
+                          b[0] = std::min(b[0], x[nodes[i]]);
+                          b[1] = std::min(b[1], y[nodes[i]]);
+                          b[2] = std::min(b[2], z[nodes[i]]);
+                          b[3] = std::max(b[3], x[nodes[i]]);
+                          b[4] = std::max(b[4], y[nodes[i]]);
+                          b[5] = std::max(b[5], z[nodes[i]]);
+                      }
+                  }
+              });
+
+    order.reserve(numElem);
+    for (int e = 0; e < numElem; e++)
+    {
+        if (valid[e])
+            order.push_back(e);
+    }
+    if (!order.empty())
+        build(box, 0, order.size());
+}
+
+// split at the median of the cell centers along the longest axis
+int coCellBVH::build(const std::vector<float> &box, size_t begin, size_t end)
+{
+    float lo[3] = { FLT_MAX, FLT_MAX, FLT_MAX }, hi[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    float clo[3] = { FLT_MAX, FLT_MAX, FLT_MAX }, chi[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (size_t i = begin; i < end; i++)
+    {
+        const float *b = &box[6 * (size_t)order[i]];
+        for (int a = 0; a < 3; a++)
+        {
+            lo[a] = std::min(lo[a], b[a]);
+            hi[a] = std::max(hi[a], b[a + 3]);
+            float c = b[a] + b[a + 3];
+            clo[a] = std::min(clo[a], c);
+            chi[a] = std::max(chi[a], c);
+        }
+    }
+
+    int index = (int)nodes.size();
+    Node node;
+    for (int a = 0; a < 3; a++)
+    {
+        node.center[a] = 0.5f * (lo[a] + hi[a]);
+        node.extent[a] = 0.5f * (hi[a] - lo[a]);
+    }
+    node.left = node.right = -1;
+    node.begin = (int)begin;
+    node.count = (int)(end - begin);
+    nodes.push_back(node);
+
+    int axis = 0;
+    for (int a = 1; a < 3; a++)
+    {
+        if (chi[a] - clo[a] > chi[axis] - clo[axis])
+            axis = a;
+    }
+    if (end - begin <= LeafSize || chi[axis] <= clo[axis])
+        return index;
+
+    size_t median = begin + (end - begin) / 2;
+    std::nth_element(order.begin() + begin, order.begin() + median, order.begin() + end,
+                     [&box, axis](int a, int b)
+                     {
+                         return box[6 * (size_t)a + axis] + box[6 * (size_t)a + axis + 3]
+                                < box[6 * (size_t)b + axis] + box[6 * (size_t)b + axis + 3];
+                     });
+    int left = build(box, begin, median);
+    int right = build(box, median, end);
+    nodes[index].left = left;
+    nodes[index].right = right;
+    return index;
+}
+
+void coCellBVH::queryPlane(float nx, float ny, float nz, float d, std::vector<int> &cells) const
+{
+    cells.clear();
+    if (nodes.empty())
+        return;
+
+    std::vector<int> stack(1, 0);
+    while (!stack.empty())
+    {
+        const Node &node = nodes[stack.back()];
+        stack.pop_back();
+
+        // the nodes are classified with float arithmetic in a different
+        // order, so keep some distance to the plane
+        float s = nx * node.center[0] + ny * node.center[1] + nz * node.center[2] - d;
+        float r = std::abs(nx) * node.extent[0] + std::abs(ny) * node.extent[1] + std::abs(nz) * node.extent[2];
+        float eps = 1e-5f * (std::abs(nx * node.center[0]) + std::abs(ny * node.center[1]) + std::abs(nz * node.center[2]) + std::abs(d) + r);
+        if (std::abs(s) > r + eps)
+            continue;
+
+        if (node.left < 0)
+            cells.insert(cells.end(), order.begin() + node.begin, order.begin() + node.begin + node.count);
+        else
+        {
+            stack.push_back(node.right);
+            stack.push_back(node.left);
+        }
+    }
+    std::sort(cells.begin(), cells.end());
+}
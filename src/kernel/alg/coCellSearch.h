@@ -0,0 +1,214 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#ifndef CO_CELL_SEARCH_H
+#define CO_CELL_SEARCH_H
+
+#include <util/coExport.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//*****************************************************************//
+// search structures for the cells of an unstructured grid that may be
+// cut by an isosurface or a cutting plane, so that repeated queries on
+// the same grid only have to look at these cells
+//*****************************************************************//
+
+namespace covise
+{
+
+// interval tree over the ranges of a scalar field in the cells
+class ALGEXPORT coCellIntervalTree
+{
+public:
+    // polyhedral cells are left out
+    coCellIntervalTree(int numElem, const int *el, const int *cl, const int *tl, const float *data);
+
+    // ascending list of the cells with min <= value <= max
+    void query(float value, std::vector<int> &cells) const;
+
+    int numCells() const
+    {
+        return num_elem;
+    }
+    bool hasStandardCells() const
+    {
+        return standard_cells;
+    }
+    bool hasPolyhedralCells() const
+    {
+        return polyhedral_cells;
+    }
+    size_t bytes() const
+    {
+        return (cell_min.capacity() + cell_max.capacity()) * sizeof(float)
+               + nodes.capacity() * sizeof(Node)
+               + (by_min.capacity() + by_max.capacity()) * sizeof(Entry);
+    }
+
+private:
+    struct Entry
+    {
+        float bound;
+        int cell;
+    };
+    struct Node
+    {
+        float center;
+        int left, right; // -1: none
+        int begin, count; // range in by_min and by_max
+    };
+
+    int build(std::vector<int> &cells, size_t begin, size_t end);
+
+    int num_elem;
+    bool standard_cells, polyhedral_cells;
+    std::vector<float> cell_min, cell_max;
+    std::vector<Node> nodes;
+    std::vector<Entry> by_min; // per node: ascending min
+    std::vector<Entry> by_max; // per node: descending max
+};
+
+// bounding volume hierarchy over the bounding boxes of the cells
+class ALGEXPORT coCellBVH
+{
+public:
+    // polyhedra are bounded by all their entries in cl, numConn is needed
+    // for the extent of the last element
+    coCellBVH(int numElem, int numConn, const int *el, const int *cl, const int *tl,
+              const float *x, const float *y, const float *z);
+
+    // ascending list of the cells whose bounding box touches the plane
+    // nx*x + ny*y + nz*z = d
+    void queryPlane(float nx, float ny, float nz, float d, std::vector<int> &cells) const;
+
+    int numCells() const
+    {
+        return num_elem;
+    }
+    size_t bytes() const
+    {
+        return nodes.capacity() * sizeof(Node) + order.capacity() * sizeof(int);
+    }
+
+private:
+    struct Node
+    {
+        float center[3], extent[3];
+        int left, right; // children, -1 for leaves
+        int begin, count; // range in order for leaves
+    };
+
+    int build(const std::vector<float> &box, size_t begin, size_t end);
+
+    int num_elem;
+    std::vector<Node> nodes;
+    std::vector<int> order;
+};
+
+// keeps search structures across executions of a module as long as the
+// objects they have been built for keep their names; call prune() once
+// per execution to drop the structures that have not been used since.
+// The structures take at most maxBytes: when a new one would exceed it,
+// the least recently used ones are dropped, e.g. for long timestep sets.
+template <class T>
+class coCellSearchCache
+{
+public:
+    explicit coCellSearchCache(size_t maxBytes = (size_t)256 << 20)
+        : max_bytes(maxBytes)
+    {
+    }
+
+    // the structure for key, created by build() on the second request:
+    // building it only pays off when the same objects are queried again
+    template <class Build>
+    std::shared_ptr<T> get(const std::string &key, Build build)
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        auto it = entries.find(key);
+        if (it == entries.end())
+        {
+            Entry &entry = entries[key];
+            entry.used = true;
+            entry.last_use = ++use_count;
+            return std::shared_ptr<T>();
+        }
+        Entry &entry = it->second;
+        entry.used = true;
+        entry.last_use = ++use_count;
+        if (!entry.search)
+        {
+            entry.search.reset(build());
+            entry.bytes = entry.search->bytes();
+            total_bytes += entry.bytes;
+            evict(it);
+        }
+        return entry.search;
+    }
+
+    void prune()
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        for (auto it = entries.begin(); it != entries.end();)
+        {
+            if (!it->second.used)
+            {
+                total_bytes -= it->second.bytes;
+                it = entries.erase(it);
+            }
+            else
+            {
+                it->second.used = false;
+                ++it;
+            }
+        }
+    }
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<T> search;
+        bool used = false;
+        unsigned long last_use = 0;
+        size_t bytes = 0;
+    };
+    typedef typename std::map<std::string, Entry>::iterator Iterator;
+
+    // drop the least recently used structures except keep's until they fit
+    // into max_bytes: modules still holding one can go on using it
+    void evict(Iterator keep)
+    {
+        while (total_bytes > max_bytes)
+        {
+            Iterator oldest = entries.end();
+            for (auto it = entries.begin(); it != entries.end(); ++it)
+            {
+                if (it != keep && it->second.search
+                    && (oldest == entries.end() || it->second.last_use < oldest->second.last_use))
+                    oldest = it;
+            }
+            if (oldest == entries.end())
+                break;
+            total_bytes -= oldest->second.bytes;
+            oldest->second.search.reset();
+            oldest->second.bytes = 0;
+        }
+    }
+
+    std::mutex mutex;
+    std::map<std::string, Entry> entries;
+    size_t max_bytes;
+    size_t total_bytes = 0;
+    unsigned long use_count = 0;
+};
+}
+#endif
@@ -8,6 +8,7 @@
 #include <appl/ApplInterface.h>
 #include "coCuttingSurface.h"
 #include "CuttingTables.h"
+#include "coCellSearch.h"
 #include <do/coDistributedObject.h>
 #include <do/coDoUnstructuredGrid.h>
 #include <do/coDoUniformGrid.h>
@@ -321,6 +322,7 @@ void Plane::initialize()
     I_Data_p = NULL;
     node_table = NULL;
     iblank = NULL;
+    cell_search = NULL;
 }
 
 Plane::~Plane()
@@ -359,9 +361,16 @@ Plane::~Plane()
 
 bool Plane::createPlane()
 {
+    std::vector<int> cells;
+    bool searched = cell_search && option == 0 && !iblank;
+    if (searched)
+        cell_search->queryPlane(planei, planej, planek, myDistance, cells);
+    int num_visited = searched ? (int)cells.size() : num_elem;
+
     // 1 = above; 0 = below
-    for (int element = 0; element < num_elem; element++)
+    for (int cell = 0; cell < num_visited; cell++)
     {
+        int element = searched ? cells[cell] : cell;
         if (iblank == NULL || iblank[element] != '\0')
         {
             int elementtype = tl[element];
@@ -413,6 +422,7 @@ bool Plane::createPlane()
     {
         Covise::sendInfo("Used %d of %d vertices: Usage=%f%%",
                          num_coords, max_coords, ((float)num_coords) / max_coords);
+        Covise::sendInfo("Visited %d of %d cells", num_visited, num_elem);
     }
     return true;
 }
@@ -4261,8 +4271,16 @@ bool POLYHEDRON_Plane::createPlane()
             first_sign = 0;
             current_sign = 2;
 
-            for (elem_count = 0; elem_count < num_elem_in; elem_count++)
+            // the search finds a superset of the cut cells in ascending order
+            std::vector<int> cells;
+            bool searched = cell_search && cell_search->numCells() == num_elem_in;
+            if (searched)
+                cell_search->queryPlane(unit_normal_vector.x, unit_normal_vector.y, unit_normal_vector.z, distance, cells);
+            int num_visited = searched ? (int)cells.size() : num_elem_in;
+
+            for (int cell = 0; cell < num_visited; cell++)
             {
+                elem_count = searched ? cells[cell] : cell;
                 /*  Avoid additional calculations if the cell is not cut by the sampling plane */
                 cell_intersection = false;
                 next_elem_index = (elem_count < num_elem_in - 1) ? elem_in[elem_count + 1] : num_conn_in;
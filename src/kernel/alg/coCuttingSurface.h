@@ -33,6 +33,7 @@ class coDoUniformGrid;
 class coDoRectilinearGrid;
 class coDoStructuredGrid;
 class CuttingSurface;
+class coCellBVH;
 
 typedef struct NodeInfo_s
 {
@@ -152,6 +153,9 @@ private:
 
     float x_minb, y_minb, z_minb, x_maxb, y_maxb, z_maxb;
 
+    // the elements that can be cut, see useCellSearch()
+    const coCellBVH *cell_search;
+
     static float gsin(float angle);
     static float gcos(float angle);
     static int trs2pol(int nb_con, int nb_tr, int *trv, int *tr_list, int *plv, int *pol_list);
@@ -224,6 +228,15 @@ public:
     virtual bool createPlane();
     virtual void createStrips();
 
+    // only visit the elements of an unstructured grid whose bounding boxes
+    // search finds on a planar cut, search has to be built for the grid of
+    // this plane; not used together with iblanking, also used by
+    // POLYHEDRON_Plane
+    void useCellSearch(const coCellBVH *search)
+    {
+        cell_search = search;
+    }
+
     virtual void createcoDistributedObjects(const char *Data_name_scal, const char *Data_name_vect,
                                             const char *Normal_name, const char *Triangle_name,
                                             AttributeContainer &gridAttrs, AttributeContainer &dataAttrs);
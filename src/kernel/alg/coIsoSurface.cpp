@@ -14,6 +14,12 @@
 #include <do/coDoTriangleStrips.h>
 #include <api/coOutputPort.h>
 #include <api/coModule.h>
+#include <util/coThreadPool.h>
+#include "coCellSearch.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
 
 using namespace covise;
 
@@ -60,9 +66,6 @@ using namespace covise;
     else                                                                                                                    \
         add_vertex(n2, n1, ii + x_add[a2], jj + y_add[a2], kk + z_add[a2], ii + x_add[a1], jj + y_add[a1], kk + z_add[a1]);
 
-// lazy eval: set from covise.config upon 1st usage. default=17
-int IsoPlane::maxTriPerVertex = -1;
-
 namespace covise
 {
 // commodity function: read an it with a default value.
@@ -72,6 +75,14 @@ static int readConfig(const char *varName, int defaultValue)
 }
 }
 
+// lazy eval: set from covise.config upon 1st usage. default=17,
+// initialized once, as planes may be created on several threads
+int IsoPlane::maxTriPerVertex()
+{
+    static const int maxTri = readConfig("Module.IsoSurface.MaxTrianglesPerVertex", 17);
+    return maxTri;
+}
+
 IsoPlane::IsoPlane()
     : vertice_list(NULL)
     , coords_x(NULL)
@@ -82,9 +93,9 @@ IsoPlane::IsoPlane()
     , V_Data_W(NULL)
     , S_Data(NULL)
     , node_table(NULL)
+    , chunk(NULL)
+    , cell_search(NULL)
 {
-    if (maxTriPerVertex < 0)
-        maxTriPerVertex = readConfig("Module.IsoSurface.MaxTrianglesPerVertex", 17);
 }
 
 IsoPlane::IsoPlane(int n_elem, int n_nodes, int Type, float cutVertexRatio,
@@ -117,10 +128,10 @@ IsoPlane::IsoPlane(int n_elem, int n_nodes, int Type, float cutVertexRatio,
     , node_table(NULL)
     , _isovalue(isovalue)
     , _isConnected(isConnected)
+    , chunk(NULL)
+    , cell_search(NULL)
 {
     iblank = ib;
-    if (maxTriPerVertex < 0)
-        maxTriPerVertex = readConfig("Module.IsoSurface.MaxTrianglesPerVertex", 17);
 
     NodeInfo *node;
     int i;
@@ -204,6 +215,8 @@ IsoPlane::IsoPlane(int n_elem, int n_nodes, int Type, /*float cutVertexRatio,*/
     , node_table(NULL)
     , _isovalue(isovalue)
     , _isConnected(isConnected)
+    , chunk(NULL)
+    , cell_search(NULL)
 {
     iblank = ib;
 
@@ -335,7 +348,24 @@ RECT_IsoPlane::RECT_IsoPlane(int n_elem, int n_nodes, int Type,
 
 bool IsoPlane::createIsoPlane()
 {
-    bool standard_cells_found;
+    standard_cells_found = false;
+    polyhedral_cells_found = false;
+    if (cell_search && !iblank)
+    {
+        std::shared_ptr<std::vector<int> > cells(new std::vector<int>);
+        cell_search->query(_isovalue, *cells);
+        active_cells = cells;
+        standard_cells_found = cell_search->hasStandardCells();
+        polyhedral_cells_found = cell_search->hasPolyhedralCells();
+    }
+    if (!extract())
+        return false;
+    // No standard cells found in the dataset
+    return standard_cells_found;
+}
+
+bool IsoPlane::extractCells(int begin, int end)
+{
     int element;
     int bitmap; // index in the MarchingCubes table
     // 1 = above; 0 = below
@@ -354,11 +384,11 @@ bool IsoPlane::createIsoPlane()
     for (i = 0; i < 256; i++)
         cases[i] = 0;
 #endif
-    standard_cells_found = false;
-    polyhedral_cells_found = false;
-
-    for (element = 0; element < num_elem; element++)
+    for (int cell = begin; cell < end; cell++)
     {
+        element = active_cells ? (*active_cells)[cell] : cell;
+        if (chunk)
+            reserve_chunk_vertices();
         if (iblank == NULL || iblank[element] != '\0')
         {
             elementtype = tl[element];
@@ -920,15 +950,17 @@ bool IsoPlane::createIsoPlane()
     for (i = 0; i < 256; i++)
         fprintf(stderr, " %d : %d\n", i, cases[i]);
 #endif
-    // No standard cells found in the dataset
-    if (standard_cells_found == false)
-    {
-        return false;
-    }
     return true;
 }
 
 void UNI_IsoPlane::createIsoPlane()
+{
+    standard_cells_found = false;
+    polyhedral_cells_found = false;
+    extract();
+}
+
+bool UNI_IsoPlane::extractCells(int begin, int end)
 {
     int bitmap; // index in the MarchingCubes table
     // 1 = above; 0 = below
@@ -950,14 +982,18 @@ void UNI_IsoPlane::createIsoPlane()
     *n_6 = (*n_2) + 1;
     *n_7 = (*n_3) + 1;
     *n_8 = (*n_4) + 1;
+    for (int l = 0; l < 8; l++)
+        node_list[l] += begin * y_size * z_size;
     cutting_info *C_Info;
 
-    for (ii = 0; ii < x_size - 1; ii++)
+    for (ii = begin; ii < end; ii++)
     {
         for (jj = 0; jj < y_size - 1; jj++)
         {
             for (kk = 0; kk < z_size - 1; kk++)
             {
+                if (chunk)
+                    reserve_chunk_vertices();
                 if (iblank == NULL || iblank[*n_1] != '\0')
                 {
                     bitmap = node_table[*n_1].side | node_table[*n_2].side << 1
@@ -1539,9 +1575,17 @@ void UNI_IsoPlane::createIsoPlane()
         (*n_7) += z_size;
         (*n_8) += z_size;
     }
+    return true;
 }
 
 void RECT_IsoPlane::createIsoPlane()
+{
+    standard_cells_found = false;
+    polyhedral_cells_found = false;
+    extract();
+}
+
+bool RECT_IsoPlane::extractCells(int begin, int end)
 {
     int bitmap; // index in the MarchingCubes table
     // 1 = above; 0 = below
@@ -1563,15 +1607,19 @@ void RECT_IsoPlane::createIsoPlane()
     *n_6 = (*n_2) + 1;
     *n_7 = (*n_3) + 1;
     *n_8 = (*n_4) + 1;
+    for (int l = 0; l < 8; l++)
+        node_list[l] += begin * y_size * z_size;
     cutting_info *C_Info;
 
     int cell = 0;
-    for (ii = 0; ii < x_size - 1; ++ii)
+    for (ii = begin; ii < end; ++ii)
     {
         for (jj = 0; jj < y_size - 1; ++jj)
         {
             for (kk = 0; kk < z_size - 1; ++kk, ++cell)
             {
+                if (chunk)
+                    reserve_chunk_vertices();
                 if (iblank == NULL || iblank[*n_1] != '\0')
                 {
                     bitmap = node_table[*n_1].side | node_table[*n_2].side << 1
@@ -2155,9 +2203,17 @@ void RECT_IsoPlane::createIsoPlane()
         (*n_7) += z_size;
         (*n_8) += z_size;
     }
+    return true;
 }
 
 bool STR_IsoPlane::createIsoPlane()
+{
+    standard_cells_found = false;
+    polyhedral_cells_found = false;
+    return extract();
+}
+
+bool STR_IsoPlane::extractCells(int begin, int end)
 {
     int bitmap; // index in the MarchingCubes table
     // 1 = above; 0 = below
@@ -2176,14 +2232,18 @@ bool STR_IsoPlane::createIsoPlane()
     *n_6 = (*n_2) + 1;
     *n_7 = (*n_3) + 1;
     *n_8 = (*n_4) + 1;
+    for (int l = 0; l < 8; l++)
+        node_list[l] += begin * y_size * z_size;
     cutting_info *C_Info;
 
-    for (ii = 0; ii < x_size - 1; ii++)
+    for (ii = begin; ii < end; ii++)
     {
         for (jj = 0; jj < y_size - 1; jj++)
         {
             for (kk = 0; kk < z_size - 1; kk++)
             {
+                if (chunk)
+                    reserve_chunk_vertices();
                 if (iblank == NULL || iblank[*n_1] != '\0')
                 {
                     bitmap = node_table[*n_1].side | node_table[*n_2].side << 1
@@ -3762,99 +3822,93 @@ void POLYHEDRON_IsoPlane::createcoDistributedObjects(coOutputPort *p_GridOut, co
     //    }
 }
 
-bool IsoPlane::add_vertex(int n1, int n2)
+namespace covise
+{
+// an edge cut by the surface, with the nodes providing the coordinates
+struct IsoEdge
+{
+    int n1, n2;
+    int x, y, z, u, v, w;
+    bool limited; // subject to max_coords
+};
+
+// output of extractCells() for one chunk of cells: the vertex list refers
+// to the recorded edges, which get their vertex indices later on
+struct IsoChunk
 {
+    int begin, end;
+    std::vector<int> vertices;
+    std::vector<IsoEdge> edges;
+    int num_triangles;
+    bool standard_cells_found;
+    bool polyhedral_cells_found;
+};
+}
 
-    int *targets, *indices; // Pointers into the node_info structure
-    float w2, w1;
+// the chunks should be large enough to make recording pay off
+static const int MinChunkCells = 32768;
 
-    targets = node_table[n1].targets;
-    indices = node_table[n1].vertice_list;
-
-    while (*targets)
+bool IsoPlane::add_vertex(int n1, int n2)
+{
+    if (chunk)
     {
-        if (*targets == n2) // did we already calculate this vertex?
-        {
-            *vertex++ = *indices; // great! just put in the right index.
-            return true;
-        }
-
-        if (*(targets + 1))
-        {
-            //fprintf(stderr,"Target_overflow\n");
-            break;
-        }
+        *vertex++ = (int)chunk->edges.size();
+        chunk->edges.push_back({ n1, n2, n1, n1, n1, n2, n2, n2, true });
+        return true;
+    }
 
-        else
-        {
-            targets++;
-            indices++;
-        }
+    int index = cached_vertex(n1, n2);
+    if (index >= 0) // did we already calculate this vertex?
+    {
+        *vertex++ = index; // great! just put in the right index.
+        return true;
     }
 
     // don't overrun buffers
     if (num_coords == max_coords)
         return false;
 
-    // remember the target we will calculate now
-    *targets++ = n2;
-    *targets = 0;
-    *indices = num_coords;
-    *vertex++ = *indices;
-
-    // Calculate the interpolation weights (linear interpolation)
-    if (node_table[n1].dist == node_table[n2].dist)
-        w2 = 1.0;
-
-    else
-    {
-        w2 = (float)((double)node_table[n1].dist / (double)(node_table[n1].dist - node_table[n2].dist));
-        if (w2 > 1.0)
-            w2 = 1.0;
-        if (w2 < 0)
-            w2 = 0.0;
-    }
+    *vertex++ = num_coords;
+    interpolate_vertex(num_coords, n1, n2, n1, n1, n1, n2, n2, n2);
+    num_coords++;
 
-    w1 = 1.0f - w2;
-    *coord_x++ = x_in[n1] * w1 + x_in[n2] * w2;
-    *coord_y++ = y_in[n1] * w1 + y_in[n2] * w2;
-    *coord_z++ = z_in[n1] * w1 + z_in[n2] * w2;
+    return true;
+}
 
-    if (!_isConnected)
+void IsoPlane::add_vertex(int n1, int n2, int x, int y, int z, int u, int v, int w)
+{
+    if (chunk)
     {
-        *S_Data_p++ = _isovalue;
+        *vertex++ = (int)chunk->edges.size();
+        chunk->edges.push_back({ n1, n2, x, y, z, u, v, w, false });
+        return;
     }
 
-    else if (Datatype)
-        *S_Data_p++ = s_in[n1] * w1 + s_in[n2] * w2;
-
-    else
+    int index = cached_vertex(n1, n2);
+    if (index >= 0) // did we already calculate this vertex?
     {
-        *V_Data_U_p++ = u_in[n1] * w1 + u_in[n2] * w2;
-        *V_Data_V_p++ = v_in[n1] * w1 + v_in[n2] * w2;
-        *V_Data_W_p++ = w_in[n1] * w1 + w_in[n2] * w2;
+        *vertex++ = index; // great! just put in the right index.
+        return;
     }
 
+    *vertex++ = num_coords;
+    interpolate_vertex(num_coords, n1, n2, x, y, z, u, v, w);
     num_coords++;
-
-    return true;
 }
 
-void IsoPlane::add_vertex(int n1, int n2, int x, int y, int z, int u, int v, int w)
+// index of the vertex on the edge n1-n2 if it has been calculated before,
+// otherwise the edge is remembered with the index num_coords and -1 returned
+int IsoPlane::cached_vertex(int n1, int n2)
 {
     int *targets, *indices; // Pointers into the node_info structure
-    float w2, w1;
 
     targets = node_table[n1].targets;
     indices = node_table[n1].vertice_list;
 
     while (*targets)
     {
-        if (*targets == n2) // did we already calculate this vertex?
-        {
-            *vertex++ = *indices; // great! just put in the right index.
-            return;
-        }
+        if (*targets == n2)
+            return *indices;
 
         if (*(targets + 1))
         {
@@ -3873,7 +3927,13 @@ void IsoPlane::add_vertex(int n1, int n2, int x, int y, int z, int u, int v, int
     *targets++ = n2;
     *targets = 0;
     *indices = num_coords;
-    *vertex++ = *indices;
+
+    return -1;
+}
+
+void IsoPlane::interpolate_vertex(int index, int n1, int n2, int x, int y, int z, int u, int v, int w)
+{
+    float w2, w1;
 
     // Calculate the interpolation weights (linear interpolation)
     if (node_table[n1].dist == node_table[n2].dist)
@@ -3889,31 +3949,178 @@ void IsoPlane::add_vertex(int n1, int n2, int x, int y, int z, int u, int v, int
     }
 
     w1 = 1.0f - w2;
-    *coord_x++ = x_in[x] * w1 + x_in[u] * w2;
-    *coord_y++ = y_in[y] * w1 + y_in[v] * w2;
-    *coord_z++ = z_in[z] * w1 + z_in[w] * w2;
+    coords_x[index] = x_in[x] * w1 + x_in[u] * w2;
+    coords_y[index] = y_in[y] * w1 + y_in[v] * w2;
+    coords_z[index] = z_in[z] * w1 + z_in[w] * w2;
 
     if (!_isConnected)
     {
-        *S_Data_p++ = _isovalue;
+        S_Data[index] = _isovalue;
     }
 
     else if (Datatype)
-        *S_Data_p++ = s_in[n1] * w1 + s_in[n2] * w2;
+        S_Data[index] = s_in[n1] * w1 + s_in[n2] * w2;
 
     else
     {
-        *V_Data_U_p++ = u_in[n1] * w1 + u_in[n2] * w2;
-        *V_Data_V_p++ = v_in[n1] * w1 + v_in[n2] * w2;
-        *V_Data_W_p++ = w_in[n1] * w1 + w_in[n2] * w2;
+        V_Data_U[index] = u_in[n1] * w1 + u_in[n2] * w2;
+        V_Data_V[index] = v_in[n1] * w1 + v_in[n2] * w2;
+        V_Data_W[index] = w_in[n1] * w1 + w_in[n2] * w2;
     }
+}
 
-    num_coords++;
+// room for the 4 triangles a cell can produce at most
+void IsoPlane::reserve_chunk_vertices()
+{
+    size_t used = vertex - chunk->vertices.data();
+    if (used + 12 > chunk->vertices.size())
+    {
+        chunk->vertices.resize(std::max(2 * chunk->vertices.size(), used + 12));
+        vertex = chunk->vertices.data() + used;
+    }
+}
+
+IsoPlane *IsoPlane::chunkCopy() const
+{
+    return new IsoPlane(*this);
+}
+
+IsoPlane *STR_IsoPlane::chunkCopy() const
+{
+    return new STR_IsoPlane(*this);
+}
+
+IsoPlane *UNI_IsoPlane::chunkCopy() const
+{
+    return new UNI_IsoPlane(*this);
+}
+
+IsoPlane *RECT_IsoPlane::chunkCopy() const
+{
+    return new RECT_IsoPlane(*this);
+}
+
+bool IsoPlane::extract()
+{
+    int layers = numCellLayers();
+    if (layers <= 1
+        || (size_t)layers * cellsPerLayer() < 2 * (size_t)MinChunkCells
+        || coThreadPool::inParallelRegion()
+        || coThreadPool::global().numThreads() < 2)
+    {
+        return extractCells(0, layers);
+    }
+    return extractParallel();
+}
+
+bool IsoPlane::extractParallel()
+{
+    int layers = numCellLayers();
+    int layersPerChunk = std::max(1, MinChunkCells / std::max(1, cellsPerLayer()));
+    int numChunks = (layers + layersPerChunk - 1) / layersPerChunk;
+    std::vector<IsoChunk> chunks(numChunks);
+
+    // record the cut edges and the vertex lists of all chunks
+    coThreadPool &pool = coThreadPool::global();
+    pool.run(numChunks, [&](size_t c, int)
+             {
+                 IsoChunk &ch = chunks[c];
+                 ch.begin = (int)c * layersPerChunk;
+                 ch.end = std::min(layers, ch.begin + layersPerChunk);
+                 ch.vertices.resize(12 * std::min(MinChunkCells, (ch.end - ch.begin) * cellsPerLayer()));
+
+                 std::unique_ptr<IsoPlane> plane(chunkCopy());
+                 plane->chunk = &ch;
+                 plane->vertex = ch.vertices.data();
+                 plane->num_triangles = 0;
+                 plane->standard_cells_found = false;
+                 plane->polyhedral_cells_found = false;
+                 plane->extractCells(ch.begin, ch.end);
+                 ch.vertices.resize(plane->vertex - ch.vertices.data());
+                 ch.num_triangles = plane->num_triangles;
+                 ch.standard_cells_found = plane->standard_cells_found;
+                 ch.polyhedral_cells_found = plane->polyhedral_cells_found;
+
+                 // the copy does not own any arrays
+                 plane->node_table = NULL;
+                 plane->vertice_list = NULL;
+                 plane->coords_x = plane->coords_y = plane->coords_z = NULL;
+                 plane->S_Data = plane->V_Data_U = plane->V_Data_V = plane->V_Data_W = NULL;
+                 plane->x_in = plane->y_in = plane->z_in = NULL;
+             });
+
+    // number the edges in cell order, exactly as add_vertex() does
+    std::vector<size_t> edgeStart(numChunks + 1, 0), vertexStart(numChunks + 1, 0);
+    for (int c = 0; c < numChunks; c++)
+    {
+        edgeStart[c + 1] = edgeStart[c] + chunks[c].edges.size();
+        vertexStart[c + 1] = vertexStart[c] + chunks[c].vertices.size();
+        num_triangles += chunks[c].num_triangles;
+        standard_cells_found = standard_cells_found || chunks[c].standard_cells_found;
+        polyhedral_cells_found = polyhedral_cells_found || chunks[c].polyhedral_cells_found;
+    }
+    std::vector<int> edgeVertex(edgeStart[numChunks]);
+    std::vector<const IsoEdge *> newVertices;
+    for (int c = 0; c < numChunks; c++)
+    {
+        int *ev = edgeVertex.data() + edgeStart[c];
+        for (const IsoEdge &e : chunks[c].edges)
+        {
+            int index = cached_vertex(e.n1, e.n2);
+            if (index < 0)
+            {
+                // don't overrun buffers
+                if (e.limited && num_coords == max_coords)
+                    return false;
+                index = num_coords++;
+                newVertices.push_back(&e);
+            }
+            *ev++ = index;
+        }
+    }
+
+    if (num_coords > max_coords)
+    {
+        max_coords = num_coords;
+        for (float **a : { &coords_x, &coords_y, &coords_z, &S_Data, &V_Data_U, &V_Data_V, &V_Data_W })
+        {
+            if (*a)
+            {
+                delete[] *a;
+                *a = new float[max_coords];
+            }
+        }
+    }
+    delete[] vertice_list;
+    vertice_list = new int[std::max(vertexStart[numChunks], (size_t)1)];
+    vertex = vertice_list + vertexStart[numChunks];
+    coord_x = coords_x + num_coords;
+    coord_y = coords_y + num_coords;
+    coord_z = coords_z + num_coords;
+
+    // place the vertex lists and calculate the new vertices
+    pool.run(numChunks, [&](size_t c, int)
+             {
+                 const int *ev = edgeVertex.data() + edgeStart[c];
+                 int *vl = vertice_list + vertexStart[c];
+                 for (int v : chunks[c].vertices)
+                     *vl++ = ev[v];
+
+                 size_t first = newVertices.size() * c / numChunks;
+                 size_t last = newVertices.size() * (c + 1) / numChunks;
+                 for (size_t i = first; i < last; i++)
+                 {
+                     const IsoEdge &e = *newVertices[i];
+                     interpolate_vertex((int)i, e.n1, e.n2, e.x, e.y, e.z, e.u, e.v, e.w);
+                 }
+             });
+
+    return true;
 }
 
 void IsoPlane::createNeighbourList()
 {
-    triPerVertex = maxTriPerVertex;
+    triPerVertex = maxTriPerVertex();
 
     // commodity for faster access
     int triPerVertexP1 = triPerVertex + 1;
@@ -3988,7 +4195,7 @@ void IsoPlane::createNeighbourList()
         }
     } while (neighbourListBad);
 
-    if (triPerVertex > 2 * maxTriPerVertex)
+    if (triPerVertex > 2 * maxTriPerVertex())
         cerr << "IsoSurface: Increase MAX_TRI_PER_VERT to at least "
              << triPerVertex << endl;
 }
@@ -10,12 +10,16 @@
 
 #include <util/coTypes.h>
 #include <cstdlib>
+#include <memory>
+#include <vector>
 #include <alg/IsoSurfaceGPMUtil.h>
 
 namespace covise
 {
 
 class coOutputPort;
+class coCellIntervalTree;
+struct IsoChunk;
 
 typedef struct NodeInfo_s
 {
@@ -88,16 +92,50 @@ private:
     // Maximal number of triangles attached to one Vertex.
     // configure at IsoSurface.MAX_TRI_PER_VERT
     // starting value for
-    static int maxTriPerVertex;
+    static int maxTriPerVertex();
 
     // This variable represents the current state. Set when
     // a neighbour list is built. Might be increased if the
     // list was not built successfully with the given default
     int triPerVertex;
 
+    bool standard_cells_found;
+
+    // set while a copy of the plane records the edges cut in one chunk of
+    // cells instead of calculating the vertices, see extract()
+    IsoChunk *chunk;
+
+    // the elements that can be cut, see useCellSearch()
+    const coCellIntervalTree *cell_search;
+    std::shared_ptr<const std::vector<int> > active_cells;
+
 protected:
     bool add_vertex(int n1, int n2);
     void add_vertex(int n1, int n2, int x, int y, int z, int u, int v, int w);
+    int cached_vertex(int n1, int n2);
+    void interpolate_vertex(int index, int n1, int n2, int x, int y, int z, int u, int v, int w);
+    void reserve_chunk_vertices();
+
+    // run the cutting cases for the iterations [begin, end) of the
+    // outermost loop over the cells: elements or x layers
+    virtual bool extractCells(int begin, int end);
+    virtual int numCellLayers() const
+    {
+        return active_cells ? (int)active_cells->size() : num_elem;
+    }
+    virtual int cellsPerLayer() const
+    {
+        return 1;
+    }
+    // shallow copy sharing the input and the node table
+    virtual IsoPlane *chunkCopy() const;
+
+    // extractCells() for all cells, split into chunks run in parallel on
+    // large grids: the chunks record the cut edges, which are numbered in
+    // cell order through the node table afterwards, so that the result is
+    // identical to sequential extraction
+    bool extract();
+    bool extractParallel();
 
 public:
     bool polyhedral_cells_found;
@@ -124,6 +162,14 @@ public:
     bool createIsoPlane();
     void createNeighbourList();
 
+    // only visit the elements of an unstructured grid that search returns
+    // for the isovalue, search has to be built for the grid and the iso
+    // data of this plane; not used together with iblanking
+    void useCellSearch(const coCellIntervalTree *search)
+    {
+        cell_search = search;
+    }
+
     // access to output fields
     int getNumCoords()
     {
@@ -174,6 +220,18 @@ public:
     }
     bool createIsoPlane();
 
+protected:
+    virtual bool extractCells(int begin, int end);
+    virtual int numCellLayers() const
+    {
+        return x_size - 1;
+    }
+    virtual int cellsPerLayer() const
+    {
+        return (y_size - 1) * (z_size - 1);
+    }
+    virtual IsoPlane *chunkCopy() const;
+
 private:
     int x_size;
     int y_size;
@@ -194,6 +252,18 @@ public:
     virtual ~UNI_IsoPlane();
     void createIsoPlane();
 
+protected:
+    virtual bool extractCells(int begin, int end);
+    virtual int numCellLayers() const
+    {
+        return x_size - 1;
+    }
+    virtual int cellsPerLayer() const
+    {
+        return (y_size - 1) * (z_size - 1);
+    }
+    virtual IsoPlane *chunkCopy() const;
+
 private:
     int x_size;
     int y_size;
@@ -212,6 +282,18 @@ public:
                   bool isConnected, char *ib);
     void createIsoPlane();
 
+protected:
+    virtual bool extractCells(int begin, int end);
+    virtual int numCellLayers() const
+    {
+        return x_size - 1;
+    }
+    virtual int cellsPerLayer() const
+    {
+        return (y_size - 1) * (z_size - 1);
+    }
+    virtual IsoPlane *chunkCopy() const;
+
 private:
     int x_size;
     int y_size;
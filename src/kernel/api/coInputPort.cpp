@@ -92,12 +92,24 @@ int coInputPort::postCompute()
 /// get my active object if I have one
 const coDistributedObject *coInputPort::getCurrentObject() const
 {
+    int slot = threadSlot();
+    if (slot >= 0 && slot < (int)d_threadObj.size())
+        return d_threadObj[slot];
     return d_inObj;
 }
 
 void coInputPort::setCurrentObject(const coDistributedObject *o)
 {
-    d_inObj = o;
+    int slot = threadSlot();
+    if (slot >= 0 && slot < (int)d_threadObj.size())
+        d_threadObj[slot] = o;
+    else
+        d_inObj = o;
+}
+
+void coInputPort::setNumThreadSlots(int n)
+{
+    d_threadObj.assign(n, d_inObj);
 }
 
 /// print to a stream
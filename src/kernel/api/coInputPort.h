@@ -11,6 +11,7 @@
 // 20.09.99
 #include <covise/covise.h>
 #include "coUifPort.h"
+#include <vector>
 
 /**
  * Class
@@ -40,6 +41,9 @@ private:
     /// Object at the input port
     const coDistributedObject *d_inObj;
 
+    /// Objects seen by the threads of a parallel compute(), see coPort::threadSlot()
+    std::vector<const coDistributedObject *> d_threadObj;
+
     /// to check whether the Dataobject changed since last execute
     char *oldObjectName;
 
@@ -76,6 +80,9 @@ public:
     /// set my active object - should only be used by the api
     void setCurrentObject(const coDistributedObject *o);
 
+    /// provide n thread slots starting with the current object - should only be used by the api
+    void setNumThreadSlots(int n);
+
     /// print to a stream
     void print(ostream &) const;
 
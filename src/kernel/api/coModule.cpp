@@ -24,6 +24,7 @@
 #endif
 
 #include <util/unixcompat.h>
+#include <util/coTrace.h>
 
 #include <sys/types.h>
 
@@ -71,6 +72,7 @@ coModule::coModule(int argc, char *argv[], const char *desc, bool propagate)
     d_autoParamInit = 0;
     d_execFlag = 0;
     d_execGracePeriod = 1.0;
+    d_streaming = false;
     _propagateObjectName = propagate;
     // declare the name of our module if given here
     if (desc)
@@ -364,6 +366,9 @@ void coModule::init(int argc, char *argv[])
     initDescription();
     // call the user's postInst() if he has one
     postInst();
+
+    if (d_streaming)
+        Covise::send_streaming_support(reusesStreamedElements());
 }
 
 /// initialize Covise and loop
@@ -679,7 +684,12 @@ void coModule::localCompute(void *)
             return;
 
     // call user's compute function, stop pipeline if not successful
-    if (compute(NULL) == STOP_PIPELINE)
+    int result = CONTINUE_PIPELINE;
+    {
+        coTraceScope trace("compute", "module");
+        result = compute(NULL);
+    }
+    if (result == STOP_PIPELINE)
         stopPipeline();
     //Add OBJECTNAME-Attribute to
     //the data
@@ -869,6 +879,32 @@ void coModule::setExecGracePeriod(float gracePeriod)
 /////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////
 
+void coModule::setStreaming(bool streaming)
+{
+    d_streaming = streaming;
+}
+
+bool coModule::isStreaming() const
+{
+    return d_streaming;
+}
+
+bool coModule::isStreamedElement() const
+{
+    return Covise::is_streamed_element();
+}
+
+/// publish a completed set element to the controller
+void coModule::publishSetElement(const coOutputPort *port, int element, int numElements,
+                                 const coDistributedObject *obj)
+{
+    if (port && obj)
+        Covise::send_set_element(port->getName(), element, numElements, obj->getName());
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////
+
 coBooleanParam *coModule::addBooleanParam(const char *name, const char *desc)
 {
     coBooleanParam *port = new coBooleanParam(name, desc);
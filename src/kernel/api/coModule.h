@@ -101,6 +101,9 @@ private:
     // 'Grace period' to wait after self-exec to prevent overrinning next module
     float d_execGracePeriod;
 
+    // whether the module can be started for single elements of a set
+    bool d_streaming;
+
     // Title of the module
     char *d_title;
 
@@ -131,6 +134,13 @@ protected:
     // internal callback called if ADD_OBJECT messages arrive
     virtual void localAddObject(void *callbackData);
 
+    // streaming execution: does the execution for the whole set use the elements
+    // computed before instead of creating them again?
+    virtual bool reusesStreamedElements() const
+    {
+        return false;
+    }
+
 public:
     /// return values for call-back functions
     enum
@@ -159,6 +169,18 @@ public:
     /// set the module's grace period
     void setExecGracePeriod(float gracePeriod);
 
+    /// streaming execution: call in the constructor if compute() may be started for single
+    /// elements of a timestep set while the upstream module is still producing the others
+    void setStreaming(bool streaming);
+    bool isStreaming() const;
+    /// compute() has been started for a single element of a set that is still being produced
+    bool isStreamedElement() const;
+
+    /// publish a completed element of the set that will be the object of port, so that
+    /// streaming modules below can process it before this module has finished
+    void publishSetElement(const coOutputPort *port, int element, int numElements,
+                           const coDistributedObject *obj);
+
     // --------------------- Parameter switching ----------------------------
 
     /// start a parameter switch: return a pointer to its master choice
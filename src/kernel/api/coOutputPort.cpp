@@ -75,6 +75,12 @@ int coOutputPort::preCompute()
 
 void coOutputPort::setObjName(const char *n)
 {
+    int slot = threadSlot();
+    if (slot >= 0 && slot < (int)d_threadObjName.size())
+    {
+        d_threadObjName[slot] = n ? n : "No_Object_Name_given";
+        return;
+    }
     if (n == d_objName)
         return;
     if (d_objName)
@@ -104,27 +110,43 @@ int coOutputPort::postCompute()
 /// set my active object if I have one
 void coOutputPort::setCurrentObject(coDistributedObject *obj)
 {
-    d_outObj = obj;
+    int slot = threadSlot();
+    if (slot >= 0 && slot < (int)d_threadObj.size())
+        d_threadObj[slot] = obj;
+    else
+        d_outObj = obj;
 }
 
 coDistributedObject *coOutputPort::getCurrentObject()
 {
+    int slot = threadSlot();
+    if (slot >= 0 && slot < (int)d_threadObj.size())
+        return d_threadObj[slot];
     return d_outObj;
 }
 
 /// get my active object if I have one
 const char *coOutputPort::getObjName()
 {
+    int slot = threadSlot();
+    if (slot >= 0 && slot < (int)d_threadObjName.size())
+        return d_threadObjName[slot].c_str();
     return d_objName;
 }
 
 coObjInfo coOutputPort::getNewObjectInfo()
 {
     coObjInfo info;
-    info.id.id = d_objName;
+    info.id.id = const_cast<char *>(getObjName());
     return info;
 }
 
+void coOutputPort::setNumThreadSlots(int n)
+{
+    d_threadObj.assign(n, d_outObj);
+    d_threadObjName.assign(n, d_objName ? d_objName : "");
+}
+
 void coOutputPort::print(ostream &str) const
 {
     str << "Output Port '" << d_name
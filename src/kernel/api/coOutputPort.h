@@ -12,6 +12,8 @@
 #include <covise/covise.h>
 #include <util/coObjID.h>
 #include "coPort.h"
+#include <string>
+#include <vector>
 
 namespace covise
 {
@@ -42,6 +44,10 @@ private:
     /// Name for the output port object
     char *d_objName;
 
+    /// Objects and names seen by the threads of a parallel compute(), see coPort::threadSlot()
+    std::vector<coDistributedObject *> d_threadObj;
+    std::vector<std::string> d_threadObjName;
+
     /// Name of the port this one is depending on
     char *d_depPort;
 
@@ -85,6 +91,9 @@ public:
     /// set object-name - should only be used by the api !
     void setObjName(const char *n);
 
+    /// provide n thread slots starting with the current object and name - should only be used by the api
+    void setNumThreadSlots(int n);
+
     /// print to a stream
     void print(ostream &) const;
 };
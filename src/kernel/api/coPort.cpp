@@ -34,6 +34,21 @@ static bool checkPortName(const char *name)
 
 using namespace covise;
 
+namespace
+{
+thread_local int s_threadSlot = -1;
+}
+
+int coPort::threadSlot()
+{
+    return s_threadSlot;
+}
+
+void coPort::setThreadSlot(int slot)
+{
+    s_threadSlot = slot;
+}
+
 coPort::~coPort()
 {
     if (NULL != d_name)
@@ -63,6 +63,11 @@ public:
 
     /// Set the info Popup text
     void setInfo(const char *value) const;
+
+    /// slot of the objects seen by the calling thread, -1 if it uses the
+    /// port's own objects (set by coSimpleModule for parallel compute())
+    static int threadSlot();
+    static void setThreadSlot(int slot);
 };
 
 inline ostream &operator<<(ostream &str, const coPort &port)
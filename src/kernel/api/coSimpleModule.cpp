@@ -7,8 +7,13 @@
 
 #include <do/coDistributedObject.h>
 #include <do/coDoSet.h>
+#include <shm/covise_shm.h>
+#include <util/coThreadPool.h>
+#include <util/coTrace.h>
 #include "coSimpleModule.h"
 
+#include <atomic>
+
 #define __DEBUG_MSG 0
 
 using namespace covise;
@@ -23,10 +28,7 @@ coSimpleModule::coSimpleModule(int argc, char *argv[], const char *desc, bool pr
     copy_attributes_non_set_flag = 1;
 
     cover_interaction_flag = 0;
-    object_level = 0;
-
-    timestep_flag = 0;
-    multiblock_flag = 0;
+    d_reentrant = false;
 
     portLeader = 0;
     return;
@@ -150,6 +152,9 @@ void coSimpleModule::localCompute(void *callbackData)
         continueExec = (handleObjects(originalInPorts, originalOutPorts) == CONTINUE_PIPELINE);
     };
 
+    if (continueExec && isStreaming())
+        recordStreamedElement();
+
     if (cover_interaction_flag == 1)
     {
         if (originalOutPorts[0]->getCurrentObject() != NULL)
@@ -244,6 +249,137 @@ void coSimpleModule::swapObjects(coInputPort **inPorts, coOutputPort **outPorts)
 
 /////////////////////////////////////////////////////////////////////////////////////////
 
+coSimpleModule::Traversal &coSimpleModule::traversal()
+{
+    int slot = coPort::threadSlot();
+    if (slot >= 0 && slot < (int)d_threadTraversal.size())
+        return d_threadTraversal[slot];
+    return d_traversal;
+}
+
+const coSimpleModule::Traversal &coSimpleModule::traversal() const
+{
+    int slot = coPort::threadSlot();
+    if (slot >= 0 && slot < (int)d_threadTraversal.size())
+        return d_threadTraversal[slot];
+    return d_traversal;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+bool coSimpleModule::handleElementsParallel(coInputPort **inPorts, coOutputPort **outPorts,
+                                            const coDistributedObject ***setInObjs,
+                                            coDistributedObject ***setOutObjs, int numSetElem,
+                                            const std::vector<bool> &done, bool streamedSet)
+{
+    int i;
+    coThreadPool &pool = coThreadPool::global();
+    int numSlots = pool.numThreads();
+
+    // every thread sees its own objects at the module's ports
+    for (i = 0; i < numInPorts; i++)
+        originalInPorts[i]->setNumThreadSlots(numSlots);
+    for (i = 0; i < numOutPorts; i++)
+        originalOutPorts[i]->setNumThreadSlots(numSlots);
+    d_threadTraversal.assign(numSlots, d_traversal);
+
+    // an object that is not a set is seen by all elements: every thread gets its own
+    // instance, so that e.g. the neighbor list of a grid is not built by several threads at once
+    std::vector<std::vector<const coDistributedObject *> > threadInObjs(numInPorts);
+    for (i = 0; i < numInPorts; i++)
+    {
+        const coDistributedObject *obj = inPorts[i] ? inPorts[i]->getCurrentObject() : NULL;
+        if (!setInObjs[i] || !obj || setInObjs[i][0] != obj)
+            continue;
+        threadInObjs[i].assign(numSlots, obj);
+        for (int thread = 1; thread < numSlots; thread++)
+        {
+            if (const coDistributedObject *copy = obj->createUnknown())
+                threadInObjs[i][thread] = copy;
+        }
+    }
+
+    std::atomic<bool> continueExec(true);
+    pool.run(numSetElem, [&](size_t elem, int thread) {
+        if (!continueExec || done[elem])
+            return;
+        int t = (int)elem;
+        coPort::setThreadSlot(thread);
+        Traversal &trav = d_threadTraversal[thread];
+        trav = d_traversal;
+        trav.element_counter.back() = t;
+        setIterator(inPorts, t);
+
+        coInputPort **newInPorts = new coInputPort *[numInPorts];
+        coOutputPort **newOutPorts = new coOutputPort *[numOutPorts];
+        char newObjName[2048];
+        for (int p = 0; p < numInPorts; p++)
+        {
+            newInPorts[p] = new coInputPort(inPorts[p]->getName(), "", "coSimpleModule - internal port");
+            if (!threadInObjs[p].empty())
+                newInPorts[p]->setCurrentObject(threadInObjs[p][thread]);
+            else
+                newInPorts[p]->setCurrentObject(setInObjs[p] ? setInObjs[p][t] : NULL);
+        }
+        for (int p = 0; p < numOutPorts; p++)
+        {
+            newOutPorts[p] = new coOutputPort(outPorts[p]->getName(), "", "coSimpleModule - internal port");
+            // same names as in sequential execution
+            sprintf(newObjName, "%s_%d", outPorts[p]->getObjName(), t);
+            newOutPorts[p]->setObjName(newObjName);
+        }
+
+        if (handleObjects(newInPorts, newOutPorts) != CONTINUE_PIPELINE)
+            continueExec = false;
+        else
+        {
+            for (int p = 0; p < numOutPorts; p++)
+            {
+                setOutObjs[p][t] = newOutPorts[p]->getCurrentObject();
+                // elements complete in any order, the controller sorts them by number
+                if (streamedSet)
+                    publishSetElement(outPorts[p], t, numSetElem, setOutObjs[p][t]);
+            }
+        }
+
+        // the objects are owned by the sets and the caller
+        for (int p = 0; p < numInPorts; p++)
+        {
+            newInPorts[p]->setCurrentObject(NULL);
+            delete newInPorts[p];
+        }
+        for (int p = 0; p < numOutPorts; p++)
+        {
+            newOutPorts[p]->setCurrentObject(NULL);
+            delete newOutPorts[p];
+        }
+        delete[] newInPorts;
+        delete[] newOutPorts;
+        coPort::setThreadSlot(-1);
+    });
+
+    for (i = 0; i < numInPorts; i++)
+    {
+        for (size_t thread = 1; thread < threadInObjs[i].size(); thread++)
+        {
+            if (threadInObjs[i][thread] != threadInObjs[i][0])
+                delete threadInObjs[i][thread];
+        }
+    }
+    d_threadTraversal.clear();
+    // the elements may have attached new segments while others were reading
+    if (!coThreadPool::inParallelRegion())
+        SharedMemory::release_replaced_tables();
+    for (i = 0; i < numInPorts; i++)
+        originalInPorts[i]->setNumThreadSlots(0);
+    for (i = 0; i < numOutPorts; i++)
+        originalOutPorts[i]->setNumThreadSlots(0);
+
+    return continueExec;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
 int coSimpleModule::handleObjects(coInputPort **inPorts, coOutputPort **outPorts)
 {
     int compute_flag;
@@ -254,6 +390,7 @@ int coSimpleModule::handleObjects(coInputPort **inPorts, coOutputPort **outPorts
     // this flag is set to false if the execution should be terminated
     bool continueExec = true;
     bool currentSetContainsTimesteps=false;
+    Traversal &trav = traversal();
 
 #if __DEBUG_MSG
     cerr << "coSimpleModule::handleObjects" << endl;
@@ -279,21 +416,21 @@ int coSimpleModule::handleObjects(coInputPort **inPorts, coOutputPort **outPorts
             if ((inPorts[portLeader]->getCurrentObject())->getAttribute("TIMESTEP"))
             {
                 compute_flag = !compute_timesteps; // transient
-                timestep_flag = 1;
-                multiblock_flag = 0;
+                trav.timestep_flag = 1;
+                trav.multiblock_flag = 0;
 		currentSetContainsTimesteps = true;
             }
             else
             {
                 compute_flag = !compute_multiblock; // multiblock
-                multiblock_flag = 1;
+                trav.multiblock_flag = 1;
             }
         }
         else
         {
             compute_flag = 0;
-            multiblock_flag = 0;
-            timestep_flag = 0;
+            trav.multiblock_flag = 0;
+            trav.timestep_flag = 0;
         } // no set
     }
 #if __DEBUG_MSG
@@ -309,9 +446,13 @@ int coSimpleModule::handleObjects(coInputPort **inPorts, coOutputPort **outPorts
         cerr << "   out-obj: " << originalOutPorts[0]->getObjName() << endl;
 #endif
 
-        // execute compute-callback
-        if (compute(NULL) != CONTINUE_PIPELINE)
-            continueExec = false;
+        // execute compute-callback, on the threads of handleElementsParallel()
+        // each element gets its own span
+        {
+            coTraceScope trace("compute", "module");
+            if (compute(NULL) != CONTINUE_PIPELINE)
+                continueExec = false;
+        }
 
 #if __DEBUG_MSG
         cerr << "   computed out-obj (org.): " << originalOutPorts[0]->getCurrentObject()->getName() << endl;
@@ -342,10 +483,10 @@ int coSimpleModule::handleObjects(coInputPort **inPorts, coOutputPort **outPorts
         coOutputPort **newOutPorts;
         char newObjName[2048];
 
-        object_level++; // object is part of set
+        trav.object_level++; // object is part of set
 
-        element_counter.push_back(0);
-        num_elements.push_back(1);
+        trav.element_counter.push_back(0);
+        trav.num_elements.push_back(1);
 
         // get input objects
         t = -1;
@@ -434,12 +575,30 @@ int coSimpleModule::handleObjects(coInputPort **inPorts, coOutputPort **outPorts
         for (i = 0; i < numOutPorts; i++)
             newOutPorts[i] = new coOutputPort(outPorts[i]->getName(), "", "coSimpleModule - internal port");
 
-        num_elements.back() = numSetElem;
+        trav.num_elements.back() = numSetElem;
+
+        // streaming execution: the elements of the top level timestep set are published
+        // to the controller, those computed while the set was streamed in are reused
+        bool streamedSet = isStreaming() && currentSetContainsTimesteps && trav.object_level == 1 && coPort::threadSlot() < 0;
+        std::vector<bool> done(numSetElem, false);
+        if (streamedSet && !d_streamedElements.empty() && setInObjs[portLeader])
+        {
+            for (t = 0; t < numSetElem; t++)
+                done[t] = reuseStreamedElement(outPorts, setInObjs[portLeader][t], t, setOutObjs);
+        }
 
-        // call the compute callback
-        for (t = 0; (t < numSetElem) && continueExec; t++)
+        // call the compute callback, on all threads if compute() is reentrant
+        t = 0;
+        if (d_reentrant && numSetElem > 1 && coPort::threadSlot() < 0)
         {
-            element_counter.back() = t;
+            continueExec = handleElementsParallel(inPorts, outPorts, setInObjs, setOutObjs, numSetElem, done, streamedSet);
+            t = numSetElem;
+        }
+        for (; (t < numSetElem) && continueExec; t++)
+        {
+            if (done[t])
+                continue;
+            trav.element_counter.back() = t;
             setIterator(inPorts, t); //sl:
             // pre
             for (i = 0; i < numInPorts; i++)
@@ -471,6 +630,8 @@ int coSimpleModule::handleObjects(coInputPort **inPorts, coOutputPort **outPorts
                 for (i = 0; i < numOutPorts; i++)
                 {
                     setOutObjs[i][t] = newOutPorts[i]->getCurrentObject();
+                    if (streamedSet)
+                        publishSetElement(outPorts[i], t, numSetElem, setOutObjs[i][t]);
                 }
             }
         }
@@ -544,34 +705,96 @@ int coSimpleModule::handleObjects(coInputPort **inPorts, coOutputPort **outPorts
         delete[] setOutObjs;
         delete[] setInObjs;
         delete[] deleteNewInPorts;
-        object_level--; // leave set
-        element_counter.pop_back();
-        num_elements.pop_back();
+        trav.object_level--; // leave set
+        trav.element_counter.pop_back();
+        trav.num_elements.pop_back();
     }
 
     // done
     return continueExec ? CONTINUE_PIPELINE : STOP_PIPELINE;
 }
 
+void coSimpleModule::recordStreamedElement()
+{
+    const coDistributedObject *inObj = originalInPorts[portLeader] ? originalInPorts[portLeader]->getCurrentObject() : NULL;
+    if (!inObj)
+        return;
+
+    // the run for the whole set has used the elements
+    if (dynamic_cast<const coDoSet *>(inObj) && inObj->getAttribute("TIMESTEP"))
+    {
+        d_streamedElements.clear();
+        return;
+    }
+
+    for (int i = 0; i < numOutPorts; i++)
+    {
+        const coDistributedObject *obj = originalOutPorts[i]->getCurrentObject();
+        if (!obj)
+            continue;
+        // element objects are named <set>_<element>: forget the elements of other sets
+        std::string name = obj->getName();
+        std::string prefix = name.substr(0, name.rfind('_') + 1);
+        if (!d_streamedElements.empty() && d_streamedElements.begin()->first.compare(0, prefix.length(), prefix) != 0)
+            d_streamedElements.clear();
+        d_streamedElements[name] = inObj->getName();
+    }
+}
+
+bool coSimpleModule::reuseStreamedElement(coOutputPort **outPorts, const coDistributedObject *inObj,
+                                          int t, coDistributedObject ***setOutObjs)
+{
+    if (!inObj)
+        return false;
+
+    int i;
+    char name[2048];
+    for (i = 0; i < numOutPorts; i++)
+    {
+        if (!outPorts[i]->getObjName())
+            continue;
+        sprintf(name, "%s_%d", outPorts[i]->getObjName(), t);
+        auto it = d_streamedElements.find(name);
+        if (it == d_streamedElements.end() || it->second != inObj->getName())
+            break;
+        setOutObjs[i][t] = const_cast<coDistributedObject *>(coDistributedObject::createFromShm(coObjInfo(name)));
+        if (!setOutObjs[i][t])
+            break;
+    }
+    if (i == numOutPorts)
+        return true;
+
+    // compute the whole element again
+    for (i = 0; i < numOutPorts; i++)
+    {
+        delete setOutObjs[i][t];
+        setOutObjs[i][t] = NULL;
+    }
+    return false;
+}
+
 int coSimpleModule::getObjectLevel() const
 {
-    return object_level;
+    const Traversal &trav = traversal();
+    return trav.object_level;
 }
 
 int coSimpleModule::getElementNumber(int level) const
 {
-    if (level < -1 || level > object_level || object_level == 0)
+    const Traversal &trav = traversal();
+    if (level < -1 || level > trav.object_level || trav.object_level == 0)
         return -1;
     if (level == -1)
-        return element_counter.back();
-    return element_counter[level];
+        return trav.element_counter.back();
+    return trav.element_counter[level];
 }
 
 int coSimpleModule::getNumberOfElements(int level) const
 {
-    if (level < -1 || level > object_level || object_level == 0)
+    const Traversal &trav = traversal();
+    if (level < -1 || level > trav.object_level || trav.object_level == 0)
         return -1;
     if (level == -1)
-        return num_elements.back();
-    return num_elements[level];
+        return trav.num_elements.back();
+    return trav.num_elements[level];
 }
@@ -18,6 +18,10 @@
 #include <appl/ApplInterface.h>
 #include "coModule.h"
 
+#include <map>
+#include <string>
+#include <vector>
+
 namespace covise
 {
 
@@ -47,20 +51,59 @@ private:
     char INTattribute[300];
     int cover_interaction_flag; // 0: turned off, 1: turned on
 
-    // information if object is part of a set
-    int object_level;
+    // state of the traversal of the set hierarchy
+    struct Traversal
+    {
+        // information if object is part of a set
+        int object_level = 0;
+
+        // currently within a block of multiblock data?
+        int multiblock_flag = 0;
+
+        // currently within a timestep?
+        bool timestep_flag = false;
+
+        // number of current element in each currently traversed level of set hierarchy
+        std::vector<int> element_counter;
+
+        // number of elements in each currently traversed level of set hierarchy
+        std::vector<int> num_elements;
+    };
+    Traversal d_traversal;
+
+    // compute() is reentrant: handle set elements in parallel
+    bool d_reentrant;
+
+    // traversal of each thread handling set elements in parallel, see coPort::threadSlot()
+    std::vector<Traversal> d_threadTraversal;
 
-    // currently within a block of multiblock data?
-    int multiblock_flag;
+    // traversal state of the calling thread
+    Traversal &traversal();
+    const Traversal &traversal() const;
 
-    // currently within a timestep?
-    bool timestep_flag;
+    // handle the elements of a set on all threads of coThreadPool::global(),
+    // except those marked in done, and publish them if streamedSet
+    bool handleElementsParallel(coInputPort **inPorts, coOutputPort **outPorts,
+                                const coDistributedObject ***setInObjs,
+                                coDistributedObject ***setOutObjs, int numSetElem,
+                                const std::vector<bool> &done, bool streamedSet);
 
-    // number of current element in each currently traversed level of set hierarchy
-    std::vector<int> element_counter;
+    // streaming execution: output element name -> name of the input element it was
+    // computed from, for the elements computed while the input set was streamed in
+    std::map<std::string, std::string> d_streamedElements;
 
-    // number of elements in each currently traversed level of set hierarchy
-    std::vector<int> num_elements;
+    // remember the objects created from a single element of a streamed set
+    void recordStreamedElement();
+
+    // use the objects of element t computed while the set was streamed in
+    bool reuseStreamedElement(coOutputPort **outPorts, const coDistributedObject *inObj,
+                              int t, coDistributedObject ***setOutObjs);
+
+    // modules handling timesteps themselves compute the whole set again
+    virtual bool reusesStreamedElements() const
+    {
+        return compute_timesteps == 0;
+    }
 
 protected:
     virtual void localCompute(void *callbackData);
@@ -112,19 +155,19 @@ public:
     // are we currently handling multiblock data?
     int isPartOfMultiblock()
     {
-        return multiblock_flag;
+        return traversal().multiblock_flag;
     }
 
     // are we currently handling timestep data?
     bool isTimestep()
     {
-        return (timestep_flag != 0);
+        return (traversal().timestep_flag != 0);
     }
 
     /// whether object is part of a set or not
     int isPartOfSet()
     {
-        return (object_level > 0);
+        return (traversal().object_level > 0);
     }
 
     /// set this if you want to add an FEEDBACK attribute string to the highest set level
@@ -141,6 +184,19 @@ public:
         return;
     };
 
+    /// set this if compute() may run concurrently for different set elements (default=false):
+    /// it must then only work on the objects of its ports and use getElementNumber()
+    /// instead of currentTimestep, setIterator() has to be reentrant as well.
+    /// Output objects are named and assembled into sets in the same order as before.
+    void setComputeReentrant(bool reentrant)
+    {
+        d_reentrant = reentrant;
+    }
+
+    // with setStreaming(true), compute() must only depend on the current timestep:
+    // the elements of timestep sets are published as soon as they are computed, and
+    // elements computed while a set was streamed in are not computed again
+
     /// set this if you need to handle multiblock yourself (default=0)
     void setComputeMultiblock(const int v)
     {
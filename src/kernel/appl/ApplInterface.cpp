@@ -32,6 +32,7 @@
 #include <util/coLog.h>
 #include <do/coDistributedObject.h>
 #include <messages/CRB_EXEC.h>
+#include <sstream>
 #if defined(__linux__) || defined(__APPLE__)
 #define NODELETE_APPROC
 #endif
@@ -92,6 +93,7 @@ void *Covise::pipelineFinishUserData = 0L;
 void *Covise::pipelineFinishCallbackData = 0L;
 int Covise::pipeline_state_once = 0;
 int Covise::renderMode_ = 0;
+bool Covise::streamedElement_ = false;
 char *Covise::objNameToAdd_ = NULL;
 char *Covise::objNameToDelete_ = NULL;
 
@@ -445,6 +447,59 @@ void Covise::send_stop_pipeline()
     return;
 }
 
+//=====================================================================
+//
+//=====================================================================
+void Covise::send_streaming_support(bool reuse)
+{
+    if ((get_module() != NULL) && (get_host() != NULL) && (get_instance() != NULL) && (appmod != NULL))
+    {
+        std::string data = std::string(get_module()) + "\n" + get_instance() + "\n" + get_host() + "\nSTREAMING\n";
+        if (reuse)
+            data += "REUSE\n";
+        Message message{ COVISE_MESSAGE_SET_ELEMENT, data };
+        appmod->send_ctl_msg(&message);
+    }
+    else
+        print_comment(__LINE__, __FILE__, "Cannot send message without get_instance()/init before");
+}
+
+//=====================================================================
+// the controller appends a line to the start messages for set elements
+//=====================================================================
+void Covise::checkStreamedElement(const Message *m)
+{
+    static const char marker[] = "\nSTREAMED_ELEMENT\n";
+    const size_t len = sizeof(marker) - 1;
+    const char *data = m->data.data();
+    size_t length = data ? size_t(m->data.length()) : 0;
+    while (length > 0 && data[length - 1] == '\0')
+        --length;
+    streamedElement_ = length >= len && strncmp(data + length - len, marker, len) == 0;
+}
+
+//=====================================================================
+//
+//=====================================================================
+void Covise::send_set_element(const char *port, int element, int numElements, const char *objName)
+{
+    if ((get_module() != NULL) && (get_host() != NULL) && (get_instance() != NULL) && (appmod != NULL))
+    {
+        std::stringstream data;
+        data << get_module() << "\n"
+             << get_instance() << "\n"
+             << get_host() << "\nELEMENT\n"
+             << port << "\n"
+             << element << "\n"
+             << numElements << "\n"
+             << objName << "\n";
+        Message message{ COVISE_MESSAGE_SET_ELEMENT, data.str() };
+        appmod->send_ctl_msg(&message);
+    }
+    else
+        print_comment(__LINE__, __FILE__, "Cannot send message without get_instance()/init before");
+}
+
 //=====================================================================
 //
 //=====================================================================
@@ -1339,6 +1394,7 @@ void Covise::doStart(Message *m)
     //    sprintf(tmpptr, "module %s starts", ap->get_name());
     //    covise_time->mark(__LINE__, tmpptr);
 
+    checkStreamedElement(m);
     msg = new CtlMessage(m);
 
     //cerr << msg->data.data() << endl;
@@ -1348,6 +1404,7 @@ void Covise::doStart(Message *m)
         callStartCallback();
 
     msg->create_finall_message();
+    send_trace();
 
     //  cerr << "Sending message to controller :" << msg->data.data() << endl;
 
@@ -1407,6 +1464,7 @@ void Covise::doStartWithoutFinish(Message *m)
 //covise_time->mark(__LINE__, tmpptr);
 #endif
 
+    checkStreamedElement(m);
     msg = new CtlMessage(m);
 
     //cerr << "[" << counter << "] CtlMessage has been newed *************" << endl;
@@ -1433,6 +1491,7 @@ void Covise::sendFinishedMsg(void *Msg)
         CtlMessage *msg = (CtlMessage *)Msg;
 
         msg->create_finall_message();
+        send_trace();
 
 #ifdef TIMING
         char *tmpptr;
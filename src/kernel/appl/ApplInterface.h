@@ -58,6 +58,10 @@ private:
 
     static int pipeline_state_once;
 
+    // the running execution is for a single element of a streamed set
+    static bool streamedElement_;
+    static void checkStreamedElement(const Message *m);
+
     // private member funcs
     static void doParam(Message *m);
     static void doPortReply(Message *m);
@@ -387,6 +391,15 @@ public:
     static char *get_generic_message();
 
     static void send_stop_pipeline();
+    // streaming execution: tell the controller that this module may be started
+    // for single elements of a set (reuse: it keeps these elements for the whole set),
+    // and publish completed elements of an output set
+    static void send_streaming_support(bool reuse = false);
+    static void send_set_element(const char *port, int element, int numElements, const char *objName);
+    static bool is_streamed_element()
+    {
+        return streamedElement_;
+    }
     static int send_ctl_message(covise_msg_type type, char *msg_string);
     static void sendFinishedMsg();
 
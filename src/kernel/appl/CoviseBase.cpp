@@ -10,6 +10,7 @@
 #include <sys/stat.h>
 #include <covise/covise_appproc.h>
 #include <util/coLog.h>
+#include <util/coTrace.h>
 #include <util/unixcompat.h>
 #ifdef _WIN32
 #include <direct.h>
@@ -1112,6 +1113,18 @@ void CoviseBase::send_quit_request()
     CoviseBase::send_message(COVISE_MESSAGE_REQ_UI, string);
 }
 
+void CoviseBase::send_trace()
+{
+    if (appmod == NULL || get_module() == NULL || get_instance() == NULL || get_host() == NULL)
+        return;
+    std::string data = coTrace::instance().takeMessage(std::string(get_module()) + "_" + get_instance() + "@" + get_host());
+    if (!data.empty())
+    {
+        Message message{ COVISE_MESSAGE_TRACE, data };
+        appmod->send_ctl_msg(&message);
+    }
+}
+
 //=====================================================================
 //                     FEEDBACK
 //=====================================================================
@@ -289,6 +289,8 @@ public:
     static const char *get_feedback_info();
     static char get_feedback_type();
     static void send_quit_request();
+    /// send the spans recorded by coTrace to the controller
+    static void send_trace();
     static void log_message(int line, const char *file, const char *comment);
 
     static ApplicationProcess *appmod;
@@ -30,6 +30,7 @@
 #include <util/coTimer.h>
 #include <covise/Covise_Util.h>
 #include <util/coLog.h>
+#include <util/coTrace.h>
 #include <do/coDistributedObject.h>
 #include <net/dataHandle.h>
 #include <messages/CRB_EXEC.h>
@@ -813,6 +814,7 @@ void CoviseRender::sendFinishedMsg()
         strcat(buf, "\n");
         Message msg{ COVISE_MESSAGE_FINISHED, DataHandle(buf, strlen(buf) + 1) };
 
+        send_trace();
         appmod->send_ctl_msg(&msg);
         // print_comment( __LINE__ , __FILE__ , "sended finished message" );
     }
@@ -824,6 +826,7 @@ void CoviseRender::sendFinishedMsg()
 void CoviseRender::doAddObject(const coDistributedObject *obj, char *name)
 {
     MARK0("COVER ADD_OBJECT adding object to the scenegraph");
+    coTraceScope trace("add object", "renderer");
 
     // call back the function provided by the user
     if (addObjectCallbackFunc != NULL)
@@ -60,18 +60,21 @@ void *ApplicationProcess::get_shared_memory_address()
 
 void ApplicationProcess::send_data_msg(Message *msg)
 {
+    std::lock_guard<std::recursive_mutex> guard(dmgr_mutex);
     if (!datamanager->sendMessage(msg))
         list_of_connections->remove(datamanager);
 }
 
 void ApplicationProcess::recv_data_msg(Message *msg)
 {
+    std::lock_guard<std::recursive_mutex> guard(dmgr_mutex);
     datamanager->recv_msg(msg);
     msg->conn = datamanager;
 }
 
 void ApplicationProcess::exch_data_msg(Message *msg, const std::vector<int> &messageTypes)
 {
+    std::lock_guard<std::recursive_mutex> guard(dmgr_mutex);
     if (!datamanager->sendMessage(msg))
     {
         list_of_connections->remove(datamanager);
@@ -306,10 +309,11 @@ void ApplicationProcess::contact_controller(int p, Host *h)
 
 void ApplicationProcess::handle_shm_msg(Message *msg)
 {
-    int tmpkey, size;
+    int tmpkey;
+    shmSizeType size;
 
-    tmpkey = ((int *)msg->data.data())[0];
-    size = ((int *)msg->data.data())[1];
+    tmpkey = *(int *)msg->data.data();
+    size = *(shmSizeType *)(&msg->data.data()[sizeof(int)]);
     shm->add_new_segment(tmpkey, size);
     //cerr << "new SharedMemory" << endl;
     print_comment(__LINE__, __FILE__, "new SharedMemory");
@@ -10,6 +10,7 @@
 
 #include "covise_process.h"
 #include "covise.h"
+#include <mutex>
 
 class ShmAccess;
 
@@ -21,6 +22,7 @@ class COVISEEXPORT ApplicationProcess : public OrdinaryProcess
 //friend class DO_PartitionedObject;
     const DataManagerConnection *datamanager;
     ShmAccess *shm; // pointer to the sharedmemory
+    std::recursive_mutex dmgr_mutex;
     //List<coDistributedObject> *part_obj_list;
 protected:
     void process_msg_from_dmgr(Message *); // handle msg from datamgr
@@ -39,6 +41,12 @@ public:
     void send_data_msg(Message *); // send message to the datamanager
     void recv_data_msg(Message *); // recv a message from the datamanager
     void exch_data_msg(Message *, const std::vector<int> &messageTypes); //send msg and wait for a response with one of messageTypes 
+    // serializes the communication with the datamanager between threads,
+    // hold it across a send_data_msg/recv_data_msg pair
+    std::recursive_mutex &data_msg_mutex()
+    {
+        return dmgr_mutex;
+    };
     //void add_new_part_obj(coDistributedObject *po) { part_obj_list->add(po); };
     // gets part obj out of list
     //coDistributedObject *get_part_obj(char *pname);
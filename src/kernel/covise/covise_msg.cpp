@@ -82,10 +82,10 @@ ShmMessage::ShmMessage(coShmPtr *ptr)
     if (ptr != NULL)
     {
         type = COVISE_MESSAGE_MALLOC_OK;
-        int *idata = new int[2];
-        idata[0] = ptr->shm_seq_no;
-        idata[1] = ptr->offset;
-        data = DataHandle((char *)idata, 2 * sizeof(int));
+        char *cdata = new char[sizeof(int) + sizeof(shmSizeType)];
+        *(int *)cdata = ptr->shm_seq_no;
+        *(shmSizeType *)(&cdata[sizeof(int)]) = ptr->offset;
+        data = DataHandle(cdata, int(sizeof(int) + sizeof(shmSizeType)));
         //cerr << "Message coShmPtr: " << ptr->shm_seq_no <<
         //     ": " << ptr->offset << "\n";
     }
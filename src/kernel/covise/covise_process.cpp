@@ -37,6 +37,7 @@
 #include <messages/CRB_EXEC.h>
 #include <util/coLog.h>
 #include <config/CoviseConfig.h>
+#include <mutex>
 #ifdef _WIN32
 #include <io.h>
 #else
@@ -984,6 +985,9 @@ int OrdinaryProcess::is_connected()
 
 void OrdinaryProcess::send_ctl_msg(const Message *msg)
 {
+    // modules may report from several threads
+    static std::mutex ctl_mutex;
+    std::unique_lock<std::mutex> guard(ctl_mutex);
     if ((controller) && !(controller->sendMessage(msg)))
     {
         list_of_connections->remove(controller);
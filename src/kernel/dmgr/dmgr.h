@@ -61,23 +61,25 @@ class DMGREXPORT ObjectEntry
     DataHandle name; // name of the object
     int version; // version of the object
     int shm_seq_no; // shm_seq_no of the object
-    int offset; // offset of the object
+    shmSizeType offset; // offset of the object
     int type; // type of the object
     const Connection *owner; // connection to the process that created this object
     List<AccessEntry> *access; // list of access rights to this object
     DMEntry *dmgr; // pointer to the DM which sent the object (can be like owner)
+    bool shared_octtree = false; // a module has built the shared oct-tree of this grid
 public:
     ObjectEntry()
     {
         name = 0L;
-        shm_seq_no = offset = -1;
+        shm_seq_no = -1;
+        offset = 0;
         dmgr = 0L;
         version = 1;
         access = new List<AccessEntry>;
     };
     ObjectEntry(const DataHandle& n);
-    ObjectEntry(const DataHandle &n, int type, int no, int o, const Connection *c, DMEntry *dm = 0L);
-    ObjectEntry(const DataHandle &n, int no, int o, const Connection *c, DMEntry *dm = 0L);
+    ObjectEntry(const DataHandle &n, int type, int no, shmSizeType o, const Connection *c, DMEntry *dm = 0L);
+    ObjectEntry(const DataHandle &n, int no, shmSizeType o, const Connection *c, DMEntry *dm = 0L);
 
     int operator==(ObjectEntry &oe)
     {
@@ -108,7 +110,8 @@ public:
     {
         dmgr = dm;
     };
-    void pack_and_send_object(Message *msg, DataManagerProcess *dm);
+    // false if the transfer was aborted as sending failed
+    bool pack_and_send_object(Message *msg, DataManagerProcess *dm);
     void pack_address(Message *msg);
     void print();
     ~ObjectEntry();
@@ -180,6 +183,22 @@ public:
 
 class AddressOrderedTree;
 class SizeOrderedTree;
+class SizeClassBins;
+class MemChunk;
+
+// counters of coShmAlloc, all sizes in bytes
+struct ShmAllocStatistics
+{
+    unsigned long long bin_hits = 0; // small allocations served from a size class bin
+    unsigned long long bin_misses = 0; // small allocations that had to refill their bin
+    unsigned long long tree_allocs = 0; // large allocations served by the AVL trees
+    unsigned long long bin_flushes = 0; // bins handed back to the trees before a new segment is created
+    unsigned long long requested_small = 0; // sum of all small sizes requested
+    unsigned long long allocated_small = 0; // sum of the size classes handed out for them
+    unsigned long long segment_bytes = 0; // size of all shared memory segments
+    unsigned long long used_bytes = 0; // currently allocated
+    unsigned long long cached_bytes = 0; // currently free, but held in size class bins
+};
 
 class DMGREXPORT coShmAlloc : public ShmAccess
 {
@@ -187,6 +206,13 @@ class DMGREXPORT coShmAlloc : public ShmAccess
     static class AddressOrderedTree *used_list;
     static class AddressOrderedTree *free_list;
     static class SizeOrderedTree *free_size_list;
+    // small and medium sized chunks bypass the trees
+    static class SizeClassBins *bins;
+    ShmAllocStatistics stats;
+    MemChunk *tree_malloc(shmSizeType size);
+    void tree_free(MemChunk *chunk);
+    MemChunk *bin_malloc(shmSizeType size);
+    void flush_bins();
 
 public:
     coShmAlloc(int *key, DataManagerProcess *d);
@@ -197,7 +223,7 @@ public:
     coShmPtr *malloc(shmSizeType size);
     void get_shmlist(char *ptr)
     {
-        shm->get_shmlist((int *)ptr);
+        shm->get_shmlist(ptr);
     };
     void free(coShmPtr *adr)
     {
@@ -205,13 +231,18 @@ public:
     };
     void free(int shm_seq_no, shmSizeType offset);
     void print();
+    const ShmAllocStatistics &get_statistics() const
+    {
+        return stats;
+    };
+    void print_statistics();
     void collect_garbage(){};
     void new_desk(void);
 };
 
 class DMGREXPORT DataManagerProcess : public OrdinaryProcess
 {
-    friend void ObjectEntry::pack_and_send_object(Message *, DataManagerProcess *);
+    friend bool ObjectEntry::pack_and_send_object(Message *, DataManagerProcess *);
     const ServerConnection *transfermanager = nullptr; // Connection to the transfermanager
     const Connection *tmpconn = nullptr; // tmpconn for intermediate use
     coShmAlloc *shm; // pointer to the sharedmemory
@@ -287,9 +318,9 @@ public:
     void has_object_changed(Message *msg); // answer requests immediately
     DataHandle get_all_hosts_for_object(const DataHandle &n); // looks for all hosts that have object
     // add new object in database
-    int add_object(const DataHandle &n, int no, int o, const Connection *c);
+    int add_object(const DataHandle &n, int no, shmSizeType o, const Connection *c);
     // add new object in database
-    int add_object(const DataHandle &n, int otype, int no, int o, const Connection *c);
+    int add_object(const DataHandle &n, int otype, int no, shmSizeType o, const Connection *c);
     int add_object(ObjectEntry *oe); // add new object in database
     ObjectEntry *get_object(const DataHandle &n); // get object from database
     // get object from database and take care that the
@@ -298,6 +329,8 @@ public:
     ObjectEntry *get_local_object(const DataHandle &n); // get object only from local database
     int delete_object(const DataHandle& n); // delete object from database
     int destroy_object(const DataHandle &n, const Connection *c); // remove obj from sharedmem.
+    void mark_shared_octtree(const DataHandle &n); // if n is a shared oct-tree, its grid has to destroy it
+    void destroy_shared_octtree(const DataHandle &n); // remove the oct-tree modules share for grid n
     // create transferred object
     ObjectEntry *create_object_from_msg(Message *msg, DMEntry *dme);
     // update from transferred object
@@ -314,7 +347,7 @@ public:
     // returns offset into shared memory
     int shm_free(coShmPtr *); // free memory (recursive !!)
     void send_to_all_connections(Message *);
-    int shm_free(int, int); // free memory (recursive !!)
+    int shm_free(int, shmSizeType); // free memory (recursive !!)
     void print_shared_memory_statistics()
     {
         shm->print();
@@ -0,0 +1,234 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#include "dmgr_codec.h"
+#include <covise/covise.h>
+#include <net/covise_connect.h>
+#include <config/CoviseConfig.h>
+#include <util/byteswap.h>
+
+#include <zlib.h>
+#include <algorithm>
+#include <map>
+#include <string>
+
+using namespace covise;
+
+// zlib counts in unsigned int
+static const shmSizeType ZLIB_CHUNK_SIZE = 1 << 30;
+
+int PackCodec::fromName(const std::string &name)
+{
+    std::string codec = name;
+    std::transform(codec.begin(), codec.end(), codec.begin(), ::tolower);
+    if (codec == "fast" || codec == "zlib" || codec == "on" || codec == "true")
+        return FAST;
+    if (codec == "best")
+        return BEST;
+    if (codec != "" && codec != "none" && codec != "off" && codec != "false")
+        print_comment(__LINE__, __FILE__, "unknown data manager compression %s, sending uncompressed", name.c_str());
+    return NONE;
+}
+
+int PackCodec::forHost(const char *hostname)
+{
+    static std::map<std::string, int> codecs;
+
+    std::string hostName = hostname ? hostname : "";
+    auto it = codecs.find(hostName);
+    if (it != codecs.end())
+        return it->second;
+
+    // try the host name, then remove domain names from back to front
+    std::string codec;
+    std::string name = hostName;
+    while (!name.empty())
+    {
+        codec = coCoviseConfig::getEntry("System.DataManager.Compression." + name);
+        if (!codec.empty())
+            break;
+        std::string::size_type lastDot = name.find_last_of('.');
+        if (lastDot == std::string::npos)
+            break;
+        name = name.substr(0, lastDot);
+    }
+    if (codec.empty())
+        codec = coCoviseConfig::getEntry("System.DataManager.Compression");
+
+    int c = fromName(codec);
+    codecs[hostName] = c;
+    return c;
+}
+
+int PackCodec::forConnection(const Connection *conn)
+{
+    if (!conn)
+        return NONE;
+    return forHost(conn->get_hostname());
+}
+
+bool PackCodec::encode(int codec, const char *data, shmSizeType nbytes, int elem_size,
+                       bool is_int, std::vector<char> &packed, int &filters)
+{
+    if (codec == NONE || nbytes == 0)
+        return false;
+
+    filters = 0;
+    shmSizeType no = nbytes / elem_size;
+    std::vector<char> filtered;
+    const char *in = data;
+
+    if (is_int && elem_size == 4)
+    {
+        // connectivity and index lists change slowly, differences compress better
+        filtered.resize(nbytes);
+        const uint32_t *src = (const uint32_t *)data;
+        uint32_t *dst = (uint32_t *)filtered.data();
+        uint32_t prev = 0;
+        for (shmSizeType i = 0; i < no; i++)
+        {
+            dst[i] = src[i] - prev;
+            prev = src[i];
+        }
+        filters |= DELTA;
+        in = filtered.data();
+    }
+    if (elem_size > 1)
+    {
+        // exponents and high order bytes of neighbouring values are similar
+        std::vector<char> planes(nbytes);
+        for (int b = 0; b < elem_size; b++)
+        {
+            char *plane = planes.data() + b * no;
+            for (shmSizeType i = 0; i < no; i++)
+                plane[i] = in[i * elem_size + b];
+        }
+        std::copy(in + no * elem_size, in + nbytes, planes.begin() + no * elem_size);
+        filtered.swap(planes);
+        filters |= SHUFFLE;
+        in = filtered.data();
+    }
+
+    z_stream strm;
+    memset(&strm, 0, sizeof(strm));
+    if (deflateInit(&strm, codec == BEST ? Z_BEST_COMPRESSION : Z_BEST_SPEED) != Z_OK)
+        return false;
+    packed.resize(deflateBound(&strm, (uLong)nbytes));
+
+    shmSizeType in_left = nbytes, out_left = packed.size();
+    strm.next_in = (Bytef *)in;
+    strm.next_out = (Bytef *)packed.data();
+    int ret = Z_OK;
+    while (ret == Z_OK)
+    {
+        if (strm.avail_in == 0)
+        {
+            strm.avail_in = (uInt)std::min(in_left, ZLIB_CHUNK_SIZE);
+            in_left -= strm.avail_in;
+        }
+        if (strm.avail_out == 0)
+        {
+            strm.avail_out = (uInt)std::min(out_left, ZLIB_CHUNK_SIZE);
+            out_left -= strm.avail_out;
+        }
+        ret = deflate(&strm, in_left == 0 ? Z_FINISH : Z_NO_FLUSH);
+        if (ret == Z_BUF_ERROR && strm.avail_out == 0 && out_left > 0)
+            ret = Z_OK;
+    }
+    shmSizeType packed_size = (shmSizeType)(strm.next_out - (Bytef *)packed.data());
+    deflateEnd(&strm);
+    if (ret != Z_STREAM_END)
+    {
+        print_error(__LINE__, __FILE__, "compressing array failed: %d", ret);
+        return false;
+    }
+    packed.resize(packed_size);
+
+    // not worth the effort of decompressing on the other side
+    return packed_size < nbytes - nbytes / 8;
+}
+
+bool PackCodec::decode(const char *packed, shmSizeType packed_size, char *data, shmSizeType nbytes,
+                       int elem_size, int filters, bool swap)
+{
+    std::vector<char> planes;
+    char *out = data;
+    if (filters & SHUFFLE)
+    {
+        planes.resize(nbytes);
+        out = planes.data();
+    }
+
+    z_stream strm;
+    memset(&strm, 0, sizeof(strm));
+    if (inflateInit(&strm) != Z_OK)
+        return false;
+    shmSizeType in_left = packed_size, out_left = nbytes;
+    strm.next_in = (Bytef *)packed;
+    strm.next_out = (Bytef *)out;
+    int ret = Z_OK;
+    while (ret == Z_OK)
+    {
+        if (strm.avail_in == 0)
+        {
+            strm.avail_in = (uInt)std::min(in_left, ZLIB_CHUNK_SIZE);
+            in_left -= strm.avail_in;
+        }
+        if (strm.avail_out == 0)
+        {
+            strm.avail_out = (uInt)std::min(out_left, ZLIB_CHUNK_SIZE);
+            out_left -= strm.avail_out;
+        }
+        ret = inflate(&strm, Z_NO_FLUSH);
+        if (ret == Z_BUF_ERROR && ((strm.avail_in == 0 && in_left > 0) || (strm.avail_out == 0 && out_left > 0)))
+            ret = Z_OK;
+    }
+    shmSizeType unpacked_size = (shmSizeType)(strm.next_out - (Bytef *)out);
+    inflateEnd(&strm);
+    if (ret != Z_STREAM_END || unpacked_size != nbytes)
+    {
+        print_error(__LINE__, __FILE__, "decompressing array failed: %d", ret);
+        return false;
+    }
+
+    shmSizeType no = nbytes / elem_size;
+    if (filters & SHUFFLE)
+    {
+        for (int b = 0; b < elem_size; b++)
+        {
+            const char *plane = planes.data() + b * no;
+            for (shmSizeType i = 0; i < no; i++)
+                data[i * elem_size + b] = plane[i];
+        }
+        std::copy(planes.begin() + no * elem_size, planes.end(), data + no * elem_size);
+    }
+
+    if (swap)
+    {
+        switch (elem_size)
+        {
+        case 2:
+            for (shmSizeType i = 0; i < no; i++)
+                std::swap(data[2 * i], data[2 * i + 1]);
+            break;
+        case 4:
+            byteSwap((uint32_t *)data, (uint64_t)no);
+            break;
+        case 8:
+            byteSwap((uint64_t *)data, (uint64_t)no);
+            break;
+        }
+    }
+
+    if (filters & DELTA)
+    {
+        uint32_t *values = (uint32_t *)data;
+        for (shmSizeType i = 1; i < no; i++)
+            values[i] += values[i - 1];
+    }
+    return true;
+}
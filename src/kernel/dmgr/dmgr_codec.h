@@ -0,0 +1,58 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#ifndef DMGR_CODEC_H
+#define DMGR_CODEC_H
+
+#include <util/coExport.h>
+#include <shm/covise_shm.h>
+#include <vector>
+
+//*****************************************************************//
+// lossless compression of arrays sent between data managers:
+// integer arrays are delta encoded, multi-byte elements are split
+// into byte planes (all first bytes, all second bytes, ...) and the
+// result is deflated with zlib
+//*****************************************************************//
+
+namespace covise
+{
+
+class Connection;
+
+class DMGREXPORT PackCodec
+{
+public:
+    enum Codec
+    {
+        NONE = 0, // send raw arrays
+        FAST, // deflate level 1
+        BEST // deflate level 9
+    };
+
+    // filters applied before deflating, sent along with the array
+    enum Filter
+    {
+        DELTA = 1,
+        SHUFFLE = 2
+    };
+
+    // codec for arrays sent to the host at the other end of conn, from
+    // System.DataManager.Compression.<hostname> or System.DataManager.Compression
+    static int forConnection(const Connection *conn);
+    static int forHost(const char *hostname);
+    static int fromName(const std::string &name);
+
+    // returns false if compressing does not pay off for this array
+    static bool encode(int codec, const char *data, shmSizeType nbytes, int elem_size,
+                       bool is_int, std::vector<char> &packed, int &filters);
+    // undo encode, elements are byte swapped if swap is set
+    static bool decode(const char *packed, shmSizeType packed_size, char *data, shmSizeType nbytes,
+                       int elem_size, int filters, bool swap);
+};
+}
+#endif
@@ -0,0 +1,123 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+// throughput and compression ratio of the data manager transport codecs
+// for the arrays of a hexahedral coDoUnstructuredGrid and a coDoFloat on it
+//
+// usage: dmgrCodecBench [cells per direction]
+
+#include "dmgr_codec.h"
+#include <do/coDoUnstructuredGrid.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace covise;
+
+struct BenchArray
+{
+    const char *name;
+    const char *data;
+    shmSizeType nbytes;
+    int elem_size;
+    bool is_int;
+};
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool bench(const BenchArray &a, int codec, const char *codecName)
+{
+    std::vector<char> packed;
+    int filters = 0;
+    auto start = std::chrono::steady_clock::now();
+    bool compressed = PackCodec::encode(codec, a.data, a.nbytes, a.elem_size, a.is_int, packed, filters);
+    double encodeTime = seconds_since(start);
+    if (!compressed)
+    {
+        printf("%-12s %-5s %10.1f MB   not compressible\n", a.name, codecName, a.nbytes / 1048576.);
+        return true;
+    }
+
+    std::vector<char> unpacked(a.nbytes);
+    start = std::chrono::steady_clock::now();
+    bool ok = PackCodec::decode(packed.data(), packed.size(), unpacked.data(), a.nbytes, a.elem_size, filters, false);
+    double decodeTime = seconds_since(start);
+    ok = ok && memcmp(unpacked.data(), a.data, a.nbytes) == 0;
+
+    printf("%-12s %-5s %10.1f MB   ratio %6.2f   encode %8.1f MB/s   decode %8.1f MB/s%s\n",
+           a.name, codecName, a.nbytes / 1048576., (double)a.nbytes / packed.size(),
+           a.nbytes / 1048576. / encodeTime, a.nbytes / 1048576. / decodeTime,
+           ok ? "" : "   MISMATCH");
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    int n = argc > 1 ? atoi(argv[1]) : 64;
+    if (n < 1)
+        n = 1;
+    int np = n + 1;
+    size_t numElem = (size_t)n * n * n, numConn = 8 * numElem, numCoord = (size_t)np * np * np;
+
+    // unstructured grid of hexahedra, as a mesh reader would create it
+    std::vector<int> el(numElem), tl(numElem, TYPE_HEXAEDER), cl(numConn);
+    std::vector<float> x(numCoord), y(numCoord), z(numCoord), s(numCoord);
+    size_t e = 0;
+    for (int k = 0; k < n; k++)
+        for (int j = 0; j < n; j++)
+            for (int i = 0; i < n; i++, e++)
+            {
+                int v = (k * np + j) * np + i;
+                int *c = &cl[8 * e];
+                el[e] = (int)(8 * e);
+                c[0] = v;
+                c[1] = v + 1;
+                c[2] = v + np + 1;
+                c[3] = v + np;
+                c[4] = v + np * np;
+                c[5] = v + np * np + 1;
+                c[6] = v + np * np + np + 1;
+                c[7] = v + np * np + np;
+            }
+    size_t p = 0;
+    for (int k = 0; k < np; k++)
+        for (int j = 0; j < np; j++)
+            for (int i = 0; i < np; i++, p++)
+            {
+                // slightly distorted to avoid perfectly regular coordinates
+                x[p] = i + 0.1f * sinf(0.3f * j);
+                y[p] = j + 0.1f * cosf(0.2f * k);
+                z[p] = k * 1.5f;
+                s[p] = sinf(0.05f * i) * cosf(0.07f * j) + 0.01f * k;
+            }
+
+    BenchArray arrays[] = {
+        { "elements", (const char *)el.data(), el.size() * sizeof(int), sizeof(int), true },
+        { "types", (const char *)tl.data(), tl.size() * sizeof(int), sizeof(int), true },
+        { "connection", (const char *)cl.data(), cl.size() * sizeof(int), sizeof(int), true },
+        { "x coord", (const char *)x.data(), x.size() * sizeof(float), sizeof(float), false },
+        { "y coord", (const char *)y.data(), y.size() * sizeof(float), sizeof(float), false },
+        { "z coord", (const char *)z.data(), z.size() * sizeof(float), sizeof(float), false },
+        { "scalar", (const char *)s.data(), s.size() * sizeof(float), sizeof(float), false },
+    };
+
+    printf("%d^3 hexahedra, %zu coordinates\n", n, numCoord);
+    bool ok = true;
+    for (const auto &a : arrays)
+    {
+        ok = bench(a, PackCodec::FAST, "fast") && ok;
+        ok = bench(a, PackCodec::BEST, "best") && ok;
+    }
+    return ok ? 0 : 1;
+}
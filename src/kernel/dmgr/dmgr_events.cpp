@@ -130,9 +130,9 @@ int DataManagerProcess::handle_msg(Message *msg)
         print_comment(__LINE__, __FILE__, tmp_str);
 #endif
         DataHandle dh = msg->data;
-        dh.movePtr(2 * sizeof(int));
+        dh.movePtr(int(sizeof(int) + sizeof(shmSizeType)));
         ok = add_object(dh, *(int*)msg->data.data(),
-            *(int*)(&msg->data.data()[sizeof(int)]), msg->conn);
+            *(shmSizeType*)(&msg->data.data()[sizeof(int)]), msg->conn);
         if (ok == 1)
             msg->type = COVISE_MESSAGE_MSG_OK;
         else
@@ -308,11 +308,11 @@ int DataManagerProcess::handle_msg(Message *msg)
         print_comment(__LINE__, __FILE__, "GET_SHM_KEY");
 #endif
         {
-            char* d = new char[sizeof(int) * (MAX_NO_SHM * 2 + 1)];
+            char* d = new char[sizeof(int) + MAX_NO_SHM * (sizeof(int) + sizeof(shmSizeType))];
             shm->get_shmlist(d);
-            msg->data = DataHandle(d, *(int*)d * sizeof(int) * 2 + sizeof(int));
-            print_comment(__LINE__, __FILE__, "GET_SHM_KEY: %d: %x, %d msg->data.length(): %d", *(int*)msg->data.data(),
-                ((int*)msg->data.data())[1], ((int*)msg->data.data())[2], msg->data.length());
+            msg->data = DataHandle(d, int(*(int*)d * (sizeof(int) + sizeof(shmSizeType)) + sizeof(int)));
+            print_comment(__LINE__, __FILE__, "GET_SHM_KEY: %d: %x msg->data.length(): %d", *(int*)msg->data.data(),
+                ((int*)msg->data.data())[1], msg->data.length());
 
         }
         break;
@@ -362,10 +362,10 @@ int DataManagerProcess::handle_msg(Message *msg)
 #ifdef DEBUG
         print_comment(__LINE__, __FILE__, "in SHM_FREE");
 #endif
-        number = (msg->data.length() / sizeof(int)) / 2;
+        number = msg->data.length() / (sizeof(int) + sizeof(shmSizeType));
         idata = (int*)msg->data.data();
         for (i = 0; i < number; i++)
-            shm_free(idata[i * 2], idata[i * 2 + 1]);
+            shm_free(idata[i * SHM_PTR_INT_SIZE], *(shmSizeType*)(&idata[i * SHM_PTR_INT_SIZE + 1]));
         retval = 1;
         break;
     }
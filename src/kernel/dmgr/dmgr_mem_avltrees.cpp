@@ -115,6 +115,33 @@ void delete_memchunk(MemChunk *chunk_ptr)
     chunk_ptr->next = chunk_list;
     chunk_list = chunk_ptr;
 }
+
+int SizeClassBins::get_class(shmSizeType size)
+{
+    if (size == 0)
+        return 0;
+    if (size <= SLAB_SMALL_LIMIT)
+        return int((size - 1) / SIZEOF_ALIGNMENT);
+    if (size > SLAB_MAX_SIZE)
+        return -1;
+
+    // size is in (2^log, 2^(log+1)]
+    int log = 0;
+    for (shmSizeType tmp = size - 1; tmp > 1; tmp >>= 1)
+        log++;
+    // (size - 1) >> (log - 2) is in 4..7
+    return NO_OF_SMALL_SIZE_CLASSES + (log - 8) * 4 + int((size - 1) >> (log - 2)) - 4;
+}
+
+shmSizeType SizeClassBins::get_class_size(int size_class)
+{
+    if (size_class < NO_OF_SMALL_SIZE_CLASSES)
+        return (size_class + 1) * SIZEOF_ALIGNMENT;
+
+    int log = 8 + (size_class - NO_OF_SMALL_SIZE_CLASSES) / 4;
+    int step = (size_class - NO_OF_SMALL_SIZE_CLASSES) % 4;
+    return shmSizeType(5 + step) << (log - 2);
+}
 }
 /* rebalance an AVL-tree */
 
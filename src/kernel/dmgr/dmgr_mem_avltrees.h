@@ -88,6 +88,10 @@ public:
         coShmPtr *ptr = new coShmPtr(seq_no, covise::shmSizeType(address - (char *)shm->get_pointer(seq_no)));
         return ptr;
     };
+    int get_seq_no()
+    {
+        return seq_no;
+    };
     char *get_plain_address()
     {
         return address;
@@ -394,5 +398,66 @@ public:
         tree.empty_tree();
     };
 };
+
+// size classes for small and medium sized chunks:
+// steps of SIZEOF_ALIGNMENT up to SLAB_SMALL_LIMIT,
+// above that four classes per power of two up to SLAB_MAX_SIZE
+const shmSizeType SLAB_SMALL_LIMIT = 256;
+const shmSizeType SLAB_MAX_SIZE = 64 * 1024;
+const int NO_OF_SMALL_SIZE_CLASSES = SLAB_SMALL_LIMIT / SIZEOF_ALIGNMENT;
+const int NO_OF_SIZE_CLASSES = NO_OF_SMALL_SIZE_CLASSES + 4 * 8; // 256 .. 64k
+// a bin is refilled by carving up to SLAB_MAX_CHUNKS chunks
+// (but not more than SLAB_REFILL_SIZE bytes) out of one tree chunk
+const shmSizeType SLAB_REFILL_SIZE = 256 * 1024;
+const int SLAB_MAX_CHUNKS = 64;
+
+class DMGREXPORT SizeClassBins
+{
+private:
+    MemChunk *bins[NO_OF_SIZE_CLASSES]; // free chunks, linked through MemChunk::next
+    int number_of_chunks[NO_OF_SIZE_CLASSES];
+
+public:
+    SizeClassBins()
+    {
+        for (int i = 0; i < NO_OF_SIZE_CLASSES; i++)
+        {
+            bins[i] = 0L;
+            number_of_chunks[i] = 0;
+        }
+    };
+    // returns -1 if size is too large for the bins
+    static int get_class(shmSizeType size);
+    static shmSizeType get_class_size(int size_class);
+    MemChunk *get_chunk(int size_class)
+    {
+        MemChunk *tmpptr = bins[size_class];
+        if (tmpptr)
+        {
+            bins[size_class] = tmpptr->next;
+            tmpptr->next = 0L;
+            number_of_chunks[size_class]--;
+        }
+        return tmpptr;
+    };
+    void add_chunk(int size_class, MemChunk *d)
+    {
+        d->next = bins[size_class];
+        bins[size_class] = d;
+        number_of_chunks[size_class]++;
+    };
+    // detaches the list of all chunks of size_class
+    MemChunk *remove_all(int size_class)
+    {
+        MemChunk *tmpptr = bins[size_class];
+        bins[size_class] = 0L;
+        number_of_chunks[size_class] = 0;
+        return tmpptr;
+    };
+    int get_number_of_chunks(int size_class)
+    {
+        return number_of_chunks[size_class];
+    };
+};
 }
 #endif
@@ -16,7 +16,7 @@ int DmgrMessage::process_list(DataManagerProcess *dmgr)
     int no = data.length() / (sizeof(data_type) + sizeof(long));
     int i, j, k;
     long size;
-    char *chdata = new char[no * 2 * sizeof(int)];
+    char *chdata = new char[no * (sizeof(int) + sizeof(shmSizeType))];
 
     for (i = 0, j = 0, k = 0; i < no; i++)
     {
@@ -27,8 +27,8 @@ int DmgrMessage::process_list(DataManagerProcess *dmgr)
         shmptr = dmgr->shm_alloc(dt, size);
         *(int *)(&chdata[k]) = shmptr->shm_seq_no;
         k += sizeof(int);
-        *(int *)(&chdata[k]) = shmptr->offset;
-        k += sizeof(int);
+        *(shmSizeType *)(&chdata[k]) = shmptr->offset;
+        k += sizeof(shmSizeType);
     }
     data = DataHandle(chdata, k);
     type = COVISE_MESSAGE_MALLOC_LIST_OK;
@@ -56,7 +56,7 @@ int DmgrMessage::process_new_object_list(DataManagerProcess *dmgr)
         start_data = sizeof(long) + name_len;
     tmp_data = data.accessData() + start_data;
     no = (data.length() - start_data) / (sizeof(data_type) + sizeof(long));
-    chdata = new char[no * 2 * sizeof(int)];
+    chdata = new char[no * (sizeof(int) + sizeof(shmSizeType))];
 
     for (i = 0, j = 0, k = 0; i < no; i++)
     {
@@ -67,12 +67,12 @@ int DmgrMessage::process_new_object_list(DataManagerProcess *dmgr)
         shmptr = dmgr->shm_alloc(dt, size);
         *(int *)(&chdata[k]) = shmptr->shm_seq_no;
         k += sizeof(int);
-        *(int *)(&chdata[k]) = shmptr->offset;
-        k += sizeof(int);
+        *(shmSizeType *)(&chdata[k]) = shmptr->offset;
+        k += sizeof(shmSizeType);
         delete shmptr;
     }
     data = DataHandle(chdata, k);
     type = COVISE_MESSAGE_MALLOC_LIST_OK;
-    ok = dmgr->add_object(DataHandle(name, strlen(name) + 1), otype, *(int *)data.data(), *(int *)(&data.data()[sizeof(int)]), conn);
+    ok = dmgr->add_object(DataHandle(name, strlen(name) + 1), otype, *(int *)data.data(), *(shmSizeType *)(&data.data()[sizeof(int)]), conn);
     return ok;
 }
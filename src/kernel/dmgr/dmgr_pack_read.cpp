@@ -7,6 +7,7 @@
 
 #include "dmgr_packer.h"
 #include <do/coDistributedObject.h>
+#include <vector>
 
 #undef DEBUG
 /* the object header is organized in the following way:
@@ -91,6 +92,30 @@ void PackBuffer::receive()
         print_error(__LINE__, __FILE__, "wrong message received");
 }
 
+bool PackBuffer::read_direct(char *dest, shmSizeType nbytes)
+{
+    // the sender has flushed its buffer before sending the array
+    if (intbuffer_ptr < intbuffer_size())
+    {
+        print_error(__LINE__, __FILE__, "unexpected data in front of direct array");
+        return false;
+    }
+    while (nbytes > 0)
+    {
+        int chunk = nbytes > DIRECT_CHUNK_SIZE ? DIRECT_CHUNK_SIZE : (int)nbytes;
+        if (conn->recv_msg_into(msg, dest, chunk) != chunk)
+        {
+            print_error(__LINE__, __FILE__, "receiving array data failed");
+            msg->data = DataHandle{};
+            return false;
+        }
+        dest += chunk;
+        nbytes -= chunk;
+    }
+    msg->data = DataHandle{};
+    return true;
+}
+
     void
     PackBuffer::read_int(int &rd)
 {
@@ -114,6 +139,20 @@ void PackBuffer::receive()
 #endif
 }
 
+void PackBuffer::read_length(ArrayLengthType &rl)
+{
+#ifdef COVISE_SHM_64BIT
+    int lo, hi;
+    read_int(lo);
+    read_int(hi);
+    rl = (ArrayLengthType)(unsigned int)lo | ((ArrayLengthType)(unsigned int)hi << 32);
+#else
+    int tmp_int;
+    read_int(tmp_int);
+    rl = (ArrayLengthType)tmp_int;
+#endif
+}
+
 inline void PackBuffer::put_back_int()
 {
     // only allowed iummediately after read_int()
@@ -238,10 +277,18 @@ coShmPtr *Packer::read_object(char **tmp_name)
     print_comment(__LINE__, __FILE__, "finished level %d", level);
     level--;
     tmp_int_ptr = (int *)shm_ptr->getPtr();
-    tmp_int_ptr[1] = int((shm_obj_ptr - tmp_int_ptr) * int(sizeof(int)));
+    *(ArrayLengthType *)((char *)tmp_int_ptr + SHM_ARRAY_LENGTH_OFFSET) = ArrayLengthType((shm_obj_ptr - tmp_int_ptr) * sizeof(int));
     return shm_ptr;
 }
 
+// store a (shm_seq_no, offset) pair at shm_obj_ptr and skip it
+void Packer::put_shm_address(int shm_seq_no, shmSizeType offset)
+{
+    *shm_obj_ptr = shm_seq_no;
+    *(shmSizeType *)(shm_obj_ptr + 1) = offset;
+    shm_obj_ptr += SHM_PTR_INT_SIZE;
+}
+
 coShmPtr *Packer::read_header(char **tmp_name)
 {
     int tmp_shm_obj_array[8];
@@ -267,12 +314,13 @@ coShmPtr *Packer::read_header(char **tmp_name)
     shm_obj_ptr = (int *)shm_ptr->getPtr();
     // copy data from temporary storage to shared memory
     *shm_obj_ptr++ = tmp_shm_obj_array[0]; // type
-    shm_obj_ptr++; // skip length; will be filled in later
+    shm_obj_ptr += (SHM_ARRAY_HEADER_SIZE - sizeof(int)) / sizeof(int); // skip length; will be filled in later
     *shm_obj_ptr++ = tmp_shm_obj_array[1]; // OBJECTID
     *shm_obj_ptr++ = tmp_shm_obj_array[2]; // part 1
     *shm_obj_ptr++ = tmp_shm_obj_array[3]; // part 2
-    *shm_obj_ptr++ = tmp_shm_obj_array[4]; // INTSHM
-    *shm_obj_ptr++ = tmp_shm_obj_array[5]; // number of elements
+    *shm_obj_ptr++ = tmp_shm_obj_array[4]; // ARRAYLENGTHSHM
+    for (size_t i = 0; i < sizeof(ArrayLengthType) / sizeof(int); i++)
+        *shm_obj_ptr++ = tmp_shm_obj_array[5 + i]; // number of elements
     buffer->read_int(*shm_obj_ptr++);
     read_int(); // version
     buffer->read_int(*shm_obj_ptr++);
@@ -283,7 +331,7 @@ coShmPtr *Packer::read_header(char **tmp_name)
     {
         shm_obj_ptr++;
         read_shm_pointer(); // object name; internal check_buffer_size
-        shm_arr = new coShmArray(*(shm_obj_ptr - 2), *(shm_obj_ptr - 1));
+        shm_arr = new coShmArray(*(shm_obj_ptr - SHM_PTR_INT_SIZE), *(shmSizeType *)(shm_obj_ptr - SHM_PTR_INT_SIZE + 1));
         tmp_name_ptr = (char *)((coShmArray *)shm_arr)->getDataPtr();
         *tmp_name = new char[strlen(tmp_name_ptr) + 1];
         strcpy(*tmp_name, tmp_name_ptr);
@@ -324,13 +372,12 @@ int Packer::read_number_of_elements()
 #ifdef DEBUG
     print_comment(__LINE__, __FILE__, "Packer::read_number_of_elements");
 #endif
-    if (read_int())
-    {
-        number_of_data_elements = *(shm_obj_ptr - 1);
-        return 1;
-    }
-    else
-        return 0;
+    ArrayLengthType noe;
+    buffer->read_length(noe);
+    memcpy(shm_obj_ptr, &noe, sizeof(noe));
+    shm_obj_ptr += sizeof(noe) / sizeof(int);
+    number_of_data_elements = (int)noe;
+    return 1;
 }
 
 int Packer::read_char()
@@ -398,7 +445,7 @@ int Packer::read_long()
     int no_of_ints = sizeof(long) / sizeof(int);
     swap_bytes((unsigned int *)tmp_char_ptr, no_of_ints);
     *(long *)shm_obj_ptr = *(long *)tmp_char_ptr;
-    shm_obj_ptr++; // proceed to next
+    shm_obj_ptr += no_of_ints; // proceed to next
     return 1;
 }
 
@@ -444,7 +491,7 @@ int Packer::read_double()
     int no_of_ints = sizeof(double) / sizeof(int);
     swap_bytes((unsigned int *)tmp_char_ptr, no_of_ints);
     *(double *)shm_obj_ptr = *(double *)tmp_char_ptr;
-    shm_obj_ptr++; // proceed to next
+    shm_obj_ptr += no_of_ints; // proceed to next
     return 1;
 }
 
@@ -462,9 +509,49 @@ int Packer::read_object_id()
     return 1;
 }
 
-int Packer::read_char_array()
+// the array data goes directly to shared memory and is only swapped
+// if the sender has a different byte order
+int Packer::read_array_direct(char *dest, shmSizeType nbytes, int elem_size, int direct)
+{
+    bool swap = (direct & (PACK_DIRECT_LITTLE_ENDIAN | PACK_DIRECT_BIG_ENDIAN)) != PACK_DIRECT_NATIVE;
+    if (direct & PACK_COMPRESSED)
+    {
+        int filters;
+        ArrayLengthType packed_size;
+        buffer->read_int(filters);
+        buffer->read_length(packed_size);
+        std::vector<char> packed(packed_size);
+        if (!buffer->read_direct(packed.data(), packed_size))
+            return 0;
+        return PackCodec::decode(packed.data(), packed_size, dest, nbytes, elem_size, filters, swap) ? 1 : 0;
+    }
+
+    if (!buffer->read_direct(dest, nbytes))
+        return 0;
+    if (!swap)
+        return 1;
+    shmSizeType no = nbytes / elem_size;
+    switch (elem_size)
+    {
+    case 2:
+        for (shmSizeType i = 0; i < no; i++)
+            std::swap(dest[2 * i], dest[2 * i + 1]);
+        break;
+    case 4:
+        byteSwap((uint32_t *)dest, (uint64_t)no);
+        break;
+    case 8:
+        byteSwap((uint64_t *)dest, (uint64_t)no);
+        break;
+    }
+    return 1;
+}
+
+int Packer::read_char_array(int direct)
 {
-    int bytes_needed, rest, length;
+    int bytes_needed;
+    shmSizeType rest;
+    ArrayLengthType length;
     char *tmp_shm_obj_ptr;
     char *tmp_char_ptr;
     coShmPtr *shm_ptr;
@@ -476,15 +563,16 @@ int Packer::read_char_array()
     // type is already read and routine is only called when appropriate!!!
     // (must be guaranteed by programmer!!!!
 
-    buffer->read_int(length);
+    buffer->read_length(length);
     shm_ptr = datamgr->shm_alloc(CHARSHMARRAY, length);
-    *shm_obj_ptr++ = shm_ptr->get_shm_seq_no();
-    *shm_obj_ptr++ = shm_ptr->get_offset();
+    put_shm_address(shm_ptr->get_shm_seq_no(), shm_ptr->get_offset());
     rest = length * sizeof(char);
     tmp_shm_obj_ptr = (char *)((coShmArray *)(void *)shm_ptr)->getDataPtr();
+    if (direct)
+        return read_array_direct(tmp_shm_obj_ptr, length * sizeof(char), 1, direct);
     while (rest > 0) // there is still something to receive
     {
-        bytes_needed = rest;
+        bytes_needed = rest > OBJECT_BUFFER_SIZE ? (int)OBJECT_BUFFER_SIZE : (int)rest;
         tmp_char_ptr = buffer->get_current_pointer_for_n_bytes(bytes_needed);
         memcpy(tmp_shm_obj_ptr, tmp_char_ptr, bytes_needed);
         rest -= bytes_needed;
@@ -493,9 +581,11 @@ int Packer::read_char_array()
     return 1;
 }
 
-int Packer::read_short_array()
+int Packer::read_short_array(int direct)
 {
-    int bytes_needed, rest, length;
+    int bytes_needed;
+    shmSizeType rest;
+    ArrayLengthType length;
     char *tmp_shm_obj_ptr;
     char *tmp_char_ptr;
 #ifdef DEBUG
@@ -510,19 +600,20 @@ int Packer::read_short_array()
     // type is already read and routine is only called when appropriate!!!
     // (must be guaranteed by programmer!!!!
 
-    buffer->read_int(length);
+    buffer->read_length(length);
 #ifdef DEBUG
-    sprintf(tmp_str, "short array with %d elements", length);
+    sprintf(tmp_str, "short array with %llu elements", (unsigned long long)length);
     print_comment(__LINE__, __FILE__, tmp_str);
 #endif
     shm_ptr = datamgr->shm_alloc(SHORTSHMARRAY, length);
-    *shm_obj_ptr++ = shm_ptr->get_shm_seq_no();
-    *shm_obj_ptr++ = shm_ptr->get_offset();
+    put_shm_address(shm_ptr->get_shm_seq_no(), shm_ptr->get_offset());
     tmp_shm_obj_ptr = (char *)((coShmArray *)(void *)shm_ptr)->getDataPtr();
-        rest = length * SIZEOF_IEEE_SHORT;
+    if (direct)
+        return read_array_direct(tmp_shm_obj_ptr, length * SIZEOF_IEEE_SHORT, SIZEOF_IEEE_SHORT, direct);
+    rest = length * SIZEOF_IEEE_SHORT;
     while (rest > 0) // there is still something to receive
     {
-        bytes_needed = rest;
+        bytes_needed = rest > OBJECT_BUFFER_SIZE ? (int)OBJECT_BUFFER_SIZE : (int)rest;
         tmp_char_ptr = buffer->get_current_pointer_for_n_bytes(bytes_needed);
         memcpy(tmp_shm_obj_ptr, tmp_char_ptr, bytes_needed);
         swap_short_bytes((short unsigned int *)tmp_char_ptr, bytes_needed / sizeof(short));
@@ -532,9 +623,11 @@ int Packer::read_short_array()
     return 1;
 }
 
-int Packer::read_int_array()
+int Packer::read_int_array(int direct)
 {
-    int bytes_needed, rest, length;
+    int bytes_needed;
+    shmSizeType rest;
+    ArrayLengthType length;
     char *tmp_shm_obj_ptr;
     char *tmp_char_ptr;
 #ifdef DEBUG
@@ -549,19 +642,20 @@ int Packer::read_int_array()
     // type is already read and routine is only called when appropriate!!!
     // (must be guaranteed by programmer!!!!
 
-    buffer->read_int(length);
+    buffer->read_length(length);
 #ifdef DEBUG
-    sprintf(tmp_str, "int array with %d elements", length);
+    sprintf(tmp_str, "int array with %llu elements", (unsigned long long)length);
     print_comment(__LINE__, __FILE__, tmp_str);
 #endif
     shm_ptr = datamgr->shm_alloc(INTSHMARRAY, length);
-    *shm_obj_ptr++ = shm_ptr->get_shm_seq_no();
-    *shm_obj_ptr++ = shm_ptr->get_offset();
+    put_shm_address(shm_ptr->get_shm_seq_no(), shm_ptr->get_offset());
     tmp_shm_obj_ptr = (char *)((coShmArray *)(void *)shm_ptr)->getDataPtr();
-        rest = length * SIZEOF_IEEE_INT;
+    if (direct)
+        return read_array_direct(tmp_shm_obj_ptr, length * SIZEOF_IEEE_INT, SIZEOF_IEEE_INT, direct);
+    rest = length * SIZEOF_IEEE_INT;
     while (rest > 0) // there is still something to receive
     {
-        bytes_needed = rest;
+        bytes_needed = rest > OBJECT_BUFFER_SIZE ? (int)OBJECT_BUFFER_SIZE : (int)rest;
         tmp_char_ptr = buffer->get_current_pointer_for_n_bytes(bytes_needed);
         memcpy(tmp_shm_obj_ptr, tmp_char_ptr, bytes_needed);
         swap_bytes((unsigned int *)tmp_shm_obj_ptr, bytes_needed / sizeof(int));
@@ -571,9 +665,11 @@ int Packer::read_int_array()
     return 1;
 }
 
-int Packer::read_long_array()
+int Packer::read_long_array(int direct)
 {
-    int bytes_needed, rest, length;
+    int bytes_needed;
+    shmSizeType rest;
+    ArrayLengthType length;
     char *tmp_shm_obj_ptr;
     char *tmp_char_ptr;
 #ifdef DEBUG
@@ -588,19 +684,20 @@ int Packer::read_long_array()
     // type is already read and routine is only called when appropriate!!!
     // (must be guaranteed by programmer!!!!
 
-    buffer->read_int(length);
+    buffer->read_length(length);
 #ifdef DEBUG
-    sprintf(tmp_str, "long array with %d elements", length);
+    sprintf(tmp_str, "long array with %llu elements", (unsigned long long)length);
     print_comment(__LINE__, __FILE__, tmp_str);
 #endif
     shm_ptr = datamgr->shm_alloc(LONGSHMARRAY, length);
-    *shm_obj_ptr++ = shm_ptr->get_shm_seq_no();
-    *shm_obj_ptr++ = shm_ptr->get_offset();
+    put_shm_address(shm_ptr->get_shm_seq_no(), shm_ptr->get_offset());
     tmp_shm_obj_ptr = (char *)((coShmArray *)(void *)shm_ptr)->getDataPtr();
+    if (direct)
+        return read_array_direct(tmp_shm_obj_ptr, length * SIZEOF_IEEE_LONG, SIZEOF_IEEE_LONG, direct);
     rest = length * SIZEOF_IEEE_LONG;
     while (rest > 0) // there is still something to receive
     {
-        bytes_needed = rest;
+        bytes_needed = rest > OBJECT_BUFFER_SIZE ? (int)OBJECT_BUFFER_SIZE : (int)rest;
         tmp_char_ptr = buffer->get_current_pointer_for_n_bytes(bytes_needed);
         memcpy(tmp_shm_obj_ptr, tmp_char_ptr, bytes_needed);
         swap_bytes((unsigned int *)tmp_shm_obj_ptr, bytes_needed / sizeof(int));
@@ -610,9 +707,11 @@ int Packer::read_long_array()
     return 1;
 }
 
-int Packer::read_float_array()
+int Packer::read_float_array(int direct)
 {
-    int bytes_needed, rest, length;
+    int bytes_needed;
+    shmSizeType rest;
+    ArrayLengthType length;
     char *tmp_shm_obj_ptr;
     char *tmp_char_ptr;
 #ifdef DEBUG
@@ -627,19 +726,20 @@ int Packer::read_float_array()
     // type is already read and routine is only called when appropriate!!!
     // (must be guaranteed by programmer!!!!
 
-    buffer->read_int(length);
+    buffer->read_length(length);
 #ifdef DEBUG
-    sprintf(tmp_str, "float array with %d elements", length);
+    sprintf(tmp_str, "float array with %llu elements", (unsigned long long)length);
     print_comment(__LINE__, __FILE__, tmp_str);
 #endif
     shm_ptr = datamgr->shm_alloc(FLOATSHMARRAY, length);
-    *shm_obj_ptr++ = shm_ptr->get_shm_seq_no();
-    *shm_obj_ptr++ = shm_ptr->get_offset();
+    put_shm_address(shm_ptr->get_shm_seq_no(), shm_ptr->get_offset());
     tmp_shm_obj_ptr = (char *)((coShmArray *)(void *)shm_ptr)->getDataPtr();
+    if (direct)
+        return read_array_direct(tmp_shm_obj_ptr, length * SIZEOF_IEEE_FLOAT, SIZEOF_IEEE_FLOAT, direct);
     rest = length * SIZEOF_IEEE_FLOAT;
     while (rest > 0) // there is still something to receive
     {
-        bytes_needed = rest;
+        bytes_needed = rest > OBJECT_BUFFER_SIZE ? (int)OBJECT_BUFFER_SIZE : (int)rest;
         tmp_char_ptr = buffer->get_current_pointer_for_n_bytes(bytes_needed);
         memcpy(tmp_shm_obj_ptr, tmp_char_ptr, bytes_needed);
         swap_bytes((unsigned int *)tmp_shm_obj_ptr, bytes_needed / sizeof(int));
@@ -649,9 +749,11 @@ int Packer::read_float_array()
     return 1;
 }
 
-int Packer::read_double_array()
+int Packer::read_double_array(int direct)
 {
-    int bytes_needed, rest, length;
+    int bytes_needed;
+    shmSizeType rest;
+    ArrayLengthType length;
     char *tmp_shm_obj_ptr;
     char *tmp_char_ptr;
 #ifdef DEBUG
@@ -666,19 +768,20 @@ int Packer::read_double_array()
     // type is already read and routine is only called when appropriate!!!
     // (must be guaranteed by programmer!!!!
 
-    buffer->read_int(length);
+    buffer->read_length(length);
 #ifdef DEBUG
-    sprintf(tmp_str, "double array with %d elements", length);
+    sprintf(tmp_str, "double array with %llu elements", (unsigned long long)length);
     print_comment(__LINE__, __FILE__, tmp_str);
 #endif
     shm_ptr = datamgr->shm_alloc(DOUBLESHMARRAY, length);
-    *shm_obj_ptr++ = shm_ptr->get_shm_seq_no();
-    *shm_obj_ptr++ = shm_ptr->get_offset();
+    put_shm_address(shm_ptr->get_shm_seq_no(), shm_ptr->get_offset());
     tmp_shm_obj_ptr = (char *)((coShmArray *)(void *)shm_ptr)->getDataPtr();
+    if (direct)
+        return read_array_direct(tmp_shm_obj_ptr, length * SIZEOF_IEEE_DOUBLE, SIZEOF_IEEE_DOUBLE, direct);
     rest = length * SIZEOF_IEEE_DOUBLE;
     while (rest > 0) // there is still something to receive
     {
-        bytes_needed = rest;
+        bytes_needed = rest > OBJECT_BUFFER_SIZE ? (int)OBJECT_BUFFER_SIZE : (int)rest;
         tmp_char_ptr = buffer->get_current_pointer_for_n_bytes(bytes_needed);
         memcpy(tmp_shm_obj_ptr, tmp_char_ptr, bytes_needed);
         swap_bytes((unsigned int *)tmp_shm_obj_ptr, bytes_needed / sizeof(int));
@@ -727,8 +830,7 @@ int Packer::read_null_pointer()
     // type is already read and routine is only called when appropriate!!!
     // (must be guaranteed by programmer!!!!)
 
-    *shm_obj_ptr++ = 0; // skip nulls
-    *shm_obj_ptr++ = 0; // skip nulls
+    put_shm_address(0, 0); // skip nulls
     return 1;
 }
 
@@ -748,25 +850,28 @@ int Packer::read_shm_pointer()
     // (must be guaranteed by programmer!!!!)
 
     buffer->read_int(type);
+    // arrays sent directly from shared memory carry the byte order of the sender
+    int direct = type & PACK_DIRECT_MASK;
+    type &= ~PACK_DIRECT_MASK;
     switch (type)
     {
     case CHARSHMARRAY:
-        read_char_array();
+        read_char_array(direct);
         break;
     case SHORTSHMARRAY:
-        read_short_array();
+        read_short_array(direct);
         break;
     case INTSHMARRAY:
-        read_int_array();
+        read_int_array(direct);
         break;
     case LONGSHMARRAY:
-        read_long_array();
+        read_long_array(direct);
         break;
     case FLOATSHMARRAY:
-        read_float_array();
+        read_float_array(direct);
         break;
     case DOUBLESHMARRAY:
-        read_double_array();
+        read_double_array(direct);
         break;
     case STRINGSHMARRAY:
         read_shm_string_array();
@@ -785,8 +890,7 @@ int Packer::read_shm_pointer()
         // and a new copy is transferred over the network and created.
 
         shm_obj_ptr = tmp_shm_obj_ptr;
-        *shm_obj_ptr++ = shm_ptr->get_shm_seq_no();
-        *shm_obj_ptr++ = shm_ptr->get_offset();
+        put_shm_address(shm_ptr->get_shm_seq_no(), shm_ptr->get_offset());
         break;
     }
     return 1;
@@ -794,7 +898,8 @@ int Packer::read_shm_pointer()
 
 int Packer::read_shm_string_array()
 {
-    int length, i, type;
+    ArrayLengthType length, i;
+    int type;
     int *tmp_shm_obj_ptr;
     coShmPtr *shm_ptr;
 
@@ -805,11 +910,10 @@ int Packer::read_shm_string_array()
     // type is already read and routine is only called when appropriate!!!
     // (must be guaranteed by programmer!!!!)
 
-    buffer->read_int(length); // *shm_obj_ptr == length
+    buffer->read_length(length); // *shm_obj_ptr == length
 
     shm_ptr = datamgr->shm_alloc(STRINGSHMARRAY, length);
-    *shm_obj_ptr++ = shm_ptr->get_shm_seq_no();
-    *shm_obj_ptr++ = shm_ptr->get_offset();
+    put_shm_address(shm_ptr->get_shm_seq_no(), shm_ptr->get_offset());
 
     tmp_shm_obj_ptr = shm_obj_ptr;
 
@@ -826,8 +930,8 @@ int Packer::read_shm_string_array()
     for (i = 0; i < length; i++)
     {
         buffer->read_int(type);
-        if (type == CHARSHMARRAY)
-            read_char_array();
+        if ((type & ~PACK_DIRECT_MASK) == CHARSHMARRAY)
+            read_char_array(type & PACK_DIRECT_MASK);
         else
             return 0;
     }
@@ -838,7 +942,8 @@ int Packer::read_shm_string_array()
 
 int Packer::read_shm_pointer_array()
 {
-    int length, i, max, type;
+    ArrayLengthType length, i, max;
+    int type;
     int *tmp_shm_obj_ptr;
     coShmPtr *shm_ptr;
 
@@ -849,12 +954,11 @@ int Packer::read_shm_pointer_array()
     // type is already read and routine is only called when appropriate!!!
     // (must be guaranteed by programmer!!!!)
 
-    buffer->read_int(length); // *shm_obj_ptr == length
+    buffer->read_length(length); // *shm_obj_ptr == length
 
     max = (length / SET_CHUNK + 1) * SET_CHUNK;
     shm_ptr = datamgr->shm_alloc(SHMPTRARRAY, max);
-    *shm_obj_ptr++ = shm_ptr->get_shm_seq_no();
-    *shm_obj_ptr++ = shm_ptr->get_offset();
+    put_shm_address(shm_ptr->get_shm_seq_no(), shm_ptr->get_offset());
 
     tmp_shm_obj_ptr = shm_obj_ptr;
 
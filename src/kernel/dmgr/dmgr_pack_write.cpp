@@ -6,6 +6,8 @@
  * License: LGPL 2+ */
 
 #include "dmgr_packer.h"
+#include <config/CoviseConfig.h>
+#include <vector>
 
 #undef DEBUG
 /*
@@ -65,7 +67,7 @@ always IEEE is enforced. This leads to the ugly #ifdef constructs.
 -----------------------------------------------------------------------*/
 using namespace covise;
 
-Packer::Packer(Message *m, int s, int o)
+Packer::Packer(Message *m, int s, shmSizeType o)
 {
     coShmPtr *shmptr;
 
@@ -93,8 +95,54 @@ int covise::PackBuffer::intbuffer_size()
         msg->data = buffer;
         msg->data.setLength(intbuffer_ptr * sizeof(int));
         print_comment(__LINE__, __FILE__, "msg->data.length(): %d", msg->data.length());
-        conn->sendMessage(msg);
+        if (!failed && !conn->sendMessage(msg))
+        {
+            print_error(__LINE__, __FILE__, "sending object data failed");
+            failed = true;
+        }
+    }
+}
+
+bool PackBuffer::use_direct_transfer()
+{
+    static bool zeroCopy = coCoviseConfig::isOn("System.DataManager.ZeroCopy", false);
+    return zeroCopy;
+}
+
+bool PackBuffer::write_direct(const char *data, shmSizeType nbytes)
+{
+    if (failed)
+    {
+        intbuffer_ptr = 0;
+        return false;
+    }
+
+    // the buffered part and all chunks of the array go out in one gather write
+    std::vector<Message> parts;
+    parts.reserve(1 + nbytes / DIRECT_CHUNK_SIZE + 1);
+    if (intbuffer_ptr != 0)
+    {
+        DataHandle dh = buffer;
+        dh.setLength(intbuffer_ptr * sizeof(int));
+        parts.emplace_back(msg->type, dh);
+    }
+    while (nbytes > 0)
+    {
+        int chunk = nbytes > DIRECT_CHUNK_SIZE ? DIRECT_CHUNK_SIZE : (int)nbytes;
+        parts.emplace_back(msg->type, DataHandle(const_cast<char *>(data), chunk, false));
+        data += chunk;
+        nbytes -= chunk;
+    }
+    std::vector<const Message *> msgs;
+    for (const auto &m : parts)
+        msgs.push_back(&m);
+    intbuffer_ptr = 0;
+    if (!conn->sendMessages(msgs.data(), (int)msgs.size()))
+    {
+        print_error(__LINE__, __FILE__, "sending array data failed");
+        failed = true;
     }
+    return !failed;
 }
 
 void Packer::flush()
@@ -129,6 +177,17 @@ void Packer::flush()
     intbuffer_ptr += 2;
 }
 
+void PackBuffer::write_length(ArrayLengthType wl)
+{
+#ifdef COVISE_SHM_64BIT
+    // lower and upper 32 bits, each in its own int slot
+    write_int((int)(wl & 0xffffffff));
+    write_int((int)(wl >> 32));
+#else
+    write_int((int)wl);
+#endif
+}
+
 char *PackBuffer::get_ptr_for_n_bytes(int &n) // always aligned
 {
     int tmp_ptr;
@@ -177,6 +236,23 @@ char *PackBuffer::get_ptr_for_n_bytes(int &n) // always aligned
     return (char *)&intbuffer()[tmp_ptr];
 }
 
+// shm_obj_ptr points behind the type of an array:
+// returns the array length and skips the rest of the array header
+ArrayLengthType Packer::get_array_length()
+{
+    ArrayLengthType length = *(ArrayLengthType *)((char *)shm_obj_ptr + SHM_ARRAY_LENGTH_OFFSET - sizeof(int));
+    shm_obj_ptr += (SHM_ARRAY_HEADER_SIZE - sizeof(int)) / sizeof(int);
+    return length;
+}
+
+// shm_obj_ptr points to a (shm_seq_no, offset) pair, which is skipped
+coShmPtr *Packer::get_shm_address()
+{
+    coShmPtr *shmptr = new coShmPtr(*shm_obj_ptr, *(shmSizeType *)(shm_obj_ptr + 1));
+    shm_obj_ptr += SHM_PTR_INT_SIZE;
+    return shmptr;
+}
+
 inline int Packer::write_int()
 {
 #ifdef DEBUG
@@ -204,8 +280,14 @@ inline int Packer::write_number_of_elements()
 #ifdef DEBUG
     print_comment(__LINE__, __FILE__, "Packer::write_number_of_elements");
 #endif
-    number_of_data_elements = *(shm_obj_ptr + 1);
-    return write_int();
+    buffer->write_int(*shm_obj_ptr);
+    shm_obj_ptr++; // skip ARRAYLENGTHSHM
+    ArrayLengthType noe;
+    memcpy(&noe, shm_obj_ptr, sizeof(noe));
+    number_of_data_elements = (int)noe;
+    buffer->write_length(noe);
+    shm_obj_ptr += sizeof(noe) / sizeof(int);
+    return 1;
 }
 
 inline int Packer::write_char()
@@ -249,7 +331,7 @@ int Packer::write_long()
     *(long *)tmp_char_ptr = *(long *)shm_obj_ptr;
     int no_of_ints = sizeof(long) / sizeof(int);
     swap_bytes((unsigned int *)tmp_char_ptr, no_of_ints);
-    shm_obj_ptr++; // proceed to next
+    shm_obj_ptr += no_of_ints; // proceed to next
     return 1;
 }
 
@@ -291,7 +373,7 @@ int Packer::write_double()
     *(double *)tmp_char_ptr = *(double *)shm_obj_ptr;
     int no_of_ints = sizeof(double) / sizeof(int);
     swap_bytes((unsigned int *)tmp_char_ptr, no_of_ints);
-    shm_obj_ptr++; // proceed to next
+    shm_obj_ptr += no_of_ints; // proceed to next
     return 1;
 }
 
@@ -309,9 +391,42 @@ inline int Packer::write_object_id()
     return 1;
 }
 
+// send large arrays compressed or without copying and byte swapping them,
+// returns 0 if the array has to go through the buffer
+int Packer::write_array_direct(int type, ArrayLengthType length, shmSizeType nbytes, int elem_size)
+{
+    if (nbytes < IOVEC_MIN_SIZE)
+        return 0;
+    std::vector<char> packed;
+    int filters = 0;
+    if (PackCodec::encode(buffer->get_codec(), (const char *)shm_obj_ptr, nbytes, elem_size,
+                          type == INTSHMARRAY, packed, filters))
+    {
+        buffer->write_int(type | PACK_COMPRESSED | PACK_DIRECT_NATIVE);
+        buffer->write_length(length);
+        buffer->write_int(filters);
+        buffer->write_length(packed.size());
+        buffer->write_direct(packed.data(), packed.size());
+    }
+    else if (buffer->is_direct())
+    {
+        buffer->write_int(type | PACK_DIRECT_NATIVE);
+        buffer->write_length(length);
+        buffer->write_direct((const char *)shm_obj_ptr, nbytes);
+    }
+    else
+    {
+        return 0;
+    }
+    shm_obj_ptr += (nbytes / sizeof(int) + (nbytes % sizeof(int) ? 1 : 0));
+    return 1;
+}
+
 int Packer::write_char_array()
 {
-    int bytes_needed, rest;
+    int bytes_needed;
+    shmSizeType rest;
+    ArrayLengthType length;
     char *tmp_char_ptr;
 
 #ifdef DEBUG
@@ -319,7 +434,6 @@ int Packer::write_char_array()
 #endif
     if (*shm_obj_ptr == CHARSHMARRAY) // *shm_obj_ptr == type
     {
-        buffer->write_int(*shm_obj_ptr);
         shm_obj_ptr++; // skip CHARSHMARRAY
     }
     else
@@ -327,12 +441,15 @@ int Packer::write_char_array()
         print_error(__LINE__, __FILE__, "No CHARSHMARRAY found");
         return 0;
     }
-    buffer->write_int(*shm_obj_ptr); // *shm_obj_ptr == length
-    rest = *shm_obj_ptr * sizeof(char);
-    shm_obj_ptr++; // skip number of characters
+    length = get_array_length();
+    rest = length * sizeof(char);
+    if (write_array_direct(CHARSHMARRAY, length, rest, 1))
+        return 1;
+    buffer->write_int(CHARSHMARRAY);
+    buffer->write_length(length);
     while (rest > 0) // there is still something to send
     {
-        bytes_needed = rest;
+        bytes_needed = rest > OBJECT_BUFFER_SIZE ? (int)OBJECT_BUFFER_SIZE : (int)rest;
         tmp_char_ptr = buffer->get_ptr_for_n_bytes(bytes_needed);
         memcpy(tmp_char_ptr, shm_obj_ptr, bytes_needed);
         rest -= bytes_needed;
@@ -343,7 +460,9 @@ int Packer::write_char_array()
 
 int Packer::write_short_array()
 {
-    int bytes_needed, rest;
+    int bytes_needed;
+    shmSizeType rest;
+    ArrayLengthType length;
     char *tmp_char_ptr;
 
 #ifdef DEBUG
@@ -351,7 +470,6 @@ int Packer::write_short_array()
 #endif
     if (*shm_obj_ptr == SHORTSHMARRAY) // *shm_obj_ptr == type
     {
-        buffer->write_int(*shm_obj_ptr);
         shm_obj_ptr++; // skip SHORTSHMARRAY
     }
     else
@@ -359,12 +477,15 @@ int Packer::write_short_array()
         print_error(__LINE__, __FILE__, "No SHORTSHMARRAY found");
         return 0;
     }
-    buffer->write_int(*shm_obj_ptr); // *shm_obj_ptr == length
-    rest = *shm_obj_ptr * SIZEOF_IEEE_SHORT;
-    shm_obj_ptr++; // skip number of shorts
+    length = get_array_length();
+    rest = length * SIZEOF_IEEE_SHORT;
+    if (write_array_direct(SHORTSHMARRAY, length, rest, SIZEOF_IEEE_SHORT))
+        return 1;
+    buffer->write_int(SHORTSHMARRAY);
+    buffer->write_length(length);
     while (rest > 0) // there is still something to send
     {
-        bytes_needed = rest;
+        bytes_needed = rest > OBJECT_BUFFER_SIZE ? (int)OBJECT_BUFFER_SIZE : (int)rest;
         tmp_char_ptr = buffer->get_ptr_for_n_bytes(bytes_needed);
         memcpy(tmp_char_ptr, shm_obj_ptr, bytes_needed);
         swap_short_bytes((short unsigned int *)tmp_char_ptr, bytes_needed / sizeof(short));
@@ -377,7 +498,9 @@ int Packer::write_short_array()
 
 int Packer::write_int_array()
 {
-    int bytes_needed, rest;
+    int bytes_needed;
+    shmSizeType rest;
+    ArrayLengthType length;
     char *tmp_char_ptr;
 
 #ifdef DEBUG
@@ -385,7 +508,6 @@ int Packer::write_int_array()
 #endif
     if (*shm_obj_ptr == INTSHMARRAY) // *shm_obj_ptr == type
     {
-        buffer->write_int(*shm_obj_ptr);
         shm_obj_ptr++; // skip INTSHMARRAY
     }
     else
@@ -393,12 +515,15 @@ int Packer::write_int_array()
         print_error(__LINE__, __FILE__, "No INTSHMARRAY found");
         return 0;
     }
-    buffer->write_int(*shm_obj_ptr); // *shm_obj_ptr == length
-    rest = *shm_obj_ptr * SIZEOF_IEEE_INT;
-    shm_obj_ptr++; // skip number of ints
+    length = get_array_length();
+    rest = length * SIZEOF_IEEE_INT;
+    if (write_array_direct(INTSHMARRAY, length, rest, SIZEOF_IEEE_INT))
+        return 1;
+    buffer->write_int(INTSHMARRAY);
+    buffer->write_length(length);
     while (rest > 0) // there is still something to send
     {
-        bytes_needed = rest;
+        bytes_needed = rest > OBJECT_BUFFER_SIZE ? (int)OBJECT_BUFFER_SIZE : (int)rest;
         tmp_char_ptr = buffer->get_ptr_for_n_bytes(bytes_needed);
         memcpy(tmp_char_ptr, shm_obj_ptr, bytes_needed);
         swap_bytes((unsigned int *)tmp_char_ptr, bytes_needed / sizeof(int));
@@ -410,7 +535,9 @@ int Packer::write_int_array()
 
 int Packer::write_long_array()
 {
-    int bytes_needed, rest;
+    int bytes_needed;
+    shmSizeType rest;
+    ArrayLengthType length;
     char *tmp_char_ptr;
 
 #ifdef DEBUG
@@ -418,7 +545,6 @@ int Packer::write_long_array()
 #endif
     if (*shm_obj_ptr == LONGSHMARRAY) // *shm_obj_ptr == type
     {
-        buffer->write_int(*shm_obj_ptr);
         shm_obj_ptr++; // skip LONGSHMARRAY
     }
     else
@@ -426,12 +552,15 @@ int Packer::write_long_array()
         print_error(__LINE__, __FILE__, "No LONGSHMARRAY found");
         return 0;
     }
-    buffer->write_int(*shm_obj_ptr); // *shm_obj_ptr == length
-    rest = *shm_obj_ptr * SIZEOF_IEEE_LONG;
-    shm_obj_ptr++; // skip number of longs
+    length = get_array_length();
+    rest = length * SIZEOF_IEEE_LONG;
+    if (write_array_direct(LONGSHMARRAY, length, rest, SIZEOF_IEEE_LONG))
+        return 1;
+    buffer->write_int(LONGSHMARRAY);
+    buffer->write_length(length);
     while (rest > 0) // there is still something to send
     {
-        bytes_needed = rest;
+        bytes_needed = rest > OBJECT_BUFFER_SIZE ? (int)OBJECT_BUFFER_SIZE : (int)rest;
         tmp_char_ptr = buffer->get_ptr_for_n_bytes(bytes_needed);
         memcpy(tmp_char_ptr, shm_obj_ptr, bytes_needed);
         swap_bytes((unsigned int *)tmp_char_ptr, bytes_needed / sizeof(int));
@@ -443,15 +572,15 @@ int Packer::write_long_array()
 
 int Packer::write_float_array()
 {
-    int bytes_needed, rest;
+    int bytes_needed;
+    shmSizeType rest;
+    ArrayLengthType length;
     char *tmp_char_ptr;
-    int no_of_floats;
 #ifdef DEBUG
     print_comment(__LINE__, __FILE__, "Packer::write_float_array");
 #endif
     if (*shm_obj_ptr == FLOATSHMARRAY) // *shm_obj_ptr == type
     {
-        buffer->write_int(*shm_obj_ptr);
         shm_obj_ptr++; // skip FLOATSHMARRAY
     }
     else
@@ -459,13 +588,15 @@ int Packer::write_float_array()
         print_error(__LINE__, __FILE__, "No FLOATSHMARRAY found");
         return 0;
     }
-    buffer->write_int(*shm_obj_ptr); // *shm_obj_ptr == length
-    no_of_floats = *shm_obj_ptr;
-    rest = no_of_floats * SIZEOF_IEEE_FLOAT;
-    shm_obj_ptr++; // skip number of floats
+    length = get_array_length();
+    rest = length * SIZEOF_IEEE_FLOAT;
+    if (write_array_direct(FLOATSHMARRAY, length, rest, SIZEOF_IEEE_FLOAT))
+        return 1;
+    buffer->write_int(FLOATSHMARRAY);
+    buffer->write_length(length);
     while (rest > 0) // there is still something to send
     {
-        bytes_needed = rest;
+        bytes_needed = rest > OBJECT_BUFFER_SIZE ? (int)OBJECT_BUFFER_SIZE : (int)rest;
         print_comment(__LINE__, __FILE__, "bytes needed: %d", bytes_needed);
         tmp_char_ptr = buffer->get_ptr_for_n_bytes(bytes_needed);
         print_comment(__LINE__, __FILE__, "bytes got: %d", bytes_needed);
@@ -479,7 +610,9 @@ int Packer::write_float_array()
 
 int Packer::write_double_array()
 {
-    int bytes_needed, rest;
+    int bytes_needed;
+    shmSizeType rest;
+    ArrayLengthType length;
     char *tmp_char_ptr;
 
 #ifdef DEBUG
@@ -487,7 +620,6 @@ int Packer::write_double_array()
 #endif
     if (*shm_obj_ptr == DOUBLESHMARRAY) // *shm_obj_ptr == type
     {
-        buffer->write_int(*shm_obj_ptr);
         shm_obj_ptr++; // skip DOUBLESHMARRAY
     }
     else
@@ -495,12 +627,15 @@ int Packer::write_double_array()
         print_error(__LINE__, __FILE__, "No DOUBLESHMARRAY found");
         return 0;
     }
-    buffer->write_int(*shm_obj_ptr); // *shm_obj_ptr == length
-    rest = *shm_obj_ptr * SIZEOF_IEEE_DOUBLE;
-    shm_obj_ptr++; // skip number of ints
+    length = get_array_length();
+    rest = length * SIZEOF_IEEE_DOUBLE;
+    if (write_array_direct(DOUBLESHMARRAY, length, rest, SIZEOF_IEEE_DOUBLE))
+        return 1;
+    buffer->write_int(DOUBLESHMARRAY);
+    buffer->write_length(length);
     while (rest > 0) // there is still something to send
     {
-        bytes_needed = rest;
+        bytes_needed = rest > OBJECT_BUFFER_SIZE ? (int)OBJECT_BUFFER_SIZE : (int)rest;
         tmp_char_ptr = buffer->get_ptr_for_n_bytes(bytes_needed);
         memcpy(tmp_char_ptr, shm_obj_ptr, bytes_needed);
         swap_bytes((unsigned int *)tmp_char_ptr, bytes_needed / sizeof(int));
@@ -526,8 +661,7 @@ int Packer::write_double_array()
         print_error(__LINE__, __FILE__, "No NULLPTR found");
         return 0;
     }
-    shm_obj_ptr++; // skip nulls
-    shm_obj_ptr++; // skip nulls
+    shm_obj_ptr += SHM_PTR_INT_SIZE; // skip nulls
 #ifdef DEBUG
     print_comment(__LINE__, __FILE__, "Ende Packer::write_null_pointer");
 #endif
@@ -559,8 +693,7 @@ int Packer::write_shm_pointer()
             return 0;
         }
     }
-    shmptr = new coShmPtr(*shm_obj_ptr, *(shm_obj_ptr + 1));
-    shm_obj_ptr += 2;
+    shmptr = get_shm_address();
     tmp_shm_buffer = shm_obj_ptr;
     shm_obj_ptr = (int *)shmptr->getPtr();
     delete shmptr;
@@ -614,7 +747,7 @@ int Packer::write_shm_pointer_direct()
 
 int Packer::write_shm_string_array()
 {
-    int length, i;
+    ArrayLengthType length, i;
     int *tmp_shm_obj_ptr;
     coShmPtr *shmptr;
 
@@ -631,9 +764,8 @@ int Packer::write_shm_string_array()
         print_error(__LINE__, __FILE__, "No STRINGSHMARRAY found");
         return 0;
     }
-    buffer->write_int(*shm_obj_ptr); // *shm_obj_ptr == length
-    length = *shm_obj_ptr;
-    shm_obj_ptr++; // skip length
+    length = get_array_length();
+    buffer->write_length(length);
 
     //
     //   +----------------+--------+------+------+------+------+----
@@ -645,8 +777,8 @@ int Packer::write_shm_string_array()
 
     for (i = 0; i < length; i++)
     {
-        shmptr = new coShmPtr(*shm_obj_ptr, *(shm_obj_ptr + 1));
-        tmp_shm_obj_ptr = shm_obj_ptr + 2;
+        shmptr = get_shm_address();
+        tmp_shm_obj_ptr = shm_obj_ptr;
         shm_obj_ptr = (int *)shmptr->getPtr();
         delete shmptr;
         write_char_array();
@@ -660,7 +792,7 @@ int Packer::write_shm_string_array()
 
 int Packer::write_shm_pointer_array()
 {
-    int length, i;
+    ArrayLengthType length, i;
     int *tmp_shm_obj_ptr;
     coShmPtr *shmptr;
 
@@ -678,13 +810,12 @@ int Packer::write_shm_pointer_array()
         return 0;
     }
 
-    length = *shm_obj_ptr;
-    shm_obj_ptr++; // skip length
+    length = get_array_length();
     for (i = 0; i < length; i++)
-        if (shm_obj_ptr[2 * i] == 0)
+        if (shm_obj_ptr[SHM_PTR_INT_SIZE * i] == 0)
             break;
     length = i;
-    buffer->write_int(length); // *shm_obj_ptr == length
+    buffer->write_length(length);
 
     //
     //   +-------------+--------+------+------+------+------+----
@@ -699,12 +830,12 @@ int Packer::write_shm_pointer_array()
     {
         if (*shm_obj_ptr == 0)
         {
-            print_comment(__LINE__, __FILE__, "only %d items of SHM_PTR_ARRAY of length %d used", i, length);
+            print_comment(__LINE__, __FILE__, "only %llu items of SHM_PTR_ARRAY of length %llu used", (unsigned long long)i, (unsigned long long)length);
             break;
         }
-        print_comment(__LINE__, __FILE__, "itm %d of %d, SHM_PTR_ARRAY", i, length);
-        shmptr = new coShmPtr(*shm_obj_ptr, *(shm_obj_ptr + 1));
-        tmp_shm_obj_ptr = shm_obj_ptr + 2;
+        print_comment(__LINE__, __FILE__, "itm %llu of %llu, SHM_PTR_ARRAY", (unsigned long long)i, (unsigned long long)length);
+        shmptr = get_shm_address();
+        tmp_shm_obj_ptr = shm_obj_ptr;
         shm_obj_ptr = (int *)shmptr->getPtr();
         delete shmptr;
         buffer->write_int(SHMPTR);
@@ -784,6 +915,14 @@ int Packer::write_object()
             return 0;
             //	    break;
         };
+        // the receiver would interpret everything sent after a lost part wrongly
+        if (buffer->has_failed())
+        {
+#ifdef DEBUG
+            level--;
+#endif
+            return 0;
+        }
     }
 #ifdef DEBUG
     sprintf(tmp_str, "finished level %d", level);
@@ -800,7 +939,7 @@ int Packer::write_header()
     print_comment(__LINE__, __FILE__, "Packer::write_header");
 #endif
     write_type();
-    shm_obj_ptr++; // skip local byte-length information
+    get_array_length(); // skip local byte-length information
     write_object_id();
     write_number_of_elements(); // number of elements
     write_int(); // version
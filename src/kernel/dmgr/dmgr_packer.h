@@ -9,6 +9,7 @@
 #define EC_PACKER_H
 
 #include "dmgr.h"
+#include "dmgr_codec.h"
 #include <covise/covise.h>
 #include <net/dataHandle.h>
 #ifdef shm_ptr
@@ -29,6 +30,21 @@ const int IOVEC_MIN_SIZE = 10000;
 const size_t OBJECT_BUFFER_SIZE = 50000 * SIZEOF_ALIGNMENT;
 const int IOVEC_MAX_LENGTH = 16;
 
+// arrays of at least IOVEC_MIN_SIZE bytes can be sent directly from shared memory
+// (System.DataManager.ZeroCopy) or compressed (System.DataManager.Compression):
+// their type is tagged with the byte order of the sender and the data follows
+// in separate messages of at most DIRECT_CHUNK_SIZE bytes
+const int PACK_DIRECT_LITTLE_ENDIAN = 0x100000;
+const int PACK_DIRECT_BIG_ENDIAN = 0x200000;
+const int PACK_COMPRESSED = 0x400000; // followed by filters and compressed size
+const int PACK_DIRECT_MASK = PACK_DIRECT_LITTLE_ENDIAN | PACK_DIRECT_BIG_ENDIAN | PACK_COMPRESSED;
+#ifdef BYTESWAP
+const int PACK_DIRECT_NATIVE = PACK_DIRECT_LITTLE_ENDIAN;
+#else
+const int PACK_DIRECT_NATIVE = PACK_DIRECT_BIG_ENDIAN;
+#endif
+const int DIRECT_CHUNK_SIZE = 1 << 30;
+
 // the following computes the size of a type entry for a data object
 // usually: TYPE + Data (for char, short, int, etc.) or
 //          TYPE + SHM_SEQ_NO + OFFSET (for shmptr, arrays, etc.)
@@ -37,7 +53,7 @@ const int IOVEC_MAX_LENGTH = 16;
 #ifndef MAX
 #define MAX(a, b) (((a) > (b)) ? (a) : (b))
 #endif
-const int MAX_INT_PER_DATA = MAX((sizeof(double) / sizeof(int)), 2);
+const int MAX_INT_PER_DATA = MAX((sizeof(double) / sizeof(int)), SHM_PTR_INT_SIZE);
 const int SIZE_PER_TYPE_ENTRY = sizeof(int) + MAX_INT_PER_DATA * sizeof(int);
 
 class DMGREXPORT PackBuffer
@@ -51,6 +67,10 @@ private:
     Message *msg; // message that will be sent
     const Connection *conn; // connection through which the message will be sent
     DataManagerProcess *datamgr; // to allow shm_alloc
+    bool direct; // send large arrays directly from shared memory
+    int codec; // PackCodec for large arrays
+    bool failed; // a send failed, nothing more is sent
+    static bool use_direct_transfer();
 public:
     //initialize for receive
     PackBuffer(DataManagerProcess *dm, Message *m)
@@ -62,6 +82,9 @@ public:
         buffer = msg->data;
         msg->data = DataHandle{};
         intbuffer_ptr = 0;
+        direct = false;
+        codec = 0;
+        failed = false;
     };
     PackBuffer(Message *m) // initialize for send
     {
@@ -71,6 +94,9 @@ public:
         convert = conn->convert_to;
         buffer = DataHandle{ OBJECT_BUFFER_SIZE };
         intbuffer_ptr = 0;
+        direct = use_direct_transfer();
+        codec = PackCodec::forConnection(conn);
+        failed = false;
     };
     ~PackBuffer()
     {
@@ -82,6 +108,27 @@ public:
     // sets n to length of available space (always aligned to SIZEOF_ALIGNMENT)
     void write_int(int i);
     void read_int(int &i);
+    // array lengths take two int slots if COVISE_SHM_64BIT is set,
+    // so both ends of a connection have to be built the same way
+    void write_length(ArrayLengthType l);
+    void read_length(ArrayLengthType &l);
+    bool is_direct() const
+    {
+        return direct;
+    };
+    int get_codec() const
+    {
+        return codec;
+    };
+    // send what is buffered and nbytes from data without copying them
+    bool write_direct(const char *data, shmSizeType nbytes);
+    // the receiver cannot follow the object any more
+    bool has_failed() const
+    {
+        return failed;
+    };
+    // receive nbytes sent by write_direct into dest
+    bool read_direct(char *dest, shmSizeType nbytes);
     void put_back_int();
     char *get_current_pointer_for_n_bytes(int &n);
     void skip_n_bytes(int n); // returns pointer to buffer and
@@ -98,6 +145,9 @@ class DMGREXPORT Packer
     DataManagerProcess *datamgr; // to allow shm_alloc
     static int iovcovise_arr[IOVEC_MAX_LENGTH];
     int get_buffer_ptr(int);
+    ArrayLengthType get_array_length();
+    coShmPtr *get_shm_address();
+    void put_shm_address(int shm_seq_no, shmSizeType offset);
     int write_object();
     int write_header();
     int write_type();
@@ -114,6 +164,7 @@ class DMGREXPORT Packer
     int write_long_array();
     int write_float_array();
     int write_double_array();
+    int write_array_direct(int type, ArrayLengthType length, shmSizeType nbytes, int elem_size);
     int write_shm_string_array();
     int write_shm_pointer_array();
     int write_null_pointer();
@@ -132,12 +183,13 @@ class DMGREXPORT Packer
     int read_long();
     int read_float();
     int read_double();
-    int read_char_array();
-    int read_short_array();
-    int read_int_array();
-    int read_long_array();
-    int read_float_array();
-    int read_double_array();
+    int read_char_array(int direct = 0);
+    int read_short_array(int direct = 0);
+    int read_int_array(int direct = 0);
+    int read_long_array(int direct = 0);
+    int read_float_array(int direct = 0);
+    int read_double_array(int direct = 0);
+    int read_array_direct(char *dest, shmSizeType nbytes, int elem_size, int direct);
     int read_shm_string_array();
     int read_shm_pointer_array();
     int read_null_pointer();
@@ -145,16 +197,17 @@ class DMGREXPORT Packer
     int read_number_of_elements();
 
 public:
-    Packer(Message *m, int s, int o);
+    Packer(Message *m, int s, shmSizeType o);
     Packer(Message *m, DataManagerProcess *dm);
     Packer();
     ~Packer()
     {
         delete buffer;
     };
+    // 0 if sending failed: the transfer has to be aborted
     int pack()
     {
-        return write_object();
+        return write_object() && !buffer->has_failed();
     };
     coShmPtr *unpack(char **tmp_name)
     {
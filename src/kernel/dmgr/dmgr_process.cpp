@@ -22,7 +22,9 @@
 
 #include <covise/covise.h>
 #include <do/coDistributedObject.h>
+#include <do/coDoOctTree.h>
 #include <net/covise_host.h>
+#include <util/coTrace.h>
 
 #include "dmgr_packer.h"
 
@@ -143,8 +145,8 @@ void DataManagerProcess::ask_for_object(Message *msg)
         print_comment(__LINE__, __FILE__, "ASK: nach OBJECT_FOLLOWS", 4);
 #endif
         //      covise_time->mark(__LINE__, "object will be packed now");
-        oe->pack_and_send_object(msg, this);
-        oe->add_access(msg->conn, ACC_REMOTE_DATA_MANAGER, ACC_READ_ONLY);
+        if (oe->pack_and_send_object(msg, this))
+            oe->add_access(msg->conn, ACC_REMOTE_DATA_MANAGER, ACC_READ_ONLY);
 #ifdef DEBUG
 //	print_comment(__LINE__, __FILE__, "vor dm_ptr->send_data_msg");
 #endif
@@ -598,7 +600,8 @@ int DataManagerProcess::forward_new_part(Message *partmsg)
             // partmsg->data.data() and partmsg->data.length() should still be ok here
             partmsg->type = COVISE_MESSAGE_NEW_PART_AVAILABLE;
             acc->conn->sendMessage(partmsg);
-            part->pack_and_send_object(partmsg, this);
+            if (!part->pack_and_send_object(partmsg, this))
+                continue;
             part->add_access(partmsg->conn, ACC_REMOTE_DATA_MANAGER, ACC_READ_ONLY);
             acc->conn->sendMessage(partmsg);
         }
@@ -697,7 +700,6 @@ coShmPtr *DataManagerProcess::shm_alloc(int type, shmSizeType msize)
 #ifdef DEBUG
     char tmpstr[255];
 #endif
-    int i;
 
     /// Collect size in this variable:
 
@@ -724,32 +726,32 @@ coShmPtr *DataManagerProcess::shm_alloc(int type, shmSizeType msize)
     case INTSHM:
         size += sizeof(int);
         break;
+    // Arrays: type and length (SHM_ARRAY_HEADER_SIZE) followed by the data,
+    // the int already counted in size is the safety value at the end.
+    // the additional int is for alignment whenever this may be doubtful
     case FLOATSHMARRAY:
-        size += msize * sizeof(float) + 2 * sizeof(int);
+        size += SHM_ARRAY_HEADER_SIZE + msize * sizeof(float);
         break;
     case DOUBLESHMARRAY:
-        size += msize * sizeof(double) + 2 * sizeof(int);
+        size += SHM_ARRAY_HEADER_SIZE + msize * sizeof(double);
         break;
-
-    // All these add 2 ints: one for length and one for safety value.
-    // the additional third int is for alignment whwnwver this may be doubtful
     case STRINGSHMARRAY:
-        size += msize * 2 * sizeof(int) + 2 * sizeof(int);
+        size += SHM_ARRAY_HEADER_SIZE + msize * (sizeof(int) + sizeof(shmSizeType));
         break;
     case CHARSHMARRAY:
-        size += msize * sizeof(char) + 3 * sizeof(int);
+        size += SHM_ARRAY_HEADER_SIZE + msize * sizeof(char) + sizeof(int);
         break;
     case SHORTSHMARRAY:
-        size += msize * sizeof(short) + 3 * sizeof(int);
+        size += SHM_ARRAY_HEADER_SIZE + msize * sizeof(short) + sizeof(int);
         break;
     case LONGSHMARRAY:
-        size += msize * sizeof(long) + 3 * sizeof(int);
+        size += SHM_ARRAY_HEADER_SIZE + msize * sizeof(long) + sizeof(int);
         break;
     case INTSHMARRAY:
-        size += msize * sizeof(int) + 2 * sizeof(int);
+        size += SHM_ARRAY_HEADER_SIZE + msize * sizeof(int);
         break;
     case SHMPTRARRAY:
-        size += msize * 2 * sizeof(int) + 2 * sizeof(int);
+        size += SHM_ARRAY_HEADER_SIZE + msize * (sizeof(int) + sizeof(shmSizeType));
         break;
     default:
         print_comment(__LINE__, __FILE__, "unkown type %d for shm_alloc\ncannot provide memory\n", type);
@@ -762,7 +764,7 @@ coShmPtr *DataManagerProcess::shm_alloc(int type, shmSizeType msize)
         size += (SIZEOF_ALIGNMENT - alignRest);
 
     // size in 'ints'
-    int intSize = size / sizeof(int);
+    shmSizeType intSize = size / sizeof(int);
 
     // allocate memory
     chptr = shm->malloc(size);
@@ -778,12 +780,8 @@ coShmPtr *DataManagerProcess::shm_alloc(int type, shmSizeType msize)
     {
     // fill memory with NULL
     case SHMPTRARRAY:
-        iptr[1] = (int)msize;
-        unsigned int ui;
-        for (ui = 2; ui < (2 * msize) + 2; ui++)
-        {
-            iptr[ui] = 0;
-        }
+        *(ArrayLengthType *)((char *)iptr + SHM_ARRAY_LENGTH_OFFSET) = (ArrayLengthType)msize;
+        memset((char *)iptr + SHM_ARRAY_HEADER_SIZE, 0, msize * (sizeof(int) + sizeof(shmSizeType)));
         iptr[intSize - 1] = type;
         break;
 
@@ -794,18 +792,18 @@ coShmPtr *DataManagerProcess::shm_alloc(int type, shmSizeType msize)
     case SHORTSHMARRAY:
     case LONGSHMARRAY:
     case INTSHMARRAY:
-        iptr[1] = (int)msize;
+        *(ArrayLengthType *)((char *)iptr + SHM_ARRAY_LENGTH_OFFSET) = (ArrayLengthType)msize;
 #ifdef FILL_SHM
-        for (i = 2; i < intSize; i++)
-            iptr[i] = EMPTY_VALUE;
+        for (shmSizeType si = SHM_ARRAY_HEADER_SIZE / sizeof(int); si < intSize; si++)
+            iptr[si] = EMPTY_VALUE;
 #endif
         iptr[intSize - 1] = type;
         break;
     };
 #ifdef DEBUG
-    sprintf(tmpstr, "DataManagerProcess::shm_alloc size: %d of type %d", size, type);
+    sprintf(tmpstr, "DataManagerProcess::shm_alloc size: %llu of type %d", (unsigned long long)size, type);
     print_comment(__LINE__, __FILE__, tmpstr, 8);
-    sprintf(tmpstr, "at address %d, %d", chptr->get_shm_seq_no(), chptr->get_offset());
+    sprintf(tmpstr, "at address %d, %llu", chptr->get_shm_seq_no(), (unsigned long long)chptr->get_offset());
     print_comment(__LINE__, __FILE__, tmpstr, 8);
 #endif
 
@@ -820,7 +818,7 @@ coShmPtr *DataManagerProcess::shm_alloc(ShmMessage *shmmsg)
     return shm_alloc(dt, size);
 }
 
-int DataManagerProcess::add_object(const DataHandle& n, int otype, int no, int o, const Connection *conn)
+int DataManagerProcess::add_object(const DataHandle& n, int otype, int no, shmSizeType o, const Connection *conn)
 {
     coDoHeader *header;
     coShmArray *shmarr;
@@ -873,7 +871,9 @@ int DataManagerProcess::add_object(const DataHandle& n, int otype, int no, int o
     // environment
 
     //    if(get_object(n, conn) == NULL)
-    return objects->insert_node(oe);
+    int ret = objects->insert_node(oe);
+    mark_shared_octtree(n);
+    return ret;
 }
 
 void DataManagerProcess::init_object_id()
@@ -954,7 +954,7 @@ void DataManagerProcess::save_object_id()
     }
 }
 
-int DataManagerProcess::add_object(const DataHandle &n, int no, int o, const Connection *conn)
+int DataManagerProcess::add_object(const DataHandle &n, int no, shmSizeType o, const Connection *conn)
 {
     coDoHeader *header;
     coShmArray *shmarr;
@@ -1009,7 +1009,11 @@ int DataManagerProcess::add_object(const DataHandle &n, int no, int o, const Con
     // environment
 
     if (get_object(n, conn) == NULL)
-        return objects->insert_node(oe);
+    {
+        int ret = objects->insert_node(oe);
+        mark_shared_octtree(n);
+        return ret;
+    }
     else
         return 0;
 }
@@ -1160,9 +1164,12 @@ int DataManagerProcess::destroy_object(const DataHandle& n, const Connection* c)
                 print_comment(__LINE__, __FILE__, "object removal failed", 4);
             }
 #endif
+            bool sharedOctTree = oe->shared_octtree;
             shm_free(oe->shm_seq_no, oe->offset);
             delete oe;
             delete tmpoe;
+            if (sharedOctTree)
+                destroy_shared_octtree(n);
             return 1;
         }
         else
@@ -1212,25 +1219,50 @@ int DataManagerProcess::destroy_object(const DataHandle& n, const Connection* c)
             print_comment(__LINE__, __FILE__, "object removal failed", 4);
         }
 #endif
+        bool sharedOctTree = oe->shared_octtree;
         shm_free(oe->shm_seq_no, oe->offset);
         delete oe;
         delete tmpoe;
+        if (sharedOctTree)
+            destroy_shared_octtree(n);
         return 1;
     }
 }
 
+// oct-trees shared between modules are not owned by any of them,
+// they live as long as their grid: only grids marked here look for one
+void DataManagerProcess::mark_shared_octtree(const DataHandle &n)
+{
+    std::string gridName = coDoOctTree::sharedGridName(n.data());
+    if (gridName.empty())
+        return;
+    DataHandle grid(gridName.length() + 1);
+    memcpy(grid.accessData(), gridName.c_str(), gridName.length() + 1);
+    if (ObjectEntry *oe = get_local_object(grid))
+        oe->shared_octtree = true;
+}
+
+void DataManagerProcess::destroy_shared_octtree(const DataHandle &n)
+{
+    std::string treeName = coDoOctTree::sharedName(n.data());
+    DataHandle tree(treeName.length() + 1);
+    memcpy(tree.accessData(), treeName.c_str(), treeName.length() + 1);
+    destroy_object(tree, nullptr);
+}
+
 int DataManagerProcess::shm_free(coShmPtr *ptr)
 {
     return shm_free(ptr->get_shm_seq_no(), ptr->get_offset());
 }
 
-int DataManagerProcess::shm_free(int shm_seq_no, int offset)
+int DataManagerProcess::shm_free(int shm_seq_no, shmSizeType offset)
 {
     int *objptr, incr;
-    coCharShmArray *chshmarr;
     char *shmptr = NULL, *obj_name = NULL;
     char tmp_str[255];
-    int type, count, i, no;
+    int type;
+    ArrayLengthType i, no;
+    shmSizeType count;
 
     if (shm_seq_no == 0)
         return 1;
@@ -1269,7 +1301,7 @@ int DataManagerProcess::shm_free(int shm_seq_no, int offset)
 #ifdef DEBUG
         print_comment(__LINE__, __FILE__, "ptr free in shm_free");
 #endif
-        if (shm_free(objptr[1], objptr[2]))
+        if (shm_free(objptr[1], *(shmSizeType *)(&objptr[2])))
         {
             shm->free(shm_seq_no, offset);
             return 1;
@@ -1280,43 +1312,41 @@ int DataManagerProcess::shm_free(int shm_seq_no, int offset)
             return 0;
         }
     case STRINGSHMARRAY:
-        no = objptr[1];
+        no = *(ArrayLengthType *)((char *)objptr + SHM_ARRAY_LENGTH_OFFSET);
+        objptr += SHM_ARRAY_HEADER_SIZE / sizeof(int);
         for (i = 0; i < no; i++)
-            if (objptr[2 + 2 * i] != 0)
-                shm_free(objptr[2 + 2 * i], objptr[2 + 2 * i + 1]);
+            if (objptr[SHM_PTR_INT_SIZE * i] != 0)
+                shm_free(objptr[SHM_PTR_INT_SIZE * i], *(shmSizeType *)(&objptr[SHM_PTR_INT_SIZE * i + 1]));
         shm->free(shm_seq_no, offset);
         return 1;
     case SHMPTRARRAY:
-        no = objptr[1];
+        no = *(ArrayLengthType *)((char *)objptr + SHM_ARRAY_LENGTH_OFFSET);
+        objptr += SHM_ARRAY_HEADER_SIZE / sizeof(int);
         for (i = 0; i < no; i++)
-            shm_free(objptr[2 + 2 * i], objptr[2 + 2 * i + 1]);
+            shm_free(objptr[SHM_PTR_INT_SIZE * i], *(shmSizeType *)(&objptr[SHM_PTR_INT_SIZE * i + 1]));
         shm->free(shm_seq_no, offset);
         return 1;
     }
     // here we have a pointer to a non basic data type:
-    objptr[10]--; // decrease reference counter
-    if (objptr[10] != 0) // if object is referenced by other objects
+    coDoHeader *header = (coDoHeader *)objptr;
+    if (header->decRefCount() != 0) // if object is referenced by other objects
         return 1; // then we are finished
 
-    int length = objptr[1]; // length in char
-    if (objptr[11] == SHMPTR) // get the name of this object
-    {
-        chshmarr = new coCharShmArray(objptr[12], objptr[13]);
-        obj_name = (char *)chshmarr->getDataPtr();
-        delete chshmarr;
+    shmSizeType length = *(ArrayLengthType *)((char *)objptr + SHM_ARRAY_LENGTH_OFFSET); // length in char
+    obj_name = (char *)header->getName(); // get the name of this object
 #ifdef DEBUG
+    if (obj_name)
         print_comment(__LINE__, __FILE__, "now freeing object %s", obj_name);
 #endif
-    }
-    objptr += 2; // jump over type and length
+    objptr += SHM_ARRAY_HEADER_SIZE / sizeof(int); // jump over type and length
 // now we process all types that are stored here together
 #ifdef DEBUG
     print_comment(__LINE__, __FILE__, "go through non simple type in shm_free", 4);
 #endif
-    for (count = 2 * sizeof(int); count < length;)
+    for (count = SHM_ARRAY_HEADER_SIZE; count < length;)
     {
 #ifdef DEBUG
-        sprintf(tmp_str, "count < length: %d < %d", count, length);
+        sprintf(tmp_str, "count < length: %llu < %llu", (unsigned long long)count, (unsigned long long)length);
         print_comment(__LINE__, __FILE__, tmp_str, 4);
 #endif
         switch (*objptr)
@@ -1348,6 +1378,9 @@ int DataManagerProcess::shm_free(int shm_seq_no, int offset)
             count += incr * sizeof(int);
             break;
         case COVISE_NULLPTR:
+            objptr += 1 + SHM_PTR_INT_SIZE;
+            count += (1 + SHM_PTR_INT_SIZE) * sizeof(int);
+            break;
         case COVISE_OBJECTID:
             objptr += 3;
             count += 3 * sizeof(int);
@@ -1362,10 +1395,10 @@ int DataManagerProcess::shm_free(int shm_seq_no, int offset)
 #ifdef DEBUG
             print_comment(__LINE__, __FILE__, "ptr part of shm_free");
 #endif
-            if (shm_free(objptr[1], objptr[2]))
+            if (shm_free(objptr[1], *(shmSizeType *)(&objptr[2])))
             {
-                objptr += 3;
-                count += 3 * sizeof(int);
+                objptr += 1 + SHM_PTR_INT_SIZE;
+                count += (1 + SHM_PTR_INT_SIZE) * sizeof(int);
             }
             else
             {
@@ -1545,6 +1578,7 @@ ObjectEntry *DataManagerProcess::get_object(const DataHandle &n)
 #ifdef DEBUG
 //	print_comment(__LINE__, __FILE__, "oe == NULL",4);
 #endif
+        coTraceScope trace("object transfer", "dmgr");
         data_mgrs->reset();
         int found = 0;
         while (!found && (dme = data_mgrs->next()))
@@ -1722,14 +1756,15 @@ ObjectEntry::ObjectEntry(const DataHandle& n)
 {
     //    printf("ObjectEntry new   : %x\n", this);
     name = n;
-    shm_seq_no = offset = -1;
+    shm_seq_no = -1;
+    offset = 0;
     version = 1;
     dmgr = NULL;
     type = 0;
     access = new List<AccessEntry>;
 }
 
-ObjectEntry::ObjectEntry(const DataHandle &n, int otype, int no, int o, const Connection *conn, DMEntry *dm)
+ObjectEntry::ObjectEntry(const DataHandle &n, int otype, int no, shmSizeType o, const Connection *conn, DMEntry *dm)
 {
     coShmPtr *tmpptr;
 
@@ -1747,7 +1782,7 @@ ObjectEntry::ObjectEntry(const DataHandle &n, int otype, int no, int o, const Co
     add_access(owner, ACC_READ_WRITE_DESTROY, ACC_READ_AND_WRITE);
 }
 
-ObjectEntry::ObjectEntry(const DataHandle& n, int no, int o, const Connection *conn, DMEntry *dm)
+ObjectEntry::ObjectEntry(const DataHandle& n, int no, shmSizeType o, const Connection *conn, DMEntry *dm)
 {
     coShmPtr *tmpptr;
 
@@ -1780,19 +1815,19 @@ ObjectEntry::~ObjectEntry()
 void ObjectEntry::print()
 {
     coShmArray *tmparr;
-    int *tmpiptr;
+    coDoHeader *header;
     char tmp_str[255];
     char *tmpname;
 
-    if (shm_seq_no == -1 && offset == -1)
+    if (shm_seq_no == -1)
         return;
     tmparr = new coShmArray(shm_seq_no, offset);
-    tmpiptr = (int *)tmparr->getPtr();
-    tmpname = coDistributedObject::calcTypeString(tmpiptr[0]);
+    header = (coDoHeader *)tmparr->getPtr();
+    tmpname = coDistributedObject::calcTypeString(header->getObjectType());
 
-    sprintf(tmp_str, "(%d, %8d) %s of type %s", shm_seq_no, offset, name.data(), tmpname);
+    sprintf(tmp_str, "(%d, %8llu) %s of type %s", shm_seq_no, (unsigned long long)offset, name.data(), tmpname);
     print_comment(__LINE__, __FILE__, tmp_str, 4);
-    sprintf(tmp_str, "Length: %d, Version: %d, Refcount: %d", tmpiptr[6], tmpiptr[8], tmpiptr[10]);
+    sprintf(tmp_str, "Length: %d, Version: %d, Refcount: %d", (int)header->get_number_of_elements(), header->get_version(), header->get_refcount());
     print_comment(__LINE__, __FILE__, tmp_str, 4);
 
     //    cerr << " (" << shm_seq_no << "," << setw(4)
@@ -1911,7 +1946,7 @@ extern char *covise_encode_list(List<PackElement> *pack_list, int size, char con
 extern void covise_create_list(List<PackElement> *pack_list, coShmAlloc *shm,
                                int shm_seq_no, int offset, int *size, char convert);
 
-void ObjectEntry::pack_and_send_object(Message *msg, DataManagerProcess *)
+bool ObjectEntry::pack_and_send_object(Message *msg, DataManagerProcess *)
 {
     //    cerr << "in pack_object for " << name << endl;
     //    List<PackElement> *pack_list = new List<PackElement>;
@@ -1922,7 +1957,13 @@ void ObjectEntry::pack_and_send_object(Message *msg, DataManagerProcess *)
 
     pack_object = new Packer(msg, shm_seq_no, offset);
 
-    pack_object->pack();
+    if (!pack_object->pack())
+    {
+        print_error(__LINE__, __FILE__, "sending object %s failed, transfer aborted", name.data());
+        delete pack_object;
+        msg->data = DataHandle();
+        return false;
+    }
 
     pack_object->flush();
 
@@ -1951,19 +1992,20 @@ void ObjectEntry::pack_and_send_object(Message *msg, DataManagerProcess *)
     msg->type = COVISE_MESSAGE_OBJECT_FOLLOWS;
     msg->data.setLength(size);
     //    delete pack_list;
+    return true;
 }
 
 void ObjectEntry::pack_address(Message *msg)
 {
     //    cerr << "in pack_address for " << name->data() << endl;
-    int *ia;
+    char *ca;
 
     // this is a local message, so no conversion is necessary
-    ia = new int[2];
+    ca = new char[sizeof(int) + sizeof(shmSizeType)];
 
-    ia[0] = shm_seq_no;
-    ia[1] = offset;
-    msg->data = DataHandle((char *)ia, 2 * sizeof(int));
+    *(int *)ca = shm_seq_no;
+    *(shmSizeType *)(&ca[sizeof(int)]) = offset;
+    msg->data = DataHandle(ca, int(sizeof(int) + sizeof(shmSizeType)));
     msg->type = COVISE_MESSAGE_OBJECT_FOUND;
 }
 
@@ -9,6 +9,10 @@
 #define AVL_EXTERN extern
 #include "dmgr_mem_avltrees.h"
 #undef AVL_EXTERN
+#include <util/coTrace.h>
+
+#include <algorithm>
+#include <vector>
 
 #ifdef shm_ptr
 #undef shm_ptr
@@ -29,6 +33,8 @@ coShmAlloc::coShmAlloc(int *key, DataManagerProcess *d)
     free_list->insert_chunk(mnode);
     free_size_list = new SizeOrderedTree();
     free_size_list->insert_chunk(mnode);
+    bins = new SizeClassBins();
+    stats.segment_bytes = ShmConfig::getMallocSize();
 #ifdef DEBUG
     print();
 #endif
@@ -36,13 +42,8 @@ coShmAlloc::coShmAlloc(int *key, DataManagerProcess *d)
 
 coShmPtr *coShmAlloc::malloc(shmSizeType size)
 {
-    int *msg_data = new int[2];
-    int tmp_key = 0;
-    shmSizeType new_size;
-    SharedMemory *new_shm;
-    MemChunk *mnode;
+    coTraceScope trace("shm alloc", "dmgr");
     MemChunk *new_used_node;
-    Message *msg;
 
     if (size % SIZEOF_ALIGNMENT != 0)
         size += (SIZEOF_ALIGNMENT - (size % SIZEOF_ALIGNMENT));
@@ -50,7 +51,44 @@ coShmPtr *coShmAlloc::malloc(shmSizeType size)
     sprintf(tmp_str, "malloc size: %d", size);
     print_comment(__LINE__, __FILE__, tmp_str);
 #endif
+    if (size <= SLAB_MAX_SIZE)
+    {
+        new_used_node = bin_malloc(size);
+    }
+    else
+    {
+        new_used_node = tree_malloc(size);
+        stats.tree_allocs++;
+    }
+    stats.used_bytes += new_used_node->get_plain_size();
+    used_list->insert_chunk(new_used_node);
+#ifdef DEBUG
+    print();
+    new_used_node->print();
+    new_used_node->getAddress()->print();
+#endif
+
+    return new_used_node->getAddress();
+}
+
+// best fit search in the free trees, creates a new segment if nothing fits
+MemChunk *coShmAlloc::tree_malloc(shmSizeType size)
+{
+    char *msg_data;
+    int tmp_key = 0;
+    shmSizeType new_size;
+    SharedMemory *new_shm;
+    MemChunk *mnode;
+    MemChunk *new_used_node;
+    Message *msg;
+
     MemChunk *free_node = free_size_list->get_chunk(size);
+    if (!free_node && stats.cached_bytes > 0)
+    {
+        // the bins might hold enough memory, try that before growing
+        flush_bins();
+        free_node = free_size_list->get_chunk(size);
+    }
     if (!free_node)
     {
         print_comment(__LINE__, __FILE__, "new SharedMemory");
@@ -69,9 +107,10 @@ coShmPtr *coShmAlloc::malloc(shmSizeType size)
             new_size = ShmConfig::getMallocSize();
         }
         new_shm = new SharedMemory(&tmp_key, new_size);
-        print_comment(__LINE__, __FILE__, "key: %d  size: %d", tmp_key, new_size);
+        print_comment(__LINE__, __FILE__, "key: %d  size: %llu", tmp_key, (unsigned long long)new_size);
         print_comment(__LINE__, __FILE__, "seq_no: %d  ptr: %llx", new_shm->get_seq_no(),
                       ( unsigned long long)new_shm->get_pointer());
+        stats.segment_bytes += new_size;
         mnode = new_memchunk(new_shm->get_seq_no(),
                              new_shm->get_pointer(), new_size);
 #ifdef DEBUG
@@ -80,9 +119,10 @@ coShmPtr *coShmAlloc::malloc(shmSizeType size)
 #endif
         free_list->insert_chunk(mnode);
         free_size_list->insert_chunk(mnode);
-        msg_data[0] = tmp_key;
-        msg_data[1] = new_size;
-        msg = new Message(COVISE_MESSAGE_NEW_SDS, DataHandle((char *)&msg_data[0], 2 * sizeof(int)));
+        msg_data = new char[sizeof(int) + sizeof(shmSizeType)];
+        *(int *)msg_data = tmp_key;
+        *(shmSizeType *)(&msg_data[sizeof(int)]) = new_size;
+        msg = new Message(COVISE_MESSAGE_NEW_SDS, DataHandle(msg_data, sizeof(int) + sizeof(shmSizeType)));
         print_comment(__LINE__, __FILE__, "dmgrproc->send_to_all_connections");
         dmgrproc->send_to_all_connections(msg);
         free_node = free_size_list->get_chunk(size);
@@ -98,29 +138,74 @@ coShmPtr *coShmAlloc::malloc(shmSizeType size)
     {
         new_used_node = free_node;
     }
-    used_list->insert_chunk(new_used_node);
-#ifdef DEBUG
-    print();
-    new_used_node->print();
-    new_used_node->getAddress()->print();
-#endif
+    return new_used_node;
+}
 
-    return new_used_node->getAddress();
+// serve size from its size class bin, refill the bin with a slab
+// of equally sized chunks carved out of one tree chunk if it is empty
+MemChunk *coShmAlloc::bin_malloc(shmSizeType size)
+{
+    int size_class = SizeClassBins::get_class(size);
+    shmSizeType class_size = SizeClassBins::get_class_size(size_class);
+    MemChunk *chunk = bins->get_chunk(size_class);
+
+    stats.requested_small += size;
+    stats.allocated_small += class_size;
+    if (chunk)
+    {
+        stats.bin_hits++;
+        stats.cached_bytes -= class_size;
+        return chunk;
+    }
+    stats.bin_misses++;
+
+    int no_of_chunks = int(SLAB_REFILL_SIZE / class_size);
+    if (no_of_chunks > SLAB_MAX_CHUNKS)
+        no_of_chunks = SLAB_MAX_CHUNKS;
+    if (no_of_chunks < 1)
+        no_of_chunks = 1;
+    MemChunk *slab = tree_malloc(class_size * no_of_chunks);
+    // the slab itself is handed out as the last chunk
+    for (int i = 0; i < no_of_chunks - 1; i++)
+    {
+        bins->add_chunk(size_class, slab->split(class_size));
+        stats.cached_bytes += class_size;
+    }
+    return slab;
 }
 
 void coShmAlloc::free(int shm_seq_no, shmSizeType offset)
 {
     char *tmpptr = (char *)shm->get_pointer(shm_seq_no);
     char *shm_ptr = tmpptr + offset;
-    MemChunk *next_chunk, *used_node, s_node;
-    static int garbage_count = 0;
+    MemChunk *used_node, s_node;
 
     s_node.set(shm_seq_no, shm_ptr, 0);
     used_node = used_list->remove_chunk(&s_node);
     if (used_node == 0L)
         return;
 
-    s_node.set(shm_seq_no, (char *)(shm_ptr + used_node->get_plain_size()), 0);
+    shmSizeType size = used_node->get_plain_size();
+    stats.used_bytes -= size;
+    if (size <= SLAB_MAX_SIZE)
+    {
+        // chunks of this size are always handed out by bin_malloc
+        bins->add_chunk(SizeClassBins::get_class(size), used_node);
+        stats.cached_bytes += size;
+    }
+    else
+    {
+        tree_free(used_node);
+    }
+}
+
+// return a chunk to the free trees, merging it with its successor
+void coShmAlloc::tree_free(MemChunk *used_node)
+{
+    MemChunk *next_chunk, s_node;
+    static int garbage_count = 0;
+
+    s_node.set(used_node->get_seq_no(), (char *)(used_node->get_plain_address() + used_node->get_plain_size()), 0);
     next_chunk = free_list->remove_chunk(&s_node);
     if (next_chunk)
     {
@@ -137,6 +222,47 @@ void coShmAlloc::free(int shm_seq_no, shmSizeType offset)
     }
 }
 
+static bool higher_address(MemChunk *a, MemChunk *b)
+{
+    return a->get_plain_address() > b->get_plain_address();
+}
+
+// hand all cached chunks back to the trees
+void coShmAlloc::flush_bins()
+{
+    std::vector<MemChunk *> chunks;
+    for (int i = 0; i < NO_OF_SIZE_CLASSES; i++)
+    {
+        MemChunk *chunk = bins->remove_all(i);
+        while (chunk)
+        {
+            MemChunk *next = chunk->next;
+            chunk->next = 0L;
+            chunks.push_back(chunk);
+            chunk = next;
+        }
+    }
+    // tree_free only merges with the following chunk,
+    // so neighbours have to be returned from the top down
+    std::sort(chunks.begin(), chunks.end(), higher_address);
+    for (size_t i = 0; i < chunks.size(); i++)
+        tree_free(chunks[i]);
+    stats.cached_bytes = 0;
+    stats.bin_flushes++;
+}
+
+void coShmAlloc::print_statistics()
+{
+    unsigned long long small_allocs = stats.bin_hits + stats.bin_misses;
+    print_comment(__LINE__, __FILE__, "shm allocator: %llu small allocations, %.1f%% bin hit rate, %llu large allocations, %llu bin flushes",
+                  small_allocs, small_allocs ? 100. * stats.bin_hits / small_allocs : 0., stats.tree_allocs, stats.bin_flushes);
+    print_comment(__LINE__, __FILE__, "shm allocator: internal fragmentation of small allocations %.1f%%",
+                  stats.allocated_small ? 100. * (stats.allocated_small - stats.requested_small) / stats.allocated_small : 0.);
+    print_comment(__LINE__, __FILE__, "shm allocator: %llu bytes in segments, %llu used, %llu cached in bins, %llu free in trees",
+                  stats.segment_bytes, stats.used_bytes, stats.cached_bytes,
+                  stats.segment_bytes - stats.used_bytes - stats.cached_bytes);
+}
+
 //extern int covise_list_size;
 
 static int covise_list_size;
@@ -152,6 +278,7 @@ void coShmAlloc::print()
     covise_list_size = 0;
     //    used_list->print("used list");
     print_comment(__LINE__, __FILE__, "used list: %d bytes ======================", covise_list_size);
+    print_statistics();
 }
 
 void coShmAlloc::new_desk(void)
@@ -161,12 +288,27 @@ void coShmAlloc::new_desk(void)
     int seq_no;
     shmSizeType size;
 
+    print_statistics();
     if (used_list)
         used_list->empty_trees(1);
     if (free_list)
         free_list->empty_trees(0);
     if (free_size_list)
         free_size_list->empty_tree();
+    if (bins)
+    {
+        for (int i = 0; i < NO_OF_SIZE_CLASSES; i++)
+        {
+            MemChunk *chunk = bins->remove_all(i);
+            while (chunk)
+            {
+                MemChunk *next = chunk->next;
+                delete_memchunk(chunk);
+                chunk = next;
+            }
+        }
+    }
+    stats.segment_bytes = stats.used_bytes = stats.cached_bytes = 0;
     p_shm = get_shared_memory();
     while (p_shm)
     {
@@ -176,6 +318,7 @@ void coShmAlloc::new_desk(void)
             size = p_shm->get_size();
             size -= 2 * (sizeof(int));
             mnode = new_memchunk(seq_no, p_shm->get_pointer(seq_no), size);
+            stats.segment_bytes += size;
             free_list->insert_chunk(mnode);
             free_size_list->insert_chunk(mnode);
         }
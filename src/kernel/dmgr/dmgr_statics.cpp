@@ -12,4 +12,5 @@ using namespace covise;
 AddressOrderedTree *coShmAlloc::used_list = 0L;
 AddressOrderedTree *coShmAlloc::free_list = 0L;
 SizeOrderedTree *coShmAlloc::free_size_list = 0L;
+SizeClassBins *coShmAlloc::bins = 0L;
 int DataManagerProcess::max_t = 0;
@@ -207,7 +207,8 @@ coDistributedObject::~coDistributedObject()
 int coDistributedObject::getObjectInfo(coDoInfo **info_list) const
 {
     int *iptr, *tmpiptr;
-    int count, i, len;
+    ArrayLengthType count, i;
+    int len;
     char *tmpcptr;
     coShmArray *tmparray;
     coDoInfo *il;
@@ -279,7 +280,7 @@ int coDistributedObject::getObjectInfo(coDoInfo **info_list) const
         case COVISE_NULLPTR:
             il->type_name = "Nullpointer";
             il->ptr = nullptr;
-            shmarr_count += 2;
+            shmarr_count += SHM_PTR_INT_SIZE;
             break;
 
         case SHMPTR:
@@ -288,7 +289,7 @@ int coDistributedObject::getObjectInfo(coDoInfo **info_list) const
             tmpiptr = (int *)il->ptr;
             il->type = tmpiptr[0];
             delete tmparray;
-            shmarr_count += 1+(sizeof(shmSizeType)/sizeof(int));
+            shmarr_count += SHM_PTR_INT_SIZE;
             switch (il->type)
             {
             case CHARSHMARRAY:
@@ -329,9 +330,8 @@ int coDistributedObject::getObjectInfo(coDoInfo **info_list) const
         }
     }
 
-    count = getObjInfo(count, info_list);
-
-    return count;
+    // the number of data items of the object type, not the size of an array
+    return getObjInfo((int)count, info_list);
 }
 
 int coDistributedObject::destroy()
@@ -383,9 +383,11 @@ int coDistributedObject::access(access_type acc)
     *(int *)data = acc;
     sprintf(&data[sizeof(int)], "%s", name);
     Message msg(COVISE_MESSAGE_SET_ACCESS, DataHandle(data, length));
+    std::unique_lock<std::recursive_mutex> guard(ApplicationProcess::approc->data_msg_mutex());
     ApplicationProcess::approc->send_data_msg(&msg);
     msg.data = DataHandle();
     ApplicationProcess::approc->recv_data_msg(&msg);
+    guard.unlock();
     if (acc == (ACC_READ_AND_WRITE | ACC_WRITE_ONLY))
     {
         if (msg.type == COVISE_MESSAGE_MSG_OK)
@@ -489,7 +491,7 @@ int *coDistributedObject::store_header(int size, int no_of_allocs, int count,
     if (header->getObjectType() == type_no) // object existed already
     {
         object_exists = 1;
-        free_list = new int[count * 2];
+        free_list = new int[count * SHM_PTR_INT_SIZE];
         current_free = 0;
         loc_version = header->get_version(); //get new version number, set by datamanager
         header->incRefCount(); // must be increased, since we are attaching
@@ -514,8 +516,8 @@ int *coDistributedObject::store_header(int size, int no_of_allocs, int count,
         refcount.setPtr(shmarr->shm_seq_no,
                         shmarr->offset + header->get_refcount_offset());
 
-        header->set_name((idataArray)[(no_of_allocs - 1) * 2],
-                         *(shmSizeType *)(&(idataArray)[(no_of_allocs - 1) * 2 + 1]), name);
+        header->set_name((idataArray)[(no_of_allocs - 1) * SHM_PTR_INT_SIZE],
+                         *(shmSizeType *)(&(idataArray)[(no_of_allocs - 1) * SHM_PTR_INT_SIZE + 1]), name);
         header->addAttributes(0, 0);
     }
     *shmarr_count = header->getIntHeaderSize();
@@ -718,18 +720,18 @@ int coDistributedObject::store_shared_dl(int count, covise_data_list *dl)
         case SHMPTRARRAY:
             if (object_exists)
             {
-                free_list[current_free++] = iptr[shmarr_count];
-                free_list[current_free++] = iptr[shmarr_count + 1];
+                for (int j = 0; j < SHM_PTR_INT_SIZE; j++)
+                    free_list[current_free++] = iptr[shmarr_count + j];
             }
             iptr[shmarr_count - 1] = SHMPTR;
-            iptr[shmarr_count++] = idataArray[2 + alloc_count * 2];
-            *(shmSizeType *)(&iptr[shmarr_count++]) = *(shmSizeType *)(&idataArray[2 + alloc_count * 2 + 1]);
+            iptr[shmarr_count++] = idataArray[(1 + alloc_count) * SHM_PTR_INT_SIZE];
+            *(shmSizeType *)(&iptr[shmarr_count++]) = *(shmSizeType *)(&idataArray[(1 + alloc_count) * SHM_PTR_INT_SIZE + 1]);
             if(sizeof(shmSizeType) > sizeof(int))
                 shmarr_count++;
 
             tmparray = (coShmArray *)dl[i].ptr;
-            tmparray->setPtr(idataArray[2 + alloc_count * 2],
-                             *(shmSizeType *)(&idataArray[2 + alloc_count * 2 + 1]));
+            tmparray->setPtr(idataArray[(1 + alloc_count) * SHM_PTR_INT_SIZE],
+                             *(shmSizeType *)(&idataArray[(1 + alloc_count) * SHM_PTR_INT_SIZE + 1]));
             alloc_count++;
             break;
 
@@ -758,7 +760,7 @@ int coDistributedObject::store_shared_dl(int count, covise_data_list *dl)
 #ifdef INSURE
     _Insight_set_option("runtime", "on");
 #endif
-    // current_free = number of entries in free_list ( = 2 * number of elements to free)
+    // current_free = number of ints in free_list ( = SHM_PTR_INT_SIZE * number of elements to free)
 
     if (current_free)
     {
@@ -890,10 +892,10 @@ int coDistributedObject::restore_header(int **iptr, int count, int *shmarr_count
 //    header->print();
 #endif
 
-    if (header->get_number_of_elements() != count)
+    if (header->get_number_of_elements() != (ArrayLengthType)count)
     {
         print_comment(__LINE__, __FILE__, "number of elements to read <> count");
-        print_comment(__LINE__, __FILE__, "%d instead of %d", header->get_number_of_elements(), count);
+        print_comment(__LINE__, __FILE__, "%llu instead of %d", (unsigned long long)header->get_number_of_elements(), count);
         return 0;
     }
 
@@ -1023,7 +1025,7 @@ int coDistributedObject::restore_shared_dl(int count, covise_data_list *dl)
                 {
                     // this is an empty array, data not yet available
                     *(void **)dl[i].ptr = nullptr;
-                    shmarr_count += 2;
+                    shmarr_count += SHM_PTR_INT_SIZE;
                 }
                 else
                 {
@@ -1031,35 +1033,35 @@ int coDistributedObject::restore_shared_dl(int count, covise_data_list *dl)
                     {
                     case CHARSHMARRAY:
                         ((coCharShmArray *)dl[i].ptr)->setPtr(iptr[shmarr_count], *(shmSizeType *)(&iptr[shmarr_count + 1]));
-                        shmarr_count += 1+(sizeof(shmSizeType)/sizeof(int));
+                        shmarr_count += SHM_PTR_INT_SIZE;
                         break;
                     case SHORTSHMARRAY:
                         ((coShortShmArray *)dl[i].ptr)->setPtr(iptr[shmarr_count], *(shmSizeType *)(&iptr[shmarr_count + 1]));
-                        shmarr_count += 1+(sizeof(shmSizeType)/sizeof(int));
+                        shmarr_count += SHM_PTR_INT_SIZE;
                         break;
                     case INTSHMARRAY:
                         ((coIntShmArray *)dl[i].ptr)->setPtr(iptr[shmarr_count], *(shmSizeType *)(&iptr[shmarr_count + 1]));
-                        shmarr_count += 1+(sizeof(shmSizeType)/sizeof(int));
+                        shmarr_count += SHM_PTR_INT_SIZE;
                         break;
                     case LONGSHMARRAY:
                         ((coLongShmArray *)dl[i].ptr)->setPtr(iptr[shmarr_count], *(shmSizeType *)(&iptr[shmarr_count + 1]));
-                        shmarr_count += 1+(sizeof(shmSizeType)/sizeof(int));
+                        shmarr_count += SHM_PTR_INT_SIZE;
                         break;
                     case FLOATSHMARRAY:
                         ((coFloatShmArray *)dl[i].ptr)->setPtr(iptr[shmarr_count], *(shmSizeType *)(&iptr[shmarr_count + 1]));
-                        shmarr_count += 1+(sizeof(shmSizeType)/sizeof(int));
+                        shmarr_count += SHM_PTR_INT_SIZE;
                         break;
                     case DOUBLESHMARRAY:
                         ((coDoubleShmArray *)dl[i].ptr)->setPtr(iptr[shmarr_count], *(shmSizeType *)(&iptr[shmarr_count + 1]));
-                        shmarr_count += 1+(sizeof(shmSizeType)/sizeof(int));
+                        shmarr_count += SHM_PTR_INT_SIZE;
                         break;
                     case STRINGSHMARRAY:
                         ((coStringShmArray *)dl[i].ptr)->setPtr(iptr[shmarr_count], *(shmSizeType *)(&iptr[shmarr_count + 1]));
-                        shmarr_count += 1+(sizeof(shmSizeType)/sizeof(int));
+                        shmarr_count += SHM_PTR_INT_SIZE;
                         break;
                     case SHMPTRARRAY:
                         ((coShmPtrArray *)dl[i].ptr)->setPtr(iptr[shmarr_count], *(shmSizeType *)(&iptr[shmarr_count + 1]));
-                        shmarr_count += 1+(sizeof(shmSizeType)/sizeof(int));
+                        shmarr_count += SHM_PTR_INT_SIZE;
                         break;
                     case DISTROBJ:
                         tmparray = new coShmArray(iptr[shmarr_count],
@@ -1071,7 +1073,7 @@ int coDistributedObject::restore_shared_dl(int count, covise_data_list *dl)
                             print_comment(__LINE__, __FILE__, "rebuildFromShm failed");
                             return 0;
                         }
-                        shmarr_count += 1+(sizeof(shmSizeType)/sizeof(int));
+                        shmarr_count += SHM_PTR_INT_SIZE;
                         break;
                     case UNKNOWN:
                     case COVISE_OPTIONAL:
@@ -1091,7 +1093,7 @@ int coDistributedObject::restore_shared_dl(int count, covise_data_list *dl)
                                 return 0;
                             }
                         }
-                        shmarr_count += 1+(sizeof(shmSizeType)/sizeof(int));
+                        shmarr_count += SHM_PTR_INT_SIZE;
                         break;
                     }
                 }
@@ -1609,19 +1611,19 @@ void coDoHeader::print()
 {
     print_comment(__LINE__, __FILE__, "--------------- Objectheader ------------");
     print_comment(__LINE__, __FILE__, "object_type:                      %d", object_type);
-    print_comment(__LINE__, __FILE__, "number_of_bytes:                  %d", number_of_bytes);
+    print_comment(__LINE__, __FILE__, "number_of_bytes:                  %llu", (unsigned long long)number_of_bytes);
     print_comment(__LINE__, __FILE__, "number_of_elements_type:          %d", number_of_elements_type);
-    print_comment(__LINE__, __FILE__, "number_of_elements:               %d", number_of_elements);
+    print_comment(__LINE__, __FILE__, "number_of_elements:               %llu", (unsigned long long)number_of_elements);
     print_comment(__LINE__, __FILE__, "version_type:                     %d", version_type);
     print_comment(__LINE__, __FILE__, "version:                          %d", version);
     print_comment(__LINE__, __FILE__, "refcount_type:                    %d", refcount_type);
     print_comment(__LINE__, __FILE__, "refcount:                         %d", refcount);
     print_comment(__LINE__, __FILE__, "name_type:                        %d", name_type);
     print_comment(__LINE__, __FILE__, "name_shm_seq_no:                  %d", name_shm_seq_no);
-    print_comment(__LINE__, __FILE__, "name_offset:                      %d", name_offset);
+    print_comment(__LINE__, __FILE__, "name_offset:                      %llu", (unsigned long long)name_offset);
     print_comment(__LINE__, __FILE__, "attr_type:                        %d", attr_type);
     print_comment(__LINE__, __FILE__, "attr_shm_seq_no:                  %d", attr_shm_seq_no);
-    print_comment(__LINE__, __FILE__, "attr_offset:                      %d", attr_offset);
+    print_comment(__LINE__, __FILE__, "attr_offset:                      %llu", (unsigned long long)attr_offset);
     print_comment(__LINE__, __FILE__, "-----------------------------------------");
 }
 
@@ -1762,7 +1764,7 @@ bool coDistributedObject::checkObj(int shmSeg, shmSizeType shmOffs, bool &printe
         //delete [] tName;
 
         // minimal check
-        if (iPtr[2] != COVISE_OBJECTID)
+        if (iPtr[SHM_ARRAY_HEADER_SIZE / sizeof(int)] != COVISE_OBJECTID)
         {
             //cerr << "Found no header for Obj: \"" << name << "\"" << endl;
             return false;
@@ -1770,16 +1772,19 @@ bool coDistributedObject::checkObj(int shmSeg, shmSizeType shmOffs, bool &printe
 
         /// Check DO Header
         coDoHeader *hdr = (coDoHeader *)iPtr;
-        int numObj = hdr->get_number_of_elements();
-        if (numObj <= 0)
+        // the number of data items of the object type: a corrupt header
+        // may hold any value, so check the full value before using it
+        ArrayLengthType numItems = hdr->get_number_of_elements();
+        if (numItems == 0 || numItems > (ArrayLengthType)INT_MAX)
         {
             //cerr << "Problems found checking header of Obj: \"" << name << "\"" << endl;
             return false;
         }
+        int numObj = (int)numItems;
 
         int i;
         // check name and attributes
-        iPtr += coDoHeader::getIntHeaderSize() - 6;
+        iPtr += coDoHeader::getIntHeaderSize() - 2 * (1 + SHM_PTR_INT_SIZE);
         for (i = 0; i < numObj + 2; i++)
         {
 
@@ -1840,12 +1845,12 @@ bool coDistributedObject::checkObj(int shmSeg, shmSizeType shmOffs, bool &printe
                         return false;
                     }
                 }
-                iPtr += 2 + sizeof(shmSizeType)/sizeof(int);
+                iPtr += 1 + SHM_PTR_INT_SIZE;
                 break;
             }
             case COVISE_NULLPTR:
             {
-                iPtr += 2 + sizeof(shmSizeType)/sizeof(int);
+                iPtr += 1 + SHM_PTR_INT_SIZE;
                 break;
             }
             default:
@@ -1864,7 +1869,7 @@ bool coDistributedObject::checkObj(int shmSeg, shmSizeType shmOffs, bool &printe
 
     if (type > 12 && type < 20)
     {
-        int msize = iPtr[1];
+        ArrayLengthType msize = *(ArrayLengthType *)((char *)iPtr + SHM_ARRAY_LENGTH_OFFSET);
 
         // Arrays are built :  | type | length | data | ... | data | type /
         // <type> at end is always int-aligned
@@ -1895,32 +1900,32 @@ bool coDistributedObject::checkObj(int shmSeg, shmSizeType shmOffs, bool &printe
         case INTSHM:
             size += sizeof(int);
             break;
+        // Arrays: type and length (SHM_ARRAY_HEADER_SIZE) followed by the data,
+        // the int already counted in size is the safety value at the end.
+        // the additional int is for alignment whenever this may be doubtful
         case FLOATSHMARRAY:
-            size += msize * sizeof(float) + 2 * sizeof(int);
+            size += SHM_ARRAY_HEADER_SIZE + msize * sizeof(float);
             break;
         case DOUBLESHMARRAY:
-            size += msize * sizeof(double) + 2 * sizeof(int);
+            size += SHM_ARRAY_HEADER_SIZE + msize * sizeof(double);
             break;
-
-        // All these add 2 ints: one for length and one for safety value.
-        // the additional third int is for alignment whwnwver this may be doubtful
         case STRINGSHMARRAY:
-            size += msize * 2 * sizeof(int) + 2 * sizeof(int);
+            size += SHM_ARRAY_HEADER_SIZE + msize * (sizeof(int) + sizeof(shmSizeType));
             break;
         case CHARSHMARRAY:
-            size += msize * sizeof(char) + 3 * sizeof(int);
+            size += SHM_ARRAY_HEADER_SIZE + msize * sizeof(char) + sizeof(int);
             break;
         case SHORTSHMARRAY:
-            size += msize * sizeof(short) + 3 * sizeof(int);
+            size += SHM_ARRAY_HEADER_SIZE + msize * sizeof(short) + sizeof(int);
             break;
         case LONGSHMARRAY:
-            size += msize * sizeof(long) + 3 * sizeof(int);
+            size += SHM_ARRAY_HEADER_SIZE + msize * sizeof(long) + sizeof(int);
             break;
         case INTSHMARRAY:
-            size += msize * sizeof(int) + 2 * sizeof(int);
+            size += SHM_ARRAY_HEADER_SIZE + msize * sizeof(int);
             break;
         case SHMPTRARRAY:
-            size += msize * 2 * sizeof(int) + 2 * sizeof(int);
+            size += SHM_ARRAY_HEADER_SIZE + msize * (sizeof(int) + sizeof(shmSizeType));
             break;
         default:
             print_comment(__LINE__, __FILE__, "unknown type %d for shm_alloc\ncannot provide memory\n", type);
@@ -1933,7 +1938,7 @@ bool coDistributedObject::checkObj(int shmSeg, shmSizeType shmOffs, bool &printe
             size += (SIZEOF_ALIGNMENT - alignRest);
 
         // size in 'ints'
-        int intSize = size / sizeof(int);
+        shmSizeType intSize = size / sizeof(int);
 
         // the protection-word test for our array
         if (iPtr[intSize - 1] != type)
@@ -1947,11 +1952,12 @@ bool coDistributedObject::checkObj(int shmSeg, shmSizeType shmOffs, bool &printe
         // recurse over SHM-Arrays
         if (type == SHMPTRARRAY)
         {
-            for (int i = 0; i < msize; i++)
+            iPtr += SHM_ARRAY_HEADER_SIZE / sizeof(int);
+            for (ArrayLengthType i = 0; i < msize; i++)
             {
-                iPtr += 1 + sizeof(shmSizeType)/sizeof(int);
                 if (iPtr[0] && !checkObj(iPtr[0], *(shmSizeType *)(&iPtr[1]), printed))
                     return false;
+                iPtr += SHM_PTR_INT_SIZE;
             }
         }
     }
@@ -8,6 +8,7 @@
 #ifndef CO_DISTRIBUTED_OBJECT_H
 #define CO_DISTRIBUTED_OBJECT_H
 
+#include <cstddef>
 #include <util/covise_list.h>
 #include <util/coObjID.h>
 #include "coShmPtrArray.h"
@@ -93,8 +94,9 @@ struct covise_data_list
     const void *ptr;
 };
 
-const int NUMBER_OF_INT_HEADER_ELEMENTS = 13;
-const int NUMBER_OF_SHM_SIZE_HEADER_ELEMENTS = 4;
+// the header overlays a CHARSHMARRAY, so number_of_bytes has to sit
+// exactly where coShmArray expects the array length
+#pragma pack(push, 4)
 
 class DOEXPORT coDoHeader
 {
@@ -106,12 +108,15 @@ class DOEXPORT coDoHeader
 
 private:
     int object_type;
+#ifdef COVISE_SHM_64BIT
+    int object_type_padding;
+#endif
     shmSizeType number_of_bytes;
     int objectid_type;
     int objectid_h;
     int objectid_t;
-    int number_of_elements_type; // INTSHM
-    int number_of_elements;
+    int number_of_elements_type; // ARRAYLENGTHSHM
+    ArrayLengthType number_of_elements;
     int version_type; // INTSHM
     int version;
     int refcount_type; // INTSHM
@@ -141,17 +146,18 @@ public:
 
     static int getIntHeaderSize()
     {
-        return NUMBER_OF_INT_HEADER_ELEMENTS + (NUMBER_OF_SHM_SIZE_HEADER_ELEMENTS * sizeof(shmSizeType)/sizeof(int));
-    }; // size must be adjusted manually!!
+        // the part_* elements are only allocated for partitioned objects
+        return (int)(offsetof(coDoHeader, part_object_type_type) / sizeof(int));
+    };
 
     int getObjectType()
     {
         return object_type;
     };
 
-    int get_number_of_elements()
+    ArrayLengthType get_number_of_elements()
     {
-        if (number_of_elements_type == INTSHM)
+        if (number_of_elements_type == ARRAYLENGTHSHM)
             return number_of_elements;
         else
         {
@@ -235,9 +241,9 @@ public:
         objectid_h = h;
         objectid_t = t;
     };
-    void set_number_of_elements(int noe)
+    void set_number_of_elements(ArrayLengthType noe)
     {
-        number_of_elements_type = INTSHM;
+        number_of_elements_type = ARRAYLENGTHSHM;
         number_of_elements = noe;
     };
     void set_version(int v)
@@ -262,6 +268,7 @@ public:
     };
     void print();
 };
+#pragma pack(pop)
 
 class DOEXPORT coDoInfo
 {
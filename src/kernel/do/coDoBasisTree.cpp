@@ -9,6 +9,7 @@
 #include <util/coVector.h>
 #include <vector>
 #include <cmath>
+#include <util/coThreadPool.h>
 using namespace covise;
 
 coDoBasisTree::coDoBasisTree(const coObjInfo &info, const char *label1, const char *label2,
@@ -138,11 +139,38 @@ coDoBasisTree::MakeOctTree(int *el,
     grid_bbox_[3] = -FLT_MAX;
     grid_bbox_[4] = -FLT_MAX;
     grid_bbox_[5] = -FLT_MAX;
-    for (i = 0, cell_bbox_ = cell_bboxes; i < nelem; ++i, cell_bbox_ += 6)
+    // for each element calculate its BBox in blocks of cells...
+    int no_blocks = numBlocks(nelem);
+    std::vector<float> block_bboxes(6 * no_blocks);
+    coThreadPool::global().run(no_blocks, [&](size_t block, int)
+                               {
+                                   float *block_bbox = &block_bboxes[6 * block];
+                                   block_bbox[0] = block_bbox[1] = block_bbox[2] = FLT_MAX;
+                                   block_bbox[3] = block_bbox[4] = block_bbox[5] = -FLT_MAX;
+                                   int end = blockBegin(block + 1, no_blocks, nelem);
+                                   for (int cell = blockBegin(block, no_blocks, nelem); cell < end; ++cell)
+                                   {
+                                       float *cell_bbox = cell_bboxes + 6 * cell;
+                                       CellBBox(cell, cell_bbox);
+                                       for (int k = 0; k < 3; ++k)
+                                       {
+                                           if (block_bbox[k] > cell_bbox[k])
+                                               block_bbox[k] = cell_bbox[k];
+                                           if (block_bbox[k + 3] < cell_bbox[k + 3])
+                                               block_bbox[k + 3] = cell_bbox[k + 3];
+                                       }
+                                   }
+                               });
+    // ...and modify the grid BBox if necessary
+    for (i = 0; i < no_blocks; ++i)
     {
-        // for each element calculate its BBox...
-        // ...and modify the grid BBox if necessary
-        BBoxForElement(i);
+        for (int k = 0; k < 3; ++k)
+        {
+            if (grid_bbox_[k] > block_bboxes[6 * i + k])
+                grid_bbox_[k] = block_bboxes[6 * i + k];
+            if (grid_bbox_[k + 3] < block_bboxes[6 * i + k + 3])
+                grid_bbox_[k + 3] = block_bboxes[6 * i + k + 3];
+        }
     }
     // check grid_bbox_ to prevent division by 0
     float dimX = grid_bbox_[3] - grid_bbox_[0];
@@ -211,17 +239,37 @@ coDoBasisTree::MakeOctTree(int *el,
 // assume cell_bbox_ points to the correct place for the i-th element
 void
 coDoBasisTree::BBoxForElement(int i)
+{
+    CellBBox(i, cell_bbox_);
+    // correct grid bbox
+    if (grid_bbox_[0] > cell_bbox_[0])
+        grid_bbox_[0] = cell_bbox_[0];
+    if (grid_bbox_[1] > cell_bbox_[1])
+        grid_bbox_[1] = cell_bbox_[1];
+    if (grid_bbox_[2] > cell_bbox_[2])
+        grid_bbox_[2] = cell_bbox_[2];
+    if (grid_bbox_[3] < cell_bbox_[3])
+        grid_bbox_[3] = cell_bbox_[3];
+    if (grid_bbox_[4] < cell_bbox_[4])
+        grid_bbox_[4] = cell_bbox_[4];
+    if (grid_bbox_[5] < cell_bbox_[5])
+        grid_bbox_[5] = cell_bbox_[5];
+}
+
+// bbox of the i-th element
+void
+coDoBasisTree::CellBBox(int i, float *cell_bbox) const
 {
     // load cell bbox with first vertex coordinates
     int first_vertex = el_[i]; //cell list
     int point = conn_[first_vertex]; //vertices array
     int numvert;
-    cell_bbox_[0] = x_c_[point];
-    cell_bbox_[1] = y_c_[point];
-    cell_bbox_[2] = z_c_[point];
-    cell_bbox_[3] = x_c_[point];
-    cell_bbox_[4] = y_c_[point];
-    cell_bbox_[5] = z_c_[point];
+    cell_bbox[0] = x_c_[point];
+    cell_bbox[1] = y_c_[point];
+    cell_bbox[2] = z_c_[point];
+    cell_bbox[3] = x_c_[point];
+    cell_bbox[4] = y_c_[point];
+    cell_bbox[5] = z_c_[point];
     // find out number of vertices for this element
     if (i < nelem - 1)
     {
@@ -235,54 +283,49 @@ coDoBasisTree::BBoxForElement(int i)
     for (i = 1; i < numvert; ++i)
     {
         point = conn_[first_vertex + i];
-        if (cell_bbox_[0] > x_c_[point])
-            cell_bbox_[0] = x_c_[point];
-        if (cell_bbox_[1] > y_c_[point])
-            cell_bbox_[1] = y_c_[point];
-        if (cell_bbox_[2] > z_c_[point])
-            cell_bbox_[2] = z_c_[point];
-        if (cell_bbox_[3] < x_c_[point])
-            cell_bbox_[3] = x_c_[point];
-        if (cell_bbox_[4] < y_c_[point])
-            cell_bbox_[4] = y_c_[point];
-        if (cell_bbox_[5] < z_c_[point])
-            cell_bbox_[5] = z_c_[point];
+        if (cell_bbox[0] > x_c_[point])
+            cell_bbox[0] = x_c_[point];
+        if (cell_bbox[1] > y_c_[point])
+            cell_bbox[1] = y_c_[point];
+        if (cell_bbox[2] > z_c_[point])
+            cell_bbox[2] = z_c_[point];
+        if (cell_bbox[3] < x_c_[point])
+            cell_bbox[3] = x_c_[point];
+        if (cell_bbox[4] < y_c_[point])
+            cell_bbox[4] = y_c_[point];
+        if (cell_bbox[5] < z_c_[point])
+            cell_bbox[5] = z_c_[point];
     }
     // do not let the bounding box be too thin!!!
-    // correct grid bbox
-    if (grid_bbox_[0] > cell_bbox_[0])
-        grid_bbox_[0] = cell_bbox_[0];
-    if (grid_bbox_[1] > cell_bbox_[1])
-        grid_bbox_[1] = cell_bbox_[1];
-    if (grid_bbox_[2] > cell_bbox_[2])
-        grid_bbox_[2] = cell_bbox_[2];
-    if (grid_bbox_[3] < cell_bbox_[3])
-        grid_bbox_[3] = cell_bbox_[3];
-    if (grid_bbox_[4] < cell_bbox_[4])
-        grid_bbox_[4] = cell_bbox_[4];
-    if (grid_bbox_[5] < cell_bbox_[5])
-        grid_bbox_[5] = cell_bbox_[5];
+}
+
+// cells are processed in blocks, so that results may be merged in the
+// order in which a serial loop over the cells would produce them
+int
+coDoBasisTree::numBlocks(int nelem)
+{
+    int no_blocks = nelem / BLOCK_SIZE + 1;
+    int max_blocks = 4 * coThreadPool::global().numThreads();
+    return no_blocks < max_blocks ? no_blocks : max_blocks;
+}
+
+int
+coDoBasisTree::blockBegin(size_t block, int no_blocks, int nelem)
+{
+    return (int)((long long)nelem * (long long)block / no_blocks);
 }
 
 // share cell population between leaves and continue division
 void
 coDoBasisTree::ShareCellsBetweenLeaves()
 {
-    int position;
     int no_p_leaves = fX_ * fY_ * fZ_;
     populations_ = new std::vector<int>[no_p_leaves];
-    // we want to reserve space for these infinite arrays...
-    int ini_room_per_tree = nelem / (no_p_leaves * 4) + 1;
-    int octtreeInd;
-    for (octtreeInd = 0; octtreeInd < no_p_leaves; ++octtreeInd)
-    {
-        populations_[octtreeInd].reserve(ini_room_per_tree);
-    }
-    int cell;
     float i_x_grid_l = 1.0f / (grid_bbox_[3] - grid_bbox_[0]);
     float i_y_grid_l = 1.0f / (grid_bbox_[4] - grid_bbox_[1]);
     float i_z_grid_l = 1.0f / (grid_bbox_[5] - grid_bbox_[2]);
-    for (cell = 0; cell < nelem; ++cell)
+    // call f(position) for every initial oct-tree the bbox of cell touches
+    auto forLeaves = [&](int cell, const auto &f)
     {
         int key[6];
         int base = 6 * cell;
@@ -324,67 +367,114 @@ coDoBasisTree::ShareCellsBetweenLeaves()
         if (key[5] < 0)
             key[5] = 0;
 
-        if (key[0] == key[3] && key[1] == key[4] && key[2] == key[5])
+        int sweep_key[3];
+        for (sweep_key[0] = key[0]; sweep_key[0] <= key[3]; ++sweep_key[0])
         {
-            position = Position(key);
-            populations_[position].push_back(cell);
-        }
-        else
-        {
-            int sweep_key[3];
-            sweep_key[0] = key[0];
-            sweep_key[1] = key[1];
-            sweep_key[2] = key[2];
-            for (sweep_key[0] = key[0]; sweep_key[0] <= key[3]; ++sweep_key[0])
+            for (sweep_key[1] = key[1]; sweep_key[1] <= key[4]; ++sweep_key[1])
             {
-                for (sweep_key[1] = key[1]; sweep_key[1] <= key[4]; ++sweep_key[1])
+                for (sweep_key[2] = key[2]; sweep_key[2] <= key[5]; ++sweep_key[2])
                 {
-                    for (sweep_key[2] = key[2]; sweep_key[2] <= key[5]; ++sweep_key[2])
-                    {
-                        position = Position(sweep_key);
-                        populations_[position].push_back(cell);
-                    }
+                    f(Position(sweep_key));
                 }
             }
         }
-    }
-    // OK, now create the octtrees; let the trees grow
-    int key[3];
-    int &i = key[0];
-    int &j = key[1];
-    int &k = key[2];
+    };
+
+    // count the population each block of cells contributes to each
+    // initial oct-tree, then let every block fill in its part, so that
+    // the cells of a population are in ascending order
+    int no_blocks = numBlocks(nelem);
+    std::vector<int> counts((size_t)no_blocks * no_p_leaves, 0);
+    coThreadPool &pool = coThreadPool::global();
+    pool.run(no_blocks, [&](size_t block, int)
+             {
+                 int *count = &counts[block * no_p_leaves];
+                 int end = blockBegin(block + 1, no_blocks, nelem);
+                 for (int cell = blockBegin(block, no_blocks, nelem); cell < end; ++cell)
+                 {
+                     forLeaves(cell, [count](int position)
+                               { ++count[position]; });
+                 }
+             });
+    pool.run(no_p_leaves, [&](size_t position, int)
+             {
+                 int size = 0;
+                 for (int block = 0; block < no_blocks; ++block)
+                 {
+                     int &count = counts[(size_t)block * no_p_leaves + position];
+                     int offset = size;
+                     size += count;
+                     count = offset;
+                 }
+                 populations_[position].resize(size);
+             });
+    pool.run(no_blocks, [&](size_t block, int)
+             {
+                 int *offset = &counts[block * no_p_leaves];
+                 int end = blockBegin(block + 1, no_blocks, nelem);
+                 for (int cell = blockBegin(block, no_blocks, nelem); cell < end; ++cell)
+                 {
+                     forLeaves(cell, [this, offset, cell](int position)
+                               { populations_[position][offset[position]++] = cell; });
+                 }
+             });
+    counts.clear();
+
+    // OK, now create the octtrees; let the trees grow,
+    // each one into lists of its own
+    std::vector<std::vector<int> > macCellLists(no_p_leaves);
+    std::vector<std::vector<int> > cellLists(no_p_leaves);
+    pool.run(no_p_leaves, [&](size_t macro_leaf, int)
+             {
+                 int key[3];
+                 key[0] = (int)(macro_leaf % fX_);
+                 key[1] = (int)(macro_leaf / fX_ % fY_);
+                 key[2] = (int)(macro_leaf / fX_ / fY_);
+                 float bbox[6];
+                 IniBBox(bbox, key);
+                 // entry point and dummy element as in the lists of the forest
+                 macCellLists[macro_leaf].push_back(0);
+                 cellLists[macro_leaf].push_back(0);
+                 SplitOctTree(bbox, populations_[macro_leaf], 0, 0,
+                              macCellLists[macro_leaf], cellLists[macro_leaf]);
+                 std::vector<int>().swap(populations_[macro_leaf]);
+             });
+    delete[] populations_;
+    populations_ = NULL;
 
-    int macro_leaf;
-    float bbox[6];
-    cellList_.reserve(nelem);
-    cellList_.push_back(0); // one dummy element for cellList_
-    // make room for the fZ_*fY_*fX_ oct-tree entry points
-    macCellList_.reserve(no_p_leaves);
-    for (k = 0; k < fZ_; ++k)
+    // ...and append the trees to the forest in the order of their
+    // entry points, correcting the offsets into both lists
+    size_t cell_list_size = 1, mac_cell_list_size = no_p_leaves;
+    for (int macro_leaf = 0; macro_leaf < no_p_leaves; ++macro_leaf)
     {
-        for (j = 0; j < fY_; ++j)
-        {
-            for (i = 0; i < fX_; ++i)
-            {
-                macCellList_.push_back(0);
-            }
-        }
+        cell_list_size += cellLists[macro_leaf].size() - 1;
+        mac_cell_list_size += macCellLists[macro_leaf].size() - 1;
     }
-    for (k = 0; k < fZ_; ++k)
+    cellList_.reserve(cell_list_size);
+    cellList_.push_back(0); // one dummy element for cellList_
+    // make room for the fZ_*fY_*fX_ oct-tree entry points
+    macCellList_.reserve(mac_cell_list_size);
+    macCellList_.resize(no_p_leaves, 0);
+    for (int macro_leaf = 0; macro_leaf < no_p_leaves; ++macro_leaf)
     {
-        for (j = 0; j < fY_; ++j)
+        std::vector<int> &macCells = macCellLists[macro_leaf];
+        std::vector<int> &cells = cellLists[macro_leaf];
+        int mac_base = (int)macCellList_.size() - 1;
+        int cell_base = (int)cellList_.size() - 1;
+        for (size_t entry = 0; entry < macCells.size(); ++entry)
         {
-            for (i = 0; i < fX_; ++i)
-            {
-                macro_leaf = Position(key);
-                IniBBox(bbox, key);
-                // macCellList_.push_back(0);
-                SplitOctTree(bbox, populations_[macro_leaf], 0, macro_leaf);
-            }
+            int &offset = macCells[entry];
+            if (offset > 0)
+                offset += mac_base;
+            else if (offset < 0)
+                offset -= cell_base;
         }
+        macCellList_[macro_leaf] = macCells[0];
+        macCellList_.insert(macCellList_.end(), macCells.begin() + 1, macCells.end());
+        cellList_.insert(cellList_.end(), cells.begin() + 1, cells.end());
+        std::vector<int>().swap(macCells);
+        std::vector<int>().swap(cells);
     }
-    delete[] populations_;
-    populations_ = NULL;
 }
 
 // creates bbox for the root of an oct-tree given its key
@@ -405,7 +495,9 @@ void
 coDoBasisTree::SplitOctTree(const float *bbox,
                             std::vector<int> &population,
                             int level,
-                            int offset)
+                            int offset,
+                            std::vector<int> &macCellList,
+                            std::vector<int> &cellList)
 {
     // no more divisions if the population is small enough or if
     // the maximum supported level has been achieved or if all cells are too big
@@ -414,20 +506,20 @@ coDoBasisTree::SplitOctTree(const float *bbox,
         || level == max_no_levels_
         || CellsAreTooBig(bbox, population))
     {
-        // negative of the absolute position in cellList_
+        // negative of the absolute position in cellList
         if (population.size() > 0)
         {
-            macCellList_[offset] = -((int)cellList_.size());
+            macCellList[offset] = -((int)cellList.size());
             // dump population
-            cellList_.push_back((int)population.size());
+            cellList.push_back((int)population.size());
             for (cell = 0; cell < population.size(); ++cell)
             {
-                cellList_.push_back(population[cell]);
+                cellList.push_back(population[cell]);
             }
         }
         else
         {
-            macCellList_[offset] = 0;
+            macCellList[offset] = 0;
         }
         population.clear();
         return;
@@ -523,13 +615,13 @@ coDoBasisTree::SplitOctTree(const float *bbox,
     if (level >= crit_level_ && max_popu >= population.size())
     {
         // population.size()<NORMAL_SIZE/10){
-        // negative of the absolute position in cellList_
-        macCellList_[offset] = -((int)cellList_.size());
+        // negative of the absolute position in cellList
+        macCellList[offset] = -((int)cellList.size());
         // dump population
-        cellList_.push_back((int)population.size());
+        cellList.push_back((int)population.size());
         for (cell = 0; cell < population.size(); ++cell)
         {
-            cellList_.push_back(population[cell]);
+            cellList.push_back(population[cell]);
         }
         population.clear();
         return;
@@ -539,19 +631,20 @@ coDoBasisTree::SplitOctTree(const float *bbox,
     // we may then release the memory of population.
     population.clear();
 
-    // write in macCellList_ the new offset.
-    macCellList_[offset] = (int)macCellList_.size();
+    // write in macCellList the new offset.
+    macCellList[offset] = (int)macCellList.size();
     // make room for the 8 sons
     for (son = 0; son < 8; ++son)
     {
-        macCellList_.push_back(0);
+        macCellList.push_back(0);
     }
     // and divide
     for (son = 0; son < 8; ++son)
     {
         float bbox_son[6];
         fillBBoxSon(bbox_son, bbox, son);
-        SplitOctTree(bbox_son, popu_sons[son], level + 1, macCellList_[offset] + son);
+        SplitOctTree(bbox_son, popu_sons[son], level + 1, macCellList[offset] + son,
+                     macCellList, cellList);
     }
 }
 
@@ -36,7 +36,8 @@ public:
         MIN_SMALL_ENOUGH = 32, // minimum goal for macro-cell division
         CRIT_LEVEL = 3, // after this level tree division is interrupted
         // if a son leaf inherits all cells from the father
-        NORMAL_SIZE = 800 // population per tree if the grid were uniform
+        NORMAL_SIZE = 800, // population per tree if the grid were uniform
+        BLOCK_SIZE = 16384 // minimum number of cells processed by one thread
     };
     /** Constructor
        * @param n objedct name
@@ -147,6 +148,10 @@ protected:
     int rebuildFromShm();
 
     void BBoxForElement(int i);
+    void CellBBox(int i, float *cell_bbox) const;
+    // blocks of cells processed in parallel while making the tree
+    static int numBlocks(int nelem);
+    static int blockBegin(size_t block, int no_blocks, int nelem);
 
     // once the tree is made up to some level, we share the cell
     // population and recursively split the cells
@@ -161,7 +166,9 @@ protected:
     void SplitOctTree(const float *bbox,
                       std::vector<int> &population_,
                       int level,
-                      int offset);
+                      int offset,
+                      std::vector<int> &macCellList,
+                      std::vector<int> &cellList);
     int CellsAreTooBig(const float *bbox,
                        std::vector<int> &population);
     // Recreate Shared Memory objects here
@@ -7,8 +7,12 @@
 
 #include "coDoOctTree.h"
 
+#include <cstring>
+
 using namespace covise;
 
+static const char SHARED_SUFFIX[] = "_SharedOctTree";
+
 coDoOctTree::coDoOctTree(const coObjInfo &info)
     : coDoBasisTree(info)
 {
@@ -51,6 +55,29 @@ coDoOctTree::IsInBBox(int cell,
     return 0;
 }
 
+const char *coDoOctTree::SHARED_ATTRIBUTE = "SHARED_OCTTREE";
+
+std::string
+coDoOctTree::sharedName(const char *gridName)
+{
+    return std::string(gridName) + SHARED_SUFFIX;
+}
+
+std::string
+coDoOctTree::sharedGridName(const char *treeName)
+{
+    size_t len = strlen(treeName), suffixLen = strlen(SHARED_SUFFIX);
+    if (len <= suffixLen || strcmp(treeName + len - suffixLen, SHARED_SUFFIX) != 0)
+        return std::string();
+    return std::string(treeName, len - suffixLen);
+}
+
+bool
+coDoOctTree::isShared(const coDistributedObject *obj)
+{
+    return obj && obj->getAttribute(SHARED_ATTRIBUTE) != NULL;
+}
+
 coDoOctTree::~coDoOctTree()
 {
     // no treacherous arrays to delete
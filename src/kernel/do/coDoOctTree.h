@@ -20,6 +20,7 @@
 // Changes:
 
 #include "coDoBasisTree.h"
+#include <string>
 
 namespace covise
 {
@@ -90,6 +91,19 @@ public:
        */
     int IsInBBox(int cell, int no_e, const float *point) const;
 
+    /// attribute identifying the grid of a shared oct-tree
+    static const char *SHARED_ATTRIBUTE;
+
+    /// name of the oct-tree shared by all modules for the grid gridName
+    static std::string sharedName(const char *gridName);
+
+    /// name of the grid if treeName is the name of a shared oct-tree, empty otherwise
+    static std::string sharedGridName(const char *treeName);
+
+    /// whether obj is the shared oct-tree of a grid: it must not be
+    /// destroyed by the modules using it
+    static bool isShared(const coDistributedObject *obj);
+
     /// Destructor
     virtual ~coDoOctTree();
 
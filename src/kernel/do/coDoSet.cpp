@@ -83,15 +83,15 @@ int coDoSet::getObjInfo(int no, coDoInfo **il) const
         tmpinfolist[1].obj_name = (*il)[1].obj_name;
         (*il)[1].obj_name = NULL;
         tmpinfolist[1].ptr = (*il)[1].ptr;
-        eleptr = (int *)(*il)[2].ptr;
+        eleptr = (int *)((char *)(*il)[2].ptr + SHM_ARRAY_HEADER_SIZE);
         delete[] * il;
         *il = tmpinfolist;
 
         for (i = 0; i < count; i++)
         {
-            if (eleptr[2 + 2 * i])
+            if (eleptr[SHM_PTR_INT_SIZE * i])
             {
-                tmparr = new coShmArray(eleptr[2 + 2 * i], eleptr[2 + 2 * i + 1]);
+                tmparr = new coShmArray(eleptr[SHM_PTR_INT_SIZE * i], *(shmSizeType *)(&eleptr[SHM_PTR_INT_SIZE * i + 1]));
                 header = (coDoHeader *)tmparr->getPtr();
                 tmpinfolist[2 + i].type = header->getObjectType();
                 tmpinfolist[2 + i].type_name = calcTypeString(tmpinfolist[2 + i].type);
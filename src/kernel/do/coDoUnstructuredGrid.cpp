@@ -9,6 +9,8 @@
 #include "coDoOctTree.h"
 #include "covise_gridmethods.h"
 
+#include <climits>
+
 // in this list the TYPE_... definitions in covise_unstrgrd.h can be
 // used to return the number of vertices for this kind of element
 namespace covise
@@ -67,6 +69,17 @@ int nneighbor, int *nl, int *nli);
 
 #undef DEBUG
 
+// the element list holds offsets into the connectivity list as ints:
+// 64 bit connectivity is not supported, such grids have to be split into sets
+static bool connectivityFitsElementList(const char *name, ArrayLengthType nconn)
+{
+    if (nconn <= (ArrayLengthType)INT_MAX)
+        return true;
+    print_error(__LINE__, __FILE__, "%s: %llu connections do not fit into the element list",
+                name ? name : "coDoUnstructuredGrid", (unsigned long long)nconn);
+    return false;
+}
+
 coDistributedObject *coDoUnstructuredGrid::virtualCtor(coShmArray *arr)
 {
     coDistributedObject *ret;
@@ -127,7 +140,7 @@ coDoUnstructuredGrid::coDoUnstructuredGrid(const coObjInfo &info, coShmArray *ar
 }
 
 coDoUnstructuredGrid::coDoUnstructuredGrid(const coObjInfo &info,
-                                           int nelem, int nconn, int ncoord,
+                                           ArrayLengthType nelem, ArrayLengthType nconn, int ncoord,
                                            int *el, int *cl, float *xc, float *yc,
                                            float *zc)
     : coDoGrid(info)
@@ -140,6 +153,11 @@ coDoUnstructuredGrid::coDoUnstructuredGrid(const coObjInfo &info,
     covise_data_list dl[SHM_OBJ];
 
     setType("UNSGRD", "UNSTRUCTURED GRID");
+    if (!connectivityFitsElementList(name, nconn))
+    {
+        new_ok = 0;
+        return;
+    }
 #ifdef DEBUG
     cerr << "vor store_shared coDoUnstructuredGrid\n";
 #endif
@@ -156,9 +174,9 @@ coDoUnstructuredGrid::coDoUnstructuredGrid(const coObjInfo &info,
       sprintf(octname,"%s_OctTree",n);
       oct_tree = new coDoOctTree(octname,nelem,nconn,ncoord,el,cl,xc,yc,zc);
    */
-    dl[0].type = INTSHM;
+    dl[0].type = ARRAYLENGTHSHM;
     dl[0].ptr = (void *)&numelem;
-    dl[1].type = INTSHM;
+    dl[1].type = ARRAYLENGTHSHM;
     dl[1].ptr = (void *)&numconn;
     dl[2].type = INTSHM;
     dl[2].ptr = (void *)&numcoord;
@@ -202,7 +220,7 @@ coDoUnstructuredGrid::coDoUnstructuredGrid(const coObjInfo &info,
 }
 
 coDoUnstructuredGrid::coDoUnstructuredGrid(const coObjInfo &info,
-                                           int nelem, int nconn, int ncoord,
+                                           ArrayLengthType nelem, ArrayLengthType nconn, int ncoord,
                                            int *el, int *cl, float *xc, float *yc,
                                            float *zc, int *tl)
     : coDoGrid(info)
@@ -213,6 +231,11 @@ coDoUnstructuredGrid::coDoUnstructuredGrid(const coObjInfo &info,
     covise_data_list dl[SHM_OBJ];
 
     setType("UNSGRD", "UNSTRUCTURED GRID");
+    if (!connectivityFitsElementList(name, nconn))
+    {
+        new_ok = 0;
+        return;
+    }
 #ifdef DEBUG
     cerr << "vor store_shared coDoUnstructuredGrid\n";
 #endif
@@ -229,9 +252,9 @@ coDoUnstructuredGrid::coDoUnstructuredGrid(const coObjInfo &info,
       sprintf(octname,"%s_OctTree",n);
       oct_tree = new coDoOctTree(octname,nelem,nconn,ncoord,el,cl,xc,yc,zc);
    */
-    dl[0].type = INTSHM;
+    dl[0].type = ARRAYLENGTHSHM;
     dl[0].ptr = (void *)&numelem;
-    dl[1].type = INTSHM;
+    dl[1].type = ARRAYLENGTHSHM;
     dl[1].ptr = (void *)&numconn;
     dl[2].type = INTSHM;
     dl[2].ptr = (void *)&numcoord;
@@ -278,7 +301,7 @@ coDoUnstructuredGrid::coDoUnstructuredGrid(const coObjInfo &info,
 }
 
 coDoUnstructuredGrid::coDoUnstructuredGrid(const coObjInfo &info,
-                                           int nelem, int nconn, int ncoord, int ht)
+                                           ArrayLengthType nelem, ArrayLengthType nconn, int ncoord, int ht)
     : coDoGrid(info)
     , oct_tree(NULL)
     , lnl(NULL)
@@ -287,6 +310,11 @@ coDoUnstructuredGrid::coDoUnstructuredGrid(const coObjInfo &info,
     covise_data_list dl[SHM_OBJ];
 
     setType("UNSGRD", "UNSTRUCTURED GRID");
+    if (!connectivityFitsElementList(name, nconn))
+    {
+        new_ok = 0;
+        return;
+    }
 #ifdef DEBUG
     cerr << "vor store_shared coDoUnstructuredGrid\n";
 #endif
@@ -301,9 +329,9 @@ coDoUnstructuredGrid::coDoUnstructuredGrid(const coObjInfo &info,
         elementtypes.set_length(0);
     neighborlist.set_length(0);
     neighborindex.set_length(0);
-    dl[0].type = INTSHM;
+    dl[0].type = ARRAYLENGTHSHM;
     dl[0].ptr = (void *)&numelem;
-    dl[1].type = INTSHM;
+    dl[1].type = ARRAYLENGTHSHM;
     dl[1].ptr = (void *)&numconn;
     dl[2].type = INTSHM;
     dl[2].ptr = (void *)&numcoord;
@@ -360,9 +388,9 @@ int coDoUnstructuredGrid::rebuildFromShm()
         print_exit(__LINE__, __FILE__, 1);
     }
 
-    dl[0].type = INTSHM;
+    dl[0].type = ARRAYLENGTHSHM;
     dl[0].ptr = (void *)&numelem;
-    dl[1].type = INTSHM;
+    dl[1].type = ARRAYLENGTHSHM;
     dl[1].ptr = (void *)&numconn;
     dl[2].type = INTSHM;
     dl[2].ptr = (void *)&numcoord;
@@ -449,15 +477,71 @@ int coDoUnstructuredGrid::rebuildFromShm()
 // }
 
 void coDoUnstructuredGrid::computeNeighborList() const
+{
+    el = (int *)elements.getDataPtr();
+    cl = (int *)connections.getDataPtr();
+    tl = (int *)elementtypes.getDataPtr();
+    coUnstructuredNeighbors::computeNeighborList(numelem, numconn, numcoord, el, cl, tl, &lnl, &lnli);
+}
+
+coUnstructuredNeighbors coDoUnstructuredGrid::neighbors() const
+{
+    return coUnstructuredNeighbors(numelem, numconn, el, cl, tl, lnl, lnli);
+}
+
+int coDoUnstructuredGrid::getNeighbor(int element, vector<int> face_nodes_list)
+{
+    return neighbors().getNeighbor(element, face_nodes_list);
+}
+
+int coDoUnstructuredGrid::getNeighbor(int element, int n1, int n2, int n3, int n4)
+{
+    return neighbors().getNeighbor(element, n1, n2, n3, n4);
+}
+
+int coDoUnstructuredGrid::getNeighbor(int element, int n1, int n2, int n3)
+{
+    return neighbors().getNeighbor(element, n1, n2, n3);
+}
+
+int coDoUnstructuredGrid::getNeighbor(int element, int n1, int n2)
+{
+    return neighbors().getNeighbor(element, n1, n2);
+}
+
+int coDoUnstructuredGrid::getNeighbors(int element, int n1, int n2, int *neighbors)
+{
+    return this->neighbors().getNeighbors(element, n1, n2, neighbors);
+}
+
+int coDoUnstructuredGrid::getNeighbors(int element, int n1, int *neighbors)
+{
+    return this->neighbors().getNeighbors(element, n1, neighbors);
+}
+
+coUnstructuredNeighbors::coUnstructuredNeighbors(int numelem, int numconn,
+                                                 const int *el, const int *cl, const int *tl,
+                                                 const int *lnl, const int *lnli)
+    : numelem(numelem)
+    , numconn(numconn)
+    , el(el)
+    , cl(cl)
+    , tl(tl)
+    , lnl(lnl)
+    , lnli(lnli)
+{
+}
+
+void coUnstructuredNeighbors::computeNeighborList(int numelem, int numconn, int numcoord,
+                                                  const int *el, const int *cl, const int *tl,
+                                                  int **neighborList, int **neighborIndex)
 {
 
     int ja, j, i, offset, *tmpl1;
     int old_elem_index;
     int next_elem_index;
+    int *lnl, *lnli;
 
-    el = (int *)elements.getDataPtr();
-    cl = (int *)connections.getDataPtr();
-    tl = (int *)elementtypes.getDataPtr();
     lnli = new int[(int)numcoord + 1];
     tmpl1 = new int[(int)numcoord];
     memset(lnli, 0, (int)numcoord * sizeof(int));
@@ -545,9 +629,11 @@ void coDoUnstructuredGrid::computeNeighborList() const
     }
     delete[] tmpl1;
     delete[] used_vertex_list;
+    *neighborList = lnl;
+    *neighborIndex = lnli;
 }
 
-int coDoUnstructuredGrid::getNeighbor(int element, vector<int> face_nodes_list)
+int coUnstructuredNeighbors::getNeighbor(int element, vector<int> face_nodes_list) const
 {
     int i;
     int j;
@@ -576,7 +662,7 @@ int coDoUnstructuredGrid::getNeighbor(int element, vector<int> face_nodes_list)
             // Polyhedral cells
             if (UnstructuredGrid_Num_Nodes[tl[ce]] == -1)
             {
-                next_elem_index = (ce < numelem) ? el[ce + 1] : numconn;
+                next_elem_index = (ce < numelem - 1) ? el[ce + 1] : numconn;
                 for (n = 0; n < next_elem_index - el[ce]; n++)
                 {
                     // Test from the second vertex on; first vertex has already been tested
@@ -637,7 +723,7 @@ int coDoUnstructuredGrid::getNeighbor(int element, vector<int> face_nodes_list)
 
 // search for another cell than 'element' containing vertices of n1...n4
 // or at least 3 polints
-int coDoUnstructuredGrid::getNeighbor(int element, int n1, int n2, int n3, int n4)
+int coUnstructuredNeighbors::getNeighbor(int element, int n1, int n2, int n3, int n4) const
 {
     int f2, f3, f4, nf, ce = -1;
     int i, n;
@@ -654,7 +740,7 @@ int coDoUnstructuredGrid::getNeighbor(int element, int n1, int n2, int n3, int n
             // Polyhedral cells
             if (UnstructuredGrid_Num_Nodes[tl[ce]] == -1)
             {
-                next_elem_index = (ce < numelem) ? el[ce + 1] : numconn;
+                next_elem_index = (ce < numelem - 1) ? el[ce + 1] : numconn;
                 for (n = 0; n < next_elem_index - el[ce]; n++)
                 {
                     if (cl[el[ce] + n] == n2)
@@ -704,7 +790,7 @@ int coDoUnstructuredGrid::getNeighbor(int element, int n1, int n2, int n3, int n
             // Polyhedral cells
             if (UnstructuredGrid_Num_Nodes[tl[ce]] == -1)
             {
-                next_elem_index = (ce < numelem) ? el[ce + 1] : numconn;
+                next_elem_index = (ce < numelem - 1) ? el[ce + 1] : numconn;
                 for (n = 0; n < next_elem_index - el[ce]; n++)
                 {
                     if (cl[el[ce] + n] == n2)
@@ -744,7 +830,7 @@ int coDoUnstructuredGrid::getNeighbor(int element, int n1, int n2, int n3, int n
     return -1;
 }
 
-int coDoUnstructuredGrid::getNeighbor(int element, int n1, int n2, int n3)
+int coUnstructuredNeighbors::getNeighbor(int element, int n1, int n2, int n3) const
 {
     int f2, f3, ce = -1;
     int i, n;
@@ -761,7 +847,7 @@ int coDoUnstructuredGrid::getNeighbor(int element, int n1, int n2, int n3)
             // Polyhedral cells
             if (UnstructuredGrid_Num_Nodes[tl[ce]] == -1)
             {
-                next_elem_index = (ce < numelem) ? el[ce + 1] : numconn;
+                next_elem_index = (ce < numelem - 1) ? el[ce + 1] : numconn;
                 for (n = 0; n < next_elem_index - el[ce]; n++)
                 {
                     if (cl[el[ce] + n] == n2)
@@ -800,7 +886,7 @@ int coDoUnstructuredGrid::getNeighbor(int element, int n1, int n2, int n3)
         return (-1);
 }
 
-int coDoUnstructuredGrid::getNeighbor(int element, int n1, int n2)
+int coUnstructuredNeighbors::getNeighbor(int element, int n1, int n2) const
 {
     int f2, ce = -1;
     int i, n;
@@ -817,7 +903,7 @@ int coDoUnstructuredGrid::getNeighbor(int element, int n1, int n2)
             // Polyhedral cells
             if (UnstructuredGrid_Num_Nodes[tl[ce]] == -1)
             {
-                next_elem_index = (ce < numelem) ? el[ce + 1] : numconn;
+                next_elem_index = (ce < numelem - 1) ? el[ce + 1] : numconn;
                 for (n = 0; n < next_elem_index - el[ce]; n++)
                 {
                     if (cl[el[ce] + n] == n2)
@@ -852,7 +938,7 @@ int coDoUnstructuredGrid::getNeighbor(int element, int n1, int n2)
         return (-1);
 }
 
-int coDoUnstructuredGrid::getNeighbors(int element, int n1, int n2, int *neighbors)
+int coUnstructuredNeighbors::getNeighbors(int element, int n1, int n2, int *neighbors) const
 {
     int f2, ce = -1;
     int i, n, num = -1;
@@ -869,7 +955,7 @@ int coDoUnstructuredGrid::getNeighbors(int element, int n1, int n2, int *neighbo
             // Polyhedral cells
             if (UnstructuredGrid_Num_Nodes[tl[ce]] == -1)
             {
-                next_elem_index = (ce < numelem) ? el[ce + 1] : numconn;
+                next_elem_index = (ce < numelem - 1) ? el[ce + 1] : numconn;
                 for (n = 0; n < next_elem_index - el[ce]; n++)
                 {
                     if (cl[el[ce] + n] == n2)
@@ -900,7 +986,7 @@ int coDoUnstructuredGrid::getNeighbors(int element, int n1, int n2, int *neighbo
     return (num);
 }
 
-int coDoUnstructuredGrid::getNeighbors(int element, int n1, int *neighbors)
+int coUnstructuredNeighbors::getNeighbors(int element, int n1, int *neighbors) const
 {
     int ce = -1;
     int i, num = -1;
@@ -917,9 +1003,9 @@ int coDoUnstructuredGrid::getNeighbors(int element, int n1, int *neighbors)
     return num;
 }
 
-int coDoUnstructuredGrid::setSizes(int numElem, int numConn, int numCoord)
+int coDoUnstructuredGrid::setSizes(ArrayLengthType numElem, ArrayLengthType numConn, int numCoord)
 {
-    if (numElem > numelem || numConn > numconn || numCoord > numcoord)
+    if (numElem > (ArrayLengthType)numelem || numConn > (ArrayLengthType)numconn || numCoord > numcoord)
         return -1;
 
     numelem = numElem;
@@ -1836,6 +1922,8 @@ void coDoUnstructuredGrid::mapInCell(float *v_interp, const float *point,
 
 void coDoUnstructuredGrid::MakeOctTree(const char *octtreeSurname) const
 {
+    if (!oct_tree)
+        GetSharedOctTree();
     if (!oct_tree)
     {
         // make oct-tree and use update_shared_dl
@@ -1864,6 +1952,57 @@ const coDoOctTree *coDoUnstructuredGrid::GetOctTree(const coDistributedObject *r
     return (coDoOctTree *)(oct_tree);
 }
 
+std::string coDoUnstructuredGrid::octTreeKey() const
+{
+    // names may be reused for new grids, their place in shared memory may
+    // only be reused after the grid - and its tree - have been destroyed
+    char key[256];
+    sprintf(key, "%d:%ld:%d:%d:%d", shmarr ? shmarr->get_shm_seq_no() : -1,
+            shmarr ? (long)shmarr->get_offset() : -1L,
+            (int)numelem, (int)numconn, (int)numcoord);
+    return key;
+}
+
+const coDoOctTree *coDoUnstructuredGrid::GetSharedOctTree() const
+{
+    if (oct_tree)
+        return (const coDoOctTree *)(oct_tree);
+    if (!name || numelem <= 0)
+        return NULL;
+
+    std::string octname = coDoOctTree::sharedName(name);
+    std::string key = octTreeKey();
+    const coDistributedObject *obj = coDistributedObject::createFromShm(coObjInfo(octname.c_str()));
+    if (obj)
+    {
+        // attributes are added after the tree has been filled
+        const char *attr = obj->getAttribute(coDoOctTree::SHARED_ATTRIBUTE);
+        if (obj->isType("OCTREE") && attr && key == attr)
+        {
+            oct_tree = obj;
+            return (const coDoOctTree *)(oct_tree);
+        }
+        // still being built by another module
+        delete obj;
+        return NULL;
+    }
+
+    int *e_l, *c_l;
+    float *x_l, *y_l, *z_l;
+    getAddresses(&e_l, &c_l, &x_l, &y_l, &z_l);
+    coDoOctTree *tree = new coDoOctTree(coObjInfo(octname.c_str()), numelem, numconn, numcoord,
+                                        e_l, c_l, x_l, y_l, z_l);
+    if (!tree->objectOk())
+    {
+        // another module has been faster
+        delete tree;
+        return NULL;
+    }
+    tree->addAttribute(coDoOctTree::SHARED_ATTRIBUTE, key.c_str());
+    oct_tree = tree;
+    return tree;
+}
+
 void
 coDoUnstructuredGrid::compressConnectivity()
 {
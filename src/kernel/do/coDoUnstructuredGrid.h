@@ -57,6 +57,46 @@ DOEXPORT extern int UnstructuredGrid_Num_Nodes[20];
 
 class coDoOctTree;
 
+// search for the cells adjacent to a cell in the lists of the cells around
+// each vertex: used by coDoUnstructuredGrid, but also works on grids that
+// are not in shared memory
+class DOEXPORT coUnstructuredNeighbors
+{
+public:
+    coUnstructuredNeighbors()
+        : numelem(0)
+        , numconn(0)
+        , el(NULL)
+        , cl(NULL)
+        , tl(NULL)
+        , lnl(NULL)
+        , lnli(NULL)
+    {
+    }
+    // lnl/lnli as created by computeNeighborList, the arrays are not copied
+    coUnstructuredNeighbors(int numelem, int numconn,
+                            const int *el, const int *cl, const int *tl,
+                            const int *lnl, const int *lnli);
+
+    // lists all elements that contain a certain vertex consecutively in lnl,
+    // lnli points to the starting index for each vertex: delete[] both
+    static void computeNeighborList(int numelem, int numconn, int numcoord,
+                                    const int *el, const int *cl, const int *tl,
+                                    int **lnl, int **lnli);
+
+    int getNeighbor(int element, std::vector<int> face_nodes_list) const;
+    int getNeighbor(int element, int n1, int n2, int n3, int n4) const;
+    int getNeighbor(int element, int n1, int n2, int n3) const;
+    int getNeighbor(int element, int n1, int n2) const;
+    int getNeighbors(int element, int n1, int n2, int *neighbors) const;
+    int getNeighbors(int element, int n1, int *neighbors) const;
+
+private:
+    int numelem, numconn;
+    const int *el, *cl, *tl;
+    const int *lnl, *lnli;
+};
+
 class DOEXPORT coDoUnstructuredGrid : public coDoGrid
 {
     friend class coDoInitializer;
@@ -67,8 +107,8 @@ private:
     {
         SHM_OBJ = 12
     };
-    coIntShm numelem; // number of elements
-    coIntShm numconn; // number of connections
+    coArrayLengthShm numelem; // number of elements
+    coArrayLengthShm numconn; // number of connections
     coIntShm numcoord; // number of coords
     coIntShm numneighbor; // number of neighbors
     coFloatShmArray x_coord; // coordinates in x-direction (length numcoord)
@@ -92,6 +132,8 @@ private:
       */
 
     void MakeOctTree(const char *octSurname) const;
+    // identifies this grid and its contents for its shared oct-tree
+    std::string octTreeKey() const;
 
     int hastypes;
     int hasneighbors;
@@ -100,6 +142,7 @@ private:
     mutable int *lnli; // points into the lnl array to the starting index for
     // each vertex
     mutable int *el, *cl, *tl;
+    coUnstructuredNeighbors neighbors() const;
 
 protected:
     int rebuildFromShm();
@@ -135,11 +178,12 @@ public:
 
     coDoUnstructuredGrid(const coObjInfo &info, coShmArray *arr);
 
-    coDoUnstructuredGrid(const coObjInfo &info, int nelem, int nconn, int ncoord, int ht);
-    coDoUnstructuredGrid(const coObjInfo &info, int nelem, int nconn, int ncoord, int ht, int nneighbor);
-    coDoUnstructuredGrid(const coObjInfo &info, int nelem, int nconn, int ncoord,
+    // the offsets in the element list are ints: nconn has to fit into an int
+    coDoUnstructuredGrid(const coObjInfo &info, ArrayLengthType nelem, ArrayLengthType nconn, int ncoord, int ht);
+    coDoUnstructuredGrid(const coObjInfo &info, ArrayLengthType nelem, ArrayLengthType nconn, int ncoord, int ht, int nneighbor);
+    coDoUnstructuredGrid(const coObjInfo &info, ArrayLengthType nelem, ArrayLengthType nconn, int ncoord,
                          int *el, int *cl, float *xc, float *yc, float *zc);
-    coDoUnstructuredGrid(const coObjInfo &info, int nelem, int nconn, int ncoord,
+    coDoUnstructuredGrid(const coObjInfo &info, ArrayLengthType nelem, ArrayLengthType nconn, int ncoord,
                          int *el, int *cl, float *xc, float *yc, float *zc,
                          int *tl);
 
@@ -165,6 +209,8 @@ public:
         *conn = (int *)connections.getDataPtr();
     };
 
+    // the element, connectivity and type lists have int entries, so a grid
+    // has at most INT_MAX connections and these counts always fit an int
     void getGridSize(int *e, int *c, int *p) const
     {
         *e = numelem;
@@ -172,6 +218,23 @@ public:
         *p = numcoord;
     }
 
+    void getGridSize(ArrayLengthType *e, ArrayLengthType *c, int *p) const
+    {
+        *e = numelem;
+        *c = numconn;
+        *p = numcoord;
+    }
+
+    ArrayLengthType getNumElements() const
+    {
+        return numelem;
+    }
+
+    ArrayLengthType getNumConnections() const
+    {
+        return numconn;
+    }
+
     int getNumPoints() const
     {
         return numcoord;
@@ -214,7 +277,7 @@ public:
        *  @param    numConn    New size of connectivity list
        *  @param    numCoord   New size of coordinale list
        */
-    int setSizes(int numElem, int numConn, int numCoord);
+    int setSizes(ArrayLengthType numElem, ArrayLengthType numConn, int numCoord);
 
     // use oct-trees for cell location and field interpolation
     // Interpolates fields of any nature given a point and an input field
@@ -260,6 +323,11 @@ public:
     const coDoOctTree *GetOctTree(const coDistributedObject *reuseOctTree,
                                   const char *OctTreeSurname) const;
 
+    // oct-tree of this grid shared by all modules on this host:
+    // attaches to the tree another module has built for it or builds it,
+    // the data manager destroys it together with the grid
+    const coDoOctTree *GetSharedOctTree() const;
+
     // checks all hexahedron elements if their connectivity
     // leads to PRISMs, QUADs or TETRAHEDRONs and fix them
     void compressConnectivity();
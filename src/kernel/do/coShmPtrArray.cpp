@@ -73,13 +73,13 @@ using namespace covise;
 
 const coDistributedObject *coShmPtrArray::operator[](unsigned int i) const
 {
-    int *iptr = (int *)getDataPtr();
+    void *data = getDataPtr();
     const coDistributedObject *tmpptr;
     coShmArray *tmparr;
 
-    if ((i >= length) || (iptr[2 * i] == 0)) // aw: identify null obj
+    if ((i >= length) || (seq_no_of(data, i) == 0)) // aw: identify null obj
         return NULL;
-    tmparr = new coShmArray(iptr[2 * i], iptr[2 * i + 1]);
+    tmparr = new coShmArray(seq_no_of(data, i), offset_of(data, i));
     tmpptr = coDistributedObject::createUnknown(tmparr);
     if (tmpptr && tmpptr->objectOk())
     {
@@ -96,9 +96,7 @@ const coDistributedObject *coShmPtrArray::operator[](unsigned int i) const
 
 int coShmPtrArray::holds_object(int i)
 {
-    int *iptr = (int *)getDataPtr();
-
-    if (iptr[2 * i])
+    if (seq_no_of(getDataPtr(), i))
         return 1;
     else
         return 0;
@@ -110,18 +108,18 @@ void coShmPtrArray::set(int i, const coDistributedObject *elem)
 
     //    sprintf(tmp_str,"setting element no. %d", i);
     //    print_comment(__LINE__, __FILE__, tmp_str);
-    int *iptr = (int *)getDataPtr();
+    void *data = getDataPtr();
 
     if (elem)
     {
         tmparr = elem->shmarr;
-        iptr[2 * i] = tmparr->shm_seq_no;
-        iptr[2 * i + 1] = tmparr->offset;
+        seq_no_of(data, i) = tmparr->shm_seq_no;
+        offset_of(data, i) = tmparr->offset;
     }
     else // if a NULL pointer is given in here, we set 0/0
     {
-        iptr[2 * i] = 0;
-        iptr[2 * i + 1] = 0;
+        seq_no_of(data, i) = 0;
+        offset_of(data, i) = 0;
     }
     //    print();
 }
@@ -130,26 +128,29 @@ int coShmPtrArray::grow(ApplicationProcess *a, unsigned int s)
 {
     ShmMessage *shmmsg;
     coShmArray *tmparr;
-	int *iptr_new, *iptr_old;
-	unsigned int i;
+    void *data_new, *data_old;
+    unsigned int i;
 
     //    print_comment(__LINE__, __FILE__, "growing coShmPtrArray");
     //    print();
     shmmsg = new ShmMessage(SHMPTRARRAY, length + s);
     a->exch_data_msg(shmmsg, {COVISE_MESSAGE_MALLOC_OK, COVISE_MESSAGE_MALLOC_FAILED});
     shm_seq_no = *(int *)&shmmsg->data.data()[0];
-    offset = *(int *)&shmmsg->data.data()[sizeof(int)];
+    offset = *(shmSizeType *)&shmmsg->data.data()[sizeof(int)];
     tmparr = new coShmArray(shm_seq_no, offset);
-    iptr_new = (int *)tmparr->getPtr();
-    iptr_old = (int *)getPtr();
+    data_new = tmparr->getDataPtr();
+    data_old = getDataPtr();
     for (i = 0; i < length; i++)
     {
-        iptr_new[2 + 2 * i] = iptr_old[2 + 2 * i];
-        iptr_new[2 + 2 * i + 1] = iptr_old[2 + 2 * i + 1];
+        seq_no_of(data_new, i) = seq_no_of(data_old, i);
+        offset_of(data_new, i) = offset_of(data_old, i);
     }
     for (i = length; i < length + s; i++)
-        iptr_new[2 + 2 * i] = iptr_new[2 + 2 * i + 1] = 0;
-    ptr = iptr_new;
+    {
+        seq_no_of(data_new, i) = 0;
+        offset_of(data_new, i) = 0;
+    }
+    ptr = tmparr->getPtr();
     length += s;
     //    print();
     return 1;
@@ -160,9 +161,9 @@ void coShmPtrArray::print()
     unsigned int i;
 
     print_comment(__LINE__, __FILE__, "Printing coShmPtrArray Object ---------");
-    int *iptr = (int *)getDataPtr();
+    void *data = getDataPtr();
     for (i = 0; i < length; i++)
     {
-        print_comment(__LINE__, __FILE__, "entry %d: (%d, %d)", i, iptr[2 * i], iptr[2 * i + 1]);
+        print_comment(__LINE__, __FILE__, "entry %d: (%d, %llu)", i, seq_no_of(data, i), (unsigned long long)offset_of(data, i));
     }
 }
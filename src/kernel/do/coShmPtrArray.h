@@ -35,7 +35,7 @@ class DOEXPORT coShmPtrArray : public coShmArray
 public:
     coShmPtrArray()
         : coShmArray(){};
-    coShmPtrArray(int no, int o)
+    coShmPtrArray(int no, shmSizeType o)
         : coShmArray(no, o)
     {
         if (type != SHMPTRARRAY)
@@ -44,7 +44,7 @@ public:
             print_exit(__LINE__, __FILE__, 1);
         }
     };
-    void setPtr(int no, int o)
+    void setPtr(int no, shmSizeType o)
     {
         coShmArray::setPtr(no, o);
         if (type != SHMPTRARRAY)
@@ -59,6 +59,17 @@ public:
     int grow(ApplicationProcess *a, unsigned int s); // __alpha
     void set(int i, const coDistributedObject *elem);
     void print();
+
+private:
+    // entries are (shm_seq_no, offset) pairs
+    static int &seq_no_of(void *data, ArrayLengthType i)
+    {
+        return *(int *)((char *)data + i * (sizeof(int) + sizeof(shmSizeType)));
+    }
+    static shmSizeType &offset_of(void *data, ArrayLengthType i)
+    {
+        return *(shmSizeType *)((char *)data + i * (sizeof(int) + sizeof(shmSizeType)) + sizeof(int));
+    }
 };
 }
 #endif
@@ -526,7 +526,7 @@ grid_methods::interpolateInHexa(float *v_interp, const float *point,
             velo_array_num = velo[array_num];
             for (comp_num = 0; comp_num < array_dim; ++comp_num)
             {
-                velos[unst2str[vert] * no_arrays * array_dim + array_dim * array_num + comp_num] = velo_array_num[connl[vert]];
+                velos[unst2str[vert] * no_arrays * array_dim + array_dim * array_num + comp_num] = velo_array_num[connl[vert] * array_dim + comp_num];
             }
         }
     }
@@ -119,6 +119,23 @@ public:
                                  const int *connl,
                                  const float *x_in, const float *y_in, const float *z_in);
 
+    // batched versions of the above for no_points points, several of them
+    // at once in the lanes of SSE or AVX registers where available:
+    // points[3*i] is the i-th point, connl[i] the vertex list of its cell
+    // (8 vertices for hexahedra, 4 for tetrahedra), results are stored at
+    // v_interp[i*no_arrays*array_dim] and status[i]
+    static void interpolateInHexa(int no_points, float *v_interp, int *status, const float *points,
+                                  int no_arrays, int array_dim, const float *const *velo,
+                                  const int *const *connl,
+                                  const float *x_in, const float *y_in, const float *z_in);
+    static void interpolateVInHexa(int no_points, float *v_interp, int *status, const float *points,
+                                   const float *const *velo, const int *const *connl,
+                                   const float *x_in, const float *y_in, const float *z_in);
+    static void interpolateInTetra(int no_points, float *v_interp, const float *points,
+                                   int no_arrays, int array_dim, const float *const *velo,
+                                   const int *const *connl,
+                                   const float *x_in, const float *y_in, const float *z_in);
+
     /******************************/
     /* Support for polyhedral cells */
     /******************************/
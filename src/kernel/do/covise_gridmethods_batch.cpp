@@ -0,0 +1,481 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+// Interpolation of many points at once: the points are processed in
+// blocks of W lanes with the vector extensions of GCC and clang.
+// All lanes use exactly the operations of the scalar versions in the same
+// order, so that the results do not differ from those of
+// interpolateInHexa and interpolateInTetra for a single point.
+
+#include "covise_gridmethods.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace covise;
+
+#if defined(__GNUC__)
+#define GRID_METHODS_SIMD
+#if defined(__x86_64__) || defined(__i386__)
+#define GRID_METHODS_AVX
+#endif
+#endif
+
+#ifdef GRID_METHODS_SIMD
+// all helpers taking or returning vectors are inlined,
+// there are no calls between code compiled for SSE and for AVX
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+namespace
+{
+
+// vertex of an unstructured hexahedron for the corners x1 ... x8 of cell3
+const int cell3Vertex[8] = { 0, 1, 3, 2, 4, 5, 7, 6 };
+// vertex of an unstructured hexahedron for the factors multi[0] ... multi[7] of interpElem
+const int interpVertex[8] = { 0, 4, 3, 7, 1, 5, 2, 6 };
+
+// cell3 compares float values against double constants,
+// these are the equivalent float bounds
+struct Cell3Limits
+{
+    float inside_min, inside_max; // ABS(a - .5) <= .50005
+    float err2_max; // err2 <= 1.e-4
+
+    Cell3Limits()
+    {
+        inside_max = 1.00005f;
+        while (inside_max - .5 > .50005)
+            inside_max = nextafterf(inside_max, 0.f);
+        while (nextafterf(inside_max, 2.f) - .5 <= .50005)
+            inside_max = nextafterf(inside_max, 2.f);
+
+        inside_min = -0.00005f;
+        while (.5 - inside_min > .50005)
+            inside_min = nextafterf(inside_min, 1.f);
+        while (.5 - nextafterf(inside_min, -1.f) <= .50005)
+            inside_min = nextafterf(inside_min, -1.f);
+
+        err2_max = 1.e-4f;
+        while (err2_max > 1.e-4)
+            err2_max = nextafterf(err2_max, 0.f);
+        while (nextafterf(err2_max, 1.f) <= 1.e-4)
+            err2_max = nextafterf(err2_max, 1.f);
+    }
+};
+
+const Cell3Limits &cell3Limits()
+{
+    static Cell3Limits limits;
+    return limits;
+}
+
+template <int W>
+struct Lanes
+{
+    typedef float F __attribute__((vector_size(W * sizeof(float))));
+    typedef int I __attribute__((vector_size(W * sizeof(int))));
+};
+
+template <int W>
+inline __attribute__((always_inline)) bool anyLane(const typename Lanes<W>::I &mask)
+{
+    for (int l = 0; l < W; ++l)
+        if (mask[l])
+            return true;
+    return false;
+}
+
+template <int W>
+inline __attribute__((always_inline)) typename Lanes<W>::F load(const float *values)
+{
+    typename Lanes<W>::F v;
+    __builtin_memcpy(&v, values, sizeof(v));
+    return v;
+}
+
+// write the interpolated values of the first count lanes
+template <int W>
+inline __attribute__((always_inline)) void store(const typename Lanes<W>::F &v, float *v_interp, int stride, int count)
+{
+    for (int l = 0; l < count; ++l)
+        v_interp[l * stride] = v[l];
+}
+
+// the points first ... first+count-1, a partial block repeats its last point
+template <int W>
+inline __attribute__((always_inline)) void hexaBlock(int first, int count, float *v_interp, int *status,
+                                                     const float *points, int no_arrays, int array_dim,
+                                                     const float *const *velo, const int *const *connl,
+                                                     const float *x_in, const float *y_in, const float *z_in)
+{
+    typedef typename Lanes<W>::F F;
+    typedef typename Lanes<W>::I I;
+    const Cell3Limits &limits = cell3Limits();
+
+    float cx[8][W], cy[8][W], cz[8][W], px[W], py[W], pz[W];
+    for (int l = 0; l < W; ++l)
+    {
+        int p = first + std::min(l, count - 1);
+        const int *conn = connl[p];
+        for (int c = 0; c < 8; ++c)
+        {
+            int v = conn[cell3Vertex[c]];
+            cx[c][l] = x_in[v];
+            cy[c][l] = y_in[v];
+            cz[c][l] = z_in[v];
+        }
+        px[l] = points[3 * p];
+        py[l] = points[3 * p + 1];
+        pz[l] = points[3 * p + 2];
+    }
+
+    // Newton iteration of cell3 for the natural coordinates
+    F x1 = load<W>(cx[0]), x2 = load<W>(cx[1]), x3 = load<W>(cx[2]), x4 = load<W>(cx[3]);
+    F x5 = load<W>(cx[4]), x6 = load<W>(cx[5]), x7 = load<W>(cx[6]), x8 = load<W>(cx[7]);
+    F y1 = load<W>(cy[0]), y2 = load<W>(cy[1]), y3 = load<W>(cy[2]), y4 = load<W>(cy[3]);
+    F y5 = load<W>(cy[4]), y6 = load<W>(cy[5]), y7 = load<W>(cy[6]), y8 = load<W>(cy[7]);
+    F z1 = load<W>(cz[0]), z2 = load<W>(cz[1]), z3 = load<W>(cz[2]), z4 = load<W>(cz[3]);
+    F z5 = load<W>(cz[4]), z6 = load<W>(cz[5]), z7 = load<W>(cz[6]), z8 = load<W>(cz[7]);
+
+    F x0 = x1;
+    F xa = x2 - x1;
+    F xb = x3 - x1;
+    F xg = x5 - x1;
+    F xab = x4 - x3 - xa;
+    F xag = x6 - x5 - xa;
+    F xbg = x7 - x5 - xb;
+    F xabg = x8 - x7 - x6 + x5 - x4 + x3 + xa;
+
+    F y0 = y1;
+    F ya = y2 - y1;
+    F yb = y3 - y1;
+    F yg = y5 - y1;
+    F yab = y4 - y3 - ya;
+    F yag = y6 - y5 - ya;
+    F ybg = y7 - y5 - yb;
+    F yabg = y8 - y7 - y6 + y5 - y4 + y3 + ya;
+
+    F z0 = z1;
+    F za = z2 - z1;
+    F zb = z3 - z1;
+    F zg = z5 - z1;
+    F zab = z4 - z3 - za;
+    F zag = z6 - z5 - za;
+    F zbg = z7 - z5 - zb;
+    F zabg = z8 - z7 - z6 + z5 - z4 + z3 + za;
+
+    F pointX = load<W>(px), pointY = load<W>(py), pointZ = load<W>(pz);
+    F a = F{} + .5f, b = a, g = a;
+    I active = I{} == 0, singular = I{};
+    for (int iter = 1; iter <= 5; ++iter)
+    {
+        F pab = a * b;
+        F pag = a * g;
+        F pbg = b * g;
+        F pabg = pab * g;
+
+        F xh = x0 + xa * a + xb * b + xg * g + xab * pab + xag * pag + xbg * pbg + xabg * pabg;
+        F yh = y0 + ya * a + yb * b + yg * g + yab * pab + yag * pag + ybg * pbg + yabg * pabg;
+        F zh = z0 + za * a + zb * b + zg * g + zab * pab + zag * pag + zbg * pbg + zabg * pabg;
+
+        F a00 = xa + xab * b + xag * g + xabg * pbg;
+        F a01 = ya + yab * b + yag * g + yabg * pbg;
+        F a02 = za + zab * b + zag * g + zabg * pbg;
+        F a10 = xb + xab * a + xbg * g + xabg * pag;
+        F a11 = yb + yab * a + ybg * g + yabg * pag;
+        F a12 = zb + zab * a + zbg * g + zabg * pag;
+        F a20 = xg + xag * a + xbg * b + xabg * pab;
+        F a21 = yg + yag * a + ybg * b + yabg * pab;
+        F a22 = zg + zag * a + zbg * b + zabg * pab;
+
+        // inv3x3
+        F i00 = a11 * a22 - a12 * a21;
+        F i10 = a12 * a20 - a10 * a22;
+        F i20 = a10 * a21 - a11 * a20;
+        F i01 = a02 * a21 - a01 * a22;
+        F i11 = a00 * a22 - a02 * a20;
+        F i21 = a01 * a20 - a00 * a21;
+        F i02 = a01 * a12 - a02 * a11;
+        F i12 = a02 * a10 - a00 * a12;
+        F i22 = a00 * a11 - a01 * a10;
+        F det = a00 * i00 + a01 * i10 + a02 * i20;
+        // cell3 moves away from singular points, leave this to the scalar version
+        I zero = active & (det == 0.f);
+        singular |= zero;
+        active &= ~zero;
+        det = 1.0f / det;
+
+        F dx = pointX - xh;
+        F dy = pointY - yh;
+        F dz = pointZ - zh;
+        F da = dx * (i00 * det) + dy * (i10 * det) + dz * (i20 * det);
+        F db = dx * (i01 * det) + dy * (i11 * det) + dz * (i21 * det);
+        F dg = dx * (i02 * det) + dy * (i12 * det) + dz * (i22 * det);
+        a = active ? a + da : a;
+        b = active ? b + db : b;
+        g = active ? g + dg : g;
+
+        // ABS(PA - .5) > 3. or err2 <= 1.e-4
+        I stop = (a > 3.5f) | (a < -2.5f) | (b > 3.5f) | (b < -2.5f) | (g > 3.5f) | (g < -2.5f);
+        stop |= da * da + db * db + dg * dg <= limits.err2_max;
+        active &= ~stop;
+        if (!anyLane<W>(active))
+            break;
+    }
+
+    I inside = (a >= limits.inside_min) & (a <= limits.inside_max)
+               & (b >= limits.inside_min) & (b <= limits.inside_max)
+               & (g >= limits.inside_min) & (g <= limits.inside_max);
+
+    // interpElem
+    a -= .5f;
+    a += a;
+    b -= .5f;
+    b += b;
+    g -= .5f;
+    g += g;
+    F val0_m = 1.0f - a;
+    F val0_p = 1.0f + a;
+    F val1_m = 1.0f - b;
+    F val1_p = 1.0f + b;
+    F val2_m = 1.0f - g;
+    F val2_p = 1.0f + g;
+    F multi[8];
+    multi[0] = val0_m * val1_m * val2_m;
+    multi[1] = val0_m * val1_m * val2_p;
+    multi[2] = val0_m * val1_p * val2_m;
+    multi[3] = val0_m * val1_p * val2_p;
+    multi[4] = val0_p * val1_m * val2_m;
+    multi[5] = val0_p * val1_m * val2_p;
+    multi[6] = val0_p * val1_p * val2_m;
+    multi[7] = val0_p * val1_p * val2_p;
+
+    int no_values = no_arrays * array_dim;
+    float *out = v_interp + (size_t)first * no_values;
+    float vals[8][W];
+    for (int array = 0; array < no_arrays; ++array)
+    {
+        const float *velo_array = velo[array];
+        for (int comp = 0; comp < array_dim; ++comp)
+        {
+            for (int l = 0; l < W; ++l)
+            {
+                const int *conn = connl[first + std::min(l, count - 1)];
+                for (int s = 0; s < 8; ++s)
+                    vals[s][l] = velo_array[conn[interpVertex[s]] * array_dim + comp];
+            }
+            F interp = multi[0] * load<W>(vals[0]);
+            for (int s = 1; s < 8; ++s)
+                interp += multi[s] * load<W>(vals[s]);
+            interp *= .125f;
+            store<W>(interp, out + array * array_dim + comp, no_values, count);
+        }
+    }
+
+    for (int l = 0; l < count; ++l)
+    {
+        int p = first + l;
+        if (singular[l])
+            status[p] = grid_methods::interpolateInHexa(v_interp + (size_t)p * no_values, points + 3 * p,
+                                                        no_arrays, array_dim, velo, connl[p],
+                                                        x_in, y_in, z_in);
+        else
+            status[p] = inside[l] ? 0 : 1;
+    }
+}
+
+template <int W>
+inline __attribute__((always_inline)) typename Lanes<W>::F tetraVol(const typename Lanes<W>::F p0[3],
+                                                                    const typename Lanes<W>::F p1[3],
+                                                                    const typename Lanes<W>::F p2[3],
+                                                                    const typename Lanes<W>::F p3[3])
+{
+    typedef typename Lanes<W>::F F;
+    F diff1_0 = p1[0] - p0[0];
+    F diff1_1 = p1[1] - p0[1];
+    F diff1_2 = p1[2] - p0[2];
+    F diff2_0 = p2[0] - p0[0];
+    F diff2_1 = p2[1] - p0[1];
+    F diff2_2 = p2[2] - p0[2];
+    F diff3_0 = p3[0] - p0[0];
+    F diff3_1 = p3[1] - p0[1];
+    F diff3_2 = p3[2] - p0[2];
+
+    F vol = (diff2_1 * diff3_2 - diff3_1 * diff2_2) * diff1_0;
+    vol += (diff2_2 * diff3_0 - diff3_2 * diff2_0) * diff1_1;
+    vol += (diff2_0 * diff3_1 - diff3_0 * diff2_1) * diff1_2;
+    vol *= 0.16666666666667f;
+    return vol;
+}
+
+template <int W>
+inline __attribute__((always_inline)) void tetraBlock(int first, int count, float *v_interp,
+                                                      const float *points, int no_arrays, int array_dim,
+                                                      const float *const *velo, const int *const *connl,
+                                                      const float *x_in, const float *y_in, const float *z_in)
+{
+    typedef typename Lanes<W>::F F;
+
+    const float *coords[3] = { x_in, y_in, z_in };
+    float c[4][3][W], pt[3][W];
+    for (int l = 0; l < W; ++l)
+    {
+        int p = first + std::min(l, count - 1);
+        for (int v = 0; v < 4; ++v)
+            for (int d = 0; d < 3; ++d)
+                c[v][d][l] = coords[d][connl[p][v]];
+        for (int d = 0; d < 3; ++d)
+            pt[d][l] = points[3 * p + d];
+    }
+    F p[4][3], px[3];
+    for (int d = 0; d < 3; ++d)
+    {
+        for (int v = 0; v < 4; ++v)
+            p[v][d] = load<W>(c[v][d]);
+        px[d] = load<W>(pt[d]);
+    }
+
+    F ivg = 1.0f / tetraVol<W>(p[0], p[1], p[2], p[3]);
+    F w[4];
+    w[0] = tetraVol<W>(px, p[1], p[2], p[3]) * ivg;
+    w[1] = tetraVol<W>(p[0], px, p[2], p[3]) * ivg;
+    w[2] = tetraVol<W>(p[0], p[1], px, p[3]) * ivg;
+    w[3] = tetraVol<W>(p[0], p[1], p[2], px) * ivg;
+
+    int no_values = no_arrays * array_dim;
+    float *out = v_interp + (size_t)first * no_values;
+    float vals[4][W];
+    for (int array = 0; array < no_arrays; ++array)
+    {
+        const float *velo_array = velo[array];
+        for (int comp = 0; comp < array_dim; ++comp)
+        {
+            for (int l = 0; l < W; ++l)
+            {
+                const int *conn = connl[first + std::min(l, count - 1)];
+                for (int v = 0; v < 4; ++v)
+                    vals[v][l] = velo_array[conn[v] * array_dim + comp];
+            }
+            F interp = w[0] * load<W>(vals[0]);
+            for (int v = 1; v < 4; ++v)
+                interp += w[v] * load<W>(vals[v]);
+            store<W>(interp, out + array * array_dim + comp, no_values, count);
+        }
+    }
+}
+
+template <int W>
+inline __attribute__((always_inline)) void hexaBatch(int no_points, float *v_interp, int *status,
+                                                     const float *points, int no_arrays, int array_dim,
+                                                     const float *const *velo, const int *const *connl,
+                                                     const float *x_in, const float *y_in, const float *z_in)
+{
+    for (int first = 0; first < no_points; first += W)
+        hexaBlock<W>(first, std::min(W, no_points - first), v_interp, status, points,
+                     no_arrays, array_dim, velo, connl, x_in, y_in, z_in);
+}
+
+template <int W>
+inline __attribute__((always_inline)) void tetraBatch(int no_points, float *v_interp,
+                                                      const float *points, int no_arrays, int array_dim,
+                                                      const float *const *velo, const int *const *connl,
+                                                      const float *x_in, const float *y_in, const float *z_in)
+{
+    for (int first = 0; first < no_points; first += W)
+        tetraBlock<W>(first, std::min(W, no_points - first), v_interp, points,
+                      no_arrays, array_dim, velo, connl, x_in, y_in, z_in);
+}
+
+#ifdef GRID_METHODS_AVX
+__attribute__((target("avx"))) void hexaBatchAVX(int no_points, float *v_interp, int *status,
+                                                 const float *points, int no_arrays, int array_dim,
+                                                 const float *const *velo, const int *const *connl,
+                                                 const float *x_in, const float *y_in, const float *z_in)
+{
+    hexaBatch<8>(no_points, v_interp, status, points, no_arrays, array_dim, velo, connl, x_in, y_in, z_in);
+}
+
+__attribute__((target("avx"))) void tetraBatchAVX(int no_points, float *v_interp,
+                                                  const float *points, int no_arrays, int array_dim,
+                                                  const float *const *velo, const int *const *connl,
+                                                  const float *x_in, const float *y_in, const float *z_in)
+{
+    tetraBatch<8>(no_points, v_interp, points, no_arrays, array_dim, velo, connl, x_in, y_in, z_in);
+}
+
+bool haveAVX()
+{
+    static bool avx = __builtin_cpu_supports("avx");
+    return avx;
+}
+#endif
+}
+#endif
+
+void grid_methods::interpolateInHexa(int no_points, float *v_interp, int *status, const float *points,
+                                     int no_arrays, int array_dim, const float *const *velo,
+                                     const int *const *connl,
+                                     const float *x_in, const float *y_in, const float *z_in)
+{
+    if (!v_interp || !velo)
+    {
+        std::fill(status, status + no_points, 0);
+        return;
+    }
+#ifdef GRID_METHODS_SIMD
+#ifdef GRID_METHODS_AVX
+    if (haveAVX())
+    {
+        hexaBatchAVX(no_points, v_interp, status, points, no_arrays, array_dim, velo, connl, x_in, y_in, z_in);
+        return;
+    }
+#endif
+    hexaBatch<4>(no_points, v_interp, status, points, no_arrays, array_dim, velo, connl, x_in, y_in, z_in);
+#else
+    int no_values = no_arrays * array_dim;
+    for (int p = 0; p < no_points; ++p)
+        status[p] = interpolateInHexa(v_interp + (size_t)p * no_values, points + 3 * p,
+                                      no_arrays, array_dim, velo, connl[p], x_in, y_in, z_in);
+#endif
+}
+
+void grid_methods::interpolateVInHexa(int no_points, float *v_interp, int *status, const float *points,
+                                      const float *const *velo, const int *const *connl,
+                                      const float *x_in, const float *y_in, const float *z_in)
+{
+    interpolateInHexa(no_points, v_interp, status, points, 3, 1, velo, connl, x_in, y_in, z_in);
+}
+
+void grid_methods::interpolateInTetra(int no_points, float *v_interp, const float *points,
+                                      int no_arrays, int array_dim, const float *const *velo,
+                                      const int *const *connl,
+                                      const float *x_in, const float *y_in, const float *z_in)
+{
+    if (!v_interp || !velo)
+        return;
+#ifdef GRID_METHODS_SIMD
+#ifdef GRID_METHODS_AVX
+    if (haveAVX())
+    {
+        tetraBatchAVX(no_points, v_interp, points, no_arrays, array_dim, velo, connl, x_in, y_in, z_in);
+        return;
+    }
+#endif
+    tetraBatch<4>(no_points, v_interp, points, no_arrays, array_dim, velo, connl, x_in, y_in, z_in);
+#else
+    int no_values = no_arrays * array_dim;
+    for (int p = 0; p < no_points; ++p)
+    {
+        const int *c = connl[p];
+        float p0[3] = { x_in[c[0]], y_in[c[0]], z_in[c[0]] };
+        float p1[3] = { x_in[c[1]], y_in[c[1]], z_in[c[1]] };
+        float p2[3] = { x_in[c[2]], y_in[c[2]], z_in[c[2]] };
+        float p3[3] = { x_in[c[3]], y_in[c[3]], z_in[c[3]] };
+        interpolateInTetra(v_interp + (size_t)p * no_values, points + 3 * p, no_arrays, array_dim, velo,
+                           c[0], c[1], c[2], c[3], p0, p1, p2, p3);
+    }
+#endif
+}
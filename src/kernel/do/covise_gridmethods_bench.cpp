@@ -0,0 +1,166 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+// throughput of the batched interpolation in hexahedra and tetrahedra
+// compared to interpolating one point after the other, and the largest
+// difference between their results
+//
+// usage: gridMethodsBench [cells per direction] [points]
+
+#include "covise_gridmethods.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace covise;
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static float max_diff(const std::vector<float> &a, const std::vector<float> &b)
+{
+    float diff = 0.f;
+    for (size_t i = 0; i < a.size(); i++)
+        diff = std::max(diff, std::fabs(a[i] - b[i]));
+    return diff;
+}
+
+static void report(const char *name, int no_points, double single, double batched, float diff, int mismatches)
+{
+    printf("%-8s single %8.2f Mpoints/s   batched %8.2f Mpoints/s   speedup %5.2f   max diff %g%s\n",
+           name, no_points / single * 1e-6, no_points / batched * 1e-6, single / batched, diff,
+           mismatches ? "   STATUS MISMATCH" : "");
+}
+
+int main(int argc, char *argv[])
+{
+    int n = argc > 1 ? atoi(argv[1]) : 32;
+    int no_points = argc > 2 ? atoi(argv[2]) : 1000000;
+    if (n < 1)
+        n = 1;
+    if (no_points < 1)
+        no_points = 1;
+    int np = n + 1;
+    size_t numElem = (size_t)n * n * n, numCoord = (size_t)np * np * np;
+
+    // distorted hexahedral grid with a vector field
+    std::vector<int> cl(8 * numElem);
+    std::vector<float> x(numCoord), y(numCoord), z(numCoord), u(numCoord), v(numCoord), w(numCoord);
+    size_t e = 0;
+    for (int k = 0; k < n; k++)
+        for (int j = 0; j < n; j++)
+            for (int i = 0; i < n; i++, e++)
+            {
+                int c = (k * np + j) * np + i;
+                int *conn = &cl[8 * e];
+                conn[0] = c;
+                conn[1] = c + 1;
+                conn[2] = c + np + 1;
+                conn[3] = c + np;
+                conn[4] = c + np * np;
+                conn[5] = c + np * np + 1;
+                conn[6] = c + np * np + np + 1;
+                conn[7] = c + np * np + np;
+            }
+    size_t p = 0;
+    for (int k = 0; k < np; k++)
+        for (int j = 0; j < np; j++)
+            for (int i = 0; i < np; i++, p++)
+            {
+                x[p] = i + 0.2f * sinf(0.7f * j + 0.3f * k);
+                y[p] = j + 0.2f * cosf(0.5f * k + 0.4f * i);
+                z[p] = k * 1.5f + 0.1f * sinf(0.9f * i);
+                u[p] = sinf(0.05f * i) * cosf(0.07f * j);
+                v[p] = cosf(0.03f * j) + 0.01f * k;
+                w[p] = sinf(0.11f * k) * 0.5f;
+            }
+    const float *velo[3] = { u.data(), v.data(), w.data() };
+
+    // random points in random cells, most of them inside, some slightly outside
+    srand(4711);
+    std::vector<const int *> hexConn(no_points), tetConn(no_points);
+    std::vector<int> tetVerts(4 * (size_t)no_points);
+    std::vector<float> points(3 * (size_t)no_points);
+    for (int i = 0; i < no_points; i++)
+    {
+        const int *conn = &cl[8 * (size_t)(rand() % numElem)];
+        hexConn[i] = conn;
+        float r[3];
+        for (int d = 0; d < 3; d++)
+            r[d] = -0.05f + 1.1f * rand() / (float)RAND_MAX;
+        // trilinear map of the unit cube to the cell
+        float wgt[8] = {
+            (1 - r[0]) * (1 - r[1]) * (1 - r[2]), r[0] * (1 - r[1]) * (1 - r[2]),
+            r[0] * r[1] * (1 - r[2]), (1 - r[0]) * r[1] * (1 - r[2]),
+            (1 - r[0]) * (1 - r[1]) * r[2], r[0] * (1 - r[1]) * r[2],
+            r[0] * r[1] * r[2], (1 - r[0]) * r[1] * r[2]
+        };
+        float *pt = &points[3 * (size_t)i];
+        pt[0] = pt[1] = pt[2] = 0.f;
+        for (int c = 0; c < 8; c++)
+        {
+            pt[0] += wgt[c] * x[conn[c]];
+            pt[1] += wgt[c] * y[conn[c]];
+            pt[2] += wgt[c] * z[conn[c]];
+        }
+        int *tet = &tetVerts[4 * (size_t)i];
+        tet[0] = conn[0];
+        tet[1] = conn[1];
+        tet[2] = conn[3];
+        tet[3] = conn[4];
+        tetConn[i] = tet;
+    }
+
+    printf("%d^3 hexahedra, %d points\n", n, no_points);
+    int mismatches = 0;
+
+    // hexahedra
+    std::vector<float> single(3 * (size_t)no_points), batched(3 * (size_t)no_points);
+    std::vector<int> singleStatus(no_points), batchedStatus(no_points);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < no_points; i++)
+        singleStatus[i] = grid_methods::interpolateInHexa(&single[3 * (size_t)i], &points[3 * (size_t)i], 3, 1, velo,
+                                                          hexConn[i], x.data(), y.data(), z.data());
+    double singleTime = seconds_since(start);
+    start = std::chrono::steady_clock::now();
+    grid_methods::interpolateInHexa(no_points, batched.data(), batchedStatus.data(), points.data(), 3, 1, velo,
+                                    hexConn.data(), x.data(), y.data(), z.data());
+    double batchedTime = seconds_since(start);
+    int hexMismatches = 0;
+    for (int i = 0; i < no_points; i++)
+        if (singleStatus[i] != batchedStatus[i])
+            ++hexMismatches;
+    report("hexa", no_points, singleTime, batchedTime, max_diff(single, batched), hexMismatches);
+    mismatches += hexMismatches;
+
+    // tetrahedra
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < no_points; i++)
+    {
+        const int *c = tetConn[i];
+        float p0[3] = { x[c[0]], y[c[0]], z[c[0]] };
+        float p1[3] = { x[c[1]], y[c[1]], z[c[1]] };
+        float p2[3] = { x[c[2]], y[c[2]], z[c[2]] };
+        float p3[3] = { x[c[3]], y[c[3]], z[c[3]] };
+        grid_methods::interpolateInTetra(&single[3 * (size_t)i], &points[3 * (size_t)i], 3, 1, velo,
+                                         c[0], c[1], c[2], c[3], p0, p1, p2, p3);
+    }
+    singleTime = seconds_since(start);
+    start = std::chrono::steady_clock::now();
+    grid_methods::interpolateInTetra(no_points, batched.data(), points.data(), 3, 1, velo,
+                                     tetConn.data(), x.data(), y.data(), z.data());
+    batchedTime = seconds_since(start);
+    report("tetra", no_points, singleTime, batchedTime, max_diff(single, batched), 0);
+
+    return mismatches ? 1 : 0;
+}
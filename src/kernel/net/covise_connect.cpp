@@ -944,6 +944,28 @@ bool Connection::sendMessage(int senderId, int senderType, const Message* msg) c
     return true;
 }
 
+bool Connection::sendMessages(const Message *const *msgs, int no) const
+{
+    if (!sock)
+        return false;
+    if (!is_connected())
+    {
+        return false;
+    }
+    std::vector<std::array<int, 4>> headers(no);
+    std::vector<SocketBuffer> parts;
+    parts.reserve(2 * no);
+    for (int i = 0; i < no; i++)
+    {
+        headers[i] = {sender_id, send_type, msgs[i]->type, msgs[i]->data.length()};
+        swap_bytes((unsigned int *)headers[i].data(), 4);
+        parts.push_back({headers[i].data(), sizeof(headers[i])});
+        if (msgs[i]->data.length() > 0)
+            parts.push_back({msgs[i]->data.data(), (size_t)msgs[i]->data.length()});
+    }
+    return sock->writev(parts.data(), (int)parts.size());
+}
+
 bool Connection::sendMessage(const UdpMessage *msg) const{
     return false;
 }
@@ -1006,6 +1028,62 @@ int Connection::recv_msg_fast(Message *msg) const
     return read_bytes + read_msg_bytes;
 }
 
+int Connection::recv_msg_into(Message *msg, char *buf, int len) const
+{
+    msg->conn = this;
+    msg->data = DataHandle();
+    message_to_do = 0;
+
+    if (!sock)
+        return -1;
+
+    // header, maybe already read ahead by recv_msg
+    while (bytes_to_process < 4 * SIZEOF_IEEE_INT)
+    {
+        int tmp_read = sock->Read(read_buf + bytes_to_process, 4 * SIZEOF_IEEE_INT - bytes_to_process);
+        if (tmp_read <= 0)
+        {
+            msg->type = Message::SOCKET_CLOSED;
+            return -1;
+        }
+        bytes_to_process += tmp_read;
+    }
+    int header[4];
+    memcpy(header, read_buf, sizeof(header));
+    swap_bytes((unsigned int *)header, 4);
+    msg->sender = header[0];
+    msg->send_type = header[1];
+    msg->type = header[2];
+    int length = header[3];
+    bytes_to_process -= 4 * SIZEOF_IEEE_INT;
+    memmove(read_buf, read_buf + 4 * SIZEOF_IEEE_INT, bytes_to_process);
+    if (length < 0 || length > len)
+    {
+        LOGERROR("recv_msg_into: message does not fit into buffer");
+        return -1;
+    }
+
+    // data that has already been read ahead, the rest goes directly to buf
+    int bytes_read = std::min(length, bytes_to_process);
+    memcpy(buf, read_buf, bytes_read);
+    bytes_to_process -= bytes_read;
+    memmove(read_buf, read_buf + bytes_read, bytes_to_process);
+    while (bytes_read < length)
+    {
+        int tmp_read = sock->Read(buf + bytes_read, length - bytes_read);
+        if (tmp_read <= 0)
+        {
+            msg->type = Message::SOCKET_CLOSED;
+            return -1;
+        }
+        bytes_read += tmp_read;
+    }
+    if (bytes_to_process >= 4 * SIZEOF_IEEE_INT)
+        message_to_do = 1;
+    msg->data = DataHandle(buf, length, false);
+    return length;
+}
+
 int Connection::recv_msg(Message *msg, char* ip) const
 {
 #ifdef SHOWMSG
@@ -1747,6 +1825,16 @@ bool SSLConnection::sendMessage(const Message *msg) const{
     return send_msg(msg) > 0;
 }
 
+bool SSLConnection::sendMessages(const Message *const *msgs, int no) const
+{
+    for (int i = 0; i < no; i++)
+    {
+        if (!sendMessage(msgs[i]))
+            return false;
+    }
+    return true;
+}
+
 const char *SSLConnection::readLine()
 {
     int numBytes = 0;
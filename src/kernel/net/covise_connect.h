@@ -169,7 +169,12 @@ public:
     virtual int send(const void *buf, unsigned nbyte) const; // send into socket
 	virtual int recv_msg(Message *msg, char *ip = nullptr) const; // receive Message, can set ip to the ip adresss of the sender(for udp msgs)
     virtual int recv_msg_fast(Message *msg) const; // high-performace receive Message
+    // receive Message with its data going directly into buf (at most len bytes),
+    // returns the data length or -1 on failure
+    int recv_msg_into(Message *msg, char *buf, int len) const;
     virtual bool sendMessage(const Message *msg) const override; // send Message
+    // send no Messages with one gather write, their data is not copied
+    virtual bool sendMessages(const Message *const *msgs, int no) const;
     virtual bool sendMessage(const UdpMessage *msg) const override; // send Message
     virtual int send_msg_fast(const Message *msg); // high-performance send Message
     int check_for_input(float time = 0.0) const; // issue select call and return TRUE if there is an event or 0L otherwise
@@ -441,6 +446,7 @@ public:
     int recv_msg(Message *msg, char *ip = nullptr) const override; // receive Message
     int send_msg(const Message *msg) const; // send Message
     bool sendMessage(const Message *msg) const override;
+    bool sendMessages(const Message *const *msgs, int no) const override;
     const char *readLine(); // Read line
     bool IsClosed() const;
     std::string getPeerAddress();
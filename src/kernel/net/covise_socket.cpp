@@ -18,6 +18,7 @@
 #include <util/unixcompat.h>
 #include <util/string_util.h>
 #include <iostream>
+#include <algorithm>
 
 #include <sys/types.h>
 #include <signal.h>
@@ -33,6 +34,8 @@
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <limits.h>
 #endif
 
 #include <util/coErr.h>
@@ -828,6 +831,97 @@ int Socket::write(const void *buf, unsigned nbyte)
     return no_of_bytes;
 }
 
+bool Socket::writeEach(const SocketBuffer *buffers, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        const char *buf = (const char *)buffers[i].buf;
+        size_t left = buffers[i].nbyte;
+        while (left > 0)
+        {
+            unsigned chunk = left > INT_MAX ? INT_MAX : (unsigned)left;
+            int no_of_bytes = write(buf, chunk);
+            if (no_of_bytes <= 0)
+                return false;
+            buf += no_of_bytes;
+            left -= no_of_bytes;
+        }
+    }
+    return true;
+}
+
+bool Socket::writev(const SocketBuffer *buffers, int count)
+{
+#ifdef _WIN32
+    return writeEach(buffers, count);
+#else
+#ifdef IOV_MAX
+    const size_t max_iov = IOV_MAX;
+#else
+    const size_t max_iov = 1024;
+#endif
+    std::vector<struct iovec> iov(count);
+    for (int i = 0; i < count; i++)
+    {
+        iov[i].iov_base = const_cast<void *>(buffers[i].buf);
+        iov[i].iov_len = buffers[i].nbyte;
+    }
+
+    char tmp_str[255];
+    size_t first = 0;
+    while (first < iov.size())
+    {
+        // skip parts that have been written completely
+        if (iov[first].iov_len == 0)
+        {
+            ++first;
+            continue;
+        }
+        int n = (int)std::min(iov.size() - first, max_iov);
+        errno = 0;
+        ssize_t no_of_bytes = ::writev(sock_id, &iov[first], n);
+        if (no_of_bytes < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN)
+            {
+                // the send buffer is full: wait until the socket can take more
+                fd_set writefds;
+                FD_ZERO(&writefds);
+                FD_SET(sock_id, &writefds);
+                if (select(sock_id + 1, NULL, &writefds, NULL, NULL) >= 0 || errno == EINTR)
+                    continue;
+            }
+            if (errno != EPIPE && errno != ECONNRESET)
+            {
+                sprintf(tmp_str, "Socket writev error = %d: %s", errno, coStrerror(errno));
+                LOGERROR(tmp_str);
+            }
+            return false;
+        }
+        else if (no_of_bytes == 0)
+        {
+            LOGERROR("writev returns 0: close socket.");
+            return false;
+        }
+
+        // advance past what has been written, possibly in the middle of a part
+        size_t written = no_of_bytes;
+        while (written > 0)
+        {
+            size_t part = std::min(written, iov[first].iov_len);
+            iov[first].iov_base = (char *)iov[first].iov_base + part;
+            iov[first].iov_len -= part;
+            written -= part;
+            if (iov[first].iov_len == 0)
+                ++first;
+        }
+    }
+    return true;
+#endif
+}
+
 int Socket::read(void *buf, unsigned nbyte)
 {
     int no_of_bytes;
@@ -1443,6 +1537,12 @@ int SSLSocket::write(const void *buf, unsigned int nbyte)
     return no_of_bytes;
 }
 
+bool SSLSocket::writev(const SocketBuffer *buffers, int count)
+{
+    // SSL_write has no gather variant
+    return writeEach(buffers, count);
+}
+
 int SSLSocket::connect(sockaddr_in addr /*, int retries, double timeout*/)
 {
     try
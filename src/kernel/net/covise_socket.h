@@ -119,6 +119,13 @@ class ServerConnection;
 class SimpleServerConnection;
 class SSLServerConnection;
 
+// one part of a gather write, see Socket::writev
+struct SocketBuffer
+{
+    const void *buf;
+    size_t nbyte;
+};
+
 class NETEXPORT Socket
 {
 protected:
@@ -133,6 +140,8 @@ protected:
     int port = 0;
     int setTCPOptions();
     bool connected = false;
+    // write all parts one after another with write()
+    bool writeEach(const SocketBuffer *buffers, int count);
 
 public:
     // connect as client
@@ -176,6 +185,9 @@ public:
     int setNonBlocking(bool on);
     //int read_non_blocking(void *buf, unsigned nbyte);
     virtual int write(const void *buf, unsigned nbyte);
+    // write all parts with as few system calls as possible,
+    // returns false if the socket failed
+    virtual bool writev(const SocketBuffer *buffers, int count);
     int get_id() const
     {
         return sock_id;
@@ -222,6 +234,7 @@ public:
     //int accept(SSLSocket* sock);
 
     int write(const void *buf, unsigned int nbyte);
+    bool writev(const SocketBuffer *buffers, int count);
     int connect(sockaddr_in addr /*, int retries, double timeout*/);
 
     SSLServerConnection *spawnConnection(SSLConnection::PasswordCallback *cb, void *userData, const SSLConnection::KeyFiles &keyfiles);
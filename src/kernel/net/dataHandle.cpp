@@ -104,6 +104,11 @@ void DataHandle::movePtr(int amount)
     checkPtr();
 }
 
+bool DataHandle::isUniqueOwner() const
+{
+    return m_ManagedData && m_ManagedData.use_count() == 1 && m_dataPtr == m_ManagedData.get();
+}
+
 void DataHandle::checkPtr() const
 {
 
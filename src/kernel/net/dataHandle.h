@@ -34,6 +34,8 @@ public:
     void incLength(const int inc);
     void movePtr(int amount);
     int getLength() const {return m_length;};
+    //whether this is the only handle to memory it has to delete
+    bool isUniqueOwner() const;
 protected:
     //char* m_dataSection = nullptr;
 	std::shared_ptr<char> m_ManagedData;
@@ -15,6 +15,9 @@
 #include <util/coErr.h>
 #include <util/byteswap.h>
 
+#include <algorithm>
+#include <limits>
+
 /*
  $Log: covise_msg.C,v $
 Revision 1.3  1994/03/23  18:07:03  zrf30125
@@ -289,6 +292,30 @@ TokenBuffer &TokenBuffer::operator=(const TokenBuffer &other)
 	return *this;
 }
 
+TokenBuffer::TokenBuffer(TokenBuffer &&other)
+    : data(other.data)
+    , debug(other.debug)
+    , buflen(other.buflen)
+    , currdata(other.currdata)
+    , networkByteOrder(other.networkByteOrder)
+{
+    other.reset();
+}
+
+TokenBuffer &TokenBuffer::operator=(TokenBuffer &&other)
+{
+    if (this != &other)
+    {
+        data = other.data;
+        debug = other.debug;
+        currdata = other.currdata;
+        buflen = other.buflen;
+        networkByteOrder = other.networkByteOrder;
+        other.reset();
+    }
+    return *this;
+}
+
 bool TokenBuffer::operator==(const TokenBuffer &other) const
 {
     return currdata == other.currdata;
@@ -525,7 +552,12 @@ void TokenBuffer::incbuf(int size)
     assert((buflen==0 && !data.data()) || (buflen>0 && data.data()));
     assert(!data.data() || data.end() == currdata);
 
-    buflen += size;
+    // grow geometrically, so that adding many tokens does not copy the
+    // contents again and again
+    if (buflen < std::numeric_limits<int>::max() / 2)
+        buflen = std::max(buflen + size, 2 * buflen);
+    else
+        buflen += size;
 #ifdef TB_DEBUG_TAG
     if (!data.data())
         buflen += 1;
@@ -553,6 +585,214 @@ void TokenBuffer::incbuf(int size)
 TokenBuffer::~TokenBuffer()
 {
 }
+
+void TokenBuffer::reserve(int n)
+{
+    if (!data.data())
+        incbuf(n);
+    else if (buflen < data.length() + n)
+        incbuf(data.length() + n - buflen);
+}
+
+int TokenBuffer::capacity() const
+{
+    return buflen;
+}
+
+void TokenBuffer::clear()
+{
+    if (!data.isUniqueOwner() || buflen == 0)
+    {
+        reset();
+        return;
+    }
+#ifdef TB_DEBUG
+    debug = true;
+#else
+    debug = false;
+#endif
+#ifdef TB_DEBUG_TAG
+    data.accessData()[0] = debug;
+    data.setLength(1);
+#else
+    data.setLength(0);
+#endif
+    currdata = data.end();
+}
+
+namespace
+{
+// copy n elements and reverse the bytes of each, the compiler turns the
+// shifts into byte swap instructions and vectorizes the loop
+void copySwapped(uint32_t *dst, const uint32_t *src, int n)
+{
+    for (int i = 0; i < n; ++i)
+    {
+        uint32_t v = src[i];
+        dst[i] = (v >> 24) | ((v >> 8) & 0xff00) | ((v << 8) & 0xff0000) | (v << 24);
+    }
+}
+
+void copySwapped(uint64_t *dst, const uint64_t *src, int n)
+{
+    for (int i = 0; i < n; ++i)
+    {
+        uint64_t v = src[i];
+        v = ((v >> 8) & 0x00ff00ff00ff00ffull) | ((v & 0x00ff00ff00ff00ffull) << 8);
+        v = ((v >> 16) & 0x0000ffff0000ffffull) | ((v & 0x0000ffff0000ffffull) << 16);
+        dst[i] = (v >> 32) | (v << 32);
+    }
+}
+
+void copyArray(char *dst, const char *src, int n, int size, bool swap)
+{
+    memcpy(dst, src, (size_t)n * size);
+    if (!swap)
+        return;
+    // swap in place, the token data is not aligned
+    const int chunk = 1024;
+    if (size == 4)
+    {
+        uint32_t tmp[chunk];
+        for (int i = 0; i < n; i += chunk)
+        {
+            int m = std::min(chunk, n - i);
+            memcpy(tmp, dst + (size_t)i * 4, m * 4);
+            copySwapped(tmp, tmp, m);
+            memcpy(dst + (size_t)i * 4, tmp, m * 4);
+        }
+    }
+    else if (size == 8)
+    {
+        uint64_t tmp[chunk];
+        for (int i = 0; i < n; i += chunk)
+        {
+            int m = std::min(chunk, n - i);
+            memcpy(tmp, dst + (size_t)i * 8, m * 8);
+            copySwapped(tmp, tmp, m);
+            memcpy(dst + (size_t)i * 8, tmp, m * 8);
+        }
+    }
+    else
+    {
+        assert(size == 1);
+    }
+}
+}
+
+void TokenBuffer::putArray(const void *values, int n, int size)
+{
+    puttype(TbArray);
+    *this << (uint32_t)n;
+    *this << (char)size;
+
+    int nbytes = n * size;
+    if (buflen < data.length() + nbytes + 1)
+        incbuf(nbytes + 1);
+    // tokens are little endian, or big endian in network byte order
+    copyArray(currdata, (const char *)values, n, size, networkByteOrder == machineIsLittleEndian());
+    currdata += nbytes;
+    data.incLength(nbytes);
+}
+
+void TokenBuffer::getArray(void *values, int n, int size)
+{
+    checktype(TbArray);
+    uint32_t count = 0;
+    *this >> count;
+    char elemSize = 0;
+    *this >> elemSize;
+    if ((int)count != n || elemSize != size)
+    {
+        std::cerr << "TokenBuffer::getArray: ERROR: expecting " << n << " elements of size " << size << ", have " << count << " of size " << (int)elemSize << std::endl;
+        assert(0 == "array size mismatch");
+        abort();
+    }
+
+    int nbytes = n * size;
+    if (currdata + nbytes > data.end())
+    {
+        std::cerr << "TokenBuffer: read past end (" << __FILE__ << ":" << __LINE__ << ")" << std::endl;
+        std::cerr << "  required: " << nbytes << ", available: " << data.end() - currdata << std::endl;
+        assert(0 == "read past end");
+        abort();
+    }
+    copyArray((char *)values, currdata, n, size, networkByteOrder == machineIsLittleEndian());
+    currdata += nbytes;
+}
+
+int TokenBuffer::getArrayLength()
+{
+    char *start = currdata;
+    checktype(TbArray);
+    uint32_t count = 0;
+    *this >> count;
+    currdata = start;
+    return (int)count;
+}
+
+TokenBuffer &TokenBuffer::addArray(const float *values, int n)
+{
+    putArray(values, n, sizeof(float));
+    return *this;
+}
+
+TokenBuffer &TokenBuffer::addArray(const double *values, int n)
+{
+    putArray(values, n, sizeof(double));
+    return *this;
+}
+
+TokenBuffer &TokenBuffer::addArray(const int *values, int n)
+{
+    putArray(values, n, sizeof(int));
+    return *this;
+}
+
+TokenBuffer &TokenBuffer::getArray(float *values, int n)
+{
+    getArray((void *)values, n, sizeof(float));
+    return *this;
+}
+
+TokenBuffer &TokenBuffer::getArray(double *values, int n)
+{
+    getArray((void *)values, n, sizeof(double));
+    return *this;
+}
+
+TokenBuffer &TokenBuffer::getArray(int *values, int n)
+{
+    getArray((void *)values, n, sizeof(int));
+    return *this;
+}
+
+TokenBufferPool::TokenBufferPool(size_t maxBuffers)
+    : m_maxBuffers(maxBuffers)
+{
+}
+
+TokenBuffer TokenBufferPool::acquire(bool nbo)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (m_free.empty())
+        return TokenBuffer(nbo);
+    TokenBuffer tb(std::move(m_free.back()));
+    m_free.pop_back();
+    tb.networkByteOrder = nbo;
+    return tb;
+}
+
+void TokenBufferPool::release(TokenBuffer &&tb)
+{
+    TokenBuffer buf(std::move(tb));
+    buf.clear();
+    if (buf.capacity() == 0)
+        return;
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (m_free.size() < m_maxBuffers)
+        m_free.push_back(std::move(buf));
+}
 TokenBuffer &TokenBuffer::operator<<(const double f)
 {
     puttype(TbDouble);
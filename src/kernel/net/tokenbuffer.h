@@ -13,7 +13,9 @@
 #include <string.h>
 #include <stdio.h>
 #include <iostream>
+#include <mutex>
 #include <string>
+#include <vector>
 
 
 #include <util/coExport.h>
@@ -77,6 +79,7 @@ class DataHandle;
 
 class NETEXPORT TokenBuffer// class for tokens
 {
+    friend class TokenBufferPool;
 private:
     enum Types
     {
@@ -89,6 +92,7 @@ private:
         TbChar,
         TbTB, //TokenBuffer or DataHandle
         TbBinary,
+        TbArray,
     };
     DataHandle data;
     void puttype(Types t);
@@ -101,6 +105,8 @@ private:
     bool networkByteOrder = false;
 
     void incbuf(int size = 100);
+    void putArray(const void *values, int n, int size);
+    void getArray(void *values, int n, int size);
 
 public:
     TokenBuffer();
@@ -111,11 +117,20 @@ public:
     TokenBuffer(const MessageBase *msg, bool nbo = false);
     TokenBuffer(const DataHandle& dh, bool nbo = false);
     TokenBuffer(const char *dat, int len, bool nbo = false);
+    TokenBuffer(const TokenBuffer &other) = default;
+    TokenBuffer(TokenBuffer &&other);
     virtual ~TokenBuffer();
     TokenBuffer &operator=(const TokenBuffer &other);
+    TokenBuffer &operator=(TokenBuffer &&other);
     bool operator==(const TokenBuffer &other) const;
 
     const DataHandle& getData();
+    //make room for at least n more bytes without reallocating
+    void reserve(int n);
+    //remove all tokens, keeps the allocated memory if it is not shared
+    void clear();
+    //number of allocated bytes
+    int capacity() const;
     const char *getBinary(int n);
     void addBinary(const char *buf, int n);
     const char *allocBinary(int n);
@@ -152,6 +167,16 @@ public:
     TokenBuffer &operator>>(const char *&c);
     TokenBuffer& operator>>(DataHandle& d);
     TokenBuffer &operator>>(TokenBuffer &tb);
+
+    //arrays are copied as a whole, n has to be the same when reading
+    TokenBuffer &addArray(const float *values, int n);
+    TokenBuffer &addArray(const double *values, int n);
+    TokenBuffer &addArray(const int *values, int n);
+    TokenBuffer &getArray(float *values, int n);
+    TokenBuffer &getArray(double *values, int n);
+    TokenBuffer &getArray(int *values, int n);
+    //number of elements of the array at the current position
+    int getArrayLength();
     
     class NETEXPORT PlaceHolderBase {
     protected:
@@ -202,6 +227,24 @@ public:
     void reset();
     void rewind();
 };
+
+//recycles the memory of TokenBuffers for senders of many messages,
+//may be used from several threads
+class NETEXPORT TokenBufferPool
+{
+public:
+    //maxBuffers: number of idle buffers kept
+    explicit TokenBufferPool(size_t maxBuffers = 16);
+    //an empty TokenBuffer, with memory of a released one if available
+    TokenBuffer acquire(bool nbo = false);
+    //return the memory of tb, unless it is still shared with a message
+    void release(TokenBuffer &&tb);
+
+private:
+    std::mutex m_mutex;
+    std::vector<TokenBuffer> m_free;
+    size_t m_maxBuffers;
+};
 }
 
 #endif
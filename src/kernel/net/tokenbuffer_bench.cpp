@@ -0,0 +1,195 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+// time to write and read TokenBuffers: single tokens, strings, float arrays
+// token by token and as a whole in both byte orders, the serializer
+// templates for standard containers and buffers recycled by TokenBufferPool
+//
+// usage: tokenBufferBench [elements]
+
+#include "tokenbuffer.h"
+#include "tokenbuffer_serializer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace covise;
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void report(const char *name, double seconds, size_t bytes)
+{
+    printf("%-36s %9.3f ms %9.1f MB/s\n", name, seconds * 1e3, bytes / seconds / 1024. / 1024.);
+}
+
+static bool benchInts(int n)
+{
+    auto start = std::chrono::steady_clock::now();
+    TokenBuffer tb;
+    for (int i = 0; i < n; ++i)
+        tb << i;
+    report("write int tokens", seconds_since(start), tb.getData().length());
+
+    start = std::chrono::steady_clock::now();
+    TokenBuffer rb(tb.getData());
+    bool ok = true;
+    for (int i = 0; i < n; ++i)
+    {
+        int v = 0;
+        rb >> v;
+        ok = ok && v == i;
+    }
+    report("read int tokens", seconds_since(start), tb.getData().length());
+    return ok;
+}
+
+static bool benchStrings(int n)
+{
+    std::string s(40, 'x');
+    auto start = std::chrono::steady_clock::now();
+    TokenBuffer tb;
+    for (int i = 0; i < n / 10; ++i)
+        tb << s;
+    report("write 40 byte strings", seconds_since(start), tb.getData().length());
+
+    TokenBuffer rb(tb.getData());
+    bool ok = true;
+    for (int i = 0; i < n / 10; ++i)
+    {
+        std::string r;
+        rb >> r;
+        ok = ok && r == s;
+    }
+    return ok;
+}
+
+static bool benchFloats(int n, bool nbo)
+{
+    std::vector<float> values(n);
+    for (int i = 0; i < n; ++i)
+        values[i] = i * 0.5f;
+
+    auto start = std::chrono::steady_clock::now();
+    TokenBuffer single(nbo);
+    for (int i = 0; i < n; ++i)
+        single << values[i];
+    report(nbo ? "write float tokens, nbo" : "write float tokens", seconds_since(start), single.getData().length());
+
+    start = std::chrono::steady_clock::now();
+    TokenBuffer bulk(nbo);
+    bulk.addArray(values.data(), n);
+    report(nbo ? "write float array, nbo" : "write float array", seconds_since(start), bulk.getData().length());
+
+    bool ok = true;
+    std::vector<float> read(n);
+    start = std::chrono::steady_clock::now();
+    TokenBuffer rs(single.getData(), nbo);
+    for (int i = 0; i < n; ++i)
+        rs >> read[i];
+    report(nbo ? "read float tokens, nbo" : "read float tokens", seconds_since(start), single.getData().length());
+    ok = ok && read == values;
+
+    start = std::chrono::steady_clock::now();
+    TokenBuffer rb(bulk.getData(), nbo);
+    ok = ok && rb.getArrayLength() == n;
+    rb.getArray(read.data(), n);
+    report(nbo ? "read float array, nbo" : "read float array", seconds_since(start), bulk.getData().length());
+    ok = ok && read == values;
+    return ok;
+}
+
+static bool benchSerializer(int n)
+{
+    std::vector<float> vec(n);
+    for (int i = 0; i < n; ++i)
+        vec[i] = (float)i;
+    std::map<std::string, int> map;
+    for (int i = 0; i < n / 10; ++i)
+        map["key" + std::to_string(i)] = i;
+
+    auto start = std::chrono::steady_clock::now();
+    TokenBuffer tb;
+    serialize(tb, vec);
+    serialize(tb, map);
+    report("serialize vector, map", seconds_since(start), tb.getData().length());
+
+    std::vector<float> vec2;
+    std::map<std::string, int> map2;
+    start = std::chrono::steady_clock::now();
+    TokenBuffer rb(tb.getData());
+    deserialize(rb, vec2);
+    deserialize(rb, map2);
+    report("deserialize vector, map", seconds_since(start), tb.getData().length());
+    return vec == vec2 && map == map2;
+}
+
+static bool benchPool(int n)
+{
+    const int messages = 10000;
+    const int ints = std::max(n / 1000, 1);
+
+    auto start = std::chrono::steady_clock::now();
+    size_t bytes = 0;
+    for (int m = 0; m < messages; ++m)
+    {
+        TokenBuffer tb;
+        for (int i = 0; i < ints; ++i)
+            tb << i;
+        bytes += tb.getData().length();
+    }
+    report("messages, new buffers", seconds_since(start), bytes);
+
+    TokenBufferPool pool;
+    bool ok = true;
+    start = std::chrono::steady_clock::now();
+    bytes = 0;
+    for (int m = 0; m < messages; ++m)
+    {
+        TokenBuffer tb = pool.acquire();
+        for (int i = 0; i < ints; ++i)
+            tb << i;
+        bytes += tb.getData().length();
+        if (m == messages - 1)
+        {
+            TokenBuffer rb(tb.getData());
+            for (int i = 0; i < ints; ++i)
+            {
+                int v = -1;
+                rb >> v;
+                ok = ok && v == i;
+            }
+        }
+        pool.release(std::move(tb));
+    }
+    report("messages, pooled buffers", seconds_since(start), bytes);
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    int n = argc > 1 ? atoi(argv[1]) : 1000000;
+    if (n < 10)
+        n = 10;
+
+    bool ok = true;
+    ok = benchInts(n) && ok;
+    ok = benchStrings(n) && ok;
+    ok = benchFloats(n, false) && ok;
+    ok = benchFloats(n, true) && ok;
+    ok = benchSerializer(n) && ok;
+    ok = benchPool(n) && ok;
+    if (!ok)
+        printf("MISMATCH between written and read values\n");
+    return ok ? 0 : 1;
+}
@@ -24,6 +24,9 @@
 #include <do/coDoIntArr.h>
 
 #include <util/unixcompat.h>
+#include <util/coThreadPool.h>
+
+#include <algorithm>
 
 #ifdef _WIN32
 #include <io.h>
@@ -53,6 +56,33 @@ typedef struct
     int zs;
 } STR_HEADER;
 
+// Files written by WriteFile end with a table of contents behind the
+// object stream, so that readers which do not know about it still read the
+// objects as before:
+//   zero padding up to a multiple of TOC_ALIGN
+//   TOC_MAGIC, int64 number of entries, CoviseIO::TocEntry[number of entries]
+//   int64 offset of TOC_MAGIC at the start of the table, TOC_MAGIC
+// in the byte order of the machine that wrote the file.
+static const char TOC_MAGIC[8] = { 'C', 'O', 'V', 'T', 'O', 'C', '0', '1' };
+static const int TOC_ALIGN = 64;
+
+template <class T>
+static void swapBytes(T &value)
+{
+    char *b = reinterpret_cast<char *>(&value);
+    std::reverse(b, b + sizeof(T));
+}
+
+static bool readFully(int fd, void *buf, size_t size)
+{
+    return read(fd, buf, size) == (ssize_t)size;
+}
+
+static bool writeFully(int fd, const void *buf, size_t size)
+{
+    return write(fd, buf, size) == (ssize_t)size;
+}
+
 int CoviseIO::WriteFile(const char *filename, const coDistributedObject *Object)
 {
     if (filename != NULL)
@@ -67,7 +97,10 @@ int CoviseIO::WriteFile(const char *filename, const coDistributedObject *Object)
 
         // Write the object
         writeobj(fd, Object);
+        writeToc(fd);
         objectNameList.clear();
+        tocEntries.clear();
+        openEntries.clear();
 
         return covCloseOutFile(fd);
     }
@@ -96,7 +129,9 @@ coDistributedObject *CoviseIO::ReadFile(const char *filename, const char *object
         skipSteps = skipNumSteps;
         setsRead = 0;
 
+        readToc(fd);
         tmp_obj = readData(fd, objectName);
+        toc.reset();
         ObjectList::iterator it = objectList.begin();
         it++; // das erste darf nicht geloescht werden, das wird spaeter von simple module gemacht.
         if (it != objectList.end())
@@ -139,6 +174,12 @@ void CoviseIO::writeobj(int fd, const coDistributedObject *data_obj)
             {
                 //we found it so insert a reference
                 covWriteOBJREF(fd, n);
+                for (size_t e = 0; e < openEntries.size(); e++)
+                {
+                    TocEntry &entry = tocEntries[openEntries[e]];
+                    if (entry.firstRef < 0 || n < entry.firstRef)
+                        entry.firstRef = n;
+                }
                 return; // that is all
             }
             n++;
@@ -146,6 +187,14 @@ void CoviseIO::writeobj(int fd, const coDistributedObject *data_obj)
     }
     // store the object name in a list for later reference if this object has been referenced
     objectNameList.push_back(std::string(data_obj->getName()));
+    TocEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.offset = ltell64(abs(fd));
+    entry.parent = openEntries.empty() ? -1 : openEntries.back();
+    entry.firstRef = -1;
+    strncpy(entry.type, data_obj->getType(), sizeof(entry.type) - 1);
+    openEntries.push_back((int)tocEntries.size());
+    tocEntries.push_back(entry);
     if (data_obj != 0L)
     {
         gtype = data_obj->getType();
@@ -447,6 +496,165 @@ void CoviseIO::writeobj(int fd, const coDistributedObject *data_obj)
     {
         Covise::sendError("ERROR: object name not correct for 'mesh_in'");
     }
+    TocEntry &written = tocEntries[openEntries.back()];
+    written.size = ltell64(abs(fd)) - written.offset;
+    openEntries.pop_back();
+}
+
+void CoviseIO::writeToc(int fd)
+{
+    int64_t pos = ltell64(abs(fd));
+    if (pos < 0)
+        return;
+    char padding[TOC_ALIGN] = { 0 };
+    size_t numPad = (TOC_ALIGN - pos % TOC_ALIGN) % TOC_ALIGN;
+    int64_t tocOffset = pos + numPad;
+    int64_t numEntries = tocEntries.size();
+    bool ok = writeFully(abs(fd), padding, numPad)
+              && writeFully(abs(fd), TOC_MAGIC, sizeof(TOC_MAGIC))
+              && writeFully(abs(fd), &numEntries, sizeof(numEntries))
+              && (tocEntries.empty() || writeFully(abs(fd), &tocEntries[0], tocEntries.size() * sizeof(TocEntry)))
+              && writeFully(abs(fd), &tocOffset, sizeof(tocOffset))
+              && writeFully(abs(fd), TOC_MAGIC, sizeof(TOC_MAGIC));
+    if (!ok)
+        Covise::sendError("failed to write table of contents to %s: %s", grid_Path.c_str(), strerror(errno));
+}
+
+// load the table of contents if the file has one, leaving the file position untouched
+bool CoviseIO::readToc(int fd)
+{
+    toc.reset();
+    int64_t pos = ltell64(abs(fd));
+    int64_t end = lseek64(abs(fd), 0, SEEK_END);
+    bool swap = fd < 0;
+    std::shared_ptr<Toc> t(new Toc);
+    const int64_t trailerSize = sizeof(int64_t) + sizeof(TOC_MAGIC);
+    int64_t tocOffset = -1, numEntries = -1;
+    char magic[sizeof(TOC_MAGIC)];
+    bool ok = pos >= 0 && end >= pos + trailerSize
+              && lseek64(abs(fd), end - trailerSize, SEEK_SET) >= 0
+              && readFully(abs(fd), &tocOffset, sizeof(tocOffset))
+              && readFully(abs(fd), magic, sizeof(magic))
+              && memcmp(magic, TOC_MAGIC, sizeof(magic)) == 0;
+    if (ok)
+    {
+        if (swap)
+            swapBytes(tocOffset);
+        ok = tocOffset > 0 && tocOffset % TOC_ALIGN == 0
+             && tocOffset + (int64_t)sizeof(TOC_MAGIC) + (int64_t)sizeof(numEntries) + trailerSize <= end
+             && lseek64(abs(fd), tocOffset, SEEK_SET) >= 0
+             && readFully(abs(fd), magic, sizeof(magic))
+             && memcmp(magic, TOC_MAGIC, sizeof(magic)) == 0
+             && readFully(abs(fd), &numEntries, sizeof(numEntries));
+    }
+    if (ok)
+    {
+        if (swap)
+            swapBytes(numEntries);
+        ok = numEntries >= 0
+             && tocOffset + (int64_t)sizeof(TOC_MAGIC) + (int64_t)sizeof(numEntries) + numEntries * (int64_t)sizeof(TocEntry) + trailerSize == end;
+    }
+    if (ok)
+    {
+        t->entries.resize(numEntries);
+        ok = numEntries == 0 || readFully(abs(fd), &t->entries[0], numEntries * sizeof(TocEntry));
+    }
+    lseek64(abs(fd), pos, SEEK_SET);
+    if (!ok)
+        return false; // legacy file
+
+    t->children.resize(numEntries);
+    for (int i = 0; i < numEntries; i++)
+    {
+        TocEntry &entry = t->entries[i];
+        if (swap)
+        {
+            swapBytes(entry.offset);
+            swapBytes(entry.size);
+            swapBytes(entry.parent);
+            swapBytes(entry.firstRef);
+        }
+        if (entry.offset < 0 || entry.size < 0 || entry.offset + entry.size > tocOffset || entry.parent >= i)
+            return false;
+        if (entry.parent >= 0)
+            t->children[entry.parent].push_back(i);
+        t->index[entry.offset] = i;
+    }
+    toc = t;
+    return true;
+}
+
+// read numsteps elements of the set described by the table of contents
+// entry starting at startstep, leaving out skipSteps elements after each,
+// and position the file behind the last element
+coDistributedObject **CoviseIO::readSetElements(int fd, const char *Name, int entry, int numsets, int startstep, int numsteps)
+{
+    const std::vector<int> &children = toc->children[entry];
+    std::vector<int> steps;
+    for (int i = startstep; i < numsets && (int)steps.size() < numsteps; i += skipSteps + 1)
+        steps.push_back(children[i]);
+
+    coDistributedObject **tmp_objs = new coDistributedObject *[numsets + 1];
+    std::fill(tmp_objs, tmp_objs + numsets + 1, (coDistributedObject *)NULL);
+
+    // elements only referring to objects within themselves can be read
+    // independently of each other, each with a file descriptor of its own
+    bool independent = steps.size() > 1 && !coThreadPool::inParallelRegion()
+                       && coThreadPool::global().numThreads() > 1;
+    for (size_t i = 0; i < steps.size() && independent; i++)
+    {
+        int ref = toc->entries[steps[i]].firstRef;
+        independent = ref < 0 || ref >= steps[i];
+    }
+
+    char buf[300];
+    if (independent)
+    {
+        std::vector<ObjectList> objects(steps.size());
+        coThreadPool::global().run(steps.size(), [&](size_t i, int)
+                                   {
+                                       CoviseIO reader;
+                                       reader.grid_Path = grid_Path;
+                                       reader.force = force;
+                                       reader.setsRead = 1;
+                                       reader.skipSteps = 0;
+                                       reader.toc = toc;
+                                       int elemFd = ::covOpenInFile(const_cast<char *>(grid_Path.c_str()));
+                                       if (!elemFd)
+                                       {
+                                           Covise::sendError("failed to open %s for reading: %s", grid_Path.c_str(), strerror(errno));
+                                           return;
+                                       }
+                                       char name[300];
+                                       sprintf(name, "%s_%d", Name, (int)i);
+                                       lseek64(abs(elemFd), toc->entries[steps[i]].offset, SEEK_SET);
+                                       tmp_objs[i] = reader.readData(elemFd, name);
+                                       ::covCloseInFile(elemFd);
+                                       objects[i].swap(reader.objectList);
+                                   });
+        for (size_t i = 0; i < steps.size(); i++)
+            objectList.insert(objectList.end(), objects[i].begin(), objects[i].end());
+    }
+    else
+    {
+        for (size_t i = 0; i < steps.size(); i++)
+        {
+            sprintf(buf, "%s_%d", Name, (int)i);
+            lseek64(abs(fd), toc->entries[steps[i]].offset, SEEK_SET);
+            tmp_objs[i] = readData(fd, buf);
+        }
+    }
+    // read failures terminate the list of elements, as when reading sequentially
+    for (size_t i = 0; i < steps.size(); i++)
+        if (!tmp_objs[i])
+            std::fill(tmp_objs + i, tmp_objs + steps.size(), (coDistributedObject *)NULL);
+
+    if (numsets > 0)
+    {
+        const TocEntry &last = toc->entries[children[numsets - 1]];
+        lseek64(abs(fd), last.offset + last.size, SEEK_SET);
+    }
+    return tmp_objs;
 }
 
 void CoviseIO::readattrib(int fd, coDistributedObject *tmp_Object)
@@ -509,6 +717,23 @@ coDistributedObject *CoviseIO::readData(int fd, const char *Name)
             // find the object in the object list, if we did not skip it, just return it, otherwise go back and read it.
             int objNum;
             covReadOBJREF(fd, &objNum);
+            if (toc && objNum >= 0 && objNum < (int)toc->entries.size())
+            {
+                int64_t offset = toc->entries[objNum].offset;
+                for (size_t n = 0; n < infoIndex; n++)
+                {
+                    if (objectList[n].fileOffset == offset && objectList[n].obj)
+                    {
+                        objectList[n].obj->incRefCount();
+                        return objectList[n].obj;
+                    }
+                }
+                int64_t currentPos = ltell64(abs(fd));
+                lseek64(abs(fd), offset, SEEK_SET);
+                coDistributedObject *obj = readData(fd, Name);
+                lseek64(abs(fd), currentPos, SEEK_SET);
+                return obj;
+            }
             int n = 0;
             for (ObjectList::iterator it = objectList.begin(); it != objectList.end() && n <= objNum; it++)
             {
@@ -562,28 +787,43 @@ coDistributedObject *CoviseIO::readData(int fd, const char *Name)
             }
             setsRead++;
 
-            tmp_objs = new coDistributedObject *[numsets + 1];
-            for (i = 0; i < startstep; i++)
+            // with a table of contents the chosen elements are accessed directly
+            int entry = -1;
+            if (toc)
+            {
+                std::map<int64_t, int>::const_iterator it = toc->index.find(objectList[infoIndex].fileOffset);
+                if (it != toc->index.end() && (int)toc->children[it->second].size() == numsets)
+                    entry = it->second;
+            }
+            if (entry >= 0)
             {
-                skipData(fd);
+                tmp_objs = readSetElements(fd, Name, entry, numsets, startstep, endstep - startstep + 1);
             }
-            int readStep = 0;
-            for (i = 0; i <= endstep - startstep; i++)
+            else
             {
-                sprintf(buf, "%s_%d", Name, readStep);
-                tmp_objs[readStep] = readData(fd, buf);
-                tmp_objs[readStep + 1] = NULL;
-                readStep++;
-                for (int n = 0; n < skipSteps && i < endstep - startstep; n++)
+                tmp_objs = new coDistributedObject *[numsets + 1];
+                for (i = 0; i < startstep; i++)
                 {
                     skipData(fd);
                 }
+                int readStep = 0;
+                for (i = 0; i <= endstep - startstep; i++)
+                {
+                    sprintf(buf, "%s_%d", Name, readStep);
+                    tmp_objs[readStep] = readData(fd, buf);
+                    tmp_objs[readStep + 1] = NULL;
+                    readStep++;
+                    for (int n = 0; n < skipSteps && i < endstep - startstep; n++)
+                    {
+                        skipData(fd);
+                    }
+                }
+                for (i = endstep + 1; i < numsets; i++)
+                {
+                    skipData(fd);
+                }
+                tmp_objs[i] = NULL;
             }
-            for (i = endstep + 1; i < numsets; i++)
-            {
-                skipData(fd);
-            }
-            tmp_objs[i] = NULL;
             set = new coDoSet(coObjInfo(Name), tmp_objs);
             if (!(set->objectOk()))
             {
@@ -13,7 +13,10 @@
 #include <file/covWriteFiles.h>
 #include <file/covReadFiles.h>
 #include <do/coDoData.h>
+#include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace covise
 {
@@ -50,6 +53,24 @@ private:
     typedef std::vector<doInfo> ObjectList;
     typedef std::list<std::string> ObjectNameList;
 
+    // table of contents appended to the object stream by WriteFile,
+    // one entry per object in the order in which they are written, so that
+    // the index of an entry is the number used by OBJREF
+    struct TocEntry
+    {
+        int64_t offset; // start of the object in the file
+        int64_t size; // bytes up to the end of its attributes
+        int32_t parent; // index of the enclosing object, -1 at the top level
+        int32_t firstRef; // smallest index referenced from within the object, -1 if none
+        char type[8];
+    };
+    struct Toc
+    {
+        std::vector<TocEntry> entries;
+        std::vector<std::vector<int> > children;
+        std::map<int64_t, int> index; // offset -> entry
+    };
+
     //  Local data
     int n_coord, n_elem, n_conn;
     int *el, *vl, *tl;
@@ -89,9 +110,15 @@ private:
     coDistributedObject *readData(int fd, const char *Name);
     void skipData(int fd);
     void writeobj(int fd, const coDistributedObject *tmp_Object);
+    void writeToc(int fd);
+    bool readToc(int fd);
+    coDistributedObject **readSetElements(int fd, const char *Name, int entry, int numsets, int startstep, int numsteps);
     bool force;
     ObjectNameList objectNameList;
     ObjectList objectList;
+    std::vector<TocEntry> tocEntries; // while writing
+    std::vector<int> openEntries; // objects being written
+    std::shared_ptr<const Toc> toc; // while reading a file with a table of contents
 
 protected:
     virtual int covOpenInFile(const char *grid_Path);
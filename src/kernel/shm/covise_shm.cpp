@@ -13,6 +13,9 @@
 #include <stdio.h>
 #include <string>
 #include <iostream>
+#include <algorithm>
+#include <memory>
+#include <vector>
 
 #ifdef SHARED_MEMORY
 #define SYSV_SHMEM
@@ -74,7 +77,8 @@ List<MMapEntry> *Malloc_tmp::mmaplist = new List<MMapEntry>;
 ShmConfig *ShmConfig::theShmConfig = NULL;
 int shmlist_exists = 0;
 List<SharedMemory> *SharedMemory::shmlist = 0L;
-SharedMemory **SharedMemory::shm_array = 0L;
+std::atomic<SharedMemory **> SharedMemory::shm_array(0L);
+int SharedMemory::shm_array_size = 0;
 int SharedMemory::global_seq_no = 0;
 SharedMemory *ShmAccess::shm = 0L;
 SharedMemory *coShmPtr::shmptr = 0L;
@@ -117,7 +121,7 @@ ShmConfig::ShmConfig()
     else
         minSegSize = 128 * 1024 * 1024 - 8;
     bool haveShmSizeConfig = false;
-    int minSegSizeConfig = coCoviseConfig::getInt("System.ShmSize", (int)minSegSize, &haveShmSizeConfig);
+    long minSegSizeConfig = coCoviseConfig::getLong("System.ShmSize", (long)minSegSize, &haveShmSizeConfig);
     if (haveShmSizeConfig)
     {
         minSegSize = minSegSizeConfig;
@@ -182,7 +186,7 @@ ShmConfig::ShmConfig()
                     size *= 1073741824;
             }
             if (readElem >= 4)
-                minSegSize = (int)size;
+                minSegSize = (size_t)size;
         }
     }
 }
@@ -193,7 +197,6 @@ shmCallback *SharedMemory::shmC = NULL;
 
 SharedMemory::SharedMemory(int shm_key, shmSizeType shm_size, int nD)
 {
-    SharedMemory **tmp_array;
     SharedMemory *last_shm;
     int tmp_perm;
     noDelete = nD;
@@ -267,7 +270,7 @@ SharedMemory::SharedMemory(int shm_key, shmSizeType shm_size, int nD)
     }
 #endif
 #endif
-    print_comment(__LINE__, __FILE__, "new SharedMemory; key: %x  size: %d", (unsigned)key, size);
+    print_comment(__LINE__, __FILE__, "new SharedMemory; key: %x  size: %llu", (unsigned)key, (unsigned long long)size);
     shmstate = valid;
 #ifdef SHARED_MEMORY
 #if defined(SYSV_SHMEM)
@@ -309,7 +312,7 @@ SharedMemory::SharedMemory(int shm_key, shmSizeType shm_size, int nD)
     std::string s = str.str();
     name = s.c_str();
 #endif
-    filemap = CreateFileMapping(handle, NULL, PAGE_READWRITE, 0, size, name);
+    filemap = CreateFileMapping(handle, NULL, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32), (DWORD)(size & 0xffffffff), name);
     if (!(data = (char *)MapViewOfFile(filemap, FILE_MAP_ALL_ACCESS, 0, 0, size)))
     {
         print_error(__LINE__, __FILE__, "Not enough disk space for CreateFileMapping file");
@@ -336,12 +339,7 @@ SharedMemory::SharedMemory(int shm_key, shmSizeType shm_size, int nD)
     }
     print_comment(__LINE__, __FILE__, "shmlist->add(this);");
     shmlist->add(this);
-    tmp_array = new SharedMemory *[global_seq_no];
-    for (int i = 0; i < global_seq_no - 1; i++)
-        tmp_array[i] = shm_array[i];
-    tmp_array[global_seq_no - 1] = this;
-    delete[] shm_array;
-    shm_array = tmp_array;
+    add_to_array(this);
 
     if (shmC)
     {
@@ -354,7 +352,6 @@ SharedMemory::SharedMemory(int shm_key, shmSizeType shm_size, int nD)
 SharedMemory::SharedMemory(int *shm_key, shmSizeType shm_size)
 {
     SharedMemory *tmpshm;
-    SharedMemory **tmp_array;
     SharedMemory *last_shm;
     char tmp_str[255];
 
@@ -438,7 +435,7 @@ SharedMemory::SharedMemory(int *shm_key, shmSizeType shm_size)
         FILE *hdl = fopen(tmp_fname, "a+");
         if (hdl)
         {
-            fprintf(hdl, "%d %x %d\n", shmid, key, size);
+            fprintf(hdl, "%d %x %llu\n", shmid, key, (unsigned long long)size);
             fclose(hdl);
         }
     }
@@ -460,7 +457,7 @@ SharedMemory::SharedMemory(int *shm_key, shmSizeType shm_size)
         FILE *hdl = fopen(tmp_fname, "a+");
         if (hdl)
         {
-            fprintf(hdl, "%d %x %d\n", -1, key, size);
+            fprintf(hdl, "%d %x %llu\n", -1, key, (unsigned long long)size);
             fclose(hdl);
         }
     }
@@ -480,7 +477,7 @@ SharedMemory::SharedMemory(int *shm_key, shmSizeType shm_size)
 #endif
     *shm_key = key;
 #ifdef DEBUG
-    sprintf(tmp_str, "new SharedMemory; key: %x  size: %d", key, size);
+    sprintf(tmp_str, "new SharedMemory; key: %x  size: %llu", key, (unsigned long long)size);
     print_comment(__LINE__, __FILE__, tmp_str);
 
 #endif
@@ -534,7 +531,7 @@ SharedMemory::SharedMemory(int *shm_key, shmSizeType shm_size)
 		std::string s = str.str();
 		name = s.c_str();
 #endif
-		filemap = CreateFileMapping(handle, NULL, PAGE_READWRITE, 0, size, name);
+		filemap = CreateFileMapping(handle, NULL, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32), (DWORD)(size & 0xffffffff), name);
 		if (filemap == NULL)
 		{
 			print_error(__LINE__, __FILE__, "Not enough disk space for CreateFileMapping file");
@@ -567,12 +564,7 @@ SharedMemory::SharedMemory(int *shm_key, shmSizeType shm_size)
         last_shm->next = this;
     }
     shmlist->add(this);
-    tmp_array = new SharedMemory *[global_seq_no];
-    for (int i = 0; i < global_seq_no - 1; i++)
-        tmp_array[i] = shm_array[i];
-    tmp_array[global_seq_no - 1] = this;
-    delete[] shm_array;
-    shm_array = tmp_array;
+    add_to_array(this);
     if (shmC)
     {
         (*shmC)(key, size, data);
@@ -582,6 +574,34 @@ SharedMemory::SharedMemory(int *shm_key, shmSizeType shm_size)
     //                    getpid(),key,size);
 }
 
+// tables replaced by add_to_array, other threads might still be indexing them
+static std::vector<std::unique_ptr<SharedMemory *[]> > replaced_tables;
+
+void SharedMemory::add_to_array(SharedMemory *shm)
+{
+    SharedMemory **array = shm_array.load();
+    if (global_seq_no > shm_array_size)
+    {
+        int size = std::max(16, 2 * shm_array_size);
+        SharedMemory **tmp_array = new SharedMemory *[size];
+        for (int i = 0; i < global_seq_no - 1; i++)
+            tmp_array[i] = array[i];
+        // doubling the size keeps the replaced tables below the size of the current one
+        if (array)
+            replaced_tables.emplace_back(array);
+        shm_array_size = size;
+        array = tmp_array;
+    }
+    array[global_seq_no - 1] = shm;
+    // publish the new entry together with the table
+    shm_array.store(array, std::memory_order_release);
+}
+
+void SharedMemory::release_replaced_tables()
+{
+    replaced_tables.clear();
+}
+
 SharedMemory::~SharedMemory()
 {
     SharedMemory *ptr;
@@ -787,25 +807,31 @@ int SharedMemory::detach()
     return 0;
 }
 
-void SharedMemory::get_shmlist(int *ptr)
+// fills ptr with the number of segments followed by (key, size) pairs,
+// size is stored as shmSizeType
+void SharedMemory::get_shmlist(char *ptr)
 {
     int i = 0;
 #ifdef DEBUG
     char tmp_str[255];
 #endif
     SharedMemory *shmptr;
+    char *cptr = ptr + sizeof(int);
 
     shmlist->reset();
     while ((shmptr = shmlist->next()))
     {
-        ptr[++i] = shmptr->key;
-        ptr[++i] = shmptr->size - 2 * sizeof(int); // pointer to a shared memory which is two integers larger seq_nr and key
+        *(int *)cptr = shmptr->key;
+        cptr += sizeof(int);
+        *(shmSizeType *)cptr = shmptr->size - 2 * sizeof(int); // pointer to a shared memory which is two integers larger seq_nr and key
+        cptr += sizeof(shmSizeType);
+        i++;
 #ifdef DEBUG
-        sprintf(tmp_str, "get_shmlist(%d, %d)", shmptr->key, shmptr->size);
+        sprintf(tmp_str, "get_shmlist(%d, %llu)", shmptr->key, (unsigned long long)shmptr->size);
         print_comment(__LINE__, __FILE__, tmp_str);
 #endif
     }
-    ptr[0] = i / 2;
+    *(int *)ptr = i;
 }
 
 void *Malloc_tmp::large_new(long size)
@@ -18,6 +18,7 @@
 #include <util/coLog.h>
 
 #include <util/covise_list.h>
+#include <atomic>
 //#include <net/covise_msg.h>
 #include <net/message.h>
 #include <covise/covise_global.h>
@@ -192,8 +193,24 @@ public:
     static void *large_new(long size);
     static void large_delete(void *);
 };
+#ifdef COVISE_SHM_64BIT
+// 64 bit offsets and array lengths: segments and arrays may exceed 4 GB
+typedef uint64_t shmSizeType;
+typedef uint64_t ArrayLengthType;
+#else
 typedef unsigned int shmSizeType;
 typedef unsigned int ArrayLengthType;
+#endif
+
+// layout of an array in shared memory:
+//   +------+--------+------+----
+//   | type | length | data | ...
+//   +------+--------+------+----
+// type is an int, padded to sizeof(ArrayLengthType) in order to keep the data aligned
+const size_t SHM_ARRAY_LENGTH_OFFSET = sizeof(ArrayLengthType);
+const size_t SHM_ARRAY_HEADER_SIZE = 2 * sizeof(ArrayLengthType);
+// number of ints needed for storing a (shm_seq_no, offset) pair
+const int SHM_PTR_INT_SIZE = int((sizeof(int) + sizeof(shmSizeType)) / sizeof(int));
 typedef void(shmCallback)(int shmKey, shmSizeType size, char *address);
 
 extern SHMEXPORT SharedMemory *get_shared_memory();
@@ -202,7 +219,11 @@ class SHMEXPORT SharedMemory
 {
     friend SHMEXPORT SharedMemory *get_shared_memory();
     friend class DataManagerProcess;
-    static class SharedMemory **shm_array;
+    // segments by seq_no - 1, read without locking while compute() runs on
+    // several threads: the table is replaced atomically when it has to grow
+    static std::atomic<SharedMemory **> shm_array;
+    static int shm_array_size;
+    static void add_to_array(SharedMemory *shm);
     static List<SharedMemory> *shmlist;
     static int global_seq_no;
     class SharedMemory *next;
@@ -233,6 +254,9 @@ public:
     SharedMemory(int *shm_key, shmSizeType shm_size);
     ~SharedMemory();
     static shmCallback *shmC;
+    // free the segment tables replaced while they might have been read by
+    // other threads: only call when no other thread accesses shared memory
+    static void release_replaced_tables();
     void *get_pointer(int no)
     {
         if (SharedMemory::shmlist)
@@ -267,7 +291,7 @@ public:
     {
         return size;
     };
-    void get_shmlist(int *);
+    void get_shmlist(char *);
     void print(){};
     static int num_attached()
     {
@@ -394,7 +418,7 @@ public:
     coShmPtr(Message *msg)
     {
         shm_seq_no = *(int *)msg->data.data();
-        offset = *(int *)(&msg->data.data()[sizeof(int)]);
+        offset = *(shmSizeType *)(&msg->data.data()[sizeof(int)]);
         recalc();
     };
     void setPtr(int no, shmSizeType o)
@@ -466,6 +490,16 @@ typedef coDataShm<float, FLOATSHM> coFloatShm;
 INST_TEMPLATE2(template class SHMEXPORT coDataShm<double, DOUBLESHM>)
 typedef coDataShm<double, DOUBLESHM> coDoubleShm;
 
+// counters of array entries stored in objects, e.g. the number of elements of a grid
+#ifdef COVISE_SHM_64BIT
+static_assert(sizeof(long) >= sizeof(ArrayLengthType), "COVISE_SHM_64BIT requires a 64 bit long");
+typedef coLongShm coArrayLengthShm;
+const int ARRAYLENGTHSHM = LONGSHM;
+#else
+typedef coIntShm coArrayLengthShm;
+const int ARRAYLENGTHSHM = INTSHM;
+#endif
+
 class SHMEXPORT coShmArray : public coShmItem
 {
 protected:
@@ -483,7 +517,7 @@ protected:
         {
             ptr = (void *)((char *)shmptr->get_pointer(shm_seq_no) + offset);
             type = *(int *)ptr;
-            length = *(int *)((char *)ptr + sizeof(int)); // int type ArrayLengthType length
+            length = *(ArrayLengthType *)((char *)ptr + SHM_ARRAY_LENGTH_OFFSET);
         }
         else
         {
@@ -511,7 +545,7 @@ public:
     coShmArray(Message *msg)
     {
         shm_seq_no = *(int *)msg->data.data();
-        offset = *(int *)(&msg->data.data()[sizeof(int)]);
+        offset = *(shmSizeType *)(&msg->data.data()[sizeof(int)]);
         recalc();
     }
     void set_length(ArrayLengthType l)
@@ -531,7 +565,7 @@ public:
     void *getDataPtr() const
     {
         if (ptr)
-            return (void *)((char *)ptr + sizeof(int) + sizeof(ArrayLengthType));
+            return (void *)((char *)ptr + SHM_ARRAY_HEADER_SIZE);
         // first integer holds type, second holds length
         else
         {
@@ -574,7 +608,7 @@ public:
     DataType &operator[](size_t i)
     {
         if (i >= 0 && i < length)
-            return ((DataType *)(((char *)ptr) + sizeof(int)+sizeof(ArrayLengthType)))[i];
+            return ((DataType *)(((char *)ptr) + SHM_ARRAY_HEADER_SIZE))[i];
         // else
         cerr << "Access error for coDataShmArray\n"
              << i << " not in 0.." << length - 1 << std::endl;
@@ -585,7 +619,7 @@ public:
     const DataType &operator[](size_t i) const
     {
         if (i >= 0 && i < length)
-            return ((DataType *)(((char *)ptr) + 2 * sizeof(int)))[i];
+            return ((DataType *)(((char *)ptr) + SHM_ARRAY_HEADER_SIZE))[i];
         // else
         cerr << "Access error for coDataShmArray\n"
              << i << " not in 0.." << length - 1 << std::endl;
@@ -649,21 +683,21 @@ public:
         : coDataShmArray<char *, STRINGSHMARRAY>(no, o)
     {
     }
-    char *operator[](unsigned int i);
-    const char *operator[](unsigned int i) const;
-    void stringPtrSet(int no, int sn, shmSizeType of)
+    char *operator[](ArrayLengthType i);
+    const char *operator[](ArrayLengthType i) const;
+    void stringPtrSet(ArrayLengthType no, int sn, shmSizeType of)
     {
         char *cptr = (char *)ptr;
-        int pos = 2*sizeof(int)/*(seq_nr+key)*/ + no*(sizeof(int)+sizeof(shmSizeType));
-        *((int *)(cptr+pos)) = sn;
-        *((int *)(cptr+pos+sizeof(int))) = of;
+        size_t pos = SHM_ARRAY_HEADER_SIZE /*(type+length)*/ + no * (sizeof(int) + sizeof(shmSizeType));
+        *((int *)(cptr + pos)) = sn;
+        *((shmSizeType *)(cptr + pos + sizeof(int))) = of;
     }
-    void stringPtrGet(int no, int *sn, shmSizeType *of)
+    void stringPtrGet(ArrayLengthType no, int *sn, shmSizeType *of)
     {
         char *cptr = (char *)ptr;
-        int pos = 2*sizeof(int)/*(seq_nr+key)*/ + no*(sizeof(int)+sizeof(shmSizeType));
-        *sn = *((int *)(cptr+pos));
-        *of = *((int *)(cptr+pos+sizeof(int)));
+        size_t pos = SHM_ARRAY_HEADER_SIZE /*(type+length)*/ + no * (sizeof(int) + sizeof(shmSizeType));
+        *sn = *((int *)(cptr + pos));
+        *of = *((shmSizeType *)(cptr + pos + sizeof(int)));
     }
 };
 }
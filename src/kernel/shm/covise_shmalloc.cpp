@@ -70,7 +70,7 @@ using namespace covise;
 
 void coShmItem::print()
 {
-    print_comment(__LINE__, __FILE__, "coShmItem shm_seq_no: %d  offset: %d", shm_seq_no, offset);
+    print_comment(__LINE__, __FILE__, "coShmItem shm_seq_no: %d  offset: %llu", shm_seq_no, (unsigned long long)offset);
 }
 
 ShmAccess::ShmAccess(int k)
@@ -114,29 +114,16 @@ void ShmAccess::add_new_segment(int k, shmSizeType size)
     // only detach
 }
 
-char *coStringShmArray::operator[](unsigned int i)
+char *coStringShmArray::operator[](ArrayLengthType i)
 {
-    char *tmpch;
     int sn;
     shmSizeType of;
-    coCharShmArray *tmparraych;
-    char *buf = (char *)(COVISE_POINTER_TYPE)ptr + 2 * sizeof(int);
-        // 2* sizeof(int) is seq_nr + key
-    
-    cerr << "check this, should be only two numbers, not three\n"
-         << i << " not in 0.." << length << endl;
 
     if (i < length)
     {
-        //old sn = (int)((COVISE_POINTER_TYPE)ptr + 2 * sizeof(int)) + 3 * i * sizeof(int) + 1;
-        //old of = (int)((COVISE_POINTER_TYPE)ptr + 2 * sizeof(int)) + 3 * i * sizeof(int) + 2;
-        sn = *(int *)(buf+sizeof(int));
-        of = *(shmSizeType *)(buf+sizeof(int)+sizeof(int));
-        buf += sizeof(int) + sizeof(int) + sizeof(shmSizeType);
-        tmparraych = new coCharShmArray(sn, of);
-        tmpch = (char *)tmparraych->getDataPtr();
-        delete tmparraych;
-        return tmpch;
+        stringPtrGet(i, &sn, &of);
+        coCharShmArray tmparraych(sn, of);
+        return (char *)tmparraych.getDataPtr();
     }
     //  else
     cerr << "Access error for coStringShmArray\n"
@@ -144,31 +131,7 @@ char *coStringShmArray::operator[](unsigned int i)
     return NULL;
 }
 
-const char *coStringShmArray::operator[](unsigned int i) const
+const char *coStringShmArray::operator[](ArrayLengthType i) const
 {
-    char *tmpch;
-    int sn;
-    shmSizeType of;
-    coCharShmArray *tmparraych;
-    char *buf = (char *)(COVISE_POINTER_TYPE)ptr + 2 * sizeof(int);
-        // 2* sizeof(int) is seq_nr + key
-    
-    cerr << "check this, should be only two numbers, not three\n"
-         << i << " not in 0.." << length << endl;
-    if (i < length)
-    {
-        //old sn = (int)((COVISE_POINTER_TYPE)ptr + 2 * sizeof(int)) + 3 * i * sizeof(int) + 1;
-        //old of = (int)((COVISE_POINTER_TYPE)ptr + 2 * sizeof(int)) + 3 * i * sizeof(int) + 2;
-        sn = *(int *)(buf+sizeof(int));
-        of = *(shmSizeType *)(buf+sizeof(int)+sizeof(int));
-        buf += sizeof(int) + sizeof(int) + sizeof(shmSizeType);
-        tmparraych = new coCharShmArray(sn, of);
-        tmpch = (char *)tmparraych->getDataPtr();
-        delete tmparraych;
-        return tmpch;
-    }
-    //  else
-    cerr << "Access error for coStringShmArray\n"
-         << i << " not in 0.." << length << endl;
-    return NULL;
+    return (*const_cast<coStringShmArray *>(this))[i];
 }
@@ -0,0 +1,247 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#include "coThreadPool.h"
+#include "threadname.h"
+
+#include <cstdlib>
+#include <string>
+
+using namespace covise;
+
+// pool and index of a thread executing a body, together with the body the
+// thread has been started for by run()
+struct coThreadPool::Context
+{
+    const coThreadPool *pool;
+    int thread;
+    const Context *parent;
+};
+
+namespace
+{
+thread_local bool s_inParallelRegion = false;
+}
+
+const coThreadPool::Context *&coThreadPool::callerContext()
+{
+    static thread_local const Context *context = nullptr;
+    return context;
+}
+
+// the not yet processed part [begin, end) of the share of one thread
+struct coThreadPool::Range
+{
+    std::mutex mutex;
+    size_t begin = 0, end = 0;
+
+    bool pop(size_t &index)
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (begin >= end)
+            return false;
+        index = begin++;
+        return true;
+    }
+};
+
+coThreadPool::coThreadPool(int numThreads)
+    : m_numThreads(numThreads > 0 ? numThreads : defaultNumThreads())
+{
+    for (int i = 0; i < m_numThreads; ++i)
+        m_ranges.emplace_back(new Range);
+    for (int i = 1; i < m_numThreads; ++i)
+        m_threads.emplace_back(&coThreadPool::worker, this, i);
+}
+
+coThreadPool::~coThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_quit = true;
+    }
+    m_start.notify_all();
+    for (auto &t : m_threads)
+        t.join();
+}
+
+int coThreadPool::defaultNumThreads()
+{
+    if (const char *env = getenv("COVISE_NUM_THREADS"))
+    {
+        int n = atoi(env);
+        if (n > 0)
+            return n;
+    }
+    int n = (int)std::thread::hardware_concurrency();
+    return n > 0 ? n : 1;
+}
+
+coThreadPool &coThreadPool::global()
+{
+    static coThreadPool pool;
+    return pool;
+}
+
+bool coThreadPool::inParallelRegion()
+{
+    return s_inParallelRegion;
+}
+
+void coThreadPool::run(size_t n, const Body &body)
+{
+    if (n == 0)
+        return;
+    for (const Context *c = callerContext(); c; c = c->parent)
+    {
+        if (c->pool == this)
+        {
+            // nested call: waiting for our own threads would never end
+            for (size_t i = 0; i < n; ++i)
+                body(i, c->thread);
+            return;
+        }
+    }
+
+    // calls from threads of other pools take turns, each one gets all threads
+    std::lock_guard<std::mutex> runGuard(m_runMutex);
+    if (m_numThreads == 1 || n == 1)
+    {
+        const Context *caller = callerContext();
+        Context context = { this, 0, caller };
+        callerContext() = &context;
+        try
+        {
+            for (size_t i = 0; i < n; ++i)
+                body(i, 0);
+        }
+        catch (...)
+        {
+            callerContext() = caller;
+            throw;
+        }
+        callerContext() = caller;
+        return;
+    }
+
+    for (int t = 0; t < m_numThreads; ++t)
+    {
+        std::lock_guard<std::mutex> guard(m_ranges[t]->mutex);
+        m_ranges[t]->begin = n * t / m_numThreads;
+        m_ranges[t]->end = n * (t + 1) / m_numThreads;
+    }
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_body = &body;
+        m_caller = callerContext();
+        m_exception = nullptr;
+        m_busy = m_numThreads;
+        ++m_generation;
+    }
+    m_start.notify_all();
+
+    work(0);
+
+    std::unique_lock<std::mutex> guard(m_mutex);
+    m_done.wait(guard, [this]() { return m_busy == 0; });
+    m_body = nullptr;
+    m_caller = nullptr;
+    if (m_exception)
+        std::rethrow_exception(m_exception);
+}
+
+void coThreadPool::worker(int thread)
+{
+    setThreadName("coThreadPool:" + std::to_string(thread));
+    unsigned generation = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> guard(m_mutex);
+            m_start.wait(guard, [this, generation]() { return m_quit || m_generation != generation; });
+            if (m_quit)
+                return;
+            generation = m_generation;
+        }
+        work(thread);
+    }
+}
+
+void coThreadPool::work(int thread)
+{
+    // the calling thread may already execute a body of another pool
+    const bool inParallelRegion = s_inParallelRegion;
+    const Context *caller = callerContext();
+    Context context = { this, thread, m_caller };
+    s_inParallelRegion = true;
+    callerContext() = &context;
+    try
+    {
+        size_t index;
+        do
+        {
+            while (m_ranges[thread]->pop(index))
+                (*m_body)(index, thread);
+        } while (steal(thread));
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        if (!m_exception)
+            m_exception = std::current_exception();
+        // make the other threads run out of work
+        for (auto &r : m_ranges)
+        {
+            std::lock_guard<std::mutex> rangeGuard(r->mutex);
+            r->end = r->begin;
+        }
+    }
+    s_inParallelRegion = inParallelRegion;
+    callerContext() = caller;
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (--m_busy == 0)
+        m_done.notify_all();
+}
+
+// move the upper half of the largest remaining range to our own range
+bool coThreadPool::steal(int thread)
+{
+    for (;;)
+    {
+        int victim = -1;
+        size_t most = 0;
+        for (int t = 0; t < m_numThreads; ++t)
+        {
+            if (t == thread)
+                continue;
+            std::lock_guard<std::mutex> guard(m_ranges[t]->mutex);
+            size_t left = m_ranges[t]->end - m_ranges[t]->begin;
+            if (m_ranges[t]->end > m_ranges[t]->begin && left > most)
+            {
+                most = left;
+                victim = t;
+            }
+        }
+        if (victim < 0)
+            return false;
+
+        Range &from = *m_ranges[victim];
+        Range &to = *m_ranges[thread];
+        std::lock(from.mutex, to.mutex);
+        std::lock_guard<std::mutex> fromGuard(from.mutex, std::adopt_lock);
+        std::lock_guard<std::mutex> toGuard(to.mutex, std::adopt_lock);
+        if (from.end <= from.begin)
+            continue; // drained meanwhile, look for another victim
+        size_t left = from.end - from.begin;
+        size_t mid = from.end - (left + 1) / 2;
+        to.begin = mid;
+        to.end = from.end;
+        from.end = mid;
+        return true;
+    }
+}
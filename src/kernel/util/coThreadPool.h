@@ -0,0 +1,88 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#ifndef CO_THREAD_POOL_H
+#define CO_THREAD_POOL_H
+
+#include "coExport.h"
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace covise
+{
+
+// Fixed set of worker threads running index ranges in parallel.
+// Each thread starts on a contiguous share of the range and steals half
+// of the remaining work of another thread when its own share is done,
+// so that elements of very different cost still keep all threads busy.
+class UTILEXPORT coThreadPool
+{
+public:
+    typedef std::function<void(size_t index, int thread)> Body;
+
+    // numThreads <= 0: defaultNumThreads()
+    explicit coThreadPool(int numThreads = 0);
+    ~coThreadPool();
+    coThreadPool(const coThreadPool &) = delete;
+    coThreadPool &operator=(const coThreadPool &) = delete;
+
+    // number of threads taking part in run(), including the calling thread
+    int numThreads() const
+    {
+        return m_numThreads;
+    }
+
+    // call body(i, thread) for all i in [0, n) and wait for completion,
+    // thread is in [0, numThreads()); the first exception thrown by body is
+    // rethrown after all threads have stopped.
+    // Calls from within a body of this pool, also from threads of other pools
+    // working for such a body, run serially and pass the index of the thread
+    // executing that body, so that state kept per thread is never shared.
+    void run(size_t n, const Body &body);
+
+    // COVISE_NUM_THREADS or the number of hardware threads
+    static int defaultNumThreads();
+
+    // pool shared by all users within a process
+    static coThreadPool &global();
+
+    // whether the calling thread is executing a body of any pool
+    static bool inParallelRegion();
+
+private:
+    struct Range;
+    struct Context;
+
+    // innermost body executed by the calling thread
+    static const Context *&callerContext();
+
+    void worker(int thread);
+    void work(int thread);
+    bool steal(int thread);
+
+    int m_numThreads;
+    std::vector<std::thread> m_threads;
+    std::vector<std::unique_ptr<Range>> m_ranges;
+
+    std::mutex m_mutex;
+    std::condition_variable m_start, m_done;
+    unsigned m_generation = 0;
+    int m_busy = 0;
+    bool m_quit = false;
+    const Body *m_body = nullptr;
+    const Context *m_caller = nullptr;
+    std::exception_ptr m_exception;
+    std::mutex m_runMutex;
+};
+}
+#endif
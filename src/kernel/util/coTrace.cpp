@@ -0,0 +1,97 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#include "coTrace.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+using namespace covise;
+
+coTrace &coTrace::instance()
+{
+    static coTrace trace;
+    return trace;
+}
+
+coTrace::coTrace()
+{
+    const char *env = getenv("COVISE_TRACE");
+    m_enabled = env && strcmp(env, "0") != 0;
+    if (!m_enabled)
+        return;
+
+    int size = 65536;
+    if (const char *buf = getenv("COVISE_TRACE_BUFFER"))
+        size = atoi(buf);
+    m_ring.resize(size > 0 ? size : 1);
+}
+
+long long coTrace::now()
+{
+    // system clock: spans of processes on different hosts go into one timeline
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+int coTrace::threadIndex()
+{
+    static std::atomic<int> numThreads{0};
+    thread_local int index = numThreads++;
+    return index;
+}
+
+void coTrace::record(const char *name, const char *category, long long begin, long long end)
+{
+    if (!m_enabled)
+        return;
+
+    Span span;
+    span.name = name;
+    span.category = category;
+    span.begin = begin;
+    span.end = end;
+    span.thread = threadIndex();
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_ring[m_next] = span;
+    m_next = (m_next + 1) % m_ring.size();
+    if (m_count < m_ring.size())
+        ++m_count;
+}
+
+std::vector<coTrace::Span> coTrace::take()
+{
+    std::vector<Span> spans;
+    std::lock_guard<std::mutex> guard(m_mutex);
+    spans.reserve(m_count);
+    size_t first = (m_next + m_ring.size() - m_count) % m_ring.size();
+    for (size_t i = 0; i < m_count; ++i)
+        spans.push_back(m_ring[(first + i) % m_ring.size()]);
+    m_count = 0;
+    return spans;
+}
+
+std::string coTrace::takeMessage(const std::string &label)
+{
+    if (!m_enabled)
+        return std::string();
+    std::vector<Span> spans = take();
+    if (spans.empty())
+        return std::string();
+
+    std::stringstream ss;
+    ss << label << "\n";
+    for (const auto &span : spans)
+    {
+        ss << span.name << "\t" << span.category << "\t" << span.thread << "\t"
+           << span.begin << "\t" << span.end << "\n";
+    }
+    return ss.str();
+}
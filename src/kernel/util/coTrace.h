@@ -0,0 +1,89 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#ifndef CO_TRACE_H
+#define CO_TRACE_H
+
+#include "coExport.h"
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace covise
+{
+
+// Timeline of what a process spends its time on: spans of work are kept in a
+// ring buffer until they are sent to the controller, which writes one
+// Chrome/Perfetto trace for each execution of the map.
+// Recording is enabled by setting the environment variable COVISE_TRACE
+// for all COVISE processes.
+class UTILEXPORT coTrace
+{
+public:
+    struct Span
+    {
+        const char *name = nullptr; // string literals, so that recording does not allocate
+        const char *category = nullptr;
+        long long begin = 0, end = 0; // microseconds since the epoch, comparable across hosts
+        int thread = 0;
+    };
+
+    static coTrace &instance();
+
+    bool enabled() const
+    {
+        return m_enabled;
+    }
+
+    static long long now();
+    // small number identifying the calling thread within the process
+    static int threadIndex();
+
+    void record(const char *name, const char *category, long long begin, long long end);
+    // the spans recorded since the last call, oldest first, the oldest ones are
+    // lost if more than COVISE_TRACE_BUFFER (65536) have been recorded
+    std::vector<Span> take();
+    // contents of a COVISE_MESSAGE_TRACE with the spans recorded since the last call:
+    // the process label in the first line, then one line per span with
+    // name, category, thread, begin and end separated by tabs; empty if there are none
+    std::string takeMessage(const std::string &label);
+
+private:
+    coTrace();
+
+    bool m_enabled = false;
+    std::mutex m_mutex;
+    std::vector<Span> m_ring;
+    size_t m_next = 0, m_count = 0;
+};
+
+// records a span from its construction to its destruction
+class UTILEXPORT coTraceScope
+{
+public:
+    coTraceScope(const char *name, const char *category)
+        : m_name(name)
+        , m_category(category)
+        , m_begin(coTrace::instance().enabled() ? coTrace::now() : -1)
+    {
+    }
+    ~coTraceScope()
+    {
+        if (m_begin >= 0)
+            coTrace::instance().record(m_name, m_category, m_begin, coTrace::now());
+    }
+    coTraceScope(const coTraceScope &) = delete;
+    coTraceScope &operator=(const coTraceScope &) = delete;
+
+private:
+    const char *m_name;
+    const char *m_category;
+    long long m_begin;
+};
+}
+#endif
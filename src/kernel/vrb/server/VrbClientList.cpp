@@ -415,6 +415,19 @@ void VRBClientList::sendMessageToClient(int clientID, TokenBuffer &tb, covise_ms
     sendMessageToClient(cl, tb, type);
 }
 
+void VRBClientList::sendMessageToClients(const std::set<int> &clientIDs, TokenBuffer &tb, covise_msg_type type)
+{
+    Message m(tb);
+    m.type = type;
+    for (auto &cl : m_clients)
+    {
+        if (clientIDs.find(cl->ID()) != clientIDs.end())
+        {
+            cl->send(&m);
+        }
+    }
+}
+
 void VRBClientList::sendMessageToAll(covise::TokenBuffer &stb, covise::covise_msg_type type)
 {
     Message m(stb);
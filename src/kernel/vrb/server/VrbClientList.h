@@ -115,6 +115,8 @@ public:
     ///send message to the client with id
     void sendMessageToClient(VRBSClient *cl, covise::TokenBuffer &tb, covise::covise_msg_type type);
     void sendMessageToClient(int clientID, covise::TokenBuffer &stb, covise::covise_msg_type type = covise::COVISE_MESSAGE_VRB_GUI);
+    ///send the same message to all clients with these ids, the message is built only once
+    void sendMessageToClients(const std::set<int> &clientIDs, covise::TokenBuffer &tb, covise::covise_msg_type type);
     void sendMessageToAll(covise::TokenBuffer &tb, covise::covise_msg_type type = covise::COVISE_MESSAGE_VRB_GUI);
 	static std::string cutFileName(const std::string& fileName);
     int numInSession(const vrb::SessionID &Group);
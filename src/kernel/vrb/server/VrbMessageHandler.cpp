@@ -374,6 +374,11 @@ namespace vrb
 		m_server->removeConnection(conn);
 	}
 
+	std::chrono::steady_clock::time_point VrbMessageHandler::flushRegistryChanges()
+	{
+		return m_sessions.flushChanges();
+	}
+
 	void VrbMessageHandler::removeUnregisteredClient(const Connection *conn)
 	{
 		auto unregisteredClient = std::find_if(m_unregisteredClients.begin(), m_unregisteredClients.end(), [conn](const ConnectionDetails::ptr &cd)
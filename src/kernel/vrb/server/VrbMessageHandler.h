@@ -76,6 +76,9 @@ public:
 	int numberOfClients();
 	void addClient(ConnectionDetails::ptr&& clientCon);
 	void remove(const covise::Connection* c);
+	///send the registry changes that were held back for coalescing and are due now,
+	///returns when the next one is due (time_point::max() if there are none)
+	std::chrono::steady_clock::time_point flushRegistryChanges();
 protected:
 	///update the vrb userinterface
 	virtual void updateApplicationWindow(const std::string& cl, int sender, const std::string& var, const covise::DataHandle& value);
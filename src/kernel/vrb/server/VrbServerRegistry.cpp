@@ -13,6 +13,7 @@
 
 #include <VrbClientList.h>
 
+#include <algorithm>
 #include <iostream>
 
 #include <assert.h>
@@ -21,6 +22,27 @@
 using namespace covise;
 namespace vrb
 {
+namespace
+{
+struct Coalescing
+{
+    std::chrono::milliseconds defaultWindow{0};
+    std::map<std::string, std::chrono::milliseconds> windows;
+};
+
+Coalescing &coalescing()
+{
+    static Coalescing c;
+    return c;
+}
+
+VrbServerRegistry::Statistics &stats()
+{
+    static VrbServerRegistry::Statistics s;
+    return s;
+}
+} // namespace
+
 VrbServerRegistry::VrbServerRegistry(const SessionID &session)
     :m_session(session)
 {
@@ -51,10 +73,29 @@ void VrbServerRegistry::setVar(int ID, const std::string &className, const std::
         rc->append(rv);
     }
 	serverRegVar* srv = dynamic_cast<serverRegVar*>(rv);
+    ++stats().changes;
+    //shared maps send their changes, not their value: they can not be coalesced
+    auto window = coalescingWindow(rc);
+    if (window.count() > 0 && !rc->isMap())
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (srv->pending)
+        {
+            ++stats().coalesced;
+            updateUI(srv);
+            return;
+        }
+        if (now - srv->lastSent < window)
+        {
+            srv->pending = true;
+            m_pendingChanges.emplace(className, name);
+            updateUI(srv);
+            return;
+        }
+        srv->lastSent = now;
+    }
     //call observers
-    std::set<int> collectiveObservers = dynamic_cast<serverRegClass*>(rc)->getOList();
-    collectiveObservers.insert(srv->getOList().begin(), srv->getOList().end());
-    sendVariableChange(srv, collectiveObservers);
+    sendVariableChange(srv, collectObservers(dynamic_cast<serverRegClass*>(rc), srv));
     updateUI(srv);
 
 
@@ -112,10 +153,77 @@ void VrbServerRegistry::deleteEntry()
 
 void VrbServerRegistry::sendVariableChange(serverRegVar * rv, std::set<int> observers)
 {
-    for (const auto client : observers)
+    if (observers.empty())
     {
-        rv->update(client);
+        return;
     }
+    covise::TokenBuffer sb;
+    rv->writeChange(sb);
+    ++stats().serializations;
+    stats().messages += observers.size();
+    clients.sendMessageToClients(observers, sb, COVISE_MESSAGE_VRB_REGISTRY_ENTRY_CHANGED);
+}
+
+std::set<int> VrbServerRegistry::collectObservers(serverRegClass *rc, serverRegVar *rv) const
+{
+    std::set<int> collectiveObservers = rc->getOList();
+    collectiveObservers.insert(rv->getOList().begin(), rv->getOList().end());
+    return collectiveObservers;
+}
+
+std::chrono::steady_clock::time_point VrbServerRegistry::flushChanges()
+{
+    auto next = std::chrono::steady_clock::time_point::max();
+    if (m_pendingChanges.empty())
+    {
+        return next;
+    }
+    auto now = std::chrono::steady_clock::now();
+    for (auto it = m_pendingChanges.begin(); it != m_pendingChanges.end();)
+    {
+        auto rc = dynamic_cast<serverRegClass *>(getClass(it->first));
+        auto srv = rc ? dynamic_cast<serverRegVar *>(rc->getVar(it->second)) : nullptr;
+        if (srv && srv->pending)
+        {
+            auto due = srv->lastSent + coalescingWindow(rc);
+            if (now < due)
+            {
+                next = std::min(next, due);
+                ++it;
+                continue;
+            }
+            srv->pending = false;
+            srv->lastSent = now;
+            sendVariableChange(srv, collectObservers(rc, srv));
+        }
+        //the variable has been deleted in the meantime
+        it = m_pendingChanges.erase(it);
+    }
+    return next;
+}
+
+void VrbServerRegistry::setCoalescingWindow(const std::string &className, std::chrono::milliseconds window)
+{
+    if (className.empty())
+    {
+        coalescing().defaultWindow = window;
+    }
+    else
+    {
+        coalescing().windows[className] = window;
+    }
+}
+
+std::chrono::milliseconds VrbServerRegistry::coalescingWindow(const regClass *rc)
+{
+    const auto &c = coalescing();
+    auto it = c.windows.find(rc->name());
+    return it == c.windows.end() ? c.defaultWindow : it->second;
+}
+
+const VrbServerRegistry::Statistics &VrbServerRegistry::statistics()
+{
+    return stats();
 }
 
 void VrbServerRegistry::updateUI(serverRegVar* rv)
@@ -200,13 +308,18 @@ serverRegVar::~serverRegVar()
     informDeleteObservers();
 }
 
+void serverRegVar::writeChange(covise::TokenBuffer &tb)
+{
+    tb << m_class->getID();
+    tb << m_class->name();
+    tb << name();
+	sendValueChange(tb);
+}
+
 void serverRegVar::update(int recvID)
 {
     covise::TokenBuffer sb;
-    sb << m_class->getID();
-    sb << m_class->name();
-    sb << name();
-	sendValueChange(sb);
+    writeChange(sb);
     clients.sendMessageToClient(recvID, sb, COVISE_MESSAGE_VRB_REGISTRY_ENTRY_CHANGED);
 }
 void serverRegVar::updateMap(int recvID)
@@ -232,10 +345,7 @@ void serverRegVar::informDeleteObservers()
 	{
 		combinedObservers.insert(c->getOList().begin(), c->getOList().end());
 	}
-    for (const int obs : combinedObservers)
-    {
-        clients.sendMessageToClient(obs, sb, COVISE_MESSAGE_VRB_REGISTRY_ENTRY_DELETED);
-    }
+    clients.sendMessageToClients(combinedObservers, sb, COVISE_MESSAGE_VRB_REGISTRY_ENTRY_DELETED);
 }
 
 
@@ -13,8 +13,12 @@
 
 #include "VrbClientList.h"
 
+#include <chrono>
 #include <map>
 #include <memory>
+#include <set>
+#include <string>
+#include <utility>
 
 #include <net/tokenbuffer.h>
 #include <vrb/RegistryClass.h>
@@ -32,10 +36,20 @@ class DataHandle;
 namespace vrb
 {
 class serverRegVar;
+class serverRegClass;
 
 class VRBSERVEREXPORT VrbServerRegistry: public VrbRegistry
 {
 public:
+    ///number of registry changes and of the messages sent for them by all registries
+    struct Statistics
+    {
+        size_t changes = 0; ///< values set by clients
+        size_t serializations = 0; ///< changes written into a message
+        size_t messages = 0; ///< messages sent to observers
+        size_t coalesced = 0; ///< changes replaced by a newer value before they were sent
+    };
+
     explicit VrbServerRegistry(const SessionID &session);
 
     const SessionID &sessionID() const;
@@ -62,6 +76,9 @@ public:
     void unObserve(int recvID);
     ///informs the observers about a variable change
     void sendVariableChange(serverRegVar *rv, std::set<int> observers);
+    ///send the latest values of coalesced variables whose window has passed,
+    ///returns when the next of the remaining ones is due (time_point::max() if there are none)
+    std::chrono::steady_clock::time_point flushChanges();
     ///Updates the <ui of the vrb server
     void updateUI(serverRegVar *rv);
     /// get a boolean Variable
@@ -72,8 +89,17 @@ public:
         return -1;
     }
     std::shared_ptr<regClass> createClass(const std::string &name, int id) override;
+
+    ///changes of the variables of className are sent at most once per window,
+    ///only the latest value is sent, an empty className sets the default for all classes
+    static void setCoalescingWindow(const std::string &className, std::chrono::milliseconds window);
+    static std::chrono::milliseconds coalescingWindow(const regClass *rc);
+    static const Statistics &statistics();
+
 private:
     SessionID m_session;
+    std::set<std::pair<std::string, std::string>> m_pendingChanges; // class and variable name
+    std::set<int> collectObservers(serverRegClass *rc, serverRegVar *rv) const;
 };
 
 class serverRegVar : public regVar
@@ -84,6 +110,8 @@ public:
 
     using regVar::regVar;
     ~serverRegVar();
+    /// write the change message for this variable to tb
+    void writeChange(covise::TokenBuffer &tb);
     /// send Value to recvID
     void update(int recvID);
 	///updatafunction for SharedMaps
@@ -107,6 +135,9 @@ public:
     };
     void informDeleteObservers();
 
+    ///for coalescing: when the value was last sent and whether a newer value waits to be sent
+    std::chrono::steady_clock::time_point lastSent;
+    bool pending = false;
 };
 
 class serverRegClass : public regClass
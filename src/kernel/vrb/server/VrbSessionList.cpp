@@ -48,6 +48,14 @@ VrbServerRegistry& VrbSessionList::forceCreateSession(const SessionID& id)
 	return *m_sessions.emplace(end(), VrbServerRegistry{ newID });
 }
 
+std::chrono::steady_clock::time_point VrbSessionList::flushChanges()
+{
+	auto next = std::chrono::steady_clock::time_point::max();
+	for (auto& reg : m_sessions)
+		next = std::min(next, reg.flushChanges());
+	return next;
+}
+
 void VrbSessionList::unobserveFromAll(int senderID, const std::string& className, const std::string& varName)
 {
 	for (auto& reg : m_sessions)
@@ -33,6 +33,8 @@ public:
 	covise::TokenBuffer serializeSession(const SessionID& id) const;
 	const VrbServerRegistry &deserializeSession(covise::TokenBuffer& tb, const SessionID& id);
 	void setMaster(const SessionID& sid);
+	///send the coalesced registry changes that are due, returns when the next one is due
+	std::chrono::steady_clock::time_point flushChanges();
 private:
 	const SessionID vrbSession = SessionID(0, std::string(), false);
 	ValueType m_sessions;
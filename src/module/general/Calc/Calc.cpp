@@ -27,6 +27,9 @@
 #include "Calc.h"
 #include <do/coDoData.h>
 #include <do/coDoUnstructuredGrid.h>
+#include <util/coThreadPool.h>
+
+#include <chrono>
 
 using namespace covise;
 
@@ -321,7 +324,6 @@ int CCalc::Compute(Calc *module, char *Expression)
 {
     char *String;
     int TempVektors = 0; // number of intermediate results with type VEKTOR
-    int Array_Count = 0; // counter for data-array
     float *pIntermed = NULL; // Pointer to beginning of intermediate results-section
     int Anz_Man_Vekt = 0; // number of manual vectors
 
@@ -542,6 +544,26 @@ int CCalc::Compute(Calc *module, char *Expression)
         return coSimpleModule::FAIL;
     }
 
+    //translate postfix-expression into instructions working on whole blocks
+    CalcProgram program;
+    std::vector<int> Result_Values;
+    if (!Compile(module, program, Result_Values))
+    {
+        //in case of an error free memory before return
+        DeleteItemList();
+        DeletePostfixList();
+        delete[](pVektor_1);
+        delete[](pVektor_2);
+        delete[](pEinh_Vektor);
+        delete[](pMan_Vektor);
+        delete[](String);
+        delete[](dtype_s1);
+        delete[](dtype_s2);
+        delete[](dtype_v1);
+        delete[](dtype_v2);
+        return coSimpleModule::FAIL;
+    }
+
     // get memory for intermediate results
     pIntermed = (float *)new float[(TempVektors + 1) * Vek_Len];
 
@@ -586,34 +608,34 @@ int CCalc::Compute(Calc *module, char *Expression)
     }
 
     //evaluate array
-
-    for (Array_Count = 0; Array_Count < Array_Len; Array_Count++)
+    std::vector<float *> outputs;
+    switch (Result_Type)
     {
-        Result_Vektor = pIntermed;
-        if (u1_in != NULL) // vector-input 1 connected
-        {
-            pVektor_1[0] = u1_in[Array_Count];
-            pVektor_1[1] = v1_in[Array_Count];
-            if (Vek_Len == 3)
-                pVektor_1[2] = w1_in[Array_Count];
-        }
-
-        if (u2_in != NULL) // vector-input 2 connected
-        {
-            pVektor_2[0] = u2_in[Array_Count];
-            pVektor_2[1] = v2_in[Array_Count];
-            if (Vek_Len == 3)
-                pVektor_2[2] = w2_in[Array_Count];
-        }
+    case VEKTOR:
+        outputs.push_back(u_out);
+        outputs.push_back(v_out);
+        if (Vek_Len == 3)
+            outputs.push_back(w_out);
+        break;
 
-        if (s1_in != NULL)
-            pSkalar_1 = &s1_in[Array_Count];
-        if (s2_in != NULL)
-            pSkalar_2 = &s2_in[Array_Count];
+    case SKALAR:
+        outputs.push_back(s_out);
+        break;
+    }
 
-        //evaluation of expression
-        if (!Evaluate(module, &Result_Type, &Result_Vektor, &Result_Skalar))
+    if (!outputs.empty() && Array_Len > 0)
+    {
+        size_t zeroDivisions = 0;
+        auto start = std::chrono::steady_clock::now();
+        CalcProgram::Status status = program.run(Result_Values, outputs, Array_Len, &zeroDivisions);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (status != CalcProgram::Ok)
         {
+            if (status == CalcProgram::DivisionByZero)
+                module->sendError("ERROR: division by zero");
+            else
+                module->sendError("ERROR: log on negativ operand");
+
             //in case of an error free memory before return
             DeleteItemList();
             DeletePostfixList();
@@ -630,23 +652,12 @@ int CCalc::Compute(Calc *module, char *Expression)
             delete[](dtype_v2);
             return coSimpleModule::FAIL;
         }
+        // scalar divisions by zero result in 0
+        if (zeroDivisions > 0 || program.zeroDivisions() > 0)
+            module->sendWarning("ERROR: division by zero");
 
-        //write result into output object
-        switch (Result_Type)
-        {
-        case VEKTOR:
-            u_out[Array_Count] = Result_Vektor[0];
-            v_out[Array_Count] = Result_Vektor[1];
-            if (Vek_Len == 3)
-                w_out[Array_Count] = Result_Vektor[2];
-            break;
-
-        case SKALAR:
-            s_out[Array_Count] = Result_Skalar;
-            break;
-        }
-        if (Array_Count == 0)
-            minmax = 1; //in case of max/min: send message
+        if (getenv("COVISE_CALC_COMPARE"))
+            CompareWithInterpreter(module, pIntermed, outputs, program, seconds);
     }
 
     //FOR TESTING *********************************************************
@@ -1765,6 +1776,427 @@ int CCalc::Evaluate(Calc *module, int *Result_Type, float **Vektor_Res,
     return (1);
 }
 
+//////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// Compile: translate postfix-expression into a CalcProgram                 //
+//                                                                          //
+//////////////////////////////////////////////////////////////////////////////
+
+int CCalc::Compile(Calc *module, CalcProgram &program, std::vector<int> &Result_Values)
+{
+    struct Operand
+    {
+        int Type; // VEKTOR or SKALAR
+        int Value[3]; // program values of the components
+    };
+    std::vector<Operand> Stack;
+    int Operation = 0;
+    int Type_Res = TOKEN;
+    int x = 0;
+
+    for (int CountPostfix = 0; pListPostfix[CountPostfix].Priority != EOL; CountPostfix++)
+    {
+        const LIST &Item = pListPostfix[CountPostfix];
+        Operand Res;
+        Res.Type = Item.Type;
+        for (x = 0; x < 3; x++)
+            Res.Value[x] = -1;
+
+        if (Item.Priority == 0) // operand: push onto stack
+        {
+            if (Item.Type == SKALAR)
+            {
+                if (!strcmp(Item.Item, SKALAR_1))
+                    Res.Value[0] = s1_in ? program.input(s1_in) : program.constant(0.f);
+                else if (!strcmp(Item.Item, SKALAR_2))
+                    Res.Value[0] = s2_in ? program.input(s2_in) : program.constant(0.f);
+                else
+                    Res.Value[0] = program.constant((float)atof(Item.Item));
+            }
+            else
+            {
+                const float *in[3] = { NULL, NULL, NULL };
+                if (!strcmp(Item.Item, VEKTOR_1))
+                {
+                    in[0] = u1_in;
+                    in[1] = v1_in;
+                    in[2] = w1_in;
+                }
+                else if (!strcmp(Item.Item, VEKTOR_2))
+                {
+                    in[0] = u2_in;
+                    in[1] = v2_in;
+                    in[2] = w2_in;
+                }
+                for (x = 0; x < Vek_Len; x++)
+                {
+                    if (strstr(Item.Item, MANUAL_V))
+                    {
+                        int Man_Vek = atoi(Item.Item + strlen(MANUAL_V));
+                        Res.Value[x] = program.constant(pMan_Vektor[Man_Vek * Vek_Len + x]);
+                    }
+                    else if (!strcmp(Item.Item, EINHEITS_V))
+                        Res.Value[x] = program.constant(1.f);
+                    else if (in[x])
+                        Res.Value[x] = program.input(in[x]);
+                    else
+                        Res.Value[x] = program.constant(0.f);
+                }
+            }
+            Stack.push_back(Res);
+            continue;
+        }
+
+        // operator or function
+        Operand Op_1, Op_2;
+        Op_2.Type = false;
+        if (Stack.size() < (Item.Priority == 5 ? 1u : 2u))
+        {
+            module->sendError("ERROR: non legal operation in expression");
+            return (0);
+        }
+        if (Item.Priority != 5)
+        {
+            Op_2 = Stack.back();
+            Stack.pop_back();
+        }
+        Op_1 = Stack.back();
+        Stack.pop_back();
+
+        if (!CheckOp(Op_1.Type, Op_2.Type, Item.Token, &Operation, &Type_Res))
+        {
+            module->sendError("ERROR: non legal operation in expression");
+            return (0);
+        }
+        Res.Type = Type_Res;
+
+        const int *V_1 = Op_1.Value;
+        const int *V_2 = Op_2.Value;
+        switch (Operation)
+        {
+        case VEK_VEK:
+            switch (Item.Token)
+            {
+            case PLUS:
+            case MINUS:
+                for (x = 0; x < Vek_Len; x++)
+                    Res.Value[x] = program.operation(Item.Token == PLUS ? CalcProgram::Add : CalcProgram::Sub, V_1[x], V_2[x]);
+                break;
+
+            case MAL:
+                Res.Value[0] = program.operation(CalcProgram::Mul, V_1[0], V_2[0]);
+                for (x = 1; x < Vek_Len; x++)
+                    Res.Value[0] = program.operation(CalcProgram::Add, Res.Value[0],
+                                                     program.operation(CalcProgram::Mul, V_1[x], V_2[x]));
+                break;
+
+            case VEK_PROD:
+                if (Vek_Len != 3)
+                {
+                    module->sendError("ERROR: `Kreuzprodukt` only in R3");
+                    return (0);
+                }
+                for (x = 0; x < 3; x++)
+                {
+                    int y = (x + 1) % 3, z = (x + 2) % 3;
+                    Res.Value[x] = program.operation(CalcProgram::Sub,
+                                                     program.operation(CalcProgram::Mul, V_1[y], V_2[z]),
+                                                     program.operation(CalcProgram::Mul, V_1[z], V_2[y]));
+                }
+                break;
+            }
+            break;
+
+        case VEK_SKA:
+            for (x = 0; x < Vek_Len; x++)
+                Res.Value[x] = program.operation(Item.Token == MAL ? CalcProgram::Mul : CalcProgram::DivChecked, V_1[x], V_2[0]);
+            break;
+
+        case SKA_VEK:
+            for (x = 0; x < Vek_Len; x++)
+                Res.Value[x] = program.operation(CalcProgram::Mul, V_2[x], V_1[0]);
+            break;
+
+        case SKA_SKA:
+        {
+            CalcProgram::Opcode Op = CalcProgram::Add;
+            switch (Item.Token)
+            {
+            case MINUS:
+                Op = CalcProgram::Sub;
+                break;
+            case MAL:
+                Op = CalcProgram::Mul;
+                break;
+            case GETEILT:
+                Op = CalcProgram::Div;
+                break;
+            case HOCH:
+                Op = CalcProgram::Pow;
+                break;
+            case WURZEL:
+                Op = CalcProgram::Root;
+                break;
+            }
+            Res.Value[0] = program.operation(Op, V_1[0], V_2[0]);
+            break;
+        }
+
+        case VEK:
+            switch (Item.Token)
+            {
+            case NEG:
+                for (x = 0; x < Vek_Len; x++)
+                    Res.Value[x] = program.operation(CalcProgram::Neg, V_1[x]);
+                break;
+
+            case VLEN:
+                Res.Value[0] = program.operation(CalcProgram::Mul, V_1[0], V_1[0]);
+                for (x = 1; x < Vek_Len; x++)
+                    Res.Value[0] = program.operation(CalcProgram::Add, Res.Value[0],
+                                                     program.operation(CalcProgram::Mul, V_1[x], V_1[x]));
+                Res.Value[0] = program.operation(CalcProgram::Sqrt, Res.Value[0]);
+                break;
+
+            case COMP_1:
+            case COMP_2:
+            case COMP_3:
+                Res.Value[0] = V_1[Item.Token - COMP_1];
+                break;
+
+            case MAX:
+            case MIN:
+            {
+                float Reduced = 0.f;
+                if (!Reduce(module, Item.Token, pListPostfix[CountPostfix - 1].Item, &Reduced))
+                    return (0);
+                Res.Value[0] = program.constant(Reduced);
+                break;
+            }
+            }
+            break;
+
+        case SKA:
+            switch (Item.Token)
+            {
+            case SIN:
+                Res.Value[0] = program.operation(CalcProgram::Sin, V_1[0]);
+                break;
+            case COS:
+                Res.Value[0] = program.operation(CalcProgram::Cos, V_1[0]);
+                break;
+            case TAN:
+                Res.Value[0] = program.operation(CalcProgram::Tan, V_1[0]);
+                break;
+            case ATAN:
+                Res.Value[0] = program.operation(CalcProgram::Atan, V_1[0]);
+                break;
+            case LOG:
+                Res.Value[0] = program.operation(CalcProgram::Log, V_1[0]);
+                break;
+            case EXP:
+                Res.Value[0] = program.operation(CalcProgram::Exp, V_1[0]);
+                break;
+            case NEG:
+                Res.Value[0] = program.operation(CalcProgram::Neg, V_1[0]);
+                break;
+            case MAX:
+            case MIN:
+            {
+                float Reduced = 0.f;
+                if (!Reduce(module, Item.Token, pListPostfix[CountPostfix - 1].Item, &Reduced))
+                    return (0);
+                Res.Value[0] = program.constant(Reduced);
+                break;
+            }
+            }
+            break;
+        }
+
+        // constant operands with an illegal value
+        for (x = 0; x < (Res.Type == VEKTOR ? Vek_Len : 1); x++)
+        {
+            if (Res.Value[x] >= 0)
+                continue;
+            if (program.status() == CalcProgram::DivisionByZero)
+                module->sendError("ERROR: division by zero");
+            else if (program.status() == CalcProgram::LogOfNegative)
+                module->sendError("ERROR: log on negativ operand");
+            else
+                module->sendError("ERROR: non legal operation in expression");
+            return (0);
+        }
+        Stack.push_back(Res);
+    }
+
+    Result_Values.clear();
+    if (!Stack.empty())
+    {
+        const Operand &Res = Stack.back();
+        Result_Values.assign(Res.Value, Res.Value + (Res.Type == VEKTOR ? Vek_Len : 1));
+    }
+    return (1);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// Reduce: max/min of a whole input (length of the vectors)                 //
+//                                                                          //
+//////////////////////////////////////////////////////////////////////////////
+
+int CCalc::Reduce(Calc *module, int Token, const char *input, float *Result)
+{
+    float *s = NULL, *u = NULL, *v = NULL, *w = NULL;
+    if (!strcmp(input, SKALAR_1))
+        s = s1_in;
+    else if (!strcmp(input, SKALAR_2))
+        s = s2_in;
+    else if (!strcmp(input, VEKTOR_1))
+    {
+        u = u1_in;
+        v = v1_in;
+        w = w1_in;
+    }
+    else if (!strcmp(input, VEKTOR_2))
+    {
+        u = u2_in;
+        v = v2_in;
+        w = w2_in;
+    }
+    else
+    {
+        if (Token == MAX)
+            module->sendError("ERROR: max() can only be used with s1, s2, v1 or v2");
+        else
+            module->sendError("ERROR: min() can only be used with s1, s2, v1 or v2");
+        return (0);
+    }
+
+    *Result = 0.f;
+    if (Array_Len == 0 || (!s && !u))
+        return (1);
+
+    // max starts at 0, min at the first element
+    for (int Count = 0; Count < Array_Len; Count++)
+    {
+        float value;
+        if (s)
+            value = s[Count];
+        else
+            value = (float)sqrt((double)(u[Count] * u[Count] + v[Count] * v[Count] + w[Count] * w[Count]));
+
+        if (Count == 0 && Token == MIN)
+            *Result = value;
+        else if (Token == MAX ? value > *Result : value < *Result)
+            *Result = value;
+    }
+    return (1);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// Interpret: evaluate the postfix-expression element by element            //
+//                                                                          //
+//////////////////////////////////////////////////////////////////////////////
+
+int CCalc::Interpret(Calc *module, float *pIntermed, float *s, float *u, float *v,
+                     float *w)
+{
+    int Array_Count = 0;
+
+    for (Array_Count = 0; Array_Count < Array_Len; Array_Count++)
+    {
+        Result_Vektor = pIntermed;
+        if (u1_in != NULL) // vector-input 1 connected
+        {
+            pVektor_1[0] = u1_in[Array_Count];
+            pVektor_1[1] = v1_in[Array_Count];
+            if (Vek_Len == 3)
+                pVektor_1[2] = w1_in[Array_Count];
+        }
+
+        if (u2_in != NULL) // vector-input 2 connected
+        {
+            pVektor_2[0] = u2_in[Array_Count];
+            pVektor_2[1] = v2_in[Array_Count];
+            if (Vek_Len == 3)
+                pVektor_2[2] = w2_in[Array_Count];
+        }
+
+        if (s1_in != NULL)
+            pSkalar_1 = &s1_in[Array_Count];
+        if (s2_in != NULL)
+            pSkalar_2 = &s2_in[Array_Count];
+
+        //evaluation of expression
+        int Type = Result_Type;
+        if (!Evaluate(module, &Type, &Result_Vektor, &Result_Skalar))
+            return (0);
+
+        //write result into output arrays
+        switch (Type)
+        {
+        case VEKTOR:
+            u[Array_Count] = Result_Vektor[0];
+            v[Array_Count] = Result_Vektor[1];
+            if (Vek_Len == 3)
+                w[Array_Count] = Result_Vektor[2];
+            break;
+
+        case SKALAR:
+            s[Array_Count] = Result_Skalar;
+            break;
+        }
+        if (Array_Count == 0)
+            minmax = 1; //in case of max/min: send message
+    }
+    return (1);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// CompareWithInterpreter: time the interpreter and compare its results     //
+// with the outputs computed by the program (COVISE_CALC_COMPARE)           //
+//                                                                          //
+//////////////////////////////////////////////////////////////////////////////
+
+void CCalc::CompareWithInterpreter(Calc *module, float *pIntermed,
+                                   const std::vector<float *> &outputs,
+                                   const CalcProgram &program, double compiledSeconds)
+{
+    std::vector<std::vector<float> > Results(3, std::vector<float>(Array_Len));
+    char buf[400];
+
+    auto start = std::chrono::steady_clock::now();
+    int ok = Interpret(module, pIntermed, Results[0].data(), Results[0].data(),
+                       Results[1].data(), Results[2].data());
+    double interpretedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!ok)
+    {
+        module->sendInfo("interpreter failed on this expression");
+        return;
+    }
+
+    float maxDiff = 0.f;
+    for (size_t i = 0; i < outputs.size(); i++)
+    {
+        for (int Count = 0; Count < Array_Len; Count++)
+        {
+            float a = outputs[i][Count], b = Results[i][Count];
+            if (a != a && b != b) // both NaN
+                continue;
+            float diff = fabs(a - b);
+            if (diff > maxDiff || diff != diff)
+                maxDiff = diff;
+        }
+    }
+
+    sprintf(buf, "%d elements: compiled %.3f ms (%d instructions, %d threads), interpreted %.3f ms, max. difference %g",
+            Array_Len, compiledSeconds * 1000., (int)program.numInstructions(),
+            coThreadPool::global().numThreads(), interpretedSeconds * 1000., maxDiff);
+    module->sendInfo(buf);
+}
+
 //////////////////////////////////////////////////////////////////////////////
 //                                                                          //
 // PerformOperation: perform one operation                                  //
@@ -31,6 +31,8 @@
 #include <api/coSimpleModule.h>
 using namespace covise;
 #include <util/coviseCompat.h>
+#include "CalcProgram.h"
+#include <vector>
 
 const unsigned MAXLEN = 80; // Max. Länge eines Ausdrucks
 const unsigned MAXITEM = 20; // Max. Länge eines Ausdrucks
@@ -173,6 +175,14 @@ private:
     int CheckOp(int Type_1, int Type_2, int Operator, int *Operatio,
                 int *Ergebnis);
 
+    int Compile(Calc *module, CalcProgram &program, std::vector<int> &Result_Values);
+    int Reduce(Calc *module, int Token, const char *input, float *Result);
+    int Interpret(Calc *module, float *pIntermed, float *s, float *u, float *v,
+                  float *w);
+    void CompareWithInterpreter(Calc *module, float *pIntermed,
+                                const std::vector<float *> &outputs,
+                                const CalcProgram &program, double compiledSeconds);
+
     int CheckInputs(Calc *module, int s1, int s2, int v1, int v2,
                     int i_s1, int j_s1, int k_s1,
                     int i_s2, int j_s2, int k_s2,
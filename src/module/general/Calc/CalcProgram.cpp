@@ -0,0 +1,444 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#include "CalcProgram.h"
+
+#include <util/coThreadPool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+using namespace covise;
+
+// the functions are evaluated in double precision like the interpreter did
+namespace
+{
+struct AddOp
+{
+    float operator()(float a, float b) const
+    {
+        return a + b;
+    }
+};
+struct SubOp
+{
+    float operator()(float a, float b) const
+    {
+        return a - b;
+    }
+};
+struct MulOp
+{
+    float operator()(float a, float b) const
+    {
+        return a * b;
+    }
+};
+struct DivOp
+{
+    float operator()(float a, float b) const
+    {
+        return b != 0.f ? a / b : 0.f;
+    }
+};
+struct DivCheckedOp
+{
+    float operator()(float a, float b) const
+    {
+        return a / b;
+    }
+};
+struct PowOp
+{
+    float operator()(float a, float b) const
+    {
+        return (float)std::pow((double)a, (double)b);
+    }
+};
+struct RootOp
+{
+    float operator()(float a, float b) const
+    {
+        return (float)std::pow((double)a, (double)(1 / b));
+    }
+};
+
+template <class F>
+void binary(float *d, const float *a, bool constA, const float *b, bool constB, int n, F f)
+{
+    if (constA)
+    {
+        const float x = *a;
+        for (int i = 0; i < n; ++i)
+            d[i] = f(x, b[i]);
+    }
+    else if (constB)
+    {
+        const float y = *b;
+        for (int i = 0; i < n; ++i)
+            d[i] = f(a[i], y);
+    }
+    else
+    {
+        for (int i = 0; i < n; ++i)
+            d[i] = f(a[i], b[i]);
+    }
+}
+
+template <class F>
+void unary(float *d, const float *a, int n, F f)
+{
+    for (int i = 0; i < n; ++i)
+        d[i] = f(a[i]);
+}
+
+// number of zeros in b, constB: b is a single value for all elements
+int countZeros(const float *b, bool constB, int n)
+{
+    if (constB)
+        return *b == 0.f ? n : 0;
+    int zeros = 0;
+    for (int i = 0; i < n; ++i)
+        zeros += b[i] == 0.f;
+    return zeros;
+}
+}
+
+bool CalcProgram::isUnary(Opcode op)
+{
+    return op >= Neg;
+}
+
+float CalcProgram::apply(Opcode op, float a, float b, Status &status, size_t &zeroDivisions)
+{
+    switch (op)
+    {
+    case Add:
+        return AddOp()(a, b);
+    case Sub:
+        return SubOp()(a, b);
+    case Mul:
+        return MulOp()(a, b);
+    case Div:
+        if (b == 0.f)
+            ++zeroDivisions;
+        return DivOp()(a, b);
+    case DivChecked:
+        if (b == 0.f)
+            status = DivisionByZero;
+        return DivCheckedOp()(a, b);
+    case Pow:
+        return PowOp()(a, b);
+    case Root:
+        return RootOp()(a, b);
+    case Neg:
+        return -a;
+    case Sin:
+        return (float)std::sin((double)a);
+    case Cos:
+        return (float)std::cos((double)a);
+    case Tan:
+        return (float)std::tan((double)a);
+    case Atan:
+        return (float)std::atan((double)a);
+    case Log:
+        if (a < 0.f)
+            status = LogOfNegative;
+        return (float)std::log((double)a);
+    case Exp:
+        return (float)std::exp((double)a);
+    case Sqrt:
+        return (float)std::sqrt((double)a);
+    }
+    return 0.f;
+}
+
+int CalcProgram::constant(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    auto it = m_constants.find(bits);
+    if (it != m_constants.end())
+        return it->second;
+
+    Value v;
+    v.kind = Value::Constant;
+    v.constant = value;
+    v.input = nullptr;
+    m_values.push_back(v);
+    m_producer.push_back(-1);
+    m_constants[bits] = (int)m_values.size() - 1;
+    return (int)m_values.size() - 1;
+}
+
+int CalcProgram::input(const float *values)
+{
+    auto it = m_inputs.find(values);
+    if (it != m_inputs.end())
+        return it->second;
+
+    Value v;
+    v.kind = Value::Input;
+    v.constant = 0.f;
+    v.input = values;
+    m_values.push_back(v);
+    m_producer.push_back(-1);
+    m_inputs[values] = (int)m_values.size() - 1;
+    return (int)m_values.size() - 1;
+}
+
+int CalcProgram::operation(Opcode op, int a, int b)
+{
+    if (a < 0 || (!isUnary(op) && b < 0))
+        return -1;
+    if (isUnary(op))
+        b = -1;
+    else if ((op == Add || op == Mul) && b < a)
+        std::swap(a, b);
+
+    if (isConstant(a) && (b < 0 || isConstant(b)))
+    {
+        Status status = Ok;
+        float value = apply(op, constantValue(a), b < 0 ? 0.f : constantValue(b), status, m_zeroDivisions);
+        if (status != Ok)
+        {
+            m_status = status;
+            return -1;
+        }
+        return constant(value);
+    }
+
+    auto key = std::make_tuple((int)op, a, b);
+    auto it = m_known.find(key);
+    if (it != m_known.end())
+        return it->second;
+
+    Value v;
+    v.kind = Value::Result;
+    v.constant = 0.f;
+    v.input = nullptr;
+    m_values.push_back(v);
+    int result = (int)m_values.size() - 1;
+
+    Instruction ins;
+    ins.op = op;
+    ins.a = a;
+    ins.b = b;
+    ins.result = result;
+    m_instructions.push_back(ins);
+    m_producer.push_back((int)m_instructions.size() - 1);
+    m_known[key] = result;
+    return result;
+}
+
+bool CalcProgram::isConstant(int value) const
+{
+    return value >= 0 && m_values[value].kind == Value::Constant;
+}
+
+float CalcProgram::constantValue(int value) const
+{
+    return m_values[value].constant;
+}
+
+int CalcProgram::allocateRegisters(const std::vector<int> &values, std::vector<Instruction> &instructions, std::vector<int> &valueRegs) const
+{
+    // instructions needed for the requested values
+    std::vector<bool> needed(m_values.size(), false);
+    for (int v : values)
+        needed[v] = true;
+    for (auto ins = m_instructions.rbegin(); ins != m_instructions.rend(); ++ins)
+    {
+        if (!needed[ins->result])
+            continue;
+        needed[ins->a] = true;
+        if (ins->b >= 0)
+            needed[ins->b] = true;
+    }
+
+    std::vector<int> lastUse(m_values.size(), -1);
+    for (const auto &ins : m_instructions)
+    {
+        if (needed[ins.result])
+            instructions.push_back(ins);
+    }
+    for (size_t i = 0; i < instructions.size(); ++i)
+    {
+        lastUse[instructions[i].a] = (int)i;
+        if (instructions[i].b >= 0)
+            lastUse[instructions[i].b] = (int)i;
+    }
+    for (int v : values)
+        lastUse[v] = INT_MAX;
+
+    // the result may go to the register of an operand used for the last time,
+    // as every element only depends on the same element of the operands
+    valueRegs.assign(m_values.size(), -1);
+    std::vector<int> freeRegs;
+    int numRegs = 0;
+    for (size_t i = 0; i < instructions.size(); ++i)
+    {
+        Instruction &ins = instructions[i];
+        for (int op : {ins.a, ins.b})
+        {
+            // lastUse is reset, so that an operand used twice is freed once
+            if (op >= 0 && lastUse[op] == (int)i && valueRegs[op] >= 0)
+            {
+                freeRegs.push_back(valueRegs[op]);
+                lastUse[op] = -1;
+            }
+        }
+        if (freeRegs.empty())
+        {
+            ins.reg = numRegs++;
+        }
+        else
+        {
+            ins.reg = freeRegs.back();
+            freeRegs.pop_back();
+        }
+        valueRegs[ins.result] = ins.reg;
+    }
+    return numRegs;
+}
+
+const float *CalcProgram::operand(int value, const std::vector<int> &valueRegs, float *regs, size_t begin, bool &isConstant) const
+{
+    const Value &v = m_values[value];
+    isConstant = v.kind == Value::Constant;
+    switch (v.kind)
+    {
+    case Value::Constant:
+        return &v.constant;
+    case Value::Input:
+        return v.input + begin;
+    case Value::Result:
+        break;
+    }
+    return regs + (size_t)valueRegs[value] * BlockSize;
+}
+
+CalcProgram::Status CalcProgram::execute(const Instruction &ins, const std::vector<int> &valueRegs, float *regs, size_t begin, int n, size_t &zeroDivisions) const
+{
+    float *d = regs + (size_t)ins.reg * BlockSize;
+    bool constA = false, constB = false;
+    const float *a = operand(ins.a, valueRegs, regs, begin, constA);
+    const float *b = ins.b >= 0 ? operand(ins.b, valueRegs, regs, begin, constB) : nullptr;
+
+    switch (ins.op)
+    {
+    case Add:
+        binary(d, a, constA, b, constB, n, AddOp());
+        break;
+    case Sub:
+        binary(d, a, constA, b, constB, n, SubOp());
+        break;
+    case Mul:
+        binary(d, a, constA, b, constB, n, MulOp());
+        break;
+    case Div:
+        zeroDivisions += countZeros(b, constB, n);
+        binary(d, a, constA, b, constB, n, DivOp());
+        break;
+    case DivChecked:
+        if (countZeros(b, constB, n) > 0)
+            return DivisionByZero;
+        binary(d, a, constA, b, constB, n, DivCheckedOp());
+        break;
+    case Pow:
+        binary(d, a, constA, b, constB, n, PowOp());
+        break;
+    case Root:
+        binary(d, a, constA, b, constB, n, RootOp());
+        break;
+    case Neg:
+        unary(d, a, n, [](float x) { return -x; });
+        break;
+    case Sin:
+        unary(d, a, n, [](float x) { return (float)std::sin((double)x); });
+        break;
+    case Cos:
+        unary(d, a, n, [](float x) { return (float)std::cos((double)x); });
+        break;
+    case Tan:
+        unary(d, a, n, [](float x) { return (float)std::tan((double)x); });
+        break;
+    case Atan:
+        unary(d, a, n, [](float x) { return (float)std::atan((double)x); });
+        break;
+    case Log:
+    {
+        int negative = 0;
+        for (int i = 0; i < n; ++i)
+            negative += a[i] < 0.f;
+        if (negative > 0)
+            return LogOfNegative;
+        unary(d, a, n, [](float x) { return (float)std::log((double)x); });
+        break;
+    }
+    case Exp:
+        unary(d, a, n, [](float x) { return (float)std::exp((double)x); });
+        break;
+    case Sqrt:
+        unary(d, a, n, [](float x) { return (float)std::sqrt((double)x); });
+        break;
+    }
+    return Ok;
+}
+
+CalcProgram::Status CalcProgram::run(const std::vector<int> &values, const std::vector<float *> &outputs, size_t length, size_t *zeroDivisions) const
+{
+    std::vector<Instruction> instructions;
+    std::vector<int> valueRegs;
+    int numRegs = allocateRegisters(values, instructions, valueRegs);
+
+    coThreadPool &pool = coThreadPool::global();
+    std::vector<std::vector<float>> regs(pool.numThreads());
+    std::atomic<int> status{Ok};
+    std::atomic<size_t> zeros{0};
+    size_t numBlocks = (length + BlockSize - 1) / BlockSize;
+    pool.run(numBlocks, [&](size_t block, int thread)
+             {
+                 if (status != Ok)
+                     return;
+                 std::vector<float> &r = regs[thread];
+                 if (r.size() < (size_t)numRegs * BlockSize)
+                     r.resize((size_t)numRegs * BlockSize);
+
+                 size_t begin = block * BlockSize;
+                 int n = (int)std::min((size_t)BlockSize, length - begin);
+                 size_t z = 0;
+                 for (const auto &ins : instructions)
+                 {
+                     Status s = execute(ins, valueRegs, r.data(), begin, n, z);
+                     if (s != Ok)
+                     {
+                         int expected = Ok;
+                         status.compare_exchange_strong(expected, s);
+                         return;
+                     }
+                 }
+                 zeros += z;
+
+                 for (size_t i = 0; i < values.size(); ++i)
+                 {
+                     bool isConst = false;
+                     const float *v = operand(values[i], valueRegs, r.data(), begin, isConst);
+                     if (isConst)
+                         std::fill(outputs[i] + begin, outputs[i] + begin + n, *v);
+                     else
+                         memcpy(outputs[i] + begin, v, n * sizeof(float));
+                 }
+             });
+
+    if (zeroDivisions)
+        *zeroDivisions = zeros;
+    return (Status)status.load();
+}
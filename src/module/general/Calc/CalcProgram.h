@@ -0,0 +1,121 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#ifndef CALC_PROGRAM_H
+#define CALC_PROGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <vector>
+
+// A Calc expression compiled to instructions on registers of BlockSize
+// elements: vector operations become one instruction per component, so that
+// every instruction is a simple loop over a block of the input arrays.
+// Operations on constants are evaluated while building the program, and an
+// operation that has been added before returns the value computed then.
+// run() distributes the blocks over the threads of the global coThreadPool.
+class CalcProgram
+{
+public:
+    enum
+    {
+        BlockSize = 1024
+    };
+
+    enum Opcode
+    {
+        Add,
+        Sub,
+        Mul,
+        Div, // division by zero results in 0
+        DivChecked, // division by zero is an error
+        Pow,
+        Root,
+        Neg,
+        Sin,
+        Cos,
+        Tan,
+        Atan,
+        Log, // log of a negative number is an error
+        Exp,
+        Sqrt
+    };
+
+    enum Status
+    {
+        Ok,
+        DivisionByZero,
+        LogOfNegative
+    };
+
+    // values are identified by ints
+    int constant(float value);
+    // array with one value per element
+    int input(const float *values);
+    // op applied to a (and b for binary operations),
+    // -1 if constant operands lead to an error, see status()
+    int operation(Opcode op, int a, int b = -1);
+
+    bool isConstant(int value) const;
+    float constantValue(int value) const;
+    // error found while evaluating constant operands
+    Status status() const
+    {
+        return m_status;
+    }
+    // number of divisions of constants by zero
+    size_t zeroDivisions() const
+    {
+        return m_zeroDivisions;
+    }
+    size_t numInstructions() const
+    {
+        return m_instructions.size();
+    }
+
+    // compute values[i] for the elements [0, length) into outputs[i],
+    // zeroDivisions is the number of elements where Div divided by zero
+    Status run(const std::vector<int> &values, const std::vector<float *> &outputs, size_t length, size_t *zeroDivisions) const;
+
+private:
+    struct Value
+    {
+        enum Kind
+        {
+            Constant,
+            Input,
+            Result
+        } kind;
+        float constant;
+        const float *input;
+    };
+    struct Instruction
+    {
+        Opcode op;
+        int a, b, result;
+        int reg = -1; // register for result, -1 if it is not needed
+    };
+
+    static bool isUnary(Opcode op);
+    static float apply(Opcode op, float a, float b, Status &status, size_t &zeroDivisions);
+    // assign registers to the instructions needed for values, returns the number of registers
+    int allocateRegisters(const std::vector<int> &values, std::vector<Instruction> &instructions, std::vector<int> &valueRegs) const;
+    const float *operand(int value, const std::vector<int> &valueRegs, float *regs, size_t begin, bool &isConstant) const;
+    Status execute(const Instruction &ins, const std::vector<int> &valueRegs, float *regs, size_t begin, int n, size_t &zeroDivisions) const;
+
+    std::vector<Value> m_values;
+    std::vector<Instruction> m_instructions;
+    std::vector<int> m_producer; // value -> instruction computing it
+    std::map<std::tuple<int, int, int>, int> m_known; // (op, a, b) -> value
+    std::map<uint32_t, int> m_constants; // by bit pattern, so that NaN can be a key
+    std::map<const float *, int> m_inputs;
+    Status m_status = Ok;
+    size_t m_zeroDivisions = 0;
+};
+#endif
@@ -40,6 +40,9 @@ CellToVert::CellToVert(int argc, char *argv[])
     data_out = addOutputPort("DataOut0", "Float|Vec3", "data");
 
     setCopyAttributes(1);
+
+    // compute() only works on the objects at the ports
+    setComputeReentrant(true);
 }
 
 ////// hello
@@ -366,6 +366,9 @@ Colors::Colors(int argc, char *argv[])
     }
 
     initCOLORS();
+
+    // color the first timesteps while the modules above are still busy with the others
+    setStreaming(true);
 }
 
 // +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -914,7 +917,11 @@ int Colors::compute(const char *)
         }
     }
 
-    if (p_scaleNow && p_scaleNow->getValue() == 1)
+    // the range of a single streamed element only previews the colors,
+    // the parameters are set when the whole set arrives
+    const bool preview = isStreamedElement();
+
+    if (p_scaleNow && p_scaleNow->getValue() == 1 && !preview)
     {
         p_scaleNow->setValue(0);
         p_autoScale->setValue(0);
@@ -938,7 +945,8 @@ int Colors::compute(const char *)
         minmaxIn->getAddress(&mmdata);
         min = mmdata[0];
         max = mmdata[1];
-        updateMinMax(min, max);
+        if (!preview)
+            updateMinMax(min, max);
     }
 
     // ---- If have got a colormap object, it overrides everything else !
@@ -977,17 +985,20 @@ int Colors::compute(const char *)
 
                 case SPIKE_ADAPTIVE:
                     removeSpikesAdaptive(base, min, max);
-                    updateMinMax(min, max);
+                    if (!preview)
+                        updateMinMax(min, max);
                     break;
 
                 case SPIKE_INTERVAL:
                     removeSpikesInterval(base, min, max);
-                    updateMinMax(min, max);
+                    if (!preview)
+                        updateMinMax(min, max);
                     break;
 
                 case SPIKE_ELEMENTS:
                     removeSpikesElements(base, min, max);
-                    updateMinMax(min, max);
+                    if (!preview)
+                        updateMinMax(min, max);
                     break;
 
                 default:
@@ -1002,7 +1013,8 @@ int Colors::compute(const char *)
                 max = min + 1;
 
             // update values in Map (only done in new module styles)
-            updateMinMax(min, max);
+            if (!preview)
+                updateMinMax(min, max);
         }
 
         // number of steps in cmap
@@ -180,6 +180,15 @@ CuttingSurfaceModule::CuttingSurfaceModule(int argc, char *argv[])
     Polyhedra = coCoviseConfig::isOn("Module.CuttingSurfaceModule.SupportPolyhedra", true);
     maxPolyPerVertex = coCoviseConfig::getInt("Module.CuttingSurfaceModule.PolyPerVertex", 17);
     pointMode = true;
+    DoPostHandle = true;
+    reExecuting = false;
+
+    // elements of sets are cut in parallel, see computeMutex
+    setComputeReentrant(true);
+#ifndef _COMPLEX_MODULE_
+    // cut the first timesteps while the reader is still busy with the others
+    setStreaming(true);
+#endif
 
     /// Send old-style or new-style feedback: Default values different HLRS/Vrc
     fbStyle_ = FEED_NEW;
@@ -218,37 +227,59 @@ void CuttingSurfaceModule::comp_borders(int nb_elem, float *x, float *y, float *
     if (!p_genDummyS->getValue())
         return;
 
+    // compute() runs on several threads: merge the borders of this object at the end
+    float x_min = FLT_MAX, y_min = FLT_MAX, z_min = FLT_MAX;
+    float x_max = -FLT_MAX, y_max = -FLT_MAX, z_max = -FLT_MAX;
     int i;
     if (x)
     {
         for (i = 0; i < nb_elem; i++)
         {
-            if (x[i] > x_maxb)
-                x_maxb = x[i];
-            if (x[i] < x_minb)
-                x_minb = x[i];
+            if (x[i] > x_max)
+                x_max = x[i];
+            if (x[i] < x_min)
+                x_min = x[i];
         }
     }
     if (y)
     {
         for (i = 0; i < nb_elem; i++)
         {
-            if (y[i] > y_maxb)
-                y_maxb = y[i];
-            if (y[i] < y_minb)
-                y_minb = y[i];
+            if (y[i] > y_max)
+                y_max = y[i];
+            if (y[i] < y_min)
+                y_min = y[i];
         }
     }
     if (z)
     {
         for (i = 0; i < nb_elem; i++)
         {
-            if (z[i] > z_maxb)
-                z_maxb = z[i];
-            if (z[i] < z_minb)
-                z_minb = z[i];
+            if (z[i] > z_max)
+                z_max = z[i];
+            if (z[i] < z_min)
+                z_min = z[i];
         }
     }
+    merge_borders(x_min, x_max, y_min, y_max, z_min, z_max);
+}
+
+void CuttingSurfaceModule::merge_borders(float x_min, float x_max, float y_min, float y_max, float z_min, float z_max)
+{
+    std::lock_guard<std::mutex> guard(computeMutex);
+    if (x_max > x_maxb)
+        x_maxb = x_max;
+    if (y_max > y_maxb)
+        y_maxb = y_max;
+    if (z_max > z_maxb)
+        z_maxb = z_max;
+
+    if (x_min < x_minb)
+        x_minb = x_min;
+    if (y_min < y_minb)
+        y_minb = y_min;
+    if (z_min < z_minb)
+        z_minb = z_min;
 }
 
 //======================================================================
@@ -447,6 +478,7 @@ void
 CuttingSurfaceModule::preHandleObjects(coInputPort **)
 {
     ww_.reset();
+    cellSearch.prune();
     // Automatically adapt our Module's title to the species
     if (autoTitle)
     {
@@ -478,6 +510,8 @@ CuttingSurfaceModule::preHandleObjects(coInputPort **)
     param_vertex[2] += 0.00001f;
 
     DoPostHandle = true;
+    isDummy_ = false;
+    reExecuting = false;
     ini_borders();
 #ifdef _COMPLEX_MODULE_
     // check for 3dTex usage:
@@ -1149,7 +1183,6 @@ CuttingSurfaceModule::postHandleObjects(coOutputPort **outPorts)
 //======================================================================
 int CuttingSurfaceModule::compute(const char *)
 {
-    isDummy_ = false;
     if (p_option->getValue() == 0) // check that p_vertex is not null for a plane
     {
         if (p_vertex->getValue(0) == 0.0 && p_vertex->getValue(1) == 0.0 && p_vertex->getValue(2) == 0.0)
@@ -1248,6 +1281,7 @@ int CuttingSurfaceModule::compute(const char *)
     int numelem = 0, numconn, numcoord = 0, data_anz = 0, idata_anz = 0;
 
     float x_min, x_max, y_min, y_max, z_min, z_max;
+    int dataType = 1; // 1 scalar, 0 vector
     Plane *plane = NULL;
     STR_Plane *splane = NULL;
     RECT_Plane *rplane = NULL;
@@ -1294,19 +1328,19 @@ int CuttingSurfaceModule::compute(const char *)
         {
             data_anz = ub_data_in->getNumPoints();
             ub_data_in->getAddress(&bs_in);
-            DataType = 1;
+            dataType = 1;
         }
         else if (us_data_in)
         {
             data_anz = us_data_in->getNumPoints();
             us_data_in->getAddress(&s_in);
-            DataType = 1;
+            dataType = 1;
         }
         else if (uv_data_in)
         {
             data_anz = uv_data_in->getNumPoints();
             uv_data_in->getAddresses(&u_in, &v_in, &w_in);
-            DataType = 0;
+            dataType = 0;
         }
         else
         {
@@ -1318,6 +1352,11 @@ int CuttingSurfaceModule::compute(const char *)
         {
             sendWarning("Data object '%s' is empty", p_DataIn->getName());
         }
+        {
+            // for the dummy objects created in postHandleObjects
+            std::lock_guard<std::mutex> guard(computeMutex);
+            DataType = dataType;
+        }
     }
     else
     {
@@ -1345,19 +1384,7 @@ int CuttingSurfaceModule::compute(const char *)
             ugrid_in->getMinMax(&x_min, &x_max, &y_min, &y_max, &z_min, &z_max);
             numcoord = x_size * y_size * z_size;
             numelem = ((x_size - 1) * (y_size - 1) * (z_size - 1));
-            if (x_max > x_maxb)
-                x_maxb = x_max;
-            if (y_max > y_maxb)
-                y_maxb = y_max;
-            if (z_max > z_maxb)
-                z_maxb = z_max;
-
-            if (x_min < x_minb)
-                x_minb = x_min;
-            if (y_min < y_minb)
-                y_minb = y_min;
-            if (z_min < z_minb)
-                z_minb = z_min;
+            merge_borders(x_min, x_max, y_min, y_max, z_min, z_max);
         }
         else if (rgrid_in)
         {
@@ -1406,10 +1433,15 @@ int CuttingSurfaceModule::compute(const char *)
 
     if (grid_in)
     {
+        float allocRatio;
+        {
+            std::lock_guard<std::mutex> guard(computeMutex);
+            allocRatio = vertexAllocRatio;
+        }
         if ((Polyhedra) && (param_option == 0)) // polyhedra currently only supported for planar cuts
         {
             genstrips = false;
-            plane = new POLYHEDRON_Plane(numelem, numcoord, DataType, el, cl, tl,
+            plane = new POLYHEDRON_Plane(numelem, numcoord, dataType, el, cl, tl,
                                          x_in, y_in, z_in,
                                          s_in, bs_in, i_in,
                                          u_in, v_in, w_in,
@@ -1418,26 +1450,41 @@ int CuttingSurfaceModule::compute(const char *)
         }
         else
         {
-            plane = new Plane(numelem, numcoord, DataType, el, cl, tl,
+            plane = new Plane(numelem, numcoord, dataType, el, cl, tl,
                               x_in, y_in, z_in,
                               s_in, bs_in, i_in,
                               u_in, v_in, w_in,
-                              sgrid_in, grid_in, vertexAllocRatio, maxPolyPerVertex, planei, planej, planek, startx, starty, startz, myDistance,
+                              sgrid_in, grid_in, allocRatio, maxPolyPerVertex, planei, planej, planek, startx, starty, startz, myDistance,
                               radius, gennormals, param_option, genstrips, iblank);
         }
 
+        // moving the plane: only look at the cells close to it
+        std::shared_ptr<coCellBVH> search;
+        if (param_option == 0 && !iblank)
+        {
+            search = cellSearch.get(grid_in->getName(), [&]()
+                                    { return new coCellBVH(numelem, numconn, el, cl, tl, x_in, y_in, z_in); });
+            plane->useCellSearch(search.get());
+        }
+
         // plane->set_min_max(x_minb, y_minb, z_minb, x_maxb, y_maxb, z_maxb);
 
         // if we couldn't do it correctly - re-run
         if (!plane->createPlane())
         {
-            vertexAllocRatio += 1.0; //increase by 100%
-            p_vertexratio->setValue(vertexAllocRatio);
-
-            Covise::sendInfo("Increased VERTEX_RATIO to %f and re-exec", vertexAllocRatio);
-            // send execute message after 0.2 sec for network latency
-            setExecGracePeriod(0.2f);
-            selfExec();
+            // only once if several elements fail
+            std::lock_guard<std::mutex> guard(computeMutex);
+            if (!reExecuting)
+            {
+                reExecuting = true;
+                vertexAllocRatio += 1.0; //increase by 100%
+                p_vertexratio->setValue(vertexAllocRatio);
+
+                Covise::sendInfo("Increased VERTEX_RATIO to %f and re-exec", vertexAllocRatio);
+                // send execute message after 0.2 sec for network latency
+                setExecGracePeriod(0.2f);
+                selfExec();
+            }
 
             delete plane;
             return -1;
@@ -1446,7 +1493,7 @@ int CuttingSurfaceModule::compute(const char *)
 
     if (ugrid_in) // handle as rect. grids
     {
-        rplane = new RECT_Plane(numelem, numcoord, DataType,
+        rplane = new RECT_Plane(numelem, numcoord, dataType,
                                 el, cl, tl, x_in, y_in, z_in, s_in, bs_in, i_in, u_in, v_in, w_in,
                                 ugrid_in, x_size, y_size, z_size, maxPolyPerVertex,
                                 planei, planej, planek, startx, starty, startz, myDistance, radius,
@@ -1457,7 +1504,7 @@ int CuttingSurfaceModule::compute(const char *)
     }
     if (rgrid_in)
     {
-        rplane = new RECT_Plane(numelem, numcoord, DataType, el, cl, tl, x_in, y_in, z_in,
+        rplane = new RECT_Plane(numelem, numcoord, dataType, el, cl, tl, x_in, y_in, z_in,
                                 s_in, bs_in, i_in, u_in, v_in, w_in, rgrid_in, x_size, y_size, z_size,
                                 maxPolyPerVertex,
                                 planei, planej, planek, startx, starty, startz,
@@ -1468,7 +1515,7 @@ int CuttingSurfaceModule::compute(const char *)
     }
     if (sgrid_in)
     {
-        splane = new STR_Plane(numelem, numcoord, DataType, el, cl, tl, x_in, y_in, z_in,
+        splane = new STR_Plane(numelem, numcoord, dataType, el, cl, tl, x_in, y_in, z_in,
                                s_in, bs_in, i_in, u_in, v_in, w_in, sgrid_in, grid_in, x_size, y_size, z_size,
                                maxPolyPerVertex, planei, planej, planek, startx, starty, startz,
                                myDistance, radius, gennormals, param_option, genstrips, iblank);
@@ -1477,7 +1524,7 @@ int CuttingSurfaceModule::compute(const char *)
         plane = splane;
     }
 
-    if (DataType)
+    if (dataType)
         plane->createcoDistributedObjects(DataOut, NULL, NormalsOut, GridOut, gridAttrs, dataAttrs);
     else
         plane->createcoDistributedObjects(NULL, DataOut, NormalsOut, GridOut, gridAttrs, dataAttrs);
@@ -1488,7 +1535,7 @@ int CuttingSurfaceModule::compute(const char *)
         p_MeshOut->setCurrentObject(plane->get_obj_pol());
     if (gennormals)
         p_NormalsOut->setCurrentObject(plane->get_obj_normal());
-    if (DataType)
+    if (dataType)
         p_DataOut->setCurrentObject(plane->get_obj_scalar());
     else
         p_DataOut->setCurrentObject(plane->get_obj_vector());
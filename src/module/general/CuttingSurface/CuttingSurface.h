@@ -27,6 +27,10 @@
 
 #include <api/coSimpleModule.h>
 #include <do/coDoGeometry.h>
+#include <alg/coCellSearch.h>
+
+#include <atomic>
+#include <mutex>
 #ifdef _COMPLEX_MODULE_
 #include <alg/coColors.h>
 #endif
@@ -41,7 +45,7 @@ private:
     int maxPolyPerVertex; //maximal number of polygons dor one vertex
 
     // params and ports
-    int DataType; // 1 scalar, 0 vector
+    int DataType; // 1 scalar, 0 vector, of the last object computed
     bool Polyhedra; // use polyhedra support or not
 
     coInputPort *p_MeshIn, *p_DataIn, *p_IBlankIn;
@@ -63,7 +67,7 @@ private:
     coFloatVectorParam *p_minmax;
     coBooleanParam *p_autoScale;
 #endif
-    bool DoPostHandle;
+    std::atomic<bool> DoPostHandle;
 
     coBooleanParam *p_gennormals, *p_genstrips, *p_genDummyS;
     coFloatParam *p_scalar;
@@ -73,6 +77,9 @@ private:
 
     coFloatParam *p_vertexratio;
 
+    // cells of unstructured grids, for planar cuts
+    coCellSearchCache<coCellBVH> cellSearch;
+
     // private member functions
     void UpdateScalar(int);
     void UpdatePoint(int);
@@ -82,6 +89,7 @@ private:
 
     void ini_borders();
     void comp_borders(int nb_elem, float *x, float *y, float *z);
+    void merge_borders(float x_min, float x_max, float y_min, float y_max, float z_min, float z_max);
 
     float x_minb, x_maxb, y_minb, y_maxb, z_minb, z_maxb;
 
@@ -115,6 +123,12 @@ private:
 #endif
     bool isDummy_;
 
+    // compute() runs on several threads for the elements of a set:
+    // guards the borders, DataType, vertexAllocRatio and reExecuting
+    std::mutex computeMutex;
+    // selfExec() with a larger vertexAllocRatio has been requested
+    bool reExecuting;
+
     // which feedback to send, maybe both?
     enum FeedbackStyle
     {
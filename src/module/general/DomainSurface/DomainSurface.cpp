@@ -27,10 +27,13 @@
 
 #include "DomainSurface.h"
 #include <util/coviseCompat.h>
+#include <util/coThreadPool.h>
 #include <do/coDoStructuredGrid.h>
 #include <do/coDoUniformGrid.h>
 #include <do/coDoRectilinearGrid.h>
 
+#include <algorithm>
+
 SDomainsurface::SDomainsurface(int argc, char *argv[])
     : coSimpleModule(argc, argv, "Domain surfaces of grids")
 {
@@ -1120,11 +1123,27 @@ void SDomainsurface::doModule(const coDistributedObject *meshIn,
     int cuc_count;
     int *cuc, *cuc_pos;
     tmp_grid->getNeighborList(&cuc_count, &cuc, &cuc_pos);
+    neighbors = coUnstructuredNeighbors(numelem, numconn, el, cl, tl, cuc, cuc_pos);
     numelem_o = numelem;
     u_out = v_out = w_out = 0;
     lu_out = lv_out = lw_out = 0;
     // Surface polygons
-    surface();
+    if (getenv("COVISE_DOMAINSURFACE_COMPARE"))
+    {
+        double serialSeconds, parallelSeconds;
+        if (compareSurface(&serialSeconds, &parallelSeconds))
+            Covise::sendInfo("%d elements, %d polygons: serial %.1f ms, parallel %.1f ms on %d threads, identical results",
+                             numelem, num_elem, serialSeconds * 1000., parallelSeconds * 1000., coThreadPool::global().numThreads());
+    }
+    else if (std::find(tl, tl + numelem, TYPE_POLYHEDRON) != tl + numelem)
+    {
+        // parallelSurface() is faster on polyhedra even on one thread, for
+        // standard cells surface() stays until the crossover on several
+        // cores has been measured
+        parallelSurface();
+    }
+    else
+        surface();
     Polygons = new coDoPolygons(meshOutName, num_vert, x_out, y_out, z_out,
                                 num_conn, conn_list, num_elem, elem_list);
     if (!meshIn->getAttribute("COLOR")) // sonst koennten wir COLOR
@@ -2230,7 +2249,7 @@ void SDomainsurface::surface()
         {
 
             //Computation for hexahedra
-            if (tmp_grid->getNeighbor(i, cl[el[i]], cl[el[i] + 1], cl[el[i] + 5], cl[el[i] + 4]) < 0)
+            if (neighbors.getNeighbor(i, cl[el[i]], cl[el[i] + 1], cl[el[i] + 5], cl[el[i] + 4]) < 0)
             {
                 //sc: when two points of a quad are identical
                 if (test(cl[el[i]], cl[el[i] + 1], cl[el[i] + 5]) || test(cl[el[i]], cl[el[i] + 4], cl[el[i] + 5]))
@@ -2271,7 +2290,7 @@ void SDomainsurface::surface()
                     }
                 }
             }
-            if (tmp_grid->getNeighbor(i, cl[el[i] + 2], cl[el[i] + 3], cl[el[i] + 7], cl[el[i] + 6]) < 0)
+            if (neighbors.getNeighbor(i, cl[el[i] + 2], cl[el[i] + 3], cl[el[i] + 7], cl[el[i] + 6]) < 0)
             {
                 //sc: when two points of a quad are identical
                 if (test(cl[el[i] + 2], cl[el[i] + 3], cl[el[i] + 7]) || test(cl[el[i] + 2], cl[el[i] + 6], cl[el[i] + 7]))
@@ -2312,7 +2331,7 @@ void SDomainsurface::surface()
                     }
                 }
             }
-            if (tmp_grid->getNeighbor(i, cl[el[i] + 4], cl[el[i] + 5], cl[el[i] + 6], cl[el[i] + 7]) < 0)
+            if (neighbors.getNeighbor(i, cl[el[i] + 4], cl[el[i] + 5], cl[el[i] + 6], cl[el[i] + 7]) < 0)
             {
                 //sc: when two points of a quad are identical
                 if (test(cl[el[i] + 4], cl[el[i] + 5], cl[el[i] + 6]) || test(cl[el[i] + 4], cl[el[i] + 7], cl[el[i] + 6]))
@@ -2353,7 +2372,7 @@ void SDomainsurface::surface()
                     }
                 }
             }
-            if (tmp_grid->getNeighbor(i, cl[el[i]], cl[el[i] + 4], cl[el[i] + 7], cl[el[i] + 3]) < 0)
+            if (neighbors.getNeighbor(i, cl[el[i]], cl[el[i] + 4], cl[el[i] + 7], cl[el[i] + 3]) < 0)
             {
                 //sc: when two points of a quad are identical
                 if (test(cl[el[i]], cl[el[i] + 4], cl[el[i] + 7]) || test(cl[el[i]], cl[el[i] + 3], cl[el[i] + 7]))
@@ -2395,7 +2414,7 @@ void SDomainsurface::surface()
                 }
             }
 
-            if (tmp_grid->getNeighbor(i, cl[el[i] + 1], cl[el[i] + 2], cl[el[i] + 6], cl[el[i] + 5]) < 0)
+            if (neighbors.getNeighbor(i, cl[el[i] + 1], cl[el[i] + 2], cl[el[i] + 6], cl[el[i] + 5]) < 0)
             {
                 //sc: when two points of a quad are identical
                 if (test(cl[el[i] + 1], cl[el[i] + 2], cl[el[i] + 6]) || test(cl[el[i] + 1], cl[el[i] + 5], cl[el[i] + 6]))
@@ -2438,7 +2457,7 @@ void SDomainsurface::surface()
                 }
             }
 
-            if (tmp_grid->getNeighbor(i, cl[el[i]], cl[el[i] + 3], cl[el[i] + 2], cl[el[i] + 1]) < 0)
+            if (neighbors.getNeighbor(i, cl[el[i]], cl[el[i] + 3], cl[el[i] + 2], cl[el[i] + 1]) < 0)
             {
                 //sc: when two points of a quad are identical
                 if (test(cl[el[i]], cl[el[i] + 3], cl[el[i] + 2]) || test(cl[el[i]], cl[el[i] + 1], cl[el[i] + 2]))
@@ -2483,7 +2502,7 @@ void SDomainsurface::surface()
         break;
         case TYPE_TETRAHEDER:
         {
-            if (tmp_grid->getNeighbor(i, cl[el[i]], cl[el[i] + 2], cl[el[i] + 1]) < 0)
+            if (neighbors.getNeighbor(i, cl[el[i]], cl[el[i] + 2], cl[el[i] + 1]) < 0)
             {
                 if (test(cl[el[i]], cl[el[i] + 2], cl[el[i] + 1]))
                 {
@@ -2519,7 +2538,7 @@ void SDomainsurface::surface()
                     }
                 }
             }
-            if (tmp_grid->getNeighbor(i, cl[el[i]], cl[el[i] + 1], cl[el[i] + 3]) < 0)
+            if (neighbors.getNeighbor(i, cl[el[i]], cl[el[i] + 1], cl[el[i] + 3]) < 0)
             {
                 if (test(cl[el[i]], cl[el[i] + 1], cl[el[i] + 3]))
                 {
@@ -2555,7 +2574,7 @@ void SDomainsurface::surface()
                     }
                 }
             }
-            if (tmp_grid->getNeighbor(i, cl[el[i] + 3], cl[el[i] + 1], cl[el[i] + 2]) < 0)
+            if (neighbors.getNeighbor(i, cl[el[i] + 3], cl[el[i] + 1], cl[el[i] + 2]) < 0)
             {
                 if (test(cl[el[i] + 3], cl[el[i] + 1], cl[el[i] + 2]))
                 {
@@ -2591,7 +2610,7 @@ void SDomainsurface::surface()
                     }
                 }
             }
-            if (tmp_grid->getNeighbor(i, cl[el[i]], cl[el[i] + 3], cl[el[i] + 2]) < 0)
+            if (neighbors.getNeighbor(i, cl[el[i]], cl[el[i] + 3], cl[el[i] + 2]) < 0)
             {
                 if (test(cl[el[i]], cl[el[i] + 3], cl[el[i] + 2]))
                 {
@@ -2631,7 +2650,7 @@ void SDomainsurface::surface()
         break;
         case TYPE_PRISM:
         {
-            if (tmp_grid->getNeighbor(i, cl[el[i]], cl[el[i] + 2], cl[el[i] + 5], cl[el[i] + 3]) < 0)
+            if (neighbors.getNeighbor(i, cl[el[i]], cl[el[i] + 2], cl[el[i] + 5], cl[el[i] + 3]) < 0)
             {
                 //sc: when two points of a quad are identical
                 if (test(cl[el[i]], cl[el[i] + 2], cl[el[i] + 5]) || test(cl[el[i]], cl[el[i] + 3], cl[el[i] + 5]))
@@ -2672,7 +2691,7 @@ void SDomainsurface::surface()
                     }
                 }
             }
-            if (tmp_grid->getNeighbor(i, cl[el[i] + 5], cl[el[i] + 4], cl[el[i] + 3]) < 0)
+            if (neighbors.getNeighbor(i, cl[el[i] + 5], cl[el[i] + 4], cl[el[i] + 3]) < 0)
             {
                 if (test(cl[el[i] + 5], cl[el[i] + 4], cl[el[i] + 3]))
                 {
@@ -2708,7 +2727,7 @@ void SDomainsurface::surface()
                     }
                 }
             }
-            if (tmp_grid->getNeighbor(i, cl[el[i]], cl[el[i] + 3], cl[el[i] + 4], cl[el[i] + 1]) < 0)
+            if (neighbors.getNeighbor(i, cl[el[i]], cl[el[i] + 3], cl[el[i] + 4], cl[el[i] + 1]) < 0)
             {
                 //sc: when two points of a quad are identical
                 if (test(cl[el[i]], cl[el[i] + 3], cl[el[i] + 4]) || test(cl[el[i]], cl[el[i] + 1], cl[el[i] + 4]))
@@ -2749,7 +2768,7 @@ void SDomainsurface::surface()
                     }
                 }
             }
-            if (tmp_grid->getNeighbor(i, cl[el[i]], cl[el[i] + 1], cl[el[i] + 2]) < 0)
+            if (neighbors.getNeighbor(i, cl[el[i]], cl[el[i] + 1], cl[el[i] + 2]) < 0)
             {
                 if (test(cl[el[i]], cl[el[i] + 1], cl[el[i] + 2]))
                 {
@@ -2785,7 +2804,7 @@ void SDomainsurface::surface()
                     }
                 }
             }
-            if (tmp_grid->getNeighbor(i, cl[el[i] + 2], cl[el[i] + 5], cl[el[i] + 4], cl[el[i] + 1]) < 0)
+            if (neighbors.getNeighbor(i, cl[el[i] + 2], cl[el[i] + 5], cl[el[i] + 4], cl[el[i] + 1]) < 0)
             {
                 //sc: when two points of a quad are identical
                 if (test(cl[el[i] + 2], cl[el[i] + 5], cl[el[i] + 4]) || test(cl[el[i] + 2], cl[el[i] + 1], cl[el[i] + 4]))
@@ -2830,7 +2849,7 @@ void SDomainsurface::surface()
         break;
         case TYPE_PYRAMID:
         {
-            if (tmp_grid->getNeighbor(i, cl[el[i]], cl[el[i] + 1], cl[el[i] + 4]) < 0)
+            if (neighbors.getNeighbor(i, cl[el[i]], cl[el[i] + 1], cl[el[i] + 4]) < 0)
             {
                 if (test(cl[el[i]], cl[el[i] + 1], cl[el[i] + 4]))
                 {
@@ -2866,7 +2885,7 @@ void SDomainsurface::surface()
                     }
                 }
             }
-            if (tmp_grid->getNeighbor(i, cl[el[i]], cl[el[i] + 4], cl[el[i] + 3]) < 0)
+            if (neighbors.getNeighbor(i, cl[el[i]], cl[el[i] + 4], cl[el[i] + 3]) < 0)
             {
                 if (test(cl[el[i]], cl[el[i] + 4], cl[el[i] + 3]))
                 {
@@ -2902,7 +2921,7 @@ void SDomainsurface::surface()
                     }
                 }
             }
-            if (tmp_grid->getNeighbor(i, cl[el[i] + 2], cl[el[i] + 3], cl[el[i] + 4]) < 0)
+            if (neighbors.getNeighbor(i, cl[el[i] + 2], cl[el[i] + 3], cl[el[i] + 4]) < 0)
             {
                 if (test(cl[el[i] + 4], cl[el[i] + 2], cl[el[i] + 3]))
                 {
@@ -2938,7 +2957,7 @@ void SDomainsurface::surface()
                     }
                 }
             }
-            if (tmp_grid->getNeighbor(i, cl[el[i] + 1], cl[el[i] + 2], cl[el[i] + 4]) < 0)
+            if (neighbors.getNeighbor(i, cl[el[i] + 1], cl[el[i] + 2], cl[el[i] + 4]) < 0)
             {
                 if (test(cl[el[i] + 1], cl[el[i] + 2], cl[el[i] + 4]))
                 {
@@ -2974,7 +2993,7 @@ void SDomainsurface::surface()
                     }
                 }
             }
-            if (tmp_grid->getNeighbor(i, cl[el[i]], cl[el[i] + 3], cl[el[i] + 2], cl[el[i] + 1]) < 0)
+            if (neighbors.getNeighbor(i, cl[el[i]], cl[el[i] + 3], cl[el[i] + 2], cl[el[i] + 1]) < 0)
             {
                 //sc: when two points of a quad are identical
                 if (test(cl[el[i]], cl[el[i] + 3], cl[el[i] + 2]) || test(cl[el[i]], cl[el[i] + 1], cl[el[i] + 2]))
@@ -3033,7 +3052,7 @@ void SDomainsurface::surface()
                 sort(face_nodes.begin(), face_nodes.end());
                 vertices_found = false;
 
-                if (tmp_grid->getNeighbor(i, face_nodes) < 0)
+                if (neighbors.getNeighbor(i, face_nodes) < 0)
                 {
                     // Avoid degeneracies:  choose three consecutive vertices of the polygon which are different and not collinear
                     for (j = 0; j < face_polygon.size(); j++)
@@ -3307,6 +3326,13 @@ int SDomainsurface::add_vertex(int v)
 
 ////// normals
 int SDomainsurface::norm_check(int v1, int v2, int v3, int /* v4 */)
+{
+    float center[3] = { x_center, y_center, z_center };
+    return norm_check(center, v1, v2, v3);
+}
+
+// orientation of the face v1 v2 v3 with respect to the volume center
+int SDomainsurface::norm_check(const float center[3], int v1, int v2, int v3)
 {
     int r;
     float a[3], b[3], c[3], n[3];
@@ -3323,9 +3349,9 @@ int SDomainsurface::norm_check(int v1, int v2, int v3, int /* v4 */)
     n[2] = a[0] * b[1] - b[0] * a[1];
 
     // compute vector from base-point to volume-center
-    c[0] = x_center - x_in[v2];
-    c[1] = y_center - y_in[v2];
-    c[2] = z_center - z_in[v2];
+    c[0] = center[0] - x_in[v2];
+    c[1] = center[1] - y_in[v2];
+    c[2] = center[2] - z_in[v2];
     // look if normal is correct or not
     if ((c[0] * n[0] + c[1] * n[1] + c[2] * n[2]) > 0)
         r = 0;
@@ -3339,7 +3365,7 @@ int SDomainsurface::norm_check(int v1, int v2, int v3, int /* v4 */)
 //=====================================================================
 // test if surface should be displayed
 //=====================================================================
-inline int SDomainsurface::test(int v1, int v2, int v3)
+int SDomainsurface::test(int v1, int v2, int v3)
 {
     float l, n1x, n1y, n1z;
     n1x = ((y_in[v1] - y_in[v2]) * (z_in[v1] - z_in[v3])) - ((z_in[v1] - z_in[v2]) * (y_in[v1] - y_in[v3]));
@@ -3357,4 +3383,6 @@ inline int SDomainsurface::test(int v1, int v2, int v3)
         return 0;
 }
 
+#ifndef DOMAINSURFACE_BENCH
 MODULE_MAIN(Filter, SDomainsurface)
+#endif
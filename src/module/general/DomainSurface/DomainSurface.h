@@ -96,6 +96,7 @@ private:
     //////////////////////////////////////////////////////////
 
     coDoUnstructuredGrid *tmp_grid;
+    coUnstructuredNeighbors neighbors; // cells adjacent to the faces of tmp_grid
     coDoLines *Lines;
     coDoPolygons *Polygons;
     coDoFloat *SOut;
@@ -119,13 +120,25 @@ private:
                   coDistributedObject **ldataOut);
 
     void surface();
+    // same result as surface(), computed on all threads
+    struct SurfaceChunk;
+    void parallelSurface();
+    int faceKeys(int i, vector<int> &faceStart, vector<int> &faceConn, vector<int> &keyStart, vector<int> &keyConn);
+    bool compareSurface(double *serialSeconds, double *parallelSeconds);
     void lines();
     int test(int, int, int);
     int add_vertex(int v);
     int ladd_vertex(int v);
     int norm_check(int v1, int v2, int v3, int v4 = -1);
+    int norm_check(const float center[3], int v1, int v2, int v3);
 
 public:
     SDomainsurface(int argc, char *argv[]);
+
+    // surface() and parallelSurface() on an unstructured grid given by its
+    // arrays, for domainSurfaceBench: whether both give the same polygons
+    bool compareSurface(int numElem, int numConn, int numCoord,
+                        int *elem, int *conn, int *types, float *x, float *y, float *z,
+                        double *serialSeconds, double *parallelSeconds, int *numPolygons);
 };
 #endif
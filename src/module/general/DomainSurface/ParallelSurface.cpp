@@ -0,0 +1,675 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+// Boundary extraction of unstructured grids on all threads of the global
+// coThreadPool. The result is identical to surface(): faces are emitted in
+// the same order and with the same orientation, and the vertices are numbered
+// in the order of their first use.
+
+#include "DomainSurface.h"
+#include <util/coviseCompat.h>
+#include <util/coThreadPool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <memory>
+
+namespace
+{
+// faces of the standard cells in the order in which surface() visits them:
+// vertices for the neighbor search, one or two triangles for test(),
+// the triangle for norm_check() and the polygon if norm_check() is true/false
+struct Face
+{
+    int numVertices;
+    int neighbor[4];
+    int numTests;
+    int test[2][3];
+    int normal[3];
+    int correct[4];
+    int flipped[4];
+};
+
+const Face hexFaces[] = {
+    { 4, { 0, 1, 5, 4 }, 2, { { 0, 1, 5 }, { 0, 4, 5 } }, { 0, 1, 5 }, { 1, 5, 4, 0 }, { 4, 5, 1, 0 } },
+    { 4, { 2, 3, 7, 6 }, 2, { { 2, 3, 7 }, { 2, 6, 7 } }, { 2, 3, 7 }, { 3, 7, 6, 2 }, { 6, 7, 3, 2 } },
+    { 4, { 4, 5, 6, 7 }, 2, { { 4, 5, 6 }, { 4, 7, 6 } }, { 4, 5, 6 }, { 5, 6, 7, 4 }, { 7, 6, 5, 4 } },
+    { 4, { 0, 4, 7, 3 }, 2, { { 0, 4, 7 }, { 0, 3, 7 } }, { 0, 4, 7 }, { 0, 4, 7, 3 }, { 3, 7, 4, 0 } },
+    { 4, { 1, 2, 6, 5 }, 2, { { 1, 2, 6 }, { 1, 5, 6 } }, { 1, 2, 6 }, { 1, 2, 6, 5 }, { 5, 6, 2, 1 } },
+    { 4, { 0, 3, 2, 1 }, 2, { { 0, 3, 2 }, { 0, 1, 2 } }, { 0, 3, 2 }, { 0, 3, 2, 1 }, { 1, 2, 3, 0 } },
+};
+const Face tetFaces[] = {
+    { 3, { 0, 2, 1, 0 }, 1, { { 0, 2, 1 }, { 0, 0, 0 } }, { 0, 2, 1 }, { 0, 1, 2, 0 }, { 1, 2, 0, 0 } },
+    { 3, { 0, 1, 3, 0 }, 1, { { 0, 1, 3 }, { 0, 0, 0 } }, { 0, 1, 3 }, { 0, 3, 1, 0 }, { 3, 1, 0, 0 } },
+    { 3, { 3, 1, 2, 0 }, 1, { { 3, 1, 2 }, { 0, 0, 0 } }, { 3, 1, 2 }, { 3, 2, 1, 0 }, { 2, 1, 3, 0 } },
+    { 3, { 0, 3, 2, 0 }, 1, { { 0, 3, 2 }, { 0, 0, 0 } }, { 0, 3, 2 }, { 0, 2, 3, 0 }, { 2, 3, 0, 0 } },
+};
+const Face prismFaces[] = {
+    { 4, { 0, 2, 5, 3 }, 2, { { 0, 2, 5 }, { 0, 3, 5 } }, { 0, 2, 5 }, { 0, 2, 5, 3 }, { 3, 5, 2, 0 } },
+    { 3, { 5, 4, 3, 0 }, 1, { { 5, 4, 3 }, { 0, 0, 0 } }, { 5, 4, 3 }, { 5, 4, 3, 0 }, { 3, 4, 5, 0 } },
+    { 4, { 0, 3, 4, 1 }, 2, { { 0, 3, 4 }, { 0, 1, 4 } }, { 0, 3, 4 }, { 0, 3, 4, 1 }, { 1, 4, 3, 0 } },
+    { 3, { 0, 1, 2, 0 }, 1, { { 0, 1, 2 }, { 0, 0, 0 } }, { 0, 1, 2 }, { 0, 1, 2, 0 }, { 2, 1, 0, 0 } },
+    { 4, { 2, 5, 4, 1 }, 2, { { 2, 5, 4 }, { 2, 1, 4 } }, { 2, 5, 4 }, { 2, 1, 4, 5 }, { 1, 4, 5, 2 } },
+};
+const Face pyramidFaces[] = {
+    { 3, { 0, 1, 4, 0 }, 1, { { 0, 1, 4 }, { 0, 0, 0 } }, { 0, 1, 4 }, { 0, 4, 1, 0 }, { 4, 1, 0, 0 } },
+    { 3, { 0, 4, 3, 0 }, 1, { { 0, 4, 3 }, { 0, 0, 0 } }, { 0, 4, 3 }, { 0, 3, 4, 0 }, { 3, 4, 0, 0 } },
+    { 3, { 2, 3, 4, 0 }, 1, { { 4, 2, 3 }, { 0, 0, 0 } }, { 2, 3, 4 }, { 2, 4, 3, 0 }, { 4, 3, 2, 0 } },
+    { 3, { 1, 2, 4, 0 }, 1, { { 1, 2, 4 }, { 0, 0, 0 } }, { 1, 2, 4 }, { 1, 4, 2, 0 }, { 4, 2, 1, 0 } },
+    { 4, { 0, 3, 2, 1 }, 2, { { 0, 3, 2 }, { 0, 1, 2 } }, { 0, 3, 2 }, { 0, 1, 2, 3 }, { 1, 2, 3, 0 } },
+};
+
+const Face *standardFaces(int type, int *numFaces)
+{
+    switch (type)
+    {
+    case TYPE_HEXAGON:
+        *numFaces = sizeof(hexFaces) / sizeof(hexFaces[0]);
+        return hexFaces;
+    case TYPE_TETRAHEDER:
+        *numFaces = sizeof(tetFaces) / sizeof(tetFaces[0]);
+        return tetFaces;
+    case TYPE_PRISM:
+        *numFaces = sizeof(prismFaces) / sizeof(prismFaces[0]);
+        return prismFaces;
+    case TYPE_PYRAMID:
+        *numFaces = sizeof(pyramidFaces) / sizeof(pyramidFaces[0]);
+        return pyramidFaces;
+    }
+    *numFaces = 0;
+    return NULL;
+}
+
+// split the connectivity of polyhedron i into faces like surface() does:
+// a face is closed when its first vertex appears again
+void polyhedronFaces(const int *el, const int *cl, int numelem, int numconn, int i,
+                     vector<int> &faceStart, vector<int> &faceConn)
+{
+    faceStart.clear();
+    faceConn.clear();
+    int next_elem_index = (i < numelem - 1) ? el[i + 1] : numconn;
+    int start_vertex = -1;
+    bool start_vertex_set = false;
+    for (int j = el[i]; j < next_elem_index; j++)
+    {
+        if (start_vertex_set)
+        {
+            if (cl[j] == start_vertex)
+                start_vertex_set = false;
+            else
+                faceConn.push_back(cl[j]);
+        }
+        else
+        {
+            start_vertex = cl[j];
+            faceStart.push_back((int)faceConn.size());
+            faceConn.push_back(start_vertex);
+            start_vertex_set = true;
+        }
+    }
+    faceStart.push_back((int)faceConn.size());
+}
+
+// entry of the face table, faces of different elements with equal keys are inner faces
+struct FaceKey
+{
+    uint64_t hash;
+    int element;
+    unsigned short face; // within element
+    unsigned short numVertices;
+    int vertices[4]; // smallest vertices of the face
+};
+
+void makeKey(FaceKey &key, const int *sorted, int n)
+{
+    uint64_t h = 14695981039346656037ULL;
+    for (int k = 0; k < n; k++)
+        h = (h ^ (uint32_t)sorted[k]) * 1099511628211ULL;
+    key.hash = h;
+    key.numVertices = (unsigned short)std::min(n, 65535);
+    for (int k = 0; k < 4; k++)
+        key.vertices[k] = k < n ? sorted[k] : -1;
+}
+}
+
+// output of a contiguous range of elements
+struct SDomainsurface::SurfaceChunk
+{
+    vector<int> elem; // start of the polygons in conn
+    vector<int> conn; // grid vertices
+    vector<float> u, v, w; // per polygon data
+    vector<int> bars;
+    bool unsupported = false;
+};
+
+// faces of element i with sorted vertices, for matching the faces of different elements
+int SDomainsurface::faceKeys(int i, vector<int> &faceStart, vector<int> &faceConn, vector<int> &keyStart, vector<int> &keyConn)
+{
+    keyStart.clear();
+    keyConn.clear();
+    int numFaces = 0;
+    const Face *faces = standardFaces(tl[i], &numFaces);
+    if (faces)
+    {
+        for (int f = 0; f < numFaces; f++)
+        {
+            keyStart.push_back((int)keyConn.size());
+            for (int k = 0; k < faces[f].numVertices; k++)
+                keyConn.push_back(cl[el[i] + faces[f].neighbor[k]]);
+        }
+    }
+    else if (tl[i] == TYPE_POLYHEDRON)
+    {
+        polyhedronFaces(el, cl, numelem, numconn, i, faceStart, faceConn);
+        numFaces = (int)faceStart.size() - 1;
+        keyStart.assign(faceStart.begin(), faceStart.end() - 1);
+        keyConn = faceConn;
+    }
+    else if (tl[i] == TYPE_QUAD || tl[i] == TYPE_TRIANGLE)
+    {
+        // 2D cells hide the faces of volume cells they are attached to
+        numFaces = 1;
+        keyStart.push_back(0);
+        keyConn.assign(cl + el[i], cl + el[i] + (tl[i] == TYPE_QUAD ? 4 : 3));
+    }
+    keyStart.push_back((int)keyConn.size());
+    for (int f = 0; f < numFaces; f++)
+        std::sort(keyConn.begin() + keyStart[f], keyConn.begin() + keyStart[f + 1]);
+    return numFaces;
+}
+
+//=====================================================================
+// create the surface of a domain on all threads
+//=====================================================================
+void SDomainsurface::parallelSurface()
+{
+    coThreadPool &pool = coThreadPool::global();
+    const int numThreads = pool.numThreads();
+    const int chunkSize = 4096;
+    const int numChunks = (numelem + chunkSize - 1) / chunkSize;
+
+    //
+    // faces with the same vertices as a face of another element are inner faces;
+    // the remaining faces are checked with getNeighbor like in surface(),
+    // which also catches non-conforming and degenerated neighbors
+    //
+    const int numKeyChunks = std::max(1, std::min(numChunks, 4 * numThreads));
+    const int keyChunkSize = (numelem + numKeyChunks - 1) / std::max(1, numKeyChunks);
+    int numBuckets = 64;
+    while (numBuckets < 16384 && (size_t)numBuckets * 1024 < (size_t)numelem * 6)
+        numBuckets *= 2;
+
+    // count the faces per bucket and chunk
+    vector<size_t> bucketOffset((size_t)numBuckets * numKeyChunks + 1, 0); // by bucket, then chunk
+    vector<size_t> faceOffset(numelem + 1, 0);
+    pool.run(numKeyChunks, [&](size_t c, int)
+             {
+                 vector<int> faceStart, faceConn, keyStart, keyConn;
+                 int end = std::min(numelem, (int)(c + 1) * keyChunkSize);
+                 for (int i = (int)c * keyChunkSize; i < end; i++)
+                 {
+                     int numFaces = faceKeys(i, faceStart, faceConn, keyStart, keyConn);
+                     faceOffset[i + 1] = numFaces;
+                     for (int f = 0; f < numFaces; f++)
+                     {
+                         FaceKey key;
+                         makeKey(key, &keyConn[keyStart[f]], keyStart[f + 1] - keyStart[f]);
+                         bucketOffset[(key.hash % numBuckets) * numKeyChunks + c + 1]++;
+                     }
+                 }
+             });
+    for (int i = 0; i < numelem; i++)
+        faceOffset[i + 1] += faceOffset[i];
+    for (size_t k = 1; k < bucketOffset.size(); k++)
+        bucketOffset[k] += bucketOffset[k - 1];
+
+    // the keys of consecutive buckets are matched in passes that hold at most
+    // MaxKeysPerPass keys (unless a single bucket is larger), the keys are
+    // computed again for every pass and stored in the order of their buckets
+    const size_t MaxKeysPerPass = (size_t)1 << 26;
+    vector<char> shared(faceOffset[numelem], 0);
+    vector<FaceKey> passKeys;
+    for (int firstBucket = 0; firstBucket < numBuckets;)
+    {
+        const size_t passBegin = bucketOffset[(size_t)firstBucket * numKeyChunks];
+        int lastBucket = firstBucket + 1;
+        while (lastBucket < numBuckets && bucketOffset[(size_t)(lastBucket + 1) * numKeyChunks] - passBegin <= MaxKeysPerPass)
+            lastBucket++;
+        const size_t passEnd = bucketOffset[(size_t)lastBucket * numKeyChunks];
+        passKeys.resize(passEnd - passBegin);
+
+        pool.run(numKeyChunks, [&](size_t c, int)
+                 {
+                     vector<int> faceStart, faceConn, keyStart, keyConn;
+                     vector<size_t> next(numBuckets);
+                     for (int b = firstBucket; b < lastBucket; b++)
+                         next[b] = bucketOffset[(size_t)b * numKeyChunks + c] - passBegin;
+                     int end = std::min(numelem, (int)(c + 1) * keyChunkSize);
+                     for (int i = (int)c * keyChunkSize; i < end; i++)
+                     {
+                         int numFaces = faceKeys(i, faceStart, faceConn, keyStart, keyConn);
+                         for (int f = 0; f < numFaces; f++)
+                         {
+                             FaceKey key;
+                             makeKey(key, &keyConn[keyStart[f]], keyStart[f + 1] - keyStart[f]);
+                             int b = (int)(key.hash % numBuckets);
+                             if (b < firstBucket || b >= lastBucket)
+                                 continue;
+                             key.element = i;
+                             key.face = (unsigned short)f;
+                             passKeys[next[b]++] = key;
+                         }
+                     }
+                 });
+
+        // match the faces of each bucket in a hash table
+        pool.run(lastBucket - firstBucket, [&](size_t n, int)
+                 {
+                     const size_t b = firstBucket + n;
+                     const size_t first = bucketOffset[b * numKeyChunks] - passBegin;
+                     const size_t last = bucketOffset[(b + 1) * numKeyChunks] - passBegin;
+                     size_t size = 16;
+                     while (size < 2 * (last - first))
+                         size *= 2;
+                     vector<size_t> table(size, SIZE_MAX);
+                     vector<int> faceStart, faceConn, keyStart1, keyConn1, keyStart2, keyConn2;
+                     for (size_t k = first; k < last; k++)
+                     {
+                         const FaceKey &key = passKeys[k];
+                         // the low bits select the bucket
+                         size_t slot = (key.hash / numBuckets) & (size - 1);
+                         for (; table[slot] != SIZE_MAX; slot = (slot + 1) & (size - 1))
+                         {
+                             const FaceKey &other = passKeys[table[slot]];
+                             if (other.hash != key.hash || other.element == key.element || other.numVertices != key.numVertices
+                                 || !std::equal(key.vertices, key.vertices + 4, other.vertices))
+                                 continue;
+                             if (key.numVertices > 4)
+                             {
+                                 // compare the vertices, as different faces may have the same hash
+                                 faceKeys(key.element, faceStart, faceConn, keyStart1, keyConn1);
+                                 faceKeys(other.element, faceStart, faceConn, keyStart2, keyConn2);
+                                 if (!std::equal(keyConn1.begin() + keyStart1[key.face], keyConn1.begin() + keyStart1[key.face + 1],
+                                                 keyConn2.begin() + keyStart2[other.face]))
+                                     continue;
+                             }
+                             shared[faceOffset[key.element] + key.face] = 1;
+                             shared[faceOffset[other.element] + other.face] = 1;
+                             break;
+                         }
+                         if (table[slot] == SIZE_MAX)
+                             table[slot] = k;
+                     }
+                 });
+        firstBucket = lastBucket;
+    }
+    vector<FaceKey>().swap(passKeys);
+
+    //
+    // polygons of each chunk of elements in the order of surface()
+    //
+    vector<SurfaceChunk> chunks(numChunks);
+    pool.run(numChunks, [&](size_t c, int)
+             {
+                 SurfaceChunk &chunk = chunks[c];
+                 vector<int> faceStart, faceConn, vertices, face_nodes;
+                 int end = std::min(numelem, (int)(c + 1) * chunkSize);
+                 for (int i = (int)c * chunkSize; i < end; i++)
+                 {
+                     const int *cell = cl + el[i];
+                     auto addPolygon = [&](const int *polygon, int n, int offset)
+                     {
+                         if (DataType == DATA_S_E)
+                         {
+                             chunk.u.push_back(u_in[i]);
+                         }
+                         else if (DataType == DATA_V_E)
+                         {
+                             chunk.u.push_back(u_in[i]);
+                             chunk.v.push_back(v_in[i]);
+                             chunk.w.push_back(w_in[i]);
+                         }
+                         chunk.elem.push_back((int)chunk.conn.size());
+                         for (int k = 0; k < n; k++)
+                             chunk.conn.push_back(offset < 0 ? polygon[k] : cell[polygon[k]]);
+                     };
+
+                     int numFaces = 0;
+                     const Face *faces = standardFaces(tl[i], &numFaces);
+                     if (faces)
+                     {
+                         // volume center for the orientation of the faces
+                         int numCorners = (tl[i] == TYPE_HEXAGON) ? 8 : (tl[i] == TYPE_TETRAHEDER) ? 4 : (tl[i] == TYPE_PRISM) ? 6 : 5;
+                         float center[3] = { 0.f, 0.f, 0.f };
+                         for (int a = 0; a < numCorners; a++)
+                         {
+                             center[0] += x_in[cell[a]];
+                             center[1] += y_in[cell[a]];
+                             center[2] += z_in[cell[a]];
+                         }
+                         for (int a = 0; a < 3; a++)
+                             center[a] /= (float)numCorners;
+
+                         for (int f = 0; f < numFaces; f++)
+                         {
+                             const Face &face = faces[f];
+                             if (shared[faceOffset[i] + f])
+                                 continue;
+                             int nb = (face.numVertices == 4)
+                                          ? neighbors.getNeighbor(i, cell[face.neighbor[0]], cell[face.neighbor[1]], cell[face.neighbor[2]], cell[face.neighbor[3]])
+                                          : neighbors.getNeighbor(i, cell[face.neighbor[0]], cell[face.neighbor[1]], cell[face.neighbor[2]]);
+                             if (nb >= 0)
+                                 continue;
+                             //sc: when two points of a quad are identical
+                             if (!test(cell[face.test[0][0]], cell[face.test[0][1]], cell[face.test[0][2]])
+                                 && (face.numTests < 2 || !test(cell[face.test[1][0]], cell[face.test[1][1]], cell[face.test[1][2]])))
+                                 continue;
+                             if (norm_check(center, cell[face.normal[0]], cell[face.normal[1]], cell[face.normal[2]]))
+                                 addPolygon(face.correct, face.numVertices, 0);
+                             else
+                                 addPolygon(face.flipped, face.numVertices, 0);
+                         }
+                         continue;
+                     }
+
+                     switch (tl[i])
+                     {
+                     case TYPE_POLYHEDRON:
+                     {
+                         polyhedronFaces(el, cl, numelem, numconn, i, faceStart, faceConn);
+
+                         // volume center from the distinct vertices
+                         vertices = faceConn;
+                         std::sort(vertices.begin(), vertices.end());
+                         vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+                         float center[3] = { 0.f, 0.f, 0.f };
+                         for (size_t a = 0; a < vertices.size(); a++)
+                         {
+                             center[0] += x_in[vertices[a]];
+                             center[1] += y_in[vertices[a]];
+                             center[2] += z_in[vertices[a]];
+                         }
+                         for (int a = 0; a < 3; a++)
+                             center[a] /= (float)vertices.size();
+
+                         for (int f = 0; f + 1 < (int)faceStart.size(); f++)
+                         {
+                             const int *polygon = &faceConn[faceStart[f]];
+                             int n = faceStart[f + 1] - faceStart[f];
+                             if (shared[faceOffset[i] + f])
+                                 continue;
+                             face_nodes.assign(polygon, polygon + n);
+                             std::sort(face_nodes.begin(), face_nodes.end());
+                             if (neighbors.getNeighbor(i, face_nodes) >= 0)
+                                 continue;
+
+                             // Avoid degeneracies:  choose three consecutive vertices of the polygon which are different and not collinear
+                             int v1 = 0, v2 = 0, v3 = 0;
+                             bool vertices_found = false;
+                             for (int j = 0; j < n; j++)
+                             {
+                                 v1 = polygon[j];
+                                 v2 = polygon[(j + 1) % n];
+                                 v3 = polygon[(j + 2) % n];
+
+                                 float normx = (y_in[v1] - y_in[v2]) * (z_in[v3] - z_in[v2]) - (z_in[v1] - z_in[v2]) * (y_in[v3] - y_in[v2]);
+                                 float normy = (z_in[v1] - z_in[v2]) * (x_in[v3] - x_in[v2]) - (x_in[v1] - x_in[v2]) * (z_in[v3] - z_in[v2]);
+                                 float normz = (x_in[v1] - x_in[v2]) * (y_in[v3] - y_in[v2]) - (y_in[v1] - y_in[v2]) * (x_in[v3] - x_in[v2]);
+                                 if (normx != 0 || normy != 0 || normz != 0)
+                                 {
+                                     vertices_found = true;
+                                     break;
+                                 }
+                             }
+                             if (!vertices_found || !test(v1, v2, v3))
+                                 continue;
+
+                             if (norm_check(center, v1, v2, v3))
+                             {
+                                 addPolygon(polygon, n, -1);
+                             }
+                             else
+                             {
+                                 vector<int> reversed(polygon, polygon + n);
+                                 std::reverse(reversed.begin(), reversed.end());
+                                 addPolygon(&reversed[0], n, -1);
+                             }
+                         }
+                     }
+                     break;
+
+                     case TYPE_QUAD:
+                     case TYPE_TRIANGLE:
+                     {
+                         static const int polygon[] = { 0, 1, 2, 3 };
+                         if (test(cell[0], cell[1], cell[2]))
+                             addPolygon(polygon, tl[i] == TYPE_QUAD ? 4 : 3, 0);
+                     }
+                     break;
+
+                     case TYPE_BAR: // no surface representation possible
+                         chunk.bars.push_back(i);
+                         break;
+
+                     case TYPE_POINT: // no surface/line representation possible
+                         break;
+
+                     default:
+                         chunk.unsupported = true;
+                         break;
+                     }
+                 }
+             });
+
+    //
+    // concatenate the chunks
+    //
+    vector<int> connBase(numChunks + 1, 0), elemBase(numChunks + 1, 0);
+    num_bar = 0;
+    bool unsupported = false;
+    for (int c = 0; c < numChunks; c++)
+    {
+        connBase[c + 1] = connBase[c] + (int)chunks[c].conn.size();
+        elemBase[c + 1] = elemBase[c] + (int)chunks[c].elem.size();
+        num_bar += (int)chunks[c].bars.size();
+        unsupported |= chunks[c].unsupported;
+    }
+    if (unsupported)
+        Covise::sendError("ERROR: unsupported grid type detected");
+    num_conn = connBase[numChunks];
+    num_elem = elemBase[numChunks];
+
+    elemMap = new int[num_bar];
+    int nb = 0;
+    for (int c = 0; c < numChunks; c++)
+    {
+        for (size_t k = 0; k < chunks[c].bars.size(); k++)
+            elemMap[nb++] = chunks[c].bars[k];
+    }
+
+    //
+    // vertices are numbered in the order of their first use, like add_vertex() does
+    //
+    std::unique_ptr<std::atomic<int>[]> firstUse(new std::atomic<int>[numcoord]);
+    const int vertexBlock = 65536;
+    const int numVertexBlocks = (numcoord + vertexBlock - 1) / vertexBlock;
+    pool.run(numVertexBlocks, [&](size_t b, int)
+             {
+                 int end = std::min(numcoord, (int)(b + 1) * vertexBlock);
+                 for (int v = (int)b * vertexBlock; v < end; v++)
+                     firstUse[v].store(INT_MAX, std::memory_order_relaxed);
+             });
+    pool.run(numChunks, [&](size_t c, int)
+             {
+                 const vector<int> &conn = chunks[c].conn;
+                 for (size_t k = 0; k < conn.size(); k++)
+                 {
+                     int pos = connBase[c] + (int)k;
+                     int current = firstUse[conn[k]].load(std::memory_order_relaxed);
+                     while (pos < current && !firstUse[conn[k]].compare_exchange_weak(current, pos, std::memory_order_relaxed))
+                     {
+                     }
+                 }
+             });
+
+    vector<int> vertBase(numChunks + 1, 0);
+    pool.run(numChunks, [&](size_t c, int)
+             {
+                 const vector<int> &conn = chunks[c].conn;
+                 int count = 0;
+                 for (size_t k = 0; k < conn.size(); k++)
+                     count += firstUse[conn[k]].load(std::memory_order_relaxed) == connBase[c] + (int)k;
+                 vertBase[c + 1] = count;
+             });
+    for (int c = 0; c < numChunks; c++)
+        vertBase[c + 1] += vertBase[c];
+    num_vert = vertBase[numChunks];
+
+    conn_tag = new int[numcoord];
+    memset(conn_tag, -1, numcoord * sizeof(int));
+    conn_list = new int[num_conn];
+    elem_list = new int[num_elem];
+    x_out = new float[num_vert];
+    y_out = new float[num_vert];
+    z_out = new float[num_vert];
+    int numData = (DataType == DATA_S || DataType == DATA_V) ? num_vert : (DataType == DATA_S_E || DataType == DATA_V_E) ? num_elem : 0;
+    bool vectorData = (DataType == DATA_V || DataType == DATA_V_E);
+    u_out = new float[numData];
+    v_out = new float[vectorData ? numData : 0];
+    w_out = new float[vectorData ? numData : 0];
+
+    pool.run(numChunks, [&](size_t c, int)
+             {
+                 const SurfaceChunk &chunk = chunks[c];
+                 int id = vertBase[c];
+                 for (size_t k = 0; k < chunk.conn.size(); k++)
+                 {
+                     int v = chunk.conn[k];
+                     if (firstUse[v].load(std::memory_order_relaxed) != connBase[c] + (int)k)
+                         continue;
+                     conn_tag[v] = id;
+                     x_out[id] = x_in[v];
+                     y_out[id] = y_in[v];
+                     z_out[id] = z_in[v];
+                     if (DataType == DATA_S || DataType == DATA_V)
+                         u_out[id] = u_in[v];
+                     if (DataType == DATA_V)
+                     {
+                         v_out[id] = v_in[v];
+                         w_out[id] = w_in[v];
+                     }
+                     id++;
+                 }
+                 for (size_t e = 0; e < chunk.elem.size(); e++)
+                     elem_list[elemBase[c] + e] = connBase[c] + chunk.elem[e];
+                 if (DataType == DATA_S_E || DataType == DATA_V_E)
+                 {
+                     std::copy(chunk.u.begin(), chunk.u.end(), u_out + elemBase[c]);
+                     std::copy(chunk.v.begin(), chunk.v.end(), v_out + elemBase[c]);
+                     std::copy(chunk.w.begin(), chunk.w.end(), w_out + elemBase[c]);
+                 }
+             });
+    pool.run(numChunks, [&](size_t c, int)
+             {
+                 const vector<int> &conn = chunks[c].conn;
+                 for (size_t k = 0; k < conn.size(); k++)
+                     conn_list[connBase[c] + k] = conn_tag[conn[k]];
+             });
+}
+
+//=====================================================================
+// run surface() and parallelSurface() and compare their results
+// (COVISE_DOMAINSURFACE_COMPARE): the result of parallelSurface() is kept
+//=====================================================================
+bool SDomainsurface::compareSurface(double *serialSeconds, double *parallelSeconds)
+{
+    auto start = std::chrono::steady_clock::now();
+    surface();
+    *serialSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    vector<int> s_conn(conn_list, conn_list + num_conn), s_elem(elem_list, elem_list + num_elem);
+    vector<float> s_x(x_out, x_out + num_vert), s_y(y_out, y_out + num_vert), s_z(z_out, z_out + num_vert);
+    int numData = (DataType == DATA_S || DataType == DATA_V) ? num_vert : (DataType == DATA_S_E || DataType == DATA_V_E) ? num_elem : 0;
+    bool vectorData = (DataType == DATA_V || DataType == DATA_V_E);
+    vector<float> s_u(u_out, u_out + numData);
+    vector<float> s_v(v_out, v_out + (vectorData ? numData : 0)), s_w(w_out, w_out + (vectorData ? numData : 0));
+    vector<int> s_bars(elemMap, elemMap + num_bar);
+    delete[] conn_tag;
+    delete[] conn_list;
+    delete[] elem_list;
+    delete[] x_out;
+    delete[] y_out;
+    delete[] z_out;
+    delete[] u_out;
+    delete[] v_out;
+    delete[] w_out;
+    delete[] elemMap;
+
+    start = std::chrono::steady_clock::now();
+    parallelSurface();
+    *parallelSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    bool identical = s_conn == vector<int>(conn_list, conn_list + num_conn)
+                     && s_elem == vector<int>(elem_list, elem_list + num_elem)
+                     && s_x == vector<float>(x_out, x_out + num_vert)
+                     && s_y == vector<float>(y_out, y_out + num_vert)
+                     && s_z == vector<float>(z_out, z_out + num_vert)
+                     && s_u == vector<float>(u_out, u_out + numData)
+                     && s_v == vector<float>(v_out, v_out + (vectorData ? numData : 0))
+                     && s_w == vector<float>(w_out, w_out + (vectorData ? numData : 0))
+                     && s_bars == vector<int>(elemMap, elemMap + num_bar);
+
+    if (!identical)
+        Covise::sendWarning("parallel surface differs from serial surface: %d/%d polygons, %d/%d vertices",
+                            (int)s_elem.size(), num_elem, (int)s_x.size(), num_vert);
+    return identical;
+}
+
+bool SDomainsurface::compareSurface(int numElem, int numConn, int numCoord,
+                                    int *elem, int *conn, int *types, float *x, float *y, float *z,
+                                    double *serialSeconds, double *parallelSeconds, int *numPolygons)
+{
+    // back-face culling and feature angle like in compute()
+    angle = tresh = param_angle->getValue();
+    scalar = param_scalar->getValue();
+    param_vertex->getValue(n2x, n2y, n2z);
+    doDoubleCheck = param_double->getValue();
+
+    numelem = numelem_o = numElem;
+    numconn = numConn;
+    numcoord = numCoord;
+    el = elem;
+    cl = conn;
+    tl = types;
+    x_in = x;
+    y_in = y;
+    z_in = z;
+    DataType = DATA_NONE;
+    u_in = v_in = w_in = NULL;
+    u_out = v_out = w_out = NULL;
+    int *lnl, *lnli;
+    coUnstructuredNeighbors::computeNeighborList(numelem, numconn, numcoord, el, cl, tl, &lnl, &lnli);
+    neighbors = coUnstructuredNeighbors(numelem, numconn, el, cl, tl, lnl, lnli);
+
+    bool identical = compareSurface(serialSeconds, parallelSeconds);
+    *numPolygons = num_elem;
+
+    neighbors = coUnstructuredNeighbors();
+    delete[] lnl;
+    delete[] lnli;
+    delete[] conn_tag;
+    delete[] conn_list;
+    delete[] elem_list;
+    delete[] x_out;
+    delete[] y_out;
+    delete[] z_out;
+    delete[] elemMap;
+    return identical;
+}
@@ -0,0 +1,124 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+// boundary extraction with surface() compared to parallelSurface() on
+// hexahedral, tetrahedral, polyhedral and mixed grids: n^3 cubes with
+// jittered vertices, where some of the cubes are left out to create inner
+// boundaries. parallelSurface() runs on the global coThreadPool, set
+// COVISE_NUM_THREADS to compare different numbers of threads.
+//
+// usage: domainSurfaceBench [cubes per direction]
+
+#include "DomainSurface.h"
+#include <util/coThreadPool.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+enum CellKind
+{
+    Hexahedra,
+    Tetrahedra,
+    Polyhedra,
+    Mixed
+};
+
+struct Grid
+{
+    std::vector<int> el, cl, tl;
+    std::vector<float> x, y, z;
+};
+
+static void makeGrid(Grid &g, int n, CellKind kind)
+{
+    std::mt19937 rng(4711);
+    std::uniform_real_distribution<float> jitter(-0.2f, 0.2f);
+    std::uniform_int_distribution<int> percent(0, 99);
+    auto id = [n](int i, int j, int k)
+    {
+        return (k * (n + 1) + j) * (n + 1) + i;
+    };
+    for (int k = 0; k <= n; k++)
+        for (int j = 0; j <= n; j++)
+            for (int i = 0; i <= n; i++)
+            {
+                g.x.push_back(i + jitter(rng));
+                g.y.push_back(j + jitter(rng));
+                g.z.push_back(k + jitter(rng));
+            }
+
+    static const int tets[6][4] = { { 0, 1, 2, 6 }, { 0, 2, 3, 6 }, { 0, 3, 7, 6 }, { 0, 7, 4, 6 }, { 0, 4, 5, 6 }, { 0, 5, 1, 6 } };
+    static const int faces[6][4] = { { 0, 3, 2, 1 }, { 4, 5, 6, 7 }, { 0, 1, 5, 4 }, { 1, 2, 6, 5 }, { 2, 3, 7, 6 }, { 3, 0, 4, 7 } };
+    for (int k = 0; k < n; k++)
+        for (int j = 0; j < n; j++)
+            for (int i = 0; i < n; i++)
+            {
+                if (percent(rng) < 3)
+                    continue;
+                int v[8] = { id(i, j, k), id(i + 1, j, k), id(i + 1, j + 1, k), id(i, j + 1, k),
+                             id(i, j, k + 1), id(i + 1, j, k + 1), id(i + 1, j + 1, k + 1), id(i, j + 1, k + 1) };
+                CellKind cell = kind == Mixed ? CellKind(percent(rng) % 3) : kind;
+                if (cell == Hexahedra)
+                {
+                    g.el.push_back((int)g.cl.size());
+                    g.tl.push_back(TYPE_HEXAGON);
+                    g.cl.insert(g.cl.end(), v, v + 8);
+                }
+                else if (cell == Tetrahedra)
+                {
+                    for (int t = 0; t < 6; t++)
+                    {
+                        g.el.push_back((int)g.cl.size());
+                        g.tl.push_back(TYPE_TETRAHEDER);
+                        for (int c = 0; c < 4; c++)
+                            g.cl.push_back(v[tets[t][c]]);
+                    }
+                }
+                else
+                {
+                    // every face is closed by repeating its first vertex
+                    g.el.push_back((int)g.cl.size());
+                    g.tl.push_back(TYPE_POLYHEDRON);
+                    for (int f = 0; f < 6; f++)
+                    {
+                        for (int c = 0; c < 4; c++)
+                            g.cl.push_back(v[faces[f][c]]);
+                        g.cl.push_back(v[faces[f][0]]);
+                    }
+                }
+            }
+}
+
+int main(int argc, char *argv[])
+{
+    int n = argc > 1 ? atoi(argv[1]) : 40;
+    if (n < 1)
+        n = 1;
+
+    SDomainsurface module(argc, argv);
+    printf("%d^3 cubes, %d threads\n", n, coThreadPool::global().numThreads());
+
+    const char *names[] = { "hex", "tet", "poly", "mixed" };
+    bool ok = true;
+    for (int kind = Hexahedra; kind <= Mixed; kind++)
+    {
+        Grid g;
+        makeGrid(g, n, CellKind(kind));
+        double serial = 0., parallel = 0.;
+        int numPolygons = 0;
+        bool identical = module.compareSurface((int)g.el.size(), (int)g.cl.size(), (int)g.x.size(),
+                                               g.el.data(), g.cl.data(), g.tl.data(), g.x.data(), g.y.data(), g.z.data(),
+                                               &serial, &parallel, &numPolygons);
+        printf("%-6s %9d elements %8d polygons   serial %9.1f ms   parallel %9.1f ms (speedup %5.2f)%s\n",
+               names[kind], (int)g.el.size(), numPolygons, serial * 1000., parallel * 1000., serial / parallel,
+               identical ? "" : "   MISMATCH");
+        ok = identical && ok;
+    }
+    return ok ? 0 : 1;
+}
@@ -49,28 +49,33 @@ static inline double sqr(float x)
     return double(x) * double(x);
 }
 
-int numiso, set_num_elem = 0, cur_elem, cur_line_elem;
+int numiso, cur_elem, cur_line_elem;
 /*
 int cuc_count;
 int *cuc = NULL, *cuc_pos = NULL;
 */
 float startpt;
-int num_coord;
 char buf[1000];
-const char *dtype, *gtype;
 const char *GridIn, *DataIn, *IsoDataIn;
 
-//  Shared memory data
-const coDoFloat *s_data_in = NULL;
-const coDoVec3 *v_data_in = NULL;
-const coDoFloat *i_data_in = NULL;
-const coDoUnstructuredGrid *grid_in = NULL;
-const coDoStructuredGrid *sgrid_in = NULL;
-const coDoUniformGrid *ugrid_in = NULL;
-const coDoRectilinearGrid *rgrid_in = NULL;
 coDoSet *polygons_set_out, *normals_set_out,
     *data_set_out;
 
+// the state of compute() is kept per thread,
+// as the elements of a set are computed in parallel
+thread_local int set_num_elem = 0;
+thread_local int num_coord;
+thread_local const char *dtype, *gtype;
+
+//  Shared memory data
+thread_local const coDoFloat *s_data_in = NULL;
+thread_local const coDoVec3 *v_data_in = NULL;
+thread_local const coDoFloat *i_data_in = NULL;
+thread_local const coDoUnstructuredGrid *grid_in = NULL;
+thread_local const coDoStructuredGrid *sgrid_in = NULL;
+thread_local const coDoUniformGrid *ugrid_in = NULL;
+thread_local const coDoRectilinearGrid *rgrid_in = NULL;
+
 //.....................................
 /*
 int *el,*cl,*tl;
@@ -79,11 +84,14 @@ float *y_in;
 float *z_in;
 */
 
-float *s_in;
-float *i_in;
-float *u_in;
-float *v_in;
-float *w_in;
+thread_local float *s_in;
+thread_local float *i_in;
+thread_local float *u_in;
+thread_local float *v_in;
+thread_local float *w_in;
+
+// element of the timestep set, see IsoSurface::setIterator()
+thread_local int lookUp = 0;
 //.....................................
 
 int find_startcell_fast(const float *p,
@@ -141,6 +149,7 @@ IsoSurface::UpdateIsoValue()
 void IsoSurface::preHandleObjects(coInputPort **InPorts)
 {
     ww_.reset();
+    cellSearch.prune();
     // Automatically adapt our Module's title to the species
     if (autoTitle)
     {
@@ -1567,7 +1576,7 @@ int IsoSurface::compute(const char *)
     z_in = NULL;
     char *iblank = NULL;
 
-    isovalue = getValue(lookUp);
+    const float isoValue = getValue(lookUp);
 
     const coDistributedObject *iblank_obj;
     iblank_obj = p_IBlankIn->getCurrentObject();
@@ -1783,7 +1792,7 @@ int IsoSurface::compute(const char *)
             {
                 pplane = new POLYHEDRON_IsoPlane(numelem, numconn, numcoord, DataType, /*vertexRatio,*/
                                                  el, cl, tl,
-                                                 x_in, y_in, z_in, s_in, i_in, u_in, v_in, w_in, isovalue,
+                                                 x_in, y_in, z_in, s_in, i_in, u_in, v_in, w_in, isoValue,
                                                  (p_DataIn->isConnected() != 0), iblank);
                 if (!pplane->createIsoPlane())
                 {
@@ -1796,10 +1805,24 @@ int IsoSurface::compute(const char *)
             }
             else
             {
-                plane = new IsoPlane(numelem, numcoord, DataType, vertexRatio,
+                float ratio;
+                {
+                    std::lock_guard<std::mutex> guard(selfExecMutex);
+                    ratio = vertexRatio;
+                }
+                plane = new IsoPlane(numelem, numcoord, DataType, ratio,
                                      el, cl, tl,
-                                     x_in, y_in, z_in, s_in, i_in, u_in, v_in, w_in, isovalue,
+                                     x_in, y_in, z_in, s_in, i_in, u_in, v_in, w_in, isoValue,
                                      (p_DataIn->isConnected() != 0), iblank);
+                // dragging the isovalue: only look at the cells containing it
+                std::shared_ptr<coCellIntervalTree> search;
+                if (!iblank)
+                {
+                    std::string key = std::string(grid_in->getName()) + "|" + i_data_in->getName();
+                    search = cellSearch.get(key, [&]()
+                                            { return new coCellIntervalTree(numelem, el, cl, tl, i_in); });
+                    plane->useCellSearch(search.get());
+                }
                 if (!plane->createIsoPlane())
                 {
                     delete plane;
@@ -1811,12 +1834,16 @@ int IsoSurface::compute(const char *)
                     }
                     else
                     {
-                        // increase VERTEX_RATIO and start over
-                        vertexRatio += 5.;
-                        sendInfo("Increased VERTEX_RATIO to %.0f%%", vertexRatio);
-                        setExecGracePeriod(0.2f); // wait only 0.2 sec for network latency
-                        inSelfExec = true;
-                        selfExec();
+                        // increase VERTEX_RATIO and start over, only once if several elements fail
+                        std::lock_guard<std::mutex> guard(selfExecMutex);
+                        if (!inSelfExec)
+                        {
+                            vertexRatio += 5.;
+                            sendInfo("Increased VERTEX_RATIO to %.0f%%", vertexRatio);
+                            setExecGracePeriod(0.2f); // wait only 0.2 sec for network latency
+                            inSelfExec = true;
+                            selfExec();
+                        }
                     }
                     return STOP_PIPELINE;
                 }
@@ -1829,7 +1856,7 @@ int IsoSurface::compute(const char *)
             uplane = new UNI_IsoPlane(numelem, numcoord, DataType,
                                       x_min, x_max, y_min, y_max, z_min, z_max,
                                       x_size, y_size, z_size,
-                                      s_in, i_in, u_in, v_in, w_in, isovalue,
+                                      s_in, i_in, u_in, v_in, w_in, isoValue,
                                       (p_DataIn->isConnected() != 0), iblank);
             uplane->createIsoPlane();
             uplane->createcoDistributedObjects(p_GridOut, p_NormalsOut, p_DataOut, gennormals, genstrips, colorn);
@@ -1840,7 +1867,7 @@ int IsoSurface::compute(const char *)
             rplane = new RECT_IsoPlane(numelem, numcoord, DataType,
                                        x_size, y_size, z_size,
                                        x_in, y_in, z_in,
-                                       s_in, i_in, u_in, v_in, w_in, isovalue,
+                                       s_in, i_in, u_in, v_in, w_in, isoValue,
                                        (p_DataIn->isConnected() != 0), iblank);
             rplane->createIsoPlane();
             rplane->createcoDistributedObjects(p_GridOut, p_NormalsOut, p_DataOut, gennormals, genstrips, colorn);
@@ -1850,7 +1877,7 @@ int IsoSurface::compute(const char *)
         {
             splane = new STR_IsoPlane(numelem, numcoord, DataType,
                                       x_size, y_size, z_size,
-                                      x_in, y_in, z_in, s_in, i_in, u_in, v_in, w_in, isovalue,
+                                      x_in, y_in, z_in, s_in, i_in, u_in, v_in, w_in, isoValue,
                                       (p_DataIn->isConnected() != 0), iblank);
             splane->createIsoPlane();
             splane->createcoDistributedObjects(p_GridOut, p_NormalsOut, p_DataOut, gennormals, genstrips, colorn);
@@ -2875,6 +2902,9 @@ IsoSurface::IsoSurface(int argc, char *argv[])
     lookUp = 0;
 
     vertexRatio = coCoviseConfig::getFloat("Module.IsoSurface.VertexRatio", 20.);
+
+    // compute() keeps its state in thread_local variables
+    setComputeReentrant(true);
 #ifdef _COMPLEX_MODULE_
     p_ColorMapIn = addInputPort("ColormapIn0", "ColorMap", "color map to create geometry");
     p_ColorMapIn->setRequired(0);
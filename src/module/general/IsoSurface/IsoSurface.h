@@ -29,12 +29,14 @@
 using namespace covise;
 #include <util/coviseCompat.h>
 #include <float.h>
+#include <mutex>
 
 #include <do/coDoData.h>
 #include <do/coDoRectilinearGrid.h>
 #include <do/coDoStructuredGrid.h>
 #include <do/coDoUniformGrid.h>
 #include <do/coDoUnstructuredGrid.h>
+#include <alg/coCellSearch.h>
 
 #include "IsoPoint.h"
 #ifdef _COMPLEX_MODULE_
@@ -106,6 +108,9 @@ private:
     // Flag set when in selfExec loop to prevent errorMessage
     bool inSelfExec;
 
+    // guards vertexRatio and inSelfExec while compute() runs on several threads
+    std::mutex selfExecMutex;
+
     // automatically create module title? if != NULL, mask for titles
     bool autoTitle;
 
@@ -115,6 +120,9 @@ private:
     // use polyhedra support or not
     bool Polyhedra;
 
+    // cells of unstructured grids that can be cut, per grid and iso data
+    coCellSearchCache<coCellIntervalTree> cellSearch;
+
 protected:
     myPair find_isovalueU(const coDoUniformGrid *, const coDoFloat *);
     myPair find_isovalueR(const coDoRectilinearGrid *, const coDoFloat *);
@@ -135,7 +143,6 @@ protected:
                              const coDistributedObject *idata);
     myList objLabVal;
     void setUpIsoList(coInputPort **inPorts);
-    int lookUp;
     int level;
     float getValue(int lookup)
     {
@@ -143,7 +143,7 @@ DataFileBin::readCells(dimType dim, coDistributedObject **outObjects, const stri
             {
             }
             // quit loop
-            if (feof(in_))
+            if (atEnd())
                 break;
 
             string partStr(str.substr(0, 4));
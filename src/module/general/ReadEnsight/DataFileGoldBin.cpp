@@ -72,7 +72,7 @@ DataFileGoldBin::readCells(dimType dim, coDistributedObject **outObjects, const
         // 1 lines decription - ignore it
         string currentLine(getStr());
 
-        while (!feof(in_)) // read all timesteps
+        while (!atEnd()) // read all timesteps
         {
             size_t tt = currentLine.find("END TIME STEP");
             if (tt != string::npos)
@@ -280,7 +280,7 @@ DataFileGoldBin::readCells(dimType dim, coDistributedObject **outObjects, const
 
                 uint64_t numParts = currPart.getNumEle();
                 // skip data
-                while ((!feof(in_)) && (numParts > 0))
+                while ((!atEnd()) && (numParts > 0))
                 {
                     currentLine = getStr();
                     string elementType(strip(currentLine));
@@ -330,7 +330,7 @@ DataFileGoldBin::read(dimType dim, coDistributedObject **outObjects, const strin
         size_t id(0);
         unsigned int actPartNr;
 
-        while (!feof(in_))
+        while (!atEnd())
         {
             float *arr1 = NULL, *arr2 = NULL, *arr3 = NULL;
             uint64_t numVal;
@@ -33,6 +33,13 @@
 
 #include <util/coviseCompat.h>
 #include <api/coModule.h>
+#include <config/CoviseConfig.h>
+
+#include <algorithm>
+#ifndef WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 using namespace covise;
 InvalidWordException::InvalidWordException(const string &type)
@@ -170,6 +177,7 @@ EnFile::EnFile(ReadEnsight *mod, const BinType &binType)
     : fileMayBeCorrupt_(false)
     , className_(string("EnFile"))
     , isOpen_(false)
+    , in_(NULL)
     , binType_(binType)
     , byteSwap_(false)
     , partList_(NULL)
@@ -177,6 +185,11 @@ EnFile::EnFile(ReadEnsight *mod, const BinType &binType)
     , activeAlloc_(true)
     , dataByteSwap_(false)
     , ens(mod)
+    , mapTried_(false)
+    , map_(NULL)
+    , mapSize_(0)
+    , mapPos_(0)
+    , mapEof_(false)
 {
 }
 
@@ -192,6 +205,11 @@ EnFile::EnFile(ReadEnsight *mod, const string &name, const unsigned int &dim, co
     , dataByteSwap_(false)
     , ens(mod)
     , name_(name)
+    , mapTried_(false)
+    , map_(NULL)
+    , mapSize_(0)
+    , mapPos_(0)
+    , mapEof_(false)
 {
     if (binType != FBIN && binType != CBIN)
     { // reopen as ASCII else leave it in binary mode
@@ -227,6 +245,11 @@ EnFile::EnFile(ReadEnsight *mod, const string &name, const BinType &binType)
     , activeAlloc_(true)
     , ens(mod)
     , name_(name)
+    , mapTried_(false)
+    , map_(NULL)
+    , mapSize_(0)
+    , mapPos_(0)
+    , mapEof_(false)
 {
 
     if (binType != FBIN && binType != CBIN)
@@ -284,8 +307,9 @@ void EnFile::createDataOutObj(dimType dim, coDistributedObject ** outObjects, co
     if (oOut[0] != NULL)
         outObjects[timeStep] = oOut[0];
 
+    // the caller terminates the list: the next slot may already have been
+    // filled by the reader of the next timestep
     ++timeStep;
-    outObjects[timeStep] = NULL;
 }
 void
 EnFile::setActiveAlloc(const bool &b)
@@ -305,6 +329,7 @@ EnFile::binType()
     BinType ret(binType_);
     if (binType_ == EnFile::UNKNOWN)
     {
+        unmapFile();
         if (isOpen_)
         {
             //	    cerr << "EnFile::binType() have to close file first " << endl;
@@ -372,10 +397,135 @@ EnFile::getDataCont() const
 
 EnFile::~EnFile()
 {
+    unmapFile();
     if (isOpen_)
         fclose(in_);
 }
 
+void
+EnFile::mapFile()
+{
+    mapTried_ = true;
+#ifndef WIN32
+    if (in_ == NULL || !coCoviseConfig::isOn("Module.ReadEnsight.MemoryMap", true))
+        return;
+    struct stat st;
+    int fd = fileno(in_);
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+        return;
+    void *m = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (m == MAP_FAILED)
+        return;
+    madvise(m, st.st_size, MADV_SEQUENTIAL);
+    map_ = (const char *)m;
+    mapSize_ = st.st_size;
+    // continue where the stream has got to, e.g. after the file type check
+    off_t pos = ftello(in_);
+    mapPos_ = pos < 0 ? 0 : std::min((uint64_t)pos, mapSize_);
+    mapEof_ = false;
+#endif
+}
+
+void
+EnFile::unmapFile()
+{
+#ifndef WIN32
+    if (map_)
+        munmap((void *)map_, mapSize_);
+#endif
+    map_ = NULL;
+    mapSize_ = mapPos_ = 0;
+    mapEof_ = false;
+    mapTried_ = false;
+}
+
+size_t
+EnFile::readBytes(void *buf, size_t size, size_t n)
+{
+    if (!mapTried_)
+        mapFile();
+    if (!map_)
+        return fread(buf, size, n, in_);
+
+    uint64_t avail = mapSize_ - mapPos_;
+    if (size * n <= avail)
+    {
+        memcpy(buf, map_ + mapPos_, size * n);
+        mapPos_ += size * n;
+        return n;
+    }
+    // short read: copy what is left like fread and flag the end of file
+    memcpy(buf, map_ + mapPos_, avail);
+    mapPos_ = mapSize_;
+    mapEof_ = true;
+    return size ? avail / size : 0;
+}
+
+int
+EnFile::readChar()
+{
+    if (!mapTried_)
+        mapFile();
+    if (!map_)
+        return fgetc(in_);
+
+    if (mapPos_ >= mapSize_)
+    {
+        mapEof_ = true;
+        return EOF;
+    }
+    return (unsigned char)map_[mapPos_++];
+}
+
+void
+EnFile::seekCur(int64_t offset)
+{
+    if (!mapTried_)
+        mapFile();
+    if (!map_)
+    {
+#ifdef WIN32
+        _fseeki64(in_, offset, SEEK_CUR);
+#else
+        fseeko(in_, offset, SEEK_CUR);
+#endif
+        return;
+    }
+
+    if (offset < 0 && (uint64_t)-offset > mapPos_)
+        mapPos_ = 0;
+    else
+        mapPos_ = std::min(mapPos_ + offset, mapSize_);
+    mapEof_ = false;
+}
+
+void
+EnFile::seekSet(uint64_t pos)
+{
+    if (!mapTried_)
+        mapFile();
+    if (!map_)
+    {
+#ifdef WIN32
+        _fseeki64(in_, pos, SEEK_SET);
+#else
+        fseeko(in_, pos, SEEK_SET);
+#endif
+        return;
+    }
+
+    mapPos_ = std::min(pos, mapSize_);
+    mapEof_ = false;
+}
+
+bool
+EnFile::atEnd()
+{
+    if (!map_)
+        return feof(in_) != 0;
+    return mapEof_;
+}
+
 // helper skip n floats or doubles
 void
 EnFile::skipFloat(const uint64_t &n)
@@ -384,11 +534,7 @@ EnFile::skipFloat(const uint64_t &n)
     { // check for block markers
         unsigned int ilen(getuIntRaw());
 
-#ifdef WIN32
-        _fseeki64(in_, ilen, SEEK_CUR);
-#else
-        fseek(in_, ilen, SEEK_CUR);
-#endif
+        seekCur(ilen);
 
         unsigned int olen(getuIntRaw());
         if ((ilen != olen))
@@ -403,11 +549,7 @@ EnFile::skipFloat(const uint64_t &n)
     // Read floats up to 4GB
     else
     {
-#ifdef WIN32
-        _fseeki64(in_, n * sizeof(float), SEEK_CUR);
-#else
-        fseek(in_, n * sizeof(float), SEEK_CUR);
-#endif
+        seekCur(n * sizeof(float));
     }
 }
 
@@ -418,11 +560,7 @@ EnFile::skipInt(const uint64_t&n)
     if (binType_ == EnFile::FBIN)
     { // check for block markers
         unsigned int ilen(getuIntRaw());
-#ifdef WIN32
-        _fseeki64(in_, n * 4, SEEK_CUR);
-#else
-        fseek(in_, n * 4, SEEK_CUR);
-#endif
+        seekCur(n * 4);
 
         unsigned int olen(getuIntRaw());
         if ((ilen != olen) || (ilen != n * 4))
@@ -435,11 +573,7 @@ EnFile::skipInt(const uint64_t&n)
     }
     else
     {
-#ifdef WIN32
-        _fseeki64(in_, n * sizeof(int), SEEK_CUR);
-#else
-        fseek(in_, n * sizeof(int), SEEK_CUR);
-#endif
+        seekCur(n * sizeof(int));
     }
 }
 
@@ -456,7 +590,7 @@ EnFile::getStr()
     if (binType_ == EnFile::FBIN)
     {
         unsigned int ilen(getuIntRaw());
-        if (feof(in_))
+        if (atEnd())
         {
             //end of file reached
             return ret;
@@ -488,8 +622,8 @@ EnFile::getStr()
             cerr << "ERROR: EnFile::getStr(): not a fortran string of length 80" << endl;
             return ret;
         }
-        fread(buf, strLen, 1, in_);
-        if (feof(in_))
+        readBytes(buf, strLen, 1);
+        if (atEnd())
         {
 #ifdef WIN32
             DebugBreak();
@@ -511,7 +645,7 @@ EnFile::getStr()
     {
         for (unsigned int i = 0; i < strLen; ++i)
         {
-            buf[i] = fgetc(in_);
+            buf[i] = readChar();
         }
     }
 
@@ -557,7 +691,7 @@ unsigned int
 EnFile::getuIntRaw()
 {
     unsigned int ret = 0;
-    fread(&ret, 4, 1, in_); // read a 4 byte integer
+    readBytes(&ret, 4, 1); // read a 4 byte integer
     if (byteSwap_)
     {
         byteSwap(ret);
@@ -569,7 +703,7 @@ int
 EnFile::getIntRaw()
 {
     int ret = 0;
-    fread(&ret, 4, 1, in_); // read a 4 byte integer
+    readBytes(&ret, 4, 1); // read a 4 byte integer
     if (byteSwap_)
     {
         byteSwap(ret);
@@ -589,7 +723,7 @@ void EnFile::getuIntArr(const uint64_t &n, unsigned int *iarr)
             unsigned int ilen(getuIntRaw());
             getIntArrHelper(n, iarr);
             unsigned int olen(getuIntRaw());
-            if ((ilen != olen) && (!feof(in_)))
+            if ((ilen != olen) && (!atEnd()))
             {
 #ifdef WIN32
                 DebugBreak();
@@ -623,7 +757,7 @@ EnFile::getIntArr(const uint64_t &n, int *iarr)
             int ilen(getIntRaw());
             getIntArrHelper(n, (unsigned int *)iarr);
             int olen(getIntRaw());
-            if ((ilen != olen) && (!feof(in_)))
+            if ((ilen != olen) && (!atEnd()))
             {
 #ifdef WIN32
                 DebugBreak();
@@ -664,18 +798,17 @@ EnFile::getIntArrHelper(const uint64_t &n, unsigned int *iarr)
     }
     ////////////////////////////
 
-    const unsigned int len(sizeof(int));
-    char *buf = new char[n * len];
+    if (iarr == NULL)
+    {
+        seekCur(n * sizeof(int));
+        return;
+    }
 
-    fread(buf, len, n, in_);
+    // straight into the target, there is no need for an intermediate buffer
+    readBytes(iarr, sizeof(int), n);
 
     if (byteSwap_)
-        byteSwap((uint32_t *)buf, n);
-
-    if (iarr != NULL)
-        memcpy(iarr, buf, n * len);
-
-    delete[] buf;
+        byteSwap((uint32_t *)iarr, n);
     return;
 }
 
@@ -692,7 +825,6 @@ EnFile::getFloatArr(const uint64_t &n, float *farr)
         return NULL;
 
     const unsigned int len(sizeof(float));
-    char *buf = new char[n * len];
     bool eightBytePerFloat = false;
 
     if (binType_ == EnFile::FBIN)
@@ -708,13 +840,10 @@ EnFile::getFloatArr(const uint64_t &n, float *farr)
         {
             eightBytePerFloat = true;
             double *dummyArr = new double[n];
-            delete[] buf;
-            buf = new char[ilen];
-            fread(buf, 8, n, in_);
+            readBytes(dummyArr, 8, n);
             olen = getuIntRaw();
             if (byteSwap_)
-                byteSwap((uint64_t *)buf, n);
-            memcpy(dummyArr, buf, ilen);
+                byteSwap((uint64_t *)dummyArr, n);
             cerr << "got 64-bit floats" << endl;
             unsigned int i;
             if (farr != NULL)
@@ -724,10 +853,10 @@ EnFile::getFloatArr(const uint64_t &n, float *farr)
         }
         else
         {
-            fread(buf, len, n, in_);
+            readBytes(farr, len, n);
             olen = getuIntRaw();
         }
-        if ((ilen != olen) && (!feof(in_)))
+        if ((ilen != olen) && (!atEnd()))
         {
 #ifdef WIN32
             DebugBreak();
@@ -737,17 +866,11 @@ EnFile::getFloatArr(const uint64_t &n, float *farr)
     }
     else
     {
-        fread(buf, len, n, in_);
+        readBytes(farr, len, n);
     }
 
-    if (!eightBytePerFloat)
-    {
-        if (byteSwap_)
-            byteSwap((uint32_t *)buf, n);
-        if (farr != NULL)
-            memcpy(farr, buf, n * len);
-    }
-    delete[] buf;
+    if (!eightBytePerFloat && byteSwap_)
+        byteSwap((uint32_t *)farr, n);
     return NULL;
 }
 
@@ -219,6 +219,15 @@ protected:
     // send a list of all parts to covise info
     void sendPartsToInfo();
 
+    // binary input goes through these: they work on a memory mapping of the
+    // file if it could be mapped and on in_ otherwise, with the semantics of
+    // fread, fgetc, fseek and feof
+    size_t readBytes(void *buf, size_t size, size_t n);
+    int readChar();
+    void seekCur(int64_t offset);
+    void seekSet(uint64_t pos);
+    bool atEnd();
+
     string className_;
 
     bool isOpen_;
@@ -251,5 +260,15 @@ private:
     string name_;
 
     void getIntArrHelper(const uint64_t &n, unsigned int *iarr = NULL);
+
+    // map in_ at its current position on first binary access
+    void mapFile();
+    void unmapFile();
+
+    bool mapTried_;
+    const char *map_;
+    uint64_t mapSize_;
+    uint64_t mapPos_;
+    bool mapEof_;
 };
 #endif
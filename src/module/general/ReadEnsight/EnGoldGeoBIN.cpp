@@ -159,19 +159,11 @@ EnGoldGeoBIN::readBB()
         {
             if (binType_ == EnFile::FBIN)
             {
-#ifdef WIN32
-                _fseeki64(in_, -88, SEEK_CUR); // 4 + 80 + 4
-#else
-                fseek(in_, -88, SEEK_CUR); // 4 + 80 + 4
-#endif
+                seekCur(-88); // 4 + 80 + 4
             }
             else
             {
-#ifdef WIN32
-                _fseeki64(in_, -80, SEEK_CUR);
-#else
-                fseek(in_, -80, SEEK_CUR);
-#endif
+                seekCur(-80);
             }
         }
     }
@@ -397,7 +389,7 @@ EnGoldGeoBIN::readPartConn(EnPart &actPart)
     // we don't know a priori how many Ensight elements we can expect here therefore we have to read
     // until we find a new 'part'
     lastNc_ = 0;
-    while ((!feof(in_)) && (!partFound))
+    while ((!atEnd()) && (!partFound))
     {
         string tmp(getStr());
         if (tmp.find("part") != string::npos)
@@ -690,7 +682,7 @@ EnGoldGeoBIN::parseForParts()
 	}
     unsigned int cnt = 0;
     bool validElementFound = false;
-    while (!feof(in_))
+    while (!atEnd())
     {
         string tmp(getStr());
         unsigned int actPartNr;
@@ -950,7 +942,7 @@ EnGoldGeoBIN::skipPart()
     }
     // scan for element type
 
-    while (!feof(in_))
+    while (!atEnd())
     {
         string tmp(getStr());
 
@@ -964,19 +956,11 @@ EnGoldGeoBIN::skipPart()
                 partList_->push_back(actPart);
             if (binType_ == EnFile::FBIN)
             {
-#ifdef WIN32
-                _fseeki64(in_, -88L, SEEK_CUR);
-#else
-                fseek(in_, -88L, SEEK_CUR);
-#endif
+                seekCur(-88L);
             }
             else
             {
-#ifdef WIN32
-                _fseeki64(in_, -80L, SEEK_CUR);
-#else
-                fseek(in_, -80L, SEEK_CUR);
-#endif
+                seekCur(-80L);
             }
             partFound = false; // read part string again next time;
             return 0;
@@ -588,3 +588,47 @@ EnPart::clearFields()
         delete[] indexMap3d_;
     indexMap3d_ = NULL;
 }
+
+void
+EnPart::clearDataFields()
+{
+    if (arr1_ != NULL)
+        delete[] arr1_;
+    arr1_ = NULL;
+    if (arr2_ != NULL)
+        delete[] arr2_;
+    arr2_ = NULL;
+    if (arr3_ != NULL)
+        delete[] arr3_;
+    arr3_ = NULL;
+    if (d2dx_ != NULL)
+        delete[] d2dx_;
+    d2dx_ = NULL;
+    if (d2dy_ != NULL)
+        delete[] d2dy_;
+    d2dy_ = NULL;
+    if (d2dz_ != NULL)
+        delete[] d2dz_;
+    d2dz_ = NULL;
+    if (d3dx_ != NULL)
+        delete[] d3dx_;
+    d3dx_ = NULL;
+    if (d3dy_ != NULL)
+        delete[] d3dy_;
+    d3dy_ = NULL;
+    if (d3dz_ != NULL)
+        delete[] d3dz_;
+    d3dz_ = NULL;
+    if (indexMap2d_ != NULL)
+        delete[] indexMap2d_;
+    indexMap2d_ = NULL;
+    if (indexMap3d_ != NULL)
+        delete[] indexMap3d_;
+    indexMap3d_ = NULL;
+    distGeo2d_ = NULL;
+    distGeo3d_ = NULL;
+    subParts_numElem.clear();
+    subParts_numConn.clear();
+    subParts_numCoord.clear();
+    subParts_IndexList.clear();
+}
@@ -113,6 +113,10 @@ public:
     // delete all fields (see below) and reset pointers to NULL
     void clearFields();
 
+    // delete the data fields and index maps but keep coordinates and
+    // connectivity, so that the part can be reused for the next execution
+    void clearDataFields();
+
     // these pointers have to be used with care
     float *arr1_, *arr2_, *arr3_;
     float *d2dx_, *d2dy_, *d2dz_;
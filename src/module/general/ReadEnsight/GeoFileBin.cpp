@@ -116,7 +116,7 @@ En6GeoBIN::parseForParts()
     int i, j, k;
     int d = 0;
     bool validElementFound = false;
-    while (!feof(in_))
+    while (!atEnd())
     {
         string tmp;
         try
@@ -226,12 +226,8 @@ En6GeoBIN::parseForParts()
         }
     }
 
-// rewind
-#ifdef WIN32
-    _fseeki64(in_, 0L, SEEK_SET);
-#else
-    fseek(in_, 0L, SEEK_SET);
-#endif
+    // rewind
+    seekSet(0);
 
     // add last part to the list of parts
     if (partList_ != NULL)
@@ -545,7 +541,7 @@ En6GeoBIN::readConn()
 
     vector<unsigned int> eleLst2d, eleLst3d, cornLst2d, cornLst3d, typeLst2d, typeLst3d;
 
-    while (!feof(in_))
+    while (!atEnd())
     {
         string tmp;
         try
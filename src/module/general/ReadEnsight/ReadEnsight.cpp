@@ -28,6 +28,11 @@
 #include <util/covise_regexp.h>
 #include <alg/coCellToVert.h>
 #include <reader/ReaderControl.h>
+#include <util/coThreadPool.h>
+#include <config/CoviseConfig.h>
+
+#include <sstream>
+#include <sys/stat.h>
 
 #include "ReadEnsight.h"
 #include "CaseParser.hpp"
@@ -80,6 +85,8 @@ ReadEnsight::ReadEnsight(int argc, char *argv[])
     , binType_(EnFile::NOBIN)
     , dataByteSwap_(true)
     , geoObj_(NULL)
+    , geoCacheBinType_(EnFile::NOBIN)
+    , numGeoSteps_(0)
 {
     geoObjs_[0] = NULL;
     geoObjs_[1] = NULL;
@@ -132,6 +139,7 @@ ReadEnsight::ReadEnsight(int argc, char *argv[])
 //
 ReadEnsight::~ReadEnsight()
 {
+    releaseGeoCache();
 }
 
 void
@@ -364,6 +372,48 @@ ReadEnsight::createMasterPL()
     delete enf;
 }
 
+string
+ReadEnsight::geoStamp(const vector<string> &geoFiles)
+{
+    if (!coCoviseConfig::isOn("Module.ReadEnsight.CacheGeometry", true))
+        return string();
+
+    // only single geometry files of Ensight 6 and Ensight Gold are cached:
+    // their readers leave all parts in globalParts_ and create the output
+    // with createGeoOutObj() like a cache hit does, the master part files
+    // (.mgeo, .mpg) are read differently
+    for (size_t i = 0; i < geoFiles.size(); ++i)
+    {
+        const char *ending = strrchr(geoFiles[i].c_str(), '.');
+        if (ending && (strcasecmp(ending, ".mgeo") == 0 || strncasecmp(ending, ".mpg", 4) == 0))
+            return string();
+    }
+
+    std::stringstream stamp;
+    stamp << partStringParam_->getValue() << ";" << dataByteSwapParam_->getValue() << ";"
+          << includePolyederParam_->getValue() << ";";
+    for (size_t i = 0; i < geoFiles.size(); ++i)
+    {
+        struct stat st;
+        if (stat(geoFiles[i].c_str(), &st) != 0)
+            return string();
+        stamp << geoFiles[i] << ":" << st.st_mtime << ":" << st.st_size << ";";
+    }
+    return stamp.str();
+}
+
+void
+ReadEnsight::releaseGeoCache()
+{
+    for (size_t i = 0; i < geoCache_.size(); ++i)
+    {
+        for (size_t j = 0; j < geoCache_[i].size(); ++j)
+            geoCache_[i][j].clearFields();
+    }
+    geoCache_.clear();
+    geoCacheStamp_.clear();
+}
+
 // read geometry file or geometry files
 // to a given port with ReaderControl token portTok
 int
@@ -395,6 +445,14 @@ ReadEnsight::readGeometry(const int &portTok2d, const int &portTok3d)
     if (numTs == 0)
         allGeoFiles.push_back(case_.getGeoFileNm());
 
+    // the parts of the last execution are still valid
+    // if neither the geometry files nor the part selection have changed
+    string stamp(geoStamp(allGeoFiles));
+    bool useCache = !stamp.empty() && stamp == geoCacheStamp_ && geoCache_.size() == allGeoFiles.size();
+    if (!useCache)
+        releaseGeoCache();
+    geoCacheStamp_ = stamp;
+
     // read all files
     int cnt(0);
     for (ii = allGeoFiles.begin(); ii != allGeoFiles.end(); ii++)
@@ -409,6 +467,25 @@ ReadEnsight::readGeometry(const int &portTok2d, const int &portTok3d)
             actObjNm2d = objNameBase2d + "_" + num;
             actObjNm3d = objNameBase3d + "_" + num;
         }
+
+        if (useCache)
+        {
+            binType_ = geoCacheBinType_;
+            globalParts_.push_back(geoCache_[cnt]);
+            coDistributedObject **oOut = createGeoOutObj(actObjNm2d, actObjNm3d, cnt);
+            objects2d[cnt] = NULL;
+            objects3d[cnt] = NULL;
+            if (oOut)
+            {
+                objects3d[cnt] = oOut[0];
+                objects2d[cnt] = oOut[1];
+                delete[] oOut;
+            }
+            ++cnt;
+            objects2d[cnt] = NULL;
+            objects3d[cnt] = NULL;
+            continue;
+        }
         // create representation of geometry file..
         EnFile *enf = EnFile::createGeometryFile(this, case_, *ii);
         if (enf == NULL)
@@ -442,6 +519,10 @@ ReadEnsight::readGeometry(const int &portTok2d, const int &portTok3d)
         delete enf;
 
     }
+    numGeoSteps_ = cnt;
+    geoCacheBinType_ = binType_;
+    if (useCache)
+        coModule::sendInfo(" geometry unchanged since the last execution - using the parts read then");
 
     // we have no timesteps - feed objectsXY[0] to outports
     if (realNumTs <= 1)
@@ -1430,13 +1511,31 @@ ReadEnsight::compute(const char *)
     }
 
     // clean up part list
+    // coordinates and connectivity of the geometry are kept if they may be cached
+    bool keepGeo = !geoCacheStamp_.empty() && numGeoSteps_ > 0 && numGeoSteps_ <= (int)globalParts_.size();
     unsigned int i, j;
     // check if we have static geo with transient data
     size_t indexSteps = (geoTimesetIdx_ == -1) ? 1 : globalParts_.size();
+    if (keepGeo)
+    {
+        for (i = 0; i < (unsigned int)numGeoSteps_; ++i)
+        {
+            for (j = 0; j < globalParts_[i].size(); ++j)
+                globalParts_[i][j].clearDataFields();
+        }
+        geoCache_.assign(globalParts_.begin(), globalParts_.begin() + numGeoSteps_);
+    }
+    else
+    {
+        geoCache_.clear();
+        geoCacheStamp_.clear();
+    }
     for (i = 0; i < indexSteps; ++i)
     {
         for (j = 0; j < globalParts_[i].size(); ++j)
         {
+            if (keepGeo && i < (unsigned int)numGeoSteps_)
+                continue;
             globalParts_[i][j].clearFields();
             // 	      if (globalParts_[i][j].indexMap2d_!=NULL) {
             // 	          delete [] globalParts_[i][j].indexMap2d_;
@@ -1654,6 +1753,14 @@ ReadEnsight::createGeoOutObj(const string &baseName2d,
                 dc.el = it->el3d_;
                 dc.cl = it->cl3d_;
                 dc.tl = it->tl3d_;
+                // the reducer renumbers the corner list in place:
+                // a cached part has to keep the original one
+                vector<unsigned int> cachedCl;
+                if (!geoCacheStamp_.empty() && it->numConnRead3d() > 0)
+                {
+                    cachedCl.assign(it->cl3d_, it->cl3d_ + it->numConnRead3d());
+                    dc.cl = &cachedCl[0];
+                }
 
                 float *xn = NULL, *yn = NULL, *zn = NULL;
                 Reducer r(dc);
@@ -1914,6 +2021,14 @@ ReadEnsight::createGeoOutObj(const string &baseName2d,
             dc.el = it->el2d_;
             dc.cl = it->cl2d_;
             dc.tl = it->tl2d_;
+            // the reducer renumbers the corner list in place:
+            // a cached part has to keep the original one
+            vector<unsigned int> cachedCl;
+            if (!geoCacheStamp_.empty() && it->numConnRead2d() > 0)
+            {
+                cachedCl.assign(it->cl2d_, it->cl2d_ + it->numConnRead2d());
+                dc.cl = &cachedCl[0];
+            }
 
             float *xn = NULL, *yn = NULL, *zn = NULL;
 
@@ -2525,61 +2640,9 @@ ReadEnsight::readData2d(const int &portTok2d,
     string objNameBase2d = READER_CONTROL->getAssocObjName(portTok2d);
     coDistributedObject **objects2d = new coDistributedObject *[rNumTs + 2];
 
-    vector<string>::iterator ii;
-
-    int cnt(0);
-    for (ii = allFiles.begin(); ii != allFiles.end(); ii++)
-    {
-        char ch[64];
-        sprintf(ch, "%d", cnt);
-        string num(ch);
-        string actObjNm2d(objNameBase2d);
-        if (rNumTs > 1)
-            actObjNm2d = objNameBase2d + "_" + num;
-
-        char buf[256];
-        switch (dim)
-        {
-        case 1:
-            sprintf(buf, "ReadEnsight start reading scalar data out of file %s", (*ii).c_str());
-            break;
-        case 3:
-            sprintf(buf, "ReadEnsight start reading vector data out of file %s", (*ii).c_str());
-            break;
-        }
-        coModule::sendInfo("%s", buf);
-
-        // really read the data
-        DataCont ddc;
-        EnFile *dFile(NULL);
-        if (pV) // per vertex
-        {
-            dFile = createDataFilePtr(*ii, dim, numCoords_[cnt]);
-            if (!dFile->isOpen())
-            {
-                sendError(" could not open file %s", (*ii).c_str());
-                return 0;
-            }
-            dFile->setPartList(&globalParts_[cnt]);
-            dFile->read(EnFile::EnFile::DIM2D, objects2d, actObjNm2d, cnt, rNumTs);
-            ddc = dFile->getDataCont();
-            delete dFile;
-        }
-        else // per cell
-        {
-            // memory is allocated now in build parts due to the information collected
-            // in the part list
-            dFile = createDataFilePtr(*ii, dim, 0);
-            //	    dFile = createDataFilePtr( *ii, fileNameBase, dim, 0 );
-            if (!dFile->isOpen())
-            {
-                sendError(" could not open file %s", fileNameBase.c_str());
-                return 0;
-            }
-            dFile->setPartList(&globalParts_[cnt]);
-            dFile->readCells(EnFile::EnFile::DIM2D, objects2d, actObjNm2d, cnt, rNumTs);
-        }
-    }
+    int cnt = readDataSteps(EnFile::DIM2D, allFiles, objNameBase2d, objects2d, rNumTs, pV, dim);
+    if (cnt < 0)
+        return 0;
 
     // we have no timesteps - feed objectsXY[0] to outports
     if (rNumTs <= 1)
@@ -2664,61 +2727,9 @@ ReadEnsight::readData3d(const int &portTok3d,
     string objNameBase3d = READER_CONTROL->getAssocObjName(portTok3d);
     coDistributedObject **objects3d = new coDistributedObject *[rNumTs + 2];
 
-    vector<string>::iterator ii;
-
-    int cnt(0);
-    for (ii = allFiles.begin(); ii != allFiles.end(); ii++)
-    {
-        char ch[64];
-        sprintf(ch, "%d", cnt);
-        string num(ch);
-        string actObjNm3d(objNameBase3d);
-        if (rNumTs > 1)
-            actObjNm3d = objNameBase3d + "_" + num;
-
-        char buf[256];
-        switch (dim)
-        {
-        case 1:
-            sprintf(buf, "ReadEnsight start reading scalar data out of file %s", (*ii).c_str());
-            break;
-        case 3:
-            sprintf(buf, "ReadEnsight start reading vector data out of file %s", (*ii).c_str());
-            break;
-        }
-        coModule::sendInfo("%s", buf);
-
-        // really read the data
-        DataCont ddc;
-        EnFile *dFile(NULL);
-        if (pV) // per vertex
-        {
-            dFile = createDataFilePtr(*ii, dim, numCoords_[cnt]);
-            if (!dFile->isOpen())
-            {
-                sendError(" could not open file %s", (*ii).c_str());
-                return 0;
-            }
-            dFile->setPartList(&globalParts_[cnt]);
-            dFile->read(EnFile::EnFile::DIM3D, objects3d, actObjNm3d, cnt, rNumTs);
-            ddc = dFile->getDataCont();
-            delete dFile;
-        }
-        else // per cell
-        {
-            // memory is allocated now in build parts due to the information collected
-            // in the part list
-            dFile = createDataFilePtr(*ii, dim, 0);
-            //	    dFile = createDataFilePtr( *ii, fileNameBase, dim, 0 );
-            if (!dFile->isOpen())
-            {
-                sendError(" could not open file %s", fileNameBase.c_str());
-                return 0;
-            }
-            dFile->setPartList(&globalParts_[cnt]);
-            dFile->readCells(EnFile::EnFile::DIM3D, objects3d, actObjNm3d, cnt, rNumTs);
-        }
-    }
+    int cnt = readDataSteps(EnFile::DIM3D, allFiles, objNameBase3d, objects3d, rNumTs, pV, dim);
+    if (cnt < 0)
+        return 0;
 
     // we have no timesteps - feed objectsXY[0] to outports
     if (rNumTs <= 1)
@@ -2781,6 +2792,80 @@ ReadEnsight::readData3d(const int &portTok3d,
     return Success;
 }
 
+int
+ReadEnsight::readDataSteps(EnFile::dimType dimFlag, const vector<string> &allFiles,
+                           const string &objNameBase, coDistributedObject **objects,
+                           const int &rNumTs, const bool &pV, const int &dim)
+{
+    // read the file of one timestep, step is advanced by the number of
+    // timesteps found in the file
+    auto readFile = [&](const string &fileName, int &step) -> bool
+    {
+        string actObjNm(objNameBase);
+        if (rNumTs > 1)
+            actObjNm = objNameBase + "_" + std::to_string(step);
+
+        char buf[256];
+        switch (dim)
+        {
+        case 1:
+            sprintf(buf, "ReadEnsight start reading scalar data out of file %s", fileName.c_str());
+            break;
+        case 3:
+            sprintf(buf, "ReadEnsight start reading vector data out of file %s", fileName.c_str());
+            break;
+        }
+        coModule::sendInfo("%s", buf);
+
+        // memory for cell based data is allocated in build parts due to the
+        // information collected in the part list
+        EnFile *dFile = createDataFilePtr(fileName, dim, pV ? numCoords_[step] : 0);
+        if (!dFile->isOpen())
+        {
+            sendError(" could not open file %s", fileName.c_str());
+            delete dFile;
+            return false;
+        }
+        dFile->setPartList(&globalParts_[step]);
+        if (pV) // per vertex
+            dFile->read(dimFlag, objects, actObjNm, step, rNumTs);
+        else // per cell
+            dFile->readCells(dimFlag, objects, actObjNm, step, rNumTs);
+        delete dFile;
+        return true;
+    };
+
+    // with one file per timestep the timesteps are independent of each other:
+    // they have their own part lists and output objects
+    size_t numFiles = allFiles.size();
+    bool parallel = numFiles > 1 && (int)numFiles == rNumTs
+                    && globalParts_.size() >= numFiles && (!pV || numCoords_.size() >= numFiles)
+                    && coThreadPool::global().numThreads() > 1;
+    if (!parallel)
+    {
+        int cnt(0);
+        for (size_t i = 0; i < numFiles; ++i)
+        {
+            if (!readFile(allFiles[i], cnt))
+                return -1;
+        }
+        return cnt;
+    }
+
+    std::vector<char> ok(numFiles, 0);
+    coThreadPool::global().run(numFiles, [&](size_t i, int)
+                               {
+                                   int step = (int)i;
+                                   ok[i] = readFile(allFiles[i], step);
+                               });
+    for (size_t i = 0; i < numFiles; ++i)
+    {
+        if (!ok[i])
+            return -1;
+    }
+    return (int)numFiles;
+}
+
 const coDistributedObject *
 ReadEnsight::getGeoObject(const int &step, const int &iPart, const int &dimFlag)
 {
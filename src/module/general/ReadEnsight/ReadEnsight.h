@@ -76,6 +76,14 @@ private:
     // read geometry
     int readGeometry(const int &portTok2d, const int &portTok3d3d);
 
+    // key of the geometry cache: names, modification times and sizes of the
+    // geometry files and the parameters influencing how they are read,
+    // empty if the geometry must not be cached
+    string geoStamp(const vector<string> &geoFiles);
+
+    // free the geometry kept from the last execution
+    void releaseGeoCache();
+
     // read Measured geometry
     int readMGeometry(const int &portTok1d);
 
@@ -96,6 +104,12 @@ private:
                    const string &fileNameBase,
                    const bool &pV, const int &dim = 1, const string &desc = "");
 
+    // read the data files of all timesteps of a variable into objects,
+    // returns the number of timesteps read or -1 if a file could not be opened
+    int readDataSteps(EnFile::dimType dimFlag, const vector<string> &allFiles,
+                      const string &objNameBase, coDistributedObject **objects,
+                      const int &rNumTs, const bool &pV, const int &dim);
+
     EnFile *createDataFilePtr(const string &filename, const uint64_t &d, const uint64_t&numCoord);
 
     // helper for static geometry / transinet data
@@ -143,5 +157,13 @@ private:
 
     coDistributedObject *geoObj_;
     coDistributedObject *geoObjs_[3];
+
+    // coordinates and connectivity of the parts of all geometry timesteps
+    // kept from the last execution, so that changing only the variable
+    // does not read the geometry again
+    string geoCacheStamp_;
+    vector<PartList> geoCache_;
+    EnFile::BinType geoCacheBinType_;
+    int numGeoSteps_;
 };
 #endif
@@ -25,6 +25,8 @@
 #include <do/coDoSet.h>
 #include <util/coFileUtil.h>
 #include <util/coRestraint.h>
+#include <util/coThreadPool.h>
+#include <config/CoviseConfig.h>
 
 #include <sstream>
 #include <fstream>
@@ -33,6 +35,7 @@
 #include <string>
 #include <set>
 #include <cctype>
+#include <algorithm>
 #include <limits>
 
 #include <ctime>
@@ -44,6 +47,19 @@
 #include <fcntl.h>
 
 
+// objects read for one processor in one timestep
+struct BlockObjects
+{
+    BlockObjects(int numPorts, int numBoundaryPorts)
+        : port(numPorts)
+        , boundPort(numBoundaryPorts)
+        , particlesPort(numPorts)
+    {
+    }
+    std::vector<coDistributedObject *> mesh, boundary, particles;
+    std::vector<std::vector<coDistributedObject *> > port, boundPort, particlesPort;
+};
+
 ReadFOAM::ReadFOAM(int argc, char *argv[]) //Constructor
     : coModule(argc, argv, "Read OpenFOAM Data") // description in the module setup window
 {
@@ -417,269 +433,354 @@ void ReadFOAM::param(const char *paramName, bool inMapLoading)
     }
 }
 
-coDoUnstructuredGrid *ReadFOAM::loadMesh(const std::string &meshdir,
-                                         const std::string &pointsdir,
-                                         const std::string &meshObjName,
-                                         const index_t Processor)
+// modification time and size of a file in the case, empty if it is not a plain file
+std::string ReadFOAM::fileStamp(const std::string &dir, const std::string &file)
 {
-    coDoUnstructuredGrid *meshObj;
-    index_t *el, *cl, *tl; // element list, connectivity list, type list
-    float *x_coord, *y_coord, *z_coord; // coordinate lists
+    if (m_case.archived)
+        return std::string();
+    const char *extensions[] = { "", ".gz" };
+    for (size_t i = 0; i < sizeof(extensions) / sizeof(extensions[0]); ++i)
+    {
+        std::string path = m_case.casedir + "/" + dir + "/" + file + extensions[i];
+        struct stat st;
+        if (stat(path.c_str(), &st) == 0)
+        {
+            std::stringstream stamp;
+            stamp << file << extensions[i] << ":" << st.st_mtime << ":" << st.st_size << ";";
+            return stamp.str();
+        }
+    }
+    return std::string();
+}
 
-    if (Processor == -1)
+// size of a file in the case, gzipped files counted with a typical
+// compression ratio, 0 if it is not a plain file
+size_t ReadFOAM::fileSize(const std::string &dir, const std::string &file)
+{
+    if (m_case.archived)
+        return 0;
+    std::string path = m_case.casedir + "/" + dir + "/" + file;
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0)
+        return st.st_size;
+    if (stat((path + ".gz").c_str(), &st) == 0)
+        return 4 * st.st_size;
+    return 0;
+}
+
+// element, connectivity and type list of the polyMesh in meshdir, from the
+// cache if its faces, owner and neighbour files have not changed since
+std::shared_ptr<const ReadFOAM::MeshTopology> ReadFOAM::loadTopology(const std::string &meshdir)
+{
+    const std::string key = m_case.casedir + "/" + meshdir;
+    std::string stamp;
+    const char *files[] = { "faces", "owner", "neighbour" };
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); ++i)
     {
-        std::shared_ptr<std::istream> pointsIn = m_case.getStreamForFile(pointsdir, "points");
-        if (!pointsIn)
-            return NULL;
-        HeaderInfo pointsH = readFoamHeader(*pointsIn);
-        std::cerr << std::time(0) << " Reading mesh from:                 " << meshdir.c_str() << std::endl;
+        std::string s = fileStamp(meshdir, files[i]);
+        if (s.empty())
         {
-            int num_points = pointsH.lines;
-            //std::cerr << std::time(0) << " reading Faces" << std::endl;
-            std::shared_ptr<std::istream> facesIn = m_case.getStreamForFile(meshdir, "faces");
-            if (!facesIn)
-                return NULL;
-            HeaderInfo facesH = readFoamHeader(*facesIn);
-            std::vector<std::vector<index_t> > faces(facesH.lines);
-            readIndexListArray(facesH, *facesIn, faces.data(), faces.size());
-
-            //std::cerr << std::time(0) << " reading Owners" << std::endl;
-            std::shared_ptr<std::istream> ownersIn = m_case.getStreamForFile(meshdir, "owner");
-            if (!ownersIn)
-                return NULL;
-            HeaderInfo ownerH = readFoamHeader(*ownersIn);
-            DimensionInfo dim = parseDimensions(ownerH.note);
-            std::vector<index_t> owners(ownerH.lines);
-            readIndexArray(ownerH, *ownersIn, owners.data(), owners.size());
-
-            //std::cerr << std::time(0) << " reading neighbours" << std::endl;
-            std::shared_ptr<std::istream> neighborsIn = m_case.getStreamForFile(meshdir, "neighbour");
-            if (!neighborsIn)
-                return NULL;
-            HeaderInfo neighbourH = readFoamHeader(*neighborsIn);
-            if (neighbourH.lines != dim.internalFaces)
-            {
-                std::cerr << "inconsistency: #internalFaces != #neighbours" << std::endl;
-                std::cerr << " #internalFaces = " << dim.internalFaces << std::endl;
-                std::cerr << " #neighbours = " << neighbourH.lines << std::endl;
-            }
-            std::vector<index_t> neighbours(neighbourH.lines);
-            readIndexArray(neighbourH, *neighborsIn, neighbours.data(), neighbours.size());
+            stamp.clear();
+            break;
+        }
+        stamp += s;
+    }
+    {
+        std::lock_guard<std::mutex> guard(meshCacheMutex);
+        meshCacheUsed.insert(key);
+        std::map<std::string, std::shared_ptr<const MeshTopology> >::iterator it = meshCache.find(key);
+        if (it != meshCache.end() && !stamp.empty() && it->second->stamp == stamp)
+        {
+            std::cerr << std::time(0) << " Using cached mesh from:            " << meshdir.c_str() << std::endl;
+            return it->second;
+        }
+    }
+
+    std::shared_ptr<MeshTopology> topology(new MeshTopology);
+    topology->stamp = stamp;
+    std::cerr << std::time(0) << " Reading mesh from:                 " << meshdir.c_str() << std::endl;
+    //std::cerr << std::time(0) << " reading Faces" << std::endl;
+    std::shared_ptr<std::istream> facesIn = m_case.getStreamForFile(meshdir, "faces");
+    if (!facesIn)
+        return std::shared_ptr<const MeshTopology>();
+    HeaderInfo facesH = readFoamHeader(*facesIn);
+    std::vector<std::vector<index_t> > faces(facesH.lines);
+    readIndexListArray(facesH, *facesIn, faces.data(), faces.size());
+
+    //std::cerr << std::time(0) << " reading Owners" << std::endl;
+    std::shared_ptr<std::istream> ownersIn = m_case.getStreamForFile(meshdir, "owner");
+    if (!ownersIn)
+        return std::shared_ptr<const MeshTopology>();
+    HeaderInfo ownerH = readFoamHeader(*ownersIn);
+    DimensionInfo dim = parseDimensions(ownerH.note);
+    std::vector<index_t> owners(ownerH.lines);
+    readIndexArray(ownerH, *ownersIn, owners.data(), owners.size());
+
+    //std::cerr << std::time(0) << " reading neighbours" << std::endl;
+    std::shared_ptr<std::istream> neighborsIn = m_case.getStreamForFile(meshdir, "neighbour");
+    if (!neighborsIn)
+        return std::shared_ptr<const MeshTopology>();
+    HeaderInfo neighbourH = readFoamHeader(*neighborsIn);
+    if (neighbourH.lines != dim.internalFaces)
+    {
+        std::cerr << "inconsistency: #internalFaces != #neighbours" << std::endl;
+        std::cerr << " #internalFaces = " << dim.internalFaces << std::endl;
+        std::cerr << " #neighbours = " << neighbourH.lines << std::endl;
+    }
+    std::vector<index_t> neighbours(neighbourH.lines);
+    readIndexArray(neighbourH, *neighborsIn, neighbours.data(), neighbours.size());
+
+    //mesh
+    //std::cerr << std::time(0) << " creating cellToFace Mapping" << std::endl;
+    std::vector<std::vector<index_t> > cellfacemap(dim.cells);
+    for (index_t face = 0; face < owners.size(); ++face)
+    {
+        cellfacemap[owners[face]].push_back(face);
+    }
+
+    for (index_t face = 0; face < neighbours.size(); ++face)
+    {
+        cellfacemap[neighbours[face]].push_back(face);
+    }
 
-            //mesh
-            //std::cerr << std::time(0) << " creating cellToFace Mapping" << std::endl;
-            std::vector<std::vector<index_t> > cellfacemap(dim.cells);
-            for (index_t face = 0; face < owners.size(); ++face)
+    //std::cerr << std::time(0) << " Adding up connectivities" << std::endl;
+    index_t num_elem = dim.cells;
+    std::vector<index_t> types(num_elem, 0);
+    index_t num_conn = 0;
+    index_t num_hex = 0, num_tet = 0, num_prism = 0, num_pyr = 0, num_poly = 0;
+    //Check Shape of Cells and add fill Type_List
+    for (index_t i = 0; i < num_elem; i++)
+    {
+        const std::vector<index_t> &cellfaces = cellfacemap[i];
+        const vertex_set cellvertices = getVerticesForCell(cellfaces, faces);
+        bool onlySimpleFaces = true; //Simple Face = Triangle or Square
+        for (index_t j = 0; j < cellfaces.size(); ++j)
+        { //check if Cell has only Triangular and/or Square Faces
+            if (faces[cellfaces[j]].size() < 3 || faces[cellfaces[j]].size() > 4)
             {
-                cellfacemap[owners[face]].push_back(face);
+                onlySimpleFaces = false;
+                break;
             }
-
-            for (index_t face = 0; face < neighbours.size(); ++face)
+        }
+        const index_t num_faces = index_t(cellfaces.size());
+        index_t num_verts = index_t(cellvertices.size());
+        if (num_faces == 6 && num_verts == 8 && onlySimpleFaces)
+        {
+            types[i] = TYPE_HEXAEDER;
+            ++num_hex;
+        }
+        else if (num_faces == 5 && num_verts == 6 && onlySimpleFaces)
+        {
+            types[i] = TYPE_PRISM;
+            ++num_prism;
+        }
+        else if (num_faces == 5 && num_verts == 5 && onlySimpleFaces)
+        {
+            types[i] = TYPE_PYRAMID;
+            ++num_pyr;
+        }
+        else if (num_faces == 4 && num_verts == 4 && onlySimpleFaces)
+        {
+            types[i] = TYPE_TETRAHEDER;
+            ++num_tet;
+        }
+        else
+        {
+            ++num_poly;
+            types[i] = TYPE_POLYHEDRON;
+            num_verts = 0;
+            for (index_t j = 0; j < cellfaces.size(); ++j)
             {
-                cellfacemap[neighbours[face]].push_back(face);
+                num_verts += index_t(faces[cellfaces[j]].size() + 1);
             }
+        }
+        num_conn += num_verts;
+    }
 
-            //std::cerr << std::time(0) << " Adding up connectivities" << std::endl;
-            index_t num_elem = dim.cells;
-            std::vector<index_t> types(num_elem, 0);
-            index_t num_conn = 0;
-            index_t num_hex = 0, num_tet = 0, num_prism = 0, num_pyr = 0, num_poly = 0;
-            //Check Shape of Cells and add fill Type_List
-            for (index_t i = 0; i < num_elem; i++)
-            {
-                const std::vector<index_t> &cellfaces = cellfacemap[i];
-                const vertex_set cellvertices = getVerticesForCell(cellfaces, faces);
-                bool onlySimpleFaces = true; //Simple Face = Triangle or Square
-                for (index_t j = 0; j < cellfaces.size(); ++j)
-                { //check if Cell has only Triangular and/or Square Faces
-                    if (faces[cellfaces[j]].size() < 3 || faces[cellfaces[j]].size() > 4)
-                    {
-                        onlySimpleFaces = false;
-                        break;
-                    }
-                }
-                const index_t num_faces = index_t(cellfaces.size());
-                index_t num_verts = index_t(cellvertices.size());
-                if (num_faces == 6 && num_verts == 8 && onlySimpleFaces)
-                {
-                    types[i] = TYPE_HEXAEDER;
-                    ++num_hex;
-                }
-                else if (num_faces == 5 && num_verts == 6 && onlySimpleFaces)
-                {
-                    types[i] = TYPE_PRISM;
-                    ++num_prism;
-                }
-                else if (num_faces == 5 && num_verts == 5 && onlySimpleFaces)
-                {
-                    types[i] = TYPE_PYRAMID;
-                    ++num_pyr;
-                }
-                else if (num_faces == 4 && num_verts == 4 && onlySimpleFaces)
-                {
-                    types[i] = TYPE_TETRAHEDER;
-                    ++num_tet;
-                }
-                else
-                {
-                    ++num_poly;
-                    types[i] = TYPE_POLYHEDRON;
-                    num_verts = 0;
-                    for (index_t j = 0; j < cellfaces.size(); ++j)
-                    {
-                        num_verts += index_t(faces[cellfaces[j]].size() + 1);
-                    }
-                }
-                num_conn += num_verts;
+    topology->el.resize(num_elem);
+    topology->cl.resize(num_conn);
+    topology->tl.resize(num_elem);
+    index_t *el = topology->el.data(), *cl = topology->cl.data(), *tl = topology->tl.data();
+
+    //std::cerr << std::time(0) << " Setting element list and connectivity list" << std::endl;
+    // save data cell by cell to element, connectivity and type list
+    index_t conncount = 0;
+    std::vector<index_t> connectivities;
+    //go cell by cell (element by element)
+    for (index_t i = 0; i < dim.cells; i++)
+    {
+        //element list
+        *el = conncount;
+        ++el;
+        //connectivity list
+        const std::vector<index_t> &cellfaces = cellfacemap[i]; //get all faces of current cell
+        //IF cell is Hexahedron
+        if (types[i] == TYPE_HEXAEDER)
+        {
+            index_t ia = cellfaces[0]; //Pick the first face in the Vector as Starting Face (all faces are squares)
+            std::vector<index_t> a = faces[ia]; //find face that corresponds to index ia
+
+            bool na = isPointingInwards(ia, i, dim.internalFaces, owners, neighbours);
+            if (na == false)
+            { //if normal vector is not pointing inwards
+                std::reverse(a.begin(), a.end()); //reverse the ordering of the Vertices
             }
 
-            //Create the unstructured grid
-            meshObj = new coDoUnstructuredGrid(meshObjName.c_str(), num_elem, num_conn, num_points, 1);
+            connectivities = a;
+            connectivities.push_back(findVertexAlongEdge(a[0], ia, cellfaces, faces));
+            connectivities.push_back(findVertexAlongEdge(a[1], ia, cellfaces, faces));
+            connectivities.push_back(findVertexAlongEdge(a[2], ia, cellfaces, faces));
+            connectivities.push_back(findVertexAlongEdge(a[3], ia, cellfaces, faces));
+
+            conncount += 8;
+        }
+
+        if (types[i] == TYPE_PRISM)
+        {
+            index_t it = 1;
+            index_t ia = cellfaces[0];
+            while (faces[ia].size() > 3)
+            { //find triangular face and use it as starting face
+                ia = cellfaces[it++];
+            }
 
-            // get pointers to the first element of the element, vertex and coordinate lists
-            meshObj->getAddresses(&el, &cl, &x_coord, &y_coord, &z_coord);
-            // get a pointer to the type list
-            meshObj->getTypeList(&tl);
+            std::vector<index_t> a = faces[ia];
 
-            //std::cerr << std::time(0) << " Setting element list and connectivity list" << std::endl;
-            // save data cell by cell to element, connectivity and type list
-            index_t conncount = 0;
-            std::vector<index_t> connectivities;
-            //go cell by cell (element by element)
-            for (index_t i = 0; i < dim.cells; i++)
+            bool na = isPointingInwards(ia, i, dim.internalFaces, owners, neighbours);
+            if (na == false)
             {
-                //element list
-                *el = conncount;
-                ++el;
-                //connectivity list
-                const std::vector<index_t> &cellfaces = cellfacemap[i]; //get all faces of current cell
-                //IF cell is Hexahedron
-                if (types[i] == TYPE_HEXAEDER)
-                {
-                    index_t ia = cellfaces[0]; //Pick the first face in the Vector as Starting Face (all faces are squares)
-                    std::vector<index_t> a = faces[ia]; //find face that corresponds to index ia
+                std::reverse(a.begin(), a.end());
+            }
 
-                    bool na = isPointingInwards(ia, i, dim.internalFaces, owners, neighbours);
-                    if (na == false)
-                    { //if normal vector is not pointing inwards
-                        std::reverse(a.begin(), a.end()); //reverse the ordering of the Vertices
-                    }
+            connectivities = a;
+            connectivities.push_back(findVertexAlongEdge(a[0], ia, cellfaces, faces));
+            connectivities.push_back(findVertexAlongEdge(a[1], ia, cellfaces, faces));
+            connectivities.push_back(findVertexAlongEdge(a[2], ia, cellfaces, faces));
 
-                    connectivities = a;
-                    connectivities.push_back(findVertexAlongEdge(a[0], ia, cellfaces, faces));
-                    connectivities.push_back(findVertexAlongEdge(a[1], ia, cellfaces, faces));
-                    connectivities.push_back(findVertexAlongEdge(a[2], ia, cellfaces, faces));
-                    connectivities.push_back(findVertexAlongEdge(a[3], ia, cellfaces, faces));
+            conncount += 6;
+        }
 
-                    conncount += 8;
-                }
+        if (types[i] == TYPE_PYRAMID)
+        {
+            index_t it = 1;
+            index_t ia = cellfaces[0];
+            while (faces[ia].size() < 4)
+            { //find the square and use it as starting face
+                ia = cellfaces[it++];
+            }
 
-                if (types[i] == TYPE_PRISM)
-                {
-                    index_t it = 1;
-                    index_t ia = cellfaces[0];
-                    while (faces[ia].size() > 3)
-                    { //find triangular face and use it as starting face
-                        ia = cellfaces[it++];
-                    }
+            std::vector<index_t> a = faces[ia];
 
-                    std::vector<index_t> a = faces[ia];
+            bool na = isPointingInwards(ia, i, dim.internalFaces, owners, neighbours);
+            if (na == false)
+            {
+                std::reverse(a.begin(), a.end());
+            }
 
-                    bool na = isPointingInwards(ia, i, dim.internalFaces, owners, neighbours);
-                    if (na == false)
-                    {
-                        std::reverse(a.begin(), a.end());
-                    }
+            connectivities = a;
+            connectivities.push_back(findVertexAlongEdge(a[0], ia, cellfaces, faces));
 
-                    connectivities = a;
-                    connectivities.push_back(findVertexAlongEdge(a[0], ia, cellfaces, faces));
-                    connectivities.push_back(findVertexAlongEdge(a[1], ia, cellfaces, faces));
-                    connectivities.push_back(findVertexAlongEdge(a[2], ia, cellfaces, faces));
+            conncount += 5;
+        }
 
-                    conncount += 6;
-                }
+        if (types[i] == TYPE_TETRAHEDER)
+        {
+            index_t ia = cellfaces[0]; //use first face in vector as starting face (all faces are triangles)
+            std::vector<index_t> a = faces[ia];
 
-                if (types[i] == TYPE_PYRAMID)
-                {
-                    index_t it = 1;
-                    index_t ia = cellfaces[0];
-                    while (faces[ia].size() < 4)
-                    { //find the square and use it as starting face
-                        ia = cellfaces[it++];
-                    }
+            bool na = isPointingInwards(ia, i, dim.internalFaces, owners, neighbours);
+            if (na == false)
+            {
+                std::reverse(a.begin(), a.end());
+            }
 
-                    std::vector<index_t> a = faces[ia];
+            connectivities = a;
+            connectivities.push_back(findVertexAlongEdge(a[0], ia, cellfaces, faces));
 
-                    bool na = isPointingInwards(ia, i, dim.internalFaces, owners, neighbours);
-                    if (na == false)
-                    {
-                        std::reverse(a.begin(), a.end());
-                    }
+            conncount += 4;
+        }
 
-                    connectivities = a;
-                    connectivities.push_back(findVertexAlongEdge(a[0], ia, cellfaces, faces));
+        if (types[i] == TYPE_POLYHEDRON)
+        {
+            index_t kk;
+            for (index_t j = 0; j < cellfaces.size(); j++)
+            { //go through all faces in order
+                index_t ia = cellfaces[j];
+                std::vector<index_t> a = faces[ia];
 
-                    conncount += 5;
-                }
+                bool na = isPointingInwards(ia, i, dim.internalFaces, owners, neighbours);
 
-                if (types[i] == TYPE_TETRAHEDER)
+                if (na == false)
                 {
-                    index_t ia = cellfaces[0]; //use first face in vector as starting face (all faces are triangles)
-                    std::vector<index_t> a = faces[ia];
-
-                    bool na = isPointingInwards(ia, i, dim.internalFaces, owners, neighbours);
-                    if (na == false)
+                    std::reverse(a.begin(), a.end());
+                }
+                for (index_t k = 0; k < a.size() + 1; k++)
+                { //go through the vertices of the current face in order
+                    if (k == a.size())
                     {
-                        std::reverse(a.begin(), a.end());
+                        kk = 0;
                     }
+                    else
+                    {
+                        kk = k;
+                    } //the first point has to appear again at the end
+                    connectivities.push_back(a[kk]);
+                    conncount++;
+                }
+            }
+        }
 
-                    connectivities = a;
-                    connectivities.push_back(findVertexAlongEdge(a[0], ia, cellfaces, faces));
+        for (index_t j = 0; j < connectivities.size(); j++)
+        { //add connectivities of the current element to the connectivity List
+            *cl = connectivities[j];
+            ++cl;
+        }
+        // add the type of the current element the type lists
+        *tl++ = types[i];
 
-                    conncount += 4;
-                }
+        connectivities.clear();
+    }
 
-                if (types[i] == TYPE_POLYHEDRON)
-                {
-                    index_t kk;
-                    for (index_t j = 0; j < cellfaces.size(); j++)
-                    { //go through all faces in order
-                        index_t ia = cellfaces[j];
-                        std::vector<index_t> a = faces[ia];
+    if (!stamp.empty())
+    {
+        std::lock_guard<std::mutex> guard(meshCacheMutex);
+        meshCache[key] = topology;
+    }
+    return topology;
+}
 
-                        bool na = isPointingInwards(ia, i, dim.internalFaces, owners, neighbours);
+coDoUnstructuredGrid *ReadFOAM::loadMesh(const std::string &meshdir,
+                                         const std::string &pointsdir,
+                                         const std::string &meshObjName,
+                                         const index_t Processor)
+{
+    coDoUnstructuredGrid *meshObj;
+    index_t *el, *cl, *tl; // element list, connectivity list, type list
+    float *x_coord, *y_coord, *z_coord; // coordinate lists
 
-                        if (na == false)
-                        {
-                            std::reverse(a.begin(), a.end());
-                        }
-                        for (index_t k = 0; k < a.size() + 1; k++)
-                        { //go through the vertices of the current face in order
-                            if (k == a.size())
-                            {
-                                kk = 0;
-                            }
-                            else
-                            {
-                                kk = k;
-                            } //the first point has to appear again at the end
-                            connectivities.push_back(a[kk]);
-                            conncount++;
-                        }
-                    }
-                }
+    if (Processor == -1)
+    {
+        std::shared_ptr<const MeshTopology> topology = loadTopology(meshdir);
+        if (!topology)
+            return NULL;
+        std::shared_ptr<std::istream> pointsIn = m_case.getStreamForFile(pointsdir, "points");
+        if (!pointsIn)
+            return NULL;
+        HeaderInfo pointsH = readFoamHeader(*pointsIn);
+        int num_points = pointsH.lines;
+        index_t num_elem = index_t(topology->el.size());
+        index_t num_conn = index_t(topology->cl.size());
 
-                for (index_t j = 0; j < connectivities.size(); j++)
-                { //add connectivities of the current element to the connectivity List
-                    *cl = connectivities[j];
-                    ++cl;
-                }
-                // add the type of the current element the type lists
-                *tl++ = types[i];
+        //Create the unstructured grid
+        meshObj = new coDoUnstructuredGrid(meshObjName.c_str(), num_elem, num_conn, num_points, 1);
 
-                connectivities.clear();
-            }
-        }
+        // get pointers to the first element of the element, vertex and coordinate lists
+        meshObj->getAddresses(&el, &cl, &x_coord, &y_coord, &z_coord);
+        // get a pointer to the type list
+        meshObj->getTypeList(&tl);
+        std::copy(topology->el.begin(), topology->el.end(), el);
+        std::copy(topology->cl.begin(), topology->cl.end(), cl);
+        std::copy(topology->tl.begin(), topology->tl.end(), tl);
 
         // save coordinates to coordinate lists
         //      if (pointsH.lines != dim.points) {
@@ -1159,10 +1260,11 @@ int ReadFOAM::compute(const char *port) //Compute is called when Module is execu
     }
     float starttime = starttimeParam->getValue();
     float stoptime = stoptimeParam->getValue(); 
-    basemeshs.clear();
-    basebounds.clear();
+    basemeshs.assign(std::max(1,m_case.numblocks), NULL);
+    basebounds.assign(std::max(1,m_case.numblocks), NULL);
     pointmaps.clear();
     pointmaps.resize(std::max(1,m_case.numblocks));
+    const size_t memoryBudget = size_t(coCoviseConfig::getInt("Module.ReadFoam.MemoryBudget", 4096)) << 20;
 
     std::vector<coDistributedObject *> meshSubSets;
     coDoSet *meshSet=NULL, *meshSubSet=NULL;
@@ -1190,6 +1292,24 @@ int ReadFOAM::compute(const char *port) //Compute is called when Module is execu
         }
     }
 
+    // streaming execution: modules below may start with the first timesteps
+    // while the others are still being read
+    index_t numTimesteps = 0;
+    for (std::map<double, std::string>::const_iterator it = m_case.timedirs.begin();
+            it != m_case.timedirs.end();
+            ++it)
+    {
+        if (it->first >= starttime && it->first <= (stoptime*(1+1e-6)))
+            ++numTimesteps;
+    }
+    numTimesteps = (numTimesteps + skipfactor - 1) / skipfactor;
+    auto publishTimestep = [this, numTimesteps](const coOutputPort *port, index_t timestep,
+                                                const std::vector<coDistributedObject *> &subSets)
+    {
+        if (numTimesteps > 1 && subSets.size() > size_t(timestep))
+            publishSetElement(port, timestep, numTimesteps, subSets[timestep]);
+    };
+
     int counter = 0;
     index_t timestep = 0;
     for (std::map<double, std::string>::const_iterator it = m_case.timedirs.begin();
@@ -1218,32 +1338,41 @@ int ReadFOAM::compute(const char *port) //Compute is called when Module is execu
                     std::vector<std::vector<coDistributedObject *> > tempSetPort(num_ports);
                     std::vector<std::vector<coDistributedObject *> > tempSetBoundPort(num_boundary_data_ports);
                     std::vector<std::vector<coDistributedObject *> > tempSetParticlesPort(num_ports);
-                    for (index_t j = 0;( j < m_case.numblocks || j==0); j++)
-                    { //fill vector:tempSet with all the mesh parts of all processors even if its just one
-                        //std::cerr << " processor" << j;
+                    const index_t numBlocks = std::max(1, m_case.numblocks);
+                    const std::string completeMeshDir = m_case.completeMeshDirs[t];
+                    const bool readMesh = (!m_case.varyingCoords && counter==0) || m_case.varyingCoords;
+                    std::vector<BlockObjects> blocks(numBlocks, BlockObjects(num_ports, num_boundary_data_ports));
+                    // directories of mesh, points and data of processor j
+                    auto blockDirs = [&](index_t j, std::string &meshdir, std::string &pointsdir, std::string &datadir)
+                    {
                         std::stringstream sMeshDir;
                         std::stringstream sPointsDir;
                         std::stringstream sDataDir;
                         if (m_case.numblocks > 0)
                         {
-                            sMeshDir << "processor" << j  << "/" << m_case.completeMeshDirs[t] << "/polyMesh";
+                            sMeshDir << "processor" << j  << "/" << completeMeshDir << "/polyMesh";
                             sPointsDir << "processor" << j  << "/" << timedir << "/polyMesh";
                             sDataDir << "processor" << j  << "/" << timedir;
                         }
                         else
                         {
-                            sMeshDir << m_case.completeMeshDirs[t] << "/polyMesh";
+                            sMeshDir << completeMeshDir << "/polyMesh";
                             sPointsDir << timedir << "/polyMesh";
                             sDataDir << timedir;
                         }
 
-                        std::string meshdir = sMeshDir.str();
-                        std::string pointsdir;
+                        meshdir = sMeshDir.str();
                         if (m_case.varyingCoords)
                             pointsdir = sPointsDir.str();
                         else
                             pointsdir = meshdir;
-                        std::string datadir = sDataDir.str();
+                        datadir = sDataDir.str();
+                    };
+                    auto readBlock = [&](index_t j)
+                    {
+                        BlockObjects &b = blocks[j];
+                        std::string meshdir, pointsdir, datadir;
+                        blockDirs(j, meshdir, pointsdir, datadir);
                         std::stringstream sm;
                         std::stringstream sb;
                         std::stringstream sd;
@@ -1263,7 +1392,7 @@ int ReadFOAM::compute(const char *port) //Compute is called when Module is execu
                             sp << "_timestep_" << timestep << "_data";
                         }
 
-                        if ((!m_case.varyingCoords && counter==0) || m_case.varyingCoords)
+                        if (readMesh)
                         {
                             if (meshParam->getValue())
                             {   
@@ -1282,7 +1411,7 @@ int ReadFOAM::compute(const char *port) //Compute is called when Module is execu
                                 }
                                 if (m_case.varyingCoords)
                                     m->addAttribute("REALTIME", realtime.c_str());
-                                tempSetMesh.push_back(m);
+                                b.mesh.push_back(m);
                             }
                             if (boundaryParam->getValue())
                             {
@@ -1302,7 +1431,7 @@ int ReadFOAM::compute(const char *port) //Compute is called when Module is execu
                                 }
                                 if (m_case.varyingCoords)
                                     p->addAttribute("REALTIME", realtime.c_str());
-                                tempSetBoundary.push_back(p);
+                                b.boundary.push_back(p);
                             }
                         }
                         for (int nPort = 0; nPort < num_ports; ++nPort)
@@ -1328,7 +1457,7 @@ int ReadFOAM::compute(const char *port) //Compute is called when Module is execu
                                         processorID[i] = float(j);
                                     }
                                     v->addAttribute("REALTIME", realtime.c_str());
-                                    tempSetPort[nPort].push_back(v);
+                                    b.port[nPort].push_back(v);
                                 }
                                 else
                                 {
@@ -1338,7 +1467,7 @@ int ReadFOAM::compute(const char *port) //Compute is called when Module is execu
                                     coDistributedObject *v = loadField(datadir, dataFilename, portObjName, meshdir);
                                     if (v)
                                         v->addAttribute("REALTIME", realtime.c_str());
-                                    tempSetPort[nPort].push_back(v);
+                                    b.port[nPort].push_back(v);
                                 }
                             }                           
                         }
@@ -1375,7 +1504,7 @@ int ReadFOAM::compute(const char *port) //Compute is called when Module is execu
                                         processorID[i] = float(j);
                                     }
                                     v->addAttribute("REALTIME", realtime.c_str());
-                                    tempSetBoundPort[nPort].push_back(v);
+                                    b.boundPort[nPort].push_back(v);
                                 }
                                 else
                                 {
@@ -1385,7 +1514,7 @@ int ReadFOAM::compute(const char *port) //Compute is called when Module is execu
                                     coDistributedObject *v = loadBoundaryField(datadir, meshdir, dataFilename, portObjName, selection);
                                     if (v)
                                         v->addAttribute("REALTIME", realtime.c_str());
-                                    tempSetBoundPort[nPort].push_back(v);
+                                    b.boundPort[nPort].push_back(v);
                                 }
                             }
                         }
@@ -1411,13 +1540,13 @@ int ReadFOAM::compute(const char *port) //Compute is called when Module is execu
                                 if (p)
                                 {
                                     p->addAttribute("REALTIME", realtime.c_str());
-                                    tempSetParticles.push_back(p);
+                                    b.particles.push_back(p);
                                 }
                                 if (cellIds)
                                 {
                                     cellIds->addAttribute("REALTIME", realtime.c_str());
                                     for (size_t i=0; i<cellIdPorts.size(); ++i)
-                                        tempSetParticlesPort[cellIdPorts[i]].push_back(cellIds);
+                                        b.particlesPort[cellIdPorts[i]].push_back(cellIds);
                                 }
                             }
                             for (int nPort = 0; nPort < num_ports; ++nPort)
@@ -1433,10 +1562,61 @@ int ReadFOAM::compute(const char *port) //Compute is called when Module is execu
                                     coDistributedObject *v = loadField(lagdir, dataFilename, portObjName, meshdir);
                                     if (v)
                                         v->addAttribute("REALTIME", realtime.c_str());
-                                    tempSetParticlesPort[nPort].push_back(v);
+                                    b.particlesPort[nPort].push_back(v);
                                 }
                             }
                         }
+                    };
+
+                    if (m_case.archived || numBlocks == 1 || coThreadPool::global().numThreads() < 2)
+                    {
+                        for (index_t j = 0; j < numBlocks; j++)
+                            readBlock(j);
+                    }
+                    else
+                    {
+                        // read the processors in parallel, in groups whose estimated memory fits into the budget
+                        std::vector<size_t> memory(numBlocks);
+                        for (index_t j = 0; j < numBlocks; j++)
+                        {
+                            std::string meshdir, pointsdir, datadir;
+                            blockDirs(j, meshdir, pointsdir, datadir);
+                            memory[j] = 2 * fileSize(pointsdir, "points");
+                            if (readMesh)
+                                memory[j] += 4 * (fileSize(meshdir, "faces") + fileSize(meshdir, "owner") + fileSize(meshdir, "neighbour"));
+                            for (int nPort = 0; nPort < num_ports; ++nPort)
+                            {
+                                index_t portchoice = portChoice[nPort]->getValue();
+                                if (portchoice > 1 && portchoice <= m_case.varyingFields.size()+1)
+                                    memory[j] += 2 * fileSize(datadir, portChoice[nPort]->getLabel(portchoice));
+                            }
+                        }
+                        for (index_t first = 0; first < numBlocks;)
+                        {
+                            index_t last = first + 1;
+                            size_t sum = memory[first];
+                            while (last < numBlocks && sum + memory[last] <= memoryBudget)
+                                sum += memory[last++];
+                            coThreadPool::global().run(last - first, [&](size_t i, int)
+                                                       {
+                                                           readBlock(first + index_t(i));
+                                                       });
+                            first = last;
+                        }
+                    }
+                    for (index_t j = 0; j < numBlocks; j++)
+                    { //fill vector:tempSet with all the mesh parts of all processors even if its just one
+                        const BlockObjects &b = blocks[j];
+                        tempSetMesh.insert(tempSetMesh.end(), b.mesh.begin(), b.mesh.end());
+                        tempSetBoundary.insert(tempSetBoundary.end(), b.boundary.begin(), b.boundary.end());
+                        tempSetParticles.insert(tempSetParticles.end(), b.particles.begin(), b.particles.end());
+                        for (int nPort = 0; nPort < num_ports; ++nPort)
+                        {
+                            tempSetPort[nPort].insert(tempSetPort[nPort].end(), b.port[nPort].begin(), b.port[nPort].end());
+                            tempSetParticlesPort[nPort].insert(tempSetParticlesPort[nPort].end(), b.particlesPort[nPort].begin(), b.particlesPort[nPort].end());
+                        }
+                        for (int nPort = 0; nPort < num_boundary_data_ports; ++nPort)
+                            tempSetBoundPort[nPort].insert(tempSetBoundPort[nPort].end(), b.boundPort[nPort].begin(), b.boundPort[nPort].end());
                     }
                     std::stringstream s;
                     s << "_set_timestep" << timestep;
@@ -1526,6 +1706,17 @@ int ReadFOAM::compute(const char *port) //Compute is called when Module is execu
                             particlePortSubSets[nPort].push_back(particlePortSubSet);
                         }
                     }
+
+                    publishTimestep(meshOutPort, timestep, meshSubSets);
+                    publishTimestep(boundaryOutPort, timestep, boundarySubSets);
+                    publishTimestep(particleOutPort, timestep, particleSubSets);
+                    for (int nPort = 0; nPort < num_ports; ++nPort)
+                    {
+                        publishTimestep(outPorts[nPort], timestep, portSubSets[nPort]);
+                        publishTimestep(particleDataPorts[nPort], timestep, particlePortSubSets[nPort]);
+                    }
+                    for (int nPort = 0; nPort < num_boundary_data_ports; ++nPort)
+                        publishTimestep(boundaryDataPorts[nPort], timestep, boundPortSubSets[nPort]);
                 }
                 ++timestep;
             }
@@ -1617,6 +1808,19 @@ int ReadFOAM::compute(const char *port) //Compute is called when Module is execu
     }
 
 
+    {
+        // forget the meshes of other cases and time directories
+        std::lock_guard<std::mutex> guard(meshCacheMutex);
+        for (std::map<std::string, std::shared_ptr<const MeshTopology> >::iterator it = meshCache.begin(); it != meshCache.end();)
+        {
+            if (meshCacheUsed.find(it->first) == meshCacheUsed.end())
+                meshCache.erase(it++);
+            else
+                ++it;
+        }
+        meshCacheUsed.clear();
+    }
+
 coModule::sendInfo("ReadFOAM complete.");
 std::cerr << "ReadFOAM finished." << std::endl;
 
@@ -34,6 +34,13 @@
 
 #include "foamtoolbox.h"
 
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
 using namespace covise;
 typedef int index_t;
 
@@ -67,9 +74,23 @@ private:
     std::vector<coChoiceParam *> particleDataChoice;
     coStringParam *patchesStringParam;
 
+    // element, connectivity and type list of a polyMesh, kept across
+    // executions as long as its faces, owner and neighbour files do not change
+    struct MeshTopology
+    {
+        std::string stamp;
+        std::vector<index_t> el, cl, tl;
+    };
+    std::map<std::string, std::shared_ptr<const MeshTopology> > meshCache;
+    std::set<std::string> meshCacheUsed; // during the current execution
+    std::mutex meshCacheMutex;
+
     //  member functions
     virtual int compute(const char *port);
     bool vectorsAreFilled();
+    std::string fileStamp(const std::string &dir, const std::string &file);
+    std::shared_ptr<const MeshTopology> loadTopology(const std::string &meshdir);
+    size_t fileSize(const std::string &dir, const std::string &file);
 
 public:
     ReadFOAM(int argc, char *argv[]); //Constructor
@@ -101,8 +122,8 @@ public:
                                       const std::string &file,
                                       const std::string &vecObjName,
                                       const std::string &selection);
-    std::map<int, coDoUnstructuredGrid *> basemeshs;
-    std::map<int, coDoPolygons *> basebounds;
+    std::vector<coDoUnstructuredGrid *> basemeshs;
+    std::vector<coDoPolygons *> basebounds;
     std::vector<std::map<int, int> > pointmaps;
 };
 #endif // READFOAM_H
@@ -1255,9 +1255,14 @@ bool readArrayBinary(std::istream &stream, T *p, const size_t lines)
     {
        return readArrayChunkBinary(stream, p, lines);
     }
+    else if (sizeof(T) == sizeof(D) && boost::is_integral<T>::value && boost::is_integral<D>::value)
+    {
+       // labels of the same size only differ in signedness, read them in place
+       return readArrayChunkBinary(stream, reinterpret_cast<D *>(p), lines);
+    }
     else
     {
-       std::vector<D> buf(bufsiz);
+       std::vector<D> buf(std::min(lines, bufsiz));
        for (size_t i=0; i<lines; i+=bufsiz)
        {
           const size_t nread = i+bufsiz <= lines ? bufsiz : lines-i;
@@ -1380,15 +1385,21 @@ bool readIndexCompactListArrayBinary(std::istream &stream, std::vector<T> *p, co
     }
 
     expect('(');
+    // all the lists at once, instead of a read per list
+    std::vector<T> indices(totalIndices);
+    if (totalIndices > 0 && !readArrayBinary<T, D>(stream, &indices[0], totalIndices))
+    {
+        std::cerr << "readIndexCompactListArrayBinary: readArrayBinary<index_t> failed to read " << totalIndices << " indices" << std::endl;
+        return false;
+    }
     for (size_t i=0; i<lines-1; ++i)
     {
-       size_t n = faceIndex[i+1] - faceIndex[i];
-       p[i].resize(n);
-       if (!readArrayBinary<index_t, D>(stream, &p[i][0], n))
+       if (faceIndex[i] > faceIndex[i+1])
        {
-           std::cerr << "readIndexCompactListArrayBinary: readArrayBinary<index_t> failed to read index list " << i << std::endl;
+           std::cerr << "readIndexCompactListArrayBinary: decreasing faceIndex at " << i << std::endl;
            return false;
        }
+       p[i].assign(indices.begin() + faceIndex[i], indices.begin() + faceIndex[i+1]);
     }
     expect(')');
     p[lines-1].resize(0);
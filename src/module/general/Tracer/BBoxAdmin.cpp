@@ -62,7 +62,9 @@ BBoxAdmin::clean()
             }
             if (prev == grid) // do not destroy an object more than once
             {
-                const_cast<coDistributedObject *>(iaOctTrees_[grid])->destroy();
+                // shared trees are destroyed together with their grid
+                if (!coDoOctTree::isShared(iaOctTrees_[grid]))
+                    const_cast<coDistributedObject *>(iaOctTrees_[grid])->destroy();
                 delete const_cast<coDistributedObject *>(iaOctTrees_[grid]);
             }
         }
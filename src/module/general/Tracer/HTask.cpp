@@ -234,26 +234,7 @@ HTask::HTask(const coModule *mod,
     fillRealTime();
 }
 
-// maqke the assignation of a PTask for a worker thread
-void
-HTask::assignTask(PTask **pp_task,
-                  int label)
-{
-    // shortly it is serviced
-    ptasks_[serviced_]->set_status(PTask::SERVICED);
-    ptasks_[serviced_]->set_label(label);
-    *pp_task = ptasks_[serviced_++]; // assign and increase serviced_ counter
-}
-
-// Gather results from a PTask
-void
-HTask::gatherPTask(PTask **pp_task)
-{ // a thread has finished a PTask
-    ++no_finished_;
-    *pp_task = 0;
-}
-
-// Solve sequentially all PTasks (used without pthreads)
+// Solve sequentially all PTasks (used without worker threads)
 void
 HTask::Solve(float epsilon,
              float epsilon_abs)
@@ -267,6 +248,27 @@ HTask::Solve(float epsilon,
     }
 }
 
+// Solve all PTasks with the worker threads of pool
+void
+HTask::Solve(coThreadPool &pool,
+             float epsilon,
+             float epsilon_abs)
+{
+    int first = serviced_;
+    for (int i = first; i < no_ptasks_; ++i)
+    {
+        ptasks_[i]->set_status(PTask::SERVICED);
+    }
+    serviced_ = no_ptasks_;
+    pool.run(no_ptasks_ - first, [&](size_t i, int thread)
+             {
+                 PTask *task = ptasks_[first + i];
+                 task->set_label(thread);
+                 task->Solve(epsilon, epsilon_abs);
+             });
+    no_finished_ = no_ptasks_;
+}
+
 void
 HTask::cleanPTasks()
 {
@@ -572,13 +574,6 @@ HTask::allPFinished()
     return (no_finished_ == no_ptasks_);
 }
 
-// returns whether there are still unserviced ptasks
-int
-HTask::unserviced()
-{
-    return serviced_ != no_ptasks_;
-}
-
 HTask::~HTask()
 {
     cleanPTasks();
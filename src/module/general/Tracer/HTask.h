@@ -21,6 +21,7 @@
 
 #include "PTask.h"
 #include <api/coModule.h>
+#include <util/coThreadPool.h>
 using namespace covise;
 #include <float.h>
 
@@ -53,23 +54,18 @@ public:
        * @param    eps_abs  absolute error per time step for step control.
        */
     void Solve(float epsilon, float epsilon_abs);
+    /** Solve the PTasks in parallel. Each thread starts on a contiguous part
+       * of the PTasks and takes over PTasks of the other threads when it is
+       * done, so a few long tracelines do not keep the other threads waiting.
+       * @param    pool     worker threads.
+       * @param    eps      relative error per time step for step control.
+       * @param    eps_abs  absolute error per time step for step control.
+       */
+    void Solve(coThreadPool &pool, float epsilon, float epsilon_abs);
     /** Return 1 if all PTasks have been finished, 0 otherwise.
        * @return            all PTasks have been finished or not.
        */
     virtual int allPFinished();
-    /** Return 1 if there are still PTasks to be assigned to a thread.
-       * @return            all PTasks have been assigned to a thread.
-       */
-    int unserviced();
-    /** Assign a task to a thread reading tasks from "port" *pp_task
-       * @retval   pp_task address of pointer to the assigned PTask.
-       * @param    label   thread identification.
-       */
-    void assignTask(PTask **pp_task, int label);
-    /** Do whatever is necessary when a PTask is done.
-       * @retval   pp_task set the pointer to assigned task to zero.
-       */
-    void gatherPTask(PTask **pp_task);
     /** Return 1 if all time steps are done.
        * @return            all time steps are done.
        */
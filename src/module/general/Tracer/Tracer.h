@@ -20,9 +20,9 @@
 #define _TRACER_H_
 
 #include <api/coModule.h>
+#include <util/coThreadPool.h>
 using namespace covise;
 #include "HTask.h"
-#include "Fifo.h"
 
 #include "BBoxAdmin.h"
 
@@ -43,10 +43,6 @@ class Tracer : public coFunctionModule
 public:
     HTask::time_direction td_;
     Tracer(int argc, char **argv);
-    virtual ~Tracer()
-    {
-        delete[] read_task_;
-    }
     enum HTaskTyp
     {
         STREAMLINES = 0,
@@ -131,14 +127,9 @@ private:
     ///////////////////////////////////////
     int crewSize_;
     int findCrewSize();
-    PTask **read_task_; // list of pointers to PTask objects.
-    // used for task assignation
-    Fifo<int> lazyThreads_;
-
-    //  virtual void quit();
-    void terminateThreads();
-    void startThreads();
-    void lockMMutex();
+    // worker threads, created for crewSize_ > 0
+    std::unique_ptr<coThreadPool> pool_;
+
     BBoxAdmin BBoxAdmin_;
     bool GoodOctTrees();
     bool GoodOctTrees(const coDistributedObject *grid, const coDistributedObject *otree);
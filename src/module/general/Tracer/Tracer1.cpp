@@ -23,8 +23,8 @@ string speciesAttr;
 int
 Tracer::findCrewSize()
 {
-    int numNodes = coCoviseConfig::getInt("System.HostInfo.NumProcessors", 1);
-    if ((numNodes < 1) || (numNodes > 200))
+    int numNodes = coCoviseConfig::getInt("System.HostInfo.NumProcessors", coThreadPool::defaultNumThreads());
+    if ((numNodes < 1) || (numNodes > 256))
     {
         numNodes = 1;
     }
@@ -0,0 +1,174 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+// scaling of the parallel PTask integration with the number of threads:
+// streamlines in the analytic ABC flow are integrated with the
+// Runge-Kutta stepper of PTask, where the lines of the first tenth of the
+// seeds are much longer than the others, once with a static partition of
+// the lines among the threads and once with coThreadPool
+//
+// usage: tracerBench [lines] [max. threads]
+
+#include "PTask.h"
+#include <util/coThreadPool.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using namespace covise;
+
+// streamline in the ABC flow
+class AnalyticLine : public PTask
+{
+public:
+    AnalyticLine(float x, float y, float z, int max_points)
+        : PTask(0)
+        , max_points_(max_points)
+        , num_points_(0)
+    {
+        ini_point_[0] = x;
+        ini_point_[1] = y;
+        ini_point_[2] = z;
+    }
+    virtual void Solve(float eps, float eps_abs)
+    {
+        float t = 0.0f, h = 0.01f, hdid, hnext;
+        float y[3] = { ini_point_[0], ini_point_[1], ini_point_[2] };
+        float dydx[3], yscal[3];
+        derivs(t, y, dydx, 0, -1);
+        for (num_points_ = 1; num_points_ < max_points_; ++num_points_)
+        {
+            for (int i = 0; i < 3; ++i)
+                yscal[i] = fabsf(y[i]) + fabsf(dydx[i] * h) + 1e-30f;
+            if (rkqs(y, dydx, 3, &t, h, eps, eps_abs, yscal, &hdid, &hnext) != SERVICED)
+                break;
+            derivs(t, y, dydx, 0, -1);
+            h = hnext;
+        }
+        end_[0] = y[0];
+        end_[1] = y[1];
+        end_[2] = y[2];
+        set_status(FINISHED_POINTS);
+    }
+    int numPoints() const
+    {
+        return num_points_;
+    }
+    const float *end() const
+    {
+        return end_;
+    }
+
+protected:
+    virtual status derivs(float, const float *p, float *v, int, int)
+    {
+        const float A = 1.0f, B = 0.7f, C = 0.43f;
+        v[0] = A * sinf(p[2]) + C * cosf(p[1]);
+        v[1] = B * sinf(p[0]) + A * cosf(p[2]);
+        v[2] = C * sinf(p[1]) + B * cosf(p[0]);
+        return SERVICED;
+    }
+
+private:
+    int max_points_;
+    int num_points_;
+    float end_[3];
+};
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void makeLines(std::vector<AnalyticLine> &lines, int numLines)
+{
+    lines.clear();
+    lines.reserve(numLines);
+    for (int i = 0; i < numLines; ++i)
+    {
+        float s = (float)i / numLines;
+        // the first tenth of the seeds gives lines that are 50 times as long
+        int max_points = s < 0.1f ? 20000 : 400;
+        lines.emplace_back(6.2832f * s, 1.0f + 0.5f * s, 0.3f, max_points);
+    }
+}
+
+static bool sameLines(const std::vector<AnalyticLine> &a, const std::vector<AnalyticLine> &b)
+{
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        if (a[i].numPoints() != b[i].numPoints())
+            return false;
+        for (int d = 0; d < 3; ++d)
+            if (a[i].end()[d] != b[i].end()[d])
+                return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    int numLines = argc > 1 ? atoi(argv[1]) : 2000;
+    int maxThreads = argc > 2 ? atoi(argv[2]) : coThreadPool::defaultNumThreads();
+    if (numLines < 1)
+        numLines = 1;
+    if (maxThreads < 1)
+        maxThreads = 1;
+    const float eps = 1e-5f, eps_abs = 1e-6f;
+
+    std::vector<AnalyticLine> reference;
+    makeLines(reference, numLines);
+    auto start = std::chrono::steady_clock::now();
+    for (auto &line : reference)
+        line.Solve(eps, eps_abs);
+    double serial = seconds_since(start);
+    long points = 0;
+    for (auto &line : reference)
+        points += line.numPoints();
+    printf("%d lines, %ld points, serial %8.3f s\n", numLines, points, serial);
+
+    bool ok = true;
+    std::vector<AnalyticLine> lines;
+    for (int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        // static partition: each thread gets a contiguous part of the lines
+        makeLines(lines, numLines);
+        start = std::chrono::steady_clock::now();
+        std::vector<std::thread> crew;
+        for (int t = 0; t < threads; ++t)
+            crew.emplace_back([&lines, t, threads, numLines, eps, eps_abs]()
+                              {
+                                  for (int i = numLines * t / threads; i < numLines * (t + 1) / threads; ++i)
+                                      lines[i].Solve(eps, eps_abs);
+                              });
+        for (auto &thread : crew)
+            thread.join();
+        double staticTime = seconds_since(start);
+        ok = sameLines(reference, lines) && ok;
+
+        // work stealing
+        makeLines(lines, numLines);
+        coThreadPool pool(threads);
+        start = std::chrono::steady_clock::now();
+        pool.run(lines.size(), [&](size_t i, int)
+                 {
+                     lines[i].Solve(eps, eps_abs);
+                 });
+        double poolTime = seconds_since(start);
+        ok = sameLines(reference, lines) && ok;
+
+        printf("%3d threads   static %8.3f s (speedup %5.2f)   coThreadPool %8.3f s (speedup %5.2f)\n",
+               threads, staticTime, serial / staticTime, poolTime, serial / poolTime);
+    }
+    if (!ok)
+        printf("MISMATCH between serial and parallel results\n");
+    return ok ? 0 : 1;
+}
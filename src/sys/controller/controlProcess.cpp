@@ -47,8 +47,8 @@ void Controller::get_shared_memory(const covise::Connection *conn)
     conn->recv_msg(&msg);
     if (msg.type == COVISE_MESSAGE_GET_SHM_KEY)
     {
-        print_comment(__LINE__, __FILE__, "GET_SHM_KEY: %d: %x, %d length: %d", *(int *)msg.data.data(),
-                      ((int *)msg.data.data())[1], ((int *)msg.data.data())[2], msg.data.length());
+        print_comment(__LINE__, __FILE__, "GET_SHM_KEY: %d: %x length: %d", *(int *)msg.data.data(),
+                      ((int *)msg.data.data())[1], msg.data.length());
         shm = new ShmAccess(msg.data.accessData(), 0);
     }
     // data of received message can be deleted
@@ -56,12 +56,13 @@ void Controller::get_shared_memory(const covise::Connection *conn)
 
 void Controller::handle_shm_msg(Message *msg)
 {
-    int tmpkey, size;
+    int tmpkey;
+    shmSizeType size;
 
     if (msg->conn->get_sender_id() == 1)
     {
-        tmpkey = ((int *)msg->data.data())[0];
-        size = ((int *)msg->data.data())[1];
+        tmpkey = *(int *)msg->data.data();
+        size = *(shmSizeType *)(&msg->data.data()[sizeof(int)]);
         shm->add_new_segment(tmpkey, size);
         print_comment(__LINE__, __FILE__, "new SharedMemory");
     }
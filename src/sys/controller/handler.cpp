@@ -34,6 +34,7 @@
 #include "list.h"
 #include "module.h"
 #include "object.h"
+#include "pipelineTrace.h"
 #include "port.h"
 #include "subProcess.h"
 #include "util.h"
@@ -304,6 +305,7 @@ void CTRLHandler::handleMsg(const std::unique_ptr<Message> &msg)
             Message mapmsg{COVISE_MESSAGE_UI, "FINISHED\n"};
             m_hostManager.sendAll<Userinterface>(mapmsg);
             m_hostManager.sendAll<Renderer>(mapmsg);
+            PipelineTrace::instance().write();
         }
 
         break;
@@ -459,6 +461,16 @@ void CTRLHandler::handleMsg(const std::unique_ptr<Message> &msg)
         break;
     }
 
+    //  SET_ELEMENT: streaming execution
+    case COVISE_MESSAGE_SET_ELEMENT:
+        handleSetElement(copyMessageData);
+        break;
+
+    //  TRACE: spans recorded by a module, renderer or CRB
+    case COVISE_MESSAGE_TRACE:
+        PipelineTrace::instance().addSpans(copyMessageData);
+        break;
+
     case COVISE_MESSAGE_GENERIC:
     {
         /* nach Keywords und Module auswerten */
@@ -855,6 +867,14 @@ void CTRLHandler::handleFinall(const std::unique_ptr<Message> &msg, string copyM
     try
     {
         auto &app = m_hostManager.findHost(hostAddress).getModule(name, std::stoi(instance));
+        PipelineTrace::instance().finished(app);
+
+        //  an element of a set has been computed, its objects went to the modules below
+        if (app.finishStreamedElement(m_numRunning))
+        {
+            executionFinished(msg, copyMessageData);
+            return;
+        }
 
         app.errorsSentByModule().clear();
 
@@ -894,6 +914,8 @@ void CTRLHandler::handleFinall(const std::unique_ptr<Message> &msg, string copyM
             app.set_DO_status(DO_RELEASE, dataObjectNames);
         }
 
+        app.cacheResults();
+
         //  send Message with Output-Parameters to all UIF
         string content = app.get_outparaobj();
         if (!content.empty())
@@ -929,26 +951,68 @@ void CTRLHandler::handleFinall(const std::unique_ptr<Message> &msg, string copyM
             }
         }
 
-        // send Finished Message to the MapEditor if no modules are running
-        m_numRunning.apps--;
-        if (m_numRunning.apps == 0)
+        executionFinished(msg, copyMessageData);
+    }
+    catch (const Exception &e)
+    {
+        std::cerr << e.what() << '\n';
+        cerr << "Module was already deleted but has sent Finished" << endl;
+    }
+}
+
+void CTRLHandler::executionFinished(const std::unique_ptr<Message> &msg, string &copyMessageData)
+{
+    // send Finished Message to the MapEditor if no modules are running
+    m_numRunning.apps--;
+    if (m_numRunning.apps == 0)
+    {
+        if (m_options.quit)
         {
-            if (m_options.quit)
-            {
-                m_quitNow = 1;
-                msg->data.setLength(0);
-                copyMessageData.clear();
-            }
+            m_quitNow = 1;
+            msg->data.setLength(0);
+            copyMessageData.clear();
+        }
 
-            Message mapmsg{COVISE_MESSAGE_UI, "FINISHED\n"};
-            m_hostManager.sendAll<Userinterface>(mapmsg);
-            m_hostManager.sendAll<Renderer>(mapmsg);
+        Message mapmsg{COVISE_MESSAGE_UI, "FINISHED\n"};
+        m_hostManager.sendAll<Userinterface>(mapmsg);
+        m_hostManager.sendAll<Renderer>(mapmsg);
+        PipelineTrace::instance().write();
+    }
+}
+
+//!
+//! streaming execution: a module supports it or has completed an element of a set
+//!
+void CTRLHandler::handleSetElement(const string &copyMessageData)
+{
+    int iel = 0;
+    vector<string> list = splitStringAndRemoveComments(copyMessageData, "\n");
+    if (list.size() < 4)
+        return;
+    const string &name = list[iel++];
+    const string &instance = list[iel++];
+    const string &hostAddress = list[iel++];
+    const string &key = list[iel++];
+    try
+    {
+        auto &app = m_hostManager.findHost(hostAddress).getModule(name, std::stoi(instance));
+        if (key == "STREAMING")
+        {
+            app.setStreaming(true, list.size() > 4 && list[iel] == "REUSE");
+        }
+        else if (key == "ELEMENT" && list.size() >= 8)
+        {
+            const string &port = list[iel++];
+            int element = std::stoi(list[iel++]);
+            int numElements = std::stoi(list[iel++]);
+            const string &objName = list[iel++];
+            app.publishSetElement(port, element, numElements, objName, m_numRunning);
         }
     }
     catch (const Exception &e)
     {
         std::cerr << e.what() << '\n';
-        cerr << "Module was already deleted but has sent Finished" << endl;
+        cerr << "SET_ELEMENT: did not find module  " << name << "_" << instance << " on " << hostAddress << endl;
     }
 }
 
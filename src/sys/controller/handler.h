@@ -94,6 +94,8 @@ void handleQuit(const std::unique_ptr<Message> &msg);
 void handleUI(Message *msg, string data);
 void handleNewUi(const NEW_UI &msg);
 void handleFinall(const std::unique_ptr<Message>& msg, string data);
+void executionFinished(const std::unique_ptr<Message> &msg, string &data);
+void handleSetElement(const string &data);
 void delModuleNode(const vector<NetModule *> &liste);
 const NetModule * initModuleNode(const string &name, const string &nr, const string &host, int, int, const string &, int, ExecFlag flags);
 NetModule *findApplication(const std::string &ipAddress, const std::string &name, int instance);
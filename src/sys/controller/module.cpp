@@ -12,7 +12,9 @@
 #include "handler.h"
 #include "host.h"
 #include "module.h"
+#include "pipelineTrace.h"
 #include "renderModule.h"
+#include "resultCache.h"
 #include "util.h"
 
 #include <cassert>
@@ -51,6 +53,7 @@ bool NetModule::isOnTop() const
 
 NetModule::~NetModule()
 {
+    ResultCache::instance().remove(*this);
     for (NetModule *app : m_mirrors)
     {
         if (m_mirror != NOT_MIRR) //ist mirrored
@@ -462,11 +465,15 @@ void NetModule::onConnectionClosed()
     ss << "Module " << fullName() << "@" << host.userInfo().ipAdress << " crashed !!!";
     host.hostManager.sendAll<Userinterface>(Message{COVISE_MESSAGE_COVISE_ERROR, ss.str()});
 
+    CTRLHandler::instance()->numRunning().apps -= static_cast<int>(m_streamRunning.size());
+    m_streamRunning.clear();
+    m_streamWaiting.clear();
+    m_streamOpen = false;
     CTRLHandler::instance()->finishExecuteIfLastRunning(*this);
     setAlive(false);
 }
 
-std::string NetModule::getStartMessage()
+std::string NetModule::getStartMessage(const StreamedElement *element)
 {
     std::stringstream buff;
     buff << serialize();
@@ -492,6 +499,13 @@ std::string NetModule::getStartMessage()
                 const object *obj = interface.get_object();
                 assert(obj);
                 std::string obj_name = obj->get_current_name();
+                if (element)
+                {
+                    const auto &names = interface.get_direction() == controller::Direction::Input ? element->inputs : element->outputs;
+                    auto name = names.find(interface.get_name());
+                    if (name != names.end())
+                        obj_name = name->second;
+                }
                 if (obj_name.empty())
                 {
                     return "";
@@ -535,6 +549,9 @@ std::string NetModule::getStartMessage()
     {
         buff << param.serialize();
     }
+    // modules can find out that the set they get is not complete, see Covise::is_streamed_element()
+    if (element)
+        buff << "STREAMED_ELEMENT\n";
     return buff.str();
 }
 
@@ -745,7 +762,7 @@ bool NetModule::is_one_running_under() const
                                                    const NetModule *app = conn.get_mod();
                                                    if (app &&
                                                        !dynamic_cast<const Renderer *>(app) &&
-                                                       app->isExecuting())
+                                                       (app->isExecuting() || app->isStreamBusy()))
                                                    {
                                                        oneRunningUnder = true;
                                                        return;
@@ -771,12 +788,26 @@ void NetModule::execute(NumRunning &numRunning)
         numRunning.apps--;
         return;
     }
+    if (reuseCachedResults(numRunning))
+        return;
     setExecuting(true);
 
-    //delete_all Objects if not saved
-    bool ret = delete_old_objs();
-    //give new Names to Output_objects
-    new_obj_names();
+    bool ret = false;
+    if (m_streamOpen && m_streamReuse && streamMatchesInputs())
+    {
+        // the output objects got their names for the streamed elements,
+        // the module reuses the elements that it has already computed
+        closeStream(false);
+    }
+    else
+    {
+        // modules that create all elements again would collide with the streamed ones
+        closeStream(true);
+        //delete_all Objects if not saved
+        ret = delete_old_objs();
+        //give new Names to Output_objects
+        new_obj_names();
+    }
     m_errorsSentByModule.clear();
 
     string content = getStartMessage();
@@ -795,6 +826,7 @@ void NetModule::execute(NumRunning &numRunning)
 
     Message msg{COVISE_MESSAGE_START, content};
     send(&msg);
+    PipelineTrace::instance().started(*this);
 
     content = this->get_inparaobj();
     if (!content.empty())
@@ -804,6 +836,60 @@ void NetModule::execute(NumRunning &numRunning)
     }
 }
 
+bool NetModule::reuseCachedResults(NumRunning &numRunning)
+{
+    ResultCache &cache = ResultCache::instance();
+    m_cacheKey.clear();
+    if (!cache.enabled() || m_mirror != NOT_MIRR || m_streamOpen)
+        return false;
+
+    std::string key = cache.key(*this);
+    const ResultCache::Outputs *outputs = cache.find(key);
+    bool complete = outputs != nullptr;
+    m_connectivity.forAllNetInterfaces([&complete, outputs](const net_interface &interface)
+                                       {
+                                           if (complete && interface.get_direction() == controller::Direction::Output && interface.get_conn_state() &&
+                                               outputs->find(interface.get_name()) == outputs->end())
+                                               complete = false;
+                                       });
+    if (!complete)
+    {
+        // remember the key to store the results when the module has finished
+        m_cacheKey = key;
+        return false;
+    }
+
+    // the cached objects become the outputs again, as if the module had finished
+    delete_old_objs();
+    m_connectivity.forAllNetInterfaces([outputs](net_interface &interface)
+                                       {
+                                           if (interface.get_direction() == controller::Direction::Output && interface.get_conn_state())
+                                               interface.get_object()->reuseDataObject(outputs->at(interface.get_name()));
+                                       });
+    m_errorsSentByModule.clear();
+    sendFinish();
+    setStart();
+    startModulesUnder(numRunning);
+    --numRunning.apps;
+    return true;
+}
+
+void NetModule::cacheResults()
+{
+    std::string key;
+    std::swap(key, m_cacheKey);
+    if (key.empty() || m_status == Status::stopping)
+        return;
+
+    ResultCache::Outputs outputs;
+    m_connectivity.forAllNetInterfaces([&outputs](const net_interface &interface)
+                                       {
+                                           if (interface.get_direction() == controller::Direction::Output && interface.get_conn_state())
+                                               outputs[interface.get_name()] = interface.get_object()->get_current_name();
+                                       });
+    ResultCache::instance().insert(*this, key, outputs);
+}
+
 int NetModule::overflowOfNextError() const
 {
     constexpr int maxErrors = 25;
@@ -978,6 +1064,219 @@ void NetModule::delObjectConn(const string &from_intf, object *obj)
     }
 }
 
+void NetModule::setStreaming(bool state, bool reuse)
+{
+    m_streaming = state;
+    m_streamReuse = reuse;
+}
+
+bool NetModule::isStreaming() const
+{
+    return m_streaming;
+}
+
+bool NetModule::isStreamOpen() const
+{
+    return m_streamOpen;
+}
+
+bool NetModule::isStreamBusy() const
+{
+    return !m_streamRunning.empty();
+}
+
+void NetModule::publishSetElement(const std::string &port, int element, int numElements, const std::string &objName, NumRunning &numRunning)
+{
+    try
+    {
+        auto &interface = m_connectivity.getInterface<net_interface>(port);
+        if (interface.get_direction() == controller::Direction::Output && interface.get_conn_state())
+        {
+            forwardSetElement(interface.get_object(), element, numElements, objName, numRunning);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << '\n';
+    }
+}
+
+void NetModule::forwardSetElement(object *obj, int element, int numElements, const std::string &objName, NumRunning &numRunning)
+{
+    // the set that will be the object of the port when the module has finished
+    const std::string source = obj->get_current_name();
+    for (auto &conn : obj->get_to())
+    {
+        NetModule *mod = conn.get_mod();
+        if (auto renderer = dynamic_cast<Renderer *>(mod))
+        {
+            renderer->showStreamedElement(conn, objName);
+        }
+        else if (mod && mod->isStreaming())
+        {
+            mod->receiveSetElement(conn.get_mod_intf(), source, element, numElements, objName, numRunning);
+        }
+    }
+}
+
+void NetModule::receiveSetElement(const std::string &port, const std::string &source, int element, int numElements, const std::string &objName, NumRunning &numRunning)
+{
+    if (!m_alive || m_status != Status::Idle)
+        return;
+
+    if (m_streamOpen)
+    {
+        auto src = m_streamSources.find(port);
+        if (src != m_streamSources.end() && src->second != source)
+        {
+            // the module above has been executed again
+            closeStream(true);
+        }
+    }
+    if (!m_streamOpen)
+    {
+        // the old objects may still be read below, the whole set is computed later
+        if (is_one_running_under())
+            return;
+        delete_old_objs();
+        new_obj_names();
+        m_streamOpen = true;
+    }
+    m_streamSources[port] = source;
+
+    auto &waiting = m_streamWaiting[element];
+    waiting.element = element;
+    waiting.numElements = numElements;
+    waiting.inputs[port] = objName;
+    executeStreamedElements(numRunning);
+}
+
+void NetModule::executeStreamedElements(NumRunning &numRunning)
+{
+    for (auto it = m_streamWaiting.begin(); it != m_streamWaiting.end();)
+    {
+        // inputs from modules above that are not executing do not change
+        bool ready = true;
+        StreamedElement &element = it->second;
+        m_connectivity.forAllNetInterfaces([&ready, &element](const net_interface &interface)
+                                           {
+                                               if (interface.get_direction() == controller::Direction::Input && interface.get_conn_state() &&
+                                                   element.inputs.find(interface.get_name()) == element.inputs.end())
+                                               {
+                                                   const NetModule *above = interface.get_object()->get_from().get_mod();
+                                                   if (above && (above->isExecuting() || above->isStreamOpen()))
+                                                       ready = false;
+                                               }
+                                           });
+        if (!ready)
+        {
+            ++it;
+            continue;
+        }
+
+        m_connectivity.forAllNetInterfaces([&element](const net_interface &interface)
+                                           {
+                                               if (interface.get_direction() == controller::Direction::Output && interface.get_conn_state())
+                                                   element.outputs[interface.get_name()] = interface.get_object()->get_current_name() + "_" + std::to_string(element.element);
+                                           });
+        string content = getStartMessage(&element);
+        if (!content.empty())
+        {
+            Message msg{COVISE_MESSAGE_START, content};
+            send(&msg);
+            PipelineTrace::instance().started(*this);
+            m_streamRunning.push_back(std::move(element));
+            ++numRunning.apps;
+        }
+        it = m_streamWaiting.erase(it);
+    }
+}
+
+bool NetModule::finishStreamedElement(NumRunning &numRunning)
+{
+    if (m_streamRunning.empty())
+        return false;
+
+    StreamedElement element = std::move(m_streamRunning.front());
+    m_streamRunning.pop_front();
+    // the module stops the pipeline if it could not compute the element
+    if (m_status == Status::stopping)
+    {
+        m_status = Status::Idle;
+        element.discard = true;
+    }
+
+    auto &crb = dynamic_cast<const CRBModule &>(host.getProcess(sender_type::CRB));
+    for (const auto &output : element.outputs)
+    {
+        if (element.discard)
+        {
+            data elementData;
+            elementData.set_name(output.second);
+            elementData.del_data(crb);
+            continue;
+        }
+        if (m_streamOpen)
+            m_streamOutputs.push_back(output.second);
+        try
+        {
+            auto &interface = m_connectivity.getInterface<net_interface>(output.first);
+            if (interface.get_conn_state())
+                forwardSetElement(interface.get_object(), element.element, element.numElements, output.second, numRunning);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << e.what() << '\n';
+        }
+    }
+
+    if (m_streamRunning.empty())
+        startModuleWaitingAbove(numRunning);
+    return true;
+}
+
+bool NetModule::streamMatchesInputs() const
+{
+    for (const auto &source : m_streamSources)
+    {
+        try
+        {
+            const auto &interface = m_connectivity.getInterface<net_interface>(source.first);
+            if (!interface.get_conn_state() || interface.get_object()->get_current_name() != source.second)
+                return false;
+        }
+        catch (const std::exception &e)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void NetModule::closeStream(bool discard)
+{
+    if (!m_streamOpen)
+        return;
+
+    m_streamOpen = false;
+    m_streamSources.clear();
+    m_streamWaiting.clear();
+    if (discard)
+    {
+        // nobody gets the elements that are still being computed
+        for (auto &element : m_streamRunning)
+            element.discard = true;
+        auto &crb = dynamic_cast<const CRBModule &>(host.getProcess(sender_type::CRB));
+        for (const auto &name : m_streamOutputs)
+        {
+            data elementData;
+            elementData.set_name(name);
+            elementData.del_data(crb);
+        }
+    }
+    m_streamOutputs.clear();
+}
+
 std::string NetModule::serialize() const
 {
     std::stringstream buff;
@@ -8,6 +8,8 @@
 #ifndef CONTROLL_MODULE_H
 #define CONTROLL_MODULE_H
 
+#include <deque>
+#include <map>
 #include <vector>
 #include <string>
 
@@ -103,6 +105,20 @@ struct NetModule : SubProcess
     void writeScript(std::ofstream &of) const;
     virtual void setObjectConn(const string &from_intf, object *obj);
     virtual void delObjectConn(const string &from_intf, object *obj);
+
+    // streaming execution: modules that support it are started for single elements
+    // of the sets published by the modules above while these are still executing
+    // reuse: the execution for the whole set keeps the elements computed before
+    void setStreaming(bool state, bool reuse = false);
+    bool isStreaming() const;
+    bool isStreamOpen() const; // output names are assigned, elements are being computed
+    bool isStreamBusy() const; // element executions have not finished
+    // element of the set that will be the object of output port has been completed
+    void publishSetElement(const std::string &port, int element, int numElements, const std::string &objName, NumRunning &numRunning);
+    // handle the finish message of an element execution, false if it belongs to a normal execution
+    bool finishStreamedElement(NumRunning &numRunning);
+    // store the outputs of the finished execution in the ResultCache
+    void cacheResults();
     
     const size_t moduleId; //global id, incremented for every module created -> s_nodeID
     
@@ -118,7 +134,31 @@ private:
     bool m_isStarted = false;
     bool m_alive = true;
     int m_instance = 0; //What number Module with this moduleInfo this is (unique in combination with module name)
-    std::string getStartMessage();
+    struct StreamedElement
+    {
+        int element = 0;
+        int numElements = 0;
+        std::map<std::string, std::string> inputs;  // input port -> element object
+        std::map<std::string, std::string> outputs; // output port -> element object
+        bool discard = false;                      // stream was given up while executing
+    };
+    bool m_streaming = false;
+    bool m_streamReuse = false;
+    bool m_streamOpen = false;
+    std::map<std::string, std::string> m_streamSources; // input port -> name of the streamed set
+    std::map<int, StreamedElement> m_streamWaiting;     // elements missing some of their inputs
+    std::deque<StreamedElement> m_streamRunning;        // elements sent to the module, in order
+    std::vector<std::string> m_streamOutputs;           // element objects created for the open stream
+    static void forwardSetElement(object *obj, int element, int numElements, const std::string &objName, NumRunning &numRunning);
+    void receiveSetElement(const std::string &port, const std::string &source, int element, int numElements, const std::string &objName, NumRunning &numRunning);
+    void executeStreamedElements(NumRunning &numRunning);
+    bool streamMatchesInputs() const;
+    void closeStream(bool discard);
+    std::string m_cacheKey; // key of the running execution in the ResultCache
+    // finish without starting the module if the cache has results for the current inputs
+    bool reuseCachedResults(NumRunning &numRunning);
+
+    std::string getStartMessage(const StreamedElement *element = nullptr);
     void sendWarningMsgToMasterUi(const std::string &msg);
     bool delete_old_objs();
     void new_obj_names();
@@ -13,6 +13,7 @@
 #include "module.h"
 #include "object.h"
 #include "renderModule.h"
+#include "resultCache.h"
 
 #include <covise/covise.h>
 #include <covise/covise_msg.h>
@@ -659,6 +660,12 @@ void object::newDataObject()
     std::for_each(to.begin(), to.end(), [&new_name](obj_conn &conn) { conn.new_data(new_name); });
 }
 
+void object::reuseDataObject(const string &name)
+{
+    dataobj->new_data(name);
+    std::for_each(to.begin(), to.end(), [&name](obj_conn &conn) { conn.new_data(name); });
+}
+
 void object::del_old_DO()
 {
     auto &crb = dynamic_cast<const controller::CRBModule &>(get_from().get_mod()->host.getProcess(sender_type::CRB));
@@ -668,7 +675,9 @@ void object::del_old_DO()
     {
         if (tmp_data->get_save_status() == 0)
         {
-            tmp_data->del_data(crb);
+            // objects in the result cache are destroyed when they are evicted
+            if (!controller::ResultCache::instance().contains(tmp_data->get_name()))
+                tmp_data->del_data(crb);
             for (auto &c : to)
             {
                 c.del_old_DO(tmp_data->get_name());
@@ -706,7 +715,7 @@ void object::del_all_DO(int already_dead)
 		data* tmp_data;
 		while ((tmp_data = dataobj->next()) != NULL)
 		{
-			if (already_dead >= 0)
+			if (already_dead >= 0 && !controller::ResultCache::instance().contains(tmp_data->get_name()))
 				tmp_data->del_data(crb);
 			std::for_each(to.begin(), to.end(), [&tmp_data](obj_conn& conn) { conn.del_old_DO(tmp_data->get_name()); });
 			dataobj->remove(tmp_data);
@@ -737,7 +746,7 @@ void object::del_old_data()
 					if (tmp_data->get_save_status() == 0)
 					{
 						string del_status = tmp_data->get_status();
-						if (del_status != "DEL")
+						if (del_status != "DEL" && !controller::ResultCache::instance().contains(tmp_data->get_name()))
 						{
 							tmp_data->del_data(crb);
 						}
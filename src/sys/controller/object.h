@@ -296,6 +296,7 @@ public:
     int is_one_running_above() const;
 
     void newDataObject(); //same as new_timestep
+    void reuseDataObject(const std::string &name); // an object created before becomes the current one
     void del_old_DO();
     void del_rez_DO();
     void del_all_DO(int already_dead);
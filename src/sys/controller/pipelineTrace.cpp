@@ -0,0 +1,178 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#include "pipelineTrace.h"
+#include "module.h"
+#include "util.h"
+
+#include <util/coTrace.h>
+
+#include <fstream>
+#include <iostream>
+
+using namespace covise;
+using namespace covise::controller;
+
+static std::string escape(const std::string &s)
+{
+    std::string e;
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\')
+            e += '\\';
+        e += c;
+    }
+    return e;
+}
+
+PipelineTrace &PipelineTrace::instance()
+{
+    static PipelineTrace trace;
+    return trace;
+}
+
+PipelineTrace::PipelineTrace()
+    : m_enabled(coTrace::instance().enabled())
+{
+}
+
+bool PipelineTrace::enabled() const
+{
+    return m_enabled;
+}
+
+void PipelineTrace::started(const NetModule &mod)
+{
+    if (!m_enabled)
+        return;
+    long long now = coTrace::now();
+    if (m_begin < 0)
+        m_begin = now;
+    m_running[mod.moduleId].push_back(now);
+}
+
+void PipelineTrace::finished(const NetModule &mod)
+{
+    if (!m_enabled)
+        return;
+    auto running = m_running.find(mod.moduleId);
+    if (running == m_running.end() || running->second.empty())
+        return;
+
+    Span span;
+    span.name = mod.fullName() + "@" + mod.getHost();
+    span.category = "execute";
+    // one row per module
+    span.thread = (int)mod.moduleId;
+    span.begin = running->second.front();
+    span.end = coTrace::now();
+    running->second.pop_front();
+    m_processes["controller"].push_back(span);
+}
+
+void PipelineTrace::elementShown(const NetModule &renderer, const std::string &objName)
+{
+    if (!m_enabled || m_begin < 0)
+        return;
+    long long now = coTrace::now();
+    if (m_firstShown < 0)
+        m_firstShown = now;
+
+    Span span;
+    span.name = objName;
+    span.category = "stream";
+    span.thread = (int)renderer.moduleId;
+    span.begin = span.end = now;
+    m_processes["controller"].push_back(span);
+}
+
+void PipelineTrace::addSpans(const std::string &messageData)
+{
+    if (!m_enabled)
+        return;
+    std::vector<std::string> lines = splitStringAndRemoveComments(messageData, "\n");
+    if (lines.empty())
+        return;
+
+    auto &spans = m_processes[lines[0]];
+    for (size_t i = 1; i < lines.size(); ++i)
+    {
+        std::vector<std::string> fields = splitStringAndRemoveComments(lines[i], "\t");
+        if (fields.size() < 5)
+            continue;
+        Span span;
+        span.name = fields[0];
+        span.category = fields[1];
+        try
+        {
+            span.thread = std::stoi(fields[2]);
+            span.begin = std::stoll(fields[3]);
+            span.end = std::stoll(fields[4]);
+        }
+        catch (const std::exception &)
+        {
+            continue;
+        }
+        spans.push_back(span);
+    }
+}
+
+void PipelineTrace::write()
+{
+    if (!m_enabled)
+        return;
+    if (m_begin < 0)
+    {
+        // nothing has been executed, e.g. only a renderer has finished
+        m_processes.clear();
+        return;
+    }
+
+    long long end = coTrace::now();
+    if (m_firstShown >= 0)
+    {
+        std::cerr << "PipelineTrace: first streamed element shown after " << (m_firstShown - m_begin) / 1000
+                  << " ms, execution finished after " << (end - m_begin) / 1000 << " ms" << std::endl;
+    }
+
+    std::string filename = "covise_trace_" + std::to_string(++m_numExecutions) + ".json";
+    std::ofstream of(filename);
+    if (!of)
+    {
+        std::cerr << "PipelineTrace: could not write " << filename << std::endl;
+    }
+    else
+    {
+        of << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool first = true;
+        int pid = 0;
+        for (const auto &process : m_processes)
+        {
+            of << (first ? "\n" : ",\n")
+               << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid
+               << ",\"args\":{\"name\":\"" << escape(process.first) << "\"}}";
+            first = false;
+            for (const auto &span : process.second)
+            {
+                // spans sent late by a previous execution
+                if (span.end < m_begin)
+                    continue;
+                of << ",\n{\"name\":\"" << escape(span.name) << "\",\"cat\":\"" << escape(span.category)
+                   << "\",\"ph\":\"X\",\"ts\":" << span.begin << ",\"dur\":" << span.end - span.begin
+                   << ",\"pid\":" << pid << ",\"tid\":" << span.thread << "}";
+            }
+            ++pid;
+        }
+        of << "\n]}\n";
+        std::cerr << "PipelineTrace: timeline of the execution written to " << filename << std::endl;
+    }
+
+    m_begin = -1;
+    m_firstShown = -1;
+    m_processes.clear();
+    m_running.clear();
+}
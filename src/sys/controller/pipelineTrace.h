@@ -0,0 +1,63 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#ifndef CONTROLLER_PIPELINE_TRACE_H
+#define CONTROLLER_PIPELINE_TRACE_H
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace covise
+{
+namespace controller
+{
+struct NetModule;
+
+// collects the spans recorded by the COVISE processes with coTrace and the
+// module executions seen by the controller, and writes a Chrome/Perfetto
+// trace (chrome://tracing, ui.perfetto.dev) for every execution of the map
+class PipelineTrace
+{
+public:
+    static PipelineTrace &instance();
+
+    bool enabled() const;
+    // a START message has been sent to mod
+    void started(const NetModule &mod);
+    // mod has finished an execution
+    void finished(const NetModule &mod);
+    // renderer has been sent an element of a set that is still being computed
+    void elementShown(const NetModule &renderer, const std::string &objName);
+    // contents of a COVISE_MESSAGE_TRACE
+    void addSpans(const std::string &messageData);
+    // no module is running anymore: write covise_trace_<n>.json
+    void write();
+
+private:
+    PipelineTrace();
+
+    struct Span
+    {
+        std::string name, category;
+        int thread = 0;
+        long long begin = 0, end = 0;
+    };
+
+    bool m_enabled = false;
+    int m_numExecutions = 0;
+    long long m_begin = -1;                             // first START of the current execution
+    long long m_firstShown = -1;                        // first streamed element sent to a renderer
+    std::map<std::string, std::vector<Span>> m_processes; // by process label
+    std::map<size_t, std::deque<long long>> m_running;    // module id -> times of its START messages
+};
+
+} // namespace controller
+} // namespace covise
+
+#endif
@@ -10,6 +10,7 @@
 #include "userinterface.h"
 #include "handler.h"
 #include "exception.h"
+#include "pipelineTrace.h"
 
 using namespace covise;
 using namespace covise::controller;
@@ -606,6 +607,24 @@ void Renderer::send_add(const object &obj, obj_conn &connection)
     }
 }
 
+void Renderer::showStreamedElement(obj_conn &connection, const string &name)
+{
+    if (m_ready < 0 || m_displays.empty())
+        return;
+
+    m_ready -= m_displays.size();
+    for (auto &display : m_displays)
+    {
+        if (!connection.get_old_name().empty())
+            display->send_del(connection.get_old_name(), name);
+        else
+            display->send_add(name);
+    }
+    // the complete set replaces it when the module has finished
+    connection.set_old_name(name);
+    PipelineTrace::instance().elementShown(*this, name);
+}
+
 void Renderer::send_add_obj(const string &name)
 {
     for (auto &display : m_displays)
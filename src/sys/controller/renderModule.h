@@ -78,6 +78,9 @@ struct Renderer : NetModule
     DisplayList::iterator addDisplayAndHandleConnections(const Userinterface &ui);
     void send_add(const object &obj, obj_conn &connection);
     void send_add_obj(const string &name);
+    // show an element of a set that is still being computed instead of the
+    // object of connection, skipped while the displays are busy
+    void showStreamedElement(obj_conn &connection, const string &name);
 
     bool update(DisplayList::iterator display, NumRunning &numRunning);
     bool isMirrorOf(int ModuleID) const;
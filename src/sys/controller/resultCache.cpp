@@ -0,0 +1,133 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#include "resultCache.h"
+#include "crb.h"
+#include "host.h"
+#include "module.h"
+#include "object.h"
+#include "port.h"
+
+#include <config/CoviseConfig.h>
+
+#include <iterator>
+#include <sstream>
+
+using namespace covise;
+using namespace covise::controller;
+
+ResultCache &ResultCache::instance()
+{
+    static ResultCache cache;
+    return cache;
+}
+
+ResultCache::ResultCache()
+{
+    m_enabled = coCoviseConfig::isOn("System.ResultCache", false);
+    // results kept per host: the controller does not know the size of the objects
+    int maxEntries = coCoviseConfig::getInt("entries", "System.ResultCache", 64);
+    m_maxEntries = maxEntries > 0 ? maxEntries : 1;
+}
+
+bool ResultCache::enabled() const
+{
+    return m_enabled;
+}
+
+std::string ResultCache::key(const NetModule &mod) const
+{
+    std::stringstream ss;
+    ss << mod.fullName() << "@" << mod.getHost() << "\n"
+       << mod.get_parameter(controller::Direction::Input, false);
+    // object names change with every execution of the module above
+    mod.connectivity().forAllNetInterfaces([&ss](const net_interface &interface)
+                                           {
+                                               if (interface.get_direction() == controller::Direction::Input && interface.get_conn_state())
+                                               {
+                                                   ss << interface.get_name() << "\n"
+                                                      << interface.get_object()->get_current_name() << "\n";
+                                               }
+                                           });
+    return ss.str();
+}
+
+const ResultCache::Outputs *ResultCache::find(const std::string &key)
+{
+    auto entry = m_entries.find(key);
+    if (entry == m_entries.end())
+        return nullptr;
+
+    auto &entries = m_hosts[entry->second->mod->getHost()];
+    entries.splice(entries.begin(), entries, entry->second);
+    return &entry->second->outputs;
+}
+
+void ResultCache::insert(const NetModule &mod, const std::string &key, const Outputs &outputs)
+{
+    auto old = m_entries.find(key);
+    if (old != m_entries.end())
+        evict(old->second);
+
+    auto &entries = m_hosts[mod.getHost()];
+    entries.push_front(Entry{key, &mod, outputs});
+    m_entries[key] = entries.begin();
+    for (const auto &output : outputs)
+        m_objects.insert(output.second);
+
+    while (entries.size() > m_maxEntries)
+        evict(std::prev(entries.end()));
+}
+
+bool ResultCache::contains(const std::string &objName) const
+{
+    return m_objects.find(objName) != m_objects.end();
+}
+
+void ResultCache::remove(const NetModule &mod)
+{
+    auto entries = m_hosts.find(mod.getHost());
+    if (entries == m_hosts.end())
+        return;
+
+    for (auto entry = entries->second.begin(); entry != entries->second.end();)
+    {
+        auto next = std::next(entry);
+        if (entry->mod == &mod)
+            evict(entry);
+        entry = next;
+    }
+}
+
+void ResultCache::evict(EntryList::iterator entry)
+{
+    const NetModule &mod = *entry->mod;
+    for (const auto &output : entry->outputs)
+    {
+        m_objects.erase(output.second);
+        // the module's current output is deleted when it is executed again or removed
+        bool current = false;
+        try
+        {
+            auto &interface = mod.connectivity().getInterface<net_interface>(output.first);
+            current = interface.get_conn_state() && interface.get_object()->get_current_name() == output.second;
+            if (!current)
+            {
+                auto &crb = dynamic_cast<const CRBModule &>(mod.host.getProcess(sender_type::CRB));
+                data obj;
+                obj.set_name(output.second);
+                obj.del_data(crb);
+            }
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << e.what() << '\n';
+        }
+    }
+    m_entries.erase(entry->key);
+    m_hosts[mod.getHost()].erase(entry);
+}
@@ -0,0 +1,69 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#ifndef CONTROLLER_RESULT_CACHE_H
+#define CONTROLLER_RESULT_CACHE_H
+
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+
+namespace covise
+{
+namespace controller
+{
+struct NetModule;
+
+// output objects of module executions, so that a module is not executed again
+// for the same parameters and input objects: instead, the objects it has
+// created before are passed on to the modules below.
+// Configured in System.ResultCache, off by default.
+class ResultCache
+{
+public:
+    typedef std::map<std::string, std::string> Outputs; // output port -> object name
+
+    static ResultCache &instance();
+
+    bool enabled() const;
+    // module, host, input parameters and input objects
+    std::string key(const NetModule &mod) const;
+    // the outputs of an earlier execution for key, nullptr if there is none
+    const Outputs *find(const std::string &key);
+    // remember the outputs of an execution, drops the least recently used
+    // results of the module's host if there are too many
+    void insert(const NetModule &mod, const std::string &key, const Outputs &outputs);
+    // objects in the cache must not be destroyed when a module is executed again
+    bool contains(const std::string &objName) const;
+    // forget the results of a module that is deleted and destroy their objects
+    void remove(const NetModule &mod);
+
+private:
+    ResultCache();
+
+    struct Entry
+    {
+        std::string key;
+        const NetModule *mod = nullptr;
+        Outputs outputs;
+    };
+    typedef std::list<Entry> EntryList;
+
+    void evict(EntryList::iterator entry);
+
+    bool m_enabled = false;
+    size_t m_maxEntries = 0;                                  // per host
+    std::map<std::string, EntryList> m_hosts;                 // most recently used first
+    std::map<std::string, EntryList::iterator> m_entries;     // by key
+    std::set<std::string> m_objects;
+};
+
+} // namespace controller
+} // namespace covise
+
+#endif
@@ -13,6 +13,7 @@
 #include <net/covise_host.h>
 #include <util/coFileUtil.h>
 #include <util/coSpawnProgram.h>
+#include <util/coTrace.h>
 #include <util/unixcompat.h>
 
 #ifndef _WIN32
@@ -124,6 +125,7 @@ int main(int argc, char* argv[])
     msg.data = DataHandle{ d, strlen(d) + 1 };
     datamgr->send_ctl_msg(&msg);
 
+    std::string traceLabel = std::string("CRB@") + Host().getAddress();
     while (1)
     {
         msg = *datamgr->wait_for_msg();
@@ -657,6 +659,17 @@ int main(int argc, char* argv[])
             if ((send_back == 2) && (msg.type != COVISE_MESSAGE_EMPTY))
                 msg.conn->sendMessage(&msg);
 
+            // object transfers and shm allocations of the data manager
+            if (coTrace::instance().enabled())
+            {
+                std::string spans = coTrace::instance().takeMessage(traceLabel);
+                if (!spans.empty())
+                {
+                    Message traceMsg{COVISE_MESSAGE_TRACE, spans};
+                    datamgr->send_ctl_msg(&traceMsg);
+                }
+            }
+
             break;
         }
 
@@ -54,9 +54,12 @@ extern ApplicationWindow *mw;
 #include <QtCore/qdir.h>
 #include <QtNetwork/qhostinfo.h>
 #include <QSocketNotifier>
+#include <QTimer>
 //#include <QTreeWidget>
 
 #include <vrb/server/VrbClientList.h>
+#include <vrb/server/VrbServerRegistry.h>
+#include <algorithm>
 #include <csignal>
 #include "gui/VRBapplication.h"
 
@@ -90,6 +93,26 @@ VRBServer::VRBServer(bool gui)
         vrbClients = &clients;
         handler.reset(new VrbMessageHandler(this));
     }
+
+    // high frequency variables, e.g. tracking data, are sent at most once per window
+    int window = coCoviseConfig::getInt("window", "System.VRB.Coalesce", 0);
+    bool coalesce = window > 0;
+    VrbServerRegistry::setCoalescingWindow("", std::chrono::milliseconds(window));
+    for (const auto &className : coCoviseConfig::getScopeNames("System.VRB.Coalesce", "Class"))
+    {
+        int classWindow = coCoviseConfig::getInt("window", "System.VRB.Coalesce.Class:" + className, window);
+        VrbServerRegistry::setCoalescingWindow(className, std::chrono::milliseconds(classWindow));
+        coalesce = coalesce || classWindow > 0;
+    }
+    m_statisticsInterval = coCoviseConfig::getInt("statisticsInterval", "System.VRB.Server", 0);
+    m_lastStatistics = std::chrono::steady_clock::now();
+    if (gui && (coalesce || m_statisticsInterval > 0))
+    {
+        flushTimer.reset(new QTimer);
+        flushTimer->setSingleShot(true);
+        QObject::connect(&*flushTimer, SIGNAL(timeout()), this, SLOT(flushRegistryChanges()));
+    }
+    flushRegistryChanges();
 #ifndef _WIN32
     signal(SIGPIPE, SIG_IGN); // otherwise writes to a closed socket kill the application.
 #endif
@@ -156,9 +179,18 @@ void VRBServer::loop()
     }
 }
 
+// waitTime, but not beyond the time the next coalesced registry change is due
+float VRBServer::boundedWait(float waitTime) const
+{
+    if (m_nextFlush == std::chrono::steady_clock::time_point::max())
+        return waitTime;
+    std::chrono::duration<float> due = m_nextFlush - std::chrono::steady_clock::now();
+    return std::max(0.f, std::min(waitTime, due.count()));
+}
+
 void VRBServer::processMessages(float waitTime)
 {
-	while (const Connection *conn = connections.check_for_input(waitTime))
+	while (const Connection *conn = connections.check_for_input(boundedWait(waitTime)))
     {
         if (conn == udpConn) // udp connection
         {
@@ -179,7 +211,48 @@ void VRBServer::processMessages(float waitTime)
             if (m_gui)
                 static_cast<VrbUiMessageHandler*>(handler.get())->setClientNotifier(conn, true);
         }
+        flushRegistryChanges();
     }
+    flushRegistryChanges();
+}
+
+void VRBServer::flushRegistryChanges()
+{
+    m_nextFlush = handler->flushRegistryChanges();
+    if (m_statisticsInterval > 0)
+    {
+        if (std::chrono::steady_clock::now() - m_lastStatistics >= std::chrono::seconds(m_statisticsInterval))
+            printStatistics();
+        m_nextFlush = std::min(m_nextFlush, m_lastStatistics + std::chrono::seconds(m_statisticsInterval));
+    }
+    if (flushTimer)
+    {
+        // in gui mode nothing else wakes us up when a held back change is due
+        if (m_nextFlush == std::chrono::steady_clock::time_point::max())
+        {
+            flushTimer->stop();
+        }
+        else
+        {
+            auto due = std::chrono::duration_cast<std::chrono::milliseconds>(m_nextFlush - std::chrono::steady_clock::now());
+            flushTimer->start(std::max(0, int(due.count())));
+        }
+    }
+}
+
+void VRBServer::printStatistics()
+{
+    auto &last = m_reportedStatistics;
+    const auto &s = VrbServerRegistry::statistics();
+    size_t changes = s.changes - last.changes;
+    size_t serializations = s.serializations - last.serializations;
+    size_t messages = s.messages - last.messages;
+    size_t coalesced = s.coalesced - last.coalesced;
+    std::cerr << "VRB registry: " << changes << " changes, " << coalesced << " coalesced, "
+              << serializations << " serialized for " << messages << " messages ("
+              << (messages - serializations) << " serializations saved)" << std::endl;
+    last = s;
+    m_lastStatistics = std::chrono::steady_clock::now();
 }
 
 void VRBServer::addClient()
@@ -12,6 +12,7 @@
 #include <QObject>
 #include <qsocketnotifier.h>
 
+#include <chrono>
 #include <string>
 #include <map>
 #include <set>
@@ -25,6 +26,7 @@
 
 class QTreeWidgetItem;
 class QSocketNotifier;
+class QTimer;
 
 namespace vrb
 {
@@ -43,6 +45,7 @@ private slots:
     void processMessages(float waitTime = 0.0001f);
 
 	void processUdpMessages();
+    void flushRegistryChanges();
 public:
     VRBServer(bool gui);
     void loop();
@@ -59,6 +62,11 @@ private:
     const covise::ServerConnection *sConn = nullptr;
 	const covise::UDPConnection* udpConn = nullptr;
     std::unique_ptr<QSocketNotifier> serverSN;
+    std::unique_ptr<QTimer> flushTimer; // sends coalesced registry changes in gui mode
+    std::chrono::steady_clock::time_point m_nextFlush = std::chrono::steady_clock::time_point::max(); // when flushRegistryChanges() has work
+    int m_statisticsInterval = 0; // seconds between registry statistics, 0: none
+    std::chrono::steady_clock::time_point m_lastStatistics;
+    vrb::VrbServerRegistry::Statistics m_reportedStatistics;
 
     covise::ConnectionList connections;
     std::unique_ptr<vrb::VrbMessageHandler> handler;
@@ -69,6 +77,8 @@ private:
     bool requestToQuit = false;
 
     void addClient();
+    void printStatistics();
+    float boundedWait(float waitTime) const;
 
 
 };
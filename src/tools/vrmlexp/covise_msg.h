@@ -215,7 +215,9 @@ enum covise_msg_type
     COVISE_MESSAGE_NEW_UI,                            // 141
     COVISE_MESSAGE_PROXY,                             // 142
     COVISE_MESSAGE_SOUND,                             // 143
-    COVISE_MESSAGE_LAST_DUMMY_MESSAGE                 // 144
+    COVISE_MESSAGE_SET_ELEMENT,                       // 144
+    COVISE_MESSAGE_TRACE,                             // 145
+    COVISE_MESSAGE_LAST_DUMMY_MESSAGE                 // 146
 };
 
 #ifdef DEFINE_MSG_TYPES
@@ -364,7 +366,9 @@ const char *covise_msg_types_array[COVISE_MESSAGE_LAST_DUMMY_MESSAGE + 1] = {
     "COVISE_MESSAGE_NEW_UI",                            // 141
     "COVISE_MESSAGE_PROXY",                             // 142
     "COVISE_MESSAGE_SOUND",                             // 143
-    "COVISE_MESSAGE_LAST_DUMMY_MESSAGE"                 // 144
+    "COVISE_MESSAGE_SET_ELEMENT",                       // 144
+    "COVISE_MESSAGE_TRACE",                             // 145
+    "COVISE_MESSAGE_LAST_DUMMY_MESSAGE"                 // 146
 };
 #else
 extern const char *covise_msg_types_array[];